@@ -49,6 +49,18 @@ void ApiEventProcessor::ProcessApiEvent(const orbit_grpc_protos::ApiEvent& grpc_
   ProcessApiEvent(api_event);
 }
 
+void ApiEventProcessor::ProcessApiScope(const orbit_grpc_protos::ApiScope& api_scope,
+                                        const std::string& name) {
+  // Downstream, the name and color of kApiEvent timers are decoded from the registers.
+  orbit_api::EncodedEvent encoded_event(orbit_api::kScopeStart, name.c_str(), /*data=*/0,
+                                        static_cast<orbit_api_color>(api_scope.color()));
+  TimerInfo timer_info = TimerInfoFromEncodedEvent(
+      encoded_event, api_scope.end_timestamp_ns() - api_scope.duration_ns(),
+      api_scope.end_timestamp_ns(), api_scope.pid(), api_scope.tid(),
+      static_cast<uint32_t>(api_scope.depth()));
+  capture_listener_->OnTimer(timer_info);
+}
+
 void ApiEventProcessor::ProcessApiEvent(const orbit_api::ApiEvent& api_event) {
   orbit_api::EventType event_type = api_event.Type();
 
@@ -20,6 +20,7 @@ using orbit_client_protos::CallstackInfo;
 using orbit_client_protos::TimerInfo;
 
 using orbit_grpc_protos::ApiEvent;
+using orbit_grpc_protos::ApiScope;
 using orbit_grpc_protos::ClientCaptureEvent;
 
 namespace {
@@ -59,6 +60,8 @@ class EmptyCaptureListener : public CaptureListener {
       orbit_grpc_protos::LostPerfRecordsEvent /*lost_perf_records_event*/) override {}
   void OnOutOfOrderEventsDiscardedEvent(orbit_grpc_protos::OutOfOrderEventsDiscardedEvent
                                         /*out_of_order_events_discarded_event*/) override {}
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/) override {}
 };
 
 // Test CaptureListener used to validate TimerInfo data produced by api events.
@@ -259,6 +262,52 @@ TEST(ApiEventProcessor, MixedEvents) {
   api.Stop().ExpectNumTimers(7).ExpectNumScopeTimers(3);
 }
 
+TEST(ApiEventProcessor, ScopePairedByService) {
+  constexpr uint64_t kNameKey = 42;
+  constexpr int32_t kPid = 1;
+  constexpr int32_t kTid = 2;
+  constexpr int32_t kDepth = 3;
+  constexpr uint64_t kDurationNs = 100;
+  constexpr uint64_t kEndTimestampNs = 1000;
+
+  ApiEventCaptureListener listener;
+  std::shared_ptr<CaptureEventProcessor> capture_event_processor =
+      CaptureEventProcessor::CreateForCaptureListener(&listener, std::nullopt, {});
+
+  ClientCaptureEvent interned_string_event;
+  interned_string_event.mutable_interned_string()->set_key(kNameKey);
+  interned_string_event.mutable_interned_string()->set_intern("Scope");
+  capture_event_processor->ProcessEvent(interned_string_event);
+
+  ClientCaptureEvent api_scope_event;
+  ApiScope* api_scope = api_scope_event.mutable_api_scope();
+  api_scope->set_pid(kPid);
+  api_scope->set_tid(kTid);
+  api_scope->set_duration_ns(kDurationNs);
+  api_scope->set_end_timestamp_ns(kEndTimestampNs);
+  api_scope->set_depth(kDepth);
+  api_scope->set_name_key(kNameKey);
+  api_scope->set_color(kOrbitColorRed);
+  capture_event_processor->ProcessEvent(api_scope_event);
+
+  ASSERT_EQ(listener.timers_.size(), 1);
+  const TimerInfo& timer_info = listener.timers_[0];
+  EXPECT_EQ(timer_info.type(), TimerInfo::kApiEvent);
+  EXPECT_EQ(timer_info.process_id(), kPid);
+  EXPECT_EQ(timer_info.thread_id(), kTid);
+  EXPECT_EQ(timer_info.start(), kEndTimestampNs - kDurationNs);
+  EXPECT_EQ(timer_info.end(), kEndTimestampNs);
+  EXPECT_EQ(timer_info.depth(), kDepth);
+
+  // The timer is indistinguishable from one created from a pair of ApiEvents.
+  orbit_api::EncodedEvent expected_encoded_event(orbit_api::kScopeStart, "Scope", /*data=*/0,
+                                                 kOrbitColorRed);
+  ASSERT_EQ(timer_info.registers_size(), 6);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(timer_info.registers(i), expected_encoded_event.args[i]);
+  }
+}
+
 }  // namespace
 
 }  // namespace orbit_capture_client
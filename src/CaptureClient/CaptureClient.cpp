@@ -76,6 +76,7 @@ Future<ErrorMessageOr<CaptureListener::CaptureOutcome>> CaptureClient::Capture(
     bool collect_gpu_jobs, bool enable_api, bool enable_introspection,
     bool enable_user_space_instrumentation, uint64_t max_local_marker_depth_per_command_buffer,
     bool collect_memory_info, uint64_t memory_sampling_period_ms,
+    uint64_t function_call_coalescing_threshold_ns, uint64_t function_call_coalescing_max_gap_ns,
     std::unique_ptr<CaptureEventProcessor> capture_event_processor) {
   absl::MutexLock lock(&state_mutex_);
   if (state_ != State::kStopped) {
@@ -93,13 +94,15 @@ Future<ErrorMessageOr<CaptureListener::CaptureOutcome>> CaptureClient::Capture(
        unwinding_method, collect_scheduling_info, collect_thread_state, collect_gpu_jobs,
        enable_api, enable_introspection, enable_user_space_instrumentation,
        max_local_marker_depth_per_command_buffer, collect_memory_info, memory_sampling_period_ms,
+       function_call_coalescing_threshold_ns, function_call_coalescing_max_gap_ns,
        capture_event_processor = std::move(capture_event_processor)]() mutable {
         return CaptureSync(process_id, module_manager, selected_functions, selected_tracepoints,
                            samples_per_second, stack_dump_size, unwinding_method,
                            collect_scheduling_info, collect_thread_state, collect_gpu_jobs,
                            enable_api, enable_introspection, enable_user_space_instrumentation,
                            max_local_marker_depth_per_command_buffer, collect_memory_info,
-                           memory_sampling_period_ms, capture_event_processor.get());
+                           memory_sampling_period_ms, function_call_coalescing_threshold_ns,
+                           function_call_coalescing_max_gap_ns, capture_event_processor.get());
       });
 
   return capture_result;
@@ -138,6 +141,7 @@ ErrorMessageOr<CaptureListener::CaptureOutcome> CaptureClient::CaptureSync(
     bool collect_thread_state, bool collect_gpu_jobs, bool enable_api, bool enable_introspection,
     bool enable_user_space_instrumentation, uint64_t max_local_marker_depth_per_command_buffer,
     bool collect_memory_info, uint64_t memory_sampling_period_ms,
+    uint64_t function_call_coalescing_threshold_ns, uint64_t function_call_coalescing_max_gap_ns,
     CaptureEventProcessor* capture_event_processor) {
   ORBIT_SCOPE_FUNCTION;
   writes_done_failed_ = false;
@@ -201,6 +205,8 @@ ErrorMessageOr<CaptureListener::CaptureOutcome> CaptureClient::CaptureSync(
   capture_options->set_enable_api(enable_api);
   capture_options->set_enable_introspection(enable_introspection);
   capture_options->set_enable_user_space_instrumentation(enable_user_space_instrumentation);
+  capture_options->set_function_call_coalescing_threshold_ns(function_call_coalescing_threshold_ns);
+  capture_options->set_function_call_coalescing_max_gap_ns(function_call_coalescing_max_gap_ns);
 
   auto api_functions = FindApiFunctions(module_manager);
   *(capture_options->mutable_api_functions()) = {api_functions.begin(), api_functions.end()};
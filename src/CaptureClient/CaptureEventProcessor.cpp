@@ -6,6 +6,7 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_format.h>
 #include <llvm/Demangle/Demangle.h>
 
 #include <string>
@@ -36,6 +37,7 @@ using orbit_grpc_protos::InternedCallstack;
 using orbit_grpc_protos::InternedString;
 using orbit_grpc_protos::IntrospectionScope;
 using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
 using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadStateSlice;
 
@@ -57,11 +59,16 @@ class CaptureEventProcessorForListener : public CaptureEventProcessor {
   void ProcessCaptureStarted(const orbit_grpc_protos::CaptureStarted& capture_started);
   void ProcessCaptureFinished(const orbit_grpc_protos::CaptureFinished& capture_finished);
   void ProcessSchedulingSlice(const orbit_grpc_protos::SchedulingSlice& scheduling_slice);
+  void ProcessSchedulingSlicesOnCore(
+      const orbit_grpc_protos::SchedulingSlicesOnCore& scheduling_slices_on_core);
+  void SendSchedulingSliceToListener(int32_t pid, int32_t tid, int32_t core,
+                                     uint64_t in_timestamp_ns, uint64_t out_timestamp_ns);
   void ProcessInternedCallstack(orbit_grpc_protos::InternedCallstack interned_callstack);
   void ProcessCallstackSample(const orbit_grpc_protos::CallstackSample& callstack_sample);
   void ProcessFunctionCall(const orbit_grpc_protos::FunctionCall& function_call);
   void ProcessIntrospectionScope(const orbit_grpc_protos::IntrospectionScope& introspection_scope);
   void ProcessInternedString(orbit_grpc_protos::InternedString interned_string);
+  void ProcessApiScope(const orbit_grpc_protos::ApiScope& api_scope);
   void ProcessModuleUpdate(orbit_grpc_protos::ModuleUpdateEvent module_update);
   void ProcessModulesSnapshot(const orbit_grpc_protos::ModulesSnapshot& modules_snapshot);
   void ProcessGpuJob(const orbit_grpc_protos::GpuJob& gpu_job);
@@ -85,6 +92,8 @@ class CaptureEventProcessorForListener : public CaptureEventProcessor {
       const orbit_grpc_protos::LostPerfRecordsEvent& lost_perf_records_event);
   void ProcessOutOfOrderEventsDiscardedEvent(
       const orbit_grpc_protos::OutOfOrderEventsDiscardedEvent& out_of_order_events_discarded_event);
+  void ProcessUnwindingErrorsSummaryEvent(
+      const orbit_grpc_protos::UnwindingErrorsSummaryEvent& unwinding_errors_summary_event);
 
   void ProcessMemoryUsageEvent(const orbit_grpc_protos::MemoryUsageEvent& memory_usage_event);
   void ExtractAndProcessSystemMemoryTrackingTimer(
@@ -125,6 +134,9 @@ void CaptureEventProcessorForListener::ProcessEvent(const ClientCaptureEvent& ev
     case ClientCaptureEvent::kSchedulingSlice:
       ProcessSchedulingSlice(event.scheduling_slice());
       break;
+    case ClientCaptureEvent::kSchedulingSlicesOnCore:
+      ProcessSchedulingSlicesOnCore(event.scheduling_slices_on_core());
+      break;
     case ClientCaptureEvent::kInternedCallstack:
       ProcessInternedCallstack(event.interned_callstack());
       break;
@@ -176,6 +188,9 @@ void CaptureEventProcessorForListener::ProcessEvent(const ClientCaptureEvent& ev
     case ClientCaptureEvent::kApiEvent:
       api_event_processor_.ProcessApiEvent(event.api_event());
       break;
+    case ClientCaptureEvent::kApiScope:
+      ProcessApiScope(event.api_scope());
+      break;
     case ClientCaptureEvent::kWarningEvent:
       ProcessWarningEvent(event.warning_event());
       break;
@@ -194,6 +209,9 @@ void CaptureEventProcessorForListener::ProcessEvent(const ClientCaptureEvent& ev
     case ClientCaptureEvent::kOutOfOrderEventsDiscardedEvent:
       ProcessOutOfOrderEventsDiscardedEvent(event.out_of_order_events_discarded_event());
       break;
+    case ClientCaptureEvent::kUnwindingErrorsSummaryEvent:
+      ProcessUnwindingErrorsSummaryEvent(event.unwinding_errors_summary_event());
+      break;
     case ClientCaptureEvent::kCaptureFinished:
       ProcessCaptureFinished(event.capture_finished());
       break;
@@ -212,18 +230,75 @@ void CaptureEventProcessorForListener::ProcessCaptureStarted(
 
 void CaptureEventProcessorForListener::ProcessCaptureFinished(
     const orbit_grpc_protos::CaptureFinished& capture_finished) {
+  // `GpuJob`s are recorded for all processes, so unmatched ones are only worth a log line, while
+  // unmatched `GpuQueueSubmission`s mean that timers of the target are missing.
+  const uint64_t num_unmatched_gpu_jobs = gpu_queue_submission_processor_.GetNumUnmatchedGpuJobs();
+  const uint64_t num_unmatched_gpu_queue_submissions =
+      gpu_queue_submission_processor_.GetNumUnmatchedGpuQueueSubmissions();
+  if (num_unmatched_gpu_jobs > 0 || num_unmatched_gpu_queue_submissions > 0) {
+    LOG("Unmatched GPU jobs: %u, unmatched GPU queue submissions: %u", num_unmatched_gpu_jobs,
+        num_unmatched_gpu_queue_submissions);
+  }
+  if (num_unmatched_gpu_queue_submissions > 0) {
+    orbit_grpc_protos::WarningEvent warning_event;
+    warning_event.set_timestamp_ns(gpu_queue_submission_processor_.GetLatestTimestampNs());
+    warning_event.set_message(absl::StrFormat(
+        "%u Vulkan queue submissions could not be matched with their GPU job, so their command "
+        "buffer and debug marker timers are missing.",
+        num_unmatched_gpu_queue_submissions));
+    capture_listener_->OnWarningEvent(warning_event);
+  }
+
   capture_listener_->OnCaptureFinished(capture_finished);
 }
 
 void CaptureEventProcessorForListener::ProcessSchedulingSlice(
     const SchedulingSlice& scheduling_slice) {
+  SendSchedulingSliceToListener(
+      scheduling_slice.pid(), scheduling_slice.tid(), scheduling_slice.core(),
+      scheduling_slice.out_timestamp_ns() - scheduling_slice.duration_ns(),
+      scheduling_slice.out_timestamp_ns());
+}
+
+void CaptureEventProcessorForListener::ProcessSchedulingSlicesOnCore(
+    const SchedulingSlicesOnCore& scheduling_slices_on_core) {
+  const int num_slices = scheduling_slices_on_core.durations_ns_size();
+  if (scheduling_slices_on_core.in_timestamp_deltas_ns_size() != num_slices ||
+      scheduling_slices_on_core.thread_indices_size() != num_slices ||
+      scheduling_slices_on_core.thread_pids_size() !=
+          scheduling_slices_on_core.thread_tids_size()) {
+    ERROR("Malformed SchedulingSlicesOnCore for core %d", scheduling_slices_on_core.core());
+    return;
+  }
+
+  uint64_t previous_out_timestamp_ns = 0;
+  for (int i = 0; i < num_slices; ++i) {
+    const uint32_t thread_index = scheduling_slices_on_core.thread_indices(i);
+    if (thread_index >= static_cast<uint32_t>(scheduling_slices_on_core.thread_pids_size())) {
+      ERROR("Thread index %u out of range in SchedulingSlicesOnCore", thread_index);
+      return;
+    }
+    const uint64_t in_timestamp_ns =
+        previous_out_timestamp_ns + scheduling_slices_on_core.in_timestamp_deltas_ns(i);
+    const uint64_t out_timestamp_ns = in_timestamp_ns + scheduling_slices_on_core.durations_ns(i);
+    SendSchedulingSliceToListener(scheduling_slices_on_core.thread_pids(thread_index),
+                                  scheduling_slices_on_core.thread_tids(thread_index),
+                                  scheduling_slices_on_core.core(), in_timestamp_ns,
+                                  out_timestamp_ns);
+    previous_out_timestamp_ns = out_timestamp_ns;
+  }
+}
+
+void CaptureEventProcessorForListener::SendSchedulingSliceToListener(int32_t pid, int32_t tid,
+                                                                     int32_t core,
+                                                                     uint64_t in_timestamp_ns,
+                                                                     uint64_t out_timestamp_ns) {
   TimerInfo timer_info;
-  uint64_t in_timestamp_ns = scheduling_slice.out_timestamp_ns() - scheduling_slice.duration_ns();
   timer_info.set_start(in_timestamp_ns);
-  timer_info.set_end(scheduling_slice.out_timestamp_ns());
-  timer_info.set_process_id(scheduling_slice.pid());
-  timer_info.set_thread_id(scheduling_slice.tid());
-  timer_info.set_processor(static_cast<int8_t>(scheduling_slice.core()));
+  timer_info.set_end(out_timestamp_ns);
+  timer_info.set_process_id(pid);
+  timer_info.set_thread_id(tid);
+  timer_info.set_processor(static_cast<int8_t>(core));
   timer_info.set_depth(timer_info.processor());
   timer_info.set_type(TimerInfo::kCoreActivity);
 
@@ -276,6 +351,13 @@ void CaptureEventProcessorForListener::ProcessFunctionCall(const FunctionCall& f
     timer_info.add_registers(function_call.registers(i));
   }
 
+  if (function_call.num_coalesced_calls() > 0) {
+    timer_info.set_num_coalesced_calls(function_call.num_coalesced_calls());
+    timer_info.set_coalesced_total_duration_ns(function_call.coalesced_total_duration_ns());
+    timer_info.set_coalesced_min_duration_ns(function_call.coalesced_min_duration_ns());
+    timer_info.set_coalesced_max_duration_ns(function_call.coalesced_max_duration_ns());
+  }
+
   gpu_queue_submission_processor_.UpdateBeginCaptureTime(begin_timestamp_ns);
 
   capture_listener_->OnTimer(timer_info);
@@ -309,6 +391,16 @@ void CaptureEventProcessorForListener::ProcessInternedString(InternedString inte
   string_intern_pool_.emplace(interned_string.key(), std::move(*interned_string.mutable_intern()));
 }
 
+void CaptureEventProcessorForListener::ProcessApiScope(
+    const orbit_grpc_protos::ApiScope& api_scope) {
+  auto name_it = string_intern_pool_.find(api_scope.name_key());
+  if (name_it == string_intern_pool_.end()) {
+    ERROR("Unknown name key %llu of ApiScope", api_scope.name_key());
+    return;
+  }
+  api_event_processor_.ProcessApiScope(api_scope, name_it->second);
+}
+
 void CaptureEventProcessorForListener::ProcessModuleUpdate(
     orbit_grpc_protos::ModuleUpdateEvent module_update) {
   capture_listener_->OnModuleUpdate(module_update.timestamp_ns(),
@@ -679,6 +771,11 @@ void CaptureEventProcessorForListener::ProcessOutOfOrderEventsDiscardedEvent(
   capture_listener_->OnOutOfOrderEventsDiscardedEvent(out_of_order_events_discarded_event);
 }
 
+void CaptureEventProcessorForListener::ProcessUnwindingErrorsSummaryEvent(
+    const orbit_grpc_protos::UnwindingErrorsSummaryEvent& unwinding_errors_summary_event) {
+  capture_listener_->OnUnwindingErrorsSummaryEvent(unwinding_errors_summary_event);
+}
+
 uint64_t CaptureEventProcessorForListener::GetStringHashAndSendToListenerIfNecessary(
     const std::string& str) {
   uint64_t hash = std::hash<std::string>{}(str);
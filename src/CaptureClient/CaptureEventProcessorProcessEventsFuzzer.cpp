@@ -67,6 +67,8 @@ class MyCaptureListener : public CaptureListener {
       orbit_grpc_protos::LostPerfRecordsEvent /*lost_perf_records_event*/) override {}
   void OnOutOfOrderEventsDiscardedEvent(orbit_grpc_protos::OutOfOrderEventsDiscardedEvent
                                         /*out_of_order_events_discarded_event*/) override {}
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/) override {}
 };
 }  // namespace
 
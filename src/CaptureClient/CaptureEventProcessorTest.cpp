@@ -56,11 +56,13 @@ using orbit_grpc_protos::ModuleInfo;
 using orbit_grpc_protos::OutOfOrderEventsDiscardedEvent;
 using orbit_grpc_protos::ProcessMemoryUsage;
 using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
 using orbit_grpc_protos::SystemMemoryUsage;
 using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadStateSlice;
 using orbit_grpc_protos::TracepointEvent;
 using orbit_grpc_protos::TracepointInfo;
+using orbit_grpc_protos::UnwindingErrorsSummaryEvent;
 using orbit_grpc_protos::WarningEvent;
 
 using ::testing::_;
@@ -109,6 +111,9 @@ class MockCaptureListener : public CaptureListener {
       void, OnOutOfOrderEventsDiscardedEvent,
       (orbit_grpc_protos::OutOfOrderEventsDiscardedEvent /*out_of_order_events_discarded_event*/),
       (override));
+  MOCK_METHOD(void, OnUnwindingErrorsSummaryEvent,
+              (orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/),
+              (override));
 };
 
 }  // namespace
@@ -140,6 +145,55 @@ TEST(CaptureEventProcessor, CanHandleSchedulingSlices) {
   EXPECT_EQ(actual_timer.type(), TimerInfo::kCoreActivity);
 }
 
+TEST(CaptureEventProcessor, CanHandleSchedulingSlicesOnCore) {
+  MockCaptureListener listener;
+  auto event_processor =
+      CaptureEventProcessor::CreateForCaptureListener(&listener, std::filesystem::path{}, {});
+
+  ClientCaptureEvent event;
+  SchedulingSlicesOnCore* scheduling_slices_on_core = event.mutable_scheduling_slices_on_core();
+  scheduling_slices_on_core->set_core(3);
+  scheduling_slices_on_core->add_thread_pids(42);
+  scheduling_slices_on_core->add_thread_tids(24);
+  scheduling_slices_on_core->add_thread_pids(43);
+  scheduling_slices_on_core->add_thread_tids(34);
+  // Slices [100, 150], [170, 200], and [190, 300] (after lost events).
+  scheduling_slices_on_core->add_thread_indices(0);
+  scheduling_slices_on_core->add_in_timestamp_deltas_ns(100);
+  scheduling_slices_on_core->add_durations_ns(50);
+  scheduling_slices_on_core->add_thread_indices(1);
+  scheduling_slices_on_core->add_in_timestamp_deltas_ns(20);
+  scheduling_slices_on_core->add_durations_ns(30);
+  scheduling_slices_on_core->add_thread_indices(0);
+  scheduling_slices_on_core->add_in_timestamp_deltas_ns(-10);
+  scheduling_slices_on_core->add_durations_ns(110);
+
+  std::vector<TimerInfo> actual_timers;
+  EXPECT_CALL(listener, OnTimer).Times(3).WillRepeatedly([&actual_timers](const TimerInfo& timer) {
+    actual_timers.push_back(timer);
+  });
+
+  event_processor->ProcessEvent(event);
+
+  ASSERT_EQ(actual_timers.size(), 3);
+  EXPECT_EQ(actual_timers[0].start(), 100);
+  EXPECT_EQ(actual_timers[0].end(), 150);
+  EXPECT_EQ(actual_timers[0].process_id(), 42);
+  EXPECT_EQ(actual_timers[0].thread_id(), 24);
+  EXPECT_EQ(actual_timers[1].start(), 170);
+  EXPECT_EQ(actual_timers[1].end(), 200);
+  EXPECT_EQ(actual_timers[1].process_id(), 43);
+  EXPECT_EQ(actual_timers[1].thread_id(), 34);
+  EXPECT_EQ(actual_timers[2].start(), 190);
+  EXPECT_EQ(actual_timers[2].end(), 300);
+  EXPECT_EQ(actual_timers[2].thread_id(), 24);
+  for (const TimerInfo& actual_timer : actual_timers) {
+    EXPECT_EQ(actual_timer.processor(), 3);
+    EXPECT_EQ(actual_timer.depth(), 3);
+    EXPECT_EQ(actual_timer.type(), TimerInfo::kCoreActivity);
+  }
+}
+
 static InternedCallstack* AddAndInitializeInternedCallstack(ClientCaptureEvent& event) {
   InternedCallstack* interned_callstack = event.mutable_interned_callstack();
   interned_callstack->set_key(1);
@@ -1160,6 +1214,30 @@ TEST(CaptureEventProcessor, CanHandleGpuDebugMarkersWithNoBeginJobRecorded) {
                            kTimelineKey, actual_marker_key);
 }
 
+TEST(CaptureEventProcessor, WarnsAboutUnmatchedGpuSubmissionsWhenCaptureFinishes) {
+  MockCaptureListener listener;
+  auto event_processor =
+      CaptureEventProcessor::CreateForCaptureListener(&listener, std::filesystem::path{}, {});
+
+  ClientCaptureEvent queue_submission_event;
+  GpuQueueSubmission* submission = queue_submission_event.mutable_gpu_queue_submission();
+  CreateGpuQueueSubmissionMetaInfo(submission, 9, 11);
+  AddGpuCommandBufferToGpuSubmitInfo(submission->add_submit_infos(), 115, 119);
+
+  ClientCaptureEvent capture_finished_event;
+  capture_finished_event.mutable_capture_finished();
+
+  WarningEvent actual_warning_event;
+  EXPECT_CALL(listener, OnWarningEvent).Times(1).WillOnce(SaveArg<0>(&actual_warning_event));
+  EXPECT_CALL(listener, OnCaptureFinished).Times(1);
+
+  event_processor->ProcessEvent(queue_submission_event);
+  event_processor->ProcessEvent(capture_finished_event);
+
+  EXPECT_EQ(actual_warning_event.timestamp_ns(), 11);
+  EXPECT_THAT(actual_warning_event.message(), testing::HasSubstr("1 Vulkan queue submissions"));
+}
+
 TEST(CaptureEventProcessor, CanHandleThreadStateSlices) {
   MockCaptureListener listener;
   auto event_processor =
@@ -1370,6 +1448,32 @@ TEST(CaptureEventProcessor, CanHandleOutOfOrderEventsDiscardedEvents) {
   EXPECT_EQ(actual_out_of_order_events_discarded_event.end_timestamp_ns(), kEndTimestampNs);
 }
 
+TEST(CaptureEventProcessor, CanHandleUnwindingErrorsSummaryEvents) {
+  MockCaptureListener listener;
+  auto event_processor =
+      CaptureEventProcessor::CreateForCaptureListener(&listener, std::filesystem::path{}, {});
+
+  ClientCaptureEvent event;
+  UnwindingErrorsSummaryEvent* unwinding_errors_summary_event =
+      event.mutable_unwinding_errors_summary_event();
+  constexpr uint64_t kTotalSamplesCount = 42;
+  unwinding_errors_summary_event->set_total_samples_count(kTotalSamplesCount);
+  constexpr uint64_t kStackDumpTooSmallCount = 12;
+  unwinding_errors_summary_event->mutable_total_errors()->set_stack_dump_too_small(
+      kStackDumpTooSmallCount);
+
+  UnwindingErrorsSummaryEvent actual_unwinding_errors_summary_event;
+  EXPECT_CALL(listener, OnUnwindingErrorsSummaryEvent)
+      .Times(1)
+      .WillOnce(SaveArg<0>(&actual_unwinding_errors_summary_event));
+
+  event_processor->ProcessEvent(event);
+
+  EXPECT_EQ(actual_unwinding_errors_summary_event.total_samples_count(), kTotalSamplesCount);
+  EXPECT_EQ(actual_unwinding_errors_summary_event.total_errors().stack_dump_too_small(),
+            kStackDumpTooSmallCount);
+}
+
 TEST(CaptureEventProcessor, CanHandleMultipleEvents) {
   MockCaptureListener listener;
   auto event_processor =
@@ -4,6 +4,9 @@
 
 #include "CaptureClient/GpuQueueSubmissionProcessor.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "OrbitBase/Logging.h"
 
 namespace orbit_capture_client {
@@ -15,6 +18,97 @@ using orbit_grpc_protos::GpuCommandBuffer;
 using orbit_grpc_protos::GpuJob;
 using orbit_grpc_protos::GpuQueueSubmission;
 
+namespace {
+// The stored infos are only checked for eviction whenever the time advanced by this fraction of
+// the maximum age, so that eviction does not cost anything per event.
+constexpr uint64_t kEvictionIntervalDivisor = 8;
+
+// The following functions operate on the time-ordered queues of `GpuJobInfo`s and
+// `GpuQueueSubmissionInfo`s, both of which are ordered by their `timestamp_ns` field.
+template <typename Infos>
+[[nodiscard]] auto LowerBound(Infos& infos, uint64_t timestamp_ns) {
+  return std::lower_bound(
+      infos.begin(), infos.end(), timestamp_ns,
+      [](const auto& info, uint64_t timestamp_ns) { return info.timestamp_ns < timestamp_ns; });
+}
+
+template <typename Infos>
+[[nodiscard]] auto UpperBound(Infos& infos, uint64_t timestamp_ns) {
+  return std::upper_bound(
+      infos.begin(), infos.end(), timestamp_ns,
+      [](uint64_t timestamp_ns, const auto& info) { return timestamp_ns < info.timestamp_ns; });
+}
+
+// Inserts `info` in order, replacing the info with the same timestamp, if any. As events mostly
+// arrive in order, this usually appends.
+template <typename Infos, typename Info>
+void InsertOrAssign(Infos* infos, Info info) {
+  if (infos->empty() || infos->back().timestamp_ns < info.timestamp_ns) {
+    infos->push_back(std::move(info));
+    return;
+  }
+  auto it = LowerBound(*infos, info.timestamp_ns);
+  if (it != infos->end() && it->timestamp_ns == info.timestamp_ns) {
+    *it = std::move(info);
+    return;
+  }
+  infos->insert(it, std::move(info));
+}
+
+template <typename TidToInfos>
+[[nodiscard]] auto* Find(TidToInfos& tid_to_infos, int32_t thread_id, uint64_t timestamp_ns) {
+  using Info = typename TidToInfos::mapped_type::value_type;
+  auto infos_it = tid_to_infos.find(thread_id);
+  if (infos_it == tid_to_infos.end()) {
+    return static_cast<Info*>(nullptr);
+  }
+  auto it = LowerBound(infos_it->second, timestamp_ns);
+  if (it == infos_it->second.end() || it->timestamp_ns != timestamp_ns) {
+    return static_cast<Info*>(nullptr);
+  }
+  return &*it;
+}
+
+template <typename TidToInfos>
+void Erase(TidToInfos* tid_to_infos, int32_t thread_id, uint64_t timestamp_ns) {
+  auto infos_it = tid_to_infos->find(thread_id);
+  if (infos_it == tid_to_infos->end()) {
+    return;
+  }
+  auto& infos = infos_it->second;
+  auto it = LowerBound(infos, timestamp_ns);
+  if (it != infos.end() && it->timestamp_ns == timestamp_ns) {
+    infos.erase(it);
+  }
+  if (infos.empty()) {
+    tid_to_infos->erase(infos_it);
+  }
+}
+
+// Calls `evict_if` with each of the infos older than `min_timestamp_ns`, at the front of each
+// queue, and removes those for which it returns true. `evict_if` may modify the infos it keeps,
+// which keep their order.
+template <typename TidToInfos, typename EvictIf>
+void EvictInfosOlderThan(TidToInfos* tid_to_infos, uint64_t min_timestamp_ns, EvictIf evict_if) {
+  for (auto infos_it = tid_to_infos->begin(); infos_it != tid_to_infos->end();) {
+    auto& infos = infos_it->second;
+    auto old_infos_end = LowerBound(infos, min_timestamp_ns);
+    auto kept_infos_end = infos.begin();
+    for (auto it = infos.begin(); it != old_infos_end; ++it) {
+      if (evict_if(*it)) continue;
+      if (kept_infos_end != it) *kept_infos_end = std::move(*it);
+      ++kept_infos_end;
+    }
+    infos.erase(kept_infos_end, old_infos_end);
+    if (infos.empty()) {
+      tid_to_infos->erase(infos_it++);
+    } else {
+      ++infos_it;
+    }
+  }
+}
+}  // namespace
+
 std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuQueueSubmission(
     const GpuQueueSubmission& gpu_queue_submission,
     const absl::flat_hash_map<uint64_t, std::string>& string_intern_pool,
@@ -25,35 +119,48 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuQueueSubmission(
       gpu_queue_submission.meta_info().pre_submission_cpu_timestamp();
   uint64_t post_submission_cpu_timestamp =
       gpu_queue_submission.meta_info().post_submission_cpu_timestamp();
-  const GpuJob* matching_gpu_job =
+  EvictOldInfos(post_submission_cpu_timestamp);
+  GpuJobInfo* matching_gpu_job =
       FindMatchingGpuJob(thread_id, pre_submission_cpu_timestamp, post_submission_cpu_timestamp);
 
   // If we haven't found the matching "GpuJob" or the submission contains "begin" markers (which
   // might have the "end" markers in a later submission), we save the "GpuSubmission" for later.
   // Note that as soon as all "begin" markers have been processed, the "GpuSubmission" will be
-  // deleted again.
+  // deleted again. The whole submission is only needed until the "GpuJob" arrives.
   if (matching_gpu_job == nullptr || gpu_queue_submission.num_begin_markers() > 0) {
-    tid_to_post_submission_time_to_gpu_submission_[thread_id][post_submission_cpu_timestamp] =
-        gpu_queue_submission;
-  }
-  if (gpu_queue_submission.num_begin_markers() > 0) {
-    tid_to_post_submission_time_to_num_begin_markers_[thread_id][post_submission_cpu_timestamp] =
+    std::optional<GpuCommandBuffer> first_command_buffer =
+        ExtractFirstCommandBuffer(gpu_queue_submission);
+    GpuQueueSubmissionInfo gpu_queue_submission_info;
+    gpu_queue_submission_info.timestamp_ns = post_submission_cpu_timestamp;
+    gpu_queue_submission_info.pre_submission_cpu_timestamp = pre_submission_cpu_timestamp;
+    gpu_queue_submission_info.num_unprocessed_begin_markers =
         gpu_queue_submission.num_begin_markers();
+    if (first_command_buffer.has_value()) {
+      gpu_queue_submission_info.first_command_buffer_begin_gpu_timestamp_ns =
+          first_command_buffer->begin_gpu_timestamp_ns();
+    }
+    if (matching_gpu_job == nullptr) {
+      gpu_queue_submission_info.waiting_for_gpu_job =
+          std::make_unique<GpuQueueSubmission>(gpu_queue_submission);
+    }
+    InsertOrAssign(&tid_to_gpu_queue_submissions_[thread_id],
+                   std::move(gpu_queue_submission_info));
   }
   if (matching_gpu_job == nullptr) {
     return {};
   }
 
-  // Save the timestamp now, as after the call to `ProcessGpuQueueSubmissionWithMatchingGpuJob`,
-  // the matching_gpu_job may already be deleted.
-  uint64_t submission_cpu_timestamp = matching_gpu_job->amdgpu_cs_ioctl_time_ns();
+  // Copy the job now, as during the call to `ProcessGpuQueueSubmissionWithMatchingGpuJob`, the
+  // saved jobs may be deleted.
+  matching_gpu_job->matched = true;
+  const GpuJobInfo gpu_job = *matching_gpu_job;
 
   std::vector<TimerInfo> result = ProcessGpuQueueSubmissionWithMatchingGpuJob(
-      gpu_queue_submission, *matching_gpu_job, string_intern_pool,
+      gpu_queue_submission, gpu_job, string_intern_pool,
       get_string_hash_and_send_to_listener_if_necessary);
 
   if (!HasUnprocessedBeginMarkers(thread_id, post_submission_cpu_timestamp)) {
-    DeleteSavedGpuJob(thread_id, submission_cpu_timestamp);
+    DeleteSavedGpuJob(thread_id, gpu_job.timestamp_ns);
   }
   return result;
 }
@@ -63,25 +170,40 @@ std::vector<orbit_client_protos::TimerInfo> GpuQueueSubmissionProcessor::Process
         get_string_hash_and_send_to_listener_if_necessary) {
   int32_t thread_id = gpu_job.tid();
   uint64_t amdgpu_cs_ioctl_time_ns = gpu_job.amdgpu_cs_ioctl_time_ns();
-  const GpuQueueSubmission* matching_gpu_submission =
+  EvictOldInfos(gpu_job.dma_fence_signaled_time_ns());
+  GpuQueueSubmissionInfo* matching_gpu_submission =
       FindMatchingGpuQueueSubmission(thread_id, amdgpu_cs_ioctl_time_ns);
+  // A submission that is only kept for its "begin" markers has already been processed.
+  if (matching_gpu_submission != nullptr &&
+      matching_gpu_submission->waiting_for_gpu_job == nullptr) {
+    matching_gpu_submission = nullptr;
+  }
+
+  GpuJobInfo gpu_job_info;
+  gpu_job_info.timestamp_ns = amdgpu_cs_ioctl_time_ns;
+  gpu_job_info.gpu_hardware_start_time_ns = gpu_job.gpu_hardware_start_time_ns();
+  gpu_job_info.timeline_key = gpu_job.timeline_key();
+  gpu_job_info.depth = gpu_job.depth();
+  gpu_job_info.matched = matching_gpu_submission != nullptr;
 
   // If we haven't found the matching "GpuSubmission" or the submission contains "begin" markers
   // (which might have the "end" markers in a later submission), we save the "GpuJob" for later.
   // Note that as soon as all "begin" markers have been processed, the "GpuJob" will be deleted
   // again.
-  if (matching_gpu_submission == nullptr || matching_gpu_submission->num_begin_markers() > 0) {
-    tid_to_submission_time_to_gpu_job_[thread_id][amdgpu_cs_ioctl_time_ns] = gpu_job;
+  if (matching_gpu_submission == nullptr ||
+      matching_gpu_submission->num_unprocessed_begin_markers > 0) {
+    InsertOrAssign(&tid_to_gpu_jobs_[thread_id], gpu_job_info);
   }
   if (matching_gpu_submission == nullptr) {
     return {};
   }
 
-  uint64_t post_submission_cpu_timestamp =
-      matching_gpu_submission->meta_info().post_submission_cpu_timestamp();
+  uint64_t post_submission_cpu_timestamp = matching_gpu_submission->timestamp_ns;
+  std::unique_ptr<GpuQueueSubmission> gpu_queue_submission =
+      std::move(matching_gpu_submission->waiting_for_gpu_job);
 
   std::vector<TimerInfo> result = ProcessGpuQueueSubmissionWithMatchingGpuJob(
-      *matching_gpu_submission, gpu_job, string_intern_pool,
+      *gpu_queue_submission, gpu_job_info, string_intern_pool,
       get_string_hash_and_send_to_listener_if_necessary);
 
   if (!HasUnprocessedBeginMarkers(thread_id, post_submission_cpu_timestamp)) {
@@ -90,77 +212,122 @@ std::vector<orbit_client_protos::TimerInfo> GpuQueueSubmissionProcessor::Process
   return result;
 }
 
-const GpuQueueSubmission* GpuQueueSubmissionProcessor::FindMatchingGpuQueueSubmission(
-    int32_t thread_id, uint64_t submit_time) {
-  const auto& post_submission_time_to_gpu_submission_it =
-      tid_to_post_submission_time_to_gpu_submission_.find(thread_id);
-  if (post_submission_time_to_gpu_submission_it ==
-      tid_to_post_submission_time_to_gpu_submission_.end()) {
+uint64_t GpuQueueSubmissionProcessor::GetNumUnmatchedGpuQueueSubmissions() const {
+  uint64_t num_unmatched = num_evicted_unmatched_gpu_queue_submissions_;
+  for (const auto& [unused_thread_id, gpu_queue_submissions] : tid_to_gpu_queue_submissions_) {
+    num_unmatched += std::count_if(gpu_queue_submissions.begin(), gpu_queue_submissions.end(),
+                                   [](const GpuQueueSubmissionInfo& gpu_queue_submission) {
+                                     return gpu_queue_submission.waiting_for_gpu_job != nullptr;
+                                   });
+  }
+  return num_unmatched;
+}
+
+uint64_t GpuQueueSubmissionProcessor::GetNumUnmatchedGpuJobs() const {
+  uint64_t num_unmatched = num_evicted_unmatched_gpu_jobs_;
+  for (const auto& [unused_thread_id, gpu_jobs] : tid_to_gpu_jobs_) {
+    num_unmatched += std::count_if(gpu_jobs.begin(), gpu_jobs.end(),
+                                   [](const GpuJobInfo& gpu_job) { return !gpu_job.matched; });
+  }
+  return num_unmatched;
+}
+
+void GpuQueueSubmissionProcessor::EvictOldInfos(uint64_t timestamp_ns) {
+  latest_timestamp_ns_ = std::max(latest_timestamp_ns_, timestamp_ns);
+  if (latest_timestamp_ns_ < next_eviction_timestamp_ns_) {
+    return;
+  }
+  const uint64_t eviction_interval_ns =
+      std::max<uint64_t>(max_unmatched_age_ns_ / kEvictionIntervalDivisor, 1);
+  next_eviction_timestamp_ns_ = latest_timestamp_ns_ + eviction_interval_ns;
+  if (latest_timestamp_ns_ <= max_unmatched_age_ns_) {
+    return;
+  }
+
+  // Submissions with unprocessed "begin" markers are kept until their "end" markers come, however
+  // long the debug markers are, and so are their matched jobs. Their number is bounded by the
+  // number of debug markers open at the same time. Only the whole submission of those still
+  // waiting for their job is dropped, as the "end" markers don't need it.
+  const uint64_t min_timestamp_ns = latest_timestamp_ns_ - max_unmatched_age_ns_;
+  EvictInfosOlderThan(&tid_to_gpu_jobs_, min_timestamp_ns, [this](const GpuJobInfo& gpu_job) {
+    if (gpu_job.matched) return false;
+    ++num_evicted_unmatched_gpu_jobs_;
+    return true;
+  });
+  EvictInfosOlderThan(&tid_to_gpu_queue_submissions_, min_timestamp_ns,
+                      [this](GpuQueueSubmissionInfo& gpu_queue_submission) {
+                        if (gpu_queue_submission.waiting_for_gpu_job == nullptr) return false;
+                        ++num_evicted_unmatched_gpu_queue_submissions_;
+                        gpu_queue_submission.waiting_for_gpu_job.reset();
+                        return gpu_queue_submission.num_unprocessed_begin_markers == 0;
+                      });
+}
+
+GpuQueueSubmissionProcessor::GpuQueueSubmissionInfo*
+GpuQueueSubmissionProcessor::FindMatchingGpuQueueSubmission(int32_t thread_id,
+                                                            uint64_t submit_time) {
+  auto gpu_submissions_it = tid_to_gpu_queue_submissions_.find(thread_id);
+  if (gpu_submissions_it == tid_to_gpu_queue_submissions_.end()) {
     return nullptr;
   }
 
-  const auto& post_submission_time_to_gpu_submission =
-      post_submission_time_to_gpu_submission_it->second;
+  auto& gpu_submissions = gpu_submissions_it->second;
 
   // Find the first Gpu submission with a "post submission" timestamp greater or equal to the Gpu
   // job's timestamp. If the "pre submission" timestamp is not greater (i.e. less or equal) than the
   // job's timestamp, we have found the matching submission.
-  auto lower_bound_gpu_submission_it =
-      post_submission_time_to_gpu_submission.lower_bound(submit_time);
-  if (lower_bound_gpu_submission_it == post_submission_time_to_gpu_submission.end()) {
+  auto lower_bound_gpu_submission_it = LowerBound(gpu_submissions, submit_time);
+  if (lower_bound_gpu_submission_it == gpu_submissions.end()) {
     return nullptr;
   }
-  const GpuQueueSubmission* matching_gpu_submission = &lower_bound_gpu_submission_it->second;
+  GpuQueueSubmissionInfo* matching_gpu_submission = &*lower_bound_gpu_submission_it;
 
-  if (matching_gpu_submission->meta_info().pre_submission_cpu_timestamp() > submit_time) {
+  if (matching_gpu_submission->pre_submission_cpu_timestamp > submit_time) {
     return nullptr;
   }
 
   return matching_gpu_submission;
 }
 
-const GpuJob* GpuQueueSubmissionProcessor::FindMatchingGpuJob(
+GpuQueueSubmissionProcessor::GpuJobInfo* GpuQueueSubmissionProcessor::FindMatchingGpuJob(
     int32_t thread_id, uint64_t pre_submission_cpu_timestamp,
     uint64_t post_submission_cpu_timestamp) {
-  const auto& submission_time_to_gpu_job_it = tid_to_submission_time_to_gpu_job_.find(thread_id);
-  if (submission_time_to_gpu_job_it == tid_to_submission_time_to_gpu_job_.end()) {
+  auto gpu_jobs_it = tid_to_gpu_jobs_.find(thread_id);
+  if (gpu_jobs_it == tid_to_gpu_jobs_.end()) {
     return nullptr;
   }
 
-  const auto& submission_time_to_gpu_job = submission_time_to_gpu_job_it->second;
+  auto& gpu_jobs = gpu_jobs_it->second;
 
   // Find the first Gpu job that has a timestamp greater or equal to the "pre submission" timestamp:
-  auto gpu_job_matching_pre_submission_it =
-      submission_time_to_gpu_job.lower_bound(pre_submission_cpu_timestamp);
-  if (gpu_job_matching_pre_submission_it == submission_time_to_gpu_job.end()) {
+  auto gpu_job_matching_pre_submission_it = LowerBound(gpu_jobs, pre_submission_cpu_timestamp);
+  if (gpu_job_matching_pre_submission_it == gpu_jobs.end()) {
     return nullptr;
   }
 
   // Find the first Gpu job that has a timestamp greater to the "post submission" timestamp
   // (which would be the next job) and decrease the iterator by one.
-  auto gpu_job_matching_post_submission_it =
-      submission_time_to_gpu_job.upper_bound(post_submission_cpu_timestamp);
-  if (gpu_job_matching_post_submission_it == submission_time_to_gpu_job.begin()) {
+  auto gpu_job_matching_post_submission_it = UpperBound(gpu_jobs, post_submission_cpu_timestamp);
+  if (gpu_job_matching_post_submission_it == gpu_jobs.begin()) {
     return nullptr;
   }
   --gpu_job_matching_post_submission_it;
 
-  if (&gpu_job_matching_pre_submission_it->second != &gpu_job_matching_post_submission_it->second) {
+  if (gpu_job_matching_pre_submission_it != gpu_job_matching_post_submission_it) {
     return nullptr;
   }
 
-  return &gpu_job_matching_pre_submission_it->second;
+  return &*gpu_job_matching_pre_submission_it;
 }
 
 std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuQueueSubmissionWithMatchingGpuJob(
-    const GpuQueueSubmission& gpu_queue_submission, const GpuJob& matching_gpu_job,
+    const GpuQueueSubmission& gpu_queue_submission, const GpuJobInfo& matching_gpu_job,
     const absl::flat_hash_map<uint64_t, std::string>& string_intern_pool,
     const std::function<uint64_t(const std::string& str)>&
         get_string_hash_and_send_to_listener_if_necessary) {
   std::vector<TimerInfo> result;
-  uint64_t timeline_key = matching_gpu_job.timeline_key();
+  uint64_t timeline_key = matching_gpu_job.timeline_key;
   CHECK(string_intern_pool.contains(timeline_key));
-  std::string timeline = string_intern_pool.at(timeline_key);
 
   std::optional<GpuCommandBuffer> first_command_buffer =
       ExtractFirstCommandBuffer(gpu_queue_submission);
@@ -188,65 +355,44 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuQueueSubmissionWit
 
 bool GpuQueueSubmissionProcessor::HasUnprocessedBeginMarkers(
     int32_t thread_id, uint64_t post_submission_timestamp) const {
-  if (!tid_to_post_submission_time_to_num_begin_markers_.contains(thread_id)) {
+  auto gpu_submissions_it = tid_to_gpu_queue_submissions_.find(thread_id);
+  if (gpu_submissions_it == tid_to_gpu_queue_submissions_.end()) {
     return false;
   }
-  if (!tid_to_post_submission_time_to_num_begin_markers_.at(thread_id).contains(
-          post_submission_timestamp)) {
-    return false;
-  }
-  CHECK(tid_to_post_submission_time_to_num_begin_markers_.at(thread_id).at(
-            post_submission_timestamp) > 0);
-  return true;
+  const auto& gpu_submissions = gpu_submissions_it->second;
+  auto it = LowerBound(gpu_submissions, post_submission_timestamp);
+  return it != gpu_submissions.end() && it->timestamp_ns == post_submission_timestamp &&
+         it->num_unprocessed_begin_markers > 0;
 }
 
 void GpuQueueSubmissionProcessor::DecrementUnprocessedBeginMarkers(
     int32_t thread_id, uint64_t submission_timestamp, uint64_t post_submission_timestamp) {
-  CHECK(tid_to_post_submission_time_to_num_begin_markers_.contains(thread_id));
-  auto& post_submission_time_to_num_begin_markers =
-      tid_to_post_submission_time_to_num_begin_markers_.at(thread_id);
-  CHECK(post_submission_time_to_num_begin_markers.contains(post_submission_timestamp));
-  uint64_t new_num = post_submission_time_to_num_begin_markers.at(post_submission_timestamp) - 1;
-  post_submission_time_to_num_begin_markers.at(post_submission_timestamp) = new_num;
-  if (new_num == 0) {
-    post_submission_time_to_num_begin_markers.erase(post_submission_timestamp);
-    if (post_submission_time_to_num_begin_markers.empty()) {
-      tid_to_post_submission_time_to_num_begin_markers_.erase(thread_id);
-      DeleteSavedGpuJob(thread_id, submission_timestamp);
-      DeleteSavedGpuSubmission(thread_id, post_submission_timestamp);
-    }
+  GpuQueueSubmissionInfo* gpu_submission =
+      Find(tid_to_gpu_queue_submissions_, thread_id, post_submission_timestamp);
+  CHECK(gpu_submission != nullptr);
+  CHECK(gpu_submission->num_unprocessed_begin_markers > 0);
+  --gpu_submission->num_unprocessed_begin_markers;
+  // The submission is still needed if it waits for its job, which then deletes it.
+  if (gpu_submission->num_unprocessed_begin_markers == 0 &&
+      gpu_submission->waiting_for_gpu_job == nullptr) {
+    DeleteSavedGpuJob(thread_id, submission_timestamp);
+    DeleteSavedGpuSubmission(thread_id, post_submission_timestamp);
   }
 }
 
 void GpuQueueSubmissionProcessor::DeleteSavedGpuJob(int32_t thread_id,
                                                     uint64_t submission_timestamp) {
-  if (!tid_to_submission_time_to_gpu_job_.contains(thread_id)) {
-    return;
-  }
   // This method might be called even when the "capture start" falls directly inside a GpuJob, and
-  // we thus don't have the job present in the map.
-  // For simplicity we "erase" it anyways (insert and remove it again).
-  auto& submission_time_to_gpu_job = tid_to_submission_time_to_gpu_job_[thread_id];
-  submission_time_to_gpu_job.erase(submission_timestamp);
-  if (submission_time_to_gpu_job.empty()) {
-    tid_to_submission_time_to_gpu_job_.erase(thread_id);
-  }
+  // we thus don't have the job saved.
+  Erase(&tid_to_gpu_jobs_, thread_id, submission_timestamp);
 }
 void GpuQueueSubmissionProcessor::DeleteSavedGpuSubmission(int32_t thread_id,
                                                            uint64_t post_submission_timestamp) {
-  if (!tid_to_post_submission_time_to_gpu_submission_.contains(thread_id)) {
-    return;
-  }
-  auto& post_submission_time_to_gpu_submission =
-      tid_to_post_submission_time_to_gpu_submission_.at(thread_id);
-  post_submission_time_to_gpu_submission.erase(post_submission_timestamp);
-  if (post_submission_time_to_gpu_submission.empty()) {
-    tid_to_post_submission_time_to_gpu_submission_.erase(thread_id);
-  }
+  Erase(&tid_to_gpu_queue_submissions_, thread_id, post_submission_timestamp);
 }
 
 std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuCommandBuffers(
-    const GpuQueueSubmission& gpu_queue_submission, const GpuJob& matching_gpu_job,
+    const GpuQueueSubmission& gpu_queue_submission, const GpuJobInfo& matching_gpu_job,
     const std::optional<GpuCommandBuffer>& first_command_buffer, uint64_t timeline_hash,
     const std::function<uint64_t(const std::string& str)>&
         get_string_hash_and_send_to_listener_if_necessary) {
@@ -266,15 +412,15 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuCommandBuffers(
       if (command_buffer.begin_gpu_timestamp_ns() != 0) {
         command_buffer_timer.set_start(command_buffer.begin_gpu_timestamp_ns() -
                                        first_command_buffer->begin_gpu_timestamp_ns() +
-                                       matching_gpu_job.gpu_hardware_start_time_ns());
+                                       matching_gpu_job.gpu_hardware_start_time_ns);
       } else {
         command_buffer_timer.set_start(begin_capture_time_ns_);
       }
 
       command_buffer_timer.set_end(command_buffer.end_gpu_timestamp_ns() -
                                    first_command_buffer->begin_gpu_timestamp_ns() +
-                                   matching_gpu_job.gpu_hardware_start_time_ns());
-      command_buffer_timer.set_depth(matching_gpu_job.depth());
+                                   matching_gpu_job.gpu_hardware_start_time_ns);
+      command_buffer_timer.set_depth(matching_gpu_job.depth);
       command_buffer_timer.set_timeline_hash(timeline_hash);
       command_buffer_timer.set_processor(-1);
       command_buffer_timer.set_thread_id(thread_id);
@@ -288,7 +434,7 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuCommandBuffers(
 }
 
 std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuDebugMarkers(
-    const GpuQueueSubmission& gpu_queue_submission, const GpuJob& matching_gpu_job,
+    const GpuQueueSubmission& gpu_queue_submission, const GpuJobInfo& matching_gpu_job,
     const std::optional<GpuCommandBuffer>& first_command_buffer) {
   if (gpu_queue_submission.completed_markers_size() == 0) {
     return {};
@@ -340,28 +486,30 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuDebugMarkers(
       // begins and ends on this submission). If this is the case, use that submission. Otherwise,
       // find the submission that matches the given meta data (that we must have received before,
       // and must still be saved).
-      std::optional<GpuCommandBuffer> begin_submission_first_command_buffer;
+      std::optional<uint64_t> begin_submission_first_command_buffer_begin_gpu_timestamp_ns;
       if (submission_pre_submission_cpu_timestamp == begin_marker_pre_submission_cpu_timestamp &&
           submission_post_submission_cpu_timestamp == begin_marker_post_submission_cpu_timestamp &&
           submission_thread_id == begin_marker_thread_id) {
-        begin_submission_first_command_buffer = ExtractFirstCommandBuffer(gpu_queue_submission);
+        begin_submission_first_command_buffer_begin_gpu_timestamp_ns =
+            first_command_buffer->begin_gpu_timestamp_ns();
       } else {
-        const GpuQueueSubmission* matching_begin_submission = FindMatchingGpuQueueSubmission(
+        const GpuQueueSubmissionInfo* matching_begin_submission = FindMatchingGpuQueueSubmission(
             begin_marker_thread_id, begin_marker_post_submission_cpu_timestamp);
         // Note that we receive submissions of a single queue in order (by CPU submission time).
         // However, if we are out of timer slot indices, we might discard submissions (if it
-        // contains no command buffer timers). If we don't have a matching submission for the
-        // "begin" marker, we have to discard the entire marker.
+        // contains no command buffer timers), and the submission might have been evicted. If we
+        // don't have a matching submission for the "begin" marker, we have to discard the entire
+        // marker.
         if (matching_begin_submission == nullptr) {
           ERROR("Discarding debug marker timer.");
           continue;
         }
-        begin_submission_first_command_buffer =
-            ExtractFirstCommandBuffer(*matching_begin_submission);
+        begin_submission_first_command_buffer_begin_gpu_timestamp_ns =
+            matching_begin_submission->first_command_buffer_begin_gpu_timestamp_ns;
       }
-      CHECK(begin_submission_first_command_buffer.has_value());
+      CHECK(begin_submission_first_command_buffer_begin_gpu_timestamp_ns.has_value());
 
-      const GpuJob* matching_begin_job = FindMatchingGpuJob(
+      const GpuJobInfo* matching_begin_job = FindMatchingGpuJob(
           begin_marker_thread_id, begin_marker_meta_info.pre_submission_cpu_timestamp(),
           begin_marker_post_submission_cpu_timestamp);
 
@@ -370,10 +518,11 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuDebugMarkers(
         // Convert the GPU time to CPU time, based on the CPU time of the HW execution begin and the
         // GPU timestamp of the begin of the first command buffer. Note that we will assume that the
         // first command buffer starts execution right away as an approximation.
-        marker_timer.set_start(completed_marker.begin_marker().gpu_timestamp_ns() +
-                               matching_begin_job->gpu_hardware_start_time_ns() -
-                               begin_submission_first_command_buffer->begin_gpu_timestamp_ns());
-        begin_submission_time_ns = matching_begin_job->amdgpu_cs_ioctl_time_ns();
+        marker_timer.set_start(
+            completed_marker.begin_marker().gpu_timestamp_ns() +
+            matching_begin_job->gpu_hardware_start_time_ns -
+            begin_submission_first_command_buffer_begin_gpu_timestamp_ns.value());
+        begin_submission_time_ns = matching_begin_job->timestamp_ns;
       } else {
         // We might have bad luck and have captured the "begin" submission, but not the matching
         // job.
@@ -398,12 +547,12 @@ std::vector<TimerInfo> GpuQueueSubmissionProcessor::ProcessGpuDebugMarkers(
 
     marker_timer.set_process_id(submission_process_id);
     marker_timer.set_depth(completed_marker.depth());
-    marker_timer.set_timeline_hash(matching_gpu_job.timeline_key());
+    marker_timer.set_timeline_hash(matching_gpu_job.timeline_key);
     marker_timer.set_processor(-1);
     marker_timer.set_type(TimerInfo::kGpuDebugMarker);
     marker_timer.set_end(completed_marker.end_gpu_timestamp_ns() -
                          first_command_buffer->begin_gpu_timestamp_ns() +
-                         matching_gpu_job.gpu_hardware_start_time_ns());
+                         matching_gpu_job.gpu_hardware_start_time_ns);
 
     if (completed_marker.has_color()) {
       Color* color = marker_timer.mutable_color();
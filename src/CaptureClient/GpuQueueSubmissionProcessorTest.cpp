@@ -0,0 +1,223 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <absl/container/flat_hash_map.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CaptureClient/GpuQueueSubmissionProcessor.h"
+#include "capture.pb.h"
+#include "capture_data.pb.h"
+
+namespace orbit_capture_client {
+
+using orbit_client_protos::TimerInfo;
+using orbit_grpc_protos::GpuCommandBuffer;
+using orbit_grpc_protos::GpuJob;
+using orbit_grpc_protos::GpuQueueSubmission;
+using orbit_grpc_protos::GpuQueueSubmissionMetaInfo;
+using orbit_grpc_protos::GpuSubmitInfo;
+
+namespace {
+constexpr uint64_t kTimelineKey = 1;
+constexpr int32_t kGpuPid = 10;
+
+GpuJob CreateGpuJob(int32_t tid, uint64_t amdgpu_cs_ioctl_time_ns,
+                    uint64_t gpu_hardware_start_time_ns, uint64_t dma_fence_signaled_time_ns) {
+  GpuJob gpu_job;
+  gpu_job.set_pid(kGpuPid);
+  gpu_job.set_tid(tid);
+  gpu_job.set_timeline_key(kTimelineKey);
+  gpu_job.set_amdgpu_cs_ioctl_time_ns(amdgpu_cs_ioctl_time_ns);
+  gpu_job.set_amdgpu_sched_run_job_time_ns(amdgpu_cs_ioctl_time_ns + 1);
+  gpu_job.set_gpu_hardware_start_time_ns(gpu_hardware_start_time_ns);
+  gpu_job.set_dma_fence_signaled_time_ns(dma_fence_signaled_time_ns);
+  return gpu_job;
+}
+
+GpuQueueSubmission CreateGpuQueueSubmission(int32_t tid, uint64_t pre_timestamp,
+                                            uint64_t post_timestamp,
+                                            uint64_t num_command_buffers) {
+  GpuQueueSubmission submission;
+  GpuQueueSubmissionMetaInfo* meta_info = submission.mutable_meta_info();
+  meta_info->set_tid(tid);
+  meta_info->set_pid(kGpuPid);
+  meta_info->set_pre_submission_cpu_timestamp(pre_timestamp);
+  meta_info->set_post_submission_cpu_timestamp(post_timestamp);
+  GpuSubmitInfo* submit_info = submission.add_submit_infos();
+  for (uint64_t i = 0; i < num_command_buffers; ++i) {
+    GpuCommandBuffer* command_buffer = submit_info->add_command_buffers();
+    command_buffer->set_begin_gpu_timestamp_ns(1000 + 10 * i);
+    command_buffer->set_end_gpu_timestamp_ns(1000 + 10 * i + 5);
+  }
+  return submission;
+}
+
+class GpuQueueSubmissionProcessorTest : public ::testing::Test {
+ protected:
+  std::vector<TimerInfo> ProcessGpuJob(const GpuJob& gpu_job) {
+    return processor_.ProcessGpuJob(gpu_job, string_intern_pool_, get_string_hash_);
+  }
+
+  std::vector<TimerInfo> ProcessGpuQueueSubmission(const GpuQueueSubmission& submission) {
+    return processor_.ProcessGpuQueueSubmission(submission, string_intern_pool_,
+                                                get_string_hash_);
+  }
+
+  GpuQueueSubmissionProcessor processor_{/*max_unmatched_age_ns=*/1000};
+  absl::flat_hash_map<uint64_t, std::string> string_intern_pool_{{kTimelineKey, "timeline"}};
+  std::function<uint64_t(const std::string& str)> get_string_hash_ =
+      [](const std::string& /*str*/) { return 42; };
+};
+}  // namespace
+
+TEST_F(GpuQueueSubmissionProcessorTest, MatchesGpuJobAndSubmissionInEitherOrder) {
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(1, 10, 30, 40)).empty());
+  EXPECT_EQ(ProcessGpuQueueSubmission(CreateGpuQueueSubmission(1, 9, 11, 3)).size(), 3);
+
+  EXPECT_TRUE(ProcessGpuQueueSubmission(CreateGpuQueueSubmission(1, 50, 52, 2)).empty());
+  EXPECT_EQ(ProcessGpuJob(CreateGpuJob(1, 51, 60, 70)).size(), 2);
+
+  // Neither side is kept after matching.
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(1, 51, 60, 70)).empty());
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 0);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuJobs(), 1);
+}
+
+TEST_F(GpuQueueSubmissionProcessorTest, CountsAndEvictsUnmatchedEvents) {
+  EXPECT_TRUE(ProcessGpuQueueSubmission(CreateGpuQueueSubmission(1, 100, 110, 1)).empty());
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(2, 200, 205, 210)).empty());
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 1);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuJobs(), 1);
+
+  // Both are older than the maximum age at this point, and are evicted.
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(3, 5000, 5005, 5010)).empty());
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 1);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuJobs(), 2);
+
+  // So a late job can't be matched with the evicted submission anymore.
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(1, 105, 107, 5020)).empty());
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 1);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuJobs(), 3);
+  EXPECT_EQ(processor_.GetLatestTimestampNs(), 5020);
+}
+
+namespace {
+void AddCompletedMarker(GpuQueueSubmission* submission, const GpuQueueSubmission& begin_submission,
+                        uint64_t begin_gpu_timestamp_ns, uint64_t end_gpu_timestamp_ns) {
+  orbit_grpc_protos::GpuDebugMarker* marker = submission->add_completed_markers();
+  *marker->mutable_begin_marker()->mutable_meta_info() = begin_submission.meta_info();
+  marker->mutable_begin_marker()->set_gpu_timestamp_ns(begin_gpu_timestamp_ns);
+  marker->set_end_gpu_timestamp_ns(end_gpu_timestamp_ns);
+}
+}  // namespace
+
+TEST_F(GpuQueueSubmissionProcessorTest, ProcessesDebugMarkersLongerThanTheMaximumAge) {
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(1, 105, 200, 300)).empty());
+  GpuQueueSubmission begin_submission = CreateGpuQueueSubmission(1, 100, 110, 1);
+  begin_submission.set_num_begin_markers(1);
+  EXPECT_EQ(ProcessGpuQueueSubmission(begin_submission).size(), 1);
+
+  // The submission and its job are older than the maximum age at this point, but are kept.
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(2, 5000, 5005, 5010)).empty());
+
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(1, 6005, 6100, 6200)).empty());
+  GpuQueueSubmission end_submission = CreateGpuQueueSubmission(1, 6000, 6010, 1);
+  AddCompletedMarker(&end_submission, begin_submission, 1002, 1003);
+  std::vector<TimerInfo> timers = ProcessGpuQueueSubmission(end_submission);
+  ASSERT_EQ(timers.size(), 2);
+  EXPECT_EQ(timers[1].type(), TimerInfo::kGpuDebugMarker);
+  EXPECT_EQ(timers[1].start(), 202);
+  EXPECT_EQ(timers[1].end(), 6103);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 0);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuJobs(), 1);
+}
+
+TEST_F(GpuQueueSubmissionProcessorTest, KeepsDebugMarkerBeginOfEvictedUnmatchedSubmission) {
+  processor_.UpdateBeginCaptureTime(50);
+  GpuQueueSubmission begin_submission = CreateGpuQueueSubmission(1, 100, 110, 1);
+  begin_submission.set_num_begin_markers(1);
+  EXPECT_TRUE(ProcessGpuQueueSubmission(begin_submission).empty());
+
+  // The submission is counted as unmatched, but what its "end" marker needs is kept.
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(2, 5000, 5005, 5010)).empty());
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 1);
+
+  EXPECT_TRUE(ProcessGpuJob(CreateGpuJob(1, 6005, 6100, 6200)).empty());
+  GpuQueueSubmission end_submission = CreateGpuQueueSubmission(1, 6000, 6010, 1);
+  AddCompletedMarker(&end_submission, begin_submission, 1002, 1003);
+  std::vector<TimerInfo> timers = ProcessGpuQueueSubmission(end_submission);
+  ASSERT_EQ(timers.size(), 2);
+  EXPECT_EQ(timers[1].type(), TimerInfo::kGpuDebugMarker);
+  // Without the job of the "begin" submission, the marker begins with the capture.
+  EXPECT_EQ(timers[1].start(), 50);
+  EXPECT_EQ(timers[1].end(), 6103);
+  EXPECT_EQ(processor_.GetNumUnmatchedGpuQueueSubmissions(), 1);
+}
+
+namespace {
+// Processes `num_frames` frames of submissions at 240 frames per second, each with many command
+// buffers, in which a few jobs and submissions are lost.
+void ProcessStreamWithLostEvents(uint64_t num_frames) {
+  constexpr uint64_t kFramesPerSecond = 240;
+  constexpr uint64_t kFramePeriodNs = 1'000'000'000 / kFramesPerSecond;
+  constexpr uint64_t kCommandBuffersPerSubmission = 64;
+  constexpr uint64_t kLostGpuJobsPeriod = 20;
+  constexpr uint64_t kLostSubmissionsPeriod = 30;
+  constexpr int32_t kTid = 1;
+
+  GpuQueueSubmissionProcessor processor;
+  absl::flat_hash_map<uint64_t, std::string> string_intern_pool{{kTimelineKey, "timeline"}};
+  auto get_string_hash = [](const std::string& /*str*/) -> uint64_t { return 42; };
+
+  std::vector<GpuJob> gpu_jobs;
+  std::vector<GpuQueueSubmission> submissions;
+  for (uint64_t frame = 0; frame < num_frames; ++frame) {
+    const uint64_t pre_timestamp = 1'000'000'000 + frame * kFramePeriodNs;
+    gpu_jobs.push_back(CreateGpuJob(kTid, pre_timestamp + 10'000, pre_timestamp + 1'000'000,
+                                    pre_timestamp + 3'000'000));
+    submissions.push_back(CreateGpuQueueSubmission(kTid, pre_timestamp, pre_timestamp + 20'000,
+                                                   kCommandBuffersPerSubmission));
+  }
+
+  uint64_t num_lost_gpu_jobs = 0;
+  uint64_t num_lost_submissions = 0;
+  uint64_t num_timers = 0;
+  for (uint64_t frame = 0; frame < num_frames; ++frame) {
+    const bool lose_gpu_job = frame % kLostGpuJobsPeriod == 0;
+    const bool lose_submission = frame % kLostSubmissionsPeriod == kLostSubmissionsPeriod / 2;
+    num_lost_gpu_jobs += lose_gpu_job ? 1 : 0;
+    num_lost_submissions += lose_submission ? 1 : 0;
+    // Alternate which of the two arrives first.
+    for (int i = 0; i < 2; ++i) {
+      if ((i == 0) == (frame % 2 == 0)) {
+        if (!lose_gpu_job) {
+          num_timers +=
+              processor.ProcessGpuJob(gpu_jobs[frame], string_intern_pool, get_string_hash).size();
+        }
+      } else if (!lose_submission) {
+        num_timers += processor
+                          .ProcessGpuQueueSubmission(submissions[frame], string_intern_pool,
+                                                     get_string_hash)
+                          .size();
+      }
+    }
+  }
+
+  EXPECT_EQ(num_timers,
+            (num_frames - num_lost_gpu_jobs - num_lost_submissions) * kCommandBuffersPerSubmission);
+  EXPECT_EQ(processor.GetNumUnmatchedGpuQueueSubmissions(), num_lost_gpu_jobs);
+  EXPECT_EQ(processor.GetNumUnmatchedGpuJobs(), num_lost_submissions);
+}
+}  // namespace
+
+TEST(GpuQueueSubmissionProcessor, LongStreamWithLostEvents) {
+  // One minute.
+  ProcessStreamWithLostEvents(240 * 60);
+}
+
+}  // namespace orbit_capture_client
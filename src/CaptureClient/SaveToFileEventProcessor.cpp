@@ -2,11 +2,24 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <absl/synchronization/mutex.h>
+#include <absl/time/clock.h>
+#include <absl/time/time.h>
+#include <absl/types/span.h>
+
+#include <deque>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
 #include "CaptureClient/CaptureEventProcessor.h"
 #include "CaptureFile/CaptureFile.h"
 #include "CaptureFile/CaptureFileHelpers.h"
 #include "CaptureFile/CaptureFileOutputStream.h"
+#include "OrbitBase/Logging.h"
 #include "OrbitBase/MakeUniqueForOverwrite.h"
+#include "OrbitBase/ThreadUtils.h"
 #include "capture_data.pb.h"
 
 using orbit_capture_file::CaptureFileOutputStream;
@@ -17,16 +30,21 @@ namespace orbit_capture_client {
 
 namespace {
 
+// Events are serialized into batches of about this size, which are written to the file at once.
+constexpr size_t kBatchSizeBytes = 1024 * 1024;
+// At most this many batches wait to be written. When the file can't be written as fast as events
+// arrive, ProcessEvent waits for a batch to be written rather than using more memory.
+constexpr size_t kMaxNumQueuedBatches = 64;
+
+// Serializes the events on the thread that calls ProcessEvent and writes them to the file on a
+// dedicated thread, so that a slow disk doesn't stall the processing of the capture, as long as
+// the queue of batches is not full.
 class SaveToFileEventProcessor : public CaptureEventProcessor {
  public:
-  explicit SaveToFileEventProcessor(std::filesystem::path file_path,
-                                    std::function<void(const ErrorMessage&)> error_handler)
-      : file_path_{std::move(file_path)},
-        error_handler_{std::move(error_handler)},
-        state_{State::kProcessing} {}
-  ~SaveToFileEventProcessor() override = default;
-
-  ErrorMessageOr<void> Initialize();
+  explicit SaveToFileEventProcessor(std::unique_ptr<CaptureFileOutputStream> output_stream,
+                                    std::function<void(const ErrorMessage&)> error_handler);
+  ~SaveToFileEventProcessor() override;
+
   void ProcessEvent(const ClientCaptureEvent& event) override;
 
  private:
@@ -37,23 +55,50 @@ class SaveToFileEventProcessor : public CaptureEventProcessor {
   };
 
   void ReportError(const ErrorMessage& error);
+  // Queues the pending batch, waiting for a queued batch to be written if the queue is full.
+  void QueuePendingBatch();
+  // Lets the writer thread write the queued batches and close the stream, and waits for it.
+  void FinishWriting();
+  [[nodiscard]] std::optional<ErrorMessage> GetWriteError();
+  void LogBackPressure() const;
+  void WriteBatches();
+
+  [[nodiscard]] bool IsQueueNotFullOrWritingStopped() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return queued_batches_.size() < kMaxNumQueuedBatches || write_error_.has_value();
+  }
+  [[nodiscard]] bool HasBatchOrIsFinishing() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !queued_batches_.empty() || finishing_;
+  }
 
-  std::filesystem::path file_path_;
   std::function<void(const ErrorMessage&)> error_handler_;
+  State state_ = State::kProcessing;
+  std::string pending_batch_;
+  uint64_t num_back_pressure_waits_ = 0;
+  absl::Duration back_pressure_duration_ = absl::ZeroDuration();
+
+  absl::Mutex mutex_;
+  std::deque<std::string> queued_batches_ ABSL_GUARDED_BY(mutex_);
+  bool finishing_ ABSL_GUARDED_BY(mutex_) = false;
+  std::optional<ErrorMessage> write_error_ ABSL_GUARDED_BY(mutex_);
+
+  // Only used by the writer thread.
   std::unique_ptr<CaptureFileOutputStream> output_stream_;
-  State state_;
+  std::thread writer_thread_;
 };
 
-ErrorMessageOr<void> SaveToFileEventProcessor::Initialize() {
-  auto stream_or_error = CaptureFileOutputStream::Create(file_path_);
-  if (stream_or_error.has_error()) {
-    return ErrorMessage{absl::StrFormat("Failed to initialize CaptureSaveToFileProcessor: %s",
-                                        stream_or_error.error().message())};
-  }
-
-  output_stream_ = std::move(stream_or_error.value());
+SaveToFileEventProcessor::SaveToFileEventProcessor(
+    std::unique_ptr<CaptureFileOutputStream> output_stream,
+    std::function<void(const ErrorMessage&)> error_handler)
+    : error_handler_{std::move(error_handler)}, output_stream_{std::move(output_stream)} {
+  CHECK(output_stream_ != nullptr);
+  CHECK(output_stream_->IsOpen());
+  pending_batch_.reserve(kBatchSizeBytes);
+  writer_thread_ = std::thread{[this] { WriteBatches(); }};
+}
 
-  return outcome::success();
+SaveToFileEventProcessor::~SaveToFileEventProcessor() {
+  // The events processed so far are written even if the capture didn't finish.
+  if (writer_thread_.joinable()) FinishWriting();
 }
 
 void SaveToFileEventProcessor::ReportError(const ErrorMessage& error) {
@@ -62,8 +107,6 @@ void SaveToFileEventProcessor::ReportError(const ErrorMessage& error) {
 }
 
 void SaveToFileEventProcessor::ProcessEvent(const ClientCaptureEvent& event) {
-  CHECK(output_stream_ != nullptr);
-
   if (state_ == State::kCaptureFinished) {
     ReportError(ErrorMessage{"Unexpected event after CaptureFinished event"});
     return;
@@ -71,23 +114,101 @@ void SaveToFileEventProcessor::ProcessEvent(const ClientCaptureEvent& event) {
 
   if (state_ == State::kErrorReported) return;
 
-  CHECK(output_stream_->IsOpen());
+  pending_batch_.append(orbit_capture_file::SerializeCaptureEvents(absl::MakeConstSpan(&event, 1)));
 
-  auto write_result = output_stream_->WriteCaptureEvent(event);
-  if (write_result.has_error()) {
-    ReportError(write_result.error());
+  if (event.event_case() == ClientCaptureEvent::kCaptureFinished) {
+    // We are done - wait for the file to be written and closed, so that a write error is reported
+    // before the capture ends.
+    FinishWriting();
+    LogBackPressure();
+    if (std::optional<ErrorMessage> write_error = GetWriteError(); write_error.has_value()) {
+      ReportError(write_error.value());
+      return;
+    }
+
+    state_ = State::kCaptureFinished;
     return;
   }
 
-  if (event.event_case() == ClientCaptureEvent::kCaptureFinished) {
-    // We are done - close the stream.
-    auto close_result = output_stream_->Close();
-    if (close_result.has_error()) {
-      ReportError(close_result.error());
+  if (pending_batch_.size() >= kBatchSizeBytes) {
+    QueuePendingBatch();
+    if (std::optional<ErrorMessage> write_error = GetWriteError(); write_error.has_value()) {
+      ReportError(write_error.value());
+    }
+  }
+}
+
+void SaveToFileEventProcessor::QueuePendingBatch() {
+  absl::MutexLock lock(&mutex_);
+  if (!IsQueueNotFullOrWritingStopped()) {
+    if (num_back_pressure_waits_ == 0) {
+      LOG("Writing the capture file can't keep up with the capture, processing waits for it");
+    }
+    ++num_back_pressure_waits_;
+    const absl::Time wait_start = absl::Now();
+    mutex_.Await(absl::Condition(this, &SaveToFileEventProcessor::IsQueueNotFullOrWritingStopped));
+    back_pressure_duration_ += absl::Now() - wait_start;
+  }
+
+  if (write_error_.has_value()) {
+    pending_batch_.clear();
+    return;
+  }
+  queued_batches_.push_back(std::move(pending_batch_));
+  pending_batch_ = std::string{};
+  pending_batch_.reserve(kBatchSizeBytes);
+}
+
+void SaveToFileEventProcessor::FinishWriting() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (!pending_batch_.empty() && !write_error_.has_value()) {
+      // The batches already queued are written first, so the queue may exceed its size here.
+      queued_batches_.push_back(std::move(pending_batch_));
+    }
+    pending_batch_.clear();
+    finishing_ = true;
+  }
+  writer_thread_.join();
+}
+
+std::optional<ErrorMessage> SaveToFileEventProcessor::GetWriteError() {
+  absl::MutexLock lock(&mutex_);
+  return write_error_;
+}
+
+void SaveToFileEventProcessor::LogBackPressure() const {
+  if (num_back_pressure_waits_ == 0) return;
+  LOG("Capture processing waited %u times, for %s in total, for the capture file to be written",
+      num_back_pressure_waits_, absl::FormatDuration(back_pressure_duration_));
+}
+
+void SaveToFileEventProcessor::WriteBatches() {
+  orbit_base::SetCurrentThreadName("SaveToFileWrite");
+  while (true) {
+    std::string batch;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &SaveToFileEventProcessor::HasBatchOrIsFinishing));
+      if (queued_batches_.empty()) break;
+      batch = std::move(queued_batches_.front());
+      queued_batches_.pop_front();
+    }
+
+    // The stream closes itself and removes the file on error.
+    auto write_result = output_stream_->WriteSerializedCaptureEvents(batch);
+    if (write_result.has_error()) {
+      absl::MutexLock lock(&mutex_);
+      write_error_ = write_result.error();
+      queued_batches_.clear();
       return;
     }
+  }
 
-    state_ = State::kCaptureFinished;
+  auto close_result = output_stream_->Close();
+  if (close_result.has_error()) {
+    absl::MutexLock lock(&mutex_);
+    write_error_ = close_result.error();
   }
 }
 
@@ -97,13 +218,20 @@ ErrorMessageOr<std::unique_ptr<CaptureEventProcessor>>
 CaptureEventProcessor::CreateSaveToFileProcessor(
     const std::filesystem::path& file_path,
     std::function<void(const ErrorMessage&)> error_handler) {
-  auto processor = std::make_unique<SaveToFileEventProcessor>(file_path, std::move(error_handler));
-  auto init_or_error = processor->Initialize();
-  if (init_or_error.has_error()) {
-    return init_or_error.error();
+  auto stream_or_error = CaptureFileOutputStream::Create(file_path);
+  if (stream_or_error.has_error()) {
+    return ErrorMessage{absl::StrFormat("Failed to initialize CaptureSaveToFileProcessor: %s",
+                                        stream_or_error.error().message())};
   }
 
-  return processor;
+  return CreateSaveToFileProcessor(std::move(stream_or_error.value()), std::move(error_handler));
+}
+
+std::unique_ptr<CaptureEventProcessor> CaptureEventProcessor::CreateSaveToFileProcessor(
+    std::unique_ptr<CaptureFileOutputStream> output_stream,
+    std::function<void(const ErrorMessage&)> error_handler) {
+  return std::make_unique<SaveToFileEventProcessor>(std::move(output_stream),
+                                                    std::move(error_handler));
 }
 
 }  // namespace orbit_capture_client
@@ -3,13 +3,21 @@
 // found in the LICENSE file.
 
 #include <absl/container/flat_hash_set.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
 #include <gtest/gtest.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "CaptureClient/CaptureEventProcessor.h"
 #include "CaptureFile/CaptureFile.h"
+#include "CaptureFile/CaptureFileOutputStream.h"
+#include "OrbitBase/Logging.h"
 #include "OrbitBase/Result.h"
 #include "OrbitBase/TemporaryFile.h"
 #include "OrbitBase/TestUtils.h"
@@ -20,6 +28,7 @@ using orbit_base::HasNoError;
 using orbit_base::HasValue;
 using orbit_base::TemporaryFile;
 using orbit_capture_file::CaptureFile;
+using orbit_capture_file::CaptureFileOutputStream;
 using orbit_grpc_protos::CaptureFinished;
 using orbit_grpc_protos::ClientCaptureEvent;
 
@@ -37,6 +46,58 @@ static ClientCaptureEvent CreateCaptureFinishedEvent() {
   return event;
 }
 
+namespace {
+
+// Records what is written. Writes can be blocked until a notification, like on a slow disk, or
+// fail.
+class FakeCaptureFileOutputStream : public CaptureFileOutputStream {
+ public:
+  ErrorMessageOr<void> WriteCaptureEvent(const ClientCaptureEvent& /*event*/) override {
+    ADD_FAILURE() << "Events are expected to be written in batches";
+    return outcome::success();
+  }
+  ErrorMessageOr<void> WriteSerializedCaptureEvents(std::string_view serialized_events) override {
+    CHECK(is_open_);
+    if (writes_allowed_ != nullptr) writes_allowed_->WaitForNotification();
+    if (fail_writes_) {
+      is_open_ = false;
+      return ErrorMessage{"Write failed"};
+    }
+    absl::MutexLock lock(&mutex_);
+    written_data_.append(serialized_events);
+    ++num_writes_;
+    return outcome::success();
+  }
+  ErrorMessageOr<void> Close() noexcept override {
+    is_open_ = false;
+    return outcome::success();
+  }
+  bool IsOpen() noexcept override { return is_open_; }
+
+  [[nodiscard]] std::string GetWrittenData() const {
+    absl::MutexLock lock(&mutex_);
+    return written_data_;
+  }
+  [[nodiscard]] size_t GetNumWrites() const {
+    absl::MutexLock lock(&mutex_);
+    return num_writes_;
+  }
+
+  void FailWrites() { fail_writes_ = true; }
+  // Must be called before the first write.
+  void BlockWritesUntil(absl::Notification* writes_allowed) { writes_allowed_ = writes_allowed; }
+
+ private:
+  absl::Notification* writes_allowed_ = nullptr;
+  std::atomic<bool> is_open_{true};
+  std::atomic<bool> fail_writes_{false};
+  mutable absl::Mutex mutex_;
+  std::string written_data_ ABSL_GUARDED_BY(mutex_);
+  size_t num_writes_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace
+
 TEST(SaveToFileEventProcessor, SaveAndLoadSimpleCapture) {
   auto temporary_file_or_error = TemporaryFile::Create();
   ASSERT_TRUE(temporary_file_or_error.has_value()) << temporary_file_or_error.error().message();
@@ -106,4 +167,60 @@ TEST(SaveToFileEventProcessor, SaveAndLoadSimpleCapture) {
   EXPECT_FALSE(user_data_section.has_value());
 }
 
-}  // namespace orbit_capture_client
\ No newline at end of file
+TEST(SaveToFileEventProcessor, BlockedOutputStreamDoesNotBlockEventProcessing) {
+  absl::Notification writes_allowed;
+  auto output_stream = std::make_unique<FakeCaptureFileOutputStream>();
+  output_stream->BlockWritesUntil(&writes_allowed);
+  FakeCaptureFileOutputStream* output_stream_ptr = output_stream.get();
+  auto error_handler = [](const ErrorMessage& error) { FAIL() << error.message(); };
+  std::unique_ptr<CaptureEventProcessor> capture_event_processor =
+      CaptureEventProcessor::CreateSaveToFileProcessor(std::move(output_stream), error_handler);
+
+  // About 4 MiB of events, which are written in several batches.
+  const std::string intern(1024, 'a');
+  std::vector<ClientCaptureEvent> events;
+  for (uint64_t key = 0; key < 4 * 1024; ++key) {
+    events.push_back(CreateInternedStringEvent(key, intern.c_str()));
+  }
+
+  for (const ClientCaptureEvent& event : events) {
+    capture_event_processor->ProcessEvent(event);
+  }
+  // All the events were processed while no batch could be written.
+  EXPECT_EQ(output_stream_ptr->GetNumWrites(), 0);
+  EXPECT_TRUE(output_stream_ptr->IsOpen());
+
+  // Finishing the capture waits for all the batches to be written.
+  writes_allowed.Notify();
+  ClientCaptureEvent capture_finished = CreateCaptureFinishedEvent();
+  capture_event_processor->ProcessEvent(capture_finished);
+  EXPECT_FALSE(output_stream_ptr->IsOpen());
+  EXPECT_GT(output_stream_ptr->GetNumWrites(), 1);
+
+  events.push_back(capture_finished);
+  EXPECT_EQ(output_stream_ptr->GetWrittenData(),
+            orbit_capture_file::SerializeCaptureEvents(events));
+}
+
+TEST(SaveToFileEventProcessor, WriteErrorIsReportedOnce) {
+  auto output_stream = std::make_unique<FakeCaptureFileOutputStream>();
+  output_stream->FailWrites();
+  int num_errors = 0;
+  auto error_handler = [&num_errors](const ErrorMessage& error) {
+    EXPECT_EQ(error.message(), "Write failed");
+    ++num_errors;
+  };
+  std::unique_ptr<CaptureEventProcessor> capture_event_processor =
+      CaptureEventProcessor::CreateSaveToFileProcessor(std::move(output_stream), error_handler);
+
+  const std::string intern(1024, 'a');
+  for (uint64_t key = 0; key < 4 * 1024; ++key) {
+    capture_event_processor->ProcessEvent(CreateInternedStringEvent(key, intern.c_str()));
+  }
+  capture_event_processor->ProcessEvent(CreateCaptureFinishedEvent());
+  capture_event_processor.reset();
+
+  EXPECT_EQ(num_errors, 1);
+}
+
+}  // namespace orbit_capture_client
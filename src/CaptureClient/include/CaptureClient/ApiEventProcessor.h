@@ -7,6 +7,9 @@
 
 #include <absl/container/flat_hash_map.h>
 
+#include <string>
+#include <vector>
+
 #include "Api/EncodedEvent.h"
 #include "CaptureClient/CaptureListener.h"
 #include "capture.pb.h"
@@ -18,10 +21,13 @@ namespace orbit_capture_client {
 // is maintained to cache "start" events until a corresponding "stop" event is received. The pair
 // is then used to create a single TimerInfo object. "Tracking" events don't need to be cached
 // however, they are translated to TImerInfo objects that are directly passed to the listener.
+// Synchronous scopes are usually already paired by the service and arrive as ApiScopes, only
+// unmatched start and stop events arrive as ApiEvents.
 class ApiEventProcessor {
  public:
   explicit ApiEventProcessor(CaptureListener* listener);
   void ProcessApiEvent(const orbit_grpc_protos::ApiEvent& event_buffer);
+  void ProcessApiScope(const orbit_grpc_protos::ApiScope& api_scope, const std::string& name);
 
  private:
   void ProcessApiEvent(const orbit_api::ApiEvent& api_event);
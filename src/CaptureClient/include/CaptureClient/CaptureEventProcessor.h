@@ -9,9 +9,11 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "CaptureClient/CaptureListener.h"
+#include "CaptureFile/CaptureFileOutputStream.h"
 #include "capture.pb.h"
 
 namespace orbit_capture_client {
@@ -27,9 +29,14 @@ class CaptureEventProcessor {
       CaptureListener* capture_listener, std::optional<std::filesystem::path> file_path,
       absl::flat_hash_set<uint64_t> frame_track_function_ids);
 
+  // The returned processor writes the events to the file on a separate thread. `error_handler` is
+  // called on the thread that calls ProcessEvent.
   static ErrorMessageOr<std::unique_ptr<CaptureEventProcessor>> CreateSaveToFileProcessor(
       const std::filesystem::path& file_path,
       std::function<void(const ErrorMessage&)> error_handler);
+  static std::unique_ptr<CaptureEventProcessor> CreateSaveToFileProcessor(
+      std::unique_ptr<orbit_capture_file::CaptureFileOutputStream> output_stream,
+      std::function<void(const ErrorMessage&)> error_handler);
 
   static std::unique_ptr<CaptureEventProcessor> CreateCompositeProcessor(
       std::vector<std::unique_ptr<CaptureEventProcessor>> event_processors);
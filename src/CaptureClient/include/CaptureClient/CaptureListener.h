@@ -52,6 +52,8 @@ class CaptureListener {
       orbit_grpc_protos::LostPerfRecordsEvent lost_perf_records_event) = 0;
   virtual void OnOutOfOrderEventsDiscardedEvent(
       orbit_grpc_protos::OutOfOrderEventsDiscardedEvent out_of_order_events_discarded_event) = 0;
+  virtual void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) = 0;
 };
 
 }  // namespace orbit_capture_client
@@ -6,10 +6,14 @@
 #define CAPTURE_CLIENT_GPU_QUEUE_SUBMISSION_PROCESSOR_H_
 
 #include <absl/container/flat_hash_map.h>
-#include <absl/container/node_hash_map.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <deque>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -31,8 +35,20 @@ namespace orbit_capture_client {
 // Worth mentioning is the case of debug markers, where the "begin" marker originates from a
 // different submission than the "end" marker. In this case we store the "begin" marker's
 // `GpuQueueSubmission` and `GpuJob` until we have processed all corresponding "end" markers.
+//
+// Only the few fields needed for matching are stored, in time-ordered queues per thread, and a
+// whole `GpuQueueSubmission` only while it waits for its `GpuJob`. As either side can be missing
+// (`GpuJob`s are recorded for all processes, and events can be lost), whatever was stored for
+// longer than `max_unmatched_age_ns` is evicted, so that memory does not grow with the capture.
+// Only what is needed for the "end" of debug markers is kept for longer, until they end.
 class GpuQueueSubmissionProcessor {
  public:
+  static constexpr uint64_t kDefaultMaxUnmatchedAgeNs = 10ULL * 1000 * 1000 * 1000;
+
+  GpuQueueSubmissionProcessor() = default;
+  explicit GpuQueueSubmissionProcessor(uint64_t max_unmatched_age_ns)
+      : max_unmatched_age_ns_{max_unmatched_age_ns} {}
+
   // If the matching `GpuJob` has already been processed, it converts the command buffer and debug
   // marker information from the `GpuQueueSubmission` event into `TimerInfo`s. Otherwise, it
   // returns an empty vector and stores the submission for later processing.
@@ -59,18 +75,53 @@ class GpuQueueSubmissionProcessor {
     begin_capture_time_ns_ = std::min(begin_capture_time_ns_, timestamp);
   }
 
+  // The number of `GpuQueueSubmission`s for which no `GpuJob` was found, either because they were
+  // evicted, or because they are still waiting for it. Their timers are missing from the capture.
+  [[nodiscard]] uint64_t GetNumUnmatchedGpuQueueSubmissions() const;
+  // The same for `GpuJob`s, which is expected for the jobs of processes not using Vulkan.
+  [[nodiscard]] uint64_t GetNumUnmatchedGpuJobs() const;
+  // The latest CPU timestamp of all the `GpuJob`s and `GpuQueueSubmission`s processed.
+  [[nodiscard]] uint64_t GetLatestTimestampNs() const { return latest_timestamp_ns_; }
+
  private:
+  // The fields of a `GpuJob` that are needed to process its `GpuQueueSubmission`.
+  struct GpuJobInfo {
+    // The amdgpu_cs_ioctl_time_ns, by which the jobs of a thread are ordered.
+    uint64_t timestamp_ns = 0;
+    uint64_t gpu_hardware_start_time_ns = 0;
+    uint64_t timeline_key = 0;
+    int32_t depth = 0;
+    // A matched job is only kept while its submission has unprocessed "begin" markers.
+    bool matched = false;
+  };
+
+  // The fields of a `GpuQueueSubmission` that are needed to match it and to process the "end"
+  // markers of the debug markers it begins.
+  struct GpuQueueSubmissionInfo {
+    // The post_submission_cpu_timestamp, by which the submissions of a thread are ordered.
+    uint64_t timestamp_ns = 0;
+    uint64_t pre_submission_cpu_timestamp = 0;
+    std::optional<uint64_t> first_command_buffer_begin_gpu_timestamp_ns;
+    uint32_t num_unprocessed_begin_markers = 0;
+    // The whole submission, only kept until the matching `GpuJob` is processed.
+    std::unique_ptr<orbit_grpc_protos::GpuQueueSubmission> waiting_for_gpu_job;
+  };
+
+  // Evicts what was stored for longer than `max_unmatched_age_ns_` before `timestamp_ns`, which
+  // is the time of the event being processed.
+  void EvictOldInfos(uint64_t timestamp_ns);
+
   [[nodiscard]] std::vector<orbit_client_protos::TimerInfo>
   ProcessGpuQueueSubmissionWithMatchingGpuJob(
       const orbit_grpc_protos::GpuQueueSubmission& gpu_queue_submission,
-      const orbit_grpc_protos::GpuJob& matching_gpu_job,
+      const GpuJobInfo& matching_gpu_job,
       const absl::flat_hash_map<uint64_t, std::string>& string_intern_pool,
       const std::function<uint64_t(const std::string& str)>&
           get_string_hash_and_send_to_listener_if_necessary);
 
   [[nodiscard]] std::vector<orbit_client_protos::TimerInfo> ProcessGpuCommandBuffers(
       const orbit_grpc_protos::GpuQueueSubmission& gpu_queue_submission,
-      const orbit_grpc_protos::GpuJob& matching_gpu_job,
+      const GpuJobInfo& matching_gpu_job,
       const std::optional<orbit_grpc_protos::GpuCommandBuffer>& first_command_buffer,
       uint64_t timeline_hash,
       const std::function<uint64_t(const std::string& str)>&
@@ -78,7 +129,7 @@ class GpuQueueSubmissionProcessor {
 
   [[nodiscard]] std::vector<orbit_client_protos::TimerInfo> ProcessGpuDebugMarkers(
       const orbit_grpc_protos::GpuQueueSubmission& gpu_queue_submission,
-      const orbit_grpc_protos::GpuJob& matching_gpu_job,
+      const GpuJobInfo& matching_gpu_job,
       const std::optional<orbit_grpc_protos::GpuCommandBuffer>& first_command_buffer);
 
   [[nodiscard]] static std::optional<orbit_grpc_protos::GpuCommandBuffer> ExtractFirstCommandBuffer(
@@ -86,14 +137,14 @@ class GpuQueueSubmissionProcessor {
 
   // Finds the GpuJob that is fully inside the given timestamps and happened on the given thread id.
   // Returns `nullptr` if there is no such job.
-  [[nodiscard]] const orbit_grpc_protos::GpuJob* FindMatchingGpuJob(
-      int32_t thread_id, uint64_t pre_submission_cpu_timestamp,
-      uint64_t post_submission_cpu_timestamp);
+  [[nodiscard]] GpuJobInfo* FindMatchingGpuJob(int32_t thread_id,
+                                               uint64_t pre_submission_cpu_timestamp,
+                                               uint64_t post_submission_cpu_timestamp);
 
   // Finds the GpuQueueSubmission that fully contains the given timestamp and happened on the given
   // thread id. Returns `nullptr` if there is no such submission.
-  [[nodiscard]] const orbit_grpc_protos::GpuQueueSubmission* FindMatchingGpuQueueSubmission(
-      int32_t thread_id, uint64_t submit_time);
+  [[nodiscard]] GpuQueueSubmissionInfo* FindMatchingGpuQueueSubmission(int32_t thread_id,
+                                                                       uint64_t submit_time);
 
   [[nodiscard]] bool HasUnprocessedBeginMarkers(int32_t thread_id,
                                                 uint64_t post_submission_timestamp) const;
@@ -105,12 +156,17 @@ class GpuQueueSubmissionProcessor {
 
   void DeleteSavedGpuSubmission(int32_t thread_id, uint64_t post_submission_timestamp);
 
-  absl::node_hash_map<int32_t, std::map<uint64_t, orbit_grpc_protos::GpuJob>>
-      tid_to_submission_time_to_gpu_job_;
-  absl::node_hash_map<int32_t, std::map<uint64_t, orbit_grpc_protos::GpuQueueSubmission>>
-      tid_to_post_submission_time_to_gpu_submission_;
-  absl::flat_hash_map<int32_t, absl::flat_hash_map<uint64_t, uint32_t>>
-      tid_to_post_submission_time_to_num_begin_markers_;
+  // Ordered by `GpuJobInfo::timestamp_ns` and `GpuQueueSubmissionInfo::timestamp_ns`. As events
+  // mostly arrive in order, and are matched soon, insertions and removals mostly happen at the
+  // ends of the queues.
+  absl::flat_hash_map<int32_t, std::deque<GpuJobInfo>> tid_to_gpu_jobs_;
+  absl::flat_hash_map<int32_t, std::deque<GpuQueueSubmissionInfo>> tid_to_gpu_queue_submissions_;
+
+  uint64_t max_unmatched_age_ns_ = kDefaultMaxUnmatchedAgeNs;
+  uint64_t latest_timestamp_ns_ = 0;
+  uint64_t next_eviction_timestamp_ns_ = 0;
+  uint64_t num_evicted_unmatched_gpu_jobs_ = 0;
+  uint64_t num_evicted_unmatched_gpu_queue_submissions_ = 0;
 
   uint64_t begin_capture_time_ns_ = std::numeric_limits<uint64_t>::max();
 };
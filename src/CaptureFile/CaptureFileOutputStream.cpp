@@ -7,12 +7,15 @@
 #include <absl/base/casts.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "CaptureFileConstants.h"
 #include "OrbitBase/File.h"
+#include "OrbitBase/Future.h"
 #include "OrbitBase/Logging.h"
 #include "OrbitBase/SafeStrerror.h"
 
@@ -20,6 +23,10 @@ namespace orbit_capture_file {
 
 namespace {
 
+// The capture section is written to the file in blocks of this size, rather than protobuf's default
+// of 8 KiB, so that writing a large capture takes few system calls.
+constexpr int kFileOutputBlockSize = 256 * 1024;
+
 class CaptureFileOutputStreamImpl final : public CaptureFileOutputStream {
  public:
   explicit CaptureFileOutputStreamImpl(std::filesystem::path path) : path_{std::move(path)} {}
@@ -28,6 +35,8 @@ class CaptureFileOutputStreamImpl final : public CaptureFileOutputStream {
   [[nodiscard]] ErrorMessageOr<void> Initialize();
   [[nodiscard]] ErrorMessageOr<void> WriteCaptureEvent(
       const orbit_grpc_protos::ClientCaptureEvent& event) override;
+  [[nodiscard]] ErrorMessageOr<void> WriteSerializedCaptureEvents(
+      std::string_view serialized_events) override;
   [[nodiscard]] ErrorMessageOr<void> Close() noexcept override;
   [[nodiscard]] bool IsOpen() noexcept override;
 
@@ -117,6 +126,19 @@ ErrorMessageOr<void> CaptureFileOutputStreamImpl::WriteCaptureEvent(
   return outcome::success();
 }
 
+ErrorMessageOr<void> CaptureFileOutputStreamImpl::WriteSerializedCaptureEvents(
+    std::string_view serialized_events) {
+  CHECK(coded_output_.has_value());
+  CHECK(file_output_stream_.has_value());
+  coded_output_->WriteRaw(serialized_events.data(), static_cast<int>(serialized_events.size()));
+
+  if (coded_output_->HadError()) {
+    return HandleWriteError("Capture", SafeStrerror(file_output_stream_->GetErrno()));
+  }
+
+  return outcome::success();
+}
+
 ErrorMessageOr<void> CaptureFileOutputStreamImpl::WriteHeader() {
   CHECK(fd_.valid());
 
@@ -142,7 +164,7 @@ ErrorMessageOr<void> CaptureFileOutputStreamImpl::WriteHeader() {
   }
 
   // Prepare the protobuf stream to use to write to capture section.
-  file_output_stream_.emplace(fd_.get());
+  file_output_stream_.emplace(fd_.get(), kFileOutputBlockSize);
   coded_output_.emplace(&file_output_stream_.value());
 
   return outcome::success();
@@ -150,6 +172,40 @@ ErrorMessageOr<void> CaptureFileOutputStreamImpl::WriteHeader() {
 
 }  // namespace
 
+std::string SerializeCaptureEvents(absl::Span<const orbit_grpc_protos::ClientCaptureEvent> events) {
+  std::string serialized_events;
+  {
+    google::protobuf::io::StringOutputStream string_output_stream(&serialized_events);
+    google::protobuf::io::CodedOutputStream coded_output(&string_output_stream);
+    for (const orbit_grpc_protos::ClientCaptureEvent& event : events) {
+      coded_output.WriteVarint32(event.ByteSizeLong());
+      event.SerializeWithCachedSizes(&coded_output);
+    }
+  }
+  return serialized_events;
+}
+
+std::vector<std::string> SerializeCaptureEventsInParallel(
+    absl::Span<const orbit_grpc_protos::ClientCaptureEvent> events, ThreadPool* thread_pool,
+    size_t num_events_per_chunk) {
+  CHECK(thread_pool != nullptr);
+  CHECK(num_events_per_chunk > 0);
+  std::vector<orbit_base::Future<std::string>> serialized_chunk_futures;
+  for (size_t chunk_begin = 0; chunk_begin < events.size(); chunk_begin += num_events_per_chunk) {
+    absl::Span<const orbit_grpc_protos::ClientCaptureEvent> chunk =
+        events.subspan(chunk_begin, num_events_per_chunk);
+    serialized_chunk_futures.emplace_back(
+        thread_pool->Schedule([chunk] { return SerializeCaptureEvents(chunk); }));
+  }
+
+  std::vector<std::string> serialized_chunks;
+  serialized_chunks.reserve(serialized_chunk_futures.size());
+  for (orbit_base::Future<std::string>& serialized_chunk : serialized_chunk_futures) {
+    serialized_chunks.push_back(serialized_chunk.Get());
+  }
+  return serialized_chunks;
+}
+
 ErrorMessageOr<std::unique_ptr<CaptureFileOutputStream>> CaptureFileOutputStream::Create(
     std::filesystem::path path) {
   auto implementation = std::make_unique<CaptureFileOutputStreamImpl>(std::move(path));
@@ -2,14 +2,22 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_join.h>
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <gtest/gtest.h>
 #include <stdint.h>
 
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "CaptureFile/CaptureFileOutputStream.h"
 #include "CaptureFileConstants.h"
 #include "OrbitBase/ReadFileToString.h"
 #include "OrbitBase/TemporaryFile.h"
+#include "OrbitBase/ThreadPool.h"
 
 namespace orbit_capture_file {
 
@@ -120,4 +128,123 @@ TEST(CaptureFileOutputStream, WriteAfterClose) {
   EXPECT_DEATH((void)output_stream->WriteCaptureEvent(event), "");
 }
 
-}  // namespace orbit_capture_file
\ No newline at end of file
+static std::string WriteCaptureFileAndReadContent(
+    const std::function<ErrorMessageOr<void>(CaptureFileOutputStream*)>& write_events) {
+  auto temporary_file_or_error = orbit_base::TemporaryFile::Create();
+  EXPECT_TRUE(temporary_file_or_error.has_value()) << temporary_file_or_error.error().message();
+  orbit_base::TemporaryFile temporary_file = std::move(temporary_file_or_error.value());
+  temporary_file.CloseAndRemove();
+
+  auto output_stream_or_error = CaptureFileOutputStream::Create(temporary_file.file_path());
+  EXPECT_TRUE(output_stream_or_error.has_value()) << output_stream_or_error.error().message();
+  std::unique_ptr<CaptureFileOutputStream> output_stream =
+      std::move(output_stream_or_error.value());
+
+  auto write_result = write_events(output_stream.get());
+  EXPECT_FALSE(write_result.has_error()) << write_result.error().message();
+  auto close_result = output_stream->Close();
+  EXPECT_FALSE(close_result.has_error()) << close_result.error().message();
+
+  ErrorMessageOr<std::string> file_content_or_error =
+      orbit_base::ReadFileToString(temporary_file.file_path());
+  EXPECT_TRUE(file_content_or_error.has_value()) << file_content_or_error.error().message();
+  return file_content_or_error.value();
+}
+
+TEST(CaptureFileOutputStream, WriteSerializedCaptureEventsMatchesWriteCaptureEvent) {
+  std::vector<orbit_grpc_protos::ClientCaptureEvent> events = {
+      CreateInternedStringCaptureEvent(kAnswerKey, kAnswerString),
+      CreateInternedStringCaptureEvent(kNotAnAnswerKey, kNotAnAnswerString)};
+
+  const std::string content_of_single_events =
+      WriteCaptureFileAndReadContent(
+          [&events](CaptureFileOutputStream* output_stream) -> ErrorMessageOr<void> {
+            for (const orbit_grpc_protos::ClientCaptureEvent& event : events) {
+              auto write_result = output_stream->WriteCaptureEvent(event);
+              if (write_result.has_error()) return write_result.error();
+            }
+            return outcome::success();
+          });
+
+  const std::string content_of_serialized_events =
+      WriteCaptureFileAndReadContent([&events](CaptureFileOutputStream* output_stream) {
+        return output_stream->WriteSerializedCaptureEvents(SerializeCaptureEvents(events));
+      });
+
+  EXPECT_FALSE(content_of_single_events.empty());
+  EXPECT_EQ(content_of_single_events, content_of_serialized_events);
+}
+
+TEST(CaptureFileOutputStream, SerializeCaptureEventsOfConsecutiveRanges) {
+  std::vector<orbit_grpc_protos::ClientCaptureEvent> events = {
+      CreateInternedStringCaptureEvent(kAnswerKey, kAnswerString),
+      CreateInternedStringCaptureEvent(kNotAnAnswerKey, kNotAnAnswerString),
+      CreateInternedStringCaptureEvent(kAnswerKey + 2, kAnswerString)};
+  absl::Span<const orbit_grpc_protos::ClientCaptureEvent> all_events(events);
+
+  EXPECT_EQ(SerializeCaptureEvents({}), "");
+  EXPECT_EQ(SerializeCaptureEvents(all_events),
+            SerializeCaptureEvents(all_events.subspan(0, 1)) +
+                SerializeCaptureEvents(all_events.subspan(1)));
+}
+
+TEST(CaptureFileOutputStream, SerializeCaptureEventsInParallelMatchesSerializeCaptureEvents) {
+  // Interned strings and scheduling slices, spanning several chunks with a partial last one.
+  constexpr size_t kNumEvents = 10'000;
+  constexpr size_t kNumEventsPerChunk = 1'000 - 1;
+  std::vector<orbit_grpc_protos::ClientCaptureEvent> events;
+  events.reserve(kNumEvents);
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    if (i % 10 == 0) {
+      events.emplace_back(CreateInternedStringCaptureEvent(i, absl::StrCat("string ", i)));
+      continue;
+    }
+    orbit_grpc_protos::SchedulingSlice* scheduling_slice =
+        events.emplace_back().mutable_scheduling_slice();
+    scheduling_slice->set_pid(static_cast<int32_t>(i % 7));
+    scheduling_slice->set_tid(static_cast<int32_t>(i % 31));
+    scheduling_slice->set_core(static_cast<int32_t>(i % 8));
+    scheduling_slice->set_duration_ns(i % 1000);
+    scheduling_slice->set_out_timestamp_ns(1'000'000'000 + i * 100);
+  }
+
+  std::shared_ptr<ThreadPool> thread_pool =
+      ThreadPool::Create(/*thread_pool_min_size=*/4, /*thread_pool_max_size=*/4,
+                         /*thread_ttl=*/absl::Seconds(1));
+  std::vector<std::string> serialized_chunks =
+      SerializeCaptureEventsInParallel(events, thread_pool.get(), kNumEventsPerChunk);
+  thread_pool->ShutdownAndWait();
+
+  EXPECT_EQ(serialized_chunks.size(), (kNumEvents + kNumEventsPerChunk - 1) / kNumEventsPerChunk);
+  EXPECT_EQ(absl::StrJoin(serialized_chunks, ""), SerializeCaptureEvents(events));
+
+  const std::string content_of_single_events =
+      WriteCaptureFileAndReadContent(
+          [&events](CaptureFileOutputStream* output_stream) -> ErrorMessageOr<void> {
+            for (const orbit_grpc_protos::ClientCaptureEvent& event : events) {
+              auto write_result = output_stream->WriteCaptureEvent(event);
+              if (write_result.has_error()) return write_result.error();
+            }
+            return outcome::success();
+          });
+  const std::string content_of_serialized_chunks =
+      WriteCaptureFileAndReadContent(
+          [&serialized_chunks](CaptureFileOutputStream* output_stream) -> ErrorMessageOr<void> {
+            for (const std::string& serialized_chunk : serialized_chunks) {
+              auto write_result = output_stream->WriteSerializedCaptureEvents(serialized_chunk);
+              if (write_result.has_error()) return write_result.error();
+            }
+            return outcome::success();
+          });
+  EXPECT_EQ(content_of_single_events, content_of_serialized_chunks);
+}
+
+TEST(CaptureFileOutputStream, SerializeCaptureEventsInParallelOfNoEvents) {
+  std::shared_ptr<ThreadPool> thread_pool =
+      ThreadPool::Create(/*thread_pool_min_size=*/1, /*thread_pool_max_size=*/1,
+                         /*thread_ttl=*/absl::Seconds(1));
+  EXPECT_TRUE(SerializeCaptureEventsInParallel({}, thread_pool.get()).empty());
+  thread_pool->ShutdownAndWait();
+}
+
+}  // namespace orbit_capture_file
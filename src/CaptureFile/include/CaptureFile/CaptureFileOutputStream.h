@@ -5,12 +5,17 @@
 #ifndef CAPTURE_FILE_CAPTURE_FILE_OUTPUT_STREAM_H_
 #define CAPTURE_FILE_CAPTURE_FILE_OUTPUT_STREAM_H_
 
+#include <absl/types/span.h>
 #include <google/protobuf/message.h>
 
 #include <filesystem>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "OrbitBase/Result.h"
+#include "OrbitBase/ThreadPool.h"
 #include "capture.pb.h"
 
 namespace orbit_capture_file {
@@ -46,6 +51,10 @@ class CaptureFileOutputStream {
   virtual ~CaptureFileOutputStream() noexcept = default;
   [[nodiscard]] virtual ErrorMessageOr<void> WriteCaptureEvent(
       const orbit_grpc_protos::ClientCaptureEvent& event) = 0;
+  // Writes events serialized with SerializeCaptureEvents. The same errors as for WriteCaptureEvent
+  // apply.
+  [[nodiscard]] virtual ErrorMessageOr<void> WriteSerializedCaptureEvents(
+      std::string_view serialized_events) = 0;
   virtual ErrorMessageOr<void> Close() noexcept = 0;
 
   [[nodiscard]] virtual bool IsOpen() noexcept = 0;
@@ -56,6 +65,20 @@ class CaptureFileOutputStream {
       std::filesystem::path path);
 };
 
+// Serializes `events` in the format of the capture section: each event is preceded by its size as a
+// varint32. Concatenating the serializations of consecutive ranges of events is the same as
+// serializing the whole range, so events can be serialized in batches and written later on.
+[[nodiscard]] std::string SerializeCaptureEvents(
+    absl::Span<const orbit_grpc_protos::ClientCaptureEvent> events);
+
+// Same as SerializeCaptureEvents, but serializes chunks of at most `num_events_per_chunk` events in
+// parallel on `thread_pool`. The chunks are returned in the order of the events, so concatenating or
+// writing them one after the other is the same as serializing all events at once. This waits for
+// tasks on `thread_pool`, so it must not be called from one of its threads.
+[[nodiscard]] std::vector<std::string> SerializeCaptureEventsInParallel(
+    absl::Span<const orbit_grpc_protos::ClientCaptureEvent> events, ThreadPool* thread_pool,
+    size_t num_events_per_chunk = 16 * 1024);
+
 }  // namespace orbit_capture_file
 
 #endif  // CAPTURE_FILE_CAPTURE_FILE_OUTPUT_STREAM_H_
@@ -0,0 +1,120 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ClientData/FunctionTable.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "ClientData/FunctionUtils.h"
+#include "OrbitBase/Logging.h"
+
+using orbit_client_protos::FunctionInfo;
+
+namespace orbit_client_data {
+
+FunctionInfo FunctionHandle::CreateFunctionInfo() const {
+  FunctionInfo function_info;
+  function_info.set_name(std::string{name()});
+  function_info.set_pretty_name(std::string{pretty_name()});
+  function_info.set_module_path(module_path());
+  function_info.set_module_build_id(module_build_id());
+  function_info.set_address(address());
+  function_info.set_size(size());
+  function_info.set_orbit_type(orbit_type());
+  return function_info;
+}
+
+FunctionTable::FunctionTable(std::string module_path, std::string module_build_id,
+                             absl::Span<const Function> functions)
+    : module_path_(std::move(module_path)), module_build_id_(std::move(module_build_id)) {
+  CHECK(functions.size() <= std::numeric_limits<uint32_t>::max());
+
+  size_t strings_size = 0;
+  for (const Function& function : functions) {
+    strings_size += function.name.size() + function.pretty_name.size();
+  }
+  strings_.reserve(strings_size);
+  addresses_.reserve(functions.size());
+  entries_.reserve(functions.size());
+  hash_to_index_.reserve(functions.size());
+
+  for (const Function& function : functions) {
+    CHECK(addresses_.empty() || addresses_.back() < function.address);
+    auto index = static_cast<uint32_t>(addresses_.size());
+    addresses_.push_back(function.address);
+    entries_.push_back({function.size, strings_.size(),
+                        static_cast<uint32_t>(function.name.size()),
+                        static_cast<uint32_t>(function.pretty_name.size())});
+    strings_.append(function.name);
+    strings_.append(function.pretty_name);
+
+    if (function_utils::IsOrbitFunctionFromType(function.orbit_type)) {
+      orbit_types_.emplace(index, function.orbit_type);
+    }
+    if (!function.pretty_name.empty()) {
+      hash_to_index_.emplace_back(function_utils::GetHash(function.pretty_name), index);
+    }
+  }
+
+  // Functions with the same hash stay sorted by address.
+  std::sort(hash_to_index_.begin(), hash_to_index_.end());
+  for (auto it = hash_to_index_.begin(); it != hash_to_index_.end(); ++it) {
+    std::string_view function_pretty_name = pretty_name(it->second);
+    for (auto previous = std::make_reverse_iterator(it);
+         previous != hash_to_index_.rend() && previous->first == it->first; ++previous) {
+      if (pretty_name(previous->second) == function_pretty_name) {
+        ++num_duplicate_pretty_names_;
+        break;
+      }
+    }
+  }
+}
+
+std::optional<uint32_t> FunctionTable::FindIndexByElfAddress(uint64_t elf_address,
+                                                             bool is_exact) const {
+  auto it = std::upper_bound(addresses_.begin(), addresses_.end(), elf_address);
+  if (it == addresses_.begin()) return std::nullopt;
+
+  --it;
+  CHECK(*it <= elf_address);
+  auto index = static_cast<uint32_t>(it - addresses_.begin());
+  if (is_exact ? *it != elf_address : *it + entries_[index].size < elf_address) {
+    return std::nullopt;
+  }
+
+  return index;
+}
+
+std::optional<uint32_t> FunctionTable::FindIndexByPrettyName(std::string_view pretty_name) const {
+  uint64_t hash = function_utils::GetHash(pretty_name);
+  auto it = std::lower_bound(hash_to_index_.begin(), hash_to_index_.end(),
+                             std::make_pair(hash, uint32_t{0}));
+  for (; it != hash_to_index_.end() && it->first == hash; ++it) {
+    if (this->pretty_name(it->second) == pretty_name) return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<uint32_t> FunctionTable::FindIndexByHash(uint64_t hash) const {
+  auto it = std::lower_bound(hash_to_index_.begin(), hash_to_index_.end(),
+                             std::make_pair(hash, uint32_t{0}));
+  if (it == hash_to_index_.end() || it->first != hash) return std::nullopt;
+  return it->second;
+}
+
+std::vector<FunctionHandle> FunctionTable::GetOrbitFunctions() const {
+  std::vector<FunctionHandle> orbit_functions;
+  orbit_functions.reserve(orbit_types_.size());
+  for (const auto& [index, unused_orbit_type] : orbit_types_) {
+    orbit_functions.emplace_back(this, index);
+  }
+  std::sort(orbit_functions.begin(), orbit_functions.end(),
+            [](const FunctionHandle& lhs, const FunctionHandle& rhs) {
+              return lhs.index() < rhs.index();
+            });
+  return orbit_functions;
+}
+
+}  // namespace orbit_client_data
@@ -0,0 +1,126 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ClientData/FunctionTable.h"
+#include "ClientData/FunctionUtils.h"
+#include "capture_data.pb.h"
+
+using orbit_client_protos::FunctionInfo;
+
+namespace orbit_client_data {
+
+namespace {
+
+constexpr const char* kModulePath = "/path/to/module";
+constexpr const char* kBuildId = "build_id";
+
+std::vector<FunctionTable::Function> CreateFunctions() {
+  return {{0x100, 0x10, "_Z3foov", "foo()", FunctionInfo::kNone},
+          {0x200, 0x20, "_Z3bari", "bar(int)", FunctionInfo::kNone},
+          {0x300, 0x10, "_Z3barl", "bar(int)", FunctionInfo::kNone},
+          {0x400, 0x10, "no_pretty_name", "", FunctionInfo::kNone},
+          {0x500, 0x10, "start", "orbit_api::Start", FunctionInfo::kOrbitTimerStart}};
+}
+
+}  // namespace
+
+TEST(FunctionTable, Empty) {
+  FunctionTable table{kModulePath, kBuildId, {}};
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.size(), 0);
+  EXPECT_TRUE(table.begin() == table.end());
+  EXPECT_EQ(table.FindIndexByElfAddress(0x100, false), std::nullopt);
+  EXPECT_EQ(table.FindIndexByPrettyName("foo()"), std::nullopt);
+  EXPECT_TRUE(table.GetOrbitFunctions().empty());
+}
+
+TEST(FunctionTable, Handles) {
+  std::vector<FunctionTable::Function> functions = CreateFunctions();
+  FunctionTable table{kModulePath, kBuildId, functions};
+  ASSERT_EQ(table.size(), functions.size());
+
+  uint32_t index = 0;
+  for (FunctionHandle function : table) {
+    EXPECT_EQ(function.index(), index);
+    EXPECT_EQ(function, table[index]);
+    EXPECT_EQ(function.address(), functions[index].address);
+    EXPECT_EQ(function.size(), functions[index].size);
+    EXPECT_EQ(function.name(), functions[index].name);
+    EXPECT_EQ(function.pretty_name(), functions[index].pretty_name);
+    EXPECT_EQ(function.orbit_type(), functions[index].orbit_type);
+    EXPECT_EQ(function.module_path(), kModulePath);
+    EXPECT_EQ(function.module_build_id(), kBuildId);
+    ++index;
+  }
+  EXPECT_EQ(index, functions.size());
+
+  EXPECT_EQ(table[0].display_name(), "foo()");
+  EXPECT_EQ(table[3].display_name(), "no_pretty_name");
+}
+
+TEST(FunctionTable, CreateFunctionInfo) {
+  FunctionTable table{kModulePath, kBuildId, CreateFunctions()};
+  FunctionInfo function_info = table[4].CreateFunctionInfo();
+  EXPECT_EQ(function_info.name(), "start");
+  EXPECT_EQ(function_info.pretty_name(), "orbit_api::Start");
+  EXPECT_EQ(function_info.module_path(), kModulePath);
+  EXPECT_EQ(function_info.module_build_id(), kBuildId);
+  EXPECT_EQ(function_info.address(), 0x500);
+  EXPECT_EQ(function_info.size(), 0x10);
+  EXPECT_EQ(function_info.orbit_type(), FunctionInfo::kOrbitTimerStart);
+}
+
+TEST(FunctionTable, FindIndexByElfAddress) {
+  FunctionTable table{kModulePath, kBuildId, CreateFunctions()};
+
+  EXPECT_EQ(table.FindIndexByElfAddress(0x200, true), 1);
+  EXPECT_EQ(table.FindIndexByElfAddress(0x208, true), std::nullopt);
+  EXPECT_EQ(table.FindIndexByElfAddress(0x208, false), 1);
+  EXPECT_EQ(table.FindIndexByElfAddress(0x220, false), 1);
+  EXPECT_EQ(table.FindIndexByElfAddress(0x221, false), std::nullopt);
+  EXPECT_EQ(table.FindIndexByElfAddress(0xff, false), std::nullopt);
+  EXPECT_EQ(table.FindIndexByElfAddress(0x510, false), 4);
+  EXPECT_EQ(table.FindIndexByElfAddress(0x511, false), std::nullopt);
+}
+
+TEST(FunctionTable, FindIndexByPrettyNameAndHash) {
+  FunctionTable table{kModulePath, kBuildId, CreateFunctions()};
+
+  EXPECT_EQ(table.FindIndexByPrettyName("foo()"), 0);
+  // The function with the lowest address wins.
+  EXPECT_EQ(table.FindIndexByPrettyName("bar(int)"), 1);
+  EXPECT_EQ(table.FindIndexByPrettyName("bar"), std::nullopt);
+  // Functions without pretty name are not indexed.
+  EXPECT_EQ(table.FindIndexByPrettyName(""), std::nullopt);
+  EXPECT_EQ(table.num_duplicate_pretty_names(), 1);
+
+  EXPECT_EQ(table.FindIndexByHash(function_utils::GetHash("foo()")), 0);
+  EXPECT_EQ(table.FindIndexByHash(function_utils::GetHash("bar(int)")), 1);
+  EXPECT_EQ(table.FindIndexByHash(function_utils::GetHash("bar")), std::nullopt);
+}
+
+TEST(FunctionTable, GetOrbitFunctions) {
+  FunctionTable table{kModulePath, kBuildId, CreateFunctions()};
+  std::vector<FunctionHandle> orbit_functions = table.GetOrbitFunctions();
+  ASSERT_EQ(orbit_functions.size(), 1);
+  EXPECT_EQ(orbit_functions[0], table[4]);
+}
+
+TEST(FunctionTable, FunctionsMustBeSortedByAddress) {
+  std::vector<FunctionTable::Function> functions = CreateFunctions();
+  std::swap(functions[0], functions[1]);
+  EXPECT_DEATH((FunctionTable{kModulePath, kBuildId, functions}), "Check failed");
+  functions[0].address = functions[1].address;
+  EXPECT_DEATH((FunctionTable{kModulePath, kBuildId, functions}), "Check failed");
+}
+
+}  // namespace orbit_client_data
@@ -18,7 +18,7 @@
 namespace orbit_client_data {
 
 namespace {
-uint64_t StringHash(const std::string& string) {
+uint64_t StringHash(std::string_view string) {
   return XXH64(string.data(), string.size(), 0xBADDCAFEDEAD10CC);
 }
 }  // namespace
@@ -37,7 +37,7 @@ std::string GetLoadedModuleNameByPath(std::string_view module_path) {
 }
 
 uint64_t GetHash(const FunctionInfo& func) { return StringHash(func.pretty_name()); }
-uint64_t GetHash(std::string_view function_name) { return StringHash(std::string(function_name)); }
+uint64_t GetHash(std::string_view function_name) { return StringHash(function_name); }
 
 uint64_t Offset(const FunctionInfo& func, const ModuleData& module) {
   return func.address() - module.load_bias();
@@ -103,7 +103,7 @@ const absl::flat_hash_map<std::string, FunctionInfo::OrbitType>& GetFunctionName
   return function_name_to_type_map;
 }
 
-FunctionInfo::OrbitType GetOrbitTypeByName(const std::string& function_name) {
+FunctionInfo::OrbitType GetOrbitTypeByName(std::string_view function_name) {
   if (absl::StartsWith(function_name, "orbit_api::")) {
     for (const auto& pair : GetFunctionNameToOrbitTypeMap()) {
       if (absl::StrContains(function_name, pair.first)) {
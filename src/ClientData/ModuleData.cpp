@@ -7,6 +7,7 @@
 #include <absl/container/flat_hash_map.h>
 
 #include <algorithm>
+#include <iterator>
 
 #include "ClientData/FunctionUtils.h"
 #include "OrbitBase/Logging.h"
@@ -19,10 +20,19 @@ using orbit_grpc_protos::ModuleInfo;
 
 namespace orbit_client_data {
 
-bool ModuleData::is_loaded() const {
-  absl::MutexLock lock(&mutex_);
-  return is_loaded_;
+namespace {
+[[nodiscard]] bool HasLowerAddress(const FunctionTable::Function& lhs,
+                                   const FunctionTable::Function& rhs) {
+  return lhs.address < rhs.address;
+}
+
+[[nodiscard]] bool HasSameAddress(const FunctionTable::Function& lhs,
+                                  const FunctionTable::Function& rhs) {
+  return lhs.address == rhs.address;
 }
+}  // namespace
+
+bool ModuleData::is_loaded() const { return is_loaded_.load(std::memory_order_acquire); }
 
 bool ModuleData::NeedsUpdate(const orbit_grpc_protos::ModuleInfo& info) const {
   return name() != info.name() || file_size() != info.file_size() ||
@@ -49,9 +59,8 @@ bool ModuleData::UpdateIfChangedAndUnload(ModuleInfo info) {
 
   LOG("Module %s contained symbols. Because the module changed, those are now removed.",
       file_path());
-  functions_.clear();
-  hash_to_function_map_.clear();
-  is_loaded_ = false;
+  PublishFunctions(nullptr);
+  is_loaded_.store(false, std::memory_order_release);
 
   return true;
 }
@@ -73,6 +82,32 @@ bool ModuleData::UpdateIfChangedAndNotLoaded(orbit_grpc_protos::ModuleInfo info)
   return true;
 }
 
+void ModuleData::PublishFunctions(std::unique_ptr<const Functions> functions) {
+  // Lookups increment num_lookups_in_progress_ before loading functions_, and all these accesses
+  // are sequentially consistent. So if no lookup is in progress after the store below, no lookup
+  // can read the replaced functions anymore.
+  functions_.store(functions.get());
+  if (current_functions_ != nullptr) retired_functions_.push_back(std::move(current_functions_));
+  current_functions_ = std::move(functions);
+  if (num_lookups_in_progress_.load() == 0) retired_functions_.clear();
+}
+
+const FunctionInfo* ModuleData::GetOrCreateFunctionInfo(const Functions& functions,
+                                                        uint32_t index) const {
+  std::atomic<const FunctionInfo*>& function_info = functions.function_infos[index];
+  const FunctionInfo* result = function_info.load(std::memory_order_acquire);
+  if (result != nullptr) return result;
+
+  absl::MutexLock lock(&function_info_mutex_);
+  result = function_info.load(std::memory_order_relaxed);
+  if (result != nullptr) return result;
+
+  auto* created = google::protobuf::Arena::CreateMessage<FunctionInfo>(&function_info_arena_);
+  *created = (*functions.table)[index].CreateFunctionInfo();
+  function_info.store(created, std::memory_order_release);
+  return created;
+}
+
 const orbit_client_protos::FunctionInfo* ModuleData::FindFunctionByOffset(uint64_t offset,
                                                                           bool is_exact) const {
   uint64_t elf_address = offset + load_bias();
@@ -81,69 +116,100 @@ const orbit_client_protos::FunctionInfo* ModuleData::FindFunctionByOffset(uint64
 
 const FunctionInfo* ModuleData::FindFunctionByElfAddress(uint64_t elf_address,
                                                          bool is_exact) const {
-  absl::MutexLock lock(&mutex_);
-  if (functions_.empty()) return nullptr;
+  ScopedLookup lookup{&num_lookups_in_progress_};
+  const Functions* functions = functions_.load();
+  if (functions == nullptr) return nullptr;
+  std::optional<uint32_t> index = functions->table->FindIndexByElfAddress(elf_address, is_exact);
+  if (!index.has_value()) return nullptr;
+  return GetOrCreateFunctionInfo(*functions, index.value());
+}
 
-  if (is_exact) {
-    auto it = functions_.find(elf_address);
-    return (it != functions_.end()) ? it->second.get() : nullptr;
+void ModuleData::AddFunctionInfosWithBuildId(absl::Span<const FunctionInfo> function_infos,
+                                             const std::string& module_build_id) {
+  absl::MutexLock lock(&mutex_);
+  const FunctionTable* table =
+      current_functions_ != nullptr ? current_functions_->table.get() : nullptr;
+  CHECK(table == nullptr || table->module_build_id() == module_build_id);
+
+  // The FunctionInfos of the functions already in the table are kept.
+  std::vector<std::pair<FunctionTable::Function, const FunctionInfo*>> functions;
+  functions.reserve((table != nullptr ? table->size() : 0) + function_infos.size());
+  if (table != nullptr) {
+    for (FunctionHandle function : *table) {
+      functions.emplace_back(
+          FunctionTable::Function{function.address(), function.size(), function.name(),
+                                  function.pretty_name(), function.orbit_type()},
+          current_functions_->function_infos[function.index()].load(std::memory_order_relaxed));
+    }
+  }
+  for (const FunctionInfo& function_info : function_infos) {
+    functions.emplace_back(
+        FunctionTable::Function{function_info.address(), function_info.size(),
+                                function_info.name(), function_info.pretty_name(),
+                                function_info.orbit_type()},
+        nullptr);
   }
 
-  auto it = functions_.upper_bound(elf_address);
-  if (it == functions_.begin()) return nullptr;
-
-  --it;
-  FunctionInfo* function = it->second.get();
-  CHECK(function->address() <= elf_address);
-
-  if (function->address() + function->size() < elf_address) return nullptr;
-
-  return function;
-}
+  std::sort(functions.begin(), functions.end(), [](const auto& lhs, const auto& rhs) {
+    return HasLowerAddress(lhs.first, rhs.first);
+  });
+  CHECK(std::adjacent_find(functions.begin(), functions.end(),
+                           [](const auto& lhs, const auto& rhs) {
+                             return HasSameAddress(lhs.first, rhs.first);
+                           }) == functions.end());
+
+  std::vector<FunctionTable::Function> table_functions;
+  table_functions.reserve(functions.size());
+  auto new_functions = std::make_unique<Functions>();
+  new_functions->function_infos =
+      std::make_unique<std::atomic<const FunctionInfo*>[]>(functions.size());
+  for (size_t i = 0; i < functions.size(); ++i) {
+    table_functions.push_back(functions[i].first);
+    new_functions->function_infos[i].store(functions[i].second, std::memory_order_relaxed);
+  }
+  new_functions->table =
+      std::make_shared<const FunctionTable>(file_path(), module_build_id, table_functions);
 
-void ModuleData::AddFunctionInfoWithBuildId(const FunctionInfo& function_info,
-                                            const std::string& module_build_id) {
-  absl::MutexLock lock(&mutex_);
-  CHECK(functions_.find(function_info.address()) == functions_.end());
-  auto value = std::make_unique<FunctionInfo>(function_info);
-  value->set_module_build_id(module_build_id);
-  functions_.insert_or_assign(function_info.address(), std::move(value));
-  is_loaded_ = true;
+  PublishFunctions(std::move(new_functions));
+  is_loaded_.store(true, std::memory_order_release);
 }
 
 void ModuleData::AddSymbols(const orbit_grpc_protos::ModuleSymbols& module_symbols) {
   absl::MutexLock lock(&mutex_);
   CHECK(!is_loaded_);
 
-  uint32_t address_reuse_counter = 0;
-  uint32_t name_reuse_counter = 0;
+  std::vector<FunctionTable::Function> functions;
+  functions.reserve(module_symbols.symbol_infos_size());
   for (const orbit_grpc_protos::SymbolInfo& symbol_info : module_symbols.symbol_infos()) {
-    auto [inserted_it, success_functions] = functions_.try_emplace(
-        symbol_info.address(),
-        function_utils::CreateFunctionInfo(symbol_info, file_path(), build_id()));
-    FunctionInfo* function = inserted_it->second.get();
-    // It happens that the same address has multiple symbol names associated
-    // with it. For example: (all the same address)
-    // __cxxabiv1::__enum_type_info::~__enum_type_info()
-    // __cxxabiv1::__shim_type_info::~__shim_type_info()
-    // __cxxabiv1::__array_type_info::~__array_type_info()
-    // __cxxabiv1::__class_type_info::~__class_type_info()
-    // __cxxabiv1::__pbase_type_info::~__pbase_type_info()
-    if (success_functions) {
-      CHECK(!function->pretty_name().empty());
-      // Be careful about the scope, the key is a string_view. This is done to avoid name
-      // duplication.
-      bool success_function_name =
-          name_to_function_info_map_.try_emplace(function->pretty_name(), function).second;
-      if (!success_function_name) {
-        name_reuse_counter++;
-      }
-
-      hash_to_function_map_.try_emplace(function_utils::GetHash(*function), function);
-    } else {
-      address_reuse_counter++;
-    }
+    functions.push_back({symbol_info.address(), symbol_info.size(), symbol_info.name(),
+                         symbol_info.demangled_name(),
+                         function_utils::GetOrbitTypeByName(symbol_info.demangled_name())});
+  }
+
+  // It happens that the same address has multiple symbol names associated
+  // with it. For example: (all the same address)
+  // __cxxabiv1::__enum_type_info::~__enum_type_info()
+  // __cxxabiv1::__shim_type_info::~__shim_type_info()
+  // __cxxabiv1::__array_type_info::~__array_type_info()
+  // __cxxabiv1::__class_type_info::~__class_type_info()
+  // __cxxabiv1::__pbase_type_info::~__pbase_type_info()
+  // Only the first symbol for each address is kept, hence the stable sort.
+  std::stable_sort(functions.begin(), functions.end(), HasLowerAddress);
+  auto unique_end = std::unique(functions.begin(), functions.end(), HasSameAddress);
+  const auto address_reuse_counter = std::distance(unique_end, functions.end());
+  functions.erase(unique_end, functions.end());
+  for (const FunctionTable::Function& function : functions) {
+    CHECK(!function.pretty_name.empty());
   }
+
+  auto new_functions = std::make_unique<Functions>();
+  // Value-initialized, so all null.
+  new_functions->function_infos =
+      std::make_unique<std::atomic<const FunctionInfo*>[]>(functions.size());
+  new_functions->table = std::make_shared<const FunctionTable>(file_path(), build_id(), functions);
+  uint32_t name_reuse_counter = new_functions->table->num_duplicate_pretty_names();
+
+  PublishFunctions(std::move(new_functions));
   if (address_reuse_counter != 0) {
     LOG("Warning: %d absolute addresses are used by more than one symbol", address_reuse_counter);
   }
@@ -154,41 +220,34 @@ void ModuleData::AddSymbols(const orbit_grpc_protos::ModuleSymbols& module_symbo
         name_reuse_counter);
   }
 
-  is_loaded_ = true;
-}
-
-const orbit_client_protos::FunctionInfo* ModuleData::FindFunctionFromHash(uint64_t hash) const {
-  absl::MutexLock lock(&mutex_);
-  return hash_to_function_map_.contains(hash) ? hash_to_function_map_.at(hash) : nullptr;
+  is_loaded_.store(true, std::memory_order_release);
 }
 
-const orbit_client_protos::FunctionInfo* ModuleData::FindFunctionFromPrettyName(
-    std::string_view pretty_name) const {
-  absl::MutexLock lock(&mutex_);
-  auto it = name_to_function_info_map_.find(pretty_name);
-  return it != name_to_function_info_map_.end() ? it->second : nullptr;
+const FunctionInfo* ModuleData::FindFunctionFromHash(uint64_t hash) const {
+  ScopedLookup lookup{&num_lookups_in_progress_};
+  const Functions* functions = functions_.load();
+  if (functions == nullptr) return nullptr;
+  std::optional<uint32_t> index = functions->table->FindIndexByHash(hash);
+  if (!index.has_value()) return nullptr;
+  return GetOrCreateFunctionInfo(*functions, index.value());
 }
 
-std::vector<const FunctionInfo*> ModuleData::GetFunctions() const {
-  absl::MutexLock lock(&mutex_);
-  std::vector<const FunctionInfo*> result;
-  result.reserve(functions_.size());
-  for (const auto& pair : functions_) {
-    result.push_back(pair.second.get());
-  }
-  return result;
+const FunctionInfo* ModuleData::FindFunctionFromPrettyName(std::string_view pretty_name) const {
+  ScopedLookup lookup{&num_lookups_in_progress_};
+  const Functions* functions = functions_.load();
+  if (functions == nullptr) return nullptr;
+  std::optional<uint32_t> index = functions->table->FindIndexByPrettyName(pretty_name);
+  if (!index.has_value()) return nullptr;
+  return GetOrCreateFunctionInfo(*functions, index.value());
 }
 
-std::vector<FunctionInfo> ModuleData::GetOrbitFunctions() const {
+std::shared_ptr<const FunctionTable> ModuleData::GetFunctions() const {
   absl::MutexLock lock(&mutex_);
-  CHECK(is_loaded_);
-  std::vector<FunctionInfo> result;
-  for (const auto& [_, function] : functions_) {
-    if (function_utils::IsOrbitFunctionFromType(function->orbit_type())) {
-      result.emplace_back(*function);
-    }
+  if (current_functions_ == nullptr) {
+    return std::make_shared<const FunctionTable>(file_path(), build_id(),
+                                                 absl::Span<const FunctionTable::Function>{});
   }
-  return result;
+  return current_functions_->table;
 }
 
 }  // namespace orbit_client_data
@@ -5,11 +5,16 @@
 #include <gtest/gtest.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "ClientData/FunctionTable.h"
 #include "ClientData/FunctionUtils.h"
 #include "ClientData/ModuleData.h"
+#include "absl/strings/str_format.h"
 #include "capture_data.pb.h"
 #include "module.pb.h"
 #include "symbol.pb.h"
@@ -43,7 +48,7 @@ TEST(ModuleData, Constructor) {
   EXPECT_EQ(module.build_id(), build_id);
   EXPECT_EQ(module.load_bias(), load_bias);
   EXPECT_FALSE(module.is_loaded());
-  EXPECT_TRUE(module.GetFunctions().empty());
+  EXPECT_TRUE(module.GetFunctions()->empty());
 }
 
 TEST(ModuleData, LoadSymbols) {
@@ -72,15 +77,27 @@ TEST(ModuleData, LoadSymbols) {
   module.AddSymbols(module_symbols);
   EXPECT_TRUE(module.is_loaded());
 
-  ASSERT_EQ(module.GetFunctions().size(), 1);
-
-  const FunctionInfo* function = module.GetFunctions()[0];
-  EXPECT_EQ(function->name(), symbol_name);
-  EXPECT_EQ(function->pretty_name(), symbol_pretty_name);
-  EXPECT_EQ(function->module_path(), module_file_path);
-  EXPECT_EQ(function->module_build_id(), kBuildId);
-  EXPECT_EQ(function->address(), symbol_address);
-  EXPECT_EQ(function->size(), symbol_size);
+  std::shared_ptr<const FunctionTable> functions = module.GetFunctions();
+  ASSERT_EQ(functions->size(), 1);
+
+  FunctionHandle function = (*functions)[0];
+  EXPECT_EQ(function.name(), symbol_name);
+  EXPECT_EQ(function.pretty_name(), symbol_pretty_name);
+  EXPECT_EQ(function.module_path(), module_file_path);
+  EXPECT_EQ(function.module_build_id(), kBuildId);
+  EXPECT_EQ(function.address(), symbol_address);
+  EXPECT_EQ(function.size(), symbol_size);
+
+  const FunctionInfo* function_info = module.FindFunctionByOffset(symbol_address, true);
+  ASSERT_NE(function_info, nullptr);
+  EXPECT_EQ(function_info->name(), symbol_name);
+  EXPECT_EQ(function_info->pretty_name(), symbol_pretty_name);
+  EXPECT_EQ(function_info->module_path(), module_file_path);
+  EXPECT_EQ(function_info->module_build_id(), kBuildId);
+  EXPECT_EQ(function_info->address(), symbol_address);
+  EXPECT_EQ(function_info->size(), symbol_size);
+  // The FunctionInfo is only created once.
+  EXPECT_EQ(module.FindFunctionByOffset(symbol_address, true), function_info);
 }
 
 TEST(ModuleData, FindFunctionByOffset) {
@@ -172,9 +189,10 @@ TEST(ModuleData, FindFunctionFromHash) {
   module.AddSymbols(symbols);
 
   ASSERT_TRUE(module.is_loaded());
-  ASSERT_FALSE(module.GetFunctions().empty());
+  ASSERT_FALSE(module.GetFunctions()->empty());
 
-  const FunctionInfo* function = module.GetFunctions()[0];
+  const FunctionInfo* function = module.FindFunctionByOffset(0, true);
+  ASSERT_NE(function, nullptr);
   uint64_t hash = function_utils::GetHash(*function);
 
   {
@@ -188,6 +206,149 @@ TEST(ModuleData, FindFunctionFromHash) {
   }
 }
 
+TEST(ModuleData, LoadSymbolsWithUnsortedAndReusedAddresses) {
+  ModuleSymbols symbols;
+  auto add_symbol = [&symbols](const std::string& name, uint64_t address) {
+    SymbolInfo* symbol = symbols.add_symbol_infos();
+    symbol->set_name(name);
+    symbol->set_demangled_name("pretty " + name);
+    symbol->set_address(address);
+    symbol->set_size(10);
+  };
+  add_symbol("c", 300);
+  add_symbol("a", 100);
+  add_symbol("b", 200);
+  // Only the first symbol at an address is kept.
+  add_symbol("alias of a", 100);
+
+  ModuleData module{ModuleInfo{}};
+  module.AddSymbols(symbols);
+  ASSERT_TRUE(module.is_loaded());
+
+  std::shared_ptr<const FunctionTable> functions = module.GetFunctions();
+  std::vector<std::string> names;
+  for (FunctionHandle function : *functions) {
+    names.emplace_back(function.name());
+  }
+  EXPECT_EQ(names, (std::vector<std::string>{"a", "b", "c"}));
+
+  const FunctionInfo* b = module.FindFunctionByOffset(205, false);
+  ASSERT_NE(b, nullptr);
+  EXPECT_EQ(b->name(), "b");
+  const FunctionInfo* c = module.FindFunctionByOffset(300, true);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(c->name(), "c");
+  EXPECT_EQ(module.FindFunctionByOffset(50, false), nullptr);
+  EXPECT_EQ(module.FindFunctionByOffset(350, false), nullptr);
+
+  EXPECT_EQ(module.FindFunctionFromPrettyName("pretty b"), b);
+  EXPECT_EQ(module.FindFunctionFromPrettyName("pretty alias of a"), nullptr);
+}
+
+TEST(ModuleData, AddFunctionInfosWithBuildId) {
+  constexpr const char* kBuildId = "build_id";
+  ModuleInfo module_info{};
+  module_info.set_build_id(kBuildId);
+  ModuleData module{module_info};
+
+  FunctionInfo function_info;
+  function_info.set_pretty_name("second");
+  function_info.set_address(200);
+  function_info.set_size(10);
+  module.AddFunctionInfosWithBuildId({function_info}, kBuildId);
+  ASSERT_TRUE(module.is_loaded());
+  ASSERT_EQ(module.GetFunctions()->size(), 1);
+  const FunctionInfo* second = module.FindFunctionByOffset(200, true);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(second->module_build_id(), kBuildId);
+
+  std::shared_ptr<const FunctionTable> replaced_functions = module.GetFunctions();
+  function_info.set_pretty_name("first");
+  function_info.set_address(100);
+  module.AddFunctionInfosWithBuildId({function_info}, kBuildId);
+  std::shared_ptr<const FunctionTable> functions = module.GetFunctions();
+  ASSERT_EQ(functions->size(), 2);
+  EXPECT_EQ((*functions)[0].pretty_name(), "first");
+  EXPECT_EQ((*functions)[1].pretty_name(), "second");
+  const FunctionInfo* first = module.FindFunctionByOffset(100, true);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(first->pretty_name(), "first");
+  // The FunctionInfos handed out before are kept.
+  EXPECT_EQ(module.FindFunctionFromPrettyName("second"), second);
+
+  // The replaced table is still valid while it is held.
+  ASSERT_EQ(replaced_functions->size(), 1);
+  EXPECT_EQ((*replaced_functions)[0].pretty_name(), "second");
+
+  // Functions can't be added twice at the same address.
+  EXPECT_DEATH(module.AddFunctionInfosWithBuildId({function_info}, kBuildId), "Check failed");
+}
+
+TEST(ModuleData, FunctionsOutliveUnload) {
+  ModuleInfo module_info{};
+  module_info.set_file_size(1000);
+  ModuleData module{module_info};
+
+  ModuleSymbols symbols;
+  SymbolInfo* symbol = symbols.add_symbol_infos();
+  symbol->set_name("name");
+  symbol->set_demangled_name("pretty name");
+  symbol->set_address(100);
+  module.AddSymbols(symbols);
+
+  std::shared_ptr<const FunctionTable> functions = module.GetFunctions();
+  ASSERT_EQ(functions->size(), 1);
+  const FunctionInfo* function = module.FindFunctionByOffset(100, true);
+  ASSERT_NE(function, nullptr);
+
+  module_info.set_file_size(1001);
+  EXPECT_TRUE(module.UpdateIfChangedAndUnload(module_info));
+  EXPECT_FALSE(module.is_loaded());
+  EXPECT_TRUE(module.GetFunctions()->empty());
+  EXPECT_EQ(module.FindFunctionByOffset(100, true), nullptr);
+  EXPECT_EQ(module.FindFunctionFromPrettyName("pretty name"), nullptr);
+
+  // The table held and the FunctionInfos handed out before the unload are still valid.
+  ASSERT_EQ(functions->size(), 1);
+  EXPECT_EQ((*functions)[0].name(), "name");
+  EXPECT_EQ(function->name(), "name");
+}
+
+TEST(ModuleData, LookupsWhileFunctionsAreReplaced) {
+  constexpr const char* kBuildId = "build_id";
+  ModuleInfo module_info{};
+  module_info.set_build_id(kBuildId);
+  ModuleData module{module_info};
+
+  constexpr uint64_t kNumFunctions = 200;
+  FunctionInfo function_info;
+  function_info.set_size(1);
+  function_info.set_pretty_name("function 0");
+  function_info.set_address(0);
+  module.AddFunctionInfosWithBuildId({function_info}, kBuildId);
+
+  std::atomic<bool> done = false;
+  std::thread reader{[&module, &done] {
+    while (!done) {
+      const FunctionInfo* function = module.FindFunctionByOffset(0, true);
+      ASSERT_NE(function, nullptr);
+      EXPECT_EQ(function->pretty_name(), "function 0");
+      EXPECT_NE(module.FindFunctionFromPrettyName("function 0"), nullptr);
+    }
+  }};
+
+  // Each call replaces the table of functions.
+  for (uint64_t address = 1; address < kNumFunctions; ++address) {
+    function_info.set_pretty_name(absl::StrFormat("function %u", address));
+    function_info.set_address(address);
+    module.AddFunctionInfosWithBuildId({function_info}, kBuildId);
+  }
+  done = true;
+  reader.join();
+
+  EXPECT_EQ(module.GetFunctions()->size(), kNumFunctions);
+}
+
 TEST(ModuleData, UpdateIfChanged) {
   std::string name = "Example Name";
   std::string file_path = "/test/file/path";
@@ -210,7 +371,7 @@ TEST(ModuleData, UpdateIfChanged) {
   EXPECT_EQ(module.build_id(), build_id);
   EXPECT_EQ(module.load_bias(), load_bias);
   EXPECT_FALSE(module.is_loaded());
-  EXPECT_TRUE(module.GetFunctions().empty());
+  EXPECT_TRUE(module.GetFunctions()->empty());
 
   module_info.set_name("different name");
   EXPECT_FALSE(module.UpdateIfChangedAndUnload(module_info));
@@ -264,7 +425,7 @@ TEST(ModuleData, UpdateIfChangedAndNotLoaded) {
   EXPECT_EQ(module.build_id(), build_id);
   EXPECT_EQ(module.load_bias(), load_bias);
   EXPECT_FALSE(module.is_loaded());
-  EXPECT_TRUE(module.GetFunctions().empty());
+  EXPECT_TRUE(module.GetFunctions()->empty());
 
   module_info.set_name("different name");
   EXPECT_TRUE(module.UpdateIfChangedAndNotLoaded(module_info));
@@ -319,7 +480,7 @@ TEST(ModuleData, UpdateIfChangedWithBuildId) {
   EXPECT_EQ(module.build_id(), build_id);
   EXPECT_EQ(module.load_bias(), load_bias);
   EXPECT_FALSE(module.is_loaded());
-  EXPECT_TRUE(module.GetFunctions().empty());
+  EXPECT_TRUE(module.GetFunctions()->empty());
 
   // We cannot change a module with non-empty build_id
   module_info.set_name("different name");
@@ -9,9 +9,11 @@
 #include <algorithm>
 #include <filesystem>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
+#include "ClientData/FunctionTable.h"
 #include "ClientData/ModuleData.h"
 #include "OrbitBase/Logging.h"
 #include "absl/synchronization/mutex.h"
@@ -100,8 +102,10 @@ std::vector<FunctionInfo> ModuleManager::GetOrbitFunctionsOfProcess(
     CHECK(module != nullptr);
     if (!module->is_loaded()) continue;
 
-    const std::vector<FunctionInfo>& orbit_functions = module->GetOrbitFunctions();
-    result.insert(result.end(), orbit_functions.begin(), orbit_functions.end());
+    std::shared_ptr<const FunctionTable> functions = module->GetFunctions();
+    for (const FunctionHandle& function : functions->GetOrbitFunctions()) {
+      result.push_back(function.CreateFunctionInfo());
+    }
   }
   return result;
 }
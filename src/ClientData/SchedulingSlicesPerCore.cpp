@@ -0,0 +1,53 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ClientData/SchedulingSlicesPerCore.h"
+
+#include "OrbitBase/Logging.h"
+
+namespace orbit_client_data {
+
+void SchedulingSlicesPerCore::AddSlice(int32_t pid, int32_t tid, int32_t core, uint64_t start_ns,
+                                       uint64_t end_ns) {
+  if (core < 0) {
+    ERROR("Scheduling slice with negative core %d", core);
+    return;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  auto [thread_index_it, inserted] =
+      thread_indices_.try_emplace(std::make_pair(pid, tid), threads_.size());
+  if (inserted) threads_.emplace_back(pid, tid);
+
+  if (static_cast<size_t>(core) >= cores_.size()) cores_.resize(core + 1);
+  Core& slices = cores_[core];
+  slices.max_duration_ns = std::max(slices.max_duration_ns, end_ns - start_ns);
+  ++num_slices_;
+
+  // Slices of a core arrive in order, except possibly when loading captures saved by old versions.
+  if (slices.start_ns.empty() || slices.start_ns.back() <= start_ns) {
+    slices.start_ns.push_back(start_ns);
+    slices.end_ns.push_back(end_ns);
+    slices.thread_indices.push_back(thread_index_it->second);
+    return;
+  }
+  const size_t index =
+      std::upper_bound(slices.start_ns.begin(), slices.start_ns.end(), start_ns) -
+      slices.start_ns.begin();
+  slices.start_ns.insert(slices.start_ns.begin() + index, start_ns);
+  slices.end_ns.insert(slices.end_ns.begin() + index, end_ns);
+  slices.thread_indices.insert(slices.thread_indices.begin() + index, thread_index_it->second);
+}
+
+size_t SchedulingSlicesPerCore::GetNumSlices() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return num_slices_;
+}
+
+uint32_t SchedulingSlicesPerCore::GetNumCores() const {
+  absl::ReaderMutexLock lock(&mutex_);
+  return cores_.size();
+}
+
+}  // namespace orbit_client_data
@@ -0,0 +1,77 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "ClientData/SchedulingSlicesPerCore.h"
+
+namespace orbit_client_data {
+
+namespace {
+
+std::vector<uint64_t> GetStartsInRange(const SchedulingSlicesPerCore& slices, int32_t core,
+                                       uint64_t min_ns, uint64_t max_ns) {
+  std::vector<uint64_t> starts;
+  slices.ForEachSliceInRange(core, min_ns, max_ns, [&starts](const SchedulingSliceInfo& slice) {
+    starts.push_back(slice.start_ns);
+    return true;
+  });
+  return starts;
+}
+
+}  // namespace
+
+TEST(SchedulingSlicesPerCore, Empty) {
+  SchedulingSlicesPerCore slices;
+  EXPECT_EQ(slices.GetNumSlices(), 0);
+  EXPECT_EQ(slices.GetNumCores(), 0);
+  EXPECT_TRUE(GetStartsInRange(slices, 0, 0, 1000).empty());
+  EXPECT_TRUE(GetStartsInRange(slices, -1, 0, 1000).empty());
+}
+
+TEST(SchedulingSlicesPerCore, ForEachSliceInRange) {
+  SchedulingSlicesPerCore slices;
+  slices.AddSlice(/*pid=*/10, /*tid=*/11, /*core=*/2, 100, 200);
+  slices.AddSlice(/*pid=*/20, /*tid=*/21, /*core=*/2, 250, 300);
+  slices.AddSlice(/*pid=*/10, /*tid=*/11, /*core=*/2, 300, 400);
+  slices.AddSlice(/*pid=*/10, /*tid=*/12, /*core=*/0, 150, 350);
+  EXPECT_EQ(slices.GetNumSlices(), 4);
+  EXPECT_EQ(slices.GetNumCores(), 3);
+
+  EXPECT_EQ(GetStartsInRange(slices, 2, 0, 1000), (std::vector<uint64_t>{100, 250, 300}));
+  EXPECT_EQ(GetStartsInRange(slices, 2, 200, 250), (std::vector<uint64_t>{100, 250}));
+  EXPECT_EQ(GetStartsInRange(slices, 2, 201, 249), (std::vector<uint64_t>{}));
+  EXPECT_EQ(GetStartsInRange(slices, 2, 350, 1000), (std::vector<uint64_t>{300}));
+  EXPECT_EQ(GetStartsInRange(slices, 0, 200, 210), (std::vector<uint64_t>{150}));
+  EXPECT_TRUE(GetStartsInRange(slices, 1, 0, 1000).empty());
+
+  std::vector<SchedulingSliceInfo> visited;
+  slices.ForEachSliceInRange(2, 0, 1000, [&visited](const SchedulingSliceInfo& slice) {
+    visited.push_back(slice);
+    return visited.size() < 2;
+  });
+  ASSERT_EQ(visited.size(), 2);
+  EXPECT_EQ(visited[0].pid, 10);
+  EXPECT_EQ(visited[0].tid, 11);
+  EXPECT_EQ(visited[0].core, 2);
+  EXPECT_EQ(visited[0].end_ns, 200);
+  EXPECT_EQ(visited[1].pid, 20);
+  EXPECT_EQ(visited[1].tid, 21);
+}
+
+TEST(SchedulingSlicesPerCore, OutOfOrderAndOverlappingSlices) {
+  SchedulingSlicesPerCore slices;
+  slices.AddSlice(/*pid=*/10, /*tid=*/11, /*core=*/0, 300, 400);
+  slices.AddSlice(/*pid=*/10, /*tid=*/11, /*core=*/0, 100, 1000);
+  slices.AddSlice(/*pid=*/10, /*tid=*/11, /*core=*/0, 200, 250);
+
+  EXPECT_EQ(GetStartsInRange(slices, 0, 0, 2000), (std::vector<uint64_t>{100, 200, 300}));
+  // The long slice starting at 100 intersects the range even though later slices end before it.
+  EXPECT_EQ(GetStartsInRange(slices, 0, 500, 600), (std::vector<uint64_t>{100}));
+}
+
+}  // namespace orbit_client_data
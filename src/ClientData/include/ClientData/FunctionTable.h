@@ -0,0 +1,192 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CLIENT_DATA_FUNCTION_TABLE_H_
+#define CLIENT_DATA_FUNCTION_TABLE_H_
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "capture_data.pb.h"
+
+namespace orbit_client_data {
+
+class FunctionTable;
+
+// Refers to one function of a FunctionTable. It is only valid as long as the table is alive.
+class FunctionHandle {
+ public:
+  FunctionHandle(const FunctionTable* table, uint32_t index) : table_(table), index_(index) {}
+
+  [[nodiscard]] uint64_t address() const;
+  [[nodiscard]] uint64_t size() const;
+  [[nodiscard]] std::string_view name() const;
+  [[nodiscard]] std::string_view pretty_name() const;
+  // The pretty name, or the name if the function has no pretty name.
+  [[nodiscard]] std::string_view display_name() const;
+  [[nodiscard]] const std::string& module_path() const;
+  [[nodiscard]] const std::string& module_build_id() const;
+  [[nodiscard]] orbit_client_protos::FunctionInfo::OrbitType orbit_type() const;
+  [[nodiscard]] uint32_t index() const { return index_; }
+
+  [[nodiscard]] orbit_client_protos::FunctionInfo CreateFunctionInfo() const;
+
+  friend bool operator==(const FunctionHandle& lhs, const FunctionHandle& rhs) {
+    return lhs.table_ == rhs.table_ && lhs.index_ == rhs.index_;
+  }
+  friend bool operator!=(const FunctionHandle& lhs, const FunctionHandle& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  const FunctionTable* table_;
+  uint32_t index_;
+};
+
+// The functions of one module, sorted by address. Modules can have millions of functions, so
+// instead of one FunctionInfo per function, each function takes an address and a 24 bytes entry in
+// flat arrays, the names and pretty names of all functions are stored in a single string, and the
+// module path and build id are stored once. The functions are accessed through FunctionHandles.
+// Tables are immutable once created, so they can be read from several threads without locking.
+class FunctionTable final {
+ public:
+  // Describes a function to add to a table. The strings are copied into the table.
+  struct Function {
+    uint64_t address = 0;
+    uint64_t size = 0;
+    std::string_view name;
+    std::string_view pretty_name;
+    orbit_client_protos::FunctionInfo::OrbitType orbit_type =
+        orbit_client_protos::FunctionInfo::kNone;
+  };
+
+  class Iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = FunctionHandle;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = FunctionHandle;
+
+    Iterator(const FunctionTable* table, uint32_t index) : table_(table), index_(index) {}
+
+    [[nodiscard]] FunctionHandle operator*() const { return FunctionHandle{table_, index_}; }
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++index_;
+      return result;
+    }
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+      return lhs.table_ == rhs.table_ && lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) { return !(lhs == rhs); }
+
+   private:
+    const FunctionTable* table_;
+    uint32_t index_;
+  };
+
+  // `functions` must be sorted by address, without two functions at the same address.
+  FunctionTable(std::string module_path, std::string module_build_id,
+                absl::Span<const Function> functions);
+
+  FunctionTable(const FunctionTable&) = delete;
+  FunctionTable& operator=(const FunctionTable&) = delete;
+
+  [[nodiscard]] const std::string& module_path() const { return module_path_; }
+  [[nodiscard]] const std::string& module_build_id() const { return module_build_id_; }
+
+  [[nodiscard]] size_t size() const { return addresses_.size(); }
+  [[nodiscard]] bool empty() const { return addresses_.empty(); }
+  [[nodiscard]] FunctionHandle operator[](uint32_t index) const {
+    return FunctionHandle{this, index};
+  }
+  [[nodiscard]] Iterator begin() const { return Iterator{this, 0}; }
+  [[nodiscard]] Iterator end() const { return Iterator{this, static_cast<uint32_t>(size())}; }
+
+  // If `is_exact` is false, finds the function whose address range contains `elf_address`.
+  [[nodiscard]] std::optional<uint32_t> FindIndexByElfAddress(uint64_t elf_address,
+                                                              bool is_exact) const;
+  // When several functions have the same pretty name, the one with the lowest address is found.
+  [[nodiscard]] std::optional<uint32_t> FindIndexByPrettyName(std::string_view pretty_name) const;
+  // TODO(b/168799822) Presets are based on a hash of the pretty name of the functions. This
+  // should be changed to not use hashes anymore.
+  [[nodiscard]] std::optional<uint32_t> FindIndexByHash(uint64_t hash) const;
+
+  [[nodiscard]] std::vector<FunctionHandle> GetOrbitFunctions() const;
+  // The number of functions with the same pretty name as a function with a lower address.
+  [[nodiscard]] uint32_t num_duplicate_pretty_names() const { return num_duplicate_pretty_names_; }
+
+ private:
+  friend class FunctionHandle;
+
+  struct Entry {
+    uint64_t size;
+    // The name starts at this offset in `strings_` and is directly followed by the pretty name.
+    uint64_t name_offset;
+    uint32_t name_size;
+    uint32_t pretty_name_size;
+  };
+
+  [[nodiscard]] std::string_view name(uint32_t index) const {
+    const Entry& entry = entries_[index];
+    return std::string_view{strings_}.substr(entry.name_offset, entry.name_size);
+  }
+  [[nodiscard]] std::string_view pretty_name(uint32_t index) const {
+    const Entry& entry = entries_[index];
+    return std::string_view{strings_}.substr(entry.name_offset + entry.name_size,
+                                             entry.pretty_name_size);
+  }
+  [[nodiscard]] orbit_client_protos::FunctionInfo::OrbitType orbit_type(uint32_t index) const {
+    auto it = orbit_types_.find(index);
+    return it != orbit_types_.end() ? it->second : orbit_client_protos::FunctionInfo::kNone;
+  }
+
+  std::string module_path_;
+  std::string module_build_id_;
+  // Kept apart from the entries, so that the lookups by address only touch the addresses.
+  std::vector<uint64_t> addresses_;
+  // The entry at the same index as the address.
+  std::vector<Entry> entries_;
+  std::string strings_;
+  // Only the few Orbit API functions have an OrbitType.
+  absl::flat_hash_map<uint32_t, orbit_client_protos::FunctionInfo::OrbitType> orbit_types_;
+  // The hash of the pretty name and the index of each function with a pretty name, sorted. This
+  // serves the lookups by hash and by pretty name, as the lookup by pretty name computes the hash.
+  std::vector<std::pair<uint64_t, uint32_t>> hash_to_index_;
+  uint32_t num_duplicate_pretty_names_ = 0;
+};
+
+inline uint64_t FunctionHandle::address() const { return table_->addresses_[index_]; }
+inline uint64_t FunctionHandle::size() const { return table_->entries_[index_].size; }
+inline std::string_view FunctionHandle::name() const { return table_->name(index_); }
+inline std::string_view FunctionHandle::pretty_name() const { return table_->pretty_name(index_); }
+inline std::string_view FunctionHandle::display_name() const {
+  std::string_view pretty_name = table_->pretty_name(index_);
+  return pretty_name.empty() ? table_->name(index_) : pretty_name;
+}
+inline const std::string& FunctionHandle::module_path() const { return table_->module_path(); }
+inline const std::string& FunctionHandle::module_build_id() const {
+  return table_->module_build_id();
+}
+inline orbit_client_protos::FunctionInfo::OrbitType FunctionHandle::orbit_type() const {
+  return table_->orbit_type(index_);
+}
+
+}  // namespace orbit_client_data
+
+#endif  // CLIENT_DATA_FUNCTION_TABLE_H_
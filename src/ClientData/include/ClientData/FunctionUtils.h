@@ -9,7 +9,9 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "ClientData/ModuleData.h"
 #include "ProcessData.h"
@@ -55,7 +57,7 @@ namespace function_utils {
 [[nodiscard]] const absl::flat_hash_map<std::string, orbit_client_protos::FunctionInfo::OrbitType>&
 GetFunctionNameToOrbitTypeMap();
 [[nodiscard]] orbit_client_protos::FunctionInfo::OrbitType GetOrbitTypeByName(
-    const std::string& function_name);
+    std::string_view function_name);
 void SetOrbitTypeFromName(orbit_client_protos::FunctionInfo* func);
 
 }  // namespace function_utils
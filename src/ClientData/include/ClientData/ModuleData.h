@@ -5,24 +5,33 @@
 #ifndef CLIENT_DATA_MODULE_DATA_H_
 #define CLIENT_DATA_MODULE_DATA_H_
 
+#include <google/protobuf/arena.h>
+
+#include <atomic>
 #include <cinttypes>
 #include <cstdint>
-#include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "ClientData/FunctionTable.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "capture_data.pb.h"
 #include "module.pb.h"
 #include "symbol.pb.h"
 
 namespace orbit_client_data {
 
-// Represents information about module on the client
+// Represents information about module on the client.
+// The functions of a module are stored in a FunctionTable. Once published, a table is never
+// modified, only replaced, so the lookups don't take any lock. A replaced table is freed as soon as
+// no lookup can still be reading it, unless a caller of GetFunctions still holds it.
 class ModuleData final {
  public:
   explicit ModuleData(orbit_grpc_protos::ModuleInfo info)
@@ -43,6 +52,8 @@ class ModuleData final {
   // returns true if update was successful or no update was needed and false if module
   // cannot be updated because it was loaded.
   [[nodiscard]] bool UpdateIfChangedAndNotLoaded(orbit_grpc_protos::ModuleInfo info);
+  // The FunctionInfos returned by the lookups below are created on first use and stay valid for
+  // the lifetime of the ModuleData.
   // offset here is the absolute address minus the address this module was loaded at by
   // the process (module base address)
   [[nodiscard]] const orbit_client_protos::FunctionInfo* FindFunctionByOffset(uint64_t offset,
@@ -50,28 +61,61 @@ class ModuleData final {
   [[nodiscard]] const orbit_client_protos::FunctionInfo* FindFunctionByElfAddress(
       uint64_t elf_address, bool is_exact) const;
   void AddSymbols(const orbit_grpc_protos::ModuleSymbols& module_symbols);
-  void AddFunctionInfoWithBuildId(const orbit_client_protos::FunctionInfo& function_info,
-                                  const std::string& module_build_id);
+  // Adds all the functions at once, as each call publishes a new table of functions.
+  void AddFunctionInfosWithBuildId(
+      absl::Span<const orbit_client_protos::FunctionInfo> function_infos,
+      const std::string& module_build_id);
   [[nodiscard]] const orbit_client_protos::FunctionInfo* FindFunctionFromHash(uint64_t hash) const;
   [[nodiscard]] const orbit_client_protos::FunctionInfo* FindFunctionFromPrettyName(
       std::string_view pretty_name) const;
-  [[nodiscard]] std::vector<const orbit_client_protos::FunctionInfo*> GetFunctions() const;
-  [[nodiscard]] std::vector<orbit_client_protos::FunctionInfo> GetOrbitFunctions() const;
+  // The functions sorted by address. The table, and the handles to its functions, stay valid as
+  // long as the returned pointer is held, even if the functions of the module are replaced.
+  [[nodiscard]] std::shared_ptr<const FunctionTable> GetFunctions() const;
 
  private:
+  struct Functions {
+    std::shared_ptr<const FunctionTable> table;
+    // The FunctionInfo of each function of the table that was looked up, or null.
+    std::unique_ptr<std::atomic<const orbit_client_protos::FunctionInfo*>[]> function_infos;
+  };
+
+  // Counts the lookups that are reading `functions_` for as long as it is in scope.
+  class ScopedLookup {
+   public:
+    explicit ScopedLookup(std::atomic<uint32_t>* num_lookups) : num_lookups_(num_lookups) {
+      num_lookups_->fetch_add(1);
+    }
+    ScopedLookup(const ScopedLookup&) = delete;
+    ScopedLookup& operator=(const ScopedLookup&) = delete;
+    ~ScopedLookup() { num_lookups_->fetch_sub(1); }
+
+   private:
+    std::atomic<uint32_t>* num_lookups_;
+  };
+
   [[nodiscard]] bool NeedsUpdate(const orbit_grpc_protos::ModuleInfo& info) const;
+  // Makes `functions` the current functions, which can be null, and frees the replaced ones if no
+  // lookup is in progress. Otherwise they are freed by a later call or with the ModuleData.
+  void PublishFunctions(std::unique_ptr<const Functions> functions)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  [[nodiscard]] const orbit_client_protos::FunctionInfo* GetOrCreateFunctionInfo(
+      const Functions& functions, uint32_t index) const;
 
+  // Serializes the updates of the module. Lookups don't need it.
   mutable absl::Mutex mutex_;
   orbit_grpc_protos::ModuleInfo module_info_;
-  bool is_loaded_;
-  std::map<uint64_t, std::unique_ptr<orbit_client_protos::FunctionInfo>> functions_;
-  absl::flat_hash_map<std::string_view, orbit_client_protos::FunctionInfo*>
-      name_to_function_info_map_;
+  std::atomic<bool> is_loaded_;
+  std::unique_ptr<const Functions> current_functions_ ABSL_GUARDED_BY(mutex_);
+  // Replaced functions that lookups might still be reading.
+  std::vector<std::unique_ptr<const Functions>> retired_functions_ ABSL_GUARDED_BY(mutex_);
+  // Points to `*current_functions_`, for the lookups.
+  std::atomic<const Functions*> functions_ = nullptr;
+  mutable std::atomic<uint32_t> num_lookups_in_progress_ = 0;
 
-  // TODO(b/168799822) This is a map of hash to function used for preset loading. Currently presets
-  // are based on a hash of the functions pretty name. This should be changed to not use hashes
-  // anymore.
-  absl::flat_hash_map<uint64_t, orbit_client_protos::FunctionInfo*> hash_to_function_map_;
+  // Only the functions that are looked up get a FunctionInfo, which is kept when the functions of
+  // the module are replaced, so that the FunctionInfos handed out stay valid.
+  mutable absl::Mutex function_info_mutex_;
+  mutable google::protobuf::Arena function_info_arena_ ABSL_GUARDED_BY(function_info_mutex_);
 };
 
 }  // namespace orbit_client_data
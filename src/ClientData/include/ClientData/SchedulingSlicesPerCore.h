@@ -0,0 +1,88 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CLIENT_DATA_SCHEDULING_SLICES_PER_CORE_H_
+#define CLIENT_DATA_SCHEDULING_SLICES_PER_CORE_H_
+
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace orbit_client_data {
+
+struct SchedulingSliceInfo {
+  int32_t pid;
+  int32_t tid;
+  int32_t core;
+  uint64_t start_ns;
+  uint64_t end_ns;
+};
+
+// Stores the scheduling slices of a capture, that is, the time ranges during which each thread ran
+// on each core. For system-wide captures these are by far the most numerous timers, so instead of
+// one TextBox (with a full TimerInfo) per slice, each core keeps three parallel arrays (start, end,
+// and an index into a dictionary of (pid, tid) pairs shared by all cores), which take 20 bytes per
+// slice. The slices of a core are kept sorted by start timestamp.
+//
+// Slices can be added from one thread while they are read from others.
+class SchedulingSlicesPerCore {
+ public:
+  void AddSlice(int32_t pid, int32_t tid, int32_t core, uint64_t start_ns, uint64_t end_ns);
+
+  [[nodiscard]] size_t GetNumSlices() const;
+  // One more than the highest core that has slices.
+  [[nodiscard]] uint32_t GetNumCores() const;
+
+  // Calls `visitor(const SchedulingSliceInfo&)` for each slice of `core` that intersects
+  // [min_ns, max_ns], in order of start timestamp. The visitor returns false to stop early. Slices
+  // must not be added from the visitor.
+  template <typename Visitor>
+  void ForEachSliceInRange(int32_t core, uint64_t min_ns, uint64_t max_ns,
+                           Visitor&& visitor) const {
+    absl::ReaderMutexLock lock(&mutex_);
+    if (core < 0 || static_cast<size_t>(core) >= cores_.size()) return;
+    const Core& slices = cores_[core];
+    // Slices of a core normally don't overlap, but they can when events were lost. Starting from
+    // the longest slice's duration before `min_ns` makes sure that no intersecting slice is missed.
+    const uint64_t search_start_ns =
+        min_ns > slices.max_duration_ns ? min_ns - slices.max_duration_ns : 0;
+    auto it = std::lower_bound(slices.start_ns.begin(), slices.start_ns.end(), search_start_ns);
+    for (size_t i = it - slices.start_ns.begin(); i < slices.start_ns.size(); ++i) {
+      if (slices.start_ns[i] > max_ns) break;
+      if (slices.end_ns[i] < min_ns) continue;
+      const std::pair<int32_t, int32_t>& thread = threads_[slices.thread_indices[i]];
+      if (!visitor(SchedulingSliceInfo{thread.first, thread.second, core, slices.start_ns[i],
+                                       slices.end_ns[i]})) {
+        return;
+      }
+    }
+  }
+
+ private:
+  struct Core {
+    std::vector<uint64_t> start_ns;
+    std::vector<uint64_t> end_ns;
+    std::vector<uint32_t> thread_indices;
+    uint64_t max_duration_ns = 0;
+  };
+
+  mutable absl::Mutex mutex_;
+  // Indexed by core.
+  std::vector<Core> cores_ ABSL_GUARDED_BY(mutex_);
+  // (pid, tid) pairs referenced by Core::thread_indices, and their indices.
+  std::vector<std::pair<int32_t, int32_t>> threads_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::pair<int32_t, int32_t>, uint32_t> thread_indices_
+      ABSL_GUARDED_BY(mutex_);
+  size_t num_slices_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace orbit_client_data
+
+#endif  // CLIENT_DATA_SCHEDULING_SLICES_PER_CORE_H_
@@ -90,17 +90,23 @@ const FunctionStats& CaptureData::GetFunctionStatsOrDefault(
 }
 
 void CaptureData::UpdateFunctionStats(uint64_t instrumented_function_id, uint64_t elapsed_nanos) {
+  UpdateFunctionStats(instrumented_function_id, 1, elapsed_nanos, elapsed_nanos, elapsed_nanos);
+}
+
+void CaptureData::UpdateFunctionStats(uint64_t instrumented_function_id, uint64_t count,
+                                      uint64_t total_nanos, uint64_t min_nanos,
+                                      uint64_t max_nanos) {
   FunctionStats& stats = functions_stats_[instrumented_function_id];
-  stats.set_count(stats.count() + 1);
-  stats.set_total_time_ns(stats.total_time_ns() + elapsed_nanos);
+  stats.set_count(stats.count() + count);
+  stats.set_total_time_ns(stats.total_time_ns() + total_nanos);
   stats.set_average_time_ns(stats.total_time_ns() / stats.count());
 
-  if (elapsed_nanos > stats.max_ns()) {
-    stats.set_max_ns(elapsed_nanos);
+  if (max_nanos > stats.max_ns()) {
+    stats.set_max_ns(max_nanos);
   }
 
-  if (stats.min_ns() == 0 || elapsed_nanos < stats.min_ns()) {
-    stats.set_min_ns(elapsed_nanos);
+  if (stats.min_ns() == 0 || min_nanos < stats.min_ns()) {
+    stats.set_min_ns(min_nanos);
   }
 }
 
@@ -128,17 +134,22 @@ std::optional<uint64_t> CaptureData::FindInstrumentedFunctionIdSlow(
   return std::nullopt;
 }
 
-const LinuxAddressInfo* CaptureData::GetAddressInfo(uint64_t absolute_address) const {
+std::optional<LinuxAddressInfo> CaptureData::GetAddressInfo(uint64_t absolute_address) const {
+  absl::MutexLock lock{&address_infos_mutex_};
   auto address_info_it = address_infos_.find(absolute_address);
   if (address_info_it == address_infos_.end()) {
-    return nullptr;
+    return std::nullopt;
   }
-  return &address_info_it->second;
+  return address_info_it->second;
 }
 
 void CaptureData::InsertAddressInfo(LinuxAddressInfo address_info) {
   const uint64_t absolute_address = address_info.absolute_address();
   const uint64_t absolute_function_address = absolute_address - address_info.offset_in_function();
+  absl::MutexLock lock{&address_infos_mutex_};
+  // Addresses in JIT-compiled code can be reused for different functions during the capture. As
+  // address infos are only identified by the address, the first address info received for an
+  // address is kept, so that the samples already attributed to it don't change function.
   // Ensure we know the symbols also for the resolved function address;
   if (!address_infos_.contains(absolute_function_address)) {
     LinuxAddressInfo function_info;
@@ -152,11 +163,12 @@ void CaptureData::InsertAddressInfo(LinuxAddressInfo address_info) {
 
 const std::string CaptureData::kUnknownFunctionOrModuleName{"???"};
 
-const std::string& CaptureData::GetFunctionNameByAddress(uint64_t absolute_address) const {
+std::string CaptureData::GetFunctionNameByAddress(uint64_t absolute_address) const {
   const FunctionInfo* function = FindFunctionByAddress(absolute_address, false);
   if (function != nullptr) {
     return orbit_client_data::function_utils::GetDisplayName(*function);
   }
+  absl::MutexLock lock{&address_infos_mutex_};
   const auto address_info_it = address_infos_.find(absolute_address);
   if (address_info_it == address_infos_.end()) {
     return kUnknownFunctionOrModuleName;
@@ -186,8 +198,8 @@ std::optional<uint64_t> CaptureData::FindFunctionAbsoluteAddressByInstructionAbs
 std::optional<uint64_t>
 CaptureData::FindFunctionAbsoluteAddressByInstructionAbsoluteAddressUsingAddressInfo(
     uint64_t absolute_address) const {
-  const LinuxAddressInfo* address_info = GetAddressInfo(absolute_address);
-  if (address_info == nullptr) return std::nullopt;
+  const std::optional<LinuxAddressInfo> address_info = GetAddressInfo(absolute_address);
+  if (!address_info.has_value()) return std::nullopt;
 
   return absolute_address - address_info->offset_in_function();
 }
@@ -235,11 +247,12 @@ std::optional<std::string> CaptureData::FindModuleBuildIdByAddress(
   return module_data->build_id();
 }
 
-const std::string& CaptureData::GetModulePathByAddress(uint64_t absolute_address) const {
+std::string CaptureData::GetModulePathByAddress(uint64_t absolute_address) const {
   const ModuleData* module_data = FindModuleByAddress(absolute_address);
   if (module_data != nullptr) {
     return module_data->file_path();
   }
+  absl::MutexLock lock{&address_infos_mutex_};
   const auto address_info_it = address_infos_.find(absolute_address);
   if (address_info_it == address_infos_.end()) {
     return kUnknownFunctionOrModuleName;
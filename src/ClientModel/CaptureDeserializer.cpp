@@ -172,6 +172,8 @@ ErrorMessageOr<CaptureListener::CaptureOutcome> LoadCaptureInfo(
   CaptureOptions* capture_options = capture_started.mutable_capture_options();
   capture_options->set_pid(capture_info.process().pid());
   absl::flat_hash_map<uint64_t, orbit_grpc_protos::InstrumentedFunction> instrumented_functions;
+  absl::flat_hash_map<ModuleData*, std::vector<orbit_client_protos::FunctionInfo>>
+      functions_per_module;
   for (const auto& function : capture_info.instrumented_functions()) {
     orbit_grpc_protos::InstrumentedFunction instrumented_function;
     instrumented_function.set_function_id(function.first);
@@ -196,9 +198,12 @@ ErrorMessageOr<CaptureListener::CaptureOutcome> LoadCaptureInfo(
         orbit_client_data::function_utils::Offset(function.second, *module_data));
     instrumented_functions.insert_or_assign(function.first, instrumented_function);
 
-    module_data->AddFunctionInfoWithBuildId(function.second, module_data->build_id());
+    functions_per_module[module_data].push_back(function.second);
     *capture_options->add_instrumented_functions() = std::move(instrumented_function);
   }
+  for (const auto& [module_data, functions] : functions_per_module) {
+    module_data->AddFunctionInfosWithBuildId(functions, module_data->build_id());
+  }
 
   TracepointInfoSet selected_tracepoints;
   for (const orbit_client_protos::TracepointInfo& tracepoint_info :
@@ -57,6 +57,8 @@ class MockCaptureListener : public orbit_capture_client::CaptureListener {
       orbit_grpc_protos::LostPerfRecordsEvent /*lost_perf_records_event*/) override {}
   void OnOutOfOrderEventsDiscardedEvent(orbit_grpc_protos::OutOfOrderEventsDiscardedEvent
                                         /*out_of_order_events_discarded_event*/) override {}
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/) override {}
 };
 
 void WriteMessage(const google::protobuf::Message* message,
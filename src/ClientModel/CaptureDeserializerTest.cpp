@@ -101,6 +101,9 @@ class MockCaptureListener : public CaptureListener {
       void, OnOutOfOrderEventsDiscardedEvent,
       (orbit_grpc_protos::OutOfOrderEventsDiscardedEvent /*out_of_order_events_discarded_event*/),
       (override));
+  MOCK_METHOD(void, OnUnwindingErrorsSummaryEvent,
+              (orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/),
+              (override));
 };
 
 TEST(CaptureDeserializer, LoadFileNotExists) {
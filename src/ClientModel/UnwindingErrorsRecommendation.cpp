@@ -0,0 +1,162 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ClientModel/UnwindingErrorsRecommendation.h"
+
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_join.h>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "GrpcProtos/Constants.h"
+
+using orbit_grpc_protos::CaptureOptions;
+using orbit_grpc_protos::kMaxStackDumpSize;
+using orbit_grpc_protos::UnwindingErrorCounts;
+using orbit_grpc_protos::UnwindingErrorsSummaryEvent;
+
+namespace orbit_client_model {
+
+namespace {
+// Below this percentage of failed samples, the unwinding settings are considered fine.
+constexpr uint64_t kMinErrorPercentageForRecommendation = 5;
+// A smaller stack dump size is only suggested if it at most halves the current one.
+constexpr uint32_t kMinStackDumpSizeReductionFactor = 2;
+// Margin applied to the largest stack size that was observed, as it is only a sample.
+constexpr uint64_t kStackSizeMarginFactor = 2;
+constexpr uint32_t kStackDumpSizeGranularity = 512;
+constexpr size_t kMaxModulesInMessage = 3;
+
+[[nodiscard]] uint64_t GetErrorsCount(const UnwindingErrorCounts& counts) {
+  return counts.stack_dump_too_small() + counts.missing_unwind_info() +
+         counts.missing_frame_pointer() + counts.unknown_map() + counts.in_uprobes() +
+         counts.uprobes_patching_failed();
+}
+
+[[nodiscard]] uint32_t RoundUpStackDumpSize(uint64_t stack_size) {
+  uint64_t rounded = (stack_size + kStackDumpSizeGranularity - 1) / kStackDumpSizeGranularity *
+                     kStackDumpSizeGranularity;
+  return static_cast<uint32_t>(std::min<uint64_t>(rounded, kMaxStackDumpSize));
+}
+
+[[nodiscard]] bool IsSignificant(uint64_t count, uint64_t total_count) {
+  return count > 0 && count * 100 >= total_count * kMinErrorPercentageForRecommendation;
+}
+
+std::optional<UnwindingSettingsRecommendation> RecommendLargerStackDumpSize(
+    const UnwindingErrorsSummaryEvent& summary) {
+  const uint32_t current_size = summary.stack_dump_size();
+  if (current_size >= kMaxStackDumpSize) {
+    if (summary.unwinding_method() != CaptureOptions::kDwarf) return std::nullopt;
+    UnwindingSettingsRecommendation recommendation;
+    recommendation.unwinding_method = CaptureOptions::kFramePointers;
+    recommendation.message =
+        "Many samples could not be unwound because the stack is larger than the maximum stack "
+        "dump size. Consider using frame pointer unwinding, which does not depend on the stack "
+        "dump size, after compiling with -fno-omit-frame-pointer.";
+    return recommendation;
+  }
+
+  const uint64_t required_size =
+      std::max<uint64_t>(uint64_t{current_size} * 2, summary.max_required_stack_size());
+  UnwindingSettingsRecommendation recommendation;
+  recommendation.stack_dump_size = RoundUpStackDumpSize(required_size);
+  recommendation.message = absl::StrFormat(
+      "Many samples could not be unwound because the stack dump size (%u bytes) was too small. "
+      "Consider increasing it to %u bytes.",
+      current_size, recommendation.stack_dump_size.value());
+  return recommendation;
+}
+
+std::optional<UnwindingSettingsRecommendation> RecommendSmallerStackDumpSize(
+    const UnwindingErrorsSummaryEvent& summary) {
+  if (summary.unwinding_method() != CaptureOptions::kDwarf) return std::nullopt;
+  if (summary.total_errors().stack_dump_too_small() > 0) return std::nullopt;
+  if (summary.max_used_stack_size() == 0) return std::nullopt;
+
+  const uint32_t current_size = summary.stack_dump_size();
+  const uint32_t suggested_size =
+      RoundUpStackDumpSize(summary.max_used_stack_size() * kStackSizeMarginFactor);
+  if (suggested_size * kMinStackDumpSizeReductionFactor > current_size) return std::nullopt;
+
+  UnwindingSettingsRecommendation recommendation;
+  recommendation.stack_dump_size = suggested_size;
+  recommendation.message = absl::StrFormat(
+      "No sample used more than %u bytes of the %u bytes of stack dump. Consider reducing the "
+      "stack dump size to %u bytes to lower the sampling overhead.",
+      summary.max_used_stack_size(), current_size, suggested_size);
+  return recommendation;
+}
+}  // namespace
+
+std::string CreateUnwindingErrorsSummaryMessage(const UnwindingErrorsSummaryEvent& summary) {
+  const UnwindingErrorCounts& errors = summary.total_errors();
+  const uint64_t errors_count = GetErrorsCount(errors);
+  const uint64_t samples_count = summary.total_samples_count();
+  std::string message = absl::StrFormat(
+      "%u of %u samples (%.1f%%) could not be unwound", errors_count, samples_count,
+      samples_count == 0 ? 0.0 : 100.0 * errors_count / samples_count);
+  if (errors_count == 0) return message + ".";
+
+  std::vector<std::string> error_descriptions;
+  auto add_error_description = [&error_descriptions](uint64_t count, std::string_view reason) {
+    if (count > 0) error_descriptions.push_back(absl::StrFormat("%u %s", count, reason));
+  };
+  add_error_description(errors.stack_dump_too_small(), "stack dump too small");
+  add_error_description(errors.missing_unwind_info(), "missing unwind info");
+  add_error_description(errors.missing_frame_pointer(), "missing frame pointer");
+  add_error_description(errors.unknown_map(), "unknown memory map");
+  add_error_description(errors.in_uprobes(), "in uprobes");
+  add_error_description(errors.uprobes_patching_failed(), "return address patching failed");
+  absl::StrAppend(&message, ": ", absl::StrJoin(error_descriptions, ", "), ".");
+
+  std::vector<std::string> module_descriptions;
+  for (const UnwindingErrorsSummaryEvent::ModuleErrors& module_errors : summary.modules()) {
+    if (module_descriptions.size() == kMaxModulesInMessage) break;
+    module_descriptions.push_back(absl::StrFormat("%s (%u)", module_errors.module_path(),
+                                                  GetErrorsCount(module_errors.errors())));
+  }
+  if (!module_descriptions.empty()) {
+    absl::StrAppend(&message, " Most affected modules: ", absl::StrJoin(module_descriptions, ", "),
+                    ".");
+  }
+  return message;
+}
+
+std::optional<UnwindingSettingsRecommendation> RecommendUnwindingSettings(
+    const UnwindingErrorsSummaryEvent& summary) {
+  const uint64_t samples_count = summary.total_samples_count();
+  if (samples_count == 0) return std::nullopt;
+
+  const UnwindingErrorCounts& errors = summary.total_errors();
+  const uint64_t errors_count = GetErrorsCount(errors);
+  if (!IsSignificant(errors_count, samples_count)) {
+    return RecommendSmallerStackDumpSize(summary);
+  }
+
+  // Only the most frequent kind of error is addressed, as it is the one that changing the settings
+  // can fix most samples of.
+  if (IsSignificant(errors.stack_dump_too_small(), samples_count) &&
+      errors.stack_dump_too_small() >= errors.missing_frame_pointer()) {
+    return RecommendLargerStackDumpSize(summary);
+  }
+
+  if (summary.unwinding_method() == CaptureOptions::kFramePointers &&
+      IsSignificant(errors.missing_frame_pointer(), samples_count)) {
+    UnwindingSettingsRecommendation recommendation;
+    recommendation.unwinding_method = CaptureOptions::kDwarf;
+    recommendation.message =
+        "Many samples could not be unwound because of missing frame pointers. Consider using "
+        "DWARF unwinding, or compiling the affected modules with -fno-omit-frame-pointer.";
+    return recommendation;
+  }
+
+  return std::nullopt;
+}
+
+}  // namespace orbit_client_model
@@ -0,0 +1,128 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <string>
+
+#include "ClientModel/UnwindingErrorsRecommendation.h"
+#include "GrpcProtos/Constants.h"
+#include "capture.pb.h"
+
+using orbit_grpc_protos::CaptureOptions;
+using orbit_grpc_protos::kMaxStackDumpSize;
+using orbit_grpc_protos::UnwindingErrorsSummaryEvent;
+
+namespace orbit_client_model {
+
+namespace {
+UnwindingErrorsSummaryEvent CreateSummary(CaptureOptions::UnwindingMethod unwinding_method,
+                                          uint32_t stack_dump_size, uint64_t total_samples_count) {
+  UnwindingErrorsSummaryEvent summary;
+  summary.set_unwinding_method(unwinding_method);
+  summary.set_stack_dump_size(stack_dump_size);
+  summary.set_total_samples_count(total_samples_count);
+  return summary;
+}
+}  // namespace
+
+TEST(UnwindingErrorsRecommendation, NoRecommendationWithoutSamples) {
+  UnwindingErrorsSummaryEvent summary = CreateSummary(CaptureOptions::kDwarf, 65000, 0);
+  EXPECT_FALSE(RecommendUnwindingSettings(summary).has_value());
+}
+
+TEST(UnwindingErrorsRecommendation, NoRecommendationWithFewErrors) {
+  UnwindingErrorsSummaryEvent summary = CreateSummary(CaptureOptions::kDwarf, 8192, 1000);
+  summary.mutable_total_errors()->set_stack_dump_too_small(10);
+  summary.mutable_total_errors()->set_missing_unwind_info(20);
+  summary.set_max_used_stack_size(6000);
+  EXPECT_FALSE(RecommendUnwindingSettings(summary).has_value());
+}
+
+TEST(UnwindingErrorsRecommendation, RecommendsLargerStackDumpSize) {
+  UnwindingErrorsSummaryEvent summary = CreateSummary(CaptureOptions::kDwarf, 8192, 1000);
+  summary.mutable_total_errors()->set_stack_dump_too_small(300);
+
+  std::optional<UnwindingSettingsRecommendation> recommendation =
+      RecommendUnwindingSettings(summary);
+  ASSERT_TRUE(recommendation.has_value());
+  EXPECT_EQ(recommendation->stack_dump_size, 16384);
+  EXPECT_FALSE(recommendation->unwinding_method.has_value());
+  EXPECT_FALSE(recommendation->message.empty());
+
+  // The size that was required by samples is used if it is larger, rounded up and capped.
+  summary.set_max_required_stack_size(20000);
+  recommendation = RecommendUnwindingSettings(summary);
+  ASSERT_TRUE(recommendation.has_value());
+  EXPECT_EQ(recommendation->stack_dump_size, 20480);
+
+  summary.set_max_required_stack_size(100000);
+  recommendation = RecommendUnwindingSettings(summary);
+  ASSERT_TRUE(recommendation.has_value());
+  EXPECT_EQ(recommendation->stack_dump_size, kMaxStackDumpSize);
+}
+
+TEST(UnwindingErrorsRecommendation, RecommendsFramePointersWhenStackDumpSizeIsMaximum) {
+  UnwindingErrorsSummaryEvent summary =
+      CreateSummary(CaptureOptions::kDwarf, kMaxStackDumpSize, 1000);
+  summary.mutable_total_errors()->set_stack_dump_too_small(300);
+
+  std::optional<UnwindingSettingsRecommendation> recommendation =
+      RecommendUnwindingSettings(summary);
+  ASSERT_TRUE(recommendation.has_value());
+  EXPECT_FALSE(recommendation->stack_dump_size.has_value());
+  EXPECT_EQ(recommendation->unwinding_method, CaptureOptions::kFramePointers);
+}
+
+TEST(UnwindingErrorsRecommendation, RecommendsDwarfForMissingFramePointers) {
+  UnwindingErrorsSummaryEvent summary = CreateSummary(CaptureOptions::kFramePointers, 512, 1000);
+  summary.mutable_total_errors()->set_missing_frame_pointer(200);
+  summary.mutable_total_errors()->set_stack_dump_too_small(60);
+
+  std::optional<UnwindingSettingsRecommendation> recommendation =
+      RecommendUnwindingSettings(summary);
+  ASSERT_TRUE(recommendation.has_value());
+  EXPECT_EQ(recommendation->unwinding_method, CaptureOptions::kDwarf);
+  EXPECT_FALSE(recommendation->stack_dump_size.has_value());
+}
+
+TEST(UnwindingErrorsRecommendation, RecommendsSmallerStackDumpSize) {
+  UnwindingErrorsSummaryEvent summary = CreateSummary(CaptureOptions::kDwarf, 65000, 1000);
+  summary.set_max_used_stack_size(3000);
+
+  std::optional<UnwindingSettingsRecommendation> recommendation =
+      RecommendUnwindingSettings(summary);
+  ASSERT_TRUE(recommendation.has_value());
+  EXPECT_EQ(recommendation->stack_dump_size, 6144);
+
+  // Not worth it if the stack dump size would not even be halved.
+  summary.set_max_used_stack_size(20000);
+  EXPECT_FALSE(RecommendUnwindingSettings(summary).has_value());
+
+  // Not safe if some samples already needed a larger stack dump.
+  summary.set_max_used_stack_size(3000);
+  summary.mutable_total_errors()->set_stack_dump_too_small(1);
+  EXPECT_FALSE(RecommendUnwindingSettings(summary).has_value());
+}
+
+TEST(UnwindingErrorsRecommendation, SummaryMessage) {
+  UnwindingErrorsSummaryEvent summary = CreateSummary(CaptureOptions::kDwarf, 8192, 200);
+  EXPECT_EQ(CreateUnwindingErrorsSummaryMessage(summary),
+            "0 of 200 samples (0.0%) could not be unwound.");
+
+  summary.mutable_total_errors()->set_stack_dump_too_small(30);
+  summary.mutable_total_errors()->set_unknown_map(20);
+  UnwindingErrorsSummaryEvent::ModuleErrors* module_errors = summary.add_modules();
+  module_errors->set_module_path("/path/to/a.so");
+  module_errors->mutable_errors()->set_stack_dump_too_small(30);
+  module_errors = summary.add_modules();
+  module_errors->set_module_path("[unknown]");
+  module_errors->mutable_errors()->set_unknown_map(20);
+  EXPECT_EQ(CreateUnwindingErrorsSummaryMessage(summary),
+            "50 of 200 samples (25.0%) could not be unwound: 30 stack dump too small, 20 unknown "
+            "memory map. Most affected modules: /path/to/a.so (30), [unknown] (20).");
+}
+
+}  // namespace orbit_client_model
@@ -69,22 +69,26 @@ class CaptureData {
 
   [[nodiscard]] absl::Time capture_start_time() const { return capture_start_time_; }
 
+  // This is not synchronized with InsertAddressInfo, so it must not be used while capturing.
   [[nodiscard]] const absl::flat_hash_map<uint64_t, orbit_client_protos::LinuxAddressInfo>&
   address_infos() const {
     return address_infos_;
   }
 
-  [[nodiscard]] const orbit_client_protos::LinuxAddressInfo* GetAddressInfo(
+  // Address infos are added by the capture thread, while the sampling data can already be
+  // post-processed on other threads. Hence, the lookups of address infos, including
+  // GetFunctionNameByAddress and GetModulePathByAddress, return copies.
+  [[nodiscard]] std::optional<orbit_client_protos::LinuxAddressInfo> GetAddressInfo(
       uint64_t absolute_address) const;
 
   void InsertAddressInfo(orbit_client_protos::LinuxAddressInfo address_info);
 
-  [[nodiscard]] const std::string& GetFunctionNameByAddress(uint64_t absolute_address) const;
+  [[nodiscard]] std::string GetFunctionNameByAddress(uint64_t absolute_address) const;
   [[nodiscard]] std::optional<uint64_t> FindFunctionAbsoluteAddressByInstructionAbsoluteAddress(
       uint64_t absolute_address) const;
   [[nodiscard]] const orbit_client_protos::FunctionInfo* FindFunctionByModulePathBuildIdAndOffset(
       const std::string& module_path, const std::string& build_id, uint64_t offset) const;
-  [[nodiscard]] const std::string& GetModulePathByAddress(uint64_t absolute_address) const;
+  [[nodiscard]] std::string GetModulePathByAddress(uint64_t absolute_address) const;
   [[nodiscard]] std::optional<std::string> FindModuleBuildIdByAddress(
       uint64_t absolute_address) const;
   [[nodiscard]] const orbit_client_data::ModuleData* GetModuleByPathAndBuildId(
@@ -143,6 +147,9 @@ class CaptureData {
       uint64_t instrumented_function_id) const;
 
   void UpdateFunctionStats(uint64_t instrumented_function_id, uint64_t elapsed_nanos);
+  // Accounts for `count` calls at once, e.g., for calls that were coalesced into a single timer.
+  void UpdateFunctionStats(uint64_t instrumented_function_id, uint64_t count, uint64_t total_nanos,
+                           uint64_t min_nanos, uint64_t max_nanos);
 
   [[nodiscard]] const orbit_client_data::CallstackData* GetCallstackData() const {
     return callstack_data_.get();
@@ -258,6 +265,7 @@ class CaptureData {
   std::optional<orbit_client_data::PostProcessedSamplingData> post_processed_sampling_data_;
 
   absl::flat_hash_map<uint64_t, orbit_client_protos::LinuxAddressInfo> address_infos_;
+  mutable absl::Mutex address_infos_mutex_;
 
   absl::flat_hash_map<uint64_t, orbit_client_protos::FunctionStats> functions_stats_;
 
@@ -0,0 +1,38 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CLIENT_MODEL_UNWINDING_ERRORS_RECOMMENDATION_H_
+#define CLIENT_MODEL_UNWINDING_ERRORS_RECOMMENDATION_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "capture.pb.h"
+
+namespace orbit_client_model {
+
+struct UnwindingSettingsRecommendation {
+  // Only set if the stack dump size should be changed.
+  std::optional<uint32_t> stack_dump_size;
+  // Only set if the unwinding method should be changed.
+  std::optional<orbit_grpc_protos::CaptureOptions::UnwindingMethod> unwinding_method;
+  std::string message;
+};
+
+// Returns a short description of the unwinding errors of a capture, listing the modules in which
+// unwinding failed most often.
+[[nodiscard]] std::string CreateUnwindingErrorsSummaryMessage(
+    const orbit_grpc_protos::UnwindingErrorsSummaryEvent& summary);
+
+// Suggests a stack dump size or unwinding method for the next capture based on the unwinding errors
+// of this one: a larger stack dump size if many samples failed because the dump was too small, a
+// smaller one if the dump was much larger than any sample needed, and frame pointer or DWARF
+// unwinding if frame pointers were missing. Returns std::nullopt if the settings look fine.
+[[nodiscard]] std::optional<UnwindingSettingsRecommendation> RecommendUnwindingSettings(
+    const orbit_grpc_protos::UnwindingErrorsSummaryEvent& summary);
+
+}  // namespace orbit_client_model
+
+#endif  // CLIENT_MODEL_UNWINDING_ERRORS_RECOMMENDATION_H_
@@ -7,6 +7,12 @@
 #include <absl/strings/str_split.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "OrbitBase/Logging.h"
+
 namespace orbit_code_report {
 
 static std::vector<std::string_view> SplitIntoLines(std::string_view source_file_contents) {
@@ -18,39 +24,85 @@ static std::vector<std::string_view> SplitIntoLines(std::string_view source_file
   return source_file_lines;
 }
 
-[[nodiscard]] std::vector<AnnotatingLine> AnnotateDisassemblyWithSourceCode(
-    const orbit_client_protos::FunctionInfo& function_info,
-    const orbit_grpc_protos::LineInfo& location_info, std::string_view source_file_contents,
-    orbit_object_utils::ElfFile* elf, const DisassemblyReport& report) {
-  const std::vector<std::string_view> source_file_lines = SplitIntoLines(source_file_contents);
+DisassemblyAnnotator::DisassemblyAnnotator(orbit_client_protos::FunctionInfo function_info,
+                                           orbit_grpc_protos::LineInfo location_info,
+                                           std::string source_file_contents,
+                                           orbit_object_utils::ElfFile* elf,
+                                           const DisassemblyReport* report)
+    : function_info_{std::move(function_info)},
+      location_info_{std::move(location_info)},
+      source_file_contents_{std::move(source_file_contents)},
+      num_source_file_lines_{static_cast<size_t>(
+          std::count(source_file_contents_.begin(), source_file_contents_.end(), '\n') + 1)},
+      elf_{elf},
+      report_{report} {
+  CHECK(elf_ != nullptr);
+  CHECK(report_ != nullptr);
+}
 
-  // We will show each source code line above the first related instruction
-  absl::flat_hash_map<size_t, uint64_t> source_line_to_first_instruction_offset;
+bool DisassemblyAnnotator::AnnotateNextInstructions(size_t max_instructions) {
+  if (!line_table_.has_value()) {
+    ErrorMessageOr<std::vector<orbit_object_utils::LineTableRow>> line_table_or_error =
+        elf_->GetLineTable(function_info_.address(), function_info_.size());
+    if (line_table_or_error.has_error()) {
+      ERROR("Reading the line table of \"%s\": %s", function_info_.pretty_name(),
+            line_table_or_error.error().message());
+      line_table_.emplace();
+    } else {
+      line_table_ = std::move(line_table_or_error.value());
+    }
+  }
 
-  for (uint64_t current_offset = 0; current_offset < function_info.size(); ++current_offset) {
-    const auto line_info_or_error = elf->GetLineInfo(current_offset + function_info.address());
-    if (line_info_or_error.has_error()) continue;
-    if (line_info_or_error.value().source_file() != location_info.source_file()) continue;
-    if (line_info_or_error.value().source_line() == 0) continue;
+  const std::vector<uint64_t>& instruction_addresses = report_->GetInstructionAddresses();
+  const size_t end_index =
+      next_instruction_index_ + std::min(max_instructions,
+                                         instruction_addresses.size() - next_instruction_index_);
+
+  for (; next_instruction_index_ < end_index; ++next_instruction_index_) {
+    const uint64_t instruction_address = instruction_addresses[next_instruction_index_];
+    const uint64_t offset = instruction_address - report_->GetAbsoluteFunctionAddress();
+    if (offset >= function_info_.size()) continue;
+
+    // The row containing the instruction is the last one starting at or before it.
+    const uint64_t address = offset + function_info_.address();
+    auto row_it = std::upper_bound(
+        line_table_->begin(), line_table_->end(), address,
+        [](uint64_t lookup_address, const orbit_object_utils::LineTableRow& row) {
+          return lookup_address < row.address;
+        });
+    if (row_it == line_table_->begin()) continue;
+    const orbit_grpc_protos::LineInfo& line_info = std::prev(row_it)->line_info;
+    if (line_info.source_file() != location_info_.source_file()) continue;
+    if (line_info.source_line() == 0) continue;
+
+    const auto source_line = line_info.source_line() - 1;
+    if (source_line >= num_source_file_lines_) continue;
+
+    // We will show each source code line above the first related instruction
+    source_line_to_first_instruction_address_.emplace(source_line, instruction_address);
+  }
 
-    const auto source_line = line_info_or_error.value().source_line() - 1;
-    if (source_line >= static_cast<size_t>(source_file_lines.size())) continue;
+  return IsDone();
+}
 
-    source_line_to_first_instruction_offset.emplace(source_line, current_offset);
-  }
+bool DisassemblyAnnotator::IsDone() const {
+  return next_instruction_index_ >= report_->GetInstructionAddresses().size();
+}
+
+std::vector<AnnotatingLine> DisassemblyAnnotator::GetAnnotatingLines() const {
+  const std::vector<std::string_view> source_file_lines = SplitIntoLines(source_file_contents_);
 
   std::vector<AnnotatingLine> annotating_lines{};
-  annotating_lines.reserve(source_line_to_first_instruction_offset.size());
+  annotating_lines.reserve(source_line_to_first_instruction_address_.size());
 
-  for (const auto& [source_line, offset] : source_line_to_first_instruction_offset) {
-    const auto disassembly_line_number =
-        report.GetLineAtAddress(report.GetAbsoluteFunctionAddress() + offset);
+  for (const auto& [source_line, address] : source_line_to_first_instruction_address_) {
+    const auto disassembly_line_number = report_->GetLineAtAddress(address);
     if (!disassembly_line_number.has_value()) continue;
 
     AnnotatingLine annotating_line{};
     annotating_line.reference_line = disassembly_line_number.value() + 1;
     annotating_line.line_number = source_line + 1;
-    annotating_line.line_contents = std::string{source_file_lines[static_cast<int>(source_line)]};
+    annotating_line.line_contents = std::string{source_file_lines[source_line]};
     annotating_lines.emplace_back(std::move(annotating_line));
   }
 
@@ -62,4 +114,15 @@ static std::vector<std::string_view> SplitIntoLines(std::string_view source_file
 
   return annotating_lines;
 }
-}  // namespace orbit_code_report
\ No newline at end of file
+
+[[nodiscard]] std::vector<AnnotatingLine> AnnotateDisassemblyWithSourceCode(
+    const orbit_client_protos::FunctionInfo& function_info,
+    const orbit_grpc_protos::LineInfo& location_info, std::string_view source_file_contents,
+    orbit_object_utils::ElfFile* elf, const DisassemblyReport& report) {
+  DisassemblyAnnotator annotator{function_info, location_info, std::string{source_file_contents},
+                                 elf, &report};
+  const bool is_done = annotator.AnnotateNextInstructions(report.GetInstructionAddresses().size());
+  CHECK(is_done);
+  return annotator.GetAnnotatingLines();
+}
+}  // namespace orbit_code_report
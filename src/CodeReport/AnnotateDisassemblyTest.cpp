@@ -88,4 +88,54 @@ static void TestSimple(bool windows_line_endings) {
 }
 
 TEST(AnnotateDisassembly, Simple) { TestSimple(false); }
-TEST(AnnotateDisassembly, SimpleWindowsLineEndings) { TestSimple(true); }
\ No newline at end of file
+TEST(AnnotateDisassembly, SimpleWindowsLineEndings) { TestSimple(true); }
+TEST(AnnotateDisassembly, IncrementalMatchesAnnotateDisassemblyWithSourceCode) {
+  const std::filesystem::path file_path =
+      orbit_base::GetExecutableDir() / "testdata" / "line_info_test_binary";
+
+  auto program = orbit_object_utils::CreateElfFile(file_path);
+  ASSERT_TRUE(program.has_value()) << program.error().message();
+
+  constexpr uint64_t kAddressOfMainFunction = 0x401140;
+  ErrorMessageOr<orbit_grpc_protos::LineInfo> decl_line_info =
+      program.value()->GetDeclarationLocationOfFunction(kAddressOfMainFunction);
+  ASSERT_TRUE(decl_line_info.has_value()) << decl_line_info.error().message();
+
+  ErrorMessageOr<std::string> source_file_contents_or_error = orbit_base::ReadFileToString(
+      orbit_base::GetExecutableDir() / "testdata" / "LineInfoTestBinary.cpp");
+  ASSERT_TRUE(source_file_contents_or_error.has_value())
+      << source_file_contents_or_error.error().message();
+
+  orbit_client_protos::FunctionInfo function_info{};
+  function_info.set_address(kAddressOfMainFunction);
+  function_info.set_size(kMainFunctionInstructions.size());
+
+  orbit_code_report::Disassembler disassembler{};
+  disassembler.Disassemble(static_cast<const void*>(kMainFunctionInstructions.data()),
+                           kMainFunctionInstructions.size(), kAddressOfMainFunction, true);
+  orbit_code_report::DisassemblyReport report{std::move(disassembler), kAddressOfMainFunction};
+
+  const std::vector<orbit_code_report::AnnotatingLine> expected_lines =
+      orbit_code_report::AnnotateDisassemblyWithSourceCode(
+          function_info, decl_line_info.value(), source_file_contents_or_error.value(),
+          program.value().get(), report);
+
+  orbit_code_report::DisassemblyAnnotator annotator{
+      function_info, decl_line_info.value(), source_file_contents_or_error.value(),
+      program.value().get(), &report};
+  size_t num_chunks = 0;
+  while (!annotator.IsDone()) {
+    (void)annotator.AnnotateNextInstructions(1);
+    ++num_chunks;
+  }
+  EXPECT_EQ(num_chunks, report.GetInstructionAddresses().size());
+  EXPECT_TRUE(annotator.AnnotateNextInstructions(1));
+
+  const std::vector<orbit_code_report::AnnotatingLine> lines = annotator.GetAnnotatingLines();
+  ASSERT_EQ(lines.size(), expected_lines.size());
+  for (size_t i = 0; i < lines.size(); ++i) {
+    EXPECT_EQ(lines[i].reference_line, expected_lines[i].reference_line);
+    EXPECT_EQ(lines[i].line_number, expected_lines[i].line_number);
+    EXPECT_EQ(lines[i].line_contents, expected_lines[i].line_contents);
+  }
+}
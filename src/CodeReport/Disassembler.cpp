@@ -5,7 +5,6 @@
 #include "CodeReport/Disassembler.h"
 
 #include <absl/strings/str_format.h>
-#include <absl/strings/str_replace.h>
 #include <capstone/capstone.h>
 
 #include <algorithm>
@@ -16,8 +15,6 @@ void Disassembler::Disassemble(const void* machine_code, size_t size, uint64_t a
                                bool is_64bit) {
   csh handle = 0;
   cs_arch arch = CS_ARCH_X86;
-  cs_insn* insn = nullptr;
-  size_t count = 0;
   cs_err err;
   cs_mode mode = is_64bit ? CS_MODE_64 : CS_MODE_32;
 
@@ -29,27 +26,38 @@ void Disassembler::Disassemble(const void* machine_code, size_t size, uint64_t a
     return;
   }
 
-  count = cs_disasm(handle, static_cast<const uint8_t*>(machine_code), size, address, 0, &insn);
+  // We decode one instruction at a time into the same cs_insn instead of letting cs_disasm
+  // allocate all instructions up front. For large functions this keeps the memory usage flat and
+  // avoids the reallocations cs_disasm does while growing its instruction array.
+  constexpr size_t kEstimatedBytesPerInstruction = 4;
+  constexpr size_t kEstimatedCharactersPerLine = 40;
+  const size_t estimated_instruction_count = size / kEstimatedBytesPerInstruction;
+  result_.reserve(result_.size() + estimated_instruction_count * kEstimatedCharactersPerLine);
+  line_to_address_.reserve(line_to_address_.size() + estimated_instruction_count);
+  instruction_addresses_.reserve(instruction_addresses_.size() + estimated_instruction_count);
+  address_to_line_.reserve(address_to_line_.size() + estimated_instruction_count);
 
-  if (count) {
-    size_t j;
+  cs_insn* insn = cs_malloc(handle);
+  const auto* code = static_cast<const uint8_t*>(machine_code);
+  size_t remaining_size = size;
+  uint64_t next_address = address;
+  size_t count = 0;
 
-    for (j = 0; j < count; j++) {
-      AddLine(
-          absl::StrFormat("0x%llx:\t%-12s %s", insn[j].address, insn[j].mnemonic, insn[j].op_str),
-          insn[j].address);
-    }
+  while (cs_disasm_iter(handle, &code, &remaining_size, &next_address, insn)) {
+    AddLine(absl::StrFormat("0x%llx:\t%-12s %s", insn->address, insn->mnemonic, insn->op_str),
+            insn->address);
+    ++count;
+  }
 
+  if (count) {
     // Print out the next offset, after the last instruction.
-    AddLine(absl::StrFormat("0x%llx:", insn[j - 1].address + insn[j - 1].size));
-
-    // Free memory allocated by cs_disasm().
-    cs_free(insn, count);
+    AddLine(absl::StrFormat("0x%llx:", next_address));
   } else {
     AddLine("****************");
     AddLine("ERROR: Failed to disasm given code!");
   }
 
+  cs_free(insn, 1);
   AddLine("");
   cs_close(&handle);
 }
@@ -66,11 +74,15 @@ std::optional<size_t> Disassembler::GetLineAtAddress(uint64_t address) const {
 }
 
 void Disassembler::AddLine(std::string line, std::optional<uint64_t> address) {
-  if (address.has_value()) address_to_line_[*address] = line_to_address_.size();
+  if (address.has_value()) {
+    address_to_line_[*address] = line_to_address_.size();
+    instruction_addresses_.push_back(*address);
+  }
   line_to_address_.push_back(address.value_or(0ul));
 
   // Remove any new line character.
-  line = absl::StrReplaceAll(line, {{"\n", ""}});
-  result_ += absl::StrFormat("%s\n", line);
+  line.erase(std::remove(line.begin(), line.end(), '\n'), line.end());
+  result_.append(line);
+  result_.push_back('\n');
 }
 }  // namespace orbit_code_report
@@ -4,6 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <vector>
+
 #include "AssemblyTestLiterals.h"
 #include "CodeReport/Disassembler.h"
 
@@ -32,4 +35,19 @@ TEST(Disassembler, Disassemble) {
   EXPECT_EQ(disassembler.GetLineAtAddress(kFibonacciAbsoluteAddress + 0x37).value_or(0), 24);
   EXPECT_FALSE(disassembler.GetLineAtAddress(kFibonacciAbsoluteAddress + 0xdf).has_value());
   EXPECT_FALSE(disassembler.GetLineAtAddress(0x0).has_value());
-}
\ No newline at end of file
+}
+
+TEST(Disassembler, GetInstructionAddresses) {
+  orbit_code_report::Disassembler disassembler{};
+  disassembler.Disassemble(static_cast<const void*>(kFibonacciAssembly.data()),
+                           kFibonacciAssembly.size(), kFibonacciAbsoluteAddress, true);
+  const std::vector<uint64_t>& addresses = disassembler.GetInstructionAddresses();
+  ASSERT_FALSE(addresses.empty());
+  EXPECT_EQ(addresses.front(), kFibonacciAbsoluteAddress);
+  EXPECT_TRUE(std::is_sorted(addresses.begin(), addresses.end()));
+  for (uint64_t address : addresses) {
+    ASSERT_TRUE(disassembler.GetLineAtAddress(address).has_value());
+    EXPECT_EQ(disassembler.GetAddressAtLine(disassembler.GetLineAtAddress(address).value()),
+              address);
+  }
+}
@@ -5,7 +5,13 @@
 #ifndef CODE_REPORT_ANNOTATE_DISASSEMBLY_H_
 #define CODE_REPORT_ANNOTATE_DISASSEMBLY_H_
 
+#include <absl/container/flat_hash_map.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "CodeReport/AnnotatingLine.h"
@@ -16,6 +22,38 @@
 
 namespace orbit_code_report {
 
+// Matches source code lines to machine instructions incrementally, so that the work can be split
+// into chunks. The line table of the function is read from `elf` once, on the first call to
+// `AnnotateNextInstructions`, and each chunk of instructions of the `DisassemblyReport` is resolved
+// against it. `report` and `elf` need to outlive the annotator, and `elf` must not be used by
+// another thread while instructions are annotated.
+class DisassemblyAnnotator {
+ public:
+  DisassemblyAnnotator(orbit_client_protos::FunctionInfo function_info,
+                       orbit_grpc_protos::LineInfo location_info, std::string source_file_contents,
+                       orbit_object_utils::ElfFile* elf, const DisassemblyReport* report);
+
+  // Looks up the source lines of the next `max_instructions` instructions. Returns true if all
+  // instructions have been processed.
+  [[nodiscard]] bool AnnotateNextInstructions(size_t max_instructions);
+  [[nodiscard]] bool IsDone() const;
+
+  // Returns the annotating lines for all instructions processed so far, ordered by reference line.
+  [[nodiscard]] std::vector<AnnotatingLine> GetAnnotatingLines() const;
+
+ private:
+  orbit_client_protos::FunctionInfo function_info_;
+  orbit_grpc_protos::LineInfo location_info_;
+  std::string source_file_contents_;
+  size_t num_source_file_lines_;
+  orbit_object_utils::ElfFile* elf_;
+  const DisassemblyReport* report_;
+
+  std::optional<std::vector<orbit_object_utils::LineTableRow>> line_table_;
+  size_t next_instruction_index_ = 0;
+  absl::flat_hash_map<size_t, uint64_t> source_line_to_first_instruction_address_;
+};
+
 // Matches source code lines to machine instructions. The mapping is determined from debug
 // information (ElfFile). The output reference line numbers in the `DisassemblyReport` and is
 // ordered by those.
@@ -23,10 +23,15 @@ class Disassembler {
   [[nodiscard]] const std::string& GetResult() const { return result_; }
   [[nodiscard]] uint64_t GetAddressAtLine(size_t line) const;
   [[nodiscard]] std::optional<size_t> GetLineAtAddress(uint64_t address) const;
+  // Addresses of all disassembled instructions, in ascending order.
+  [[nodiscard]] const std::vector<uint64_t>& GetInstructionAddresses() const {
+    return instruction_addresses_;
+  }
 
  private:
   std::string result_;
   std::vector<uint64_t> line_to_address_;
+  std::vector<uint64_t> instruction_addresses_;
   absl::flat_hash_map<uint64_t, size_t> address_to_line_;
 };
 }  // namespace orbit_code_report
@@ -10,6 +10,7 @@
 
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "ClientData/PostProcessedSamplingData.h"
 #include "CodeReport/CodeReport.h"
@@ -38,6 +39,9 @@ class DisassemblyReport : public orbit_code_report::CodeReport {
   [[nodiscard]] std::optional<uint32_t> GetNumSamplesAtLine(size_t line) const override;
 
   [[nodiscard]] std::optional<size_t> GetLineAtAddress(uint64_t address) const;
+  [[nodiscard]] const std::vector<uint64_t>& GetInstructionAddresses() const {
+    return disasm_.GetInstructionAddresses();
+  }
 
   [[nodiscard]] uint64_t GetAbsoluteFunctionAddress() const { return absolute_function_address_; }
 
@@ -28,6 +28,7 @@ Dialog::Dialog(QWidget* parent) : QDialog{parent}, ui_{std::make_unique<Ui::Code
 Dialog::~Dialog() noexcept = default;
 
 void Dialog::SetMainContent(const QString& code) {
+  ui_->viewer->SetSyntaxHighlighter(nullptr);
   ui_->viewer->setPlainText(code);
   syntax_highlighter_.reset();
   ui_->viewer->document()->setDefaultFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
@@ -40,6 +41,13 @@ void Dialog::SetMainContent(const QString& code,
   syntax_highlighter_->setDocument(ui_->viewer->document());
 }
 
+void Dialog::SetMainContent(
+    const QString& code,
+    std::unique_ptr<orbit_syntax_highlighter::BlockHighlighter> syntax_highlighter) {
+  SetMainContent(code);
+  ui_->viewer->SetSyntaxHighlighter(std::move(syntax_highlighter));
+}
+
 void Dialog::SetHeatmap(FontSizeInEm heatmap_bar_width,
                         const orbit_code_report::CodeReport* code_report) {
   ui_->viewer->SetHeatmapBarWidth(heatmap_bar_width);
@@ -0,0 +1,126 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "CodeViewer/LazySyntaxHighlighter.h"
+
+#include <QTextCharFormat>
+#include <QTextLayout>
+#include <QVector>
+#include <algorithm>
+
+#include "OrbitBase/Logging.h"
+
+namespace orbit_code_viewer {
+
+using orbit_syntax_highlighter::BlockHighlighter;
+
+LazySyntaxHighlighter::LazySyntaxHighlighter(QTextDocument* document,
+                                             std::unique_ptr<BlockHighlighter> highlighter)
+    : document_(document), highlighter_(std::move(highlighter)) {
+  CHECK(document_ != nullptr);
+  CHECK(highlighter_ != nullptr);
+}
+
+void LazySyntaxHighlighter::HighlightBlocks(int first_block_number, int last_block_number) {
+  // Applying formats relayouts the block, which can trigger another request while we are iterating.
+  if (is_applying_formats_) return;
+
+  const int block_count = document_->blockCount();
+  first_block_number = std::max(first_block_number, 0);
+  last_block_number = std::min(last_block_number, block_count - 1);
+  if (first_block_number > last_block_number) return;
+
+  if (is_block_highlighted_.size() < static_cast<size_t>(block_count)) {
+    is_block_highlighted_.resize(block_count, false);
+  }
+
+  for (QTextBlock block = document_->findBlockByNumber(first_block_number);
+       block.isValid() && block.blockNumber() <= last_block_number; block = block.next()) {
+    if (is_block_highlighted_[block.blockNumber()]) continue;
+    HighlightBlock(block);
+  }
+}
+
+void LazySyntaxHighlighter::Invalidate(int block_number) {
+  const size_t first_invalid_block = static_cast<size_t>(std::max(block_number, 0));
+  if (block_states_.size() > first_invalid_block) block_states_.resize(first_invalid_block);
+  if (is_block_highlighted_.size() > first_invalid_block) {
+    num_highlighted_blocks_ -= static_cast<int>(std::count(
+        is_block_highlighted_.begin() + first_invalid_block, is_block_highlighted_.end(), true));
+    is_block_highlighted_.resize(first_invalid_block);
+  }
+}
+
+void LazySyntaxHighlighter::ClearFormats() {
+  for (QTextBlock block = document_->begin(); block.isValid(); block = block.next()) {
+    if (IsBlockHighlighted(block.blockNumber())) ApplyFormats(block, {});
+  }
+  Invalidate(0);
+}
+
+bool LazySyntaxHighlighter::IsBlockHighlighted(int block_number) const {
+  return block_number >= 0 && static_cast<size_t>(block_number) < is_block_highlighted_.size() &&
+         is_block_highlighted_[block_number];
+}
+
+int LazySyntaxHighlighter::ComputePreviousBlockState(const QTextBlock& block) {
+  const size_t block_number = static_cast<size_t>(block.blockNumber());
+  if (block_number == 0) return BlockHighlighter::kNoPreviousBlockState;
+
+  if (block_states_.size() < block_number) {
+    QTextBlock current_block = document_->findBlockByNumber(static_cast<int>(block_states_.size()));
+    while (block_states_.size() < block_number) {
+      const int previous_block_state = block_states_.empty()
+                                           ? BlockHighlighter::kNoPreviousBlockState
+                                           : block_states_.back();
+      block_states_.push_back(
+          highlighter_->ComputeNextBlockState(current_block, previous_block_state));
+      current_block = current_block.next();
+    }
+  }
+  return block_states_[block_number - 1];
+}
+
+void LazySyntaxHighlighter::HighlightBlock(const QTextBlock& block) {
+  const int previous_block_state = ComputePreviousBlockState(block);
+
+  // Like QSyntaxHighlighter, we keep one format per character, so that later calls to set_format
+  // paint over earlier ones, and merge them into ranges afterwards.
+  const int block_length = block.length();
+  QVector<QTextCharFormat> formats(block_length);
+  const int next_block_state = highlighter_->HighlightBlock(
+      block, previous_block_state,
+      [&formats, block_length](int start, int count, const QTextCharFormat& format) {
+        const int end = std::min(start + count, block_length);
+        for (int i = std::max(start, 0); i < end; ++i) formats[i] = format;
+      });
+
+  QVector<QTextLayout::FormatRange> ranges;
+  for (int start = 0; start < block_length;) {
+    int end = start + 1;
+    while (end < block_length && formats[end] == formats[start]) ++end;
+    if (formats[start] != QTextCharFormat{}) ranges.push_back({start, end - start, formats[start]});
+    start = end;
+  }
+  ApplyFormats(block, ranges);
+
+  const size_t block_number = static_cast<size_t>(block.blockNumber());
+  if (block_states_.size() == block_number) {
+    block_states_.push_back(next_block_state);
+  } else {
+    block_states_[block_number] = next_block_state;
+  }
+  is_block_highlighted_[block_number] = true;
+  ++num_highlighted_blocks_;
+}
+
+void LazySyntaxHighlighter::ApplyFormats(const QTextBlock& block,
+                                         const QVector<QTextLayout::FormatRange>& formats) {
+  is_applying_formats_ = true;
+  block.layout()->setFormats(formats);
+  document_->markContentsDirty(block.position(), block.length());
+  is_applying_formats_ = false;
+}
+
+}  // namespace orbit_code_viewer
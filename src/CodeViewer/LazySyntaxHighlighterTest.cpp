@@ -0,0 +1,138 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <QColor>
+#include <QString>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <memory>
+#include <vector>
+
+#include "CodeViewer/LazySyntaxHighlighter.h"
+#include "SyntaxHighlighter/Cpp.h"
+
+namespace orbit_code_viewer {
+
+namespace {
+
+constexpr const char* kCppCode = R"(/* A comment
+   spanning several
+   lines */
+int main() {
+  const char* kString = "a string \
+which continues";
+  // A single line comment
+  return 0;  /* trailing */
+}
+/* Unterminated comment
+int not_code = 42;)";
+
+// Returns the foreground color of each character of `block`, as drawn by Qt.
+std::vector<QColor> GetForegroundColors(const QTextBlock& block) {
+  std::vector<QColor> colors(block.length());
+  for (const QTextLayout::FormatRange& range : block.layout()->formats()) {
+    for (int i = range.start; i < range.start + range.length; ++i) {
+      colors[i] = range.format.foreground().color();
+    }
+  }
+  return colors;
+}
+
+}  // namespace
+
+TEST(LazySyntaxHighlighter, HighlightsOnlyRequestedBlocks) {
+  QTextDocument document{};
+  document.setPlainText(kCppCode);
+  LazySyntaxHighlighter highlighter{
+      &document, std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>()};
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), 0);
+
+  highlighter.HighlightBlocks(3, 4);
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), 2);
+  for (int block_number = 0; block_number < document.blockCount(); ++block_number) {
+    EXPECT_EQ(highlighter.IsBlockHighlighted(block_number), block_number == 3 || block_number == 4)
+        << block_number;
+  }
+
+  // Already highlighted blocks are not highlighted again and the range gets clamped.
+  highlighter.HighlightBlocks(4, 1000);
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), document.blockCount() - 3);
+
+  highlighter.HighlightBlocks(-5, -1);
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), document.blockCount() - 3);
+}
+
+TEST(LazySyntaxHighlighter, MatchesQSyntaxHighlighter) {
+  QTextDocument expected_document{};
+  expected_document.setPlainText(kCppCode);
+  orbit_syntax_highlighter::Cpp cpp{};
+  cpp.setDocument(&expected_document);
+
+  QTextDocument document{};
+  document.setPlainText(kCppCode);
+  LazySyntaxHighlighter highlighter{
+      &document, std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>()};
+
+  // Highlighting backwards forces the states of the preceding blocks to be computed without
+  // highlighting them first.
+  for (int block_number = document.blockCount() - 1; block_number >= 0; --block_number) {
+    highlighter.HighlightBlocks(block_number, block_number);
+  }
+
+  ASSERT_EQ(document.blockCount(), expected_document.blockCount());
+  for (QTextBlock block = document.begin(), expected_block = expected_document.begin();
+       block.isValid(); block = block.next(), expected_block = expected_block.next()) {
+    EXPECT_EQ(GetForegroundColors(block), GetForegroundColors(expected_block))
+        << block.text().toStdString();
+  }
+}
+
+TEST(LazySyntaxHighlighter, InvalidatesChangedBlocks) {
+  QTextDocument document{};
+  document.setPlainText(kCppCode);
+  LazySyntaxHighlighter highlighter{
+      &document, std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>()};
+  highlighter.HighlightBlocks(0, document.blockCount() - 1);
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), document.blockCount());
+
+  highlighter.Invalidate(5);
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), 5);
+  EXPECT_TRUE(highlighter.IsBlockHighlighted(4));
+  EXPECT_FALSE(highlighter.IsBlockHighlighted(5));
+
+  // Closing the first comment earlier turns the following lines into code.
+  QTextCursor cursor{document.begin()};
+  cursor.movePosition(QTextCursor::EndOfBlock);
+  cursor.insertText(" */");
+  highlighter.Invalidate(0);
+  highlighter.HighlightBlocks(0, document.blockCount() - 1);
+
+  QTextDocument expected_document{};
+  expected_document.setPlainText(document.toPlainText());
+  orbit_syntax_highlighter::Cpp cpp{};
+  cpp.setDocument(&expected_document);
+  EXPECT_EQ(GetForegroundColors(document.findBlockByNumber(1)),
+            GetForegroundColors(expected_document.findBlockByNumber(1)));
+}
+
+TEST(LazySyntaxHighlighter, ClearFormats) {
+  QTextDocument document{};
+  document.setPlainText(kCppCode);
+  LazySyntaxHighlighter highlighter{
+      &document, std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>()};
+  highlighter.HighlightBlocks(0, document.blockCount() - 1);
+  EXPECT_FALSE(document.begin().layout()->formats().isEmpty());
+
+  highlighter.ClearFormats();
+  EXPECT_EQ(highlighter.GetNumHighlightedBlocks(), 0);
+  for (QTextBlock block = document.begin(); block.isValid(); block = block.next()) {
+    EXPECT_TRUE(block.layout()->formats().isEmpty());
+  }
+}
+
+}  // namespace orbit_code_viewer
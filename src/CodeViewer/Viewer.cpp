@@ -110,6 +110,7 @@ Viewer::Viewer(QWidget* parent)
     }
   };
   QObject::connect(this, &QPlainTextEdit::updateRequest, this, update_viewport_area);
+  QObject::connect(this, &QPlainTextEdit::updateRequest, this, &Viewer::HighlightVisibleBlocks);
 
   constexpr int kTabStopInWhitespaces = 4;
   setTabStopDistance(fontMetrics().horizontalAdvance(' ') * kTabStopInWhitespaces);
@@ -126,6 +127,7 @@ void Viewer::resizeEvent(QResizeEvent* ev) {
   QPlainTextEdit::resizeEvent(ev);
 
   UpdateBarsPosition();
+  HighlightVisibleBlocks();
 }
 
 void Viewer::wheelEvent(QWheelEvent* ev) {
@@ -493,6 +495,45 @@ void Viewer::HighlightCurrentLine() {
   setExtraSelections({selection});
 }
 
+void Viewer::SetSyntaxHighlighter(
+    std::unique_ptr<orbit_syntax_highlighter::BlockHighlighter> highlighter) {
+  QObject::disconnect(contents_change_connection_);
+  if (syntax_highlighter_ != nullptr) syntax_highlighter_->ClearFormats();
+  syntax_highlighter_.reset();
+  if (highlighter == nullptr) return;
+
+  syntax_highlighter_ = std::make_unique<LazySyntaxHighlighter>(document(), std::move(highlighter));
+  contents_change_connection_ = QObject::connect(
+      document(), &QTextDocument::contentsChange, this, [this](int position, int /*removed*/,
+                                                               int /*added*/) {
+        if (syntax_highlighter_->IsApplyingFormats()) return;
+        syntax_highlighter_->Invalidate(document()->findBlock(position).blockNumber());
+      });
+  HighlightVisibleBlocks();
+}
+
+void Viewer::HighlightVisibleBlocks() {
+  if (syntax_highlighter_ == nullptr) return;
+
+  const QTextBlock first_visible_block = firstVisibleBlock();
+  if (!first_visible_block.isValid()) return;
+
+  // The visible blocks are determined the same way as in DrawLineNumbers.
+  const int viewport_bottom = viewport()->rect().bottom();
+  QTextBlock block = first_visible_block;
+  int num_visible_blocks = 0;
+  while (block.isValid() &&
+         blockBoundingGeometry(block).translated(contentOffset()).top() <= viewport_bottom) {
+    ++num_visible_blocks;
+    block = block.next();
+  }
+
+  // A margin of one page makes sure that small scroll steps don't show unhighlighted lines.
+  const int first_block_number = first_visible_block.blockNumber();
+  syntax_highlighter_->HighlightBlocks(first_block_number - num_visible_blocks,
+                                       first_block_number + 2 * num_visible_blocks);
+}
+
 int Viewer::WidthPercentageColumn() const {
   const QString kWidestPercentage = "100.00 %";
   return StringWidthInPixels(fontMetrics(), kWidestPercentage);
@@ -6,6 +6,7 @@
 #include <QFont>
 #include <QFontDatabase>
 #include <QFontMetrics>
+#include <QScrollBar>
 #include <QTextBlock>
 #include <QTextDocument>
 #include <QWheelEvent>
@@ -13,6 +14,7 @@
 #include <limits>
 
 #include "CodeViewer/Viewer.h"
+#include "SyntaxHighlighter/Cpp.h"
 #include "gtest/gtest.h"
 
 namespace orbit_code_viewer {
@@ -303,4 +305,57 @@ TEST(Viewer, HighlightCurrentLine) {
   viewer.SetHighlightCurrentLine(false);
   EXPECT_FALSE(viewer.IsCurrentLineHighlighted());
 }
-}  // namespace orbit_code_viewer
\ No newline at end of file
+
+namespace {
+QString GenerateCode(int num_lines) {
+  QString code;
+  for (int line = 0; line < num_lines; ++line) {
+    code += QString{"int Function%1(int value) { /* comment */ return value * %1; }\n"}.arg(line);
+  }
+  return code;
+}
+}  // namespace
+
+TEST(Viewer, OpenAndJumpToEndOfLargeFileOnlyHighlightsVisibleBlocks) {
+  constexpr int kNumLines = 5'000;
+  orbit_code_viewer::Viewer viewer{};
+  viewer.resize(QSize{800, 600});
+  viewer.show();
+  QApplication::processEvents();
+
+  viewer.setPlainText(GenerateCode(kNumLines));
+  viewer.SetSyntaxHighlighter(std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>());
+  QApplication::processEvents();
+
+  const LazySyntaxHighlighter* highlighter = viewer.GetSyntaxHighlighter();
+  ASSERT_NE(highlighter, nullptr);
+  const int num_highlighted_blocks_after_open = highlighter->GetNumHighlightedBlocks();
+  EXPECT_GT(num_highlighted_blocks_after_open, 0);
+  EXPECT_LT(num_highlighted_blocks_after_open, 1'000);
+  EXPECT_TRUE(highlighter->IsBlockHighlighted(0));
+  EXPECT_FALSE(highlighter->IsBlockHighlighted(kNumLines - 1));
+
+  // Jumping to the end highlights the blocks around the new visible window, but none of the blocks
+  // that were skipped.
+  viewer.verticalScrollBar()->setValue(viewer.verticalScrollBar()->maximum());
+  QApplication::processEvents();
+
+  EXPECT_TRUE(highlighter->IsBlockHighlighted(kNumLines - 1));
+  EXPECT_FALSE(highlighter->IsBlockHighlighted(kNumLines / 2));
+  EXPECT_LE(highlighter->GetNumHighlightedBlocks(), 2 * num_highlighted_blocks_after_open);
+}
+
+TEST(Viewer, SetSyntaxHighlighterNullptrRemovesHighlighting) {
+  orbit_code_viewer::Viewer viewer{};
+  viewer.resize(QSize{800, 600});
+  viewer.show();
+  viewer.setPlainText("int main() { return 0; }");
+  viewer.SetSyntaxHighlighter(std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>());
+  ASSERT_NE(viewer.GetSyntaxHighlighter(), nullptr);
+  EXPECT_FALSE(viewer.document()->begin().layout()->formats().isEmpty());
+
+  viewer.SetSyntaxHighlighter(nullptr);
+  EXPECT_EQ(viewer.GetSyntaxHighlighter(), nullptr);
+  EXPECT_TRUE(viewer.document()->begin().layout()->formats().isEmpty());
+}
+}  // namespace orbit_code_viewer
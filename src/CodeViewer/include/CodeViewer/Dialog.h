@@ -14,6 +14,7 @@
 #include "CodeReport/CodeReport.h"
 #include "CodeViewer/FontSizeInEm.h"
 #include "CodeViewer/Viewer.h"
+#include "SyntaxHighlighter/BlockHighlighter.h"
 
 namespace Ui {
 class CodeViewerDialog;  // IWYU pragma: keep
@@ -33,10 +34,13 @@ namespace orbit_code_viewer {
 
   Optionally a syntax highlighter can be provided with the source code.
   Check out the Syntax highlighting module for more details on this.
+  Prefer a BlockHighlighter, which only highlights the visible lines, over a
+  QSyntaxHighlighter, which highlights the whole document up front.
   Example:
 
   orbit_code_viewer::Dialog dialog{};
-  dialog.SetMainContent(source_code, std::make_unique<orbit_syntax_highlighter::X86Assembly>());
+  dialog.SetMainContent(source_code,
+                        std::make_unique<orbit_syntax_highlighter::X86AssemblyBlockHighlighter>());
   dialog.exec();
 
   Check out orbit_code_viewer::Viewer if you don't need a dialog but rather a widget
@@ -53,6 +57,9 @@ class Dialog : public QDialog {
 
   void SetMainContent(const QString& code);
   void SetMainContent(const QString& code, std::unique_ptr<QSyntaxHighlighter> syntax_highlighter);
+  void SetMainContent(
+      const QString& code,
+      std::unique_ptr<orbit_syntax_highlighter::BlockHighlighter> syntax_highlighter);
 
   void SetAnnotatingContent(absl::Span<const orbit_code_report::AnnotatingLine> annotating_lines);
 
@@ -0,0 +1,71 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CODE_VIEWER_LAZY_SYNTAX_HIGHLIGHTER_H_
+#define CODE_VIEWER_LAZY_SYNTAX_HIGHLIGHTER_H_
+
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "SyntaxHighlighter/BlockHighlighter.h"
+
+namespace orbit_code_viewer {
+
+/*
+  LazySyntaxHighlighter applies the formats of a BlockHighlighter to a document, but in contrast to
+  QSyntaxHighlighter only to the blocks it is asked for. The Viewer uses it to only highlight the
+  visible blocks (plus a margin), which keeps opening and scrolling large files fast.
+
+  Formats are applied at most once per block and the states of the blocks are cached, so scrolling
+  back to an already highlighted area is free. The states of blocks preceding a requested block are
+  computed with the cheaper BlockHighlighter::ComputeNextBlockState.
+
+  Changes to the document's content need to be reported with Invalidate.
+*/
+class LazySyntaxHighlighter {
+ public:
+  LazySyntaxHighlighter(QTextDocument* document,
+                        std::unique_ptr<orbit_syntax_highlighter::BlockHighlighter> highlighter);
+
+  // Highlights all blocks with numbers in [first_block_number, last_block_number] which have not
+  // been highlighted yet. Out-of-range block numbers are clamped.
+  void HighlightBlocks(int first_block_number, int last_block_number);
+
+  // Drops all results for blocks starting at `block_number`. Blocks which have been highlighted
+  // keep their formats until they are highlighted again.
+  void Invalidate(int block_number);
+
+  // Removes the formats from all highlighted blocks.
+  void ClearFormats();
+
+  // Returns true while formats are applied to the document. Content change notifications caused by
+  // that must not be passed to Invalidate.
+  [[nodiscard]] bool IsApplyingFormats() const { return is_applying_formats_; }
+
+  [[nodiscard]] int GetNumHighlightedBlocks() const { return num_highlighted_blocks_; }
+  [[nodiscard]] bool IsBlockHighlighted(int block_number) const;
+
+ private:
+  [[nodiscard]] int ComputePreviousBlockState(const QTextBlock& block);
+  void HighlightBlock(const QTextBlock& block);
+  void ApplyFormats(const QTextBlock& block, const QVector<QTextLayout::FormatRange>& formats);
+
+  QTextDocument* document_;
+  std::unique_ptr<orbit_syntax_highlighter::BlockHighlighter> highlighter_;
+
+  // block_states_[i] is the state at the end of block i. It is computed for a prefix of the
+  // document only.
+  std::vector<int> block_states_;
+  std::vector<bool> is_block_highlighted_;
+  int num_highlighted_blocks_ = 0;
+  bool is_applying_formats_ = false;
+};
+
+}  // namespace orbit_code_viewer
+
+#endif  // CODE_VIEWER_LAZY_SYNTAX_HIGHLIGHTER_H_
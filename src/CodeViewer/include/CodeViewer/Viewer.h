@@ -12,11 +12,14 @@
 #include <QResizeEvent>
 #include <QWheelEvent>
 #include <functional>
+#include <memory>
 
 #include "CodeReport/AnnotatingLine.h"
 #include "CodeReport/CodeReport.h"
 #include "CodeViewer/FontSizeInEm.h"
+#include "CodeViewer/LazySyntaxHighlighter.h"
 #include "CodeViewer/PlaceHolderWidget.h"
+#include "SyntaxHighlighter/BlockHighlighter.h"
 
 namespace orbit_code_viewer {
 
@@ -47,6 +50,9 @@ struct LargestOccurringLineNumbers {
     return 0.5f;
   });
 
+  // Only the visible lines will be highlighted, so this is cheap even for large files.
+  viewer.SetSyntaxHighlighter(std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>());
+
   viewer.show();
 
   Also check out the documentation of QPlainTextEdit for more details on how to
@@ -75,6 +81,15 @@ class Viewer : public QPlainTextEdit {
   void SetTopBarTitle(const QString& title) { top_bar_title_ = title; }
   [[nodiscard]] const QString& GetTopBarTitle() const { return top_bar_title_; }
 
+  // Highlights the visible blocks of the document, plus a margin of one page above and below, with
+  // `highlighter`. More blocks get highlighted on demand when scrolling. Passing nullptr removes
+  // the highlighting.
+  void SetSyntaxHighlighter(
+      std::unique_ptr<orbit_syntax_highlighter::BlockHighlighter> highlighter);
+  [[nodiscard]] const LazySyntaxHighlighter* GetSyntaxHighlighter() const {
+    return syntax_highlighter_.get();
+  }
+
  private:
   void resizeEvent(QResizeEvent* ev) override;
   void wheelEvent(QWheelEvent* ev) override;
@@ -85,6 +100,7 @@ class Viewer : public QPlainTextEdit {
   void UpdateBarsSize();
   void UpdateBarsPosition();
   void HighlightCurrentLine();
+  void HighlightVisibleBlocks();
   [[nodiscard]] int WidthPercentageColumn() const;
   [[nodiscard]] int WidthSampleCounterColumn() const;
   [[nodiscard]] int WidthMarginBetweenColumns() const;
@@ -110,6 +126,9 @@ class Viewer : public QPlainTextEdit {
   [[nodiscard]] uint64_t LargestOccurringLineNumber() const;
 
   QString top_bar_title_;
+
+  std::unique_ptr<LazySyntaxHighlighter> syntax_highlighter_;
+  QMetaObject::Connection contents_change_connection_;
 };
 
 // Determine how many pixels are needed to draw all possible line numbers for the given font
@@ -32,7 +32,8 @@ int main(int argc, char* argv[]) {
   // Example file
   const QString content = x86Assembly_example;
 
-  dialog.SetMainContent(content, std::make_unique<orbit_syntax_highlighter::X86Assembly>());
+  dialog.SetMainContent(content,
+                        std::make_unique<orbit_syntax_highlighter::X86AssemblyBlockHighlighter>());
 
   std::vector<orbit_code_report::AnnotatingLine> lines{};
   lines.emplace_back();
@@ -14,8 +14,11 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <numeric>
+#include <utility>
 
+#include "ClientData/FunctionTable.h"
 #include "ClientData/FunctionUtils.h"
 #include "ClientData/ModuleData.h"
 #include "ClientData/ProcessData.h"
@@ -28,6 +31,8 @@
 #include "OrbitBase/Logging.h"
 #include "OrbitBase/ThreadPool.h"
 
+using orbit_client_data::FunctionHandle;
+using orbit_client_data::FunctionTable;
 using orbit_client_data::ModuleData;
 using orbit_client_data::ProcessData;
 using orbit_client_model::CaptureData;
@@ -35,6 +40,12 @@ using orbit_client_protos::FunctionInfo;
 
 namespace orbit_data_views {
 
+namespace {
+[[nodiscard]] std::string GetLoadedModuleName(const FunctionHandle& function) {
+  return orbit_client_data::function_utils::GetLoadedModuleNameByPath(function.module_path());
+}
+}  // namespace
+
 FunctionsDataView::FunctionsDataView(AppInterface* app, ThreadPool* thread_pool)
     : DataView(DataViewType::kFunctions, app), thread_pool_{thread_pool} {}
 
@@ -97,17 +108,17 @@ std::string FunctionsDataView::GetValue(int row, int column) {
     return "";
   }
 
-  const FunctionInfo& function = *GetFunction(row);
+  FunctionHandle function = GetFunction(row);
 
   switch (column) {
     case kColumnSelected:
-      return BuildSelectedColumnsString(app_, function);
+      return BuildSelectedColumnsString(app_, function.CreateFunctionInfo());
     case kColumnName:
-      return orbit_client_data::function_utils::GetDisplayName(function);
+      return std::string{function.display_name()};
     case kColumnSize:
       return absl::StrFormat("%lu", function.size());
     case kColumnModule:
-      return orbit_client_data::function_utils::GetLoadedModuleName(function);
+      return GetLoadedModuleName(function);
     case kColumnAddressInModule:
       return absl::StrFormat("%#x", function.address());
     default:
@@ -115,14 +126,14 @@ std::string FunctionsDataView::GetValue(int row, int column) {
   }
 }
 
-#define ORBIT_FUNC_SORT(Member)                                                                   \
-  [&](int a, int b) {                                                                             \
-    return CompareAscendingOrDescending(functions_[a]->Member, functions_[b]->Member, ascending); \
+#define ORBIT_FUNC_SORT(Member)                                                                 \
+  [&](int a, int b) {                                                                           \
+    return CompareAscendingOrDescending(functions_[a].Member, functions_[b].Member, ascending); \
   }
 
-#define ORBIT_CUSTOM_FUNC_SORT(Func)                                                            \
-  [&](int a, int b) {                                                                           \
-    return CompareAscendingOrDescending(Func(*functions_[a]), Func(*functions_[b]), ascending); \
+#define ORBIT_CUSTOM_FUNC_SORT(Func)                                                          \
+  [&](int a, int b) {                                                                         \
+    return CompareAscendingOrDescending(Func(functions_[a]), Func(functions_[b]), ascending); \
   }
 
 void FunctionsDataView::DoSort() {
@@ -136,18 +147,28 @@ void FunctionsDataView::DoSort() {
   bool ascending = sorting_orders_[sorting_column_] == SortingOrder::kAscending;
   std::function<bool(int a, int b)> sorter = nullptr;
 
+  // Checking if a function is selected needs a FunctionInfo, so it is done once per function and
+  // not on each comparison.
+  std::vector<bool> is_selected;
+
   switch (sorting_column_) {
     case kColumnSelected:
-      sorter = ORBIT_CUSTOM_FUNC_SORT(app_->IsFunctionSelected);
+      is_selected.resize(functions_.size());
+      for (uint64_t index : indices_) {
+        is_selected[index] = app_->IsFunctionSelected(functions_[index].CreateFunctionInfo());
+      }
+      sorter = [&](int a, int b) {
+        return CompareAscendingOrDescending(is_selected[a], is_selected[b], ascending);
+      };
       break;
     case kColumnName:
-      sorter = ORBIT_CUSTOM_FUNC_SORT(orbit_client_data::function_utils::GetDisplayName);
+      sorter = ORBIT_FUNC_SORT(display_name());
       break;
     case kColumnSize:
       sorter = ORBIT_FUNC_SORT(size());
       break;
     case kColumnModule:
-      sorter = ORBIT_CUSTOM_FUNC_SORT(orbit_client_data::function_utils::GetLoadedModuleName);
+      sorter = ORBIT_CUSTOM_FUNC_SORT(GetLoadedModuleName);
       break;
     case kColumnAddressInModule:
       sorter = ORBIT_FUNC_SORT(address());
@@ -176,7 +197,7 @@ std::vector<std::string> FunctionsDataView::GetContextMenu(
   bool enable_disable_frame_track = false;
 
   for (int index : selected_indices) {
-    const FunctionInfo& function = *GetFunction(index);
+    const FunctionInfo function = GetFunction(index).CreateFunctionInfo();
     enable_select |= !app_->IsFunctionSelected(function);
     enable_unselect |= app_->IsFunctionSelected(function);
     enable_enable_frame_track |= !app_->IsFrameTrackEnabled(function);
@@ -198,22 +219,23 @@ void FunctionsDataView::OnContextMenu(const std::string& action, int menu_index,
                                       const std::vector<int>& item_indices) {
   if (action == kMenuActionSelect) {
     for (int i : item_indices) {
-      app_->SelectFunction(*GetFunction(i));
+      app_->SelectFunction(GetFunction(i).CreateFunctionInfo());
     }
   } else if (action == kMenuActionUnselect) {
     for (int i : item_indices) {
-      app_->DeselectFunction(*GetFunction(i));
+      const FunctionInfo function = GetFunction(i).CreateFunctionInfo();
+      app_->DeselectFunction(function);
       // Unhooking a function implies disabling (and removing) the frame
       // track for this function. While it would be possible to keep the
       // current frame track in the capture data, this would lead to a
       // somewhat inconsistent state where the frame track for this function
       // is enabled for the current capture but disabled for the next one.
-      app_->DisableFrameTrack(*GetFunction(i));
-      app_->RemoveFrameTrack(*GetFunction(i));
+      app_->DisableFrameTrack(function);
+      app_->RemoveFrameTrack(function);
     }
   } else if (action == kMenuActionEnableFrameTrack) {
     for (int i : item_indices) {
-      const FunctionInfo& function = *GetFunction(i);
+      const FunctionInfo function = GetFunction(i).CreateFunctionInfo();
       // Functions used as frame tracks must be hooked (selected), otherwise the
       // data to produce the frame track will not be captured.
       app_->SelectFunction(function);
@@ -225,16 +247,17 @@ void FunctionsDataView::OnContextMenu(const std::string& action, int menu_index,
       // When we remove a frame track, we do not unhook (deselect) the function as
       // it may have been selected manually (not as part of adding a frame track).
       // However, disable the frame track, so it is not recreated on the next capture.
-      app_->DisableFrameTrack(*GetFunction(i));
-      app_->RemoveFrameTrack(*GetFunction(i));
+      const FunctionInfo function = GetFunction(i).CreateFunctionInfo();
+      app_->DisableFrameTrack(function);
+      app_->RemoveFrameTrack(function);
     }
   } else if (action == kMenuActionDisassembly) {
     for (int i : item_indices) {
-      app_->Disassemble(app_->GetTargetProcess()->pid(), *GetFunction(i));
+      app_->Disassemble(app_->GetTargetProcess()->pid(), GetFunction(i).CreateFunctionInfo());
     }
   } else if (action == kMenuActionSourceCode) {
     for (int i : item_indices) {
-      app_->ShowSourceCode(*GetFunction(i));
+      app_->ShowSourceCode(GetFunction(i).CreateFunctionInfo());
     }
   } else {
     DataView::OnContextMenu(action, menu_index, item_indices);
@@ -266,10 +289,9 @@ void FunctionsDataView::DoFilter() {
       std::vector<uint64_t> indices_of_matches;
 
       for (size_t index = begin; index < end; ++index) {
-        const FunctionInfo* function = functions_[index];
-        std::string name =
-            absl::AsciiStrToLower(orbit_client_data::function_utils::GetDisplayName(*function));
-        std::string module = orbit_client_data::function_utils::GetLoadedModuleName(*function);
+        const FunctionHandle& function = functions_[index];
+        std::string name = absl::AsciiStrToLower(function.display_name());
+        std::string module = GetLoadedModuleName(function);
 
         const auto is_token_found = [&name, &module](const std::string& token) {
           return name.find(token) != std::string::npos || module.find(token) != std::string::npos;
@@ -294,9 +316,10 @@ void FunctionsDataView::DoFilter() {
   indices_ = std::move(indices);
 }
 
-void FunctionsDataView::AddFunctions(
-    std::vector<const orbit_client_protos::FunctionInfo*> functions) {
-  functions_.insert(functions_.end(), functions.begin(), functions.end());
+void FunctionsDataView::AddFunctions(std::shared_ptr<const FunctionTable> functions) {
+  functions_.reserve(functions_.size() + functions->size());
+  functions_.insert(functions_.end(), functions->begin(), functions->end());
+  function_tables_.push_back(std::move(functions));
   indices_.resize(functions_.size());
   for (size_t i = 0; i < indices_.size(); ++i) {
     indices_[i] = i;
@@ -306,6 +329,7 @@ void FunctionsDataView::AddFunctions(
 
 void FunctionsDataView::ClearFunctions() {
   functions_.clear();
+  function_tables_.clear();
   OnDataChanged();
 }
 
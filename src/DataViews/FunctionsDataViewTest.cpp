@@ -12,6 +12,10 @@
 #include <gmock/gmock-more-actions.h>
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <vector>
+
+#include "ClientData/FunctionTable.h"
 #include "ClientData/FunctionUtils.h"
 #include "ClientData/ModuleData.h"
 #include "ClientData/ModuleManager.h"
@@ -116,6 +120,19 @@ struct FunctionsDataViewTest : public testing::Test {
   std::vector<orbit_client_protos::FunctionInfo> functions_;
   std::vector<orbit_grpc_protos::ModuleInfo> module_infos_;
 
+  // Each function is added in its own table, as they are from different modules.
+  void AddFunctionsToView(const std::vector<size_t>& indices) {
+    for (size_t index : indices) {
+      const orbit_client_protos::FunctionInfo& function = functions_[index];
+      orbit_client_data::FunctionTable::Function table_function{
+          function.address(), function.size(), function.name(), function.pretty_name(),
+          function.orbit_type()};
+      view_.AddFunctions(std::make_shared<const orbit_client_data::FunctionTable>(
+          function.module_path(), function.module_build_id(),
+          absl::MakeConstSpan(&table_function, 1)));
+    }
+  }
+
   [[nodiscard]] std::optional<size_t> IndexOfFunction(
       const orbit_client_protos::FunctionInfo& function) const {
     const auto it = std::find_if(functions_.begin(), functions_.end(),
@@ -153,13 +170,13 @@ TEST_F(FunctionsDataViewTest, FunctionNameIsDisplayName) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
   EXPECT_EQ(view_.GetValue(0, 1), orbit_client_data::function_utils::GetDisplayName(functions_[0]));
 }
 
 TEST_F(FunctionsDataViewTest, InvalidColumnAndRowNumbersReturnEmptyString) {
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
   EXPECT_EQ(view_.GetValue(1, 0), "");    // Invalid row index
   EXPECT_EQ(view_.GetValue(0, 25), "");   // Invalid column index
@@ -171,7 +188,7 @@ TEST_F(FunctionsDataViewTest, ViewHandlesMultipleElements) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0], &functions_[1], &functions_[2]});
+  AddFunctionsToView({0, 1, 2});
   ASSERT_EQ(view_.GetNumElements(), 3);
 
   // We don't expect the view to be in any particular order at this point.
@@ -187,7 +204,7 @@ TEST_F(FunctionsDataViewTest, ClearFunctionsRemovesAllElements) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0], &functions_[1], &functions_[2]});
+  AddFunctionsToView({0, 1, 2});
   ASSERT_EQ(view_.GetNumElements(), 3);
 
   view_.ClearFunctions();
@@ -210,7 +227,7 @@ TEST_F(FunctionsDataViewTest, FunctionSelectionAppearsInFirstColumn) {
 
   EXPECT_CALL(app_, HasCaptureData).WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
 
   function_selected = false;
@@ -244,7 +261,7 @@ TEST_F(FunctionsDataViewTest, FrameTrackSelectionAppearsInFirstColumn) {
 
   EXPECT_CALL(app_, HasCaptureData).WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
 
   function_selected = false;
@@ -272,7 +289,7 @@ TEST_F(FunctionsDataViewTest, FrameTrackSelectionAppearsInFirstColumnWhenACaptur
 
   orbit_client_data::ModuleData* module_data = module_manager.GetMutableModuleByPathAndBuildId(
       functions_[0].module_path(), functions_[0].module_build_id());
-  module_data->AddFunctionInfoWithBuildId(functions_[0], functions_[0].module_build_id());
+  module_data->AddFunctionInfosWithBuildId({functions_[0]}, functions_[0].module_build_id());
 
   orbit_grpc_protos::CaptureStarted capture_started{};
 
@@ -306,7 +323,7 @@ TEST_F(FunctionsDataViewTest, FrameTrackSelectionAppearsInFirstColumnWhenACaptur
       .Times(2)
       .WillRepeatedly(testing::ReturnPointee(&frame_track_enabled));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
 
   frame_track_enabled = true;
@@ -321,7 +338,7 @@ TEST_F(FunctionsDataViewTest, FunctionSizeAppearsInThirdColumn) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
   EXPECT_EQ(view_.GetValue(0, 2), std::to_string(functions_[0].size()));
 }
@@ -331,14 +348,14 @@ TEST_F(FunctionsDataViewTest, ModuleColumnShowsFilenameOfModule) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
   EXPECT_EQ(view_.GetValue(0, 3),
             std::filesystem::path{functions_[0].module_path()}.filename().string());
 }
 
 TEST_F(FunctionsDataViewTest, AddressColumnShowsAddress) {
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
   ASSERT_EQ(view_.GetNumElements(), 1);
 
   // We expect the address to be in hex - indicated by "0x"
@@ -358,7 +375,7 @@ TEST_F(FunctionsDataViewTest, CommonContextMenuEntriesArePresent) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0], &functions_[1], &functions_[2]});
+  AddFunctionsToView({0, 1, 2});
 
   EXPECT_THAT(view_.GetContextMenu(0, {0}),
               testing::IsSupersetOf({"Copy Selection", "Export to CSV"}));
@@ -384,7 +401,7 @@ TEST_F(FunctionsDataViewTest, ContextMenuEntriesChangeOnFunctionState) {
         return is_frame_track_enabled.at(index.value());
       });
 
-  view_.AddFunctions({&functions_[0], &functions_[1], &functions_[2]});
+  AddFunctionsToView({0, 1, 2});
 
   const auto can_unhook = [&]() {
     return testing::AllOf(testing::Not(testing::Contains("Hook")), testing::Contains("Unhook"));
@@ -482,7 +499,7 @@ TEST_F(FunctionsDataViewTest, GenericDataExportFunctionShowCorrectData) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
 
   std::vector<std::string> context_menu = view_.GetContextMenu(0, {0});
 
@@ -564,8 +581,7 @@ TEST_F(FunctionsDataViewTest, ColumnSorting) {
   EXPECT_EQ(view_.GetDefaultSortingColumn(), kAddressColumn);
 
   std::vector<orbit_client_protos::FunctionInfo> functions = functions_;
-  view_.AddFunctions(
-      {&functions_[0], &functions_[1], &functions_[2], &functions_[3], &functions_[4]});
+  AddFunctionsToView({0, 1, 2, 3, 4});
 
   const auto verify_correct_sorting = [&]() {
     // We won't check all columns because we control the test data and know that checking address
@@ -641,7 +657,7 @@ TEST_F(FunctionsDataViewTest, ContextMenuActionsCallCorrespondingFunctionsInAppI
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions({&functions_[0]});
+  AddFunctionsToView({0});
 
   const auto match_function = [&](const orbit_client_protos::FunctionInfo& function) {
     EXPECT_EQ(function.address(), functions_[0].address());
@@ -699,8 +715,7 @@ TEST_F(FunctionsDataViewTest, FilteringByFunctionName) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions(
-      {&functions_[0], &functions_[1], &functions_[2], &functions_[3], &functions_[4]});
+  AddFunctionsToView({0, 1, 2, 3, 4});
 
   // Filtering by an empty string should result in all functions listed -> No filtering.
   view_.OnFilter("");
@@ -754,8 +769,7 @@ TEST_F(FunctionsDataViewTest, FilteringByModuleName) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions(
-      {&functions_[0], &functions_[1], &functions_[2], &functions_[3], &functions_[4]});
+  AddFunctionsToView({0, 1, 2, 3, 4});
 
   // Only the filename is considered when filtering, so searching for the full file path results in
   // an empty search result.
@@ -783,8 +797,7 @@ TEST_F(FunctionsDataViewTest, FilteringByFunctionAndModuleName) {
       .Times(testing::AnyNumber())
       .WillRepeatedly(testing::Return(false));
 
-  view_.AddFunctions(
-      {&functions_[0], &functions_[1], &functions_[2], &functions_[3], &functions_[4]});
+  AddFunctionsToView({0, 1, 2, 3, 4});
 
   // ffind is the name of the function while foomodule is the filename of the corresponding module.
   view_.OnFilter("ffind foomodule");
@@ -5,9 +5,11 @@
 #ifndef DATA_VIEWS_FUNCTIONS_DATA_VIEW_H_
 #define DATA_VIEWS_FUNCTIONS_DATA_VIEW_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "ClientData/FunctionTable.h"
 #include "DataViews/AppInterface.h"
 #include "DataViews/DataView.h"
 #include "OrbitBase/ThreadPool.h"
@@ -33,13 +35,14 @@ class FunctionsDataView : public DataView {
 
   void OnContextMenu(const std::string& action, int menu_index,
                      const std::vector<int>& item_indices) override;
-  void AddFunctions(std::vector<const orbit_client_protos::FunctionInfo*> functions);
+  // The table is kept alive as long as its functions are in the view.
+  void AddFunctions(std::shared_ptr<const orbit_client_data::FunctionTable> functions);
   void ClearFunctions();
 
  protected:
   void DoSort() override;
   void DoFilter() override;
-  [[nodiscard]] const orbit_client_protos::FunctionInfo* GetFunction(int row) const {
+  [[nodiscard]] orbit_client_data::FunctionHandle GetFunction(int row) const {
     return functions_[indices_[row]];
   }
 
@@ -66,7 +69,8 @@ class FunctionsDataView : public DataView {
                                              const orbit_client_protos::FunctionInfo& function);
   static bool ShouldShowFrameTrackIcon(AppInterface* app,
                                        const orbit_client_protos::FunctionInfo& function);
-  std::vector<const orbit_client_protos::FunctionInfo*> functions_;
+  std::vector<std::shared_ptr<const orbit_client_data::FunctionTable>> function_tables_;
+  std::vector<orbit_client_data::FunctionHandle> functions_;
 
   ThreadPool* thread_pool_;
 };
@@ -185,6 +185,8 @@ int main(int argc, char* argv[]) {
   constexpr bool kEnableIntrospection = false;
   constexpr bool kEnableUserSpaceInstrumentation = false;
   constexpr uint64_t kMaxLocalMarkerDepthPerCommandBuffer = std::numeric_limits<uint64_t>::max();
+  constexpr uint64_t kFunctionCallCoalescingThresholdNs = 0;
+  constexpr uint64_t kFunctionCallCoalescingMaxGapNs = 0;
   bool collect_memory_info = absl::GetFlag(FLAGS_memory_sampling_rate) > 0;
   LOG("collect_memory_info=%d", collect_memory_info);
   uint64_t memory_sampling_period_ms = 0;
@@ -242,7 +244,8 @@ int main(int argc, char* argv[]) {
       orbit_client_data::TracepointInfoSet{}, samples_per_second, kStackDumpSize, unwinding_method,
       collect_scheduling_info, collect_thread_state, collect_gpu_jobs, kEnableApi,
       kEnableIntrospection, kEnableUserSpaceInstrumentation, kMaxLocalMarkerDepthPerCommandBuffer,
-      collect_memory_info, memory_sampling_period_ms, std::move(capture_event_processor));
+      collect_memory_info, memory_sampling_period_ms, kFunctionCallCoalescingThresholdNs,
+      kFunctionCallCoalescingMaxGapNs, std::move(capture_event_processor));
   LOG("Asked to start capture");
 
   uint32_t duration_s = absl::GetFlag(FLAGS_duration);
@@ -0,0 +1,120 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "FramePointerValidator/CachingFramePointerValidator.h"
+
+#include "FramePointerValidator/FramePointerValidator.h"
+#include "OrbitBase/Logging.h"
+
+using orbit_grpc_protos::CodeBlock;
+
+CachingFramePointerValidator::CachingFramePointerValidator(ThreadPool* thread_pool,
+                                                           size_t max_num_cached_build_ids)
+    : thread_pool_{thread_pool}, max_num_cached_build_ids_{max_num_cached_build_ids} {
+  CHECK(thread_pool_ != nullptr);
+  CHECK(max_num_cached_build_ids_ > 0);
+}
+
+std::optional<std::vector<CodeBlock>> CachingFramePointerValidator::GetFpoFunctions(
+    const std::vector<CodeBlock>& functions, const std::filesystem::path& file_name,
+    const std::string& build_id, bool is_64_bit) {
+  if (build_id.empty()) {
+    return FramePointerValidator::GetFpoFunctions(functions, file_name, is_64_bit, thread_pool_);
+  }
+
+  // The entry can be evicted by other calls while the lock is not held, so the results are
+  // collected here rather than read back from the cache at the end.
+  std::vector<std::optional<bool>> has_frame_pointers(functions.size());
+  std::vector<CodeBlock> uncached_functions;
+  {
+    absl::MutexLock lock(&mutex_);
+    const CacheEntry* entry = FindCacheEntry(build_id);
+    for (size_t i = 0; i < functions.size(); ++i) {
+      const CodeBlock& function = functions[i];
+      if (function.size() == 0) continue;
+      if (entry == nullptr) {
+        uncached_functions.push_back(function);
+        continue;
+      }
+      auto it = entry->has_frame_pointers.find(FunctionKey{function.offset(), function.size()});
+      if (it != entry->has_frame_pointers.end()) {
+        has_frame_pointers[i] = it->second;
+      } else {
+        uncached_functions.push_back(function);
+      }
+    }
+  }
+
+  if (!uncached_functions.empty()) {
+    std::optional<std::vector<CodeBlock>> uncached_fpo_functions =
+        FramePointerValidator::GetFpoFunctions(uncached_functions, file_name, is_64_bit,
+                                               thread_pool_);
+    if (!uncached_fpo_functions.has_value()) return {};
+
+    absl::flat_hash_map<FunctionKey, bool> uncached_has_frame_pointers;
+    uncached_has_frame_pointers.reserve(uncached_functions.size());
+    for (const CodeBlock& function : uncached_functions) {
+      uncached_has_frame_pointers.insert_or_assign(FunctionKey{function.offset(), function.size()},
+                                                   true);
+    }
+    for (const CodeBlock& function : uncached_fpo_functions.value()) {
+      uncached_has_frame_pointers[FunctionKey{function.offset(), function.size()}] = false;
+    }
+
+    for (size_t i = 0; i < functions.size(); ++i) {
+      const CodeBlock& function = functions[i];
+      if (function.size() == 0 || has_frame_pointers[i].has_value()) continue;
+      has_frame_pointers[i] =
+          uncached_has_frame_pointers.at(FunctionKey{function.offset(), function.size()});
+    }
+
+    absl::MutexLock lock(&mutex_);
+    CacheEntry& entry = GetOrCreateCacheEntry(build_id);
+    entry.has_frame_pointers.reserve(entry.has_frame_pointers.size() +
+                                     uncached_has_frame_pointers.size());
+    for (const auto& [function_key, function_has_frame_pointers] : uncached_has_frame_pointers) {
+      entry.has_frame_pointers.insert_or_assign(function_key, function_has_frame_pointers);
+    }
+  }
+
+  std::vector<CodeBlock> result;
+  for (size_t i = 0; i < functions.size(); ++i) {
+    if (has_frame_pointers[i].has_value() && !has_frame_pointers[i].value()) {
+      result.push_back(functions[i]);
+    }
+  }
+  return result;
+}
+
+CachingFramePointerValidator::CacheEntry* CachingFramePointerValidator::FindCacheEntry(
+    const std::string& build_id) {
+  auto it = cache_entries_by_build_id_.find(build_id);
+  if (it == cache_entries_by_build_id_.end()) return nullptr;
+  recently_used_build_ids_.splice(recently_used_build_ids_.begin(), recently_used_build_ids_,
+                                  it->second.recently_used_build_ids_it);
+  return &it->second;
+}
+
+CachingFramePointerValidator::CacheEntry& CachingFramePointerValidator::GetOrCreateCacheEntry(
+    const std::string& build_id) {
+  if (CacheEntry* entry = FindCacheEntry(build_id); entry != nullptr) return *entry;
+
+  if (cache_entries_by_build_id_.size() >= max_num_cached_build_ids_) {
+    cache_entries_by_build_id_.erase(recently_used_build_ids_.back());
+    recently_used_build_ids_.pop_back();
+  }
+  recently_used_build_ids_.push_front(build_id);
+  CacheEntry& entry = cache_entries_by_build_id_[build_id];
+  entry.recently_used_build_ids_it = recently_used_build_ids_.begin();
+  return entry;
+}
+
+size_t CachingFramePointerValidator::GetNumCachedFunctions() const {
+  absl::MutexLock lock(&mutex_);
+  size_t num_cached_functions = 0;
+  for (const auto& [unused_build_id, entry] : cache_entries_by_build_id_) {
+    num_cached_functions += entry.has_frame_pointers.size();
+  }
+  return num_cached_functions;
+}
@@ -0,0 +1,179 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <absl/time/time.h>
+#include <absl/types/span.h>
+#include <gtest/gtest.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FramePointerValidator/CachingFramePointerValidator.h"
+#include "FramePointerValidator/FramePointerValidator.h"
+#include "OrbitBase/ExecutablePath.h"
+#include "OrbitBase/File.h"
+#include "OrbitBase/Logging.h"
+#include "OrbitBase/ReadFileToString.h"
+#include "OrbitBase/TemporaryFile.h"
+#include "OrbitBase/ThreadPool.h"
+#include "code_block.pb.h"
+
+using orbit_grpc_protos::CodeBlock;
+
+namespace {
+
+// 64-bit code of a function with frame pointers.
+constexpr uint8_t kFunctionWithFramePointers[] = {
+    0x55,                          // push rbp
+    0x48, 0x89, 0xE5,              // mov rbp,rsp
+    0x48, 0x83, 0xC0, 0x01,        // add rax,0x1
+    0xE8, 0x00, 0x00, 0x00, 0x00,  // call
+    0x48, 0x89, 0xEC,              // mov rsp,rbp
+    0x5D,                          // pop rbp
+    0xC3                           // ret
+};
+
+// 64-bit code of a non-leaf function without frame pointers.
+constexpr uint8_t kFunctionWithoutFramePointers[] = {
+    0x48, 0x83, 0xC0, 0x01,        // add rax,0x1
+    0xE8, 0x00, 0x00, 0x00, 0x00,  // call
+    0x48, 0x83, 0xE8, 0x01,        // sub rax,0x1
+    0xC3                           // ret
+};
+
+// A large ELF file, generated by appending `num_functions` functions to hello_world_elf, every
+// other one without frame pointers.
+struct GeneratedElfFile {
+  orbit_base::TemporaryFile file;
+  std::vector<CodeBlock> functions;
+  std::vector<CodeBlock> functions_without_frame_pointers;
+};
+
+GeneratedElfFile GenerateElfFile(size_t num_functions) {
+  const std::filesystem::path hello_world_elf =
+      orbit_base::GetExecutableDir() / "testdata" / "hello_world_elf";
+  ErrorMessageOr<std::string> content_or_error = orbit_base::ReadFileToString(hello_world_elf);
+  CHECK(content_or_error.has_value());
+  std::string content = std::move(content_or_error.value());
+
+  std::vector<CodeBlock> functions;
+  std::vector<CodeBlock> functions_without_frame_pointers;
+  for (size_t i = 0; i < num_functions; ++i) {
+    const bool has_frame_pointers = i % 2 == 0;
+    absl::Span<const uint8_t> code = has_frame_pointers
+                                         ? absl::MakeConstSpan(kFunctionWithFramePointers)
+                                         : absl::MakeConstSpan(kFunctionWithoutFramePointers);
+    CodeBlock function;
+    function.set_offset(content.size());
+    function.set_size(code.size());
+    content.append(code.begin(), code.end());
+    functions.push_back(function);
+    if (!has_frame_pointers) functions_without_frame_pointers.push_back(function);
+  }
+
+  ErrorMessageOr<orbit_base::TemporaryFile> file_or_error = orbit_base::TemporaryFile::Create();
+  CHECK(file_or_error.has_value());
+  CHECK(!orbit_base::WriteFully(file_or_error.value().fd(), content).has_error());
+  return GeneratedElfFile{std::move(file_or_error.value()), std::move(functions),
+                          std::move(functions_without_frame_pointers)};
+}
+
+[[nodiscard]] bool HaveSameOffsets(const std::vector<CodeBlock>& lhs,
+                                   const std::vector<CodeBlock>& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](const CodeBlock& lhs_function, const CodeBlock& rhs_function) {
+                      return lhs_function.offset() == rhs_function.offset() &&
+                             lhs_function.size() == rhs_function.size();
+                    });
+}
+
+class CachingFramePointerValidatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+    thread_pool_ = ThreadPool::Create(num_threads, num_threads, absl::Seconds(1));
+  }
+  void TearDown() override { thread_pool_->ShutdownAndWait(); }
+
+  std::shared_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace
+
+TEST_F(CachingFramePointerValidatorTest, ValidationOnThreadPoolMatchesSerialValidation) {
+  GeneratedElfFile elf_file = GenerateElfFile(5'000);
+
+  std::optional<std::vector<CodeBlock>> serial_fpo_functions =
+      FramePointerValidator::GetFpoFunctions(elf_file.functions, elf_file.file.file_path(), true);
+  ASSERT_TRUE(serial_fpo_functions.has_value());
+  EXPECT_TRUE(HaveSameOffsets(serial_fpo_functions.value(),
+                              elf_file.functions_without_frame_pointers));
+
+  std::optional<std::vector<CodeBlock>> parallel_fpo_functions =
+      FramePointerValidator::GetFpoFunctions(elf_file.functions, elf_file.file.file_path(), true,
+                                             thread_pool_.get());
+  ASSERT_TRUE(parallel_fpo_functions.has_value());
+  EXPECT_TRUE(HaveSameOffsets(parallel_fpo_functions.value(), serial_fpo_functions.value()));
+}
+
+TEST_F(CachingFramePointerValidatorTest, FunctionOutsideOfFileIsAnError) {
+  GeneratedElfFile elf_file = GenerateElfFile(10);
+  CodeBlock function = elf_file.functions.back();
+  function.set_offset(function.offset() + 1);
+  elf_file.functions.push_back(function);
+
+  EXPECT_FALSE(
+      FramePointerValidator::GetFpoFunctions(elf_file.functions, elf_file.file.file_path(), true)
+          .has_value());
+}
+
+TEST_F(CachingFramePointerValidatorTest, ResultsAreCachedByBuildId) {
+  GeneratedElfFile elf_file = GenerateElfFile(100);
+  CachingFramePointerValidator validator{thread_pool_.get()};
+
+  std::optional<std::vector<CodeBlock>> fpo_functions = validator.GetFpoFunctions(
+      elf_file.functions, elf_file.file.file_path(), "build_id", true);
+  ASSERT_TRUE(fpo_functions.has_value());
+  EXPECT_TRUE(HaveSameOffsets(fpo_functions.value(), elf_file.functions_without_frame_pointers));
+  EXPECT_EQ(validator.GetNumCachedFunctions(), elf_file.functions.size());
+
+  // The cached results don't need the file anymore.
+  const std::filesystem::path file_path = elf_file.file.file_path();
+  elf_file.file.CloseAndRemove();
+  fpo_functions = validator.GetFpoFunctions(elf_file.functions, file_path, "build_id", true);
+  ASSERT_TRUE(fpo_functions.has_value());
+  EXPECT_TRUE(HaveSameOffsets(fpo_functions.value(), elf_file.functions_without_frame_pointers));
+
+  // Neither a module with another build id, nor one without build id, uses the cache.
+  EXPECT_FALSE(validator.GetFpoFunctions(elf_file.functions, file_path, "other_build_id", true)
+                   .has_value());
+  EXPECT_FALSE(validator.GetFpoFunctions(elf_file.functions, file_path, "", true).has_value());
+  EXPECT_EQ(validator.GetNumCachedFunctions(), elf_file.functions.size());
+}
+
+TEST_F(CachingFramePointerValidatorTest, LeastRecentlyUsedBuildIdIsEvicted) {
+  GeneratedElfFile elf_file = GenerateElfFile(10);
+  const std::filesystem::path file_path = elf_file.file.file_path();
+  CachingFramePointerValidator validator{thread_pool_.get(), /*max_num_cached_build_ids=*/2};
+
+  EXPECT_TRUE(validator.GetFpoFunctions(elf_file.functions, file_path, "a", true).has_value());
+  EXPECT_TRUE(validator.GetFpoFunctions(elf_file.functions, file_path, "b", true).has_value());
+  EXPECT_TRUE(validator.GetFpoFunctions(elf_file.functions, file_path, "a", true).has_value());
+  EXPECT_TRUE(validator.GetFpoFunctions(elf_file.functions, file_path, "c", true).has_value());
+  EXPECT_EQ(validator.GetNumCachedFunctions(), 2 * elf_file.functions.size());
+
+  // Only "b" needs the file again.
+  elf_file.file.CloseAndRemove();
+  EXPECT_TRUE(validator.GetFpoFunctions(elf_file.functions, file_path, "a", true).has_value());
+  EXPECT_TRUE(validator.GetFpoFunctions(elf_file.functions, file_path, "c", true).has_value());
+  EXPECT_FALSE(validator.GetFpoFunctions(elf_file.functions, file_path, "b", true).has_value());
+}
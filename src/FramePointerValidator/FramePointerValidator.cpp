@@ -4,27 +4,38 @@
 
 #include "FramePointerValidator/FramePointerValidator.h"
 
+#include <absl/types/span.h>
 #include <capstone/capstone.h>
+#include <errno.h>
 #include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <algorithm>
 #include <cstdint>
-#include <ios>
-#include <iterator>
 #include <utility>
 
 #include "FramePointerValidator/FunctionFramePointerValidator.h"
+#include "OrbitBase/File.h"
+#include "OrbitBase/Future.h"
 #include "OrbitBase/Logging.h"
-#include "OrbitBase/ReadFileToString.h"
+#include "OrbitBase/SafeStrerror.h"
 #include "OrbitBase/UniqueResource.h"
 
 using orbit_grpc_protos::CodeBlock;
 
-std::optional<std::vector<CodeBlock>> FramePointerValidator::GetFpoFunctions(
-    const std::vector<CodeBlock>& functions, const std::filesystem::path& file_name,
-    bool is_64_bit) {
-  std::vector<CodeBlock> result;
+namespace {
 
+// On a thread pool, functions are validated in chunks of this size. The cost of scheduling a chunk
+// and of opening its Capstone handle is small compared to validating this many functions, while a
+// large module still has enough chunks to keep all threads busy.
+constexpr size_t kNumFunctionsPerChunk = 512;
+
+// Returns the functions in `functions` that failed validation, in the same order, or nullopt if
+// Capstone could not be opened. `content` is the content of the whole file.
+std::optional<std::vector<CodeBlock>> GetFpoFunctionsInChunk(absl::Span<const CodeBlock> functions,
+                                                             const uint8_t* content,
+                                                             bool is_64_bit) {
   cs_mode mode = is_64_bit ? CS_MODE_64 : CS_MODE_32;
   csh temp_handle;
   if (cs_open(CS_ARCH_X86, mode, &temp_handle) != CS_ERR_OK) {
@@ -35,21 +46,15 @@ std::optional<std::vector<CodeBlock>> FramePointerValidator::GetFpoFunctions(
 
   cs_option(handle.get(), CS_OPT_DETAIL, CS_OPT_ON);
 
-  ErrorMessageOr<std::string> binary_or_error = orbit_base::ReadFileToString(file_name);
-  if (binary_or_error.has_error()) {
-    ERROR("%s", binary_or_error.error().message());
-    return {};
-  }
-
+  std::vector<CodeBlock> result;
   for (const auto& function : functions) {
     uint64_t function_size = function.size();
     if (function_size == 0) {
       continue;
     }
 
-    const std::string& content = binary_or_error.value();
-    FunctionFramePointerValidator validator{handle.get(), content.data() + function.offset(),
-                                            static_cast<size_t>(function.size())};
+    FunctionFramePointerValidator validator{handle.get(), content + function.offset(),
+                                            static_cast<size_t>(function_size)};
 
     if (!validator.Validate()) {
       result.push_back(function);
@@ -57,3 +62,70 @@ std::optional<std::vector<CodeBlock>> FramePointerValidator::GetFpoFunctions(
   }
   return result;
 }
+
+}  // namespace
+
+std::optional<std::vector<CodeBlock>> FramePointerValidator::GetFpoFunctions(
+    const std::vector<CodeBlock>& functions, const std::filesystem::path& file_name,
+    bool is_64_bit, ThreadPool* thread_pool) {
+  ErrorMessageOr<orbit_base::unique_fd> fd_or_error = orbit_base::OpenFileForReading(file_name);
+  if (fd_or_error.has_error()) {
+    ERROR("%s", fd_or_error.error().message());
+    return {};
+  }
+
+  struct stat st {};
+  if (fstat(fd_or_error.value().get(), &st) == -1) {
+    ERROR("Unable to get size of \"%s\": %s", file_name.string(), SafeStrerror(errno));
+    return {};
+  }
+  const auto file_size = static_cast<uint64_t>(st.st_size);
+
+  // Reading outside of the mapping would not fail gracefully, so the functions are checked first.
+  for (const auto& function : functions) {
+    if (function.size() > 0 &&
+        (function.offset() > file_size || function.size() > file_size - function.offset())) {
+      ERROR("Function at offset %#x of size %u is outside of \"%s\"", function.offset(),
+            function.size(), file_name.string());
+      return {};
+    }
+  }
+  if (file_size == 0) return std::vector<CodeBlock>{};
+
+  void* address =
+      mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd_or_error.value().get(), /*offset=*/0);
+  if (address == MAP_FAILED) {
+    ERROR("Unable to map \"%s\": %s", file_name.string(), SafeStrerror(errno));
+    return {};
+  }
+  orbit_base::unique_resource mapping{address,
+                                      [file_size](void* address) { munmap(address, file_size); }};
+  const auto* content = static_cast<const uint8_t*>(mapping.get());
+
+  if (thread_pool == nullptr) {
+    return GetFpoFunctionsInChunk(functions, content, is_64_bit);
+  }
+
+  std::vector<orbit_base::Future<std::optional<std::vector<CodeBlock>>>> chunk_results;
+  for (size_t chunk_begin = 0; chunk_begin < functions.size();
+       chunk_begin += kNumFunctionsPerChunk) {
+    absl::Span<const CodeBlock> chunk =
+        absl::MakeConstSpan(functions).subspan(chunk_begin, kNumFunctionsPerChunk);
+    chunk_results.emplace_back(thread_pool->Schedule(
+        [chunk, content, is_64_bit] { return GetFpoFunctionsInChunk(chunk, content, is_64_bit); }));
+  }
+
+  // All chunks need to be done before the mapping is released, even after an error.
+  std::vector<CodeBlock> result;
+  bool has_error = false;
+  for (const auto& chunk_result : chunk_results) {
+    const std::optional<std::vector<CodeBlock>>& chunk_fpo_functions = chunk_result.Get();
+    if (!chunk_fpo_functions.has_value()) {
+      has_error = true;
+      continue;
+    }
+    result.insert(result.end(), chunk_fpo_functions->begin(), chunk_fpo_functions->end());
+  }
+  if (has_error) return {};
+  return result;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef FRAME_POINTER_VALIDATOR_CACHING_FRAME_POINTER_VALIDATOR_H_
+#define FRAME_POINTER_VALIDATOR_CACHING_FRAME_POINTER_VALIDATOR_H_
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <filesystem>
+#include <list>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "OrbitBase/ThreadPool.h"
+#include "code_block.pb.h"
+
+// Validates functions like FramePointerValidator::GetFpoFunctions, on the given thread pool, and
+// remembers the result of each function by build id, offset and size. Functions of a module that
+// were already validated are not disassembled again. Modules without a build id are not cached.
+// Only the results of the `max_num_cached_build_ids` most recently validated build ids are kept.
+// This class is thread-safe.
+class CachingFramePointerValidator {
+ public:
+  static constexpr size_t kDefaultMaxNumCachedBuildIds = 64;
+
+  explicit CachingFramePointerValidator(
+      ThreadPool* thread_pool, size_t max_num_cached_build_ids = kDefaultMaxNumCachedBuildIds);
+
+  [[nodiscard]] std::optional<std::vector<orbit_grpc_protos::CodeBlock>> GetFpoFunctions(
+      const std::vector<orbit_grpc_protos::CodeBlock>& functions,
+      const std::filesystem::path& file_name, const std::string& build_id, bool is_64_bit);
+
+  [[nodiscard]] size_t GetNumCachedFunctions() const;
+
+ private:
+  // Offset and size of a function.
+  using FunctionKey = std::pair<uint64_t, uint64_t>;
+
+  struct CacheEntry {
+    // Whether each validated function has frame pointers.
+    absl::flat_hash_map<FunctionKey, bool> has_frame_pointers;
+    std::list<std::string>::iterator recently_used_build_ids_it;
+  };
+
+  // Returns the entry of `build_id`, or nullptr if there is none, and marks it as the most
+  // recently used.
+  [[nodiscard]] CacheEntry* FindCacheEntry(const std::string& build_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // The same, but creates the entry if there is none, evicting the least recently used entry if
+  // there are too many.
+  [[nodiscard]] CacheEntry& GetOrCreateCacheEntry(const std::string& build_id)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  ThreadPool* thread_pool_;
+  size_t max_num_cached_build_ids_;
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, CacheEntry> cache_entries_by_build_id_ ABSL_GUARDED_BY(mutex_);
+  // From the most to the least recently used.
+  std::list<std::string> recently_used_build_ids_ ABSL_GUARDED_BY(mutex_);
+};
+
+#endif  // FRAME_POINTER_VALIDATOR_CACHING_FRAME_POINTER_VALIDATOR_H_
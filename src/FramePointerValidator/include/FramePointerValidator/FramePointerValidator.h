@@ -9,6 +9,7 @@
 #include <optional>
 #include <vector>
 
+#include "OrbitBase/ThreadPool.h"
 #include "code_block.pb.h"
 
 class FramePointerValidator {
@@ -16,9 +17,12 @@ class FramePointerValidator {
   // Checks all given functions if they were compiled with frame pointers and
   // returns the functions, where validation failed. If there was an error
   // during validation, nullopt will be return.
+  // The file is memory mapped rather than read. If a `thread_pool` is given, the
+  // functions are validated in chunks on the thread pool, each with its own Capstone
+  // handle; the result is the same, and in the same order, as without.
   static std::optional<std::vector<orbit_grpc_protos::CodeBlock>> GetFpoFunctions(
       const std::vector<orbit_grpc_protos::CodeBlock>& functions,
-      const std::filesystem::path& file_name, bool is_64_bit);
+      const std::filesystem::path& file_name, bool is_64_bit, ThreadPool* thread_pool = nullptr);
 };
 
 #endif  // FRAME_POINTER_VALIDATOR_FRAME_POINTER_VALIDATOR_H_
@@ -19,6 +19,16 @@ constexpr uint64_t kLinuxTracingProducerId = 1;
 constexpr uint64_t kMemoryInfoProducerId = 2;
 constexpr uint64_t kExternalProducerStartingId = 1024;
 
+// The largest stack dump size (CaptureOptions::stack_dump_size) that the service accepts.
+// Max to pass to perf_event_open without getting an error is (1u << 16u) - 8,
+// because the kernel stores this in a short and because of alignment reasons.
+// But the size the kernel actually returns is smaller, because the maximum size
+// of the entire record the kernel is willing to return is (1u << 16u) - 8.
+// If we want the size we pass to coincide with the size we get, we need to pass
+// a lower value. For the current layout of perf_event_stack_sample_fixed, the maximum
+// size is 65312. We leave some extra room with our flag (see `ClientFlags.cpp`).
+constexpr uint16_t kMaxStackDumpSize = 65000;
+
 enum class UnwindingMethod { kDwarfUnwinding, kFramePointerUnwinding };
 }  // namespace orbit_grpc_protos
 
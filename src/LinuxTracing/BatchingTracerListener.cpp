@@ -0,0 +1,103 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "BatchingTracerListener.h"
+
+#include "Introspection/Introspection.h"
+
+namespace orbit_linux_tracing {
+
+void BatchingTracerListener::OnIntrospectionScope(
+    orbit_grpc_protos::IntrospectionScope introspection_scope) {
+  Flush();
+  listener_->OnIntrospectionScope(std::move(introspection_scope));
+}
+
+void BatchingTracerListener::OnThreadName(orbit_grpc_protos::ThreadName thread_name) {
+  Flush();
+  listener_->OnThreadName(std::move(thread_name));
+}
+
+void BatchingTracerListener::OnThreadNamesSnapshot(
+    orbit_grpc_protos::ThreadNamesSnapshot thread_names_snapshot) {
+  Flush();
+  listener_->OnThreadNamesSnapshot(std::move(thread_names_snapshot));
+}
+
+void BatchingTracerListener::OnTracepointEvent(
+    orbit_grpc_protos::FullTracepointEvent tracepoint_event) {
+  Flush();
+  listener_->OnTracepointEvent(std::move(tracepoint_event));
+}
+
+void BatchingTracerListener::OnModulesSnapshot(
+    orbit_grpc_protos::ModulesSnapshot modules_snapshot) {
+  Flush();
+  listener_->OnModulesSnapshot(std::move(modules_snapshot));
+}
+
+void BatchingTracerListener::OnModuleUpdate(
+    orbit_grpc_protos::ModuleUpdateEvent module_update_event) {
+  Flush();
+  listener_->OnModuleUpdate(std::move(module_update_event));
+}
+
+void BatchingTracerListener::OnErrorsWithPerfEventOpenEvent(
+    orbit_grpc_protos::ErrorsWithPerfEventOpenEvent errors_with_perf_event_open_event) {
+  Flush();
+  listener_->OnErrorsWithPerfEventOpenEvent(std::move(errors_with_perf_event_open_event));
+}
+
+void BatchingTracerListener::OnLostPerfRecordsEvent(
+    orbit_grpc_protos::LostPerfRecordsEvent lost_perf_records_event) {
+  Flush();
+  listener_->OnLostPerfRecordsEvent(std::move(lost_perf_records_event));
+}
+
+void BatchingTracerListener::OnOutOfOrderEventsDiscardedEvent(
+    orbit_grpc_protos::OutOfOrderEventsDiscardedEvent out_of_order_events_discarded_event) {
+  Flush();
+  listener_->OnOutOfOrderEventsDiscardedEvent(std::move(out_of_order_events_discarded_event));
+}
+
+void BatchingTracerListener::OnUnwindingErrorsSummaryEvent(
+    orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) {
+  Flush();
+  listener_->OnUnwindingErrorsSummaryEvent(std::move(unwinding_errors_summary_event));
+}
+
+namespace {
+// Moves the pending events out of `events`, leaving it empty for the next batch.
+template <typename Event>
+[[nodiscard]] std::vector<Event> TakeEvents(std::vector<Event>* events) {
+  std::vector<Event> taken_events = std::move(*events);
+  events->clear();
+  return taken_events;
+}
+}  // namespace
+
+void BatchingTracerListener::Flush() {
+  ORBIT_SCOPE_FUNCTION;
+  pending_type_ = BatchedEventType::kNone;
+  if (!address_infos_.empty()) {
+    listener_->OnAddressInfos(TakeEvents(&address_infos_));
+  }
+  if (!callstack_samples_.empty()) {
+    listener_->OnCallstackSamples(TakeEvents(&callstack_samples_));
+  }
+  if (!function_calls_.empty()) {
+    listener_->OnFunctionCalls(TakeEvents(&function_calls_));
+  }
+  if (!gpu_jobs_.empty()) {
+    listener_->OnGpuJobs(TakeEvents(&gpu_jobs_));
+  }
+  if (!scheduling_slices_.empty()) {
+    listener_->OnSchedulingSlices(TakeEvents(&scheduling_slices_));
+  }
+  if (!thread_state_slices_.empty()) {
+    listener_->OnThreadStateSlices(TakeEvents(&thread_state_slices_));
+  }
+}
+
+}  // namespace orbit_linux_tracing
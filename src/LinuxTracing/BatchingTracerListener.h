@@ -0,0 +1,102 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_BATCHING_TRACER_LISTENER_H_
+#define LINUX_TRACING_BATCHING_TRACER_LISTENER_H_
+
+#include <utility>
+#include <vector>
+
+#include "LinuxTracing/TracerListener.h"
+#include "OrbitBase/Logging.h"
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+// This TracerListener is what the PerfEventVisitors report to. It collects consecutive events of
+// the same frequent type (those with a batched callback in TracerListener) and passes them to the
+// batched callback of the wrapped listener on Flush, which TracerThread calls each time
+// PerfEventProcessor has processed a batch of PerfEvents.
+// Pending events are also flushed when an event of a different type arrives, so that the wrapped
+// listener receives all events in the order in which they were reported (which is timestamp
+// order, as PerfEventProcessor processes PerfEvents in that order).
+// This class is not thread safe, as PerfEventProcessor only processes events on one thread.
+class BatchingTracerListener final : public TracerListener {
+ public:
+  explicit BatchingTracerListener(TracerListener* listener) : listener_{listener} {
+    CHECK(listener_ != nullptr);
+  }
+
+  void OnSchedulingSlice(orbit_grpc_protos::SchedulingSlice scheduling_slice) override {
+    AddEvent(BatchedEventType::kSchedulingSlice, &scheduling_slices_, std::move(scheduling_slice));
+  }
+  void OnCallstackSample(orbit_grpc_protos::FullCallstackSample callstack_sample) override {
+    AddEvent(BatchedEventType::kCallstackSample, &callstack_samples_, std::move(callstack_sample));
+  }
+  void OnFunctionCall(orbit_grpc_protos::FunctionCall function_call) override {
+    AddEvent(BatchedEventType::kFunctionCall, &function_calls_, std::move(function_call));
+  }
+  void OnGpuJob(orbit_grpc_protos::FullGpuJob gpu_job) override {
+    AddEvent(BatchedEventType::kGpuJob, &gpu_jobs_, std::move(gpu_job));
+  }
+  void OnThreadStateSlice(orbit_grpc_protos::ThreadStateSlice thread_state_slice) override {
+    AddEvent(BatchedEventType::kThreadStateSlice, &thread_state_slices_,
+             std::move(thread_state_slice));
+  }
+  void OnAddressInfo(orbit_grpc_protos::FullAddressInfo full_address_info) override {
+    AddEvent(BatchedEventType::kAddressInfo, &address_infos_, std::move(full_address_info));
+  }
+
+  void OnIntrospectionScope(orbit_grpc_protos::IntrospectionScope introspection_scope) override;
+  void OnThreadName(orbit_grpc_protos::ThreadName thread_name) override;
+  void OnThreadNamesSnapshot(orbit_grpc_protos::ThreadNamesSnapshot thread_names_snapshot) override;
+  void OnTracepointEvent(orbit_grpc_protos::FullTracepointEvent tracepoint_event) override;
+  void OnModulesSnapshot(orbit_grpc_protos::ModulesSnapshot modules_snapshot) override;
+  void OnModuleUpdate(orbit_grpc_protos::ModuleUpdateEvent module_update_event) override;
+  void OnErrorsWithPerfEventOpenEvent(
+      orbit_grpc_protos::ErrorsWithPerfEventOpenEvent errors_with_perf_event_open_event) override;
+  void OnLostPerfRecordsEvent(
+      orbit_grpc_protos::LostPerfRecordsEvent lost_perf_records_event) override;
+  void OnOutOfOrderEventsDiscardedEvent(orbit_grpc_protos::OutOfOrderEventsDiscardedEvent
+                                            out_of_order_events_discarded_event) override;
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) override;
+
+  // Passes the pending events to the wrapped listener.
+  void Flush();
+
+ private:
+  enum class BatchedEventType {
+    kNone,
+    kSchedulingSlice,
+    kCallstackSample,
+    kFunctionCall,
+    kGpuJob,
+    kThreadStateSlice,
+    kAddressInfo,
+  };
+
+  template <typename Event>
+  void AddEvent(BatchedEventType type, std::vector<Event>* events, Event event) {
+    if (type != pending_type_) {
+      Flush();
+      pending_type_ = type;
+    }
+    events->emplace_back(std::move(event));
+  }
+
+  TracerListener* listener_;
+  // The type of the pending events. Only the vector of this type is not empty.
+  BatchedEventType pending_type_ = BatchedEventType::kNone;
+  std::vector<orbit_grpc_protos::FullAddressInfo> address_infos_;
+  std::vector<orbit_grpc_protos::FullCallstackSample> callstack_samples_;
+  std::vector<orbit_grpc_protos::FunctionCall> function_calls_;
+  std::vector<orbit_grpc_protos::FullGpuJob> gpu_jobs_;
+  std::vector<orbit_grpc_protos::SchedulingSlice> scheduling_slices_;
+  std::vector<orbit_grpc_protos::ThreadStateSlice> thread_state_slices_;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_BATCHING_TRACER_LISTENER_H_
@@ -0,0 +1,167 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <absl/strings/str_format.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BatchingTracerListener.h"
+#include "LinuxTracing/TracerListener.h"
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+namespace {
+
+// Implements all the single-event callbacks, and records which callbacks were called.
+class RecordingTracerListener : public TracerListener {
+ public:
+  void OnSchedulingSlice(orbit_grpc_protos::SchedulingSlice scheduling_slice) override {
+    calls_.emplace_back(absl::StrFormat("SchedulingSlice %d", scheduling_slice.tid()));
+  }
+  void OnCallstackSample(orbit_grpc_protos::FullCallstackSample /*callstack_sample*/) override {
+    calls_.emplace_back("CallstackSample");
+  }
+  void OnFunctionCall(orbit_grpc_protos::FunctionCall /*function_call*/) override {
+    calls_.emplace_back("FunctionCall");
+  }
+  void OnIntrospectionScope(
+      orbit_grpc_protos::IntrospectionScope /*introspection_scope*/) override {}
+  void OnGpuJob(orbit_grpc_protos::FullGpuJob /*gpu_job*/) override {}
+  void OnThreadName(orbit_grpc_protos::ThreadName /*thread_name*/) override {
+    calls_.emplace_back("ThreadName");
+  }
+  void OnThreadNamesSnapshot(
+      orbit_grpc_protos::ThreadNamesSnapshot /*thread_names_snapshot*/) override {}
+  void OnThreadStateSlice(orbit_grpc_protos::ThreadStateSlice /*thread_state_slice*/) override {
+    calls_.emplace_back("ThreadStateSlice");
+  }
+  void OnAddressInfo(orbit_grpc_protos::FullAddressInfo /*full_address_info*/) override {
+    calls_.emplace_back("AddressInfo");
+  }
+  void OnTracepointEvent(orbit_grpc_protos::FullTracepointEvent /*tracepoint_event*/) override {}
+  void OnModulesSnapshot(orbit_grpc_protos::ModulesSnapshot /*modules_snapshot*/) override {}
+  void OnModuleUpdate(orbit_grpc_protos::ModuleUpdateEvent /*module_update_event*/) override {}
+  void OnErrorsWithPerfEventOpenEvent(
+      orbit_grpc_protos::ErrorsWithPerfEventOpenEvent /*errors_with_perf_event_open_event*/)
+      override {}
+  void OnLostPerfRecordsEvent(
+      orbit_grpc_protos::LostPerfRecordsEvent /*lost_perf_records_event*/) override {
+    calls_.emplace_back("LostPerfRecordsEvent");
+  }
+  void OnOutOfOrderEventsDiscardedEvent(
+      orbit_grpc_protos::OutOfOrderEventsDiscardedEvent /*out_of_order_events_discarded_event*/)
+      override {}
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/) override {}
+
+  std::vector<std::string> calls_;
+};
+
+// Also records the calls to the batched callbacks.
+class RecordingBatchedTracerListener : public RecordingTracerListener {
+ public:
+  void OnSchedulingSlices(
+      std::vector<orbit_grpc_protos::SchedulingSlice> scheduling_slices) override {
+    calls_.emplace_back(absl::StrFormat("SchedulingSlices %u", scheduling_slices.size()));
+  }
+  void OnCallstackSamples(
+      std::vector<orbit_grpc_protos::FullCallstackSample> callstack_samples) override {
+    calls_.emplace_back(absl::StrFormat("CallstackSamples %u", callstack_samples.size()));
+  }
+  void OnFunctionCalls(std::vector<orbit_grpc_protos::FunctionCall> function_calls) override {
+    calls_.emplace_back(absl::StrFormat("FunctionCalls %u", function_calls.size()));
+  }
+  void OnThreadStateSlices(
+      std::vector<orbit_grpc_protos::ThreadStateSlice> thread_state_slices) override {
+    calls_.emplace_back(absl::StrFormat("ThreadStateSlices %u", thread_state_slices.size()));
+  }
+  void OnAddressInfos(std::vector<orbit_grpc_protos::FullAddressInfo> full_address_infos) override {
+    calls_.emplace_back(absl::StrFormat("AddressInfos %u", full_address_infos.size()));
+  }
+};
+
+orbit_grpc_protos::SchedulingSlice MakeSchedulingSlice(int32_t tid) {
+  orbit_grpc_protos::SchedulingSlice scheduling_slice;
+  scheduling_slice.set_tid(tid);
+  return scheduling_slice;
+}
+
+}  // namespace
+
+TEST(BatchingTracerListener, EventsArePassedInBatchesOnFlush) {
+  RecordingBatchedTracerListener listener;
+  BatchingTracerListener batching_listener{&listener};
+
+  batching_listener.OnAddressInfo(orbit_grpc_protos::FullAddressInfo{});
+  batching_listener.OnAddressInfo(orbit_grpc_protos::FullAddressInfo{});
+  EXPECT_TRUE(listener.calls_.empty());
+  batching_listener.OnCallstackSample(orbit_grpc_protos::FullCallstackSample{});
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(1));
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(2));
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(3));
+  EXPECT_THAT(listener.calls_, testing::ElementsAre("AddressInfos 2", "CallstackSamples 1"));
+
+  batching_listener.Flush();
+  EXPECT_THAT(listener.calls_,
+              testing::ElementsAre("AddressInfos 2", "CallstackSamples 1", "SchedulingSlices 3"));
+
+  listener.calls_.clear();
+  batching_listener.Flush();
+  EXPECT_TRUE(listener.calls_.empty());
+
+  batching_listener.OnFunctionCall(orbit_grpc_protos::FunctionCall{});
+  batching_listener.Flush();
+  EXPECT_THAT(listener.calls_, testing::ElementsAre("FunctionCalls 1"));
+}
+
+TEST(BatchingTracerListener, InterleavedEventsArePassedInOrder) {
+  RecordingBatchedTracerListener listener;
+  BatchingTracerListener batching_listener{&listener};
+
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(1));
+  batching_listener.OnThreadStateSlice(orbit_grpc_protos::ThreadStateSlice{});
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(2));
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(3));
+  batching_listener.OnAddressInfo(orbit_grpc_protos::FullAddressInfo{});
+  batching_listener.OnCallstackSample(orbit_grpc_protos::FullCallstackSample{});
+  batching_listener.OnAddressInfo(orbit_grpc_protos::FullAddressInfo{});
+  batching_listener.OnCallstackSample(orbit_grpc_protos::FullCallstackSample{});
+  batching_listener.Flush();
+  EXPECT_THAT(listener.calls_,
+              testing::ElementsAre("SchedulingSlices 1", "ThreadStateSlices 1",
+                                   "SchedulingSlices 2", "AddressInfos 1", "CallstackSamples 1",
+                                   "AddressInfos 1", "CallstackSamples 1"));
+}
+
+TEST(BatchingTracerListener, RareEventsArePassedImmediatelyAfterPendingEvents) {
+  RecordingBatchedTracerListener listener;
+  BatchingTracerListener batching_listener{&listener};
+
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(1));
+  batching_listener.OnThreadName(orbit_grpc_protos::ThreadName{});
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(2));
+  batching_listener.OnLostPerfRecordsEvent(orbit_grpc_protos::LostPerfRecordsEvent{});
+  EXPECT_THAT(listener.calls_, testing::ElementsAre("SchedulingSlices 1", "ThreadName",
+                                                    "SchedulingSlices 1", "LostPerfRecordsEvent"));
+}
+
+TEST(BatchingTracerListener, DefaultBatchedCallbacksCallSingleEventCallbacks) {
+  RecordingTracerListener listener;
+  BatchingTracerListener batching_listener{&listener};
+
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(1));
+  batching_listener.OnSchedulingSlice(MakeSchedulingSlice(2));
+  batching_listener.OnFunctionCall(orbit_grpc_protos::FunctionCall{});
+  batching_listener.Flush();
+  EXPECT_THAT(listener.calls_,
+              testing::ElementsAre("SchedulingSlice 1", "SchedulingSlice 2", "FunctionCall"));
+}
+
+}  // namespace orbit_linux_tracing
@@ -5,12 +5,12 @@
 #ifndef LINUX_TRACING_CONTEXT_SWITCH_MANAGER_H_
 #define LINUX_TRACING_CONTEXT_SWITCH_MANAGER_H_
 
-#include <absl/container/flat_hash_map.h>
 #include <stdint.h>
 #include <sys/types.h>
 
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 #include "capture.pb.h"
 
@@ -45,7 +45,8 @@ class ContextSwitchManager {
     uint64_t timestamp_ns;
   };
 
-  absl::flat_hash_map<uint16_t, OpenSwitchIn> open_switches_by_core_;
+  // Indexed by core, as there are few cores and this is accessed on every context switch.
+  std::vector<std::optional<OpenSwitchIn>> open_switches_by_core_;
 };
 
 }  // namespace orbit_linux_tracing
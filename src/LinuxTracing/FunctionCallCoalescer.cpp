@@ -0,0 +1,115 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "FunctionCallCoalescer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace orbit_linux_tracing {
+
+using orbit_grpc_protos::FunctionCall;
+
+namespace {
+
+void SortByEndTimestamp(std::vector<FunctionCall>* function_calls) {
+  std::sort(function_calls->begin(), function_calls->end(),
+            [](const FunctionCall& lhs, const FunctionCall& rhs) {
+              return lhs.end_timestamp_ns() < rhs.end_timestamp_ns();
+            });
+}
+
+void Coalesce(FunctionCall* coalesced_call, const FunctionCall& function_call) {
+  if (coalesced_call->num_coalesced_calls() == 0) {
+    // The first call loses its return value and registers, as they don't describe the whole group.
+    const uint64_t duration_ns = coalesced_call->duration_ns();
+    coalesced_call->set_num_coalesced_calls(1);
+    coalesced_call->set_coalesced_total_duration_ns(duration_ns);
+    coalesced_call->set_coalesced_min_duration_ns(duration_ns);
+    coalesced_call->set_coalesced_max_duration_ns(duration_ns);
+    coalesced_call->set_return_value(0);
+    coalesced_call->clear_registers();
+  }
+
+  const uint64_t begin_timestamp_ns =
+      coalesced_call->end_timestamp_ns() - coalesced_call->duration_ns();
+  const uint64_t duration_ns = function_call.duration_ns();
+  coalesced_call->set_duration_ns(function_call.end_timestamp_ns() - begin_timestamp_ns);
+  coalesced_call->set_end_timestamp_ns(function_call.end_timestamp_ns());
+  coalesced_call->set_num_coalesced_calls(coalesced_call->num_coalesced_calls() + 1);
+  coalesced_call->set_coalesced_total_duration_ns(coalesced_call->coalesced_total_duration_ns() +
+                                                  duration_ns);
+  coalesced_call->set_coalesced_min_duration_ns(
+      std::min(coalesced_call->coalesced_min_duration_ns(), duration_ns));
+  coalesced_call->set_coalesced_max_duration_ns(
+      std::max(coalesced_call->coalesced_max_duration_ns(), duration_ns));
+}
+
+}  // namespace
+
+std::vector<FunctionCall> FunctionCallCoalescer::ProcessFunctionCall(FunctionCall function_call) {
+  std::vector<FunctionCall> complete_function_calls;
+  const pid_t tid = function_call.tid();
+  std::map<int32_t, FunctionCall>& pending_function_calls = pending_function_calls_by_tid_[tid];
+  const int32_t depth = function_call.depth();
+
+  // The pending calls deeper than this one were called by it (or by one of its previous calls, if
+  // it's coalesced): they can't be followed by a call to merge with anymore.
+  for (auto it = pending_function_calls.upper_bound(depth); it != pending_function_calls.end();) {
+    complete_function_calls.emplace_back(std::move(it->second));
+    it = pending_function_calls.erase(it);
+  }
+
+  auto pending_it = pending_function_calls.find(depth);
+  const bool is_short = function_call.duration_ns() < threshold_ns_;
+  if (pending_it != pending_function_calls.end()) {
+    if (is_short && pending_it->second.function_id() == function_call.function_id() &&
+        IsWithinMaxGap(pending_it->second, function_call)) {
+      Coalesce(&pending_it->second, function_call);
+    } else {
+      complete_function_calls.emplace_back(std::move(pending_it->second));
+      if (is_short) {
+        pending_it->second = std::move(function_call);
+      } else {
+        pending_function_calls.erase(pending_it);
+        complete_function_calls.emplace_back(std::move(function_call));
+      }
+    }
+  } else if (is_short) {
+    pending_function_calls.emplace(depth, std::move(function_call));
+  } else {
+    complete_function_calls.emplace_back(std::move(function_call));
+  }
+
+  if (pending_function_calls.empty()) {
+    pending_function_calls_by_tid_.erase(tid);
+  }
+
+  SortByEndTimestamp(&complete_function_calls);
+  return complete_function_calls;
+}
+
+bool FunctionCallCoalescer::IsWithinMaxGap(const FunctionCall& pending_call,
+                                           const FunctionCall& next_call) const {
+  if (max_gap_ns_ == 0) return true;
+  const uint64_t next_call_begin_timestamp_ns =
+      next_call.end_timestamp_ns() - next_call.duration_ns();
+  // Calls at the same depth of a thread don't overlap, but don't rely on it for unsigned math.
+  if (next_call_begin_timestamp_ns <= pending_call.end_timestamp_ns()) return true;
+  return next_call_begin_timestamp_ns - pending_call.end_timestamp_ns() <= max_gap_ns_;
+}
+
+std::vector<FunctionCall> FunctionCallCoalescer::Flush() {
+  std::vector<FunctionCall> function_calls;
+  for (auto& [unused_tid, pending_function_calls] : pending_function_calls_by_tid_) {
+    for (auto& [unused_depth, function_call] : pending_function_calls) {
+      function_calls.emplace_back(std::move(function_call));
+    }
+  }
+  pending_function_calls_by_tid_.clear();
+  SortByEndTimestamp(&function_calls);
+  return function_calls;
+}
+
+}  // namespace orbit_linux_tracing
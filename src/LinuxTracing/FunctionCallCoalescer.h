@@ -0,0 +1,59 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_FUNCTION_CALL_COALESCER_H_
+#define LINUX_TRACING_FUNCTION_CALL_COALESCER_H_
+
+#include <absl/container/flat_hash_map.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+// Merges consecutive calls of the same function, at the same depth of the same thread, into a
+// single FunctionCall, as long as each of the calls is shorter than a threshold and starts at most
+// a maximum gap after the previous one ended. The merged
+// FunctionCall spans from the beginning of the first call to the end of the last one, and carries
+// the number of calls and their total, minimum and maximum duration. Calls at least as long as the
+// threshold, as well as short calls that are not followed closely by another call of the same
+// function, are passed on unchanged.
+//
+// This keeps functions called in tight loops from flooding the transport and the timeline, without
+// losing the calls that are actually expensive. The maximum gap keeps sparse calls apart, so that a
+// coalesced call doesn't hide the idle time between them.
+class FunctionCallCoalescer {
+ public:
+  // A `max_gap_ns` of 0 means that the gap between coalesced calls is not bounded.
+  explicit FunctionCallCoalescer(uint64_t threshold_ns, uint64_t max_gap_ns)
+      : threshold_ns_{threshold_ns}, max_gap_ns_{max_gap_ns} {}
+
+  // Returns the FunctionCalls, possibly coalesced, that are complete now that `function_call` has
+  // returned. They are sorted by end timestamp.
+  [[nodiscard]] std::vector<orbit_grpc_protos::FunctionCall> ProcessFunctionCall(
+      orbit_grpc_protos::FunctionCall function_call);
+
+  // Returns the FunctionCalls of all threads that are still waiting for a next call to be merged
+  // with, e.g., at the end of the capture.
+  [[nodiscard]] std::vector<orbit_grpc_protos::FunctionCall> Flush();
+
+ private:
+  // Whether `next_call` starts at most `max_gap_ns_` after `pending_call` ended.
+  [[nodiscard]] bool IsWithinMaxGap(const orbit_grpc_protos::FunctionCall& pending_call,
+                                    const orbit_grpc_protos::FunctionCall& next_call) const;
+
+  uint64_t threshold_ns_;
+  uint64_t max_gap_ns_;
+  // For each thread, the last short FunctionCall (possibly already coalesced) at each depth.
+  absl::flat_hash_map<pid_t, std::map<int32_t, orbit_grpc_protos::FunctionCall>>
+      pending_function_calls_by_tid_;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_FUNCTION_CALL_COALESCER_H_
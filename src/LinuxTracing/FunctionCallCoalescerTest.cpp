@@ -0,0 +1,181 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "FunctionCallCoalescer.h"
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+using orbit_grpc_protos::FunctionCall;
+
+namespace {
+
+constexpr pid_t kPid = 41;
+constexpr pid_t kTid = 42;
+constexpr uint64_t kThresholdNs = 100;
+constexpr uint64_t kMaxGapNs = 50;
+constexpr uint64_t kFunctionIdFoo = 1;
+constexpr uint64_t kFunctionIdBar = 2;
+
+FunctionCall MakeFunctionCall(pid_t tid, uint64_t function_id, uint64_t begin_timestamp_ns,
+                              uint64_t end_timestamp_ns, int32_t depth) {
+  FunctionCall function_call;
+  function_call.set_pid(kPid);
+  function_call.set_tid(tid);
+  function_call.set_function_id(function_id);
+  function_call.set_duration_ns(end_timestamp_ns - begin_timestamp_ns);
+  function_call.set_end_timestamp_ns(end_timestamp_ns);
+  function_call.set_depth(depth);
+  function_call.set_return_value(end_timestamp_ns);
+  function_call.add_registers(begin_timestamp_ns);
+  return function_call;
+}
+
+}  // namespace
+
+TEST(FunctionCallCoalescer, SingleShortCallIsUnchanged) {
+  FunctionCallCoalescer coalescer{kThresholdNs, kMaxGapNs};
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 10, 0))
+                  .empty());
+
+  std::vector<FunctionCall> flushed = coalescer.Flush();
+  ASSERT_EQ(flushed.size(), 1);
+  EXPECT_EQ(flushed[0].num_coalesced_calls(), 0);
+  EXPECT_EQ(flushed[0].duration_ns(), 10);
+  EXPECT_EQ(flushed[0].end_timestamp_ns(), 10);
+  EXPECT_EQ(flushed[0].return_value(), 10);
+  EXPECT_EQ(flushed[0].registers_size(), 1);
+
+  EXPECT_TRUE(coalescer.Flush().empty());
+}
+
+TEST(FunctionCallCoalescer, LongCallIsPassedOnImmediately) {
+  FunctionCallCoalescer coalescer{kThresholdNs, kMaxGapNs};
+  std::vector<FunctionCall> complete =
+      coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 100, 0));
+  ASSERT_EQ(complete.size(), 1);
+  EXPECT_EQ(complete[0].num_coalesced_calls(), 0);
+  EXPECT_EQ(complete[0].duration_ns(), 100);
+  EXPECT_TRUE(coalescer.Flush().empty());
+}
+
+TEST(FunctionCallCoalescer, ConsecutiveShortCallsAreCoalesced) {
+  FunctionCallCoalescer coalescer{kThresholdNs, kMaxGapNs};
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 10, 1))
+                  .empty());
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 20, 50, 1))
+                  .empty());
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 60, 80, 1))
+                  .empty());
+
+  // The caller returning completes the coalesced call.
+  std::vector<FunctionCall> complete =
+      coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdBar, 0, 200, 0));
+  ASSERT_EQ(complete.size(), 2);
+
+  const FunctionCall& coalesced = complete[0];
+  EXPECT_EQ(coalesced.pid(), kPid);
+  EXPECT_EQ(coalesced.tid(), kTid);
+  EXPECT_EQ(coalesced.function_id(), kFunctionIdFoo);
+  EXPECT_EQ(coalesced.depth(), 1);
+  EXPECT_EQ(coalesced.duration_ns(), 80);
+  EXPECT_EQ(coalesced.end_timestamp_ns(), 80);
+  EXPECT_EQ(coalesced.num_coalesced_calls(), 3);
+  EXPECT_EQ(coalesced.coalesced_total_duration_ns(), 60);
+  EXPECT_EQ(coalesced.coalesced_min_duration_ns(), 10);
+  EXPECT_EQ(coalesced.coalesced_max_duration_ns(), 30);
+  EXPECT_EQ(coalesced.return_value(), 0);
+  EXPECT_EQ(coalesced.registers_size(), 0);
+
+  EXPECT_EQ(complete[1].function_id(), kFunctionIdBar);
+  EXPECT_EQ(complete[1].num_coalesced_calls(), 0);
+  EXPECT_TRUE(coalescer.Flush().empty());
+}
+
+TEST(FunctionCallCoalescer, DifferentFunctionOrLongCallBreaksTheSequence) {
+  FunctionCallCoalescer coalescer{kThresholdNs, kMaxGapNs};
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 10, 0))
+                  .empty());
+
+  std::vector<FunctionCall> complete =
+      coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdBar, 20, 30, 0));
+  ASSERT_EQ(complete.size(), 1);
+  EXPECT_EQ(complete[0].function_id(), kFunctionIdFoo);
+  EXPECT_EQ(complete[0].num_coalesced_calls(), 0);
+
+  complete = coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdBar, 40, 500, 0));
+  ASSERT_EQ(complete.size(), 2);
+  EXPECT_EQ(complete[0].end_timestamp_ns(), 30);
+  EXPECT_EQ(complete[1].end_timestamp_ns(), 500);
+  EXPECT_EQ(complete[1].num_coalesced_calls(), 0);
+
+  EXPECT_TRUE(coalescer.Flush().empty());
+}
+
+TEST(FunctionCallCoalescer, ThreadsAreIndependent) {
+  FunctionCallCoalescer coalescer{kThresholdNs, kMaxGapNs};
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 10, 0))
+                  .empty());
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid + 1, kFunctionIdBar, 5, 15, 0))
+                  .empty());
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 20, 30, 0))
+                  .empty());
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid + 1, kFunctionIdBar, 25, 45, 0))
+                  .empty());
+
+  std::vector<FunctionCall> flushed = coalescer.Flush();
+  ASSERT_EQ(flushed.size(), 2);
+  EXPECT_EQ(flushed[0].tid(), kTid);
+  EXPECT_EQ(flushed[0].num_coalesced_calls(), 2);
+  EXPECT_EQ(flushed[0].duration_ns(), 30);
+  EXPECT_EQ(flushed[1].tid(), kTid + 1);
+  EXPECT_EQ(flushed[1].num_coalesced_calls(), 2);
+  EXPECT_EQ(flushed[1].duration_ns(), 40);
+}
+
+TEST(FunctionCallCoalescer, SparseCallsAreNotCoalesced) {
+  FunctionCallCoalescer coalescer{kThresholdNs, kMaxGapNs};
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 10, 0))
+                  .empty());
+  // Starts exactly the maximum gap after the previous call ended.
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 60, 70, 0))
+                  .empty());
+
+  // A call starting further away completes the pending one, whose span stops at its last call.
+  std::vector<FunctionCall> complete =
+      coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 10'000, 10'010, 0));
+  ASSERT_EQ(complete.size(), 1);
+  EXPECT_EQ(complete[0].num_coalesced_calls(), 2);
+  EXPECT_EQ(complete[0].duration_ns(), 70);
+  EXPECT_EQ(complete[0].end_timestamp_ns(), 70);
+
+  std::vector<FunctionCall> flushed = coalescer.Flush();
+  ASSERT_EQ(flushed.size(), 1);
+  EXPECT_EQ(flushed[0].num_coalesced_calls(), 0);
+  EXPECT_EQ(flushed[0].duration_ns(), 10);
+  EXPECT_EQ(flushed[0].end_timestamp_ns(), 10'010);
+  EXPECT_EQ(flushed[0].return_value(), 10'010);
+}
+
+TEST(FunctionCallCoalescer, GapIsNotBoundedWithoutMaxGap) {
+  FunctionCallCoalescer coalescer{kThresholdNs, /*max_gap_ns=*/0};
+  EXPECT_TRUE(coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 0, 10, 0))
+                  .empty());
+  EXPECT_TRUE(
+      coalescer.ProcessFunctionCall(MakeFunctionCall(kTid, kFunctionIdFoo, 10'000, 10'010, 0))
+          .empty());
+
+  std::vector<FunctionCall> flushed = coalescer.Flush();
+  ASSERT_EQ(flushed.size(), 1);
+  EXPECT_EQ(flushed[0].num_coalesced_calls(), 2);
+  EXPECT_EQ(flushed[0].duration_ns(), 10'010);
+}
+
+}  // namespace orbit_linux_tracing
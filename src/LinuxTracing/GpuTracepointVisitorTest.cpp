@@ -44,6 +44,8 @@ class MockTracerListener : public TracerListener {
   MOCK_METHOD(void, OnLostPerfRecordsEvent, (orbit_grpc_protos::LostPerfRecordsEvent), (override));
   MOCK_METHOD(void, OnOutOfOrderEventsDiscardedEvent,
               (orbit_grpc_protos::OutOfOrderEventsDiscardedEvent), (override));
+  MOCK_METHOD(void, OnUnwindingErrorsSummaryEvent,
+              (orbit_grpc_protos::UnwindingErrorsSummaryEvent), (override));
 };
 
 class GpuTracepointVisitorTest : public ::testing::Test {
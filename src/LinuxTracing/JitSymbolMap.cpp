@@ -0,0 +1,75 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "JitSymbolMap.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace orbit_linux_tracing {
+
+void JitSymbolMap::AddSymbol(uint64_t start, uint64_t size, std::string name,
+                             uint64_t timestamp_ns) {
+  if (size == 0) return;
+  const uint64_t end = start + size;
+
+  auto it = loaded_symbols_by_start_.upper_bound(start);
+  if (it != loaded_symbols_by_start_.begin() && std::prev(it)->second.end > start) {
+    --it;
+  }
+  if (it != loaded_symbols_by_start_.end() && it->first == start && it->second.end == end &&
+      it->second.name == name) {
+    return;
+  }
+
+  // The code region of the symbols this overlaps was reused: move them to the unloaded symbols.
+  while (it != loaded_symbols_by_start_.end() && it->first < end) {
+    JitSymbol& unloaded_symbol = it->second;
+    unloaded_symbol.unload_timestamp_ns = std::max(timestamp_ns, unloaded_symbol.load_timestamp_ns);
+    max_unloaded_symbol_size_ =
+        std::max(max_unloaded_symbol_size_, unloaded_symbol.end - unloaded_symbol.start);
+    const uint64_t unload_timestamp_ns = unloaded_symbol.unload_timestamp_ns;
+    auto unloaded_it = unloaded_symbols_by_start_.emplace(it->first, std::move(unloaded_symbol));
+    unloaded_symbols_by_unload_timestamp_.emplace(unload_timestamp_ns, unloaded_it);
+    it = loaded_symbols_by_start_.erase(it);
+  }
+
+  loaded_symbols_by_start_.emplace_hint(it, start,
+                                        JitSymbol{start, end, std::move(name), timestamp_ns});
+}
+
+const JitSymbol* JitSymbolMap::FindSymbol(uint64_t address, uint64_t timestamp_ns) const {
+  auto loaded_it = loaded_symbols_by_start_.upper_bound(address);
+  if (loaded_it != loaded_symbols_by_start_.begin()) {
+    const JitSymbol& symbol = std::prev(loaded_it)->second;
+    if (address < symbol.end && symbol.load_timestamp_ns <= timestamp_ns) return &symbol;
+  }
+
+  // The symbol at this address at that time, if any, was replaced since.
+  for (auto it = unloaded_symbols_by_start_.upper_bound(address);
+       it != unloaded_symbols_by_start_.begin();) {
+    --it;
+    const JitSymbol& symbol = it->second;
+    if (address - symbol.start >= max_unloaded_symbol_size_) break;
+    if (address < symbol.end && symbol.load_timestamp_ns <= timestamp_ns &&
+        timestamp_ns < symbol.unload_timestamp_ns) {
+      return &symbol;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<JitSymbol> JitSymbolMap::RemoveSymbolsUnloadedBefore(uint64_t timestamp_ns) {
+  std::vector<JitSymbol> removed_symbols;
+  auto end = unloaded_symbols_by_unload_timestamp_.lower_bound(timestamp_ns);
+  for (auto it = unloaded_symbols_by_unload_timestamp_.begin(); it != end; ++it) {
+    removed_symbols.push_back(std::move(unloaded_symbols_by_start_.extract(it->second).mapped()));
+  }
+  unloaded_symbols_by_unload_timestamp_.erase(unloaded_symbols_by_unload_timestamp_.begin(), end);
+  if (unloaded_symbols_by_start_.empty()) max_unloaded_symbol_size_ = 0;
+  return removed_symbols;
+}
+
+}  // namespace orbit_linux_tracing
@@ -0,0 +1,67 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_JIT_SYMBOL_MAP_H_
+#define LINUX_TRACING_JIT_SYMBOL_MAP_H_
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace orbit_linux_tracing {
+
+// A function generated by a JIT compiler, and the time range in which its code was at
+// [start, end). After unload_timestamp_ns, the code region was reused for other code.
+struct JitSymbol {
+  uint64_t start;
+  uint64_t end;
+  std::string name;
+  uint64_t load_timestamp_ns;
+  uint64_t unload_timestamp_ns = std::numeric_limits<uint64_t>::max();
+};
+
+// Keeps the JitSymbols of a process as an interval map, so that the addresses in the callstacks
+// that don't belong to any module can be resolved to the JIT-generated function they are in.
+// As JIT compilers reuse the memory of code they discard, an address can belong to different
+// functions over time. The symbols that were replaced are kept, so that addresses can be resolved
+// at the time of the event they come from, until RemoveSymbolsUnloadedBefore discards them.
+// Symbols are expected to be added in order of load timestamp.
+class JitSymbolMap {
+ public:
+  // Adds a symbol for the code at [start, start + size) loaded at `timestamp_ns`. The symbols it
+  // overlaps are considered unloaded at that time. Adding again the symbol currently loaded at the
+  // same range has no effect.
+  void AddSymbol(uint64_t start, uint64_t size, std::string name, uint64_t timestamp_ns);
+
+  // Returns the symbol that `address` belonged to at `timestamp_ns`, or nullptr if none.
+  [[nodiscard]] const JitSymbol* FindSymbol(uint64_t address, uint64_t timestamp_ns) const;
+
+  // Discards the symbols unloaded before `timestamp_ns`, as they are no longer needed once all
+  // events older than that have been processed, and returns them.
+  std::vector<JitSymbol> RemoveSymbolsUnloadedBefore(uint64_t timestamp_ns);
+
+  [[nodiscard]] bool empty() const {
+    return loaded_symbols_by_start_.empty() && unloaded_symbols_by_start_.empty();
+  }
+  [[nodiscard]] size_t GetNumLoadedSymbols() const { return loaded_symbols_by_start_.size(); }
+  [[nodiscard]] size_t GetNumUnloadedSymbols() const { return unloaded_symbols_by_start_.size(); }
+
+ private:
+  // These never overlap.
+  std::map<uint64_t, JitSymbol> loaded_symbols_by_start_;
+  // These can overlap each other, but then their time ranges don't.
+  std::multimap<uint64_t, JitSymbol> unloaded_symbols_by_start_;
+  // The entries of unloaded_symbols_by_start_ by unload timestamp, so that
+  // RemoveSymbolsUnloadedBefore only goes through the symbols it removes.
+  std::multimap<uint64_t, std::multimap<uint64_t, JitSymbol>::iterator>
+      unloaded_symbols_by_unload_timestamp_;
+  // Bounds how far back from an address to look for unloaded symbols that might contain it.
+  uint64_t max_unloaded_symbol_size_ = 0;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_JIT_SYMBOL_MAP_H_
@@ -0,0 +1,97 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "JitSymbolMap.h"
+
+namespace orbit_linux_tracing {
+
+namespace {
+std::optional<std::string> FindName(const JitSymbolMap& map, uint64_t address,
+                                    uint64_t timestamp_ns) {
+  const JitSymbol* symbol = map.FindSymbol(address, timestamp_ns);
+  if (symbol == nullptr) return std::nullopt;
+  return symbol->name;
+}
+}  // namespace
+
+TEST(JitSymbolMap, FindSymbol) {
+  JitSymbolMap map;
+  EXPECT_TRUE(map.empty());
+  map.AddSymbol(0x1000, 0x100, "first", 10);
+  map.AddSymbol(0x1200, 0x100, "second", 20);
+  EXPECT_FALSE(map.empty());
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 2);
+
+  EXPECT_EQ(FindName(map, 0x1000, 10), "first");
+  EXPECT_EQ(FindName(map, 0x10FF, 100), "first");
+  EXPECT_EQ(FindName(map, 0x1250, 20), "second");
+  EXPECT_EQ(FindName(map, 0x0FFF, 100), std::nullopt);
+  EXPECT_EQ(FindName(map, 0x1100, 100), std::nullopt);
+  EXPECT_EQ(FindName(map, 0x1300, 100), std::nullopt);
+  // Before the code was loaded.
+  EXPECT_EQ(FindName(map, 0x1250, 19), std::nullopt);
+}
+
+TEST(JitSymbolMap, ReusedCodeRegionIsResolvedByTimestamp) {
+  JitSymbolMap map;
+  map.AddSymbol(0x1000, 0x100, "old_a", 10);
+  map.AddSymbol(0x1100, 0x100, "old_b", 10);
+  map.AddSymbol(0x2000, 0x100, "untouched", 10);
+  // Overlaps both old_a and old_b.
+  map.AddSymbol(0x1080, 0x100, "new", 50);
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 2);
+  EXPECT_EQ(map.GetNumUnloadedSymbols(), 2);
+
+  EXPECT_EQ(FindName(map, 0x1000, 40), "old_a");
+  EXPECT_EQ(FindName(map, 0x1090, 49), "old_a");
+  EXPECT_EQ(FindName(map, 0x1150, 49), "old_b");
+  EXPECT_EQ(FindName(map, 0x1090, 50), "new");
+  EXPECT_EQ(FindName(map, 0x1150, 60), "new");
+  EXPECT_EQ(FindName(map, 0x1190, 60), std::nullopt);
+  EXPECT_EQ(FindName(map, 0x1000, 60), std::nullopt);
+  EXPECT_EQ(FindName(map, 0x2000, 60), "untouched");
+
+  // The region is reused once more.
+  map.AddSymbol(0x1000, 0x200, "newest", 70);
+  EXPECT_EQ(FindName(map, 0x1090, 45), "old_a");
+  EXPECT_EQ(FindName(map, 0x1090, 65), "new");
+  EXPECT_EQ(FindName(map, 0x1090, 75), "newest");
+
+  EXPECT_EQ(map.GetNumUnloadedSymbols(), 3);
+
+  EXPECT_TRUE(map.RemoveSymbolsUnloadedBefore(50).empty());
+  EXPECT_EQ(map.GetNumUnloadedSymbols(), 3);
+  std::vector<JitSymbol> removed_symbols = map.RemoveSymbolsUnloadedBefore(60);
+  ASSERT_EQ(removed_symbols.size(), 2);
+  EXPECT_EQ(removed_symbols[0].unload_timestamp_ns, 50);
+  EXPECT_EQ(removed_symbols[1].unload_timestamp_ns, 50);
+  EXPECT_EQ(map.GetNumUnloadedSymbols(), 1);
+  EXPECT_EQ(FindName(map, 0x1090, 65), "new");
+  removed_symbols = map.RemoveSymbolsUnloadedBefore(80);
+  ASSERT_EQ(removed_symbols.size(), 1);
+  EXPECT_EQ(removed_symbols[0].name, "new");
+  EXPECT_EQ(map.GetNumUnloadedSymbols(), 0);
+  EXPECT_EQ(FindName(map, 0x1090, 75), "newest");
+}
+
+TEST(JitSymbolMap, AddingTheSameSymbolAgainHasNoEffect) {
+  JitSymbolMap map;
+  map.AddSymbol(0x1000, 0x100, "function", 10);
+  map.AddSymbol(0x1000, 0x100, "function", 20);
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 1);
+  EXPECT_EQ(map.GetNumUnloadedSymbols(), 0);
+  EXPECT_EQ(FindName(map, 0x1000, 15), "function");
+
+  map.AddSymbol(0x1000, 0x0, "empty", 30);
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 1);
+}
+
+}  // namespace orbit_linux_tracing
@@ -0,0 +1,244 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "JitSymbolsReader.h"
+
+#include <absl/strings/str_format.h>
+#include <absl/strings/str_split.h>
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "OrbitBase/Logging.h"
+
+namespace orbit_linux_tracing {
+
+namespace {
+
+// Retrying to open a file that doesn't exist only once per second keeps the cost negligible for
+// the many processes that never write these files.
+constexpr uint64_t kOpenRetryIntervalNs = 1'000'000'000;
+
+// See tools/perf/util/jitdump.h in the Linux kernel sources for the specification of the format.
+constexpr uint32_t kJitdumpMagic = 0x4A695444;
+constexpr uint64_t kJitdumpFlagArchTimestamp = 1;
+constexpr uint32_t kJitCodeLoad = 0;
+constexpr uint32_t kJitCodeMove = 1;
+
+struct __attribute__((__packed__)) jitdump_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  uint32_t elf_mach;
+  uint32_t pad1;
+  uint32_t pid;
+  uint64_t timestamp;
+  uint64_t flags;
+};
+
+struct __attribute__((__packed__)) jitdump_record_prefix {
+  uint32_t id;
+  uint32_t total_size;
+  uint64_t timestamp;
+};
+
+struct __attribute__((__packed__)) jitdump_code_load {
+  jitdump_record_prefix prefix;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+  // OMITTED: char name[] (null-terminated)
+  // OMITTED: uint8_t code[code_size]
+};
+
+struct __attribute__((__packed__)) jitdump_code_move {
+  jitdump_record_prefix prefix;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t old_code_addr;
+  uint64_t new_code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+};
+
+template <typename T>
+[[nodiscard]] T ReadAt(std::string_view data, size_t offset) {
+  CHECK(offset + sizeof(T) <= data.size());
+  T result;
+  std::memcpy(&result, data.data() + offset, sizeof(T));
+  return result;
+}
+
+[[nodiscard]] std::optional<uint64_t> ParseHex(std::string_view hex) {
+  if (hex.size() > 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) hex.remove_prefix(2);
+  uint64_t value = 0;
+  auto [end, error] = std::from_chars(hex.data(), hex.data() + hex.size(), value, 16);
+  if (error != std::errc{} || end != hex.data() + hex.size()) return std::nullopt;
+  return value;
+}
+
+}  // namespace
+
+std::optional<PerfMapEntry> ParsePerfMapLine(std::string_view line) {
+  if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+  size_t first_space = line.find(' ');
+  if (first_space == std::string_view::npos) return std::nullopt;
+  size_t second_space = line.find(' ', first_space + 1);
+  if (second_space == std::string_view::npos) return std::nullopt;
+
+  std::optional<uint64_t> start = ParseHex(line.substr(0, first_space));
+  std::optional<uint64_t> size =
+      ParseHex(line.substr(first_space + 1, second_space - first_space - 1));
+  if (!start.has_value() || !size.has_value()) return std::nullopt;
+  // The name can contain spaces.
+  return PerfMapEntry{start.value(), size.value(), std::string{line.substr(second_space + 1)}};
+}
+
+bool IsJitdumpFile(const std::string& file_path, pid_t pid) {
+  return std::filesystem::path{file_path}.filename() == absl::StrFormat("jit-%d.dump", pid);
+}
+
+std::filesystem::path JitSymbolsReader::GetPerfMapPath(pid_t pid) {
+  return absl::StrFormat("/tmp/perf-%d.map", pid);
+}
+
+void JitSymbolsReader::Visit(MmapPerfEvent* event) {
+  if (event->pid() != pid_ || jitdump_file_.has_value() ||
+      !IsJitdumpFile(event->filename(), pid_)) {
+    return;
+  }
+  jitdump_file_.emplace();
+  jitdump_file_->path = event->filename();
+}
+
+void JitSymbolsReader::FindJitdumpFileInMaps(std::string_view proc_maps_data) {
+  if (jitdump_file_.has_value()) return;
+  const std::vector<std::string> proc_maps = absl::StrSplit(proc_maps_data, '\n');
+  for (const std::string& line : proc_maps) {
+    std::vector<std::string> tokens = absl::StrSplit(line, ' ', absl::SkipEmpty());
+    if (tokens.size() != 6 || !IsJitdumpFile(tokens[5], pid_)) continue;
+    jitdump_file_.emplace();
+    jitdump_file_->path = tokens[5];
+    return;
+  }
+}
+
+void JitSymbolsReader::ReadAppendedData(AppendedFile* file, uint64_t timestamp_ns) {
+  if (!file->fd.valid()) {
+    if (timestamp_ns < file->next_open_attempt_timestamp_ns) return;
+    file->next_open_attempt_timestamp_ns = timestamp_ns + kOpenRetryIntervalNs;
+    ErrorMessageOr<orbit_base::unique_fd> fd_or_error = orbit_base::OpenFileForReading(file->path);
+    if (fd_or_error.has_error()) return;
+    file->fd = std::move(fd_or_error.value());
+  }
+
+  constexpr size_t kChunkSize = 64 * 1024;
+  std::array<char, kChunkSize> chunk;
+  while (true) {
+    ErrorMessageOr<size_t> bytes_read_or_error =
+        orbit_base::ReadFully(file->fd, chunk.data(), chunk.size());
+    if (bytes_read_or_error.has_error()) {
+      ERROR("Reading \"%s\": %s", file->path.string(), bytes_read_or_error.error().message());
+      return;
+    }
+    file->unprocessed_data.append(chunk.data(), bytes_read_or_error.value());
+    if (bytes_read_or_error.value() < chunk.size()) return;
+  }
+}
+
+void JitSymbolsReader::ReadNewSymbols(uint64_t timestamp_ns) {
+  // What is read now was written after the previous call read to the end of the files.
+  const uint64_t load_timestamp_ns = last_read_timestamp_ns_;
+  last_read_timestamp_ns_ = timestamp_ns;
+
+  ReadAppendedData(&perf_map_file_, timestamp_ns);
+  ProcessPerfMapData(load_timestamp_ns);
+
+  if (jitdump_file_.has_value() && !jitdump_is_invalid_) {
+    ReadAppendedData(&jitdump_file_.value(), timestamp_ns);
+    ProcessJitdumpData(load_timestamp_ns);
+  }
+}
+
+void JitSymbolsReader::ProcessPerfMapData(uint64_t load_timestamp_ns) {
+  std::string& data = perf_map_file_.unprocessed_data;
+  size_t line_begin = 0;
+  for (size_t line_end = data.find('\n'); line_end != std::string::npos;
+       line_end = data.find('\n', line_begin)) {
+    std::string_view line{data.data() + line_begin, line_end - line_begin};
+    std::optional<PerfMapEntry> entry = ParsePerfMapLine(line);
+    if (entry.has_value()) {
+      jit_symbol_map_->AddSymbol(entry->start, entry->size, std::move(entry->name),
+                                 load_timestamp_ns);
+    } else if (!line.empty()) {
+      ERROR("Invalid line in \"%s\": %s", perf_map_file_.path.string(), line);
+    }
+    line_begin = line_end + 1;
+  }
+  data.erase(0, line_begin);
+}
+
+void JitSymbolsReader::ProcessJitdumpData(uint64_t load_timestamp_ns) {
+  const std::string& path = jitdump_file_->path.string();
+  std::string& data = jitdump_file_->unprocessed_data;
+  size_t offset = 0;
+
+  if (!jitdump_header_processed_) {
+    if (data.size() < sizeof(jitdump_header)) return;
+    auto header = ReadAt<jitdump_header>(data, 0);
+    if (header.magic != kJitdumpMagic || header.total_size < sizeof(jitdump_header)) {
+      // This includes jitdump files written by a process with the other endianness.
+      ERROR("\"%s\" is not a valid jitdump file", path);
+      jitdump_is_invalid_ = true;
+      data.clear();
+      return;
+    }
+    if (data.size() < header.total_size) return;
+    jitdump_has_arch_timestamps_ = (header.flags & kJitdumpFlagArchTimestamp) != 0;
+    jitdump_header_processed_ = true;
+    offset = header.total_size;
+  }
+
+  while (data.size() - offset >= sizeof(jitdump_record_prefix)) {
+    auto prefix = ReadAt<jitdump_record_prefix>(data, offset);
+    if (prefix.total_size < sizeof(jitdump_record_prefix)) {
+      ERROR("Invalid record in jitdump file \"%s\"", path);
+      jitdump_is_invalid_ = true;
+      data.clear();
+      return;
+    }
+    if (data.size() - offset < prefix.total_size) break;
+    std::string_view record{data.data() + offset, prefix.total_size};
+    offset += prefix.total_size;
+
+    const uint64_t timestamp_ns =
+        jitdump_has_arch_timestamps_ ? load_timestamp_ns : prefix.timestamp;
+    if (prefix.id == kJitCodeLoad && record.size() > sizeof(jitdump_code_load)) {
+      auto code_load = ReadAt<jitdump_code_load>(record, 0);
+      std::string_view name_and_code = record.substr(sizeof(jitdump_code_load));
+      std::string_view name = name_and_code.substr(0, name_and_code.find('\0'));
+      jit_symbol_map_->AddSymbol(code_load.code_addr, code_load.code_size, std::string{name},
+                                 timestamp_ns);
+    } else if (prefix.id == kJitCodeMove && record.size() >= sizeof(jitdump_code_move)) {
+      auto code_move = ReadAt<jitdump_code_move>(record, 0);
+      const JitSymbol* moved_symbol =
+          jit_symbol_map_->FindSymbol(code_move.old_code_addr, timestamp_ns);
+      if (moved_symbol != nullptr) {
+        jit_symbol_map_->AddSymbol(code_move.new_code_addr, code_move.code_size,
+                                   moved_symbol->name, timestamp_ns);
+      }
+    }
+    // Other records (debug info, unwinding info, close) are not needed to resolve symbols.
+  }
+  data.erase(0, offset);
+}
+
+}  // namespace orbit_linux_tracing
@@ -0,0 +1,95 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_JIT_SYMBOLS_READER_H_
+#define LINUX_TRACING_JIT_SYMBOLS_READER_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "JitSymbolMap.h"
+#include "OrbitBase/File.h"
+#include "PerfEvent.h"
+#include "PerfEventVisitor.h"
+
+namespace orbit_linux_tracing {
+
+struct PerfMapEntry {
+  uint64_t start;
+  uint64_t size;
+  std::string name;
+};
+
+// Parses a line of a perf map file: "START SIZE NAME", with START and SIZE in hexadecimal.
+[[nodiscard]] std::optional<PerfMapEntry> ParsePerfMapLine(std::string_view line);
+
+// JIT compilers write a jitdump file called jit-<pid>.dump, in any directory, and map it as
+// executable so that it appears in the PERF_RECORD_MMAPs.
+[[nodiscard]] bool IsJitdumpFile(const std::string& file_path, pid_t pid);
+
+// Reads the symbols that JIT compilers (e.g., LuaJIT, V8, or the JVM through perf-map-agent) write
+// for the code they generate into a JitSymbolMap. Both the perf map format (/tmp/perf-<pid>.map)
+// and the jitdump format are supported. As JIT compilers append to these files while they run,
+// ReadNewSymbols only reads what was appended since the previous call.
+// Perf map entries have no timestamp: as they were written after the previous call, they are
+// considered loaded at the time of the previous call. Jitdump records have their own timestamp.
+// This is also a PerfEventVisitor, to find the jitdump file from the PERF_RECORD_MMAP that the JIT
+// compiler generates for it.
+class JitSymbolsReader : public PerfEventVisitor {
+ public:
+  explicit JitSymbolsReader(pid_t pid, std::filesystem::path perf_map_path,
+                            JitSymbolMap* jit_symbol_map)
+      : pid_{pid}, jit_symbol_map_{jit_symbol_map} {
+    CHECK(jit_symbol_map_ != nullptr);
+    perf_map_file_.path = std::move(perf_map_path);
+  }
+
+  [[nodiscard]] static std::filesystem::path GetPerfMapPath(pid_t pid);
+
+  // Finds the jitdump file if it was already mapped before the capture started, in which case no
+  // PERF_RECORD_MMAP is received for it.
+  void FindJitdumpFileInMaps(std::string_view proc_maps_data);
+
+  void Visit(MmapPerfEvent* event) override;
+
+  // `timestamp_ns` is the current time. Events older than that can only be resolved with symbols
+  // that were read by this call.
+  void ReadNewSymbols(uint64_t timestamp_ns);
+
+ private:
+  struct AppendedFile {
+    std::filesystem::path path;
+    orbit_base::unique_fd fd;
+    uint64_t next_open_attempt_timestamp_ns = 0;
+    // Data read from the file but not processed yet, as it's only part of a line or record.
+    std::string unprocessed_data;
+  };
+  // Appends the new content of `file` to `file->unprocessed_data`. The file is opened on the first
+  // call, and is retried periodically if it doesn't exist yet.
+  static void ReadAppendedData(AppendedFile* file, uint64_t timestamp_ns);
+
+  void ProcessPerfMapData(uint64_t load_timestamp_ns);
+  void ProcessJitdumpData(uint64_t load_timestamp_ns);
+
+  pid_t pid_;
+  JitSymbolMap* jit_symbol_map_;
+  uint64_t last_read_timestamp_ns_ = 0;
+
+  AppendedFile perf_map_file_;
+
+  std::optional<AppendedFile> jitdump_file_;
+  bool jitdump_header_processed_ = false;
+  bool jitdump_is_invalid_ = false;
+  // Timestamps in the jitdump records are in the CLOCK_MONOTONIC domain unless this is set.
+  bool jitdump_has_arch_timestamps_ = false;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_JIT_SYMBOLS_READER_H_
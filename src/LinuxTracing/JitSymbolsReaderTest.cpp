@@ -0,0 +1,269 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <absl/strings/str_format.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "JitSymbolMap.h"
+#include "JitSymbolsReader.h"
+#include "OrbitBase/File.h"
+#include "OrbitBase/TemporaryFile.h"
+#include "PerfEvent.h"
+#include "PerfEventRecords.h"
+
+namespace orbit_linux_tracing {
+
+namespace {
+
+std::optional<std::string> FindName(const JitSymbolMap& map, uint64_t address,
+                                    uint64_t timestamp_ns) {
+  const JitSymbol* symbol = map.FindSymbol(address, timestamp_ns);
+  if (symbol == nullptr) return std::nullopt;
+  return symbol->name;
+}
+
+template <typename T>
+void AppendBytes(std::string* data, const T& value) {
+  data->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::string CreateJitdumpHeader(uint64_t flags) {
+  std::string data;
+  AppendBytes<uint32_t>(&data, 0x4A695444);  // magic
+  AppendBytes<uint32_t>(&data, 1);           // version
+  AppendBytes<uint32_t>(&data, 40);          // total_size
+  AppendBytes<uint32_t>(&data, 62);          // elf_mach
+  AppendBytes<uint32_t>(&data, 0);           // pad1
+  AppendBytes<uint32_t>(&data, getpid());    // pid
+  AppendBytes<uint64_t>(&data, 0);           // timestamp
+  AppendBytes<uint64_t>(&data, flags);       // flags
+  return data;
+}
+
+std::string CreateJitdumpCodeLoad(uint64_t timestamp_ns, uint64_t code_addr, uint64_t code_size,
+                                  const std::string& name) {
+  std::string data;
+  const uint32_t total_size = 16 + 40 + name.size() + 1 + code_size;
+  AppendBytes<uint32_t>(&data, 0);  // JIT_CODE_LOAD
+  AppendBytes<uint32_t>(&data, total_size);
+  AppendBytes<uint64_t>(&data, timestamp_ns);
+  AppendBytes<uint32_t>(&data, getpid());
+  AppendBytes<uint32_t>(&data, getpid());
+  AppendBytes<uint64_t>(&data, code_addr);  // vma
+  AppendBytes<uint64_t>(&data, code_addr);
+  AppendBytes<uint64_t>(&data, code_size);
+  AppendBytes<uint64_t>(&data, 0);  // code_index
+  data.append(name);
+  data.push_back('\0');
+  data.append(code_size, '\xCC');
+  return data;
+}
+
+std::string CreateJitdumpCodeMove(uint64_t timestamp_ns, uint64_t old_code_addr,
+                                  uint64_t new_code_addr, uint64_t code_size) {
+  std::string data;
+  AppendBytes<uint32_t>(&data, 1);  // JIT_CODE_MOVE
+  AppendBytes<uint32_t>(&data, 16 + 48);
+  AppendBytes<uint64_t>(&data, timestamp_ns);
+  AppendBytes<uint32_t>(&data, getpid());
+  AppendBytes<uint32_t>(&data, getpid());
+  AppendBytes<uint64_t>(&data, new_code_addr);  // vma
+  AppendBytes<uint64_t>(&data, old_code_addr);
+  AppendBytes<uint64_t>(&data, new_code_addr);
+  AppendBytes<uint64_t>(&data, code_size);
+  AppendBytes<uint64_t>(&data, 0);  // code_index
+  return data;
+}
+
+// The jitdump file of a process is recognized by its name, so unlike an orbit_base::TemporaryFile
+// it can't have a random one. Instead it is created in a new temporary directory, which is removed
+// with it when this goes out of scope, also when an assertion fails.
+class TemporaryJitdumpFile {
+ public:
+  TemporaryJitdumpFile() {
+    std::string directory = (std::filesystem::temp_directory_path() / "orbit_XXXXXX").string();
+    if (mkdtemp(directory.data()) == nullptr) return;
+    directory_ = directory;
+    file_path_ = directory_ / absl::StrFormat("jit-%d.dump", getpid());
+    auto fd_or_error = orbit_base::OpenFileForWriting(file_path_);
+    if (fd_or_error.has_value()) fd_ = std::move(fd_or_error.value());
+  }
+  TemporaryJitdumpFile(const TemporaryJitdumpFile&) = delete;
+  TemporaryJitdumpFile& operator=(const TemporaryJitdumpFile&) = delete;
+  ~TemporaryJitdumpFile() {
+    fd_.release();
+    if (directory_.empty()) return;
+    std::error_code error;
+    std::filesystem::remove_all(directory_, error);
+  }
+
+  [[nodiscard]] bool IsValid() const { return fd_.valid(); }
+  [[nodiscard]] const orbit_base::unique_fd& fd() const { return fd_; }
+  [[nodiscard]] const std::filesystem::path& file_path() const { return file_path_; }
+
+ private:
+  std::filesystem::path directory_;
+  std::filesystem::path file_path_;
+  orbit_base::unique_fd fd_;
+};
+
+void VisitMmap(JitSymbolsReader* reader, const std::string& filename) {
+  perf_event_mmap_up_to_pgoff mmap_event{};
+  mmap_event.pid = getpid();
+  mmap_event.tid = getpid();
+  mmap_event.address = 0x1000;
+  mmap_event.length = 0x1000;
+  MmapPerfEvent event{getpid(), 0, mmap_event, filename};
+  reader->Visit(&event);
+}
+
+}  // namespace
+
+TEST(ParsePerfMapLine, ValidLines) {
+  std::optional<PerfMapEntry> entry =
+      ParsePerfMapLine("7f3a1c0000 1a0 LuaJIT trace #12 main.lua:8");
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->start, 0x7f3a1c0000);
+  EXPECT_EQ(entry->size, 0x1a0);
+  EXPECT_EQ(entry->name, "LuaJIT trace #12 main.lua:8");
+
+  entry = ParsePerfMapLine("0x1000 0x20 LazyCompile:~foo app.js:1\r");
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->start, 0x1000);
+  EXPECT_EQ(entry->size, 0x20);
+  EXPECT_EQ(entry->name, "LazyCompile:~foo app.js:1");
+}
+
+TEST(ParsePerfMapLine, InvalidLines) {
+  EXPECT_FALSE(ParsePerfMapLine("").has_value());
+  EXPECT_FALSE(ParsePerfMapLine("1000").has_value());
+  EXPECT_FALSE(ParsePerfMapLine("1000 20").has_value());
+  EXPECT_FALSE(ParsePerfMapLine("xyz 20 name").has_value());
+  EXPECT_FALSE(ParsePerfMapLine("1000 2g name").has_value());
+}
+
+TEST(IsJitdumpFile, MatchesOnlyTheFileOfThePid) {
+  EXPECT_TRUE(IsJitdumpFile("/home/user/.debug/jit/llvm-IR-jit-20210101.abc/jit-42.dump", 42));
+  EXPECT_TRUE(IsJitdumpFile("jit-42.dump", 42));
+  EXPECT_FALSE(IsJitdumpFile("/tmp/jit-43.dump", 42));
+  EXPECT_FALSE(IsJitdumpFile("/tmp/jit-42.dump.old", 42));
+  EXPECT_FALSE(IsJitdumpFile("/usr/lib/libjit.so", 42));
+}
+
+TEST(JitSymbolsReader, PerfMapIsReadIncrementally) {
+  auto temporary_file_or_error = orbit_base::TemporaryFile::Create();
+  ASSERT_FALSE(temporary_file_or_error.has_error()) << temporary_file_or_error.error().message();
+  orbit_base::TemporaryFile temporary_file = std::move(temporary_file_or_error.value());
+
+  JitSymbolMap map;
+  JitSymbolsReader reader{getpid(), temporary_file.file_path(), &map};
+
+  ASSERT_FALSE(orbit_base::WriteFully(temporary_file.fd(), "1000 100 first\n2000 10").has_error());
+  reader.ReadNewSymbols(100);
+  EXPECT_EQ(FindName(map, 0x1050, 50), "first");
+  // The second line is not complete yet.
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 1);
+
+  ASSERT_FALSE(
+      orbit_base::WriteFully(temporary_file.fd(), "0 second\n1000 80 reused\n").has_error());
+  reader.ReadNewSymbols(200);
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 2);
+  EXPECT_EQ(FindName(map, 0x2050, 150), "second");
+  // The new lines were written between the two reads: they are considered loaded at 100.
+  EXPECT_EQ(FindName(map, 0x1050, 99), "first");
+  EXPECT_EQ(FindName(map, 0x1050, 100), "reused");
+  EXPECT_EQ(FindName(map, 0x10A0, 150), std::nullopt);
+
+  reader.ReadNewSymbols(300);
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 2);
+}
+
+TEST(JitSymbolsReader, MissingPerfMapIsNotAnError) {
+  JitSymbolMap map;
+  JitSymbolsReader reader{getpid(), "/non/existing/perf.map", &map};
+  reader.ReadNewSymbols(100);
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(JitSymbolsReader, JitdumpIsReadOnceMapped) {
+  TemporaryJitdumpFile jitdump_file;
+  ASSERT_TRUE(jitdump_file.IsValid());
+  const std::filesystem::path& jitdump_path = jitdump_file.file_path();
+  const orbit_base::unique_fd& fd = jitdump_file.fd();
+
+  JitSymbolMap map;
+  JitSymbolsReader reader{getpid(), "/non/existing/perf.map", &map};
+
+  std::string data = CreateJitdumpHeader(0) + CreateJitdumpCodeLoad(50, 0x1000, 0x40, "first");
+  std::string partial_record = CreateJitdumpCodeLoad(60, 0x2000, 0x40, "second");
+  data.append(partial_record.substr(0, 20));
+  ASSERT_FALSE(orbit_base::WriteFully(fd, data).has_error());
+
+  // Not known to be the jitdump file of the process yet.
+  reader.ReadNewSymbols(100);
+  EXPECT_TRUE(map.empty());
+
+  VisitMmap(&reader, "/usr/lib/libc.so.6");
+  VisitMmap(&reader, jitdump_path.string());
+  reader.ReadNewSymbols(200);
+  EXPECT_EQ(map.GetNumLoadedSymbols(), 1);
+  // Jitdump records come with their own timestamp.
+  EXPECT_EQ(FindName(map, 0x1010, 49), std::nullopt);
+  EXPECT_EQ(FindName(map, 0x1010, 50), "first");
+
+  data = partial_record.substr(20) + CreateJitdumpCodeMove(70, 0x2000, 0x3000, 0x40) +
+         CreateJitdumpCodeLoad(80, 0x2000, 0x20, "reused");
+  ASSERT_FALSE(orbit_base::WriteFully(fd, data).has_error());
+  reader.ReadNewSymbols(300);
+  EXPECT_EQ(FindName(map, 0x2010, 65), "second");
+  EXPECT_EQ(FindName(map, 0x3010, 75), "second");
+  EXPECT_EQ(FindName(map, 0x2010, 85), "reused");
+}
+
+TEST(JitSymbolsReader, JitdumpIsFoundInMaps) {
+  TemporaryJitdumpFile jitdump_file;
+  ASSERT_TRUE(jitdump_file.IsValid());
+  const std::filesystem::path& jitdump_path = jitdump_file.file_path();
+  ASSERT_FALSE(orbit_base::WriteFully(jitdump_file.fd(),
+                                      CreateJitdumpHeader(0) +
+                                          CreateJitdumpCodeLoad(50, 0x1000, 0x40, "first"))
+                   .has_error());
+
+  JitSymbolMap map;
+  JitSymbolsReader reader{getpid(), "/non/existing/perf.map", &map};
+  reader.FindJitdumpFileInMaps(absl::StrFormat(
+      "7f0000000000-7f0000001000 r-xp 00000000 fe:01 1234       /usr/lib/libc.so.6\n"
+      "7f0000001000-7f0000002000 rwxp 00000000 00:00 0 \n"
+      "7f0000002000-7f0000003000 r-xp 00000000 fe:01 5678       %s\n",
+      jitdump_path.string()));
+  reader.ReadNewSymbols(100);
+  EXPECT_EQ(FindName(map, 0x1010, 50), "first");
+}
+
+TEST(JitSymbolsReader, InvalidJitdumpIsIgnored) {
+  TemporaryJitdumpFile jitdump_file;
+  ASSERT_TRUE(jitdump_file.IsValid());
+  const std::filesystem::path& jitdump_path = jitdump_file.file_path();
+  std::string data(64, 'x');
+  ASSERT_FALSE(orbit_base::WriteFully(jitdump_file.fd(), data).has_error());
+
+  JitSymbolMap map;
+  JitSymbolsReader reader{getpid(), "/non/existing/perf.map", &map};
+  VisitMmap(&reader, jitdump_path.string());
+  reader.ReadNewSymbols(100);
+  reader.ReadNewSymbols(200);
+  EXPECT_TRUE(map.empty());
+}
+
+}  // namespace orbit_linux_tracing
@@ -4,13 +4,65 @@
 
 #include "LibunwindstackMaps.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace orbit_linux_tracing {
 
 namespace {
 
+// unwindstack::Maps::Add followed by unwindstack::Maps::Sort re-sorts all the maps, which is what
+// happens on every PERF_RECORD_MMAP. Instead, this inserts the new map at its sorted position and
+// only fixes prev_map and prev_real_map of the maps after it, as far as they are affected.
+class IncrementalBufferMaps : public unwindstack::BufferMaps {
+ public:
+  explicit IncrementalBufferMaps(const char* buffer) : unwindstack::BufferMaps{buffer} {}
+
+  void Insert(uint64_t start, uint64_t end, uint64_t offset, uint64_t flags,
+              const std::string& name, uint64_t load_bias) {
+    auto insert_it =
+        std::upper_bound(maps_.begin(), maps_.end(), start,
+                         [](uint64_t start, const std::unique_ptr<unwindstack::MapInfo>& map_info) {
+                           return start < map_info->start();
+                         });
+
+    // The same file is often mapped again at the same address (e.g., dlopen after dlclose). As we
+    // don't remove maps on munmap, don't let such a map accumulate.
+    for (auto it = insert_it; it != maps_.begin() && (*std::prev(it))->start() == start; --it) {
+      unwindstack::MapInfo& map_info = **std::prev(it);
+      const std::string& map_name = map_info.name();
+      if (map_info.end() == end && map_info.offset() == offset && map_info.flags() == flags &&
+          map_name == name && static_cast<uint64_t>(map_info.load_bias()) == load_bias) {
+        return;
+      }
+    }
+
+    const size_t index = insert_it - maps_.begin();
+    auto new_map_info =
+        std::make_unique<unwindstack::MapInfo>(nullptr, nullptr, start, end, offset, flags, name);
+    new_map_info->set_load_bias(load_bias);
+    maps_.insert(insert_it, std::move(new_map_info));
+
+    // Same as the loop in unwindstack::Maps::Sort, but starting from the new map. After the map
+    // that follows the new one, prev_map doesn't change, and as soon as prev_real_map doesn't
+    // change either, the rest of the maps are not affected.
+    unwindstack::MapInfo* prev_map = index > 0 ? maps_[index - 1].get() : nullptr;
+    unwindstack::MapInfo* prev_real_map =
+        (prev_map == nullptr || !prev_map->IsBlank()) ? prev_map : prev_map->prev_real_map();
+    for (size_t i = index; i < maps_.size(); ++i) {
+      unwindstack::MapInfo* map_info = maps_[i].get();
+      if (i > index + 1 && map_info->prev_real_map() == prev_real_map) break;
+      map_info->set_prev_map(prev_map);
+      map_info->set_prev_real_map(prev_real_map);
+      prev_map = map_info;
+      if (!map_info->IsBlank()) prev_real_map = map_info;
+    }
+  }
+};
+
 class LibunwindstackMapsImpl : public LibunwindstackMaps {
  public:
-  explicit LibunwindstackMapsImpl(std::unique_ptr<unwindstack::BufferMaps> maps)
+  explicit LibunwindstackMapsImpl(std::unique_ptr<IncrementalBufferMaps> maps)
       : maps_{std::move(maps)} {}
 
   unwindstack::MapInfo* Find(uint64_t pc) override { return maps_->Find(pc); }
@@ -19,21 +71,20 @@ class LibunwindstackMapsImpl : public LibunwindstackMaps {
 
   void AddAndSort(uint64_t start, uint64_t end, uint64_t offset, uint64_t flags,
                   const std::string& name, uint64_t load_bias) override {
-    maps_->Add(start, end, offset, flags, name, load_bias);
-    maps_->Sort();
+    maps_->Insert(start, end, offset, flags, name, load_bias);
   }
 
  private:
-  std::unique_ptr<unwindstack::BufferMaps> maps_;
+  std::unique_ptr<IncrementalBufferMaps> maps_;
 };
 }  // namespace
 
 std::unique_ptr<LibunwindstackMaps> LibunwindstackMaps::ParseMaps(const std::string& maps_buffer) {
-  auto maps = std::make_unique<unwindstack::BufferMaps>(maps_buffer.c_str());
+  auto maps = std::make_unique<IncrementalBufferMaps>(maps_buffer.c_str());
   if (!maps->Parse()) {
     return nullptr;
   }
   return std::make_unique<LibunwindstackMapsImpl>(std::move(maps));
 }
 
-}  // namespace orbit_linux_tracing
\ No newline at end of file
+}  // namespace orbit_linux_tracing
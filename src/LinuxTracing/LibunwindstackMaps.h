@@ -16,6 +16,7 @@ class LibunwindstackMaps {
 
   virtual unwindstack::MapInfo* Find(uint64_t pc) = 0;
   virtual unwindstack::Maps* Get() = 0;
+  // Inserts the map keeping the maps sorted. Does nothing if the exact same map is already present.
   virtual void AddAndSort(uint64_t start, uint64_t end, uint64_t offset, uint64_t flags,
                           const std::string& name, uint64_t load_bias) = 0;
 
@@ -0,0 +1,117 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unwindstack/MapInfo.h>
+#include <unwindstack/Maps.h>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "LibunwindstackMaps.h"
+
+namespace orbit_linux_tracing {
+
+namespace {
+
+const std::string kMapsString =
+    "55d0f2600000-55d0f2601000 r--p 00000000 fe:00 1311222  /tmp/target\n"
+    "55d0f2601000-55d0f2602000 r-xp 00001000 fe:00 1311222  /tmp/target\n"
+    "55d0f2602000-55d0f2603000 ---p 00000000 00:00 0 \n"
+    "7f075b600000-7f075b700000 r-xp 00000000 fe:00 2131077  /usr/lib/x86_64-linux-gnu/libc.so\n"
+    "7ffcae624000-7ffcae646000 rw-p 00000000 00:00 0        [stack]\n";
+
+struct MapsEntry {
+  uint64_t start;
+  uint64_t end;
+  uint64_t offset;
+  uint64_t flags;
+  std::string name;
+};
+
+// Describes a map by its start address, or nullopt for a null map, to compare the maps of two
+// different unwindstack::Maps.
+std::optional<uint64_t> GetStart(unwindstack::MapInfo* map_info) {
+  if (map_info == nullptr) return std::nullopt;
+  return map_info->start();
+}
+
+std::string GetName(unwindstack::MapInfo* map_info) { return map_info->name(); }
+
+// Checks that `actual` contains the same maps as `expected`, linked in the same way.
+void ExpectSameMaps(unwindstack::Maps* actual, unwindstack::Maps* expected) {
+  ASSERT_EQ(actual->Total(), expected->Total());
+  for (size_t i = 0; i < expected->Total(); ++i) {
+    unwindstack::MapInfo* actual_map_info = actual->Get(i);
+    unwindstack::MapInfo* expected_map_info = expected->Get(i);
+    EXPECT_EQ(actual_map_info->start(), expected_map_info->start());
+    EXPECT_EQ(actual_map_info->end(), expected_map_info->end());
+    EXPECT_EQ(actual_map_info->offset(), expected_map_info->offset());
+    EXPECT_EQ(actual_map_info->flags(), expected_map_info->flags());
+    EXPECT_EQ(GetName(actual_map_info), GetName(expected_map_info));
+    EXPECT_EQ(actual_map_info->load_bias(), expected_map_info->load_bias());
+    EXPECT_EQ(GetStart(actual_map_info->prev_map()), GetStart(expected_map_info->prev_map()));
+    EXPECT_EQ(GetStart(actual_map_info->prev_real_map()),
+              GetStart(expected_map_info->prev_real_map()));
+  }
+}
+
+}  // namespace
+
+TEST(LibunwindstackMaps, AddAndSortKeepsMapsSortedAndLinked) {
+  std::unique_ptr<LibunwindstackMaps> maps = LibunwindstackMaps::ParseMaps(kMapsString);
+  ASSERT_NE(maps, nullptr);
+  unwindstack::BufferMaps expected_maps{kMapsString.c_str()};
+  ASSERT_TRUE(expected_maps.Parse());
+
+  const std::vector<MapsEntry> entries_to_add{
+      // After all the maps.
+      {0x7fffffffe000, 0x7ffffffff000, 0, PROT_EXEC, "[uprobes]"},
+      // Before all the maps.
+      {0x1000, 0x2000, 0, PROT_READ | PROT_EXEC, "/tmp/first"},
+      // Right after the blank map.
+      {0x55d0f2603000, 0x55d0f2604000, 0, PROT_READ | PROT_EXEC, "/tmp/after_blank"},
+      // A blank map between real maps.
+      {0x7f075b500000, 0x7f075b600000, 0, 0, ""},
+      // Between the new blank map and the real map preceding it.
+      {0x7f075b400000, 0x7f075b500000, 0x1000, PROT_READ | PROT_EXEC, "/tmp/before_blank"},
+  };
+  for (const MapsEntry& entry : entries_to_add) {
+    maps->AddAndSort(entry.start, entry.end, entry.offset, entry.flags, entry.name, 0);
+    expected_maps.Add(entry.start, entry.end, entry.offset, entry.flags, entry.name, 0);
+    expected_maps.Sort();
+    ExpectSameMaps(maps->Get(), &expected_maps);
+  }
+
+  unwindstack::MapInfo* found = maps->Find(0x7f075b400010);
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(GetName(found), "/tmp/before_blank");
+  found = maps->Find(0x55d0f2603010);
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(GetName(found), "/tmp/after_blank");
+  EXPECT_EQ(maps->Find(0x3000), nullptr);
+}
+
+TEST(LibunwindstackMaps, AddAndSortIgnoresTheSameMapAddedAgain) {
+  std::unique_ptr<LibunwindstackMaps> maps = LibunwindstackMaps::ParseMaps(kMapsString);
+  ASSERT_NE(maps, nullptr);
+  const size_t initial_count = maps->Get()->Total();
+
+  maps->AddAndSort(0x1000, 0x2000, 0, PROT_READ | PROT_EXEC, "/tmp/lib.so", 0);
+  maps->AddAndSort(0x1000, 0x2000, 0, PROT_READ | PROT_EXEC, "/tmp/lib.so", 0);
+  EXPECT_EQ(maps->Get()->Total(), initial_count + 1);
+
+  // A different file, or the same file with a different size, is a different map.
+  maps->AddAndSort(0x1000, 0x2000, 0, PROT_READ | PROT_EXEC, "/tmp/other_lib.so", 0);
+  maps->AddAndSort(0x1000, 0x3000, 0, PROT_READ | PROT_EXEC, "/tmp/lib.so", 0);
+  EXPECT_EQ(maps->Get()->Total(), initial_count + 3);
+  maps->AddAndSort(0x1000, 0x2000, 0, PROT_READ | PROT_EXEC, "/tmp/lib.so", 0);
+  EXPECT_EQ(maps->Get()->Total(), initial_count + 3);
+}
+
+}  // namespace orbit_linux_tracing
@@ -0,0 +1,48 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "ModuleInfoCache.h"
+
+#include <sys/stat.h>
+
+#include "ObjectUtils/LinuxMap.h"
+
+namespace orbit_linux_tracing {
+
+ErrorMessageOr<orbit_grpc_protos::ModuleInfo> ModuleInfoCache::GetOrCreateModule(
+    const std::string& file_path, uint64_t address_start, uint64_t address_end) {
+  struct stat file_stat {};
+  if (stat(file_path.c_str(), &file_stat) != 0) {
+    // Let orbit_object_utils::CreateModule produce the appropriate error.
+    module_infos_by_file_path_.erase(file_path);
+    ++num_created_modules_;
+    return orbit_object_utils::CreateModule(file_path, address_start, address_end);
+  }
+  const FileIdentity file_identity{
+      static_cast<uint64_t>(file_stat.st_dev), static_cast<uint64_t>(file_stat.st_ino),
+      static_cast<uint64_t>(file_stat.st_size),
+      static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1'000'000'000 + file_stat.st_mtim.tv_nsec};
+
+  auto cached_it = module_infos_by_file_path_.find(file_path);
+  if (cached_it != module_infos_by_file_path_.end() &&
+      cached_it->second.file_identity == file_identity) {
+    orbit_grpc_protos::ModuleInfo module_info = cached_it->second.module_info;
+    module_info.set_address_start(address_start);
+    module_info.set_address_end(address_end);
+    return module_info;
+  }
+
+  ++num_created_modules_;
+  ErrorMessageOr<orbit_grpc_protos::ModuleInfo> module_info_or_error =
+      orbit_object_utils::CreateModule(file_path, address_start, address_end);
+  if (module_info_or_error.has_error()) {
+    if (cached_it != module_infos_by_file_path_.end()) module_infos_by_file_path_.erase(cached_it);
+    return module_info_or_error;
+  }
+  module_infos_by_file_path_.insert_or_assign(
+      file_path, CachedModuleInfo{file_identity, module_info_or_error.value()});
+  return module_info_or_error;
+}
+
+}  // namespace orbit_linux_tracing
@@ -0,0 +1,55 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_MODULE_INFO_CACHE_H_
+#define LINUX_TRACING_MODULE_INFO_CACHE_H_
+
+#include <absl/container/flat_hash_map.h>
+
+#include <cstdint>
+#include <string>
+
+#include "OrbitBase/Result.h"
+#include "module.pb.h"
+
+namespace orbit_linux_tracing {
+
+// orbit_object_utils::CreateModule opens and parses the whole object file. Processes that map the
+// same files over and over (dlopen/dlclose cycles, JITs, asset streaming) would make us do this on
+// every PERF_RECORD_MMAP. This class remembers the ModuleInfo of each file and, as long as the file
+// has not changed, only updates the addresses. A file is considered unchanged if its device, inode,
+// size and modification time are the same, which only costs a stat.
+class ModuleInfoCache {
+ public:
+  [[nodiscard]] ErrorMessageOr<orbit_grpc_protos::ModuleInfo> GetOrCreateModule(
+      const std::string& file_path, uint64_t address_start, uint64_t address_end);
+
+  // The number of times orbit_object_utils::CreateModule was actually called.
+  [[nodiscard]] uint64_t GetNumCreatedModules() const { return num_created_modules_; }
+
+ private:
+  struct FileIdentity {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t modification_time_ns;
+
+    friend bool operator==(const FileIdentity& lhs, const FileIdentity& rhs) {
+      return lhs.device == rhs.device && lhs.inode == rhs.inode && lhs.size == rhs.size &&
+             lhs.modification_time_ns == rhs.modification_time_ns;
+    }
+  };
+
+  struct CachedModuleInfo {
+    FileIdentity file_identity;
+    orbit_grpc_protos::ModuleInfo module_info;
+  };
+
+  absl::flat_hash_map<std::string, CachedModuleInfo> module_infos_by_file_path_;
+  uint64_t num_created_modules_ = 0;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_MODULE_INFO_CACHE_H_
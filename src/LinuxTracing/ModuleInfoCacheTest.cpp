@@ -0,0 +1,81 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "ModuleInfoCache.h"
+#include "ObjectUtils/LinuxMap.h"
+#include "OrbitBase/ExecutablePath.h"
+#include "OrbitBase/TemporaryFile.h"
+#include "module.pb.h"
+
+namespace orbit_linux_tracing {
+
+TEST(ModuleInfoCache, ModuleInfoIsReusedForTheSameFile) {
+  // The test binary itself is an ELF file we can create a ModuleInfo from.
+  const std::string file_path = orbit_base::GetExecutablePath().string();
+  ModuleInfoCache cache;
+
+  ErrorMessageOr<orbit_grpc_protos::ModuleInfo> first_or_error =
+      cache.GetOrCreateModule(file_path, 0x1000, 0x2000);
+  ASSERT_FALSE(first_or_error.has_error()) << first_or_error.error().message();
+  ErrorMessageOr<orbit_grpc_protos::ModuleInfo> second_or_error =
+      cache.GetOrCreateModule(file_path, 0x5000, 0x7000);
+  ASSERT_FALSE(second_or_error.has_error()) << second_or_error.error().message();
+  EXPECT_EQ(cache.GetNumCreatedModules(), 1);
+
+  const orbit_grpc_protos::ModuleInfo& first = first_or_error.value();
+  const orbit_grpc_protos::ModuleInfo& second = second_or_error.value();
+  EXPECT_EQ(first.address_start(), 0x1000);
+  EXPECT_EQ(first.address_end(), 0x2000);
+  EXPECT_EQ(second.address_start(), 0x5000);
+  EXPECT_EQ(second.address_end(), 0x7000);
+  EXPECT_EQ(second.file_path(), first.file_path());
+  EXPECT_EQ(second.file_size(), first.file_size());
+  EXPECT_EQ(second.name(), first.name());
+  EXPECT_EQ(second.build_id(), first.build_id());
+  EXPECT_EQ(second.load_bias(), first.load_bias());
+  EXPECT_EQ(second.executable_segment_offset(), first.executable_segment_offset());
+
+  ErrorMessageOr<orbit_grpc_protos::ModuleInfo> expected_or_error =
+      orbit_object_utils::CreateModule(file_path, 0x5000, 0x7000);
+  ASSERT_FALSE(expected_or_error.has_error());
+  EXPECT_EQ(second.SerializeAsString(), expected_or_error.value().SerializeAsString());
+}
+
+TEST(ModuleInfoCache, ModuleInfoIsCreatedAgainWhenTheFileChanges) {
+  auto temporary_file_or_error = orbit_base::TemporaryFile::Create();
+  ASSERT_FALSE(temporary_file_or_error.has_error()) << temporary_file_or_error.error().message();
+  orbit_base::TemporaryFile temporary_file = std::move(temporary_file_or_error.value());
+  const std::filesystem::path& file_path = temporary_file.file_path();
+  std::filesystem::copy_file(orbit_base::GetExecutablePath(), file_path,
+                             std::filesystem::copy_options::overwrite_existing);
+
+  ModuleInfoCache cache;
+  EXPECT_FALSE(cache.GetOrCreateModule(file_path, 0x1000, 0x2000).has_error());
+  EXPECT_FALSE(cache.GetOrCreateModule(file_path, 0x1000, 0x2000).has_error());
+  EXPECT_EQ(cache.GetNumCreatedModules(), 1);
+
+  std::filesystem::last_write_time(
+      file_path, std::filesystem::last_write_time(file_path) + std::chrono::hours{1});
+  EXPECT_FALSE(cache.GetOrCreateModule(file_path, 0x1000, 0x2000).has_error());
+  EXPECT_EQ(cache.GetNumCreatedModules(), 2);
+  EXPECT_FALSE(cache.GetOrCreateModule(file_path, 0x1000, 0x2000).has_error());
+  EXPECT_EQ(cache.GetNumCreatedModules(), 2);
+}
+
+TEST(ModuleInfoCache, ErrorsAreNotCached) {
+  ModuleInfoCache cache;
+  EXPECT_TRUE(cache.GetOrCreateModule("/non/existing/file", 0x1000, 0x2000).has_error());
+  EXPECT_TRUE(cache.GetOrCreateModule("/non/existing/file", 0x1000, 0x2000).has_error());
+  EXPECT_TRUE(cache.GetOrCreateModule("/dev/null", 0x1000, 0x2000).has_error());
+  EXPECT_EQ(cache.GetNumCreatedModules(), 3);
+}
+
+}  // namespace orbit_linux_tracing
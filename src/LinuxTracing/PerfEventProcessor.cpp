@@ -4,6 +4,7 @@
 
 #include "PerfEventProcessor.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -89,12 +90,17 @@ void PerfEventProcessor::ProcessAllEvents() {
 void PerfEventProcessor::ProcessOldEvents() {
   CHECK(!visitors_.empty());
   uint64_t current_timestamp_ns = orbit_base::CaptureTimestampNs();
+  // Events older than this can be processed, as no older event will arrive anymore (or if it does,
+  // it's so late that discarding it is acceptable).
+  uint64_t process_before_timestamp_ns =
+      std::max(current_timestamp_ns - std::min(current_timestamp_ns, kProcessingDelayMs * 1'000'000),
+               watermark_ns_);
 
   while (event_queue_.HasEvent()) {
     PerfEvent* event = event_queue_.TopEvent();
 
     // Do not read the most recent events as out-of-order events could (and will) arrive.
-    if (event->GetTimestamp() + kProcessingDelayMs * 1'000'000 >= current_timestamp_ns) {
+    if (event->GetTimestamp() >= process_before_timestamp_ns) {
       break;
     }
     // Events are guaranteed to be processed in order of timestamp
@@ -109,4 +115,17 @@ void PerfEventProcessor::ProcessOldEvents() {
   }
 }
 
+uint64_t ComputeRingBufferWatermarkNs(std::optional<uint64_t> last_record_timestamp_ns,
+                                      bool ring_buffer_is_empty,
+                                      uint64_t read_start_timestamp_ns) {
+  uint64_t watermark_ns = last_record_timestamp_ns.value_or(0);
+  if (ring_buffer_is_empty) {
+    constexpr uint64_t kProcessingDelayNs = PerfEventProcessor::kProcessingDelayMs * 1'000'000;
+    watermark_ns =
+        std::max(watermark_ns,
+                 read_start_timestamp_ns - std::min(read_start_timestamp_ns, kProcessingDelayNs));
+  }
+  return watermark_ns;
+}
+
 }  // namespace orbit_linux_tracing
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "PerfEvent.h"
@@ -25,14 +26,27 @@ namespace orbit_linux_tracing {
 // we will never process events out of order.
 // If events older than kProcessingDelayMs are encountered anyway, these are discarded, and
 // DiscardedPerfEvents are generated and processed in their place.
+// When the caller knows that all ring buffers have been read up to some timestamp (the watermark),
+// events older than the watermark are processed right away, without waiting for kProcessingDelayMs.
+// The delay then only bounds how long events are held back by ring buffers that don't progress.
 class PerfEventProcessor {
  public:
   void AddEvent(std::unique_ptr<PerfEvent> event);
 
   void ProcessAllEvents();
 
+  // Processes the events older than kProcessingDelayMs or older than the watermark.
   void ProcessOldEvents();
 
+  // Promises that no event with a timestamp lower than `watermark_ns` will be added anymore. The
+  // watermark never moves back, lower values are ignored.
+  void SetWatermark(uint64_t watermark_ns) { watermark_ns_ = std::max(watermark_ns_, watermark_ns); }
+
+  // Events older than this will not be processed anymore, as they would be discarded.
+  [[nodiscard]] uint64_t GetLastProcessedTimestampNs() const {
+    return last_processed_timestamp_ns_;
+  }
+
   void AddVisitor(PerfEventVisitor* visitor) { visitors_.push_back(visitor); }
 
   void ClearVisitors() { visitors_.clear(); }
@@ -49,6 +63,7 @@ class PerfEventProcessor {
 
  private:
   uint64_t last_processed_timestamp_ns_ = 0;
+  uint64_t watermark_ns_ = 0;
   std::atomic<uint64_t>* discarded_out_of_order_counter_ = nullptr;
 
   PerfEventQueue event_queue_;
@@ -60,6 +75,16 @@ class PerfEventProcessor {
   uint64_t last_discarded_end_ = 0;
 };
 
+// Returns the timestamp up to which all records of a ring buffer have been read, to compute the
+// watermark passed to PerfEventProcessor::SetWatermark. This is the timestamp of the last record
+// read from it, if any. A record only becomes visible in a ring buffer some time after its
+// timestamp was taken, also in a ring buffer that was idle until then. So for a ring buffer found
+// empty when reading started at `read_start_timestamp_ns`, only records older than
+// kProcessingDelayMs are assumed to have been read, the same bound as without a watermark.
+[[nodiscard]] uint64_t ComputeRingBufferWatermarkNs(
+    std::optional<uint64_t> last_record_timestamp_ns, bool ring_buffer_is_empty,
+    uint64_t read_start_timestamp_ns);
+
 }  // namespace orbit_linux_tracing
 
 #endif  // LINUX_TRACING_PERF_EVENT_PROCESSOR_H_
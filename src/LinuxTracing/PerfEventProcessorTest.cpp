@@ -6,9 +6,11 @@
 #include <gtest/gtest.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <thread>
 
 #include "OrbitBase/Profiling.h"
@@ -96,6 +98,91 @@ TEST_F(PerfEventProcessorTest, ProcessOldEvents) {
   EXPECT_EQ(discarded_out_of_order_counter_, 0);
 }
 
+TEST_F(PerfEventProcessorTest, ProcessOldEventsUpToWatermark) {
+  uint64_t timestamp_ns = orbit_base::CaptureTimestampNs();
+  processor_.AddEvent(MakeFakePerfEvent(11, timestamp_ns));
+  processor_.AddEvent(MakeFakePerfEvent(22, timestamp_ns + 10));
+  processor_.AddEvent(MakeFakePerfEvent(11, timestamp_ns + 20));
+
+  // Events older than the watermark are processed without waiting for kProcessingDelayMs.
+  EXPECT_CALL(mock_visitor_, Visit(A<ForkPerfEvent*>())).Times(2);
+  processor_.SetWatermark(timestamp_ns + 20);
+  processor_.ProcessOldEvents();
+  Mock::VerifyAndClearExpectations(&mock_visitor_);
+
+  // The watermark never moves back.
+  EXPECT_CALL(mock_visitor_, Visit(A<ForkPerfEvent*>())).Times(0);
+  processor_.SetWatermark(timestamp_ns);
+  processor_.ProcessOldEvents();
+  Mock::VerifyAndClearExpectations(&mock_visitor_);
+
+  // An event at the watermark is still in order.
+  processor_.AddEvent(MakeFakePerfEvent(22, timestamp_ns + 20));
+  EXPECT_EQ(discarded_out_of_order_counter_, 0);
+
+  EXPECT_CALL(mock_visitor_, Visit(A<ForkPerfEvent*>())).Times(2);
+  processor_.SetWatermark(timestamp_ns + 21);
+  processor_.ProcessOldEvents();
+  EXPECT_EQ(discarded_out_of_order_counter_, 0);
+}
+
+TEST(PerfEventProcessor, ComputeRingBufferWatermarkNs) {
+  constexpr uint64_t kProcessingDelayNs = PerfEventProcessor::kProcessingDelayMs * 1'000'000;
+  constexpr uint64_t kReadStartTimestampNs = 10 * kProcessingDelayNs;
+  constexpr uint64_t kRecentTimestampNs = kReadStartTimestampNs - 1;
+  constexpr uint64_t kOldTimestampNs = 1;
+
+  // A ring buffer that still has records is read up to the last record read from it.
+  EXPECT_EQ(ComputeRingBufferWatermarkNs(kRecentTimestampNs, false, kReadStartTimestampNs),
+            kRecentTimestampNs);
+  EXPECT_EQ(ComputeRingBufferWatermarkNs(std::nullopt, false, kReadStartTimestampNs), 0);
+
+  // A ring buffer found empty can still receive records up to kProcessingDelayMs old.
+  EXPECT_EQ(ComputeRingBufferWatermarkNs(kRecentTimestampNs, true, kReadStartTimestampNs),
+            kRecentTimestampNs);
+  EXPECT_EQ(ComputeRingBufferWatermarkNs(kOldTimestampNs, true, kReadStartTimestampNs),
+            kReadStartTimestampNs - kProcessingDelayNs);
+  EXPECT_EQ(ComputeRingBufferWatermarkNs(std::nullopt, true, kReadStartTimestampNs),
+            kReadStartTimestampNs - kProcessingDelayNs);
+  EXPECT_EQ(ComputeRingBufferWatermarkNs(std::nullopt, true, kProcessingDelayNs / 2), 0);
+}
+
+TEST_F(PerfEventProcessorTest, LateEventFromPreviouslyIdleRingBufferIsProcessedInOrder) {
+  constexpr int kBusyFd = 11;
+  constexpr int kIdleFd = 22;
+  const uint64_t read_start_timestamp_ns = orbit_base::CaptureTimestampNs();
+  const uint64_t busy_timestamp_ns = read_start_timestamp_ns - 1;
+
+  // The busy ring buffer was read up to a recent event, the idle one was found empty.
+  processor_.AddEvent(MakeFakePerfEvent(kBusyFd, busy_timestamp_ns));
+  processor_.SetWatermark(
+      std::min(ComputeRingBufferWatermarkNs(busy_timestamp_ns, false, read_start_timestamp_ns),
+               ComputeRingBufferWatermarkNs(std::nullopt, true, read_start_timestamp_ns)));
+  EXPECT_CALL(mock_visitor_, Visit(A<ForkPerfEvent*>())).Times(0);
+  processor_.ProcessOldEvents();
+  Mock::VerifyAndClearExpectations(&mock_visitor_);
+
+  // A record written to the idle ring buffer before the busy one's shows up late.
+  const uint64_t late_timestamp_ns = busy_timestamp_ns - 100'000'000;
+  processor_.AddEvent(MakeFakePerfEvent(kIdleFd, late_timestamp_ns));
+  EXPECT_EQ(discarded_out_of_order_counter_, 0);
+
+  EXPECT_CALL(mock_visitor_, Visit(A<DiscardedPerfEvent*>())).Times(0);
+  {
+    ::testing::InSequence in_sequence;
+    EXPECT_CALL(mock_visitor_, Visit(::testing::Matcher<ForkPerfEvent*>(::testing::Truly(
+                                   [late_timestamp_ns](ForkPerfEvent* event) {
+                                     return event->GetTimestamp() == late_timestamp_ns;
+                                   }))));
+    EXPECT_CALL(mock_visitor_, Visit(::testing::Matcher<ForkPerfEvent*>(::testing::Truly(
+                                   [busy_timestamp_ns](ForkPerfEvent* event) {
+                                     return event->GetTimestamp() == busy_timestamp_ns;
+                                   }))));
+  }
+  processor_.ProcessAllEvents();
+  EXPECT_EQ(discarded_out_of_order_counter_, 0);
+}
+
 TEST_F(PerfEventProcessorTest, ProcessAllEvents) {
   EXPECT_CALL(mock_visitor_, Visit(A<ForkPerfEvent*>())).Times(4);
   processor_.AddEvent(MakeFakePerfEvent(11, orbit_base::CaptureTimestampNs()));
@@ -4,9 +4,6 @@
 
 #include "SwitchesStatesNamesVisitor.h"
 
-#include <absl/container/flat_hash_map.h>
-#include <absl/meta/type_traits.h>
-
 #include <utility>
 #include <vector>
 
@@ -20,18 +17,30 @@ using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadStateSlice;
 
 void SwitchesStatesNamesVisitor::ProcessInitialTidToPidAssociation(pid_t tid, pid_t pid) {
-  bool new_insertion = tid_to_pid_association_.insert_or_assign(tid, pid).second;
-  if (!new_insertion) {
-    ERROR("Overwriting previous pid for tid %d with initial pid %d", tid, pid);
+  switch (tid_to_pid_association_.InsertOrAssign(tid, pid)) {
+    case TidInsertOrAssignResult::kInserted:
+      break;
+    case TidInsertOrAssignResult::kAssigned:
+      ERROR("Overwriting previous pid for tid %d with initial pid %d", tid, pid);
+      break;
+    case TidInsertOrAssignResult::kInvalidTid:
+      ERROR("Ignoring initial pid %d for invalid tid %d", pid, tid);
+      break;
   }
 }
 
 void SwitchesStatesNamesVisitor::Visit(ForkPerfEvent* event) {
   pid_t pid = event->GetPid();
   pid_t tid = event->GetTid();
-  bool new_insertion = tid_to_pid_association_.insert_or_assign(tid, pid).second;
-  if (!new_insertion) {
-    ERROR("Overwriting previous pid for tid %d with pid %d from PERF_RECORD_FORK", tid, pid);
+  switch (tid_to_pid_association_.InsertOrAssign(tid, pid)) {
+    case TidInsertOrAssignResult::kInserted:
+      break;
+    case TidInsertOrAssignResult::kAssigned:
+      ERROR("Overwriting previous pid for tid %d with pid %d from PERF_RECORD_FORK", tid, pid);
+      break;
+    case TidInsertOrAssignResult::kInvalidTid:
+      ERROR("Ignoring pid %d for invalid tid %d from PERF_RECORD_FORK", pid, tid);
+      break;
   }
 }
 
@@ -46,7 +55,7 @@ void SwitchesStatesNamesVisitor::Visit(ForkPerfEvent* event) {
 void SwitchesStatesNamesVisitor::Visit(ExitPerfEvent* event) {
   pid_t pid = event->GetPid();
   pid_t tid = event->GetTid();
-  tid_to_pid_association_.insert_or_assign(tid, pid);
+  tid_to_pid_association_.InsertOrAssign(tid, pid);
   // Don't log an error on overwrite, as it's expected that the pid was already known.
 }
 
@@ -55,20 +64,16 @@ bool SwitchesStatesNamesVisitor::TidMatchesPidFilter(pid_t tid) {
     return false;
   }
 
-  auto tid_to_pid_it = tid_to_pid_association_.find(tid);
-  if (tid_to_pid_it == tid_to_pid_association_.end()) {
-    return false;
-  }
-
-  return tid_to_pid_it->second == thread_state_pid_filter_;
+  const pid_t* pid = tid_to_pid_association_.Find(tid);
+  return pid != nullptr && *pid == thread_state_pid_filter_;
 }
 
 std::optional<pid_t> SwitchesStatesNamesVisitor::GetPidOfTid(pid_t tid) {
-  auto tid_to_pid_it = tid_to_pid_association_.find(tid);
-  if (tid_to_pid_it == tid_to_pid_association_.end()) {
+  const pid_t* pid = tid_to_pid_association_.Find(tid);
+  if (pid == nullptr) {
     return std::nullopt;
   }
-  return tid_to_pid_it->second;
+  return *pid;
 }
 
 void SwitchesStatesNamesVisitor::ProcessInitialState(uint64_t timestamp_ns, pid_t tid,
@@ -5,8 +5,6 @@
 #ifndef LINUX_TRACING_THREAD_STATE_VISITOR_H_
 #define LINUX_TRACING_THREAD_STATE_VISITOR_H_
 
-#include <absl/container/flat_hash_map.h>
-#include <absl/hash/hash.h>
 #include <sys/types.h>
 
 #include <atomic>
@@ -19,6 +17,7 @@
 #include "PerfEvent.h"
 #include "PerfEventVisitor.h"
 #include "ThreadStateManager.h"
+#include "TidIndexedTable.h"
 #include "capture.pb.h"
 
 namespace orbit_linux_tracing {
@@ -76,7 +75,8 @@ class SwitchesStatesNamesVisitor : public PerfEventVisitor {
   std::optional<pid_t> GetPidOfTid(pid_t tid);
   static constexpr pid_t kPidFilterNoThreadState = -1;
   pid_t thread_state_pid_filter_ = kPidFilterNoThreadState;
-  absl::flat_hash_map<pid_t, pid_t> tid_to_pid_association_;
+  // Looked up for both threads of every sched:sched_switch system-wide, hence a dense table.
+  TidIndexedTable<pid_t> tid_to_pid_association_;
 
   ContextSwitchManager switch_manager_;
   ThreadStateManager state_manager_;
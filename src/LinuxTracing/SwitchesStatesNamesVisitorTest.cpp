@@ -0,0 +1,220 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "LinuxTracing/TracerListener.h"
+#include "PerfEvent.h"
+#include "SwitchesStatesNamesVisitor.h"
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+namespace {
+
+// Not a gMock listener, as the benchmark below produces too many events for gMock to be fast.
+class FakeTracerListener : public TracerListener {
+ public:
+  void OnSchedulingSlice(orbit_grpc_protos::SchedulingSlice scheduling_slice) override {
+    scheduling_slices_.emplace_back(std::move(scheduling_slice));
+  }
+  void OnCallstackSample(orbit_grpc_protos::FullCallstackSample /*callstack_sample*/) override {}
+  void OnFunctionCall(orbit_grpc_protos::FunctionCall /*function_call*/) override {}
+  void OnIntrospectionScope(
+      orbit_grpc_protos::IntrospectionScope /*introspection_scope*/) override {}
+  void OnGpuJob(orbit_grpc_protos::FullGpuJob /*gpu_job*/) override {}
+  void OnThreadName(orbit_grpc_protos::ThreadName thread_name) override {
+    thread_names_.emplace_back(std::move(thread_name));
+  }
+  void OnThreadNamesSnapshot(
+      orbit_grpc_protos::ThreadNamesSnapshot /*thread_names_snapshot*/) override {}
+  void OnThreadStateSlice(orbit_grpc_protos::ThreadStateSlice thread_state_slice) override {
+    thread_state_slices_.emplace_back(std::move(thread_state_slice));
+  }
+  void OnAddressInfo(orbit_grpc_protos::FullAddressInfo /*full_address_info*/) override {}
+  void OnTracepointEvent(orbit_grpc_protos::FullTracepointEvent /*tracepoint_event*/) override {}
+  void OnModulesSnapshot(orbit_grpc_protos::ModulesSnapshot /*modules_snapshot*/) override {}
+  void OnModuleUpdate(orbit_grpc_protos::ModuleUpdateEvent /*module_update_event*/) override {}
+  void OnErrorsWithPerfEventOpenEvent(
+      orbit_grpc_protos::ErrorsWithPerfEventOpenEvent /*errors_with_perf_event_open_event*/)
+      override {}
+  void OnLostPerfRecordsEvent(
+      orbit_grpc_protos::LostPerfRecordsEvent /*lost_perf_records_event*/) override {}
+  void OnOutOfOrderEventsDiscardedEvent(
+      orbit_grpc_protos::OutOfOrderEventsDiscardedEvent /*out_of_order_events_discarded_event*/)
+      override {}
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent /*unwinding_errors_summary_event*/) override {}
+
+  std::vector<orbit_grpc_protos::SchedulingSlice> scheduling_slices_;
+  std::vector<orbit_grpc_protos::ThreadName> thread_names_;
+  std::vector<orbit_grpc_protos::ThreadStateSlice> thread_state_slices_;
+};
+
+constexpr int64_t kPrevStateRunnable = 0;
+constexpr int64_t kPrevStateInterruptibleSleep = 0x01;
+
+std::unique_ptr<SchedSwitchPerfEvent> MakeSchedSwitch(uint64_t timestamp_ns, uint32_t cpu,
+                                                      pid_t prev_pid, pid_t prev_tid,
+                                                      int64_t prev_state, pid_t next_tid) {
+  auto event = std::make_unique<SchedSwitchPerfEvent>();
+  event->ring_buffer_record.sample_id.time = timestamp_ns;
+  event->ring_buffer_record.sample_id.cpu = cpu;
+  event->ring_buffer_record.sample_id.pid = prev_pid;
+  event->ring_buffer_record.sample_id.tid = prev_tid;
+  event->ring_buffer_record.data.prev_pid = prev_tid;
+  event->ring_buffer_record.data.prev_state = prev_state;
+  event->ring_buffer_record.data.next_pid = next_tid;
+  return event;
+}
+
+std::unique_ptr<SchedWakeupPerfEvent> MakeSchedWakeup(uint64_t timestamp_ns, pid_t woken_tid) {
+  auto event = std::make_unique<SchedWakeupPerfEvent>();
+  event->ring_buffer_record.sample_id.time = timestamp_ns;
+  event->ring_buffer_record.data.pid = woken_tid;
+  return event;
+}
+
+}  // namespace
+
+TEST(SwitchesStatesNamesVisitor, ThreadStatesAreOnlyProducedForTheFilteredProcess) {
+  constexpr pid_t kTargetPid = 10;
+  constexpr pid_t kTargetTid = 11;
+  constexpr pid_t kOtherPid = 20;
+  constexpr pid_t kOtherTid = 21;
+  constexpr uint32_t kCpu = 3;
+
+  FakeTracerListener listener;
+  SwitchesStatesNamesVisitor visitor{&listener};
+  visitor.SetProduceSchedulingSlices(true);
+  visitor.SetThreadStatePidFilter(kTargetPid);
+  visitor.ProcessInitialTidToPidAssociation(kTargetTid, kTargetPid);
+  visitor.ProcessInitialTidToPidAssociation(kOtherTid, kOtherPid);
+  visitor.ProcessInitialState(100, kTargetTid, 'S');
+  visitor.ProcessInitialState(100, kOtherTid, 'S');
+
+  visitor.Visit(MakeSchedWakeup(200, kTargetTid).get());
+  visitor.Visit(MakeSchedWakeup(200, kOtherTid).get());
+  visitor.Visit(MakeSchedSwitch(300, kCpu, 0, 0, kPrevStateRunnable, kTargetTid).get());
+  visitor.Visit(
+      MakeSchedSwitch(400, kCpu, kTargetPid, kTargetTid, kPrevStateRunnable, kOtherTid).get());
+  visitor.Visit(
+      MakeSchedSwitch(500, kCpu, kOtherPid, kOtherTid, kPrevStateInterruptibleSleep, 0).get());
+  visitor.ProcessRemainingOpenStates(600);
+
+  ASSERT_EQ(listener.scheduling_slices_.size(), 2);
+  EXPECT_EQ(listener.scheduling_slices_[0].pid(), kTargetPid);
+  EXPECT_EQ(listener.scheduling_slices_[0].tid(), kTargetTid);
+  EXPECT_EQ(listener.scheduling_slices_[0].duration_ns(), 100);
+  EXPECT_EQ(listener.scheduling_slices_[1].pid(), kOtherPid);
+  EXPECT_EQ(listener.scheduling_slices_[1].tid(), kOtherTid);
+
+  // Sleeping, runnable, running, and runnable until the end of the capture.
+  ASSERT_EQ(listener.thread_state_slices_.size(), 4);
+  for (const orbit_grpc_protos::ThreadStateSlice& slice : listener.thread_state_slices_) {
+    EXPECT_EQ(slice.tid(), kTargetTid);
+  }
+  EXPECT_EQ(listener.thread_state_slices_[0].thread_state(),
+            orbit_grpc_protos::ThreadStateSlice::kInterruptibleSleep);
+  EXPECT_EQ(listener.thread_state_slices_[1].thread_state(),
+            orbit_grpc_protos::ThreadStateSlice::kRunnable);
+  EXPECT_EQ(listener.thread_state_slices_[2].thread_state(),
+            orbit_grpc_protos::ThreadStateSlice::kRunning);
+  EXPECT_EQ(listener.thread_state_slices_[3].thread_state(),
+            orbit_grpc_protos::ThreadStateSlice::kRunnable);
+  EXPECT_EQ(listener.thread_state_slices_[3].end_timestamp_ns(), 600);
+}
+
+TEST(SwitchesStatesNamesVisitor, ThreadNamesUseTheKnownPid) {
+  constexpr pid_t kPid = 10;
+  constexpr pid_t kTid = 11;
+  FakeTracerListener listener;
+  SwitchesStatesNamesVisitor visitor{&listener};
+  visitor.ProcessInitialTidToPidAssociation(kTid, kPid);
+
+  TaskRenamePerfEvent known;
+  known.ring_buffer_record.sample_id.time = 100;
+  known.ring_buffer_record.data.pid = kTid;
+  visitor.Visit(&known);
+
+  TaskRenamePerfEvent unknown;
+  unknown.ring_buffer_record.sample_id.time = 200;
+  unknown.ring_buffer_record.data.pid = kTid + 1;
+  visitor.Visit(&unknown);
+
+  ASSERT_EQ(listener.thread_names_.size(), 2);
+  EXPECT_EQ(listener.thread_names_[0].pid(), kPid);
+  EXPECT_EQ(listener.thread_names_[1].pid(), -1);
+}
+
+// Replays a synthetic system-wide stream of sched:sched_switch and sched:sched_wakeup events shaped
+// like the ones recorded on a machine with many cores and many threads, of which only a few belong
+// to the target process.
+TEST(SwitchesStatesNamesVisitor, ReplaySystemWideSchedulingStream) {
+  constexpr uint32_t kNumCpus = 96;
+  constexpr pid_t kNumThreads = 4096;
+  constexpr pid_t kFirstTid = 100'000;
+  constexpr pid_t kTargetPid = kFirstTid;
+  constexpr pid_t kNumTargetThreads = 64;
+  constexpr size_t kNumSwitches = 20'000;
+
+  auto get_pid_of_tid = [](pid_t tid) {
+    // Threads come in processes of 16, except for the target process.
+    if (tid < kFirstTid + kNumTargetThreads) return kTargetPid;
+    return kFirstTid + (tid - kFirstTid) / 16 * 16;
+  };
+
+  std::mt19937 random_engine{42};
+  std::uniform_int_distribution<pid_t> tid_distribution{kFirstTid, kFirstTid + kNumThreads - 1};
+  std::vector<std::unique_ptr<PerfEvent>> events;
+  events.reserve(2 * kNumSwitches);
+  std::vector<pid_t> running_tid_by_cpu(kNumCpus, 0);
+  std::vector<bool> is_running(kNumThreads, false);
+  uint64_t timestamp_ns = 1'000'000;
+  for (size_t i = 0; i < kNumSwitches; ++i) {
+    const uint32_t cpu = i % kNumCpus;
+    const pid_t prev_tid = running_tid_by_cpu[cpu];
+    if (prev_tid != 0) is_running[prev_tid - kFirstTid] = false;
+    // A thread can only run on one cpu at a time.
+    pid_t next_tid;
+    do {
+      next_tid = tid_distribution(random_engine);
+    } while (is_running[next_tid - kFirstTid]);
+    is_running[next_tid - kFirstTid] = true;
+    events.emplace_back(MakeSchedWakeup(timestamp_ns++, next_tid));
+    events.emplace_back(MakeSchedSwitch(timestamp_ns++, cpu,
+                                        prev_tid == 0 ? 0 : get_pid_of_tid(prev_tid), prev_tid,
+                                        kPrevStateInterruptibleSleep, next_tid));
+    running_tid_by_cpu[cpu] = next_tid;
+  }
+
+  FakeTracerListener listener;
+  listener.scheduling_slices_.reserve(kNumSwitches);
+  SwitchesStatesNamesVisitor visitor{&listener};
+  visitor.SetProduceSchedulingSlices(true);
+  visitor.SetThreadStatePidFilter(kTargetPid);
+  for (pid_t tid = kFirstTid; tid < kFirstTid + kNumThreads; ++tid) {
+    visitor.ProcessInitialTidToPidAssociation(tid, get_pid_of_tid(tid));
+    visitor.ProcessInitialState(0, tid, 'S');
+  }
+
+  for (const std::unique_ptr<PerfEvent>& event : events) {
+    event->Accept(&visitor);
+  }
+
+  EXPECT_EQ(listener.scheduling_slices_.size(), kNumSwitches - kNumCpus);
+  EXPECT_FALSE(listener.thread_state_slices_.empty());
+  for (const orbit_grpc_protos::ThreadStateSlice& slice : listener.thread_state_slices_) {
+    EXPECT_EQ(get_pid_of_tid(slice.tid()), kTargetPid);
+  }
+}
+
+}  // namespace orbit_linux_tracing
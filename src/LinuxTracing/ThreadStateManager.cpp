@@ -4,9 +4,6 @@
 
 #include "ThreadStateManager.h"
 
-#include <absl/container/flat_hash_map.h>
-#include <absl/meta/type_traits.h>
-
 #include <type_traits>
 #include <utility>
 
@@ -27,37 +24,36 @@ using orbit_grpc_protos::ThreadStateSlice;
 
 void ThreadStateManager::OnInitialState(uint64_t timestamp_ns, pid_t tid,
                                         ThreadStateSlice::ThreadState state) {
-  CHECK(!tid_open_states_.contains(tid));
-  tid_open_states_.emplace(tid, OpenState{state, timestamp_ns});
+  CHECK(!tid_open_states_.Contains(tid));
+  tid_open_states_.InsertOrAssign(tid, OpenState{state, timestamp_ns});
 }
 
 void ThreadStateManager::OnNewTask(uint64_t timestamp_ns, pid_t tid) {
   static constexpr ThreadStateSlice::ThreadState kNewState = ThreadStateSlice::kRunnable;
 
-  if (auto open_state_it = tid_open_states_.find(tid);
-      open_state_it != tid_open_states_.end() &&
-      timestamp_ns >= open_state_it->second.begin_timestamp_ns) {
+  if (const OpenState* open_state = tid_open_states_.Find(tid);
+      open_state != nullptr && timestamp_ns >= open_state->begin_timestamp_ns) {
     ERROR("Processed task:task_newtask but thread %d was already known", tid);
     return;
   }
-  tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+  tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
 }
 
 std::optional<ThreadStateSlice> ThreadStateManager::OnSchedWakeup(uint64_t timestamp_ns,
                                                                   pid_t tid) {
   static constexpr ThreadStateSlice::ThreadState kNewState = ThreadStateSlice::kRunnable;
 
-  auto open_state_it = tid_open_states_.find(tid);
-  if (open_state_it == tid_open_states_.end()) {
+  const OpenState* open_state_ptr = tid_open_states_.Find(tid);
+  if (open_state_ptr == nullptr) {
     ERROR("Processed sched:sched_wakeup but previous state of thread %d is unknown", tid);
-    tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+    tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
     return std::nullopt;
   }
 
-  const OpenState& open_state = open_state_it->second;
+  const OpenState& open_state = *open_state_ptr;
   if (timestamp_ns < open_state.begin_timestamp_ns) {
     // As noted above, overwrite the thread state retrieved at the beginning.
-    tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+    tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
     return std::nullopt;
   }
 
@@ -78,7 +74,7 @@ std::optional<ThreadStateSlice> ThreadStateManager::OnSchedWakeup(uint64_t times
   slice.set_thread_state(open_state.state);
   slice.set_duration_ns(timestamp_ns - open_state.begin_timestamp_ns);
   slice.set_end_timestamp_ns(timestamp_ns);
-  tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+  tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
   return slice;
 }
 
@@ -86,16 +82,16 @@ std::optional<ThreadStateSlice> ThreadStateManager::OnSchedSwitchIn(uint64_t tim
                                                                     pid_t tid) {
   static constexpr ThreadStateSlice::ThreadState kNewState = ThreadStateSlice::kRunning;
 
-  auto open_state_it = tid_open_states_.find(tid);
-  if (open_state_it == tid_open_states_.end()) {
+  const OpenState* open_state_ptr = tid_open_states_.Find(tid);
+  if (open_state_ptr == nullptr) {
     ERROR("Processed sched:sched_switch(in) but previous state of thread %d is unknown", tid);
-    tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+    tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
     return std::nullopt;
   }
 
-  const OpenState& open_state = open_state_it->second;
+  const OpenState& open_state = *open_state_ptr;
   if (timestamp_ns < open_state.begin_timestamp_ns) {
-    tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+    tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
     return std::nullopt;
   }
 
@@ -113,22 +109,22 @@ std::optional<ThreadStateSlice> ThreadStateManager::OnSchedSwitchIn(uint64_t tim
   slice.set_thread_state(open_state.state);
   slice.set_duration_ns(timestamp_ns - open_state.begin_timestamp_ns);
   slice.set_end_timestamp_ns(timestamp_ns);
-  tid_open_states_.insert_or_assign(tid, OpenState{kNewState, timestamp_ns});
+  tid_open_states_.InsertOrAssign(tid, OpenState{kNewState, timestamp_ns});
   return slice;
 }
 
 std::optional<ThreadStateSlice> ThreadStateManager::OnSchedSwitchOut(
     uint64_t timestamp_ns, pid_t tid, ThreadStateSlice::ThreadState new_state) {
-  auto open_state_it = tid_open_states_.find(tid);
-  if (open_state_it == tid_open_states_.end()) {
+  const OpenState* open_state_ptr = tid_open_states_.Find(tid);
+  if (open_state_ptr == nullptr) {
     ERROR("Processed sched:sched_switch(out) but previous state of thread %d is unknown", tid);
-    tid_open_states_.insert_or_assign(tid, OpenState{new_state, timestamp_ns});
+    tid_open_states_.InsertOrAssign(tid, OpenState{new_state, timestamp_ns});
     return std::nullopt;
   }
 
-  const OpenState& open_state = open_state_it->second;
+  const OpenState& open_state = *open_state_ptr;
   if (timestamp_ns < open_state.begin_timestamp_ns) {
-    tid_open_states_.insert_or_assign(tid, OpenState{new_state, timestamp_ns});
+    tid_open_states_.InsertOrAssign(tid, OpenState{new_state, timestamp_ns});
     return std::nullopt;
   }
 
@@ -157,20 +153,21 @@ std::optional<ThreadStateSlice> ThreadStateManager::OnSchedSwitchOut(
 
   // Note: If the thread exits but the new_state is kZombie instead of kDead,
   // the switch to kDead will never be reported.
-  tid_open_states_.insert_or_assign(tid, OpenState{new_state, timestamp_ns});
+  tid_open_states_.InsertOrAssign(tid, OpenState{new_state, timestamp_ns});
   return slice;
 }
 
 std::vector<ThreadStateSlice> ThreadStateManager::OnCaptureFinished(uint64_t timestamp_ns) {
   std::vector<ThreadStateSlice> slices;
-  for (const auto& [tid, open_state] : tid_open_states_) {
+  slices.reserve(tid_open_states_.size());
+  tid_open_states_.ForEach([timestamp_ns, &slices](pid_t tid, const OpenState& open_state) {
     ThreadStateSlice slice;
     slice.set_tid(tid);
     slice.set_thread_state(open_state.state);
     slice.set_duration_ns(timestamp_ns - open_state.begin_timestamp_ns);
     slice.set_end_timestamp_ns(timestamp_ns);
     slices.emplace_back(std::move(slice));
-  }
+  });
   return slices;
 }
 
@@ -12,7 +12,7 @@
 #include <vector>
 
 #include "OrbitBase/Logging.h"
-#include "absl/container/flat_hash_map.h"
+#include "TidIndexedTable.h"
 #include "capture.pb.h"
 
 namespace orbit_linux_tracing {
@@ -66,7 +66,9 @@ class ThreadStateManager {
     uint64_t begin_timestamp_ns;
   };
 
-  absl::flat_hash_map<pid_t, OpenState> tid_open_states_;
+  // Looked up on every sched:sched_switch and sched:sched_wakeup of the threads of the target
+  // process, hence a dense table instead of a hash map.
+  TidIndexedTable<OpenState> tid_open_states_;
 };
 
 }  // namespace orbit_linux_tracing
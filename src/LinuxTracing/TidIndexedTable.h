@@ -0,0 +1,91 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_TID_INDEXED_TABLE_H_
+#define LINUX_TRACING_TID_INDEXED_TABLE_H_
+
+#include <sys/types.h>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace orbit_linux_tracing {
+
+enum class TidInsertOrAssignResult { kInserted, kAssigned, kInvalidTid };
+
+// Associative container from thread ids to values of type T, meant to replace hash maps on paths
+// that are hit for every scheduling event. Thread ids are small non-negative integers (bounded by
+// /proc/sys/kernel/pid_max), so the table is a vector indexed directly by tid. To keep the memory
+// proportional to the ranges of tids actually seen (pid_max can be as large as 2^22), the vector is
+// split into pages of kPageSize entries that are only allocated when a tid in their range is first
+// inserted. Lookups are two indexing operations, with no hashing and no probing.
+// Negative tids are never stored.
+template <typename T>
+class TidIndexedTable {
+ public:
+  [[nodiscard]] T* Find(pid_t tid) {
+    std::optional<T>* entry = FindEntry(tid);
+    if (entry == nullptr || !entry->has_value()) return nullptr;
+    return &entry->value();
+  }
+
+  [[nodiscard]] const T* Find(pid_t tid) const {
+    return const_cast<TidIndexedTable*>(this)->Find(tid);
+  }
+
+  [[nodiscard]] bool Contains(pid_t tid) const { return Find(tid) != nullptr; }
+
+  // Returns whether `tid` was newly inserted or already in the table, or kInvalidTid (and does
+  // nothing) if `tid` is negative.
+  TidInsertOrAssignResult InsertOrAssign(pid_t tid, T value) {
+    if (tid < 0) return TidInsertOrAssignResult::kInvalidTid;
+    const auto page_index = static_cast<size_t>(tid) / kPageSize;
+    if (page_index >= pages_.size()) pages_.resize(page_index + 1);
+    if (pages_[page_index] == nullptr) pages_[page_index] = std::make_unique<Page>();
+    std::optional<T>& entry = (*pages_[page_index])[static_cast<size_t>(tid) % kPageSize];
+    const bool inserted = !entry.has_value();
+    entry = std::move(value);
+    if (!inserted) return TidInsertOrAssignResult::kAssigned;
+    ++size_;
+    return TidInsertOrAssignResult::kInserted;
+  }
+
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size_ == 0; }
+
+  // Calls `visitor(tid, value)` for every entry, in increasing order of tid.
+  template <typename Visitor>
+  void ForEach(Visitor&& visitor) const {
+    for (size_t page_index = 0; page_index < pages_.size(); ++page_index) {
+      if (pages_[page_index] == nullptr) continue;
+      const Page& page = *pages_[page_index];
+      for (size_t offset = 0; offset < kPageSize; ++offset) {
+        if (!page[offset].has_value()) continue;
+        visitor(static_cast<pid_t>(page_index * kPageSize + offset), page[offset].value());
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kPageSize = 1024;
+  using Page = std::array<std::optional<T>, kPageSize>;
+
+  [[nodiscard]] std::optional<T>* FindEntry(pid_t tid) {
+    if (tid < 0) return nullptr;
+    const auto page_index = static_cast<size_t>(tid) / kPageSize;
+    if (page_index >= pages_.size() || pages_[page_index] == nullptr) return nullptr;
+    return &(*pages_[page_index])[static_cast<size_t>(tid) % kPageSize];
+  }
+
+  std::vector<std::unique_ptr<Page>> pages_;
+  size_t size_ = 0;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_TID_INDEXED_TABLE_H_
@@ -0,0 +1,62 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <sys/types.h>
+
+#include <utility>
+#include <vector>
+
+#include "TidIndexedTable.h"
+
+namespace orbit_linux_tracing {
+
+TEST(TidIndexedTable, FindInsertOrAssign) {
+  TidIndexedTable<int> table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.Find(42), nullptr);
+
+  EXPECT_EQ(table.InsertOrAssign(42, 1), TidInsertOrAssignResult::kInserted);
+  ASSERT_NE(table.Find(42), nullptr);
+  EXPECT_EQ(*table.Find(42), 1);
+  EXPECT_EQ(table.size(), 1);
+
+  EXPECT_EQ(table.InsertOrAssign(42, 2), TidInsertOrAssignResult::kAssigned);
+  EXPECT_EQ(*table.Find(42), 2);
+  EXPECT_EQ(table.size(), 1);
+
+  *table.Find(42) = 3;
+  EXPECT_EQ(*table.Find(42), 3);
+
+  EXPECT_FALSE(table.Contains(41));
+  EXPECT_FALSE(table.Contains(43));
+}
+
+TEST(TidIndexedTable, LargeAndNegativeTids) {
+  constexpr pid_t kLargeTid = 4'194'000;
+  TidIndexedTable<int> table;
+  EXPECT_EQ(table.InsertOrAssign(0, 1), TidInsertOrAssignResult::kInserted);
+  EXPECT_EQ(table.InsertOrAssign(kLargeTid, 2), TidInsertOrAssignResult::kInserted);
+  EXPECT_EQ(*table.Find(0), 1);
+  EXPECT_EQ(*table.Find(kLargeTid), 2);
+  EXPECT_FALSE(table.Contains(kLargeTid - 1));
+  EXPECT_FALSE(table.Contains(kLargeTid * 2));
+
+  EXPECT_EQ(table.InsertOrAssign(-1, 3), TidInsertOrAssignResult::kInvalidTid);
+  EXPECT_FALSE(table.Contains(-1));
+  EXPECT_EQ(table.size(), 2);
+}
+
+TEST(TidIndexedTable, ForEachVisitsInTidOrder) {
+  TidIndexedTable<int> table;
+  table.InsertOrAssign(5000, 3);
+  table.InsertOrAssign(7, 1);
+  table.InsertOrAssign(1023, 2);
+
+  std::vector<std::pair<pid_t, int>> visited;
+  table.ForEach([&visited](pid_t tid, int value) { visited.emplace_back(tid, value); });
+  EXPECT_EQ(visited, (std::vector<std::pair<pid_t, int>>{{7, 1}, {1023, 2}, {5000, 3}}));
+}
+
+}  // namespace orbit_linux_tracing
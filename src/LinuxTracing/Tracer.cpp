@@ -4,10 +4,12 @@
 
 #include "LinuxTracing/Tracer.h"
 
+#include <google/protobuf/util/message_differencer.h>
 #include <pthread.h>
 
 #include <atomic>
 #include <memory>
+#include <utility>
 
 #include "LinuxTracing/TracerListener.h"
 #include "TracerThread.h"
@@ -15,11 +17,41 @@
 
 namespace orbit_linux_tracing {
 
+Tracer::Tracer(orbit_grpc_protos::CaptureOptions capture_options)
+    : capture_options_{std::move(capture_options)},
+      session_{std::make_unique<TracerThread>(capture_options_)} {}
+
+// Destroying session_ closes the file descriptors even if they were kept armed by Stop.
+Tracer::~Tracer() { Stop(); }
+
+bool Tracer::IsArmed() const { return thread_ == nullptr && session_->ArePerfEventsOpen(); }
+
+bool Tracer::IsArmedFor(const orbit_grpc_protos::CaptureOptions& capture_options) const {
+  return IsArmed() &&
+         google::protobuf::util::MessageDifferencer::Equals(capture_options_, capture_options);
+}
+
+void Tracer::Start() {
+  *exit_requested_ = false;
+  thread_ = std::make_shared<std::thread>(&Tracer::Run, this);
+}
+
+void Tracer::Stop() {
+  *exit_requested_ = true;
+  if (thread_ != nullptr && thread_->joinable()) {
+    thread_->join();
+  }
+  thread_.reset();
+
+  if (!keep_armed_after_stop_) {
+    session_->ClosePerfEvents();
+  }
+}
+
 void Tracer::Run() {
   pthread_setname_np(pthread_self(), "Tracer::Run");
-  TracerThread session{capture_options_};
-  session.SetListener(listener_);
-  session.Run(exit_requested_);
+  session_->SetListener(listener_);
+  session_->Run(exit_requested_);
 }
 
 }  // namespace orbit_linux_tracing
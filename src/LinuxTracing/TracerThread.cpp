@@ -22,7 +22,10 @@
 #include <utility>
 
 #include "Function.h"
+#include "GrpcProtos/Constants.h"
 #include "Introspection/Introspection.h"
+#include "JitSymbolMap.h"
+#include "JitSymbolsReader.h"
 #include "LibunwindstackMaps.h"
 #include "LibunwindstackUnwinder.h"
 #include "LinuxTracing/TracerListener.h"
@@ -43,24 +46,29 @@ namespace orbit_linux_tracing {
 using orbit_base::GetAllPids;
 using orbit_base::GetTidsOfProcess;
 using orbit_grpc_protos::CaptureOptions;
+using orbit_grpc_protos::FunctionCall;
 using orbit_grpc_protos::InstrumentedFunction;
 using orbit_grpc_protos::ModuleInfo;
 using orbit_grpc_protos::ModulesSnapshot;
 using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadNamesSnapshot;
+using orbit_grpc_protos::kMaxStackDumpSize;
 
 TracerThread::TracerThread(const CaptureOptions& capture_options)
     : trace_context_switches_{capture_options.trace_context_switches()},
       target_pid_{capture_options.pid()},
       unwinding_method_{capture_options.unwinding_method()},
       trace_thread_state_{capture_options.trace_thread_state()},
-      trace_gpu_driver_{capture_options.trace_gpu_driver()} {
+      trace_gpu_driver_{capture_options.trace_gpu_driver()},
+      function_call_coalescing_threshold_ns_{
+          capture_options.function_call_coalescing_threshold_ns()},
+      function_call_coalescing_max_gap_ns_{capture_options.function_call_coalescing_max_gap_ns()} {
   if (unwinding_method_ != CaptureOptions::kUndefined) {
     uint32_t stack_dump_size = capture_options.stack_dump_size();
-    if (stack_dump_size > kMaxStackSampleUserSize || stack_dump_size == 0) {
+    if (stack_dump_size > kMaxStackDumpSize || stack_dump_size == 0) {
       ERROR("Invalid sample stack dump size: %u; Reassigning to default: %u", stack_dump_size,
-            kMaxStackSampleUserSize);
-      stack_dump_size = kMaxStackSampleUserSize;
+            kMaxStackDumpSize);
+      stack_dump_size = kMaxStackDumpSize;
     }
     stack_dump_size_ = static_cast<uint16_t>(stack_dump_size);
     std::optional<uint64_t> sampling_period_ns =
@@ -113,14 +121,30 @@ void CloseFileDescriptors(const absl::flat_hash_map<int32_t, int>& fds_per_cpu)
 
 void TracerThread::InitUprobesEventVisitor() {
   ORBIT_SCOPE_FUNCTION;
-  maps_ = LibunwindstackMaps::ParseMaps(ReadMaps(target_pid_));
+  std::string proc_maps_data = ReadMaps(target_pid_);
+  maps_ = LibunwindstackMaps::ParseMaps(proc_maps_data);
   unwinder_ = LibunwindstackUnwinder::Create();
   leaf_function_call_manager_ = std::make_unique<LeafFunctionCallManager>(stack_dump_size_);
   uprobes_unwinding_visitor_ = std::make_unique<UprobesUnwindingVisitor>(
-      listener_, &function_call_manager_, &return_address_manager_, maps_.get(), unwinder_.get(),
-      leaf_function_call_manager_.get());
+      batching_listener_.get(), &function_call_manager_, &return_address_manager_, maps_.get(),
+      unwinder_.get(), leaf_function_call_manager_.get());
   uprobes_unwinding_visitor_->SetUnwindErrorsAndDiscardedSamplesCounters(
       &stats_.unwind_error_count, &stats_.samples_in_uretprobes_count);
+  unwinding_errors_aggregator_ = std::make_unique<UnwindingErrorsAggregator>();
+  uprobes_unwinding_visitor_->SetUnwindingErrorsAggregator(unwinding_errors_aggregator_.get());
+  if (function_call_coalescing_threshold_ns_ > 0) {
+    function_call_coalescer_ = std::make_unique<FunctionCallCoalescer>(
+        function_call_coalescing_threshold_ns_, function_call_coalescing_max_gap_ns_);
+    uprobes_unwinding_visitor_->SetFunctionCallCoalescer(function_call_coalescer_.get());
+  }
+  jit_symbol_map_ = std::make_unique<JitSymbolMap>();
+  jit_symbols_reader_ = std::make_unique<JitSymbolsReader>(
+      target_pid_, JitSymbolsReader::GetPerfMapPath(target_pid_), jit_symbol_map_.get());
+  jit_symbols_reader_->FindJitdumpFileInMaps(proc_maps_data);
+  uprobes_unwinding_visitor_->SetJitSymbolMap(jit_symbol_map_.get());
+  // JitSymbolsReader needs to be visited before UprobesUnwindingVisitor, which ignores the
+  // PERF_RECORD_MMAP of the jitdump file.
+  event_processor_.AddVisitor(jit_symbols_reader_.get());
   event_processor_.AddVisitor(uprobes_unwinding_visitor_.get());
 }
 
@@ -444,7 +468,8 @@ bool TracerThread::OpenThreadNameTracepoints(const std::vector<int32_t>& cpus) {
 
 void TracerThread::InitSwitchesStatesNamesVisitor() {
   ORBIT_SCOPE_FUNCTION;
-  switches_states_names_visitor_ = std::make_unique<SwitchesStatesNamesVisitor>(listener_);
+  switches_states_names_visitor_ =
+      std::make_unique<SwitchesStatesNamesVisitor>(batching_listener_.get());
   switches_states_names_visitor_->SetProduceSchedulingSlices(trace_context_switches_);
   if (trace_thread_state_) {
     switches_states_names_visitor_->SetThreadStatePidFilter(target_pid_);
@@ -476,7 +501,7 @@ bool TracerThread::OpenContextSwitchAndThreadStateTracepoints(const std::vector<
 
 void TracerThread::InitGpuTracepointEventVisitor() {
   ORBIT_SCOPE_FUNCTION;
-  gpu_event_visitor_ = std::make_unique<GpuTracepointVisitor>(listener_);
+  gpu_event_visitor_ = std::make_unique<GpuTracepointVisitor>(batching_listener_.get());
   event_processor_.AddVisitor(gpu_event_visitor_.get());
 }
 
@@ -525,7 +550,8 @@ bool TracerThread::OpenInstrumentedTracepoints(const std::vector<int32_t>& cpus)
 
 void TracerThread::InitLostAndDiscardedEventVisitor() {
   ORBIT_SCOPE_FUNCTION;
-  lost_and_discarded_event_visitor_ = std::make_unique<LostAndDiscardedEventVisitor>(listener_);
+  lost_and_discarded_event_visitor_ =
+      std::make_unique<LostAndDiscardedEventVisitor>(batching_listener_.get());
   event_processor_.AddVisitor(lost_and_discarded_event_visitor_.get());
 }
 
@@ -550,9 +576,9 @@ static std::vector<ThreadName> RetrieveInitialThreadNamesSystemWide(uint64_t ini
   return thread_names;
 }
 
-void TracerThread::Startup() {
+void TracerThread::OpenPerfEvents() {
   ORBIT_SCOPE_FUNCTION;
-  Reset();
+  ClosePerfEvents();
 
   // perf_event_open refers to cores as "CPUs".
 
@@ -577,77 +603,142 @@ void TracerThread::Startup() {
   // cpu per instrumented function, increase the maximum number of open files.
   SetMaxOpenFilesSoftLimit(GetMaxOpenFilesHardLimit());
 
-  event_processor_.SetDiscardedOutOfOrderCounter(&stats_.discarded_out_of_order_count);
-
-  InitLostAndDiscardedEventVisitor();
-
-  bool perf_event_open_errors = false;
-  std::vector<std::string> perf_event_open_error_details;
-
   if (bool opened = OpenMmapTask(all_cpus); !opened) {
-    perf_event_open_error_details.emplace_back("mmap events, fork and exit events");
-    perf_event_open_errors = true;
+    perf_event_open_error_details_.emplace_back("mmap events, fork and exit events");
   }
 
   if (!instrumented_functions_.empty()) {
     if (bool opened = OpenUserSpaceProbes(cpuset_cpus); !opened) {
-      perf_event_open_error_details.emplace_back("u(ret)probes");
-      perf_event_open_errors = true;
+      perf_event_open_error_details_.emplace_back("u(ret)probes");
     }
   }
 
-  // This takes an initial snapshot of the maps. Note that, if at least one
-  // function is dynamically instrumented, the snapshot might or might not
-  // already contain the [uprobes] map entry. This depends on whether at least
-  // one of those functions has already been called after the corresponding
-  // uprobes file descriptor has been opened by OpenUserSpaceProbes (opening is
-  // enough, it doesn't need to have been enabled).
-  InitUprobesEventVisitor();
-
   if (unwinding_method_ == CaptureOptions::kFramePointers ||
       unwinding_method_ == CaptureOptions::kDwarf) {
     if (bool opened = OpenSampling(cpuset_cpus); !opened) {
-      perf_event_open_error_details.emplace_back("sampling");
-      perf_event_open_errors = true;
+      perf_event_open_error_details_.emplace_back("sampling");
     }
   }
 
-  InitSwitchesStatesNamesVisitor();
   if (bool opened = OpenThreadNameTracepoints(all_cpus); !opened) {
-    perf_event_open_error_details.emplace_back(
+    perf_event_open_error_details_.emplace_back(
         "task:task_newtask and task:task_rename tracepoints");
-    perf_event_open_errors = true;
   }
   if (trace_context_switches_ || trace_thread_state_) {
     if (bool opened = OpenContextSwitchAndThreadStateTracepoints(all_cpus); !opened) {
-      perf_event_open_error_details.emplace_back(
+      perf_event_open_error_details_.emplace_back(
           "sched:sched_switch and sched:sched_wakeup tracepoints");
-      perf_event_open_errors = true;
     }
   }
 
   if (trace_gpu_driver_) {
     // We want to trace all GPU activity, hence we pass 'all_cpus' here.
-    if (OpenGpuTracepoints(all_cpus)) {
-      InitGpuTracepointEventVisitor();
-    } else {
+    gpu_tracepoints_open_ = OpenGpuTracepoints(all_cpus);
+    if (!gpu_tracepoints_open_) {
       LOG("There were errors opening GPU tracepoint events");
     }
   }
 
   if (bool opened = OpenInstrumentedTracepoints(all_cpus); !opened) {
-    perf_event_open_error_details.emplace_back("selected tracepoints");
-    perf_event_open_errors = true;
+    perf_event_open_error_details_.emplace_back("selected tracepoints");
   }
 
-  if (perf_event_open_errors) {
+  if (!perf_event_open_error_details_.empty()) {
     ERROR("With perf_event_open: did you forget to run as root?");
     LOG("In particular, there were errors with opening %s",
-        absl::StrJoin(perf_event_open_error_details, ", "));
+        absl::StrJoin(perf_event_open_error_details_, ", "));
+  }
+
+  perf_events_open_ = true;
+}
+
+void TracerThread::ClosePerfEvents() {
+  ORBIT_SCOPE_FUNCTION;
+  if (!perf_events_open_) return;
+
+  // Close the ring buffers.
+  {
+    ORBIT_SCOPE("ring_buffers_.clear()");
+    ring_buffers_.clear();
+  }
+
+  // Close the file descriptors.
+  {
+    ORBIT_SCOPE_WITH_COLOR(
+        absl::StrFormat("Closing %d file descriptors", tracing_fds_.size()).c_str(),
+        kOrbitColorRed);
+    SCOPED_TIMED_LOG("Closing %d file descriptors", tracing_fds_.size());
+    for (int fd : tracing_fds_) {
+      ORBIT_SCOPE("Closing fd");
+      close(fd);
+    }
+  }
+  tracing_fds_.clear();
+
+  uprobes_uretprobes_ids_to_function_.clear();
+  uprobes_ids_.clear();
+  uretprobes_ids_.clear();
+  stack_sampling_ids_.clear();
+  callchain_sampling_ids_.clear();
+  task_newtask_ids_.clear();
+  task_rename_ids_.clear();
+  sched_switch_ids_.clear();
+  sched_wakeup_ids_.clear();
+  amdgpu_cs_ioctl_ids_.clear();
+  amdgpu_sched_run_job_ids_.clear();
+  dma_fence_signaled_ids_.clear();
+  ids_to_tracepoint_info_.clear();
+
+  gpu_tracepoints_open_ = false;
+  perf_event_open_error_details_.clear();
+  perf_events_open_ = false;
+}
+
+void TracerThread::DiscardRingBuffersContent() {
+  ORBIT_SCOPE_FUNCTION;
+  for (PerfEventRingBuffer& ring_buffer : ring_buffers_) {
+    while (ring_buffer.HasNewData()) {
+      perf_event_header header;
+      ring_buffer.ReadHeader(&header);
+      ring_buffer.SkipRecord(header);
+    }
+  }
+}
+
+void TracerThread::Startup() {
+  ORBIT_SCOPE_FUNCTION;
+  Reset();
+
+  if (perf_events_open_) {
+    // The perf events were kept open, disabled, since a previous capture. Their ring buffers can
+    // still contain the records that arrived after that capture stopped reading them.
+    DiscardRingBuffersContent();
+  } else {
+    OpenPerfEvents();
+  }
+
+  batching_listener_ = std::make_unique<BatchingTracerListener>(listener_);
+
+  event_processor_.SetDiscardedOutOfOrderCounter(&stats_.discarded_out_of_order_count);
+
+  InitLostAndDiscardedEventVisitor();
+  // This takes an initial snapshot of the maps. Note that, if at least one
+  // function is dynamically instrumented, the snapshot might or might not
+  // already contain the [uprobes] map entry. This depends on whether at least
+  // one of those functions has already been called after the corresponding
+  // uprobes file descriptor has been opened by OpenUserSpaceProbes (opening is
+  // enough, it doesn't need to have been enabled).
+  InitUprobesEventVisitor();
+  InitSwitchesStatesNamesVisitor();
+  if (gpu_tracepoints_open_) {
+    InitGpuTracepointEventVisitor();
+  }
+
+  if (!perf_event_open_error_details_.empty()) {
     orbit_grpc_protos::ErrorsWithPerfEventOpenEvent errors_with_perf_event_open_event;
     errors_with_perf_event_open_event.set_timestamp_ns(orbit_base::CaptureTimestampNs());
-    for (std::string& detail : perf_event_open_error_details) {
-      errors_with_perf_event_open_event.add_failed_to_open(std::move(detail));
+    for (const std::string& detail : perf_event_open_error_details_) {
+      errors_with_perf_event_open_event.add_failed_to_open(detail);
     }
     listener_->OnErrorsWithPerfEventOpenEvent(std::move(errors_with_perf_event_open_event));
   }
@@ -702,28 +793,11 @@ void TracerThread::Shutdown() {
     switches_states_names_visitor_->ProcessRemainingOpenStates(orbit_base::CaptureTimestampNs());
   }
 
-  // Stop recording.
+  // Stop recording. The file descriptors are only closed by ClosePerfEvents, so that they can be
+  // enabled again by the next capture.
   for (int fd : tracing_fds_) {
     perf_event_disable(fd);
   }
-
-  // Close the ring buffers.
-  {
-    ORBIT_SCOPE("ring_buffers_.clear()");
-    ring_buffers_.clear();
-  }
-
-  // Close the file descriptors.
-  {
-    ORBIT_SCOPE_WITH_COLOR(
-        absl::StrFormat("Closing %d file descriptors", tracing_fds_.size()).c_str(),
-        kOrbitColorRed);
-    SCOPED_TIMED_LOG("Closing %d file descriptors", tracing_fds_.size());
-    for (int fd : tracing_fds_) {
-      ORBIT_SCOPE("Closing fd");
-      close(fd);
-    }
-  }
 }
 
 void TracerThread::ProcessOneRecord(PerfEventRingBuffer* ring_buffer) {
@@ -799,6 +873,11 @@ void TracerThread::Run(const std::shared_ptr<std::atomic<bool>>& exit_requested)
 
     last_iteration_saw_events = false;
 
+    // Ring buffers found empty in this iteration are considered read up to kProcessingDelayMs
+    // before this, see ComputeRingBufferWatermarkNs.
+    uint64_t iteration_start_timestamp_ns = orbit_base::CaptureTimestampNs();
+    uint64_t watermark_ns = std::numeric_limits<uint64_t>::max();
+
     // Read and process events from all ring buffers. In order to ensure that no
     // buffer is read constantly while others overflow, we schedule the reading
     // using round-robin like scheduling.
@@ -811,25 +890,57 @@ void TracerThread::Run(const std::shared_ptr<std::atomic<bool>>& exit_requested)
       // TODO: Some event types (e.g., stack samples) have a much longer
       //  processing time but are less frequent than others (e.g., context
       //  switches). Take this into account in our scheduling algorithm.
+      bool ring_buffer_is_empty = false;
       for (int32_t read_from_this_buffer = 0;
            read_from_this_buffer < ROUND_ROBIN_POLLING_BATCH_SIZE; ++read_from_this_buffer) {
         if (*exit_requested) {
           break;
         }
         if (!ring_buffer.HasNewData()) {
+          ring_buffer_is_empty = true;
           break;
         }
 
         last_iteration_saw_events = true;
         ProcessOneRecord(&ring_buffer);
       }
+
+      std::optional<uint64_t> last_record_timestamp_ns;
+      if (auto it = fds_to_last_timestamp_ns_.find(ring_buffer.GetFileDescriptor());
+          it != fds_to_last_timestamp_ns_.end()) {
+        last_record_timestamp_ns = it->second;
+      }
+      watermark_ns = std::min(
+          watermark_ns, ComputeRingBufferWatermarkNs(last_record_timestamp_ns, ring_buffer_is_empty,
+                                                     iteration_start_timestamp_ns));
+    }
+
+    if (!trace_gpu_driver_ && !(*exit_requested) && !ring_buffers_.empty()) {
+      UpdateDeferredEventsWatermark(watermark_ns);
     }
   }
 
   // Finish processing all deferred events.
   stop_deferred_thread_ = true;
   deferred_events_thread.join();
+  jit_symbols_reader_->ReadNewSymbols(orbit_base::CaptureTimestampNs());
   event_processor_.ProcessAllEvents();
+  batching_listener_->Flush();
+
+  // Summarize the unwinding errors of the whole capture, so that the client can suggest better
+  // unwinding settings.
+  if (unwinding_errors_aggregator_ != nullptr &&
+      unwinding_errors_aggregator_->GetTotalSamplesCount() > 0) {
+    listener_->OnUnwindingErrorsSummaryEvent(unwinding_errors_aggregator_->CreateSummaryEvent(
+        orbit_base::CaptureTimestampNs(), target_pid_, unwinding_method_, stack_dump_size_));
+  }
+
+  // Send the FunctionCalls that were still waiting to be coalesced with a next call.
+  if (function_call_coalescer_ != nullptr) {
+    for (FunctionCall& function_call : function_call_coalescer_->Flush()) {
+      listener_->OnFunctionCall(std::move(function_call));
+    }
+  }
 
   Shutdown();
 }
@@ -1129,37 +1240,60 @@ void TracerThread::DeferEvent(std::unique_ptr<PerfEvent> event) {
   deferred_events_.emplace_back(std::move(event));
 }
 
-std::vector<std::unique_ptr<PerfEvent>> TracerThread::ConsumeDeferredEvents() {
+void TracerThread::UpdateDeferredEventsWatermark(uint64_t watermark_ns) {
+  // The events read before computing the watermark have already been deferred, so that the
+  // deferred events and the watermark are consistent when consumed together.
+  std::lock_guard<std::mutex> lock(deferred_events_mutex_);
+  deferred_events_watermark_ns_ = std::max(deferred_events_watermark_ns_, watermark_ns);
+}
+
+std::vector<std::unique_ptr<PerfEvent>> TracerThread::ConsumeDeferredEvents(
+    uint64_t* watermark_ns) {
   std::lock_guard<std::mutex> lock(deferred_events_mutex_);
   std::vector<std::unique_ptr<PerfEvent>> events(std::move(deferred_events_));
   deferred_events_.clear();
+  *watermark_ns = deferred_events_watermark_ns_;
   return events;
 }
 
 void TracerThread::ProcessDeferredEvents() {
   pthread_setname_np(pthread_self(), "Proc.Def.Events");
   bool should_exit = false;
+  uint64_t last_watermark_ns = 0;
   while (!should_exit) {
     ORBIT_SCOPE("ProcessDeferredEvents iteration");
     // When "should_exit" becomes true, we know that we have stopped generating
     // deferred events. The last iteration will consume all remaining events.
     should_exit = stop_deferred_thread_;
-    std::vector<std::unique_ptr<PerfEvent>> events = ConsumeDeferredEvents();
-    if (events.empty()) {
+    uint64_t watermark_ns = 0;
+    std::vector<std::unique_ptr<PerfEvent>> events = ConsumeDeferredEvents(&watermark_ns);
+    if (events.empty() && watermark_ns == last_watermark_ns) {
       // TODO: use a wait/notify mechanism instead of check/sleep.
       ORBIT_SCOPE("Sleep");
       usleep(IDLE_TIME_ON_EMPTY_DEFERRED_EVENTS_US);
     } else {
+      {
+        // Only the symbols that JIT compilers have written so far can be used for the events
+        // processed below.
+        ORBIT_SCOPE("ReadNewJitSymbols");
+        jit_symbols_reader_->ReadNewSymbols(orbit_base::CaptureTimestampNs());
+      }
       {
         ORBIT_SCOPE("AddEvents");
         for (auto& event : events) {
           event_processor_.AddEvent(std::move(event));
         }
       }
+      event_processor_.SetWatermark(watermark_ns);
+      last_watermark_ns = watermark_ns;
       {
         ORBIT_SCOPE("ProcessOldEvents");
         event_processor_.ProcessOldEvents();
       }
+      // No event older than the last processed one will be processed any more.
+      uprobes_unwinding_visitor_->OnJitSymbolsRemoved(jit_symbol_map_->RemoveSymbolsUnloadedBefore(
+          event_processor_.GetLastProcessedTimestampNs()));
+      batching_listener_->Flush();
     }
   }
 }
@@ -1185,32 +1319,24 @@ void TracerThread::RetrieveInitialThreadStatesOfTarget() {
 
 void TracerThread::Reset() {
   ORBIT_SCOPE_FUNCTION;
-  tracing_fds_.clear();
-  ring_buffers_.clear();
   fds_to_last_timestamp_ns_.clear();
-
-  uprobes_uretprobes_ids_to_function_.clear();
-  uprobes_ids_.clear();
-  uretprobes_ids_.clear();
-  stack_sampling_ids_.clear();
-  callchain_sampling_ids_.clear();
-  task_newtask_ids_.clear();
-  task_rename_ids_.clear();
-  sched_switch_ids_.clear();
-  sched_wakeup_ids_.clear();
-  amdgpu_cs_ioctl_ids_.clear();
-  amdgpu_sched_run_job_ids_.clear();
-  dma_fence_signaled_ids_.clear();
-  ids_to_tracepoint_info_.clear();
+  deferred_events_watermark_ns_ = 0;
 
   effective_capture_start_timestamp_ns_ = 0;
 
   stop_deferred_thread_ = false;
   deferred_events_.clear();
   uprobes_unwinding_visitor_.reset();
+  unwinding_errors_aggregator_.reset();
+  jit_symbols_reader_.reset();
+  jit_symbol_map_.reset();
+  function_call_coalescer_.reset();
   switches_states_names_visitor_.reset();
   gpu_event_visitor_.reset();
-  event_processor_.ClearVisitors();
+  lost_and_discarded_event_visitor_.reset();
+  function_call_manager_ = UprobesFunctionCallManager{};
+  return_address_manager_ = UprobesReturnAddressManager{};
+  event_processor_ = PerfEventProcessor{};
 }
 
 void TracerThread::PrintStatsIfTimerElapsed() {
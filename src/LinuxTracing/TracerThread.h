@@ -17,11 +17,16 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 #include <vector>
 
+#include "BatchingTracerListener.h"
 #include "ContextSwitchManager.h"
 #include "Function.h"
+#include "FunctionCallCoalescer.h"
 #include "GpuTracepointVisitor.h"
+#include "JitSymbolMap.h"
+#include "JitSymbolsReader.h"
 #include "LinuxTracing/TracerListener.h"
 #include "LinuxTracingUtils.h"
 #include "LostAndDiscardedEventVisitor.h"
@@ -31,6 +36,7 @@
 #include "PerfEventProcessor.h"
 #include "PerfEventRingBuffer.h"
 #include "SwitchesStatesNamesVisitor.h"
+#include "UnwindingErrorsAggregator.h"
 #include "UprobesUnwindingVisitor.h"
 #include "capture.pb.h"
 
@@ -39,6 +45,7 @@ namespace orbit_linux_tracing {
 class TracerThread {
  public:
   explicit TracerThread(const orbit_grpc_protos::CaptureOptions& capture_options);
+  ~TracerThread() { ClosePerfEvents(); }
 
   TracerThread(const TracerThread&) = delete;
   TracerThread& operator=(const TracerThread&) = delete;
@@ -47,6 +54,14 @@ class TracerThread {
 
   void SetListener(TracerListener* listener) { listener_ = listener; }
 
+  // Opens the perf_event_open file descriptors and ring buffers for the capture options, without
+  // enabling them. Run calls this if the file descriptors are not open yet. As they are only
+  // disabled, and not closed, at the end of Run, they can be kept open between captures, so that
+  // starting the next capture only requires enabling them.
+  void OpenPerfEvents();
+  void ClosePerfEvents();
+  [[nodiscard]] bool ArePerfEventsOpen() const { return perf_events_open_; }
+
   void Run(const std::shared_ptr<std::atomic<bool>>& exit_requested);
 
  private:
@@ -61,6 +76,7 @@ class TracerThread {
 
   void Startup();
   void Shutdown();
+  void DiscardRingBuffersContent();
   void ProcessOneRecord(PerfEventRingBuffer* ring_buffer);
   void InitUprobesEventVisitor();
   bool OpenUserSpaceProbes(const std::vector<int32_t>& cpus);
@@ -105,8 +121,11 @@ class TracerThread {
       const perf_event_header& header, PerfEventRingBuffer* ring_buffer);
 
   void DeferEvent(std::unique_ptr<PerfEvent> event);
-  std::vector<std::unique_ptr<PerfEvent>> ConsumeDeferredEvents();
+  // Returns the deferred events and, in `watermark_ns`, the timestamp up to which all ring buffers
+  // had been read when the last of those events was deferred.
+  std::vector<std::unique_ptr<PerfEvent>> ConsumeDeferredEvents(uint64_t* watermark_ns);
   void ProcessDeferredEvents();
+  void UpdateDeferredEventsWatermark(uint64_t watermark_ns);
 
   void RetrieveInitialTidToPidAssociationSystemWide();
   void RetrieveInitialThreadStatesOfTarget();
@@ -142,10 +161,18 @@ class TracerThread {
   ManualInstrumentationConfig manual_instrumentation_config_;
   bool trace_thread_state_;
   bool trace_gpu_driver_;
+  uint64_t function_call_coalescing_threshold_ns_;
+  uint64_t function_call_coalescing_max_gap_ns_;
   std::vector<orbit_grpc_protos::TracepointInfo> instrumented_tracepoints_;
 
   TracerListener* listener_ = nullptr;
+  // The PerfEventVisitors report to this listener, which passes their events to listener_ in
+  // batches.
+  std::unique_ptr<BatchingTracerListener> batching_listener_;
 
+  bool perf_events_open_ = false;
+  bool gpu_tracepoints_open_ = false;
+  std::vector<std::string> perf_event_open_error_details_;
   std::vector<int> tracing_fds_;
   std::vector<PerfEventRingBuffer> ring_buffers_;
   absl::flat_hash_map<int, uint64_t> fds_to_last_timestamp_ns_;
@@ -168,6 +195,9 @@ class TracerThread {
 
   std::atomic<bool> stop_deferred_thread_ = false;
   std::vector<std::unique_ptr<PerfEvent>> deferred_events_;
+  // Only used when no GPU tracepoints are traced, as those events can arrive arbitrarily late even
+  // relative to the other events in their own ring buffer.
+  uint64_t deferred_events_watermark_ns_ = 0;
   std::mutex deferred_events_mutex_;
 
   UprobesFunctionCallManager function_call_manager_;
@@ -175,7 +205,11 @@ class TracerThread {
   std::unique_ptr<LibunwindstackMaps> maps_;
   std::unique_ptr<LibunwindstackUnwinder> unwinder_;
   std::unique_ptr<LeafFunctionCallManager> leaf_function_call_manager_;
+  std::unique_ptr<FunctionCallCoalescer> function_call_coalescer_;
   std::unique_ptr<UprobesUnwindingVisitor> uprobes_unwinding_visitor_;
+  std::unique_ptr<UnwindingErrorsAggregator> unwinding_errors_aggregator_;
+  std::unique_ptr<JitSymbolMap> jit_symbol_map_;
+  std::unique_ptr<JitSymbolsReader> jit_symbols_reader_;
   std::unique_ptr<SwitchesStatesNamesVisitor> switches_states_names_visitor_;
   std::unique_ptr<GpuTracepointVisitor> gpu_event_visitor_;
   std::unique_ptr<LostAndDiscardedEventVisitor> lost_and_discarded_event_visitor_;
@@ -0,0 +1,120 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "UnwindingErrorsAggregator.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace orbit_linux_tracing {
+
+namespace {
+constexpr std::string_view kUnknownModulePath = "[unknown]";
+
+// Returns the entries of `map` with the largest `get_count`, at most `max_entries`, in decreasing
+// order of count.
+template <typename Map, typename GetCount>
+std::vector<typename Map::const_pointer> GetTopEntries(const Map& map, size_t max_entries,
+                                                       GetCount get_count) {
+  std::vector<typename Map::const_pointer> entries;
+  entries.reserve(map.size());
+  for (const auto& entry : map) {
+    if (get_count(entry.second) > 0) entries.push_back(&entry);
+  }
+  auto compare = [&get_count](typename Map::const_pointer lhs, typename Map::const_pointer rhs) {
+    uint64_t lhs_count = get_count(lhs->second);
+    uint64_t rhs_count = get_count(rhs->second);
+    // Break ties by key for a deterministic result.
+    if (lhs_count != rhs_count) return lhs_count > rhs_count;
+    return lhs->first < rhs->first;
+  };
+  const size_t num_entries = std::min(max_entries, entries.size());
+  std::partial_sort(entries.begin(), entries.begin() + num_entries, entries.end(), compare);
+  entries.resize(num_entries);
+  return entries;
+}
+}  // namespace
+
+void UnwindingErrorsAggregator::RecordSuccessfulSample(pid_t tid, uint64_t used_stack_size) {
+  ++total_samples_count_;
+  ++counts_by_tid_[tid].samples_count;
+  max_used_stack_size_ = std::max(max_used_stack_size_, used_stack_size);
+}
+
+void UnwindingErrorsAggregator::RecordUnwindingError(pid_t tid, UnwindingErrorType type,
+                                                     std::string_view module_path) {
+  const auto type_index = static_cast<size_t>(type);
+  ++total_samples_count_;
+  ++total_errors_[type_index];
+
+  ThreadCounts& thread_counts = counts_by_tid_[tid];
+  ++thread_counts.samples_count;
+  ++thread_counts.errors[type_index];
+
+  if (module_path.empty()) module_path = kUnknownModulePath;
+  auto module_it = errors_by_module_.find(module_path);
+  if (module_it == errors_by_module_.end()) {
+    module_it = errors_by_module_.emplace(std::string{module_path}, ErrorCounts{}).first;
+  }
+  ++module_it->second[type_index];
+}
+
+void UnwindingErrorsAggregator::RecordRequiredStackSize(uint64_t required_stack_size) {
+  max_required_stack_size_ = std::max(max_required_stack_size_, required_stack_size);
+}
+
+uint64_t UnwindingErrorsAggregator::GetTotalErrorsCount() const { return Sum(total_errors_); }
+
+uint64_t UnwindingErrorsAggregator::Sum(const ErrorCounts& counts) {
+  return std::accumulate(counts.begin(), counts.end(), uint64_t{0});
+}
+
+void UnwindingErrorsAggregator::SetErrorCounts(
+    const ErrorCounts& counts, orbit_grpc_protos::UnwindingErrorCounts* counts_proto) {
+  auto get = [&counts](UnwindingErrorType type) { return counts[static_cast<size_t>(type)]; };
+  counts_proto->set_stack_dump_too_small(get(UnwindingErrorType::kStackDumpTooSmall));
+  counts_proto->set_missing_unwind_info(get(UnwindingErrorType::kMissingUnwindInfo));
+  counts_proto->set_missing_frame_pointer(get(UnwindingErrorType::kMissingFramePointer));
+  counts_proto->set_unknown_map(get(UnwindingErrorType::kUnknownMap));
+  counts_proto->set_in_uprobes(get(UnwindingErrorType::kInUprobes));
+  counts_proto->set_uprobes_patching_failed(get(UnwindingErrorType::kUprobesPatchingFailed));
+}
+
+orbit_grpc_protos::UnwindingErrorsSummaryEvent UnwindingErrorsAggregator::CreateSummaryEvent(
+    uint64_t timestamp_ns, pid_t pid,
+    orbit_grpc_protos::CaptureOptions::UnwindingMethod unwinding_method,
+    uint32_t stack_dump_size) const {
+  orbit_grpc_protos::UnwindingErrorsSummaryEvent summary;
+  summary.set_timestamp_ns(timestamp_ns);
+  summary.set_pid(pid);
+  summary.set_unwinding_method(unwinding_method);
+  summary.set_stack_dump_size(stack_dump_size);
+  summary.set_total_samples_count(total_samples_count_);
+  SetErrorCounts(total_errors_, summary.mutable_total_errors());
+  summary.set_max_used_stack_size(max_used_stack_size_);
+  summary.set_max_required_stack_size(max_required_stack_size_);
+
+  for (const auto* module_entry : GetTopEntries(errors_by_module_, kMaxModulesInSummary, Sum)) {
+    orbit_grpc_protos::UnwindingErrorsSummaryEvent::ModuleErrors* module_errors =
+        summary.add_modules();
+    module_errors->set_module_path(module_entry->first);
+    SetErrorCounts(module_entry->second, module_errors->mutable_errors());
+  }
+
+  auto get_thread_errors_count = [](const ThreadCounts& counts) { return Sum(counts.errors); };
+  for (const auto* thread_entry :
+       GetTopEntries(counts_by_tid_, kMaxThreadsInSummary, get_thread_errors_count)) {
+    orbit_grpc_protos::UnwindingErrorsSummaryEvent::ThreadErrors* thread_errors =
+        summary.add_threads();
+    thread_errors->set_tid(thread_entry->first);
+    thread_errors->set_samples_count(thread_entry->second.samples_count);
+    SetErrorCounts(thread_entry->second.errors, thread_errors->mutable_errors());
+  }
+
+  return summary;
+}
+
+}  // namespace orbit_linux_tracing
@@ -0,0 +1,80 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef LINUX_TRACING_UNWINDING_ERRORS_AGGREGATOR_H_
+#define LINUX_TRACING_UNWINDING_ERRORS_AGGREGATOR_H_
+
+#include <absl/container/flat_hash_map.h>
+#include <sys/types.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+enum class UnwindingErrorType {
+  kStackDumpTooSmall = 0,
+  kMissingUnwindInfo,
+  kMissingFramePointer,
+  kUnknownMap,
+  kInUprobes,
+  kUprobesPatchingFailed,
+};
+
+// Classifies and counts the samples that could not be unwound, per module in which unwinding
+// stopped and per thread, together with how much of the stack dump the samples used. This is sent
+// as an UnwindingErrorsSummaryEvent at the end of the capture, so that the client can suggest a
+// better stack dump size or unwinding method: a too small dump makes samples fail, while a too
+// large one makes each sample more expensive for no benefit.
+// This class is not thread safe, as samples are only processed on one thread.
+class UnwindingErrorsAggregator {
+ public:
+  // Only this many modules and threads, those with the most errors, are included in the summary.
+  static constexpr size_t kMaxModulesInSummary = 10;
+  static constexpr size_t kMaxThreadsInSummary = 10;
+
+  // `used_stack_size` is how much of the stack dump the unwinding needed.
+  void RecordSuccessfulSample(pid_t tid, uint64_t used_stack_size);
+  // `module_path` is the module in which unwinding stopped, or empty if unknown.
+  void RecordUnwindingError(pid_t tid, UnwindingErrorType type, std::string_view module_path);
+  // For samples of type kStackDumpTooSmall for which the size that would have been needed is known.
+  void RecordRequiredStackSize(uint64_t required_stack_size);
+
+  [[nodiscard]] uint64_t GetTotalSamplesCount() const { return total_samples_count_; }
+  [[nodiscard]] uint64_t GetTotalErrorsCount() const;
+
+  [[nodiscard]] orbit_grpc_protos::UnwindingErrorsSummaryEvent CreateSummaryEvent(
+      uint64_t timestamp_ns, pid_t pid,
+      orbit_grpc_protos::CaptureOptions::UnwindingMethod unwinding_method,
+      uint32_t stack_dump_size) const;
+
+ private:
+  static constexpr size_t kNumErrorTypes =
+      static_cast<size_t>(UnwindingErrorType::kUprobesPatchingFailed) + 1;
+  using ErrorCounts = std::array<uint64_t, kNumErrorTypes>;
+  static void SetErrorCounts(const ErrorCounts& counts,
+                             orbit_grpc_protos::UnwindingErrorCounts* counts_proto);
+  [[nodiscard]] static uint64_t Sum(const ErrorCounts& counts);
+
+  struct ThreadCounts {
+    uint64_t samples_count = 0;
+    ErrorCounts errors{};
+  };
+
+  uint64_t total_samples_count_ = 0;
+  ErrorCounts total_errors_{};
+  uint64_t max_used_stack_size_ = 0;
+  uint64_t max_required_stack_size_ = 0;
+  absl::flat_hash_map<std::string, ErrorCounts> errors_by_module_;
+  absl::flat_hash_map<pid_t, ThreadCounts> counts_by_tid_;
+};
+
+}  // namespace orbit_linux_tracing
+
+#endif  // LINUX_TRACING_UNWINDING_ERRORS_AGGREGATOR_H_
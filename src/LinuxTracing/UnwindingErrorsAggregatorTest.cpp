@@ -0,0 +1,102 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "UnwindingErrorsAggregator.h"
+#include "capture.pb.h"
+
+namespace orbit_linux_tracing {
+
+using orbit_grpc_protos::CaptureOptions;
+using orbit_grpc_protos::UnwindingErrorsSummaryEvent;
+
+TEST(UnwindingErrorsAggregator, EmptySummary) {
+  UnwindingErrorsAggregator aggregator;
+  UnwindingErrorsSummaryEvent summary =
+      aggregator.CreateSummaryEvent(100, 42, CaptureOptions::kDwarf, 65000);
+  EXPECT_EQ(summary.timestamp_ns(), 100);
+  EXPECT_EQ(summary.pid(), 42);
+  EXPECT_EQ(summary.unwinding_method(), CaptureOptions::kDwarf);
+  EXPECT_EQ(summary.stack_dump_size(), 65000);
+  EXPECT_EQ(summary.total_samples_count(), 0);
+  EXPECT_EQ(summary.total_errors().stack_dump_too_small(), 0);
+  EXPECT_TRUE(summary.modules().empty());
+  EXPECT_TRUE(summary.threads().empty());
+}
+
+TEST(UnwindingErrorsAggregator, ErrorsAreClassifiedPerModuleAndThread) {
+  UnwindingErrorsAggregator aggregator;
+  aggregator.RecordSuccessfulSample(1, 1000);
+  aggregator.RecordSuccessfulSample(1, 3000);
+  aggregator.RecordSuccessfulSample(2, 2000);
+  aggregator.RecordUnwindingError(1, UnwindingErrorType::kStackDumpTooSmall, "/lib/a.so");
+  aggregator.RecordUnwindingError(2, UnwindingErrorType::kStackDumpTooSmall, "/lib/a.so");
+  aggregator.RecordRequiredStackSize(70000);
+  aggregator.RecordRequiredStackSize(20000);
+  aggregator.RecordUnwindingError(2, UnwindingErrorType::kMissingUnwindInfo, "/lib/b.so");
+  aggregator.RecordUnwindingError(2, UnwindingErrorType::kUnknownMap, "");
+  aggregator.RecordUnwindingError(3, UnwindingErrorType::kInUprobes, "[uprobes]");
+  EXPECT_EQ(aggregator.GetTotalSamplesCount(), 8);
+  EXPECT_EQ(aggregator.GetTotalErrorsCount(), 5);
+
+  UnwindingErrorsSummaryEvent summary =
+      aggregator.CreateSummaryEvent(100, 42, CaptureOptions::kDwarf, 65000);
+  EXPECT_EQ(summary.total_samples_count(), 8);
+  EXPECT_EQ(summary.total_errors().stack_dump_too_small(), 2);
+  EXPECT_EQ(summary.total_errors().missing_unwind_info(), 1);
+  EXPECT_EQ(summary.total_errors().missing_frame_pointer(), 0);
+  EXPECT_EQ(summary.total_errors().unknown_map(), 1);
+  EXPECT_EQ(summary.total_errors().in_uprobes(), 1);
+  EXPECT_EQ(summary.total_errors().uprobes_patching_failed(), 0);
+  EXPECT_EQ(summary.max_used_stack_size(), 3000);
+  EXPECT_EQ(summary.max_required_stack_size(), 70000);
+
+  // Sorted by decreasing number of errors, then by path.
+  ASSERT_EQ(summary.modules_size(), 4);
+  EXPECT_EQ(summary.modules(0).module_path(), "/lib/a.so");
+  EXPECT_EQ(summary.modules(0).errors().stack_dump_too_small(), 2);
+  EXPECT_EQ(summary.modules(1).module_path(), "/lib/b.so");
+  EXPECT_EQ(summary.modules(1).errors().missing_unwind_info(), 1);
+  EXPECT_EQ(summary.modules(2).module_path(), "[unknown]");
+  EXPECT_EQ(summary.modules(2).errors().unknown_map(), 1);
+  EXPECT_EQ(summary.modules(3).module_path(), "[uprobes]");
+
+  ASSERT_EQ(summary.threads_size(), 3);
+  EXPECT_EQ(summary.threads(0).tid(), 2);
+  EXPECT_EQ(summary.threads(0).samples_count(), 4);
+  EXPECT_EQ(summary.threads(0).errors().stack_dump_too_small(), 1);
+  EXPECT_EQ(summary.threads(0).errors().missing_unwind_info(), 1);
+  EXPECT_EQ(summary.threads(0).errors().unknown_map(), 1);
+  EXPECT_EQ(summary.threads(1).tid(), 1);
+  EXPECT_EQ(summary.threads(1).samples_count(), 3);
+  EXPECT_EQ(summary.threads(2).tid(), 3);
+  EXPECT_EQ(summary.threads(2).samples_count(), 1);
+}
+
+TEST(UnwindingErrorsAggregator, SummaryOnlyContainsModulesAndThreadsWithMostErrors) {
+  UnwindingErrorsAggregator aggregator;
+  constexpr int kNumModulesAndThreads = 30;
+  for (int i = 1; i <= kNumModulesAndThreads; ++i) {
+    for (int j = 0; j < i; ++j) {
+      aggregator.RecordUnwindingError(i, UnwindingErrorType::kMissingUnwindInfo,
+                                      "/lib/" + std::to_string(i));
+    }
+  }
+  aggregator.RecordSuccessfulSample(kNumModulesAndThreads + 1, 100);
+
+  UnwindingErrorsSummaryEvent summary =
+      aggregator.CreateSummaryEvent(100, 42, CaptureOptions::kFramePointers, 512);
+  ASSERT_EQ(summary.modules_size(), UnwindingErrorsAggregator::kMaxModulesInSummary);
+  ASSERT_EQ(summary.threads_size(), UnwindingErrorsAggregator::kMaxThreadsInSummary);
+  for (int i = 0; i < summary.modules_size(); ++i) {
+    EXPECT_EQ(summary.modules(i).module_path(),
+              "/lib/" + std::to_string(kNumModulesAndThreads - i));
+    EXPECT_EQ(summary.threads(i).tid(), kNumModulesAndThreads - i);
+  }
+}
+
+}  // namespace orbit_linux_tracing
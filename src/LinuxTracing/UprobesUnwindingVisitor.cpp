@@ -10,12 +10,13 @@
 #include <unwindstack/Unwinder.h>
 
 #include <algorithm>
+#include <iterator>
 #include <optional>
 #include <utility>
 
 #include "Function.h"
+#include "JitSymbolsReader.h"
 #include "LeafFunctionCallManager.h"
-#include "ObjectUtils/LinuxMap.h"
 #include "OrbitBase/Logging.h"
 #include "OrbitBase/Result.h"
 #include "capture.pb.h"
@@ -28,10 +29,37 @@ using orbit_grpc_protos::FullAddressInfo;
 using orbit_grpc_protos::FullCallstackSample;
 using orbit_grpc_protos::FunctionCall;
 
+static constexpr const char* kJitModuleName = "[jit]";
+
+static void SendJitFullAddressInfoToListener(TracerListener* listener, uint64_t absolute_address,
+                                             const JitSymbol& jit_symbol) {
+  FullAddressInfo address_info;
+  address_info.set_absolute_address(absolute_address);
+  address_info.set_function_name(jit_symbol.name);
+  address_info.set_offset_in_function(absolute_address - jit_symbol.start);
+  address_info.set_module_name(kJitModuleName);
+
+  listener->OnAddressInfo(std::move(address_info));
+}
+
+// libunwindstack can't symbolize frames in JIT-compiled code, as that code is not backed by an ELF
+// file. For those frames, we use the symbols that the JIT compiler wrote for the code that was
+// loaded at that address at the time of the sample.
 static void SendFullAddressInfoToListener(TracerListener* listener,
-                                          const unwindstack::FrameData& libunwindstack_frame) {
+                                          const unwindstack::FrameData& libunwindstack_frame,
+                                          const JitSymbolMap* jit_symbol_map,
+                                          uint64_t timestamp_ns) {
   CHECK(listener != nullptr);
 
+  if (libunwindstack_frame.function_name.empty() && jit_symbol_map != nullptr &&
+      !jit_symbol_map->empty()) {
+    const JitSymbol* jit_symbol = jit_symbol_map->FindSymbol(libunwindstack_frame.pc, timestamp_ns);
+    if (jit_symbol != nullptr) {
+      SendJitFullAddressInfoToListener(listener, libunwindstack_frame.pc, *jit_symbol);
+      return;
+    }
+  }
+
   FullAddressInfo address_info;
   address_info.set_absolute_address(libunwindstack_frame.pc);
   address_info.set_function_name(libunwindstack_frame.function_name);
@@ -41,6 +69,29 @@ static void SendFullAddressInfoToListener(TracerListener* listener,
   listener->OnAddressInfo(std::move(address_info));
 }
 
+// Callstacks from frame-pointer unwinding are symbolized by the client using the modules, so only
+// the frames in JIT-compiled code need a FullAddressInfo. Each one is only sent once per symbol.
+void UprobesUnwindingVisitor::SendJitFullAddressInfosToListener(const Callstack& callstack,
+                                                                uint64_t timestamp_ns) {
+  if (jit_symbol_map_ == nullptr || jit_symbol_map_->empty()) return;
+  for (uint64_t pc : callstack.pcs()) {
+    const JitSymbol* jit_symbol = jit_symbol_map_->FindSymbol(pc, timestamp_ns);
+    if (jit_symbol == nullptr) continue;
+    if (!sent_jit_addresses_by_symbol_[{jit_symbol->start, jit_symbol->load_timestamp_ns}]
+             .insert(pc)
+             .second) {
+      continue;
+    }
+    SendJitFullAddressInfoToListener(listener_, pc, *jit_symbol);
+  }
+}
+
+void UprobesUnwindingVisitor::OnJitSymbolsRemoved(const std::vector<JitSymbol>& removed_symbols) {
+  for (const JitSymbol& removed_symbol : removed_symbols) {
+    sent_jit_addresses_by_symbol_.erase({removed_symbol.start, removed_symbol.load_timestamp_ns});
+  }
+}
+
 // For addresses falling directly inside u(ret)probes code, unwindstack::FrameData has limited
 // information. Nonetheless, we can send a perfectly meaningful FullAddressInfo, treating
 // u(ret)probes code as a single function. This makes sense as the only affected virtual addresses I
@@ -60,6 +111,25 @@ static void SendUprobesFullAddressInfoToListener(
   listener->OnAddressInfo(std::move(address_info));
 }
 
+// libunwindstack falls back to reading the memory of the process when reading past the end of the
+// stack dump, so running out of stack dump doesn't necessarily result in a specific error. But if
+// unwinding stopped at a frame whose stack pointer is this close to the end of the dump, it most
+// likely needed to read past it.
+static constexpr uint64_t kStackDumpEndMarginBytes = 64;
+
+[[nodiscard]] static UnwindingErrorType ClassifyDwarfUnwindingError(
+    const LibunwindstackResult& libunwindstack_result, uint64_t stack_start, uint64_t stack_size) {
+  const unwindstack::FrameData& last_frame = libunwindstack_result.frames().back();
+  if (last_frame.sp + kStackDumpEndMarginBytes >= stack_start + stack_size) {
+    return UnwindingErrorType::kStackDumpTooSmall;
+  }
+  if (libunwindstack_result.error_code() == unwindstack::ErrorCode::ERROR_INVALID_MAP ||
+      last_frame.map_name.empty()) {
+    return UnwindingErrorType::kUnknownMap;
+  }
+  return UnwindingErrorType::kMissingUnwindInfo;
+}
+
 void UprobesUnwindingVisitor::Visit(StackSamplePerfEvent* event) {
   CHECK(listener_ != nullptr);
   CHECK(current_maps_ != nullptr);
@@ -92,6 +162,8 @@ void UprobesUnwindingVisitor::Visit(StackSamplePerfEvent* event) {
       ++(*samples_in_uretprobes_counter_);
     }
     callstack->set_type(Callstack::kInUprobes);
+    RecordUnwindingError(event->GetTid(), UnwindingErrorType::kInUprobes,
+                         libunwindstack_result.frames().front().map_name);
     SendUprobesFullAddressInfoToListener(listener_, libunwindstack_result.frames().front());
     callstack->add_pcs(libunwindstack_result.frames().front().pc);
 
@@ -106,7 +178,10 @@ void UprobesUnwindingVisitor::Visit(StackSamplePerfEvent* event) {
       ++(*unwind_error_counter_);
     }
     callstack->set_type(Callstack::kUprobesPatchingFailed);
-    SendFullAddressInfoToListener(listener_, libunwindstack_result.frames().front());
+    RecordUnwindingError(event->GetTid(), UnwindingErrorType::kUprobesPatchingFailed,
+                         libunwindstack_result.frames().front().map_name);
+    SendFullAddressInfoToListener(listener_, libunwindstack_result.frames().front(),
+                                  jit_symbol_map_, event->GetTimestamp());
     callstack->add_pcs(libunwindstack_result.frames().front().pc);
 
   } else if (!libunwindstack_result.IsSuccess() || libunwindstack_result.frames().size() == 1) {
@@ -120,14 +195,25 @@ void UprobesUnwindingVisitor::Visit(StackSamplePerfEvent* event) {
       ++(*unwind_error_counter_);
     }
     callstack->set_type(Callstack::kDwarfUnwindingError);
-    SendFullAddressInfoToListener(listener_, libunwindstack_result.frames().front());
+    RecordUnwindingError(event->GetTid(),
+                         ClassifyDwarfUnwindingError(libunwindstack_result,
+                                                     event->GetRegisters()[PERF_REG_X86_SP],
+                                                     event->GetStackSize()),
+                         libunwindstack_result.frames().back().map_name);
+    SendFullAddressInfoToListener(listener_, libunwindstack_result.frames().front(),
+                                  jit_symbol_map_, event->GetTimestamp());
     callstack->add_pcs(libunwindstack_result.frames().front().pc);
 
   } else {
     callstack->set_type(Callstack::kComplete);
+    const uint64_t stack_start = event->GetRegisters()[PERF_REG_X86_SP];
+    const uint64_t outermost_sp = libunwindstack_result.frames().back().sp;
+    RecordSuccessfulSample(event->GetTid(),
+                           outermost_sp >= stack_start ? outermost_sp - stack_start : 0);
 
     for (const unwindstack::FrameData& libunwindstack_frame : libunwindstack_result.frames()) {
-      SendFullAddressInfoToListener(listener_, libunwindstack_frame);
+      SendFullAddressInfoToListener(listener_, libunwindstack_frame, jit_symbol_map_,
+                                    event->GetTimestamp());
       callstack->add_pcs(libunwindstack_frame.pc);
     }
   }
@@ -164,7 +250,10 @@ void UprobesUnwindingVisitor::Visit(CallchainSamplePerfEvent* event) {
       ++(*unwind_error_counter_);
     }
     callstack->set_type(Callstack::kFramePointerUnwindingError);
+    RecordUnwindingError(event->GetTid(), UnwindingErrorType::kMissingFramePointer,
+                         GetMapName(event->GetCallchain()[1]));
     callstack->add_pcs(event->GetCallchain()[1]);
+    SendJitFullAddressInfosToListener(*callstack, event->GetTimestamp());
     listener_->OnCallstackSample(std::move(sample));
     return;
   }
@@ -179,6 +268,9 @@ void UprobesUnwindingVisitor::Visit(CallchainSamplePerfEvent* event) {
       ++(*samples_in_uretprobes_counter_);
     }
     callstack->set_type(Callstack::kInUprobes);
+    // Like the callstack, also record a sample without a map as in uprobes, as reporting it as an
+    // unknown map would suggest changing the unwinding settings.
+    RecordUnwindingError(event->GetTid(), UnwindingErrorType::kInUprobes, "[uprobes]");
     callstack->add_pcs(top_ip);
     listener_->OnCallstackSample(std::move(sample));
     return;
@@ -208,7 +300,22 @@ void UprobesUnwindingVisitor::Visit(CallchainSamplePerfEvent* event) {
       ++(*unwind_error_counter_);
     }
     callstack->set_type(leaf_function_patching_status);
+    if (leaf_function_patching_status == Callstack::kStackTopForDwarfUnwindingTooSmall) {
+      RecordUnwindingError(event->GetTid(), UnwindingErrorType::kStackDumpTooSmall,
+                           top_ip_map_info->name());
+      if (unwinding_errors_aggregator_ != nullptr) {
+        unwinding_errors_aggregator_->RecordRequiredStackSize(
+            event->GetRegisters()[PERF_REG_X86_BP] - event->GetRegisters()[PERF_REG_X86_SP]);
+      }
+    } else if (leaf_function_patching_status == Callstack::kFramePointerUnwindingError) {
+      RecordUnwindingError(event->GetTid(), UnwindingErrorType::kMissingFramePointer,
+                           top_ip_map_info->name());
+    } else {
+      RecordUnwindingError(event->GetTid(), UnwindingErrorType::kMissingUnwindInfo,
+                           top_ip_map_info->name());
+    }
     callstack->add_pcs(top_ip);
+    SendJitFullAddressInfosToListener(*callstack, event->GetTimestamp());
     listener_->OnCallstackSample(std::move(sample));
     return;
   }
@@ -219,12 +326,19 @@ void UprobesUnwindingVisitor::Visit(CallchainSamplePerfEvent* event) {
       ++(*unwind_error_counter_);
     }
     callstack->set_type(Callstack::kUprobesPatchingFailed);
+    RecordUnwindingError(event->GetTid(), UnwindingErrorType::kUprobesPatchingFailed,
+                         top_ip_map_info->name());
     callstack->add_pcs(top_ip);
+    SendJitFullAddressInfosToListener(*callstack, event->GetTimestamp());
     listener_->OnCallstackSample(std::move(sample));
     return;
   }
 
   callstack->set_type(Callstack::kComplete);
+  // Only the part of the stack dump up to the frame of the caller of the leaf function is needed.
+  const uint64_t rbp = event->GetRegisters()[PERF_REG_X86_BP];
+  const uint64_t rsp = event->GetRegisters()[PERF_REG_X86_SP];
+  RecordSuccessfulSample(event->GetTid(), rbp >= rsp ? rbp - rsp : 0);
   // Skip the first frame as the top of a perf_event_open callchain is always
   // inside kernel code.
   callstack->add_pcs(event->GetCallchain()[1]);
@@ -239,6 +353,7 @@ void UprobesUnwindingVisitor::Visit(CallchainSamplePerfEvent* event) {
   }
 
   CHECK(!callstack->pcs().empty());
+  SendJitFullAddressInfosToListener(*callstack, event->GetTimestamp());
   listener_->OnCallstackSample(std::move(sample));
 }
 
@@ -297,7 +412,14 @@ void UprobesUnwindingVisitor::Visit(UretprobesPerfEvent* event) {
   std::optional<FunctionCall> function_call = function_call_manager_->ProcessUretprobes(
       event->GetPid(), event->GetTid(), event->GetTimestamp(), event->GetAx());
   if (function_call.has_value()) {
-    listener_->OnFunctionCall(std::move(function_call.value()));
+    if (function_call_coalescer_ != nullptr) {
+      for (FunctionCall& complete_function_call :
+           function_call_coalescer_->ProcessFunctionCall(std::move(function_call.value()))) {
+        listener_->OnFunctionCall(std::move(complete_function_call));
+      }
+    } else {
+      listener_->OnFunctionCall(std::move(function_call.value()));
+    }
   }
 
   return_address_manager_->ProcessUretprobes(event->GetTid());
@@ -322,9 +444,24 @@ void UprobesUnwindingVisitor::Visit(MmapPerfEvent* event) {
     return;
   }
 
+  // The jitdump file that JIT compilers map to announce it is not a module: JitSymbolsReader reads
+  // it instead.
+  if (IsJitdumpFile(event->filename(), event->pid())) {
+    return;
+  }
+
+  // Anonymous executable maps usually contain JIT-compiled code. They need to be in current_maps_
+  // for the frames in them not to be taken for samples in uprobes or for invalid frames, but
+  // CreateModule can't process them. Like in /proc/<pid>/maps, they have no name.
+  if (event->filename() == "//anon") {
+    current_maps_->AddAndSort(event->address(), event->address() + event->length(), 0,
+                              PROT_READ | PROT_EXEC, "", 0);
+    return;
+  }
+
   ErrorMessageOr<orbit_grpc_protos::ModuleInfo> module_info_or_error =
-      orbit_object_utils::CreateModule(event->filename(), event->address(),
-                                       event->address() + event->length());
+      module_info_cache_.GetOrCreateModule(event->filename(), event->address(),
+                                           event->address() + event->length());
   if (module_info_or_error.has_error()) {
     ERROR("Unable to create module: %s", module_info_or_error.error().message());
     return;
@@ -337,6 +474,8 @@ void UprobesUnwindingVisitor::Visit(MmapPerfEvent* event) {
                             event->page_offset(), PROT_READ | PROT_EXEC, event->filename(),
                             module_info.load_bias());
 
+  if (!RecordReportedModule(module_info)) return;
+
   orbit_grpc_protos::ModuleUpdateEvent module_update_event;
   module_update_event.set_pid(event->pid());
   module_update_event.set_timestamp_ns(event->GetTimestamp());
@@ -345,4 +484,50 @@ void UprobesUnwindingVisitor::Visit(MmapPerfEvent* event) {
   listener_->OnModuleUpdate(std::move(module_update_event));
 }
 
+void UprobesUnwindingVisitor::RecordSuccessfulSample(pid_t tid, uint64_t used_stack_size) {
+  if (unwinding_errors_aggregator_ == nullptr) return;
+  unwinding_errors_aggregator_->RecordSuccessfulSample(tid, used_stack_size);
+}
+
+void UprobesUnwindingVisitor::RecordUnwindingError(pid_t tid, UnwindingErrorType type,
+                                                   const std::string& module_path) {
+  if (unwinding_errors_aggregator_ == nullptr) return;
+  unwinding_errors_aggregator_->RecordUnwindingError(tid, type, module_path);
+}
+
+std::string UprobesUnwindingVisitor::GetMapName(uint64_t address) {
+  unwindstack::MapInfo* map_info = current_maps_->Find(address);
+  if (map_info == nullptr) return "";
+  return map_info->name();
+}
+
+bool UprobesUnwindingVisitor::RecordReportedModule(
+    const orbit_grpc_protos::ModuleInfo& module_info) {
+  const uint64_t start = module_info.address_start();
+  const uint64_t end = module_info.address_end();
+
+  // Modules without build id can't be told apart from a different version of the same file.
+  if (!module_info.build_id().empty()) {
+    auto same_start_it = reported_modules_by_address_start_.find(start);
+    if (same_start_it != reported_modules_by_address_start_.end() &&
+        same_start_it->second.address_end == end &&
+        same_start_it->second.build_id == module_info.build_id() &&
+        same_start_it->second.file_path == module_info.file_path()) {
+      return false;
+    }
+  }
+
+  auto it = reported_modules_by_address_start_.upper_bound(start);
+  if (it != reported_modules_by_address_start_.begin() &&
+      std::prev(it)->second.address_end > start) {
+    --it;
+  }
+  while (it != reported_modules_by_address_start_.end() && it->first < end) {
+    it = reported_modules_by_address_start_.erase(it);
+  }
+  reported_modules_by_address_start_.insert_or_assign(
+      start, ReportedModule{end, module_info.file_path(), module_info.build_id()});
+  return true;
+}
+
 }  // namespace orbit_linux_tracing
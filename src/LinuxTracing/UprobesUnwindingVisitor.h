@@ -6,25 +6,33 @@
 #define LINUX_TRACING_UPROBES_UNWINDING_VISITOR_H_
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <absl/hash/hash.h>
 #include <sys/types.h>
 #include <unwindstack/Maps.h>
 
 #include <atomic>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "FunctionCallCoalescer.h"
+#include "JitSymbolMap.h"
 #include "LeafFunctionCallManager.h"
 #include "LibunwindstackMaps.h"
 #include "LibunwindstackUnwinder.h"
 #include "LinuxTracing/TracerListener.h"
+#include "ModuleInfoCache.h"
 #include "PerfEvent.h"
 #include "PerfEventVisitor.h"
+#include "UnwindingErrorsAggregator.h"
 #include "UprobesFunctionCallManager.h"
 #include "UprobesReturnAddressManager.h"
+#include "capture.pb.h"
 
 namespace orbit_linux_tracing {
 
@@ -79,6 +87,26 @@ class UprobesUnwindingVisitor : public PerfEventVisitor {
     samples_in_uretprobes_counter_ = samples_in_uretprobes_counter;
   }
 
+  // If set, each sample is recorded in `unwinding_errors_aggregator` as either successfully unwound
+  // or as an unwinding error of a specific type.
+  void SetUnwindingErrorsAggregator(UnwindingErrorsAggregator* unwinding_errors_aggregator) {
+    unwinding_errors_aggregator_ = unwinding_errors_aggregator;
+  }
+
+  // If set, FunctionCalls go through `function_call_coalescer` before being sent to the listener.
+  // The owner is responsible for flushing the coalescer at the end of the capture.
+  void SetFunctionCallCoalescer(FunctionCallCoalescer* function_call_coalescer) {
+    function_call_coalescer_ = function_call_coalescer;
+  }
+
+  // If set, frames in JIT-compiled code are symbolized with `jit_symbol_map`, which the owner keeps
+  // up to date with the symbols written by the JIT compilers of the target.
+  void SetJitSymbolMap(const JitSymbolMap* jit_symbol_map) { jit_symbol_map_ = jit_symbol_map; }
+
+  // Forgets which addresses were sent for the JIT symbols that the owner removed from the
+  // JitSymbolMap, as no more events can resolve to them.
+  void OnJitSymbolsRemoved(const std::vector<JitSymbol>& removed_symbols);
+
   void Visit(StackSamplePerfEvent* event) override;
   void Visit(CallchainSamplePerfEvent* event) override;
   void Visit(UprobesPerfEvent* event) override;
@@ -86,6 +114,17 @@ class UprobesUnwindingVisitor : public PerfEventVisitor {
   void Visit(MmapPerfEvent* event) override;
 
  private:
+  void RecordSuccessfulSample(pid_t tid, uint64_t used_stack_size);
+  void RecordUnwindingError(pid_t tid, UnwindingErrorType type, const std::string& module_path);
+  [[nodiscard]] std::string GetMapName(uint64_t address);
+  void SendJitFullAddressInfosToListener(const orbit_grpc_protos::Callstack& callstack,
+                                         uint64_t timestamp_ns);
+
+  // Returns false if a module with the same build id and file path was already reported at the
+  // same address range, in which case sending the ModuleUpdateEvent again is unnecessary.
+  // Otherwise, records the module as reported, replacing those it overlaps, like the client does.
+  [[nodiscard]] bool RecordReportedModule(const orbit_grpc_protos::ModuleInfo& module_info);
+
   TracerListener* listener_;
 
   UprobesFunctionCallManager* function_call_manager_;
@@ -96,9 +135,25 @@ class UprobesUnwindingVisitor : public PerfEventVisitor {
 
   std::atomic<uint64_t>* unwind_error_counter_ = nullptr;
   std::atomic<uint64_t>* samples_in_uretprobes_counter_ = nullptr;
+  FunctionCallCoalescer* function_call_coalescer_ = nullptr;
+  UnwindingErrorsAggregator* unwinding_errors_aggregator_ = nullptr;
+  const JitSymbolMap* jit_symbol_map_ = nullptr;
+  // The addresses for which a JIT FullAddressInfo was already sent, by (start, load timestamp) of
+  // their symbol.
+  absl::flat_hash_map<std::pair<uint64_t, uint64_t>, absl::flat_hash_set<uint64_t>>
+      sent_jit_addresses_by_symbol_;
 
   absl::flat_hash_map<pid_t, std::vector<std::tuple<uint64_t, uint64_t, uint32_t>>>
       uprobe_sps_ips_cpus_per_thread_{};
+
+  ModuleInfoCache module_info_cache_;
+
+  struct ReportedModule {
+    uint64_t address_end;
+    std::string file_path;
+    std::string build_id;
+  };
+  std::map<uint64_t, ReportedModule> reported_modules_by_address_start_;
 };
 
 }  // namespace orbit_linux_tracing
@@ -2,12 +2,16 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <absl/strings/str_format.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <sys/mman.h>
 
+#include "JitSymbolMap.h"
 #include "LibunwindstackMaps.h"
 #include "LibunwindstackUnwinder.h"
+#include "ObjectUtils/LinuxMap.h"
+#include "OrbitBase/ExecutablePath.h"
 #include "UprobesUnwindingVisitor.h"
 
 using ::testing::_;
@@ -16,6 +20,7 @@ using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
 using ::testing::Ge;
 using ::testing::Invoke;
+using ::testing::IsEmpty;
 using ::testing::Lt;
 using ::testing::Property;
 using ::testing::Return;
@@ -63,6 +68,8 @@ class MockTracerListener : public TracerListener {
   MOCK_METHOD(void, OnLostPerfRecordsEvent, (orbit_grpc_protos::LostPerfRecordsEvent), (override));
   MOCK_METHOD(void, OnOutOfOrderEventsDiscardedEvent,
               (orbit_grpc_protos::OutOfOrderEventsDiscardedEvent), (override));
+  MOCK_METHOD(void, OnUnwindingErrorsSummaryEvent,
+              (orbit_grpc_protos::UnwindingErrorsSummaryEvent), (override));
 };
 
 class MockUprobesReturnAddressManager : public UprobesReturnAddressManager {
@@ -245,6 +252,58 @@ TEST_F(UprobesUnwindingVisitorTest,
   EXPECT_EQ(discarded_samples_in_uretprobes_counter, 0);
 }
 
+TEST_F(UprobesUnwindingVisitorTest, VisitStackSamplesRecordsUnwindingErrorsByType) {
+  static constexpr uint32_t kPid = 10;
+  static constexpr uint64_t kStackSize = 1024;
+  static constexpr uint64_t kSp = 0x10000;
+  UnwindingErrorsAggregator unwinding_errors_aggregator;
+  visitor_->SetUnwindingErrorsAggregator(&unwinding_errors_aggregator);
+
+  auto visit_sample = [this](const std::vector<unwindstack::FrameData>& frames,
+                             unwindstack::ErrorCode error_code) {
+    StackSamplePerfEvent event{kStackSize};
+    event.ring_buffer_record.sample_id.pid = kPid;
+    event.ring_buffer_record.sample_id.tid = 11;
+    event.ring_buffer_record.regs.sp = kSp;
+    EXPECT_CALL(unwinder_, Unwind(kPid, nullptr, _, _, kStackSize, _, _))
+        .WillOnce(Return(LibunwindstackResult{frames, error_code}));
+    visitor_->Visit(&event);
+  };
+
+  EXPECT_CALL(return_address_manager_, PatchSample).WillRepeatedly(Return());
+  EXPECT_CALL(maps_, Get).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(listener_, OnCallstackSample).Times(4);
+  EXPECT_CALL(listener_, OnAddressInfo).Times(5);
+
+  unwindstack::FrameData frame1 = kFrame1;
+  frame1.sp = kSp;
+  unwindstack::FrameData frame2 = kFrame2;
+  frame2.sp = kSp + 200;
+  visit_sample({frame1, frame2}, unwindstack::ErrorCode::ERROR_NONE);
+
+  // Unwinding stopped at the end of the stack dump.
+  frame2.sp = kSp + kStackSize - 8;
+  visit_sample({frame1, frame2}, unwindstack::ErrorCode::ERROR_MEMORY_INVALID);
+
+  frame2.sp = kSp + 200;
+  visit_sample({frame1, frame2}, unwindstack::ErrorCode::ERROR_UNWIND_INFO);
+
+  frame2.map_name = "";
+  visit_sample({frame1, frame2}, unwindstack::ErrorCode::ERROR_INVALID_MAP);
+
+  orbit_grpc_protos::UnwindingErrorsSummaryEvent summary =
+      unwinding_errors_aggregator.CreateSummaryEvent(
+          0, kPid, orbit_grpc_protos::CaptureOptions::kDwarf, kStackSize);
+  EXPECT_EQ(summary.total_samples_count(), 4);
+  EXPECT_EQ(summary.max_used_stack_size(), 200);
+  EXPECT_EQ(summary.total_errors().stack_dump_too_small(), 1);
+  EXPECT_EQ(summary.total_errors().missing_unwind_info(), 1);
+  EXPECT_EQ(summary.total_errors().unknown_map(), 1);
+  ASSERT_EQ(summary.modules_size(), 2);
+  EXPECT_EQ(summary.modules(0).module_path(), kTargetName);
+  EXPECT_EQ(summary.modules(1).module_path(), "[unknown]");
+}
+
 TEST_F(UprobesUnwindingVisitorTest, VisitEmptyStackSampleWithoutUprobesDoesNothing) {
   constexpr uint32_t kPid = 10;
   constexpr uint64_t kStackSize = 13;
@@ -513,6 +572,177 @@ TEST_F(UprobesUnwindingVisitorTest, VisitValidCallchainSampleWithoutUprobesSends
   EXPECT_EQ(discarded_samples_in_uretprobes_counter, 0);
 }
 
+TEST_F(UprobesUnwindingVisitorTest, VisitCallchainSampleWithJitFramesSendsJitAddressInfos) {
+  constexpr uint32_t kPid = 10;
+  constexpr uint64_t kStackSize = 13;
+  constexpr uint64_t kTimestampNs = 15;
+
+  std::vector<uint64_t> callchain;
+  callchain.push_back(kKernelAddress);
+  callchain.push_back(kTargetAddress1 + 4);
+  callchain.push_back(kTargetAddress2 + 1);
+  callchain.push_back(kTargetAddress3 + 1);
+
+  CallchainSamplePerfEvent event{callchain.size(), kStackSize};
+  perf_event_sample_id_tid_time_streamid_cpu sample_id{
+      .pid = kPid,
+      .tid = 11,
+      .time = kTimestampNs,
+      .stream_id = 12,
+      .cpu = 0,
+      .res = 0,
+  };
+  event.ring_buffer_record.sample_id = sample_id;
+  event.ips = callchain;
+
+  JitSymbolMap jit_symbol_map;
+  jit_symbol_map.AddSymbol(kTargetAddress1, 0x10, "jitted_leaf", 0);
+  // Was replaced by "jitted_caller" before the sample.
+  jit_symbol_map.AddSymbol(kTargetAddress3 - 8, 0x10, "unloaded", 0);
+  jit_symbol_map.AddSymbol(kTargetAddress3 - 8, 0x10, "jitted_caller", kTimestampNs - 1);
+  // Only loaded after the sample.
+  jit_symbol_map.AddSymbol(kTargetAddress2 - 8, 0x10, "not_loaded_yet", kTimestampNs + 1);
+  visitor_->SetJitSymbolMap(&jit_symbol_map);
+
+  EXPECT_CALL(maps_, Find).WillRepeatedly(Return(&kTargetMapInfo));
+  EXPECT_CALL(return_address_manager_, PatchCallchain).Times(1).WillOnce(Return(true));
+  EXPECT_CALL(leaf_function_call_manager_, PatchCallerOfLeafFunction)
+      .Times(1)
+      .WillOnce(Return(Callstack::kComplete));
+
+  orbit_grpc_protos::FullCallstackSample actual_callstack_sample;
+  EXPECT_CALL(listener_, OnCallstackSample).Times(1).WillOnce(SaveArg<0>(&actual_callstack_sample));
+
+  std::vector<orbit_grpc_protos::FullAddressInfo> actual_address_infos;
+  auto save_address_info =
+      [&actual_address_infos](orbit_grpc_protos::FullAddressInfo actual_address_info) {
+        actual_address_infos.push_back(std::move(actual_address_info));
+      };
+  EXPECT_CALL(listener_, OnAddressInfo).Times(2).WillRepeatedly(Invoke(save_address_info));
+
+  visitor_->Visit(&event);
+
+  EXPECT_THAT(actual_callstack_sample.callstack().pcs(),
+              ElementsAre(kTargetAddress1 + 4, kTargetAddress2, kTargetAddress3));
+  EXPECT_THAT(
+      actual_address_infos,
+      UnorderedElementsAre(
+          AllOf(
+              Property(&orbit_grpc_protos::FullAddressInfo::absolute_address, kTargetAddress1 + 4),
+              Property(&orbit_grpc_protos::FullAddressInfo::function_name, "jitted_leaf"),
+              Property(&orbit_grpc_protos::FullAddressInfo::offset_in_function, 4),
+              Property(&orbit_grpc_protos::FullAddressInfo::module_name, "[jit]")),
+          AllOf(Property(&orbit_grpc_protos::FullAddressInfo::absolute_address, kTargetAddress3),
+                Property(&orbit_grpc_protos::FullAddressInfo::function_name, "jitted_caller"),
+                Property(&orbit_grpc_protos::FullAddressInfo::offset_in_function, 8),
+                Property(&orbit_grpc_protos::FullAddressInfo::module_name, "[jit]"))));
+}
+
+TEST_F(UprobesUnwindingVisitorTest, VisitCallchainSamplesSendsEachJitAddressInfoOnce) {
+  static constexpr uint32_t kPid = 10;
+  static constexpr uint64_t kStackSize = 13;
+
+  std::vector<uint64_t> callchain;
+  callchain.push_back(kKernelAddress);
+  callchain.push_back(kTargetAddress1 + 4);
+  callchain.push_back(kTargetAddress2 + 1);
+
+  auto create_event = [&callchain](uint64_t timestamp_ns) {
+    auto event = std::make_unique<CallchainSamplePerfEvent>(callchain.size(), kStackSize);
+    event->ring_buffer_record.sample_id = perf_event_sample_id_tid_time_streamid_cpu{
+        .pid = kPid,
+        .tid = 11,
+        .time = timestamp_ns,
+        .stream_id = 12,
+        .cpu = 0,
+        .res = 0,
+    };
+    event->ips = callchain;
+    return event;
+  };
+
+  JitSymbolMap jit_symbol_map;
+  jit_symbol_map.AddSymbol(kTargetAddress1, 0x10, "jitted_leaf", 0);
+  jit_symbol_map.AddSymbol(kTargetAddress2 - 8, 0x10, "jitted_caller", 0);
+  visitor_->SetJitSymbolMap(&jit_symbol_map);
+
+  EXPECT_CALL(maps_, Find).WillRepeatedly(Return(&kTargetMapInfo));
+  EXPECT_CALL(return_address_manager_, PatchCallchain).WillRepeatedly(Return(true));
+  EXPECT_CALL(leaf_function_call_manager_, PatchCallerOfLeafFunction)
+      .WillRepeatedly(Return(Callstack::kComplete));
+  EXPECT_CALL(listener_, OnCallstackSample).Times(4);
+
+  std::vector<std::string> actual_function_names;
+  auto save_function_name =
+      [&actual_function_names](orbit_grpc_protos::FullAddressInfo actual_address_info) {
+        actual_function_names.push_back(actual_address_info.function_name());
+      };
+  EXPECT_CALL(listener_, OnAddressInfo).WillRepeatedly(Invoke(save_function_name));
+
+  visitor_->Visit(create_event(10).get());
+  visitor_->Visit(create_event(20).get());
+  EXPECT_THAT(actual_function_names, UnorderedElementsAre("jitted_leaf", "jitted_caller"));
+
+  // The code of the caller was replaced, so its address now belongs to a different symbol.
+  jit_symbol_map.AddSymbol(kTargetAddress2 - 8, 0x10, "jitted_caller_again", 25);
+  actual_function_names.clear();
+  visitor_->Visit(create_event(30).get());
+  EXPECT_THAT(actual_function_names, ElementsAre("jitted_caller_again"));
+
+  // Removing the replaced symbol doesn't cause the address infos of the current ones to be sent
+  // again.
+  visitor_->OnJitSymbolsRemoved(jit_symbol_map.RemoveSymbolsUnloadedBefore(30));
+  EXPECT_EQ(jit_symbol_map.GetNumUnloadedSymbols(), 0);
+  actual_function_names.clear();
+  visitor_->Visit(create_event(40).get());
+  EXPECT_THAT(actual_function_names, IsEmpty());
+}
+
+TEST_F(UprobesUnwindingVisitorTest, VisitStackSampleUsesJitSymbolsForFramesWithoutFunctionName) {
+  constexpr uint32_t kPid = 10;
+  constexpr uint64_t kStackSize = 13;
+  StackSamplePerfEvent event{kStackSize};
+  perf_event_sample_id_tid_time_streamid_cpu sample_id{
+      .pid = kPid,
+      .tid = 11,
+      .time = 15,
+      .stream_id = 12,
+      .cpu = 0,
+      .res = 0,
+  };
+  event.ring_buffer_record.sample_id = sample_id;
+
+  JitSymbolMap jit_symbol_map;
+  jit_symbol_map.AddSymbol(kTargetAddress1, 0x10, "jitted", 0);
+  visitor_->SetJitSymbolMap(&jit_symbol_map);
+
+  EXPECT_CALL(return_address_manager_, PatchSample).Times(1).WillOnce(Return());
+  EXPECT_CALL(maps_, Get).Times(1).WillOnce(Return(nullptr));
+
+  unwindstack::FrameData jit_frame{
+      .pc = kTargetAddress1 + 2,
+      .map_name = "",
+  };
+  std::vector<unwindstack::FrameData> libunwindstack_callstack{jit_frame};
+  EXPECT_CALL(unwinder_, Unwind(kPid, nullptr, _, _, kStackSize, _, _))
+      .Times(1)
+      .WillOnce(Return(LibunwindstackResult{libunwindstack_callstack,
+                                            unwindstack::ErrorCode::ERROR_UNWIND_INFO}));
+
+  orbit_grpc_protos::FullCallstackSample actual_callstack_sample;
+  EXPECT_CALL(listener_, OnCallstackSample).Times(1).WillOnce(SaveArg<0>(&actual_callstack_sample));
+  orbit_grpc_protos::FullAddressInfo actual_address_info;
+  EXPECT_CALL(listener_, OnAddressInfo).Times(1).WillOnce(SaveArg<0>(&actual_address_info));
+
+  visitor_->Visit(&event);
+
+  EXPECT_EQ(actual_callstack_sample.callstack().type(), Callstack::kDwarfUnwindingError);
+  EXPECT_EQ(actual_address_info.absolute_address(), kTargetAddress1 + 2);
+  EXPECT_EQ(actual_address_info.function_name(), "jitted");
+  EXPECT_EQ(actual_address_info.offset_in_function(), 2);
+  EXPECT_EQ(actual_address_info.module_name(), "[jit]");
+}
+
 TEST_F(UprobesUnwindingVisitorTest, VisitSingleFrameCallchainSampleDoesNothing) {
   constexpr uint32_t kPid = 10;
   constexpr uint64_t kStackSize = 13;
@@ -598,6 +828,46 @@ TEST_F(UprobesUnwindingVisitorTest, VisitCallchainSampleInsideUprobeCodeSendsInU
   EXPECT_EQ(discarded_samples_in_uretprobes_counter, 1);
 }
 
+TEST_F(UprobesUnwindingVisitorTest, VisitCallchainSampleWithoutMapRecordsInUprobesError) {
+  constexpr uint32_t kPid = 10;
+  constexpr uint64_t kStackSize = 13;
+  UnwindingErrorsAggregator unwinding_errors_aggregator;
+  visitor_->SetUnwindingErrorsAggregator(&unwinding_errors_aggregator);
+
+  std::vector<uint64_t> callchain;
+  callchain.push_back(kKernelAddress);
+  callchain.push_back(kUprobesMapsStart);
+  callchain.push_back(kTargetAddress2 + 1);
+
+  CallchainSamplePerfEvent event{callchain.size(), kStackSize};
+  event.ring_buffer_record.sample_id = perf_event_sample_id_tid_time_streamid_cpu{
+      .pid = kPid,
+      .tid = 11,
+      .time = 15,
+      .stream_id = 12,
+      .cpu = 0,
+      .res = 0,
+  };
+  event.ips = callchain;
+
+  EXPECT_CALL(maps_, Find(_)).WillRepeatedly(Return(&kTargetMapInfo));
+  EXPECT_CALL(maps_, Find(kUprobesMapsStart)).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(return_address_manager_, PatchCallchain).Times(0);
+  EXPECT_CALL(leaf_function_call_manager_, PatchCallerOfLeafFunction).Times(0);
+
+  orbit_grpc_protos::FullCallstackSample actual_callstack_sample;
+  EXPECT_CALL(listener_, OnCallstackSample).Times(1).WillOnce(SaveArg<0>(&actual_callstack_sample));
+
+  visitor_->Visit(&event);
+
+  EXPECT_EQ(actual_callstack_sample.callstack().type(), orbit_grpc_protos::Callstack::kInUprobes);
+  orbit_grpc_protos::UnwindingErrorsSummaryEvent summary =
+      unwinding_errors_aggregator.CreateSummaryEvent(
+          0, kPid, orbit_grpc_protos::CaptureOptions::kFramePointers, kStackSize);
+  EXPECT_EQ(summary.total_errors().in_uprobes(), 1);
+  EXPECT_EQ(summary.total_errors().unknown_map(), 0);
+}
+
 TEST_F(UprobesUnwindingVisitorTest, VisitCallchainSampleWithUprobeSendsCompleteCallstack) {
   constexpr uint32_t kPid = 10;
   constexpr uint64_t kStackSize = 13;
@@ -820,4 +1090,63 @@ TEST_F(
   EXPECT_EQ(discarded_samples_in_uretprobes_counter, 0);
 }
 
-}  // namespace orbit_linux_tracing
\ No newline at end of file
+TEST_F(UprobesUnwindingVisitorTest, VisitMmapSendsModuleUpdateOnlyIfTheModuleWasNotReportedThere) {
+  // The test binary itself is an ELF file with a build id we can create a ModuleInfo from.
+  const std::string file_path = orbit_base::GetExecutablePath().string();
+  auto module_info_or_error = orbit_object_utils::CreateModule(file_path, 0, 0);
+  ASSERT_FALSE(module_info_or_error.has_error()) << module_info_or_error.error().message();
+  if (module_info_or_error.value().build_id().empty()) {
+    GTEST_SKIP() << "test requires the test binary to have a build id";
+  }
+
+  static constexpr int32_t kPid = 10;
+  auto visit_mmap = [this, &file_path](uint64_t address, uint64_t length) {
+    perf_event_mmap_up_to_pgoff mmap_event{};
+    mmap_event.pid = kPid;
+    mmap_event.tid = kPid;
+    mmap_event.address = address;
+    mmap_event.length = length;
+    MmapPerfEvent event{kPid, /*timestamp=*/address, mmap_event, file_path};
+    visitor_->Visit(&event);
+  };
+
+  std::vector<uint64_t> reported_starts;
+  EXPECT_CALL(maps_, AddAndSort).Times(6);
+  EXPECT_CALL(listener_, OnModuleUpdate)
+      .WillRepeatedly(
+          Invoke([&reported_starts](orbit_grpc_protos::ModuleUpdateEvent module_update_event) {
+            EXPECT_EQ(module_update_event.pid(), kPid);
+            reported_starts.push_back(module_update_event.module().address_start());
+          }));
+
+  visit_mmap(0x10000, 0x1000);
+  visit_mmap(0x10000, 0x1000);
+  // A different address range.
+  visit_mmap(0x20000, 0x1000);
+  // Overlaps the first one, so that it's not the module mapped at 0x10000 any longer.
+  visit_mmap(0x0F000, 0x2000);
+  visit_mmap(0x10000, 0x1000);
+  visit_mmap(0x20000, 0x1000);
+
+  EXPECT_THAT(reported_starts, ElementsAre(0x10000, 0x20000, 0x0F000, 0x10000));
+}
+
+TEST_F(UprobesUnwindingVisitorTest, VisitMmapOfAnonymousMapAddsItWithoutModuleUpdate) {
+  constexpr int32_t kPid = 10;
+  perf_event_mmap_up_to_pgoff mmap_event{};
+  mmap_event.pid = kPid;
+  mmap_event.tid = kPid;
+  mmap_event.address = 0x10000;
+  mmap_event.length = 0x1000;
+
+  EXPECT_CALL(maps_, AddAndSort(0x10000, 0x11000, 0, PROT_READ | PROT_EXEC, "", 0)).Times(1);
+  EXPECT_CALL(listener_, OnModuleUpdate).Times(0);
+  MmapPerfEvent anon_event{kPid, 1, mmap_event, "//anon"};
+  visitor_->Visit(&anon_event);
+
+  // The jitdump file of the process is neither a map for unwinding nor a module.
+  MmapPerfEvent jitdump_event{kPid, 2, mmap_event, absl::StrFormat("/tmp/jit-%d.dump", kPid)};
+  visitor_->Visit(&jitdump_event);
+}
+
+}  // namespace orbit_linux_tracing
@@ -8,42 +8,44 @@
 #include <atomic>
 #include <memory>
 #include <thread>
-#include <utility>
 
 #include "LinuxTracing/TracerListener.h"
 #include "capture.pb.h"
 
 namespace orbit_linux_tracing {
 
+class TracerThread;
+
 class Tracer {
  public:
-  explicit Tracer(orbit_grpc_protos::CaptureOptions capture_options)
-      : capture_options_{std::move(capture_options)} {}
+  explicit Tracer(orbit_grpc_protos::CaptureOptions capture_options);
 
-  ~Tracer() { Stop(); }
+  ~Tracer();
 
   Tracer(const Tracer&) = delete;
   Tracer& operator=(const Tracer&) = delete;
-  Tracer(Tracer&&) = default;
-  Tracer& operator=(Tracer&&) = default;
+  Tracer(Tracer&&) = delete;
+  Tracer& operator=(Tracer&&) = delete;
 
   void SetListener(TracerListener* listener) { listener_ = listener; }
 
-  void Start() {
-    *exit_requested_ = false;
-    thread_ = std::make_shared<std::thread>(&Tracer::Run, this);
+  // If true, Stop only disables the perf_event_open file descriptors and ring buffers, and keeps
+  // them open ("armed"), so that a later Start only has to enable them again. Note that armed
+  // u(ret)probes stay installed in the target, they just don't produce events.
+  void SetKeepArmedAfterStop(bool keep_armed_after_stop) {
+    keep_armed_after_stop_ = keep_armed_after_stop;
   }
+  [[nodiscard]] bool IsArmed() const;
+  // Whether this Tracer is armed and can be started for a capture with `capture_options`.
+  [[nodiscard]] bool IsArmedFor(const orbit_grpc_protos::CaptureOptions& capture_options) const;
 
-  void Stop() {
-    *exit_requested_ = true;
-    if (thread_ != nullptr && thread_->joinable()) {
-      thread_->join();
-    }
-    thread_.reset();
-  }
+  void Start();
+  void Stop();
 
  private:
   orbit_grpc_protos::CaptureOptions capture_options_;
+  std::unique_ptr<TracerThread> session_;
+  bool keep_armed_after_stop_ = false;
 
   TracerListener* listener_ = nullptr;
 
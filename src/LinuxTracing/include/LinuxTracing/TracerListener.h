@@ -5,6 +5,9 @@
 #ifndef LINUX_TRACING_TRACER_LISTENER_H_
 #define LINUX_TRACING_TRACER_LISTENER_H_
 
+#include <utility>
+#include <vector>
+
 #include "capture.pb.h"
 
 namespace orbit_linux_tracing {
@@ -31,6 +34,46 @@ class TracerListener {
       orbit_grpc_protos::LostPerfRecordsEvent lost_perf_records_event) = 0;
   virtual void OnOutOfOrderEventsDiscardedEvent(
       orbit_grpc_protos::OutOfOrderEventsDiscardedEvent out_of_order_events_discarded_event) = 0;
+  virtual void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) = 0;
+
+  // Batched versions of the callbacks for the most frequent event types. The tracer collects the
+  // events of these types produced while processing a batch of perf_event_open records and passes
+  // them together, so that listeners can amortize their per-event costs (e.g., taking a lock).
+  // By default, each event is passed to the corresponding single-event callback.
+  virtual void OnSchedulingSlices(
+      std::vector<orbit_grpc_protos::SchedulingSlice> scheduling_slices) {
+    for (orbit_grpc_protos::SchedulingSlice& scheduling_slice : scheduling_slices) {
+      OnSchedulingSlice(std::move(scheduling_slice));
+    }
+  }
+  virtual void OnCallstackSamples(
+      std::vector<orbit_grpc_protos::FullCallstackSample> callstack_samples) {
+    for (orbit_grpc_protos::FullCallstackSample& callstack_sample : callstack_samples) {
+      OnCallstackSample(std::move(callstack_sample));
+    }
+  }
+  virtual void OnFunctionCalls(std::vector<orbit_grpc_protos::FunctionCall> function_calls) {
+    for (orbit_grpc_protos::FunctionCall& function_call : function_calls) {
+      OnFunctionCall(std::move(function_call));
+    }
+  }
+  virtual void OnGpuJobs(std::vector<orbit_grpc_protos::FullGpuJob> gpu_jobs) {
+    for (orbit_grpc_protos::FullGpuJob& gpu_job : gpu_jobs) {
+      OnGpuJob(std::move(gpu_job));
+    }
+  }
+  virtual void OnThreadStateSlices(
+      std::vector<orbit_grpc_protos::ThreadStateSlice> thread_state_slices) {
+    for (orbit_grpc_protos::ThreadStateSlice& thread_state_slice : thread_state_slices) {
+      OnThreadStateSlice(std::move(thread_state_slice));
+    }
+  }
+  virtual void OnAddressInfos(std::vector<orbit_grpc_protos::FullAddressInfo> full_address_infos) {
+    for (orbit_grpc_protos::FullAddressInfo& full_address_info : full_address_infos) {
+      OnAddressInfo(std::move(full_address_info));
+    }
+  }
 };
 
 }  // namespace orbit_linux_tracing
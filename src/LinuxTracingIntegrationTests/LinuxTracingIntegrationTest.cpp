@@ -309,6 +309,16 @@ class BufferTracerListener : public orbit_linux_tracing::TracerListener {
     }
   }
 
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) override {
+    orbit_grpc_protos::ProducerCaptureEvent event;
+    *event.mutable_unwinding_errors_summary_event() = std::move(unwinding_errors_summary_event);
+    {
+      absl::MutexLock lock{&events_mutex_};
+      events_.emplace_back(std::move(event));
+    }
+  }
+
   [[nodiscard]] std::vector<orbit_grpc_protos::ProducerCaptureEvent> GetAndClearEvents() {
     absl::MutexLock lock{&events_mutex_};
     std::vector<orbit_grpc_protos::ProducerCaptureEvent> events = std::move(events_);
@@ -355,8 +365,16 @@ class LinuxTracingIntegrationTestFixture {
     return capture_options;
   }
 
+  // If true, the Tracer is kept armed after StopTracingAndGetEvents and reused by the next capture
+  // with the same CaptureOptions.
+  void SetKeepTracerArmedAfterStop(bool keep_tracer_armed_after_stop) {
+    keep_tracer_armed_after_stop_ = keep_tracer_armed_after_stop;
+  }
+
+  [[nodiscard]] bool IsTracerArmed() const { return tracer_.has_value() && tracer_->IsArmed(); }
+
   void StartTracingAndWaitForTracingLoopStarted(orbit_grpc_protos::CaptureOptions capture_options) {
-    CHECK(!tracer_.has_value());
+    CHECK(!tracer_.has_value() || tracer_->IsArmed());
     CHECK(!listener_.has_value());
 
     if (IsRunningAsRoot()) {
@@ -364,7 +382,11 @@ class LinuxTracingIntegrationTestFixture {
       CHECK(capture_options.trace_context_switches());
     }
 
-    tracer_.emplace(std::move(capture_options));
+    if (!tracer_.has_value() || !tracer_->IsArmedFor(capture_options)) {
+      tracer_.reset();
+      tracer_.emplace(std::move(capture_options));
+    }
+    tracer_->SetKeepArmedAfterStop(keep_tracer_armed_after_stop_);
     listener_.emplace();
     tracer_->SetListener(&*listener_);
     tracer_->Start();
@@ -386,7 +408,9 @@ class LinuxTracingIntegrationTestFixture {
     CHECK(tracer_.has_value());
     CHECK(listener_.has_value());
     tracer_->Stop();
-    tracer_.reset();
+    if (!tracer_->IsArmed()) {
+      tracer_.reset();
+    }
     std::vector<orbit_grpc_protos::ProducerCaptureEvent> events = listener_->GetAndClearEvents();
     listener_.reset();
     return events;
@@ -394,6 +418,7 @@ class LinuxTracingIntegrationTestFixture {
 
  private:
   ChildProcess puppet_;
+  bool keep_tracer_armed_after_stop_ = false;
   std::optional<orbit_linux_tracing::Tracer> tracer_ = std::nullopt;
   std::optional<BufferTracerListener> listener_ = std::nullopt;
 };
@@ -467,6 +492,9 @@ void VerifyOrderOfAllEvents(const std::vector<orbit_grpc_protos::ProducerCapture
         EXPECT_GE(event.scheduling_slice().out_timestamp_ns(), previous_event_timestamp_ns);
         previous_event_timestamp_ns = event.scheduling_slice().out_timestamp_ns();
         break;
+      case orbit_grpc_protos::ProducerCaptureEvent::kSchedulingSlicesOnCore:
+        // Only LinuxTracingHandler encodes SchedulingSlices per core.
+        UNREACHABLE();
       case orbit_grpc_protos::ProducerCaptureEvent::kInternedCallstack:
         UNREACHABLE();
       case orbit_grpc_protos::ProducerCaptureEvent::kCallstackSample:
@@ -540,6 +568,11 @@ void VerifyOrderOfAllEvents(const std::vector<orbit_grpc_protos::ProducerCapture
         previous_event_timestamp_ns =
             event.out_of_order_events_discarded_event().end_timestamp_ns();
         break;
+      case orbit_grpc_protos::ProducerCaptureEvent::kUnwindingErrorsSummaryEvent:
+        EXPECT_GE(event.unwinding_errors_summary_event().timestamp_ns(),
+                  previous_event_timestamp_ns);
+        previous_event_timestamp_ns = event.unwinding_errors_summary_event().timestamp_ns();
+        break;
       case orbit_grpc_protos::ProducerCaptureEvent::EVENT_NOT_SET:
         UNREACHABLE();
     }
@@ -607,6 +640,45 @@ TEST(LinuxTracingIntegrationTest, SchedulingSlices) {
   EXPECT_GE(scheduling_slice_count, PuppetConstants::kSleepCount - 1);
 }
 
+TEST(LinuxTracingIntegrationTest, SchedulingSlicesWithArmedTracer) {
+  if (!CheckIsRunningAsRoot()) {
+    GTEST_SKIP();
+  }
+  LinuxTracingIntegrationTestFixture fixture;
+  fixture.SetKeepTracerArmedAfterStop(true);
+
+  // The second capture reuses the file descriptors of the first, and must neither miss events nor
+  // report the ones that were still in the ring buffers when the first capture stopped.
+  uint64_t previous_capture_last_out_timestamp_ns = 0;
+  for (int capture_index = 0; capture_index < 2; ++capture_index) {
+    std::vector<orbit_grpc_protos::ProducerCaptureEvent> events =
+        TraceAndGetEvents(&fixture, PuppetConstants::kSleepCommand);
+    EXPECT_TRUE(fixture.IsTracerArmed());
+
+    VerifyOrderOfAllEvents(events);
+
+    VerifyNoLostOrDiscardedEvents(events);
+
+    uint64_t scheduling_slice_count = 0;
+    uint64_t last_out_timestamp_ns = 0;
+    for (const auto& event : events) {
+      if (event.event_case() != orbit_grpc_protos::ProducerCaptureEvent::kSchedulingSlice) {
+        continue;
+      }
+      const orbit_grpc_protos::SchedulingSlice& scheduling_slice = event.scheduling_slice();
+      EXPECT_GT(scheduling_slice.out_timestamp_ns(), previous_capture_last_out_timestamp_ns);
+      last_out_timestamp_ns = scheduling_slice.out_timestamp_ns();
+      if (scheduling_slice.pid() == fixture.GetPuppetPid()) {
+        ++scheduling_slice_count;
+      }
+    }
+
+    LOG("capture_index=%d scheduling_slice_count=%lu", capture_index, scheduling_slice_count);
+    EXPECT_GE(scheduling_slice_count, PuppetConstants::kSleepCount - 1);
+    previous_capture_last_out_timestamp_ns = last_out_timestamp_ns;
+  }
+}
+
 void AddOuterAndInnerFunctionToCaptureOptions(orbit_grpc_protos::CaptureOptions* capture_options,
                                               pid_t pid, uint64_t outer_function_id,
                                               uint64_t inner_function_id) {
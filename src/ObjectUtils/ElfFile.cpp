@@ -29,6 +29,8 @@
 #include <llvm/Support/MathExtras.h>
 #include <llvm/Support/MemoryBuffer.h>
 
+#include <algorithm>
+#include <memory>
 #include <outcome.hpp>
 #include <type_traits>
 #include <utility>
@@ -73,6 +75,8 @@ class ElfFileImpl : public ElfFile {
   [[nodiscard]] std::string GetSoname() const override;
   [[nodiscard]] const std::filesystem::path& GetFilePath() const override;
   [[nodiscard]] ErrorMessageOr<LineInfo> GetLineInfo(uint64_t address) override;
+  [[nodiscard]] ErrorMessageOr<std::vector<LineTableRow>> GetLineTable(uint64_t address,
+                                                                      uint64_t size) override;
   [[nodiscard]] ErrorMessageOr<LineInfo> GetDeclarationLocationOfFunction(
       uint64_t address) override;
   [[nodiscard]] std::optional<GnuDebugLinkInfo> GetGnuDebugLinkInfo() const override;
@@ -87,6 +91,8 @@ class ElfFileImpl : public ElfFile {
   llvm::object::OwningBinary<llvm::object::ObjectFile> owning_binary_;
   llvm::object::ELFObjectFile<ElfT>* object_file_;
   llvm::symbolize::LLVMSymbolizer symbolizer_;
+  // Created on the first call to GetLineTable.
+  std::unique_ptr<llvm::DWARFContext> dwarf_context_;
   std::string build_id_;
   std::string soname_;
   bool has_symtab_section_;
@@ -495,6 +501,34 @@ ErrorMessageOr<LineInfo> orbit_object_utils::ElfFileImpl<ElfT>::GetLineInfo(uint
   return line_info;
 }
 
+template <typename ElfT>
+ErrorMessageOr<std::vector<LineTableRow>> orbit_object_utils::ElfFileImpl<ElfT>::GetLineTable(
+    uint64_t address, uint64_t size) {
+  CHECK(has_debug_info_section_);
+  if (dwarf_context_ == nullptr) {
+    dwarf_context_ = llvm::DWARFContext::create(*owning_binary_.getBinary());
+    if (dwarf_context_ == nullptr) return ErrorMessage{"Could not read DWARF information."};
+  }
+
+  const llvm::DILineInfoTable rows = dwarf_context_->getLineInfoForAddressRange(
+      {address, llvm::object::SectionedAddress::UndefSection}, size);
+
+  std::vector<LineTableRow> line_table;
+  line_table.reserve(rows.size());
+  for (const auto& [row_address, unused_innermost_line_info] : rows) {
+    // The first row can start before `address`.
+    const uint64_t row_start = std::max<uint64_t>(row_address, address);
+    if (!line_table.empty() && line_table.back().address == row_start) continue;
+
+    // The line table only has the location in the innermost inlined function, so the location in
+    // the outermost function is looked up once per row.
+    ErrorMessageOr<LineInfo> line_info_or_error = GetLineInfo(row_start);
+    LineTableRow& row = line_table.emplace_back(LineTableRow{row_start, LineInfo{}});
+    if (line_info_or_error.has_value()) row.line_info = std::move(line_info_or_error.value());
+  }
+  return line_table;
+}
+
 template <typename ElfT>
 ErrorMessageOr<LineInfo> orbit_object_utils::ElfFileImpl<ElfT>::GetDeclarationLocationOfFunction(
     uint64_t address) {
@@ -5,6 +5,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <iterator>
 #include <memory>
@@ -28,6 +29,7 @@ using orbit_grpc_protos::SymbolInfo;
 using orbit_object_utils::CreateElfFile;
 using orbit_object_utils::CreateElfFileFromBuffer;
 using orbit_object_utils::ElfFile;
+using orbit_object_utils::LineTableRow;
 
 TEST(ElfFile, LoadDebugSymbols) {
   std::filesystem::path file_path =
@@ -329,6 +331,43 @@ TEST(ElfFile, LineInfoInlining) {
             "LineInfoTestBinary.cpp");
 }
 
+TEST(ElfFile, LineTableMatchesLineInfoOfEachRow) {
+  const std::filesystem::path file_path =
+      orbit_base::GetExecutableDir() / "testdata" / "line_info_test_binary";
+
+  auto program = CreateElfFile(file_path);
+  ASSERT_THAT(program, HasNoError());
+
+  constexpr uint64_t kAddressOfMainFunction = 0x401140;
+  constexpr uint64_t kSizeOfMainFunction = 16;
+  ErrorMessageOr<std::vector<LineTableRow>> line_table =
+      program.value()->GetLineTable(kAddressOfMainFunction, kSizeOfMainFunction);
+  ASSERT_THAT(line_table, HasNoError());
+  ASSERT_FALSE(line_table.value().empty());
+  EXPECT_EQ(line_table.value().front().address, kAddressOfMainFunction);
+
+  // The inlined call to PrintHelloWorld starts a new row, located at the call site in main.
+  static constexpr uint64_t kFirstInstructionOfInlinedPrintHelloWorld = 0x401141;
+  EXPECT_TRUE(std::any_of(line_table.value().begin(), line_table.value().end(),
+                          [](const LineTableRow& row) {
+                            return row.address == kFirstInstructionOfInlinedPrintHelloWorld &&
+                                   row.line_info.source_line() == 13;
+                          }));
+
+  uint64_t previous_address = 0;
+  for (const LineTableRow& row : line_table.value()) {
+    EXPECT_GT(row.address, previous_address);
+    EXPECT_LT(row.address, kAddressOfMainFunction + kSizeOfMainFunction);
+    previous_address = row.address;
+
+    ErrorMessageOr<orbit_grpc_protos::LineInfo> line_info =
+        program.value()->GetLineInfo(row.address);
+    ASSERT_THAT(line_info, HasNoError());
+    EXPECT_EQ(row.line_info.source_file(), line_info.value().source_file());
+    EXPECT_EQ(row.line_info.source_line(), line_info.value().source_line());
+  }
+}
+
 TEST(ElfFile, CompressedDebugInfo) {
   const std::filesystem::path file_path =
       orbit_base::GetExecutableDir() / "testdata" / "line_info_test_binary_compressed";
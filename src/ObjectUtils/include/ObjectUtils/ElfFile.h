@@ -31,6 +31,13 @@ struct GnuDebugLinkInfo {
   uint32_t crc32_checksum;
 };
 
+// A row of the line table, see ElfFile::GetLineTable. The row applies to all addresses from
+// `address` up to the address of the next row.
+struct LineTableRow {
+  uint64_t address;
+  orbit_grpc_protos::LineInfo line_info;
+};
+
 class ElfFile : public ObjectFile {
  public:
   ElfFile() = default;
@@ -47,6 +54,12 @@ class ElfFile : public ObjectFile {
   [[nodiscard]] virtual std::string GetBuildId() const = 0;
   [[nodiscard]] virtual ErrorMessageOr<orbit_grpc_protos::LineInfo> GetLineInfo(
       uint64_t address) = 0;
+  // Returns the rows of the line table covering [address, address + size), ordered by address.
+  // Like GetLineInfo, the source location of inlined code is the one in the outermost function.
+  // Rows without a valid location have a source line of 0. This is considerably cheaper than calling
+  // GetLineInfo for every instruction of a function, as rows only start where the location changes.
+  [[nodiscard]] virtual ErrorMessageOr<std::vector<LineTableRow>> GetLineTable(uint64_t address,
+                                                                              uint64_t size) = 0;
   [[nodiscard]] virtual ErrorMessageOr<orbit_grpc_protos::LineInfo>
   GetDeclarationLocationOfFunction(uint64_t address) = 0;
   [[nodiscard]] virtual std::optional<GnuDebugLinkInfo> GetGnuDebugLinkInfo() const = 0;
@@ -36,7 +36,7 @@ class CaptureClientGgpClient::CaptureClientGgpClientImpl {
  public:
   void SetupGrpcClient(const std::string& grpc_server_address);
 
-  [[nodiscard]] ErrorMessageOr<void> StartCapture();
+  [[nodiscard]] ErrorMessageOr<void> StartCapture(uint32_t retroactive_capture_s);
   [[nodiscard]] ErrorMessageOr<void> StopCapture();
   [[nodiscard]] ErrorMessageOr<void> UpdateSelectedFunctions(
       const std::vector<std::string>& selected_functions);
@@ -51,8 +51,10 @@ CaptureClientGgpClient::CaptureClientGgpClient(const std::string& grpc_server_ad
   pimpl->SetupGrpcClient(grpc_server_address);
 }
 
-int CaptureClientGgpClient::StartCapture() {
-  ErrorMessageOr<void> result = pimpl->StartCapture();
+CaptureClientGgpClient::CaptureClientGgpClient() = default;
+
+int CaptureClientGgpClient::StartCapture(uint32_t retroactive_capture_s) {
+  ErrorMessageOr<void> result = pimpl->StartCapture(retroactive_capture_s);
   if (result.has_error()) {
     ERROR("Not possible to start capture: %s", result.error().message());
     return 0;
@@ -101,8 +103,10 @@ void CaptureClientGgpClient::CaptureClientGgpClientImpl::SetupGrpcClient(
   capture_client_ggp_service_ = orbit_grpc_protos::CaptureClientGgpService::NewStub(grpc_channel);
 }
 
-ErrorMessageOr<void> CaptureClientGgpClient::CaptureClientGgpClientImpl::StartCapture() {
+ErrorMessageOr<void> CaptureClientGgpClient::CaptureClientGgpClientImpl::StartCapture(
+    uint32_t retroactive_capture_s) {
   StartCaptureRequest request;
+  request.set_retroactive_capture_s(retroactive_capture_s);
   StartCaptureResponse response;
   auto context = std::make_unique<ClientContext>();
 
@@ -113,6 +117,11 @@ ErrorMessageOr<void> CaptureClientGgpClient::CaptureClientGgpClientImpl::StartCa
           status.error_code());
     return ErrorMessage(status.error_message());
   }
+  if (retroactive_capture_s > response.retroactive_capture_s()) {
+    LOG("Capture started; it only contains %us of the %us requested before its start",
+        response.retroactive_capture_s(), retroactive_capture_s);
+    return outcome::success();
+  }
   LOG("Capture started");
   return outcome::success();
 }
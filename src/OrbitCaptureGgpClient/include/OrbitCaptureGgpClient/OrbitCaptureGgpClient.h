@@ -5,21 +5,31 @@
 #ifndef ORBIT_CAPTURE_GGP_CLIENT_ORBIT_CAPTURE_GGP_CLIENT_H_
 #define ORBIT_CAPTURE_GGP_CLIENT_ORBIT_CAPTURE_GGP_CLIENT_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
 #include <vector>
 
+// The methods are virtual so that the users of this client can be tested with a fake that does not
+// need an OrbitCaptureGgpService.
 class CaptureClientGgpClient {
  public:
   explicit CaptureClientGgpClient(const std::string& grpc_server_address);
-  ~CaptureClientGgpClient();
+  virtual ~CaptureClientGgpClient();
   CaptureClientGgpClient(CaptureClientGgpClient&&);
   CaptureClientGgpClient& operator=(CaptureClientGgpClient&&);
 
-  int StartCapture();
-  int StopCapture();
-  int UpdateSelectedFunctions(const std::vector<std::string>& selected_functions);
-  void ShutdownService();
+  // Starts a capture. If `retroactive_capture_s` is not zero, the capture also contains the data of
+  // up to that many seconds before the call, as far as the service supports it.
+  virtual int StartCapture(uint32_t retroactive_capture_s);
+  virtual int StopCapture();
+  virtual int UpdateSelectedFunctions(const std::vector<std::string>& selected_functions);
+  virtual void ShutdownService();
+
+ protected:
+  // For fakes, which do not connect to a service.
+  CaptureClientGgpClient();
 
  private:
   class CaptureClientGgpClientImpl;
@@ -50,7 +50,7 @@ int main(int argc, char** argv) {
     switch (i) {
       case kStartCaptureCommand:
         LOG("Chosen %d: Start capture", i);
-        ggp_capture_client.StartCapture();
+        ggp_capture_client.StartCapture(/*retroactive_capture_s=*/0);
         break;
       case kStopAndSaveCaptureCommand:
         LOG("Chosen %d: Stop and save capture", i);
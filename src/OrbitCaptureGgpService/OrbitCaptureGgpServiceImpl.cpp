@@ -64,12 +64,19 @@ void CaptureClientGgpServiceImpl::InitClientGgp() {
 }
 
 Status CaptureClientGgpServiceImpl::StartCapture(ServerContext* /*context*/,
-                                                 const StartCaptureRequest* /*request*/,
-                                                 StartCaptureResponse* /*response*/) {
+                                                 const StartCaptureRequest* request,
+                                                 StartCaptureResponse* response) {
   LOG("Start capture grpc call received");
   if (CaptureIsRunning()) {
     return Status(StatusCode::INTERNAL, "A capture is already running");
   }
+  // No data is collected while no capture is running, so the capture can't contain anything that
+  // happened before this request.
+  if (request->retroactive_capture_s() > 0) {
+    LOG("Retroactive capture of %us requested, which is not supported",
+        request->retroactive_capture_s());
+  }
+  response->set_retroactive_capture_s(0);
 
   auto start_capture_result = client_ggp_->RequestStartCapture(thread_pool_.get());
 
@@ -19,11 +19,13 @@
 #include <memory>
 #include <outcome.hpp>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
 #include "CaptureClient/CaptureClient.h"
 #include "CaptureClient/CaptureListener.h"
+#include "ClientData/FunctionTable.h"
 #include "ClientData/FunctionUtils.h"
 #include "ClientData/ProcessData.h"
 #include "ClientData/UserDefinedCaptureData.h"
@@ -48,6 +50,8 @@ using orbit_capture_client::CaptureClient;
 using orbit_capture_client::CaptureEventProcessor;
 using orbit_capture_client::CaptureListener;
 
+using orbit_client_data::FunctionHandle;
+using orbit_client_data::FunctionTable;
 using orbit_client_data::ProcessData;
 using orbit_client_data::TracepointInfoSet;
 
@@ -131,7 +135,7 @@ ErrorMessageOr<void> ClientGgp::RequestStartCapture(ThreadPool* thread_pool) {
       selected_tracepoints, options_.samples_per_second, options_.stack_dump_size, unwinding_method,
       collect_scheduling_info, collect_thread_state, collect_gpu_jobs, enable_api,
       enable_introspection, enable_user_space_instrumentation,
-      max_local_marker_depth_per_command_buffer, false, 0, std::move(event_processor));
+      max_local_marker_depth_per_command_buffer, false, 0, 0, 0, std::move(event_processor));
 
   orbit_base::ImmediateExecutor executor;
 
@@ -278,9 +282,9 @@ void ClientGgp::InformUsedSelectedCaptureFunctions(
   }
 }
 
-std::string ClientGgp::SelectedFunctionMatch(const FunctionInfo& func) {
+std::string ClientGgp::SelectedFunctionMatch(std::string_view pretty_name) {
   for (const std::string& selected_function : options_.capture_functions) {
-    if (func.pretty_name().find(selected_function) != std::string::npos) {
+    if (pretty_name.find(selected_function) != std::string_view::npos) {
       return selected_function;
     }
   }
@@ -291,10 +295,11 @@ absl::flat_hash_map<uint64_t, FunctionInfo> ClientGgp::GetSelectedFunctions() {
   uint64_t function_id = 1;
   absl::flat_hash_map<uint64_t, FunctionInfo> selected_functions;
   absl::flat_hash_set<std::string> capture_functions_used;
-  for (const FunctionInfo* func : main_module_->GetFunctions()) {
-    const std::string& selected_function_match = SelectedFunctionMatch(*func);
+  std::shared_ptr<const FunctionTable> functions = main_module_->GetFunctions();
+  for (FunctionHandle func : *functions) {
+    const std::string& selected_function_match = SelectedFunctionMatch(func.pretty_name());
     if (!selected_function_match.empty()) {
-      selected_functions[function_id++] = *func;
+      selected_functions[function_id++] = func.CreateFunctionInfo();
       if (!capture_functions_used.contains(selected_function_match)) {
         capture_functions_used.insert(selected_function_match);
       }
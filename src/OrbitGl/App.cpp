@@ -49,6 +49,7 @@
 #include "ClientModel/CaptureDeserializer.h"
 #include "ClientModel/CaptureSerializer.h"
 #include "ClientModel/SamplingDataPostProcessor.h"
+#include "ClientModel/UnwindingErrorsRecommendation.h"
 #include "CodeReport/Disassembler.h"
 #include "CodeReport/DisassemblyReport.h"
 #include "CodeReport/SourceCodeReport.h"
@@ -374,6 +375,7 @@ Future<void> OrbitApp::OnCaptureComplete() {
                           GetCaptureData().GetCallstackData()->GetUniqueCallstacksCopy());
         SetTopDownView(GetCaptureData());
         SetBottomUpView(GetCaptureData());
+        SetFlameGraph(GetCaptureData());
 
         CHECK(capture_stopped_callback_);
         capture_stopped_callback_();
@@ -413,8 +415,15 @@ void OrbitApp::OnTimer(const TimerInfo& timer_info) {
   }
 
   CaptureData& capture_data = GetMutableCaptureData();
-  uint64_t elapsed_nanos = timer_info.end() - timer_info.start();
-  capture_data.UpdateFunctionStats(timer_info.function_id(), elapsed_nanos);
+  if (timer_info.num_coalesced_calls() > 0) {
+    capture_data.UpdateFunctionStats(
+        timer_info.function_id(), timer_info.num_coalesced_calls(),
+        timer_info.coalesced_total_duration_ns(), timer_info.coalesced_min_duration_ns(),
+        timer_info.coalesced_max_duration_ns());
+  } else {
+    uint64_t elapsed_nanos = timer_info.end() - timer_info.start();
+    capture_data.UpdateFunctionStats(timer_info.function_id(), elapsed_nanos);
+  }
 
   const InstrumentedFunction& func =
       capture_data.instrumented_functions().at(timer_info.function_id());
@@ -616,6 +625,33 @@ void OrbitApp::OnOutOfOrderEventsDiscardedEvent(
   });
 }
 
+void OrbitApp::OnUnwindingErrorsSummaryEvent(
+    orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) {
+  main_thread_executor_->Schedule(
+      [this, unwinding_errors_summary_event = std::move(unwinding_errors_summary_event)]() {
+        const uint64_t timestamp_ns = unwinding_errors_summary_event.timestamp_ns();
+        std::optional<orbit_client_model::UnwindingSettingsRecommendation> recommendation =
+            orbit_client_model::RecommendUnwindingSettings(unwinding_errors_summary_event);
+        main_window_->AppendToCaptureLog(
+            recommendation.has_value() ? MainWindowInterface::CaptureLogSeverity::kWarning
+                                       : MainWindowInterface::CaptureLogSeverity::kInfo,
+            GetCaptureTimeAt(timestamp_ns),
+            orbit_client_model::CreateUnwindingErrorsSummaryMessage(
+                unwinding_errors_summary_event));
+        if (!recommendation.has_value()) return;
+
+        main_window_->AppendToCaptureLog(MainWindowInterface::CaptureLogSeverity::kWarning,
+                                         GetCaptureTimeAt(timestamp_ns), recommendation->message);
+        if (!IsLoadingCapture()) {
+          constexpr const char* kDontShowAgainUnwindingSettingsRecommendationKey =
+              "DontShowAgainUnwindingSettingsRecommendation";
+          main_window_->ShowWarningWithDontShowAgainCheckboxIfNeeded(
+              "Unwinding settings", recommendation->message,
+              kDontShowAgainUnwindingSettingsRecommendationKey);
+        }
+      });
+}
+
 void OrbitApp::OnValidateFramePointers(std::vector<const ModuleData*> modules_to_validate) {
   thread_pool_->Schedule([modules_to_validate = std::move(modules_to_validate), this] {
     frame_pointer_validator_client_->AnalyzeModules(modules_to_validate);
@@ -909,6 +945,8 @@ void OrbitApp::MainTick() {
     RequestUpdatePrimitives();
     DoZoom = false;
   }
+
+  MaybeUpdateFlameGraphDuringCapture();
 }
 
 void OrbitApp::SetCaptureWindow(CaptureWindow* capture) {
@@ -929,6 +967,11 @@ void OrbitApp::SetIntrospectionWindow(IntrospectionWindow* introspection_window)
   introspection_window_ = introspection_window;
 }
 
+void OrbitApp::SetFlameGraphWindow(FlameGraphWindow* flame_graph_window) {
+  CHECK(flame_graph_window_ == nullptr);
+  flame_graph_window_ = flame_graph_window;
+}
+
 void OrbitApp::StopIntrospection() {
   if (introspection_window_) {
     introspection_window_->StopIntrospection();
@@ -1016,6 +1059,43 @@ void OrbitApp::SetBottomUpView(const CaptureData& capture_data) {
   bottom_up_view_callback_(std::move(bottom_up_view));
 }
 
+void OrbitApp::SetFlameGraph(const CaptureData& capture_data) {
+  if (flame_graph_window_ == nullptr) return;
+  flame_graph_window_->SetSamplingData(capture_data.post_processed_sampling_data(), &capture_data);
+}
+
+void OrbitApp::ClearFlameGraph() {
+  if (flame_graph_window_ == nullptr) return;
+  flame_graph_window_->ClearSamplingData();
+}
+
+void OrbitApp::MaybeUpdateFlameGraphDuringCapture() {
+  if (flame_graph_window_ == nullptr || !IsCapturing() || !HasCaptureData() ||
+      is_flame_graph_update_in_progress_ ||
+      flame_graph_update_timer_.ElapsedMillis() < kFlameGraphUpdateIntervalMs) {
+    return;
+  }
+
+  is_flame_graph_update_in_progress_ = true;
+  // The capture data stays alive while the task runs, even if the capture gets cleared meanwhile.
+  // The callstacks and address infos it reads are synchronized with the capture thread.
+  std::shared_ptr<const CaptureData> capture_data = capture_data_;
+  thread_pool_->Schedule([this, capture_data = std::move(capture_data)] {
+    PostProcessedSamplingData post_processed_sampling_data =
+        orbit_client_model::CreatePostProcessedSamplingData(*capture_data->GetCallstackData(),
+                                                            *capture_data);
+    main_thread_executor_->Schedule(
+        [this, capture_data, post_processed_sampling_data =
+                                 std::move(post_processed_sampling_data)] {
+          is_flame_graph_update_in_progress_ = false;
+          flame_graph_update_timer_.Restart();
+          // The final sampling data is set when the capture completes.
+          if (!IsCapturing() || capture_data_ != capture_data) return;
+          flame_graph_window_->SetSamplingData(post_processed_sampling_data, capture_data.get());
+        });
+  });
+}
+
 void OrbitApp::ClearBottomUpView() {
   CHECK(bottom_up_view_callback_);
   bottom_up_view_callback_(std::make_unique<CallTreeView>());
@@ -1323,6 +1403,10 @@ void OrbitApp::StartCapture() {
 
   bool collect_memory_info = data_manager_->collect_memory_info();
   uint64_t memory_sampling_period_ms = data_manager_->memory_sampling_period_ms();
+  uint64_t function_call_coalescing_threshold_ns =
+      data_manager_->function_call_coalescing_threshold_ns();
+  uint64_t function_call_coalescing_max_gap_ns =
+      data_manager_->function_call_coalescing_max_gap_ns();
 
   // In metrics, -1 indicates memory collection was turned off. See also the comment in
   // orbit_log_event.proto
@@ -1369,6 +1453,7 @@ void OrbitApp::StartCapture() {
       collect_scheduling_info, collect_thread_states, collect_gpu_jobs, enable_api,
       enable_introspection, enable_user_space_instrumentation,
       max_local_marker_depth_per_command_buffer, collect_memory_info, memory_sampling_period_ms,
+      function_call_coalescing_threshold_ns, function_call_coalescing_max_gap_ns,
       std::move(capture_event_processor));
 
   // TODO(b/187250643): Refactor this to be more readable and maybe remove parts that are not needed
@@ -2159,6 +2244,11 @@ void OrbitApp::SetMaxLocalMarkerDepthPerCommandBuffer(
       max_local_marker_depth_per_command_buffer);
 }
 
+void OrbitApp::SetFunctionCallCoalescingThresholdNs(
+    uint64_t function_call_coalescing_threshold_ns) {
+  data_manager_->set_function_call_coalescing_threshold_ns(function_call_coalescing_threshold_ns);
+}
+
 void OrbitApp::SelectFunction(const orbit_client_protos::FunctionInfo& func) {
   LOG("Selected %s (address_=0x%" PRIx64 ", loaded_module_path_=%s)", func.pretty_name(),
       func.address(), func.module_path());
@@ -2320,6 +2410,7 @@ void OrbitApp::UpdateAfterSymbolLoading() {
     GetMutableCaptureData().set_post_processed_sampling_data(post_processed_sampling_data);
     SetTopDownView(capture_data);
     SetBottomUpView(capture_data);
+    SetFlameGraph(capture_data);
   }
 
   if (selection_report_ == nullptr) {
@@ -2348,6 +2439,7 @@ void OrbitApp::UpdateAfterCaptureCleared() {
   ClearTopDownView();
   ClearSelectionTopDownView();
   ClearBottomUpView();
+  ClearFlameGraph();
   ClearSelectionBottomUpView();
   if (selection_report_ != nullptr) {
     SetSelectionReport(std::move(empty_post_processed_sampling_data), empty_unique_callstacks,
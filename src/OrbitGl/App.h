@@ -52,6 +52,7 @@
 #include "DataViews/FunctionsDataView.h"
 #include "DataViews/PresetLoadState.h"
 #include "DataViews/PresetsDataView.h"
+#include "FlameGraphWindow.h"
 #include "FramePointerValidatorClient.h"
 #include "FrameTrackOnlineProcessor.h"
 #include "GlCanvas.h"
@@ -72,6 +73,7 @@
 #include "StatusListener.h"
 #include "StringManager.h"
 #include "Symbols/SymbolHelper.h"
+#include "Timer.h"
 #include "TracepointsDataView.h"
 #include "capture.pb.h"
 #include "capture_data.pb.h"
@@ -167,6 +169,8 @@ class OrbitApp final : public DataViewFactory,
       orbit_grpc_protos::LostPerfRecordsEvent lost_perf_records_event) override;
   void OnOutOfOrderEventsDiscardedEvent(orbit_grpc_protos::OutOfOrderEventsDiscardedEvent
                                             out_of_order_events_discarded_event) override;
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) override;
 
   void OnValidateFramePointers(
       std::vector<const orbit_client_data::ModuleData*> modules_to_validate);
@@ -183,6 +187,7 @@ class OrbitApp final : public DataViewFactory,
   void SetDebugCanvas(GlCanvas* debug_canvas);
   void SetIntrospectionWindow(IntrospectionWindow* canvas);
   void StopIntrospection();
+  void SetFlameGraphWindow(FlameGraphWindow* flame_graph_window);
 
   void SetSamplingReport(
       orbit_client_data::PostProcessedSamplingData post_processed_sampling_data,
@@ -202,6 +207,11 @@ class OrbitApp final : public DataViewFactory,
 
   void SetBottomUpView(const orbit_client_model::CaptureData& capture_data);
   void ClearBottomUpView();
+  void SetFlameGraph(const orbit_client_model::CaptureData& capture_data);
+  void ClearFlameGraph();
+  // Recomputes the sampling data of the ongoing capture on the thread pool and shows it in the
+  // flame graph, at most once per kFlameGraphUpdateIntervalMs.
+  void MaybeUpdateFlameGraphDuringCapture();
   void SetSelectionBottomUpView(
       const orbit_client_data::PostProcessedSamplingData& selection_post_processed_data,
       const orbit_client_model::CaptureData& capture_data);
@@ -367,6 +377,7 @@ class OrbitApp final : public DataViewFactory,
     return process_manager_;
   }
   [[nodiscard]] MainThreadExecutor* GetMainThreadExecutor() { return main_thread_executor_; }
+  [[nodiscard]] ThreadPool* GetThreadPool() { return thread_pool_.get(); }
   [[nodiscard]] orbit_client_data::ProcessData* GetMutableTargetProcess() const { return process_; }
   [[nodiscard]] const orbit_client_data::ProcessData* GetTargetProcess() const override {
     return process_;
@@ -391,6 +402,8 @@ class OrbitApp final : public DataViewFactory,
   void SetStackDumpSize(uint16_t stack_dump_size);
   void SetUnwindingMethod(orbit_grpc_protos::UnwindingMethod unwinding_method);
   void SetMaxLocalMarkerDepthPerCommandBuffer(uint64_t max_local_marker_depth_per_command_buffer);
+  // 0 disables coalescing of short function calls.
+  void SetFunctionCallCoalescingThresholdNs(uint64_t function_call_coalescing_threshold_ns);
 
   void SetCollectMemoryInfo(bool collect_memory_info) {
     data_manager_->set_collect_memory_info(collect_memory_info);
@@ -554,8 +567,13 @@ class OrbitApp final : public DataViewFactory,
 
   CaptureWindow* capture_window_ = nullptr;
   IntrospectionWindow* introspection_window_ = nullptr;
+  FlameGraphWindow* flame_graph_window_ = nullptr;
   GlCanvas* debug_canvas_ = nullptr;
 
+  static constexpr double kFlameGraphUpdateIntervalMs = 1000.0;
+  Timer flame_graph_update_timer_;
+  bool is_flame_graph_update_in_progress_ = false;
+
   std::shared_ptr<SamplingReport> sampling_report_;
   std::shared_ptr<SamplingReport> selection_report_ = nullptr;
 
@@ -591,7 +609,8 @@ class OrbitApp final : public DataViewFactory,
   // TODO(b/166767590): This is mostly written during capture by the capture thread on the
   //  CaptureListener parts of App, but may be read also during capturing by all threads.
   //  Currently, it is not properly synchronized (and thus it can't live at DataManager).
-  std::unique_ptr<orbit_client_model::CaptureData> capture_data_;
+  //  It is shared with the tasks that post-process the sampling data during the capture.
+  std::shared_ptr<orbit_client_model::CaptureData> capture_data_;
 
   orbit_gl::FrameTrackOnlineProcessor frame_track_online_processor_;
 
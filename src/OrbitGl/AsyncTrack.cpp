@@ -111,7 +111,7 @@ void AsyncTrack::SetTimesliceText(const TimerInfo& timer_info, float min_x, floa
   const auto& box_size = text_box->GetSize();
   float pos_x = std::max(box_pos.first, min_x);
   float max_size = box_pos.first + box_size.first - pos_x;
-  text_renderer_->AddTextTrailingCharsPrioritized(
+  time_graph_->GetTextRendererForUpdate()->AddTextTrailingCharsPrioritized(
       text_box->GetText().c_str(), pos_x, box_pos.second + layout_->GetTextOffset(),
       GlCanvas::kZValueBox + z_offset, kTextWhite, text_box->GetElapsedTimeTextLength(),
       layout_->CalculateZoomedFontSize(), max_size);
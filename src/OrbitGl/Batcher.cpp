@@ -200,9 +200,7 @@ void Batcher::AddBox(const Box& box, const std::array<Color, 4>& colors, const C
   }
   float layer_z_value = rounded_box.vertices[0][2];
   auto& buffer = primitive_buffers_by_layer_[layer_z_value];
-  buffer.box_buffer.boxes_.emplace_back(rounded_box);
-  buffer.box_buffer.colors_.push_back(colors);
-  buffer.box_buffer.picking_colors_.push_back_n(picking_color, 4);
+  buffer.box_buffer.boxes_.emplace_back(rounded_box, colors, picking_color);
   user_data_.push_back(std::move(user_data));
 }
 
@@ -313,6 +311,10 @@ const orbit_client_data::TextBox* Batcher::GetTextBox(PickingId id) const {
     return data->text_box_;
   }
 
+  if (data && data->create_text_box_) {
+    return data->create_text_box_();
+  }
+
   return nullptr;
 }
 
@@ -355,6 +357,7 @@ void Batcher::ResetElements() {
   for (auto& [unused_layer, buffer] : primitive_buffers_by_layer_) {
     buffer.Reset();
   }
+  picking_index_by_layer_.clear();
 }
 
 void Batcher::StartNewFrame() {
@@ -400,23 +403,86 @@ void Batcher::Draw(bool picking) const {
   }
 }
 
-void Batcher::DrawBoxBuffer(float layer, bool picking) const {
-  auto& box_buffer = primitive_buffers_by_layer_.at(layer).box_buffer;
-  const Block<Box, BoxBuffer::NUM_BOXES_PER_BLOCK>* box_block = box_buffer.boxes_.root();
-  const Block<Color, BoxBuffer::NUM_BOXES_PER_BLOCK * 4>* color_block;
+std::optional<PickingId> Batcher::PickLayer(float layer, const Vec2& pos,
+                                            bool decorations_occlude) const {
+  ORBIT_SCOPE_FUNCTION;
+  auto buffers_it = primitive_buffers_by_layer_.find(layer);
+  if (buffers_it == primitive_buffers_by_layer_.end()) return std::nullopt;
 
-  color_block = !picking ? box_buffer.colors_.root() : box_buffer.picking_colors_.root();
+  auto [index_it, inserted] = picking_index_by_layer_.try_emplace(layer);
+  if (inserted) {
+    BuildPickingIndex(buffers_it->second, &index_it->second);
+  }
+  return index_it->second.Find(pos, decorations_occlude);
+}
 
-  while (box_block != nullptr) {
-    if (auto num_elems = box_block->size()) {
-      glVertexPointer(3, GL_FLOAT, sizeof(Vec3), box_block->data());
-      glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Color), color_block->data());
-      glDrawArrays(GL_QUADS, 0, num_elems * 4);
+bool Batcher::IsDecoration(PickingId id) const {
+  if (id.type == PickingType::kPickable) return false;
+  CHECK(id.element_id < user_data_.size());
+  return user_data_[id.element_id] == nullptr;
+}
+
+void Batcher::BuildPickingIndex(const PrimitiveBuffers& buffers,
+                                orbit_gl::SpatialPickingIndex* picking_index) const {
+  // The order in which primitives are added has to match the order in which DrawLayer() draws
+  // them: boxes first, then lines, then triangles.
+  for (const orbit_gl::BoxInstance& box : buffers.box_buffer.boxes_) {
+    PickingId id = PickingId::FromColor(box.picking_color);
+    picking_index->AddBox(box.GetBox(0.f), id, IsDecoration(id));
+  }
+
+  auto line_picking_color_it = buffers.line_buffer.picking_colors_.begin();
+  for (const Line& line : buffers.line_buffer.lines_) {
+    PickingId id = PickingId::FromColor(*line_picking_color_it);
+    picking_index->AddLine(line, id, IsDecoration(id));
+    for (size_t i = 0; i < 2; ++i) ++line_picking_color_it;
+  }
+
+  auto triangle_picking_color_it = buffers.triangle_buffer.picking_colors_.begin();
+  for (const Triangle& triangle : buffers.triangle_buffer.triangles_) {
+    PickingId id = PickingId::FromColor(*triangle_picking_color_it);
+    picking_index->AddTriangle(triangle, id, IsDecoration(id));
+    for (size_t i = 0; i < 3; ++i) ++triangle_picking_color_it;
+  }
+
+  picking_index->Build();
+}
+
+void Batcher::DrawBoxBuffer(float layer, bool picking) const {
+  auto& box_buffer = primitive_buffers_by_layer_.at(layer).box_buffer;
+  const bool use_instancing =
+      instanced_box_renderer_ != nullptr && instanced_box_renderer_->IsSupported();
+
+  for (const Block<orbit_gl::BoxInstance, BoxBuffer::NUM_BOXES_PER_BLOCK>* box_block =
+           box_buffer.boxes_.root();
+       box_block != nullptr; box_block = box_block->next()) {
+    if (box_block->size() == 0) continue;
+    if (use_instancing) {
+      instanced_box_renderer_->Draw(box_block->data(), box_block->size(), layer, picking);
+    } else {
+      DrawBoxBlockWithVertexArrays(box_block->data(), box_block->size(), layer, picking);
     }
+  }
+}
 
-    box_block = box_block->next();
-    color_block = color_block->next();
+void Batcher::DrawBoxBlockWithVertexArrays(const orbit_gl::BoxInstance* boxes, size_t num_boxes,
+                                           float z, bool picking) const {
+  expanded_boxes_.clear();
+  expanded_box_colors_.clear();
+  for (size_t i = 0; i < num_boxes; ++i) {
+    const orbit_gl::BoxInstance& box = boxes[i];
+    expanded_boxes_.push_back(box.GetBox(z));
+    if (picking) {
+      expanded_box_colors_.insert(expanded_box_colors_.end(), 4, box.picking_color);
+    } else {
+      const std::array<Color, 4> colors = box.GetColors();
+      expanded_box_colors_.insert(expanded_box_colors_.end(), colors.begin(), colors.end());
+    }
   }
+
+  glVertexPointer(3, GL_FLOAT, sizeof(Vec3), expanded_boxes_.data());
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Color), expanded_box_colors_.data());
+  glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(num_boxes * 4));
 }
 
 void Batcher::DrawLineBuffer(float layer, bool picking) const {
@@ -12,22 +12,30 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "BlockChain.h"
+#include "BoxInstance.h"
 #include "ClientData/TextBox.h"
 #include "CoreMath.h"
 #include "Geometry.h"
+#include "InstancedBoxRenderer.h"
 #include "PickingManager.h"
+#include "SpatialPickingIndex.h"
 
 using TooltipCallback = std::function<std::string(PickingId)>;
+using TextBoxCallback = std::function<const orbit_client_data::TextBox*()>;
 
 struct PickingUserData {
   const orbit_client_data::TextBox* text_box_;
   TooltipCallback generate_tooltip_;
+  // Alternative to text_box_ for primitives that are not backed by a TextBox: creates the TextBox
+  // of the primitive only once it is picked.
+  TextBoxCallback create_text_box_ = nullptr;
   const void* custom_data_ = nullptr;
 
   explicit PickingUserData(const orbit_client_data::TextBox* text_box = nullptr,
@@ -48,17 +56,13 @@ struct LineBuffer {
   BlockChain<Color, 2 * NUM_LINES_PER_BLOCK> picking_colors_;
 };
 
+// Boxes are stored as compact records (including their colors and picking color) instead of
+// four vertices, see orbit_gl::BoxInstance.
 struct BoxBuffer {
-  void Reset() {
-    boxes_.Reset();
-    colors_.Reset();
-    picking_colors_.Reset();
-  }
+  void Reset() { boxes_.Reset(); }
 
   static const int NUM_BOXES_PER_BLOCK = 64 * 1024;
-  BlockChain<Box, NUM_BOXES_PER_BLOCK> boxes_;
-  BlockChain<Color, 4 * NUM_BOXES_PER_BLOCK> colors_;
-  BlockChain<Color, 4 * NUM_BOXES_PER_BLOCK> picking_colors_;
+  BlockChain<orbit_gl::BoxInstance, NUM_BOXES_PER_BLOCK> boxes_;
 };
 
 struct TriangleBuffer {
@@ -96,6 +100,10 @@ into layers formed by equal z-coordinates. Each layer can then be drawn seperate
 Batcher::DrawLayer(), or all layers can be drawn at once in their correct order using
 Batcher::Draw():
 
+Boxes are drawn with instancing where GL 3.3 is available and an InstancedBoxRenderer is set,
+i.e. only their compact records are uploaded and a vertex shader expands them to quads.
+Otherwise, they are expanded on the CPU and drawn from vertex arrays like the other primitives.
+
 NOTE: The Batcher assumes x/y coordinates are in pixels and will automatically round those
 down to the next integer in all Batcher::AddXXX methods. This fixes the issue of primitives
 "jumping" around when their coordinates are changed slightly.
@@ -125,6 +133,8 @@ class Batcher {
   void AddVerticalLine(Vec2 pos, float size, float z, const Color& color,
                        std::shared_ptr<Pickable> pickable);
 
+  // `colors` need to describe a single color or a gradient along one axis (see
+  // orbit_gl::BoxInstance).
   void AddBox(const Box& box, const std::array<Color, 4>& colors,
               std::unique_ptr<PickingUserData> user_data = nullptr);
   void AddBox(const Box& box, const Color& color,
@@ -162,10 +172,23 @@ class Batcher {
   void DrawLayer(float layer, bool picking = false) const;
   virtual void Draw(bool picking = false) const;
 
+  // Returns the id of the primitive that is drawn on top at `pos` in the given layer, or
+  // std::nullopt if no primitive of this batcher covers `pos` there. This is the CPU-side
+  // equivalent of DrawLayer(layer, /*picking=*/true) followed by reading back one pixel, and does
+  // not need a GL context. Primitives without user data and without a Pickable are only taken into
+  // account if `decorations_occlude` is true. The lookup structure is built on first use after
+  // each call to ResetElements().
+  [[nodiscard]] std::optional<PickingId> PickLayer(float layer, const Vec2& pos,
+                                                   bool decorations_occlude) const;
+
   void ResetElements();
   void StartNewFrame();
 
   [[nodiscard]] PickingManager* GetPickingManager() const { return picking_manager_; }
+  // The renderer belongs to the GL context this batcher draws into and has to outlive the batcher.
+  void SetInstancedBoxRenderer(orbit_gl::InstancedBoxRenderer* instanced_box_renderer) {
+    instanced_box_renderer_ = instanced_box_renderer;
+  }
   void SetPickingManager(PickingManager* picking_manager) { picking_manager_ = picking_manager; }
 
   [[nodiscard]] const PickingUserData* GetUserData(PickingId id) const;
@@ -178,8 +201,14 @@ class Batcher {
  protected:
   void DrawLineBuffer(float layer, bool picking) const;
   void DrawBoxBuffer(float layer, bool picking) const;
+  void DrawBoxBlockWithVertexArrays(const orbit_gl::BoxInstance* boxes, size_t num_boxes, float z,
+                                    bool picking) const;
   void DrawTriangleBuffer(float layer, bool picking) const;
 
+  void BuildPickingIndex(const PrimitiveBuffers& buffers,
+                         orbit_gl::SpatialPickingIndex* picking_index) const;
+  [[nodiscard]] bool IsDecoration(PickingId id) const;
+
   void GetBoxGradientColors(const Color& color, std::array<Color, 4>* colors,
                             ShadingDirection shading_direction = ShadingDirection::kLeftToRight);
 
@@ -198,8 +227,14 @@ class Batcher {
   std::unordered_map<float, PrimitiveBuffers> primitive_buffers_by_layer_;
 
   std::vector<std::unique_ptr<PickingUserData>> user_data_;
+  mutable std::unordered_map<float, orbit_gl::SpatialPickingIndex> picking_index_by_layer_;
 
   std::vector<Vec2> circle_points;
+
+  orbit_gl::InstancedBoxRenderer* instanced_box_renderer_ = nullptr;
+  // Scratch buffers to expand boxes into when instancing is not available.
+  mutable std::vector<Box> expanded_boxes_;
+  mutable std::vector<Color> expanded_box_colors_;
 };
 
 #endif
@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -52,13 +53,8 @@ class MockBatcher : public Batcher {
           ++it;
           ++it;
         }
-        for (auto it = buffer.box_buffer.picking_colors_.begin();
-             it != buffer.box_buffer.picking_colors_.end();) {
-          drawn_box_colors_.push_back(*it);
-          ++it;
-          ++it;
-          ++it;
-          ++it;
+        for (const orbit_gl::BoxInstance& box : buffer.box_buffer.boxes_) {
+          drawn_box_colors_.push_back(box.picking_color);
         }
       } else {
         for (auto it = buffer.line_buffer.colors_.begin();
@@ -74,12 +70,8 @@ class MockBatcher : public Batcher {
           ++it;
           ++it;
         }
-        for (auto it = buffer.box_buffer.colors_.begin(); it != buffer.box_buffer.colors_.end();) {
-          drawn_box_colors_.push_back(*it);
-          ++it;
-          ++it;
-          ++it;
-          ++it;
+        for (const orbit_gl::BoxInstance& box : buffer.box_buffer.boxes_) {
+          drawn_box_colors_.push_back(box.GetColors()[0]);
         }
       }
     }
@@ -237,4 +229,49 @@ TEST(Batcher, MultipleDrawCalls) {
   EXPECT_DEATH((void)batcher.GetUserData(id), "size");
 }
 
+TEST(Batcher, PickLayerOnCpu) {
+  PickingManager pm;
+  MockBatcher batcher(BatcherId::kTimeGraph, &pm);
+  std::shared_ptr<PickableMock> pickable = std::make_shared<PickableMock>();
+
+  std::string box_custom_data = "box custom data";
+  auto box_user_data = std::make_unique<PickingUserData>();
+  box_user_data->custom_data_ = &box_custom_data;
+
+  constexpr float kLayer = 0.1f;
+  constexpr float kOtherLayer = 0.2f;
+  batcher.AddBox(Box(Vec2(0, 0), Vec2(10, 10), kLayer), Color(255, 0, 0, 255),
+                 std::move(box_user_data));
+  batcher.AddBox(Box(Vec2(20, 0), Vec2(10, 10), kLayer), Color(255, 0, 0, 255), pickable);
+  // A decoration on top of the first box.
+  batcher.AddBox(Box(Vec2(0, 0), Vec2(5, 10), kLayer), Color(0, 0, 0, 255));
+  batcher.AddBox(Box(Vec2(40, 0), Vec2(10, 10), kOtherLayer), Color(0, 0, 0, 255));
+
+  std::optional<PickingId> id = batcher.PickLayer(kLayer, Vec2(7.5f, 5.5f), false);
+  ASSERT_TRUE(id.has_value());
+  EXPECT_EQ(id->type, PickingType::kBox);
+  EXPECT_EQ(id->batcher_id, BatcherId::kTimeGraph);
+  ExpectCustomDataEq(batcher, PickingId::ToColor(id->type, id->element_id, id->batcher_id),
+                     box_custom_data);
+
+  id = batcher.PickLayer(kLayer, Vec2(2.5f, 5.5f), false);
+  ASSERT_TRUE(id.has_value());
+  EXPECT_NE(batcher.GetUserData(id.value()), nullptr);
+  id = batcher.PickLayer(kLayer, Vec2(2.5f, 5.5f), true);
+  ASSERT_TRUE(id.has_value());
+  EXPECT_EQ(batcher.GetUserData(id.value()), nullptr);
+
+  id = batcher.PickLayer(kLayer, Vec2(25.5f, 5.5f), false);
+  ASSERT_TRUE(id.has_value());
+  EXPECT_EQ(id->type, PickingType::kPickable);
+  EXPECT_EQ(pm.GetPickableFromId(id.value()).get(), pickable.get());
+
+  EXPECT_FALSE(batcher.PickLayer(kLayer, Vec2(45.5f, 5.5f), true).has_value());
+  EXPECT_TRUE(batcher.PickLayer(kOtherLayer, Vec2(45.5f, 5.5f), true).has_value());
+  EXPECT_FALSE(batcher.PickLayer(0.3f, Vec2(45.5f, 5.5f), true).has_value());
+
+  batcher.StartNewFrame();
+  EXPECT_FALSE(batcher.PickLayer(kLayer, Vec2(7.5f, 5.5f), false).has_value());
+}
+
 }  // namespace
\ No newline at end of file
@@ -0,0 +1,71 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_GL_BOX_INSTANCE_H_
+#define ORBIT_GL_BOX_INSTANCE_H_
+
+#include <stdint.h>
+
+#include <array>
+
+#include "CoreMath.h"
+#include "Geometry.h"
+#include "OrbitBase/Logging.h"
+
+namespace orbit_gl {
+
+// Compact representation of an axis-aligned box, as stored by the Batcher. The z-coordinate is not
+// stored, as it is the same for all boxes of a layer. The box is filled either with a single color
+// or with a linear gradient from `start_color` to `end_color` along the x-axis or the y-axis, which
+// covers all fills produced by Batcher::AddBox and Batcher::AddShadedBox.
+//
+// Compared to four vertices with one color and one picking color each, this reduces the size of a
+// box from 80 to 32 bytes.
+struct BoxInstance {
+  enum class GradientAxis : uint8_t { kX = 0, kY = 1 };
+
+  BoxInstance() = default;
+  // `colors` are the colors of the box's vertices, in the order of Box::vertices. They need to
+  // describe a single color or a gradient along one axis.
+  BoxInstance(const Box& box, const std::array<Color, 4>& colors, const Color& picking_color)
+      : x(box.vertices[0][0]),
+        y(box.vertices[0][1]),
+        width(box.vertices[2][0] - box.vertices[0][0]),
+        height(box.vertices[2][1] - box.vertices[0][1]),
+        picking_color(picking_color) {
+    // Vertices 0 and 1 are at the start of the x-axis, vertices 0 and 3 at the start of the y-axis.
+    if (colors[0] == colors[1] && colors[2] == colors[3]) {
+      start_color = colors[0];
+      end_color = colors[2];
+      gradient_axis = GradientAxis::kX;
+    } else {
+      CHECK(colors[0] == colors[3] && colors[1] == colors[2]);
+      start_color = colors[0];
+      end_color = colors[1];
+      gradient_axis = GradientAxis::kY;
+    }
+  }
+
+  [[nodiscard]] Box GetBox(float z) const { return Box(Vec2(x, y), Vec2(width, height), z); }
+
+  [[nodiscard]] std::array<Color, 4> GetColors() const {
+    if (gradient_axis == GradientAxis::kX) {
+      return {start_color, start_color, end_color, end_color};
+    }
+    return {start_color, end_color, end_color, start_color};
+  }
+
+  float x = 0.f;
+  float y = 0.f;
+  float width = 0.f;
+  float height = 0.f;
+  Color start_color;
+  Color end_color;
+  Color picking_color;
+  GradientAxis gradient_axis = GradientAxis::kX;
+};
+
+}  // namespace orbit_gl
+
+#endif  // ORBIT_GL_BOX_INSTANCE_H_
@@ -0,0 +1,68 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "BoxInstance.h"
+#include "CoreMath.h"
+#include "Geometry.h"
+
+namespace orbit_gl {
+
+namespace {
+
+const Color kRed(255, 0, 0, 255);
+const Color kDarkRed(128, 0, 0, 255);
+const Color kPickingColor(1, 2, 3, 4);
+
+void ExpectBoxEq(const Box& actual, const Box& expected) {
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(actual.vertices[i], expected.vertices[i]) << "vertex " << i;
+  }
+}
+
+void ExpectRoundTrip(const std::array<Color, 4>& colors) {
+  const Box box(Vec2(10.f, 20.f), Vec2(30.f, 5.f), 0.5f);
+  BoxInstance instance(box, colors, kPickingColor);
+  ExpectBoxEq(instance.GetBox(0.5f), box);
+  EXPECT_EQ(instance.GetColors(), colors);
+  EXPECT_EQ(instance.picking_color, kPickingColor);
+}
+
+}  // namespace
+
+TEST(BoxInstance, IsSmallerThanExpandedBox) {
+  // Four vertices, each with a color and a picking color.
+  constexpr size_t kExpandedBoxSize = sizeof(Box) + 8 * sizeof(Color);
+  EXPECT_LE(sizeof(BoxInstance), 32);
+  EXPECT_LT(2 * sizeof(BoxInstance), kExpandedBoxSize);
+}
+
+TEST(BoxInstance, RoundTripsSingleColor) { ExpectRoundTrip({kRed, kRed, kRed, kRed}); }
+
+TEST(BoxInstance, RoundTripsHorizontalGradients) {
+  ExpectRoundTrip({kDarkRed, kDarkRed, kRed, kRed});
+  ExpectRoundTrip({kRed, kRed, kDarkRed, kDarkRed});
+}
+
+TEST(BoxInstance, RoundTripsVerticalGradients) {
+  ExpectRoundTrip({kDarkRed, kRed, kRed, kDarkRed});
+  ExpectRoundTrip({kRed, kDarkRed, kDarkRed, kRed});
+}
+
+TEST(BoxInstance, RoundTripsNegativeSize) {
+  const Box box(Vec2(10.f, 20.f), Vec2(-5.f, -8.f), 0.f);
+  BoxInstance instance(box, {kRed, kRed, kRed, kRed}, kPickingColor);
+  ExpectBoxEq(instance.GetBox(0.f), box);
+}
+
+TEST(BoxInstanceDeathTest, RejectsUnsupportedColors) {
+  EXPECT_DEATH(BoxInstance(Box(Vec2(0.f, 0.f), Vec2(1.f, 1.f), 0.f),
+                           {kRed, kDarkRed, kRed, kDarkRed}, kPickingColor),
+               "Check failed");
+}
+
+}  // namespace orbit_gl
@@ -7,14 +7,24 @@
 #include <absl/strings/str_format.h>
 
 #include "CaptureWindow.h"
-#include "ClientData/TextBox.h"
+#include "ClientData/SchedulingSlicesPerCore.h"
 #include "Introspection/Introspection.h"
+#include "OrbitBase/Logging.h"
 #include "SchedulingStats.h"
 
-ErrorMessageOr<void> CaptureStats::Generate(CaptureWindow* capture_window, uint64_t start_ns,
-                                            uint64_t end_ns) {
+CaptureStats::~CaptureStats() { CancelComputation(); }
+
+void CaptureStats::CancelComputation() {
+  if (computation_ == nullptr) return;
+  computation_->cancelled = true;
+  computation_.reset();
+}
+
+ErrorMessageOr<void> CaptureStats::Generate(CaptureWindow* capture_window, ThreadPool* thread_pool,
+                                            uint64_t start_ns, uint64_t end_ns) {
   ORBIT_SCOPE_FUNCTION;
   if (capture_window == nullptr) return ErrorMessage("CaptureWindow is null");
+  if (thread_pool == nullptr) return ErrorMessage("ThreadPool is null");
   if (start_ns == end_ns) return ErrorMessage("Time range is 0");
   if (start_ns > end_ns) std::swap(start_ns, end_ns);
 
@@ -23,12 +33,63 @@ ErrorMessageOr<void> CaptureStats::Generate(CaptureWindow* capture_window, uint6
   const orbit_client_model::CaptureData* capture_data = time_graph->GetCaptureData();
   if (capture_data == nullptr) return ErrorMessage("No capture data found");
 
-  std::vector<const orbit_client_data::TextBox*> sched_scopes =
-      scheduler_track->GetScopesInRange(start_ns, end_ns);
-  SchedulingStats::ThreadNameProvider thread_name_provider = [capture_data](int32_t thread_id) {
+  CancelComputation();
+  capture_window_ = capture_window;
+  start_ns_ = start_ns;
+  end_ns_ = end_ns;
+
+  // The scheduling slices of each core are aggregated in a separate task. The tasks share ownership
+  // of the slices, so that they stay valid even if the track is removed in the meantime.
+  std::shared_ptr<const orbit_client_data::SchedulingSlicesPerCore> scheduling_slices =
+      scheduler_track->GetSchedulingSlices();
+  const uint32_t num_cores = scheduling_slices->GetNumCores();
+  auto computation = std::make_shared<Computation>();
+  {
+    absl::MutexLock lock(&computation->mutex);
+    computation->num_pending_cores = num_cores;
+  }
+  computation_ = computation;
+
+  for (uint32_t core = 0; core < num_cores; ++core) {
+    thread_pool->Schedule([computation, scheduling_slices, core, start_ns, end_ns] {
+      ORBIT_SCOPE("SchedulingStats::AggregateCore");
+      SchedulingStats::PartialStats partial_stats = SchedulingStats::AggregateCore(
+          *scheduling_slices, static_cast<int32_t>(core), start_ns, end_ns, computation->cancelled);
+      absl::MutexLock lock(&computation->mutex);
+      computation->partial_stats.emplace_back(std::move(partial_stats));
+      --computation->num_pending_cores;
+    });
+  }
+  return outcome::success();
+}
+
+bool CaptureStats::IsGenerating() const {
+  if (computation_ == nullptr) return false;
+  absl::MutexLock lock(&computation_->mutex);
+  return computation_->num_pending_cores > 0;
+}
+
+const std::string& CaptureStats::GetSummary() {
+  if (computation_ == nullptr || IsGenerating()) return summary_;
+
+  std::vector<SchedulingStats::PartialStats> partial_stats;
+  {
+    absl::MutexLock lock(&computation_->mutex);
+    partial_stats = std::move(computation_->partial_stats);
+  }
+  computation_.reset();
+
+  // Thread names are resolved here rather than on the thread pool, as the capture data can change
+  // while the per-core tasks are running.
+  const orbit_client_model::CaptureData* capture_data =
+      capture_window_->GetTimeGraph() != nullptr ? capture_window_->GetTimeGraph()->GetCaptureData()
+                                                 : nullptr;
+  SchedulingStats::ThreadNameProvider thread_name_provider =
+      [capture_data](int32_t thread_id) -> std::string {
+    if (capture_data == nullptr) return "";
     return capture_data->GetThreadName(thread_id);
   };
-  SchedulingStats scheduling_stats(sched_scopes, thread_name_provider, start_ns, end_ns);
+  SchedulingStats scheduling_stats(partial_stats, thread_name_provider, start_ns_, end_ns_);
   summary_ = scheduling_stats.ToString();
-  return outcome::success();
+  return summary_;
 }
@@ -5,20 +5,55 @@
 #ifndef ORBIT_GL_CAPUTRE_STATS_H_
 #define ORBIT_GL_CAPUTRE_STATS_H_
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "OrbitBase/Result.h"
+#include "OrbitBase/ThreadPool.h"
+#include "SchedulingStats.h"
 
 class CaptureWindow;
 
 // CaptureStats generates statistics from a CaptureWindow for a given time period.
+//
+// The scheduling slices of each core are aggregated in a separate task on a thread pool, directly
+// over the compact storage of the scheduler track. Generating the statistics of a new selection
+// cancels the computation for the previous one. The summary is assembled on the calling thread by
+// GetSummary, once all cores are done.
 class CaptureStats {
  public:
   CaptureStats() = default;
-  ErrorMessageOr<void> Generate(CaptureWindow* capture_window, uint64_t start_ns, uint64_t end_ns);
-  [[nodiscard]] const std::string& GetSummary() { return summary_; }
+  ~CaptureStats();
+  CaptureStats(const CaptureStats&) = delete;
+  CaptureStats& operator=(const CaptureStats&) = delete;
+
+  ErrorMessageOr<void> Generate(CaptureWindow* capture_window, ThreadPool* thread_pool,
+                                uint64_t start_ns, uint64_t end_ns);
+  // Returns the summary of the last selection for which all cores have been aggregated.
+  [[nodiscard]] const std::string& GetSummary();
+  // Returns true while the statistics of the last selection are being computed.
+  [[nodiscard]] bool IsGenerating() const;
 
  private:
+  // Shared with the tasks on the thread pool, so that they can outlive this object.
+  struct Computation {
+    std::atomic<bool> cancelled = false;
+    mutable absl::Mutex mutex;
+    std::vector<SchedulingStats::PartialStats> partial_stats ABSL_GUARDED_BY(mutex);
+    size_t num_pending_cores ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  void CancelComputation();
+
+  CaptureWindow* capture_window_ = nullptr;
+  std::shared_ptr<Computation> computation_;
+  uint64_t start_ns_ = 0;
+  uint64_t end_ns_ = 0;
   std::string summary_;
 };
 
@@ -4,16 +4,19 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <list>
+#include <vector>
 
 #include "CaptureStats.h"
+#include "ClientData/SchedulingSlicesPerCore.h"
 #include "ClientData/TextBox.h"
 #include "SchedulerTrack.h"
 #include "SchedulingStats.h"
 
 TEST(CaptureStats, NullCaptureWindow) {
   CaptureStats capture_stats;
-  auto result = capture_stats.Generate(/*capture_window=*/nullptr, 0, 0);
+  auto result = capture_stats.Generate(/*capture_window=*/nullptr, /*thread_pool=*/nullptr, 0, 0);
   EXPECT_EQ(result.has_error(), true);
 }
 
@@ -100,3 +103,58 @@ TEST(SchedulingStats, SchedulingStats) {
     EXPECT_EQ(scheduling_stats.GetProcessStatsSortedByTimeOnCore()[2]->pid, 0);
   }
 }
+
+TEST(SchedulingStats, PartialStatsPerCore) {
+  constexpr int32_t kNumCores = 4;
+  constexpr uint64_t kNumScopesPerCore = 3000;
+  orbit_client_data::SchedulingSlicesPerCore scheduling_slices;
+  std::list<orbit_client_data::TextBox> scope_buffer;  // Use a list as we need pointer stability.
+  std::vector<const orbit_client_data::TextBox*> scopes;
+  for (int32_t cpu = 0; cpu < kNumCores; ++cpu) {
+    for (uint64_t i = 0; i < kNumScopesPerCore; ++i) {
+      orbit_client_protos::TimerInfo timer_info;
+      timer_info.set_start(i * 10);
+      timer_info.set_end(i * 10 + 5);
+      timer_info.set_process_id(static_cast<int32_t>(i % 2));
+      timer_info.set_thread_id(static_cast<int32_t>(i % 5));
+      timer_info.set_processor(cpu);
+      scheduling_slices.AddSlice(timer_info.process_id(), timer_info.thread_id(), cpu,
+                                 timer_info.start(), timer_info.end());
+      scopes.push_back(&scope_buffer.emplace_back(std::move(timer_info)));
+    }
+  }
+  SchedulingStats::ThreadNameProvider thread_name_provider = [](int32_t thread_id) {
+    return std::to_string(thread_id);
+  };
+
+  // The selection clips the first and the last scope of each core.
+  constexpr uint64_t kStartNs = 2;
+  constexpr uint64_t kEndNs = 20'002;
+  std::vector<const orbit_client_data::TextBox*> scopes_in_range;
+  for (const orbit_client_data::TextBox* scope : scopes) {
+    if (scope->GetTimerInfo().start() <= kEndNs && scope->GetTimerInfo().end() > kStartNs) {
+      scopes_in_range.push_back(scope);
+    }
+  }
+
+  std::atomic<bool> cancelled = false;
+  std::vector<SchedulingStats::PartialStats> partial_stats;
+  for (int32_t cpu = 0; cpu < kNumCores; ++cpu) {
+    partial_stats.push_back(
+        SchedulingStats::AggregateCore(scheduling_slices, cpu, kStartNs, kEndNs, cancelled));
+  }
+  SchedulingStats stats_of_cores(partial_stats, thread_name_provider, kStartNs, kEndNs);
+  SchedulingStats stats_of_scopes(scopes_in_range, thread_name_provider, kStartNs, kEndNs);
+
+  // 2001 scopes of 5ns per core, the first one is clipped by 2ns and the last one by 3ns.
+  EXPECT_EQ(stats_of_cores.GetTimeOnCoreNs(), kNumCores * (2001 * 5 - 2 - 3));
+  EXPECT_EQ(stats_of_cores.GetTimeOnCoreNs(), stats_of_scopes.GetTimeOnCoreNs());
+  EXPECT_EQ(stats_of_cores.GetTimeOnCoreNsByCore(), stats_of_scopes.GetTimeOnCoreNsByCore());
+  EXPECT_EQ(stats_of_cores.GetProcessStatsByPid().size(), 2);
+  EXPECT_EQ(stats_of_cores.ToString(), stats_of_scopes.ToString());
+
+  cancelled = true;
+  SchedulingStats::PartialStats cancelled_stats =
+      SchedulingStats::AggregateCore(scheduling_slices, 0, kStartNs, kEndNs, cancelled);
+  EXPECT_TRUE(cancelled_stats.time_on_core_ns_by_core.empty());
+}
@@ -185,6 +185,11 @@ void CaptureWindow::HandlePickedElement(PickingMode picking_mode, PickingId pick
   }
 }
 
+std::vector<const Batcher*> CaptureWindow::GetBatchersInDrawOrder() const {
+  if (time_graph_ == nullptr) return {&ui_batcher_};
+  return {&time_graph_->GetBatcher(), &ui_batcher_};
+}
+
 void CaptureWindow::SelectTextBox(const orbit_client_data::TextBox* text_box) {
   CHECK(time_graph_ != nullptr);
   if (text_box == nullptr) return;
@@ -233,7 +238,8 @@ bool CaptureWindow::RightUp() {
   }
 
   if (app_->IsDevMode()) {
-    auto result = selection_stats_.Generate(this, select_start_time_, select_stop_time_);
+    auto result = selection_stats_.Generate(this, app_->GetThreadPool(), select_start_time_,
+                                            select_stop_time_);
     if (result.has_error()) {
       ERROR("%s", result.error().message());
     }
@@ -607,6 +613,7 @@ void CaptureWindow::set_draw_help(bool draw_help) {
 void CaptureWindow::CreateTimeGraph(const CaptureData* capture_data) {
   time_graph_ =
       std::make_unique<TimeGraph>(this, app_, &viewport_, capture_data, &GetPickingManager());
+  time_graph_->SetInstancedBoxRenderer(&instanced_box_renderer_);
 }
 
 Batcher& CaptureWindow::GetBatcherById(BatcherId batcher_id) {
@@ -673,6 +680,7 @@ void CaptureWindow::RenderImGuiDebugUI() {
   }
 
   if (ImGui::CollapsingHeader("Selection Summary")) {
+    if (selection_stats_.IsGenerating()) ImGui::TextUnformatted("Computing...");
     const std::string& selection_summary = selection_stats_.GetSummary();
 
     if (ImGui::Button("Copy to clipboard")) {
@@ -85,6 +85,7 @@ class CaptureWindow : public GlCanvas {
   [[nodiscard]] virtual const char* GetHelpText() const;
   [[nodiscard]] virtual bool ShouldAutoZoom() const;
   void HandlePickedElement(PickingMode picking_mode, PickingId picking_id, int x, int y) override;
+  [[nodiscard]] std::vector<const Batcher*> GetBatchersInDrawOrder() const override;
 
   std::unique_ptr<TimeGraph> time_graph_ = nullptr;
   bool draw_help_;
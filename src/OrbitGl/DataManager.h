@@ -110,6 +110,19 @@ class DataManager final {
     return max_local_marker_depth_per_command_buffer_;
   }
 
+  void set_function_call_coalescing_threshold_ns(uint64_t function_call_coalescing_threshold_ns) {
+    function_call_coalescing_threshold_ns_ = function_call_coalescing_threshold_ns;
+  }
+  [[nodiscard]] uint64_t function_call_coalescing_threshold_ns() const {
+    return function_call_coalescing_threshold_ns_;
+  }
+  void set_function_call_coalescing_max_gap_ns(uint64_t function_call_coalescing_max_gap_ns) {
+    function_call_coalescing_max_gap_ns_ = function_call_coalescing_max_gap_ns;
+  }
+  [[nodiscard]] uint64_t function_call_coalescing_max_gap_ns() const {
+    return function_call_coalescing_max_gap_ns_;
+  }
+
   void set_collect_memory_info(bool collect_memory_info) {
     collect_memory_info_ = collect_memory_info;
   }
@@ -147,6 +160,8 @@ class DataManager final {
   bool enable_introspection_ = false;
   bool enable_user_space_instrumentation_ = false;
   uint64_t max_local_marker_depth_per_command_buffer_ = std::numeric_limits<uint64_t>::max();
+  uint64_t function_call_coalescing_threshold_ns_ = 0;
+  uint64_t function_call_coalescing_max_gap_ns_ = 1'000'000;
   double samples_per_second_ = 0;
   uint16_t stack_dump_size_ = 0;
   orbit_grpc_protos::UnwindingMethod unwinding_method_{};
@@ -0,0 +1,128 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "FlameGraph.h"
+
+#include <algorithm>
+
+#include "Introspection/Introspection.h"
+#include "capture_data.pb.h"
+
+using orbit_client_data::PostProcessedSamplingData;
+using orbit_client_data::ThreadID;
+using orbit_client_data::ThreadSampleData;
+using orbit_client_protos::CallstackInfo;
+
+namespace orbit_gl {
+
+namespace {
+
+struct WeightedCallstack {
+  // Outermost frame first.
+  std::vector<uint64_t> frames;
+  uint64_t sample_count = 0;
+};
+
+}  // namespace
+
+FlameGraph::FlameGraph(const PostProcessedSamplingData& post_processed_sampling_data,
+                       ThreadID thread_id) {
+  ORBIT_SCOPE_FUNCTION;
+  const ThreadSampleData* thread_sample_data =
+      post_processed_sampling_data.GetThreadSampleDataByThreadId(thread_id);
+  if (thread_sample_data == nullptr) return;
+
+  std::vector<WeightedCallstack> callstacks;
+  callstacks.reserve(thread_sample_data->sampled_callstack_id_to_count.size());
+  for (const auto& [callstack_id, sample_count] :
+       thread_sample_data->sampled_callstack_id_to_count) {
+    const CallstackInfo& resolved_callstack =
+        post_processed_sampling_data.GetResolvedCallstack(callstack_id);
+    if (resolved_callstack.frames().empty()) continue;
+
+    WeightedCallstack& callstack = callstacks.emplace_back();
+    callstack.sample_count = sample_count;
+    if (resolved_callstack.type() == CallstackInfo::kComplete) {
+      callstack.frames.assign(resolved_callstack.frames().rbegin(),
+                              resolved_callstack.frames().rend());
+    } else {
+      callstack.frames = {kUnwindErrorsAddress, resolved_callstack.frames(0)};
+    }
+  }
+
+  // After sorting, all callstacks sharing a prefix are adjacent, so the frames of the flame graph
+  // can be emitted in a single pass: a callstack only opens new frames below the prefix it shares
+  // with the previous callstack, and adds its samples to the frames of that prefix.
+  std::sort(callstacks.begin(), callstacks.end(),
+            [](const WeightedCallstack& lhs, const WeightedCallstack& rhs) {
+              return lhs.frames < rhs.frames;
+            });
+
+  // Index in rows_[depth] of the frame at `depth` of the previous callstack.
+  std::vector<size_t> open_frames;
+  const std::vector<uint64_t>* previous_frames = nullptr;
+  for (const WeightedCallstack& callstack : callstacks) {
+    const std::vector<uint64_t>& frames = callstack.frames;
+    size_t common_depth = 0;
+    if (previous_frames != nullptr) {
+      const size_t max_common_depth = std::min(previous_frames->size(), frames.size());
+      while (common_depth < max_common_depth &&
+             (*previous_frames)[common_depth] == frames[common_depth]) {
+        ++common_depth;
+      }
+    }
+
+    if (rows_.size() < frames.size()) rows_.resize(frames.size());
+    open_frames.resize(frames.size());
+    for (size_t depth = 0; depth < common_depth; ++depth) {
+      rows_[depth].sample_counts[open_frames[depth]] += callstack.sample_count;
+    }
+    for (size_t depth = common_depth; depth < frames.size(); ++depth) {
+      Row& row = rows_[depth];
+      open_frames[depth] = row.size();
+      row.first_samples.push_back(total_sample_count_);
+      row.sample_counts.push_back(callstack.sample_count);
+      row.function_addresses.push_back(frames[depth]);
+    }
+
+    total_sample_count_ += callstack.sample_count;
+    previous_frames = &frames;
+  }
+}
+
+size_t FlameGraph::GetNumFrames() const {
+  size_t num_frames = 0;
+  for (const Row& row : rows_) {
+    num_frames += row.size();
+  }
+  return num_frames;
+}
+
+size_t FlameGraph::FindFirstFrameEndingAfter(size_t depth, double sample) const {
+  // Frames of a row don't overlap, so their ends are sorted as well.
+  const Row& row = rows_[depth];
+  size_t first = 0;
+  size_t last = row.size();
+  while (first < last) {
+    const size_t middle = first + (last - first) / 2;
+    if (static_cast<double>(row.first_samples[middle] + row.sample_counts[middle]) <= sample) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+  return first;
+}
+
+std::optional<size_t> FlameGraph::FindFrame(size_t depth, double sample) const {
+  if (depth >= rows_.size()) return std::nullopt;
+  const size_t index = FindFirstFrameEndingAfter(depth, sample);
+  if (index == rows_[depth].size() ||
+      static_cast<double>(rows_[depth].first_samples[index]) > sample) {
+    return std::nullopt;
+  }
+  return index;
+}
+
+}  // namespace orbit_gl
@@ -0,0 +1,82 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_GL_FLAME_GRAPH_H_
+#define ORBIT_GL_FLAME_GRAPH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "ClientData/CallstackTypes.h"
+#include "ClientData/PostProcessedSamplingData.h"
+
+namespace orbit_gl {
+
+// Layout of a flame graph of the callstacks sampled in one thread (or in all threads, using the
+// summary of PostProcessedSamplingData). Each frame is a function at a given depth of a callstack
+// prefix, spanning all samples that share that prefix. The outermost frames are at depth 0.
+//
+// Frames are stored per depth as parallel arrays sorted by their first sample, so that the frames
+// overlapping a range of samples can be found with a binary search, and so that drawing only needs
+// to walk contiguous memory.
+class FlameGraph {
+ public:
+  // Used as function address of the root frame of callstacks that could not be unwound. Only the
+  // innermost frame of those is shown as its child, as in the top-down view.
+  static constexpr uint64_t kUnwindErrorsAddress = std::numeric_limits<uint64_t>::max();
+
+  struct Row {
+    [[nodiscard]] size_t size() const { return first_samples.size(); }
+
+    std::vector<uint64_t> first_samples;
+    std::vector<uint64_t> sample_counts;
+    std::vector<uint64_t> function_addresses;
+  };
+
+  FlameGraph() = default;
+  FlameGraph(const orbit_client_data::PostProcessedSamplingData& post_processed_sampling_data,
+             orbit_client_data::ThreadID thread_id);
+
+  [[nodiscard]] uint64_t GetTotalSampleCount() const { return total_sample_count_; }
+  [[nodiscard]] size_t GetDepth() const { return rows_.size(); }
+  [[nodiscard]] const Row& GetRow(size_t depth) const { return rows_[depth]; }
+  [[nodiscard]] size_t GetNumFrames() const;
+
+  // Calls `visitor(index)` for each frame at `depth` that overlaps the samples
+  // [min_sample, max_sample) and spans at least `min_sample_count` samples. `index` is the index of
+  // the frame in GetRow(depth). This is how frames narrower than a pixel are culled: as a frame
+  // never spans more samples than its parent, all its descendants are culled as well.
+  template <typename Visitor>
+  void ForEachVisibleFrame(size_t depth, double min_sample, double max_sample,
+                           double min_sample_count, Visitor&& visitor) const;
+
+  // Returns the index in GetRow(depth) of the frame containing `sample`, if any.
+  [[nodiscard]] std::optional<size_t> FindFrame(size_t depth, double sample) const;
+
+ private:
+  [[nodiscard]] size_t FindFirstFrameEndingAfter(size_t depth, double sample) const;
+
+  std::vector<Row> rows_;
+  uint64_t total_sample_count_ = 0;
+};
+
+template <typename Visitor>
+void FlameGraph::ForEachVisibleFrame(size_t depth, double min_sample, double max_sample,
+                                     double min_sample_count, Visitor&& visitor) const {
+  if (depth >= rows_.size()) return;
+  const Row& row = rows_[depth];
+  for (size_t i = FindFirstFrameEndingAfter(depth, min_sample);
+       i < row.size() && static_cast<double>(row.first_samples[i]) < max_sample; ++i) {
+    if (static_cast<double>(row.sample_counts[i]) < min_sample_count) continue;
+    visitor(i);
+  }
+}
+
+}  // namespace orbit_gl
+
+#endif  // ORBIT_GL_FLAME_GRAPH_H_
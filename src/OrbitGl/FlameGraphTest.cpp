@@ -0,0 +1,206 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <absl/container/flat_hash_map.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "ClientData/PostProcessedSamplingData.h"
+#include "FlameGraph.h"
+#include "capture_data.pb.h"
+
+using orbit_client_data::PostProcessedSamplingData;
+using orbit_client_data::ThreadID;
+using orbit_client_data::ThreadSampleData;
+using orbit_client_protos::CallstackInfo;
+
+namespace orbit_gl {
+
+namespace {
+
+constexpr ThreadID kThreadId = 42;
+
+constexpr uint64_t kMain = 0x10;
+constexpr uint64_t kFoo = 0x20;
+constexpr uint64_t kBar = 0x30;
+constexpr uint64_t kBaz = 0x40;
+
+class PostProcessedSamplingDataBuilder {
+ public:
+  // `frames` are innermost first, as in CallstackInfo.
+  void AddCallstack(const std::vector<uint64_t>& frames, uint32_t count,
+                    CallstackInfo::CallstackType type = CallstackInfo::kComplete) {
+    const uint64_t callstack_id = next_callstack_id_++;
+    CallstackInfo callstack;
+    *callstack.mutable_frames() = {frames.begin(), frames.end()};
+    callstack.set_type(type);
+    id_to_resolved_callstack_.emplace(callstack_id, std::move(callstack));
+    original_id_to_resolved_callstack_id_.emplace(callstack_id, callstack_id);
+    thread_sample_data_.sampled_callstack_id_to_count.emplace(callstack_id, count);
+    thread_sample_data_.samples_count += count;
+  }
+
+  [[nodiscard]] PostProcessedSamplingData Build() {
+    thread_sample_data_.thread_id = kThreadId;
+    absl::flat_hash_map<ThreadID, ThreadSampleData> thread_id_to_sample_data;
+    thread_id_to_sample_data.emplace(kThreadId, thread_sample_data_);
+    return PostProcessedSamplingData(std::move(thread_id_to_sample_data), id_to_resolved_callstack_,
+                                     original_id_to_resolved_callstack_id_, {},
+                                     {thread_sample_data_});
+  }
+
+ private:
+  uint64_t next_callstack_id_ = 1;
+  ThreadSampleData thread_sample_data_;
+  absl::flat_hash_map<uint64_t, CallstackInfo> id_to_resolved_callstack_;
+  absl::flat_hash_map<uint64_t, uint64_t> original_id_to_resolved_callstack_id_;
+};
+
+struct ExpectedFrame {
+  uint64_t first_sample;
+  uint64_t sample_count;
+  uint64_t function_address;
+};
+
+void ExpectRowEq(const FlameGraph::Row& row, const std::vector<ExpectedFrame>& expected) {
+  ASSERT_EQ(row.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(row.first_samples[i], expected[i].first_sample) << "frame " << i;
+    EXPECT_EQ(row.sample_counts[i], expected[i].sample_count) << "frame " << i;
+    EXPECT_EQ(row.function_addresses[i], expected[i].function_address) << "frame " << i;
+  }
+}
+
+}  // namespace
+
+TEST(FlameGraph, EmptyForUnknownThread) {
+  PostProcessedSamplingDataBuilder builder;
+  builder.AddCallstack({kFoo, kMain}, 1);
+  FlameGraph flame_graph(builder.Build(), kThreadId + 1);
+  EXPECT_EQ(flame_graph.GetTotalSampleCount(), 0);
+  EXPECT_EQ(flame_graph.GetDepth(), 0);
+}
+
+TEST(FlameGraph, MergesCommonPrefixes) {
+  PostProcessedSamplingDataBuilder builder;
+  builder.AddCallstack({kBar, kFoo, kMain}, 3);
+  builder.AddCallstack({kBaz, kMain}, 2);
+  builder.AddCallstack({kFoo, kMain}, 1);
+  builder.AddCallstack({kBaz, kFoo, kMain}, 4);
+  // The same path as the first callstack, e.g. from a different original callstack.
+  builder.AddCallstack({kBar, kFoo, kMain}, 5);
+
+  FlameGraph flame_graph(builder.Build(), kThreadId);
+  EXPECT_EQ(flame_graph.GetTotalSampleCount(), 15);
+  ASSERT_EQ(flame_graph.GetDepth(), 3);
+  EXPECT_EQ(flame_graph.GetNumFrames(), 5);
+
+  ExpectRowEq(flame_graph.GetRow(0), {{0, 15, kMain}});
+  ExpectRowEq(flame_graph.GetRow(1), {{0, 13, kFoo}, {13, 2, kBaz}});
+  // main -> foo has one sample of its own at the start.
+  ExpectRowEq(flame_graph.GetRow(2), {{1, 8, kBar}, {9, 4, kBaz}});
+}
+
+TEST(FlameGraph, UnwindErrorsOnlyShowInnermostFrame) {
+  PostProcessedSamplingDataBuilder builder;
+  builder.AddCallstack({kBar, kFoo}, 2, CallstackInfo::kDwarfUnwindingError);
+  builder.AddCallstack({kFoo, kMain}, 1);
+
+  FlameGraph flame_graph(builder.Build(), kThreadId);
+  ASSERT_EQ(flame_graph.GetDepth(), 2);
+  ExpectRowEq(flame_graph.GetRow(0),
+              {{0, 1, kMain}, {1, 2, FlameGraph::kUnwindErrorsAddress}});
+  ExpectRowEq(flame_graph.GetRow(1), {{0, 1, kFoo}, {1, 2, kBar}});
+}
+
+TEST(FlameGraph, FindFrame) {
+  PostProcessedSamplingDataBuilder builder;
+  builder.AddCallstack({kBar, kFoo, kMain}, 3);
+  builder.AddCallstack({kMain}, 2);
+  FlameGraph flame_graph(builder.Build(), kThreadId);
+
+  EXPECT_EQ(flame_graph.FindFrame(0, 0.0), size_t{0});
+  EXPECT_EQ(flame_graph.FindFrame(0, 4.5), size_t{0});
+  EXPECT_EQ(flame_graph.FindFrame(0, 5.0), std::nullopt);
+  // The samples of main itself come first, as its callstack is a prefix of the others.
+  EXPECT_EQ(flame_graph.FindFrame(1, 1.0), std::nullopt);
+  EXPECT_EQ(flame_graph.FindFrame(1, 2.0), size_t{0});
+  EXPECT_EQ(flame_graph.FindFrame(2, 4.9), size_t{0});
+  EXPECT_EQ(flame_graph.FindFrame(3, 3.0), std::nullopt);
+}
+
+TEST(FlameGraph, ForEachVisibleFrameCullsSmallAndOffscreenFrames) {
+  PostProcessedSamplingDataBuilder builder;
+  // Ten frames of increasing size below main, at samples [0, 1), [1, 3), [3, 6), ...
+  for (uint32_t i = 1; i <= 10; ++i) {
+    builder.AddCallstack({kFoo + i, kMain}, i);
+  }
+  FlameGraph flame_graph(builder.Build(), kThreadId);
+  ASSERT_EQ(flame_graph.GetRow(1).size(), 10);
+
+  std::vector<size_t> visited;
+  auto visit = [&visited](size_t index) { visited.push_back(index); };
+
+  flame_graph.ForEachVisibleFrame(1, 0.0, 55.0, 0.0, visit);
+  EXPECT_EQ(visited.size(), 10);
+
+  // [4, 12) overlaps the frames [3, 6), [6, 10) and [10, 15).
+  visited.clear();
+  flame_graph.ForEachVisibleFrame(1, 4.0, 12.0, 0.0, visit);
+  EXPECT_EQ(visited, (std::vector<size_t>{2, 3, 4}));
+
+  visited.clear();
+  flame_graph.ForEachVisibleFrame(1, 0.0, 55.0, 8.0, visit);
+  EXPECT_EQ(visited, (std::vector<size_t>{7, 8, 9}));
+
+  visited.clear();
+  flame_graph.ForEachVisibleFrame(2, 0.0, 55.0, 0.0, visit);
+  EXPECT_TRUE(visited.empty());
+}
+
+TEST(FlameGraph, ManyCallstacks) {
+  // A deep and wide tree: 4^8 distinct callstacks of depth 9 with a common root.
+  constexpr size_t kFanOut = 4;
+  constexpr size_t kDepth = 8;
+  PostProcessedSamplingDataBuilder builder;
+  size_t num_callstacks = 1;
+  for (size_t depth = 0; depth < kDepth; ++depth) num_callstacks *= kFanOut;
+  for (size_t i = 0; i < num_callstacks; ++i) {
+    std::vector<uint64_t> frames;
+    size_t path = i;
+    for (size_t depth = 0; depth < kDepth; ++depth) {
+      frames.push_back(kFoo + path % kFanOut);
+      path /= kFanOut;
+    }
+    frames.push_back(kMain);
+    builder.AddCallstack(frames, 1);
+  }
+  PostProcessedSamplingData post_processed_sampling_data = builder.Build();
+
+  FlameGraph flame_graph(post_processed_sampling_data, kThreadId);
+
+  EXPECT_EQ(flame_graph.GetTotalSampleCount(), num_callstacks);
+  ASSERT_EQ(flame_graph.GetDepth(), kDepth + 1);
+  size_t expected_row_size = 1;
+  for (size_t depth = 0; depth <= kDepth; ++depth) {
+    EXPECT_EQ(flame_graph.GetRow(depth).size(), expected_row_size);
+    expected_row_size *= kFanOut;
+  }
+
+  // Showing all samples on 1000 pixels, only frames of the first six levels are at least one pixel
+  // wide.
+  const double samples_per_pixel = static_cast<double>(num_callstacks) / 1000.0;
+  size_t num_visited = 0;
+  for (size_t depth = 0; depth < flame_graph.GetDepth(); ++depth) {
+    flame_graph.ForEachVisibleFrame(depth, 0.0, static_cast<double>(num_callstacks),
+                                    samples_per_pixel,
+                                    [&num_visited](size_t /*index*/) { ++num_visited; });
+  }
+  EXPECT_EQ(num_visited, 1 + 4 + 16 + 64 + 256);
+}
+
+}  // namespace orbit_gl
@@ -0,0 +1,232 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "FlameGraphWindow.h"
+
+#include <absl/hash/hash.h>
+#include <absl/strings/str_format.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "App.h"
+#include "Batcher.h"
+#include "CoreMath.h"
+#include "Geometry.h"
+#include "Introspection/Introspection.h"
+#include "OrbitBase/Append.h"
+#include "OrbitBase/Logging.h"
+#include "OrbitBase/ThreadConstants.h"
+#include "TextRenderer.h"
+
+using orbit_client_data::PostProcessedSamplingData;
+using orbit_client_model::CaptureData;
+using orbit_gl::FlameGraph;
+
+namespace {
+
+constexpr float kRowHeight = 20.f;
+constexpr float kFrameMargin = 1.f;
+constexpr float kTextMargin = 3.f;
+constexpr float kTextOffset = 5.f;
+constexpr uint32_t kFontSize = 14;
+// Frames narrower than this don't get a label.
+constexpr float kMinFrameWidthForText = 3 * kFontSize;
+// The smallest range of samples the window can be zoomed in to.
+constexpr double kMinVisibleSamples = 1.0;
+constexpr double kZoomFactor = 0.8;
+
+const Color kTextBlack(0, 0, 0, 255);
+const Color kUnwindErrorsColor(180, 180, 180, 255);
+const std::string kUnwindErrorsName = "[Unwind errors]";
+
+// Flame graphs are traditionally drawn in warm colors. The color only depends on the function, so
+// that the same function has the same color everywhere in the graph and across updates.
+[[nodiscard]] Color GetFrameColor(uint64_t function_address) {
+  if (function_address == FlameGraph::kUnwindErrorsAddress) return kUnwindErrorsColor;
+  const size_t hash = absl::Hash<uint64_t>{}(function_address);
+  const auto red = static_cast<uint8_t>(205 + hash % 50);
+  const auto green = static_cast<uint8_t>(80 + (hash >> 8) % 150);
+  const auto blue = static_cast<uint8_t>((hash >> 16) % 55);
+  return Color(red, green, blue, 255);
+}
+
+}  // namespace
+
+FlameGraphWindow::FlameGraphWindow(OrbitApp* app) : GlCanvas(), app_{app} {}
+
+void FlameGraphWindow::SetSamplingData(const PostProcessedSamplingData& post_processed_sampling_data,
+                                       const CaptureData* capture_data) {
+  ORBIT_SCOPE_FUNCTION;
+  const bool was_showing_all_samples = IsShowingAllSamples();
+  flame_graph_ = FlameGraph(post_processed_sampling_data, orbit_base::kAllProcessThreadsTid);
+  capture_data_ = capture_data;
+
+  if (was_showing_all_samples) {
+    ZoomAll();
+  } else {
+    SetVisibleSampleRange(min_visible_sample_, max_visible_sample_);
+  }
+  RequestRedraw();
+}
+
+void FlameGraphWindow::ClearSamplingData() {
+  flame_graph_ = FlameGraph();
+  capture_data_ = nullptr;
+  ZoomAll();
+  RequestRedraw();
+}
+
+void FlameGraphWindow::ZoomAll() {
+  min_visible_sample_ = 0.0;
+  max_visible_sample_ = static_cast<double>(flame_graph_.GetTotalSampleCount());
+}
+
+bool FlameGraphWindow::IsShowingAllSamples() const {
+  return min_visible_sample_ <= 0.0 &&
+         max_visible_sample_ >= static_cast<double>(flame_graph_.GetTotalSampleCount());
+}
+
+void FlameGraphWindow::SetVisibleSampleRange(double min_sample, double max_sample) {
+  const auto total_sample_count = static_cast<double>(flame_graph_.GetTotalSampleCount());
+  const double visible_samples =
+      std::min(std::max(max_sample - min_sample, kMinVisibleSamples), total_sample_count);
+  min_visible_sample_ = std::clamp(min_sample, 0.0, total_sample_count - visible_samples);
+  max_visible_sample_ = min_visible_sample_ + visible_samples;
+}
+
+double FlameGraphWindow::GetSamplesPerPixel() const {
+  if (viewport_.GetScreenWidth() == 0) return 0.0;
+  return (max_visible_sample_ - min_visible_sample_) / viewport_.GetScreenWidth();
+}
+
+void FlameGraphWindow::MouseMoved(int x, int y, bool left, bool right, bool middle) {
+  if (left && !picking_manager_.IsDragging()) {
+    const double delta_samples = (x - mouse_click_x_) * GetSamplesPerPixel();
+    const double visible_samples = max_visible_sample_ - min_visible_sample_;
+    const double min_sample = mouse_click_min_visible_sample_ - delta_samples;
+    SetVisibleSampleRange(min_sample, min_sample + visible_samples);
+  }
+
+  // Handles the vertical panning, the flame graph is never wider than the viewport.
+  GlCanvas::MouseMoved(x, y, left, right, middle);
+}
+
+void FlameGraphWindow::LeftDown(int x, int y) {
+  GlCanvas::LeftDown(x, y);
+  mouse_click_x_ = x;
+  mouse_click_min_visible_sample_ = min_visible_sample_;
+}
+
+void FlameGraphWindow::MouseWheelMoved(int x, int y, int delta, bool ctrl) {
+  GlCanvas::MouseWheelMoved(x, y, delta, ctrl);
+  if (delta == 0) return;
+
+  const double scale = delta > 0 ? kZoomFactor : 1.0 / kZoomFactor;
+  const double mouse_sample = min_visible_sample_ + x * GetSamplesPerPixel();
+  SetVisibleSampleRange(mouse_sample - (mouse_sample - min_visible_sample_) * scale,
+                        mouse_sample + (max_visible_sample_ - mouse_sample) * scale);
+}
+
+void FlameGraphWindow::KeyPressed(unsigned int key_code, bool ctrl, bool shift, bool alt) {
+  GlCanvas::KeyPressed(key_code, ctrl, shift, alt);
+  if (key_code == ' ' && !shift) {
+    ZoomAll();
+  }
+}
+
+void FlameGraphWindow::HandlePickedElement(PickingMode picking_mode, PickingId picking_id,
+                                           int /*x*/, int /*y*/) {
+  if (picking_mode != PickingMode::kHover) return;
+  std::string tooltip;
+  if (picking_id.batcher_id == BatcherId::kUi) {
+    const PickingUserData* user_data = ui_batcher_.GetUserData(picking_id);
+    if (user_data != nullptr && user_data->generate_tooltip_) {
+      tooltip = user_data->generate_tooltip_(picking_id);
+    }
+  }
+  app_->SendTooltipToUi(tooltip);
+}
+
+std::string FlameGraphWindow::GetFunctionName(uint64_t function_address) const {
+  if (function_address == FlameGraph::kUnwindErrorsAddress) return kUnwindErrorsName;
+  if (capture_data_ == nullptr) return CaptureData::kUnknownFunctionOrModuleName;
+  return capture_data_->GetFunctionNameByAddress(function_address);
+}
+
+std::string FlameGraphWindow::GetFrameTooltip(size_t depth, size_t index) const {
+  // The primitives used for picking can be from before the last call to SetSamplingData.
+  if (depth >= flame_graph_.GetDepth() || index >= flame_graph_.GetRow(depth).size()) return "";
+  const FlameGraph::Row& row = flame_graph_.GetRow(depth);
+  const uint64_t sample_count = row.sample_counts[index];
+  const float percent = 100.f * static_cast<float>(sample_count) /
+                        static_cast<float>(flame_graph_.GetTotalSampleCount());
+  return absl::StrFormat("<b>%s</b><br/>%u samples (%.2f%%)",
+                         GetFunctionName(row.function_addresses[index]), sample_count, percent);
+}
+
+void FlameGraphWindow::Draw(bool /*viewport_was_dirty*/) {
+  ORBIT_SCOPE("FlameGraphWindow::Draw");
+  const float world_width = viewport_.GetVisibleWorldWidth();
+  viewport_.SetWorldExtents(world_width, kRowHeight * static_cast<float>(flame_graph_.GetDepth()));
+
+  const double samples_per_pixel = GetSamplesPerPixel();
+  if (samples_per_pixel > 0.0) {
+    const float world_top_y = viewport_.GetWorldTopLeft()[1];
+    const float world_bottom_y = world_top_y - viewport_.GetVisibleWorldHeight();
+    for (size_t depth = 0; depth < flame_graph_.GetDepth(); ++depth) {
+      const float row_top_y = -kRowHeight * static_cast<float>(depth);
+      const float row_bottom_y = row_top_y - kRowHeight;
+      if (row_bottom_y > world_top_y) continue;
+      if (row_top_y < world_bottom_y) break;
+
+      const FlameGraph::Row& row = flame_graph_.GetRow(depth);
+      flame_graph_.ForEachVisibleFrame(
+          depth, min_visible_sample_, max_visible_sample_, samples_per_pixel, [&](size_t index) {
+            // Clip to the window, so that labels of frames wider than the window stay visible.
+            const double first_sample = std::max<double>(row.first_samples[index],
+                                                          min_visible_sample_);
+            const double end_sample = std::min<double>(
+                row.first_samples[index] + row.sample_counts[index], max_visible_sample_);
+            const auto x = static_cast<float>((first_sample - min_visible_sample_) /
+                                              samples_per_pixel);
+            const auto width = static_cast<float>((end_sample - first_sample) / samples_per_pixel);
+
+            const uint64_t function_address = row.function_addresses[index];
+            Box box(Vec2(x, row_bottom_y), Vec2(std::max(width - kFrameMargin, 1.f),
+                                                kRowHeight - kFrameMargin),
+                    GlCanvas::kZValueBox);
+            auto user_data = std::make_unique<PickingUserData>(
+                nullptr, [this, depth, index](PickingId /*id*/) {
+                  return GetFrameTooltip(depth, index);
+                });
+            ui_batcher_.AddBox(box, GetFrameColor(function_address), std::move(user_data));
+
+            if (picking_mode_ == PickingMode::kNone && width >= kMinFrameWidthForText) {
+              text_renderer_.AddText(GetFunctionName(function_address).c_str(), x + kTextMargin,
+                                     row_bottom_y + kTextOffset, GlCanvas::kZValueBox, kTextBlack,
+                                     kFontSize, width - 2 * kTextMargin);
+            }
+          });
+    }
+  }
+
+  std::vector<float> all_layers = ui_batcher_.GetLayers();
+  orbit_base::Append(all_layers, text_renderer_.GetLayers());
+  std::sort(all_layers.begin(), all_layers.end());
+  all_layers.erase(std::unique(all_layers.begin(), all_layers.end()), all_layers.end());
+
+  for (float layer : all_layers) {
+    PrepareWorldSpaceViewport();
+    ui_batcher_.DrawLayer(layer, picking_mode_ != PickingMode::kNone);
+
+    // Text needs to be drawn in screen space.
+    PrepareScreenSpaceViewport();
+    if (picking_mode_ == PickingMode::kNone) {
+      text_renderer_.RenderLayer(layer);
+    }
+  }
+}
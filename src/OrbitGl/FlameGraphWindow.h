@@ -0,0 +1,74 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_GL_FLAME_GRAPH_WINDOW_H_
+#define ORBIT_GL_FLAME_GRAPH_WINDOW_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "ClientData/PostProcessedSamplingData.h"
+#include "ClientModel/CaptureData.h"
+#include "FlameGraph.h"
+#include "GlCanvas.h"
+#include "PickingManager.h"
+
+class OrbitApp;
+
+// Canvas showing the sampled callstacks of all threads as a flame graph, with the outermost frames
+// at the top. Frames are drawn with the Batcher, and only frames that are at least one pixel wide
+// are drawn, so that the cost of a frame does not depend on the number of samples.
+//
+// The mouse wheel zooms horizontally around the mouse, dragging pans and space zooms out to all
+// samples.
+class FlameGraphWindow : public GlCanvas {
+ public:
+  explicit FlameGraphWindow(OrbitApp* app);
+
+  // Shows the summary of `post_processed_sampling_data`. Function names are looked up in
+  // `capture_data`, which needs to outlive the window or the next call to SetSamplingData or
+  // ClearSamplingData. If the window showed all samples before, it also shows all samples after the
+  // update, so that live updates during a capture keep the whole graph visible.
+  void SetSamplingData(
+      const orbit_client_data::PostProcessedSamplingData& post_processed_sampling_data,
+      const orbit_client_model::CaptureData* capture_data);
+  void ClearSamplingData();
+
+  [[nodiscard]] const orbit_gl::FlameGraph& GetFlameGraph() const { return flame_graph_; }
+
+  void MouseMoved(int x, int y, bool left, bool right, bool middle) override;
+  void LeftDown(int x, int y) override;
+  void MouseWheelMoved(int x, int y, int delta, bool ctrl) override;
+  void KeyPressed(unsigned int key_code, bool ctrl, bool shift, bool alt) override;
+
+ protected:
+  void Draw(bool viewport_was_dirty) override;
+
+ private:
+  void HandlePickedElement(PickingMode picking_mode, PickingId picking_id, int x,
+                           int y) override;
+
+  void ZoomAll();
+  void SetVisibleSampleRange(double min_sample, double max_sample);
+  [[nodiscard]] bool IsShowingAllSamples() const;
+  [[nodiscard]] double GetSamplesPerPixel() const;
+
+  [[nodiscard]] std::string GetFunctionName(uint64_t function_address) const;
+  [[nodiscard]] std::string GetFrameTooltip(size_t depth, size_t index) const;
+
+  OrbitApp* app_ = nullptr;
+  const orbit_client_model::CaptureData* capture_data_ = nullptr;
+  orbit_gl::FlameGraph flame_graph_;
+
+  // The range of samples spanning the width of the window.
+  double min_visible_sample_ = 0.0;
+  double max_visible_sample_ = 0.0;
+
+  int mouse_click_x_ = 0;
+  double mouse_click_min_visible_sample_ = 0.0;
+};
+
+#endif  // ORBIT_GL_FLAME_GRAPH_WINDOW_H_
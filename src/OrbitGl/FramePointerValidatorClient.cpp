@@ -11,10 +11,11 @@
 
 #include <algorithm>
 #include <chrono>
+#include <memory>
 #include <string>
 
 #include "App.h"
-#include "ClientData/FunctionUtils.h"
+#include "ClientData/FunctionTable.h"
 #include "ClientData/ModuleData.h"
 #include "OrbitBase/Logging.h"
 #include "capture_data.pb.h"
@@ -23,8 +24,9 @@
 #include "services.grpc.pb.h"
 #include "services.pb.h"
 
+using orbit_client_data::FunctionHandle;
+using orbit_client_data::FunctionTable;
 using orbit_client_data::ModuleData;
-using orbit_client_protos::FunctionInfo;
 using orbit_grpc_protos::CodeBlock;
 using orbit_grpc_protos::FramePointerValidatorService;
 using orbit_grpc_protos::ValidateFramePointersRequest;
@@ -48,12 +50,12 @@ void FramePointerValidatorClient::AnalyzeModules(const std::vector<const ModuleD
     ValidateFramePointersResponse response;
     CHECK(module != nullptr);
 
-    std::vector<const FunctionInfo*> functions = module->GetFunctions();
     request.set_module_path(module->file_path());
-    for (const FunctionInfo* function : functions) {
+    std::shared_ptr<const FunctionTable> functions = module->GetFunctions();
+    for (FunctionHandle function : *functions) {
       CodeBlock* function_info = request.add_functions();
-      function_info->set_offset(orbit_client_data::function_utils::Offset(*function, *module));
-      function_info->set_size(function->size());
+      function_info->set_offset(function.address() - module->load_bias());
+      function_info->set_size(function.size());
     }
     grpc::ClientContext context;
     std::chrono::time_point deadline = std::chrono::system_clock::now() + std::chrono::minutes(1);
@@ -9,14 +9,20 @@
 #include <glad/glad.h>
 #include <math.h>
 
+#include <algorithm>
+#include <optional>
+#include <vector>
+
 #include "AccessibleInterfaceProvider.h"
 #include "App.h"
 #include "CaptureWindow.h"
+#include "FlameGraphWindow.h"
 #include "GlUtils.h"
 #include "ImGuiOrbit.h"
 #include "Introspection/Introspection.h"
 #include "IntrospectionWindow.h"
 #include "OrbitAccessibility/AccessibleWidgetBridge.h"
+#include "OrbitBase/Append.h"
 #include "OrbitBase/Logging.h"
 
 // Tracks: 0.0 - 0.1
@@ -65,6 +71,7 @@ GlCanvas::GlCanvas()
   // Note that `GlCanvas` is the bridge to OpenGl content, and `GlCanvas`'s parent needs special
   // handling for accessibility. Thus, we use `nullptr` here.
   text_renderer_.SetViewport(&viewport_);
+  ui_batcher_.SetInstancedBoxRenderer(&instanced_box_renderer_);
 
   is_selecting_ = false;
   double_clicking_ = false;
@@ -98,6 +105,11 @@ std::unique_ptr<GlCanvas> GlCanvas::Create(CanvasType canvas_type, OrbitApp* app
       app->SetIntrospectionWindow(introspection_window.get());
       return introspection_window;
     }
+    case CanvasType::kFlameGraphWindow: {
+      auto flame_graph_window = std::make_unique<FlameGraphWindow>(app);
+      app->SetFlameGraphWindow(flame_graph_window.get());
+      return flame_graph_window;
+    }
     case CanvasType::kDebug:
       return std::make_unique<GlCanvas>();
     default:
@@ -273,6 +285,16 @@ void GlCanvas::Render(int width, int height) {
   }
 
   redraw_requested_ = false;
+
+  // Most hover targets can be resolved from the primitives of the last frame, which saves the
+  // additional render pass with picking colors. Clicks still use that render pass, as some elements
+  // (e.g. event bars) are drawn above their content when handling a click.
+  if (picking_mode_ == PickingMode::kHover &&
+      PickOnCpu(picking_mode_, mouse_move_pos_screen_[0], mouse_move_pos_screen_[1])) {
+    can_hover_ = false;
+    picking_mode_ = PickingMode::kNone;
+  }
+
   ui_batcher_.StartNewFrame();
 
   PrepareGlState();
@@ -360,6 +382,46 @@ void GlCanvas::Pick(PickingMode picking_mode, int x, int y) {
   HandlePickedElement(picking_mode, pick_id, x, y);
 }
 
+bool GlCanvas::PickOnCpu(PickingMode picking_mode, int x, int y) {
+  ORBIT_SCOPE_FUNCTION;
+  std::vector<const Batcher*> batchers = GetBatchersInDrawOrder();
+
+  std::vector<float> all_layers;
+  for (const Batcher* batcher : batchers) {
+    orbit_base::Append(all_layers, batcher->GetLayers());
+  }
+  std::sort(all_layers.begin(), all_layers.end());
+  all_layers.erase(std::unique(all_layers.begin(), all_layers.end()), all_layers.end());
+
+  // Use the center of the pixel, in both coordinate systems used for drawing (see Draw()).
+  Vec2 world_pos = viewport_.ScreenToWorldPos(Vec2i(x, y));
+  world_pos[0] += 0.5f * viewport_.ScreenToWorldWidth(1);
+  world_pos[1] -= 0.5f * viewport_.ScreenToWorldHeight(1);
+  const Vec2 screen_space_pos(static_cast<float>(x) + 0.5f,
+                              static_cast<float>(viewport_.GetScreenHeight() - y) - 0.5f);
+
+  // Higher layers are drawn on top, and within a layer, later batchers are drawn on top.
+  std::optional<PickingId> picked_id;
+  for (auto layer = all_layers.rbegin(); layer != all_layers.rend() && !picked_id; ++layer) {
+    const bool is_screen_space = *layer >= kScreenSpaceCutPoint;
+    // Decorations in screen space (margins, time bar background) are also drawn when rendering
+    // with picking colors and hide what is below them. Decorations in world space (rounded
+    // corners, the mouse position line, overlays) are not.
+    const Vec2& pos = is_screen_space ? screen_space_pos : world_pos;
+    for (auto batcher = batchers.rbegin(); batcher != batchers.rend() && !picked_id; ++batcher) {
+      picked_id = (*batcher)->PickLayer(*layer, pos, /*decorations_occlude=*/is_screen_space);
+    }
+  }
+
+  // Custom Pickables might draw differently when rendering with picking colors, so only the GPU
+  // can tell for sure what is below the mouse.
+  if (picked_id.has_value() && picked_id->type == PickingType::kPickable) return false;
+
+  // Nothing was hit, which is equivalent to reading back the cleared background.
+  HandlePickedElement(picking_mode, picked_id.value_or(PickingId::FromPixelValue(0)), x, y);
+  return true;
+}
+
 std::unique_ptr<orbit_accessibility::AccessibleInterface> GlCanvas::CreateAccessibleInterface() {
   return std::make_unique<orbit_accessibility::AccessibleWidgetBridge>();
 }
\ No newline at end of file
@@ -36,7 +36,7 @@ class GlCanvas : public orbit_gl::AccessibleInterfaceProvider {
   explicit GlCanvas();
   virtual ~GlCanvas();
 
-  enum class CanvasType { kCaptureWindow, kIntrospectionWindow, kDebug };
+  enum class CanvasType { kCaptureWindow, kIntrospectionWindow, kFlameGraphWindow, kDebug };
   static std::unique_ptr<GlCanvas> Create(CanvasType canvas_type, OrbitApp* app);
 
   void Resize(int width, int height);
@@ -137,6 +137,11 @@ class GlCanvas : public orbit_gl::AccessibleInterfaceProvider {
 
   void SetPickingMode(PickingMode mode);
 
+  // Batchers whose primitives can be picked, in the order in which they are drawn within a layer.
+  [[nodiscard]] virtual std::vector<const Batcher*> GetBatchersInDrawOrder() const {
+    return {&ui_batcher_};
+  }
+
   Vec2 mouse_click_pos_world_;
   Vec2i mouse_move_pos_screen_ = Vec2i(0, 0);
   Vec2 select_start_pos_world_ = Vec2(0, 0);
@@ -161,6 +166,8 @@ class GlCanvas : public orbit_gl::AccessibleInterfaceProvider {
 
   orbit_gl::Viewport viewport_;
 
+  // Shared by all batchers drawing into this canvas' GL context, so it has to outlive them.
+  orbit_gl::InstancedBoxRenderer instanced_box_renderer_;
   // Batcher to draw elements in the UI.
   Batcher ui_batcher_;
   std::vector<RenderCallback> render_callbacks_;
@@ -169,6 +176,7 @@ class GlCanvas : public orbit_gl::AccessibleInterfaceProvider {
   [[nodiscard]] virtual std::unique_ptr<orbit_accessibility::AccessibleInterface>
   CreateAccessibleInterface() override;
   void Pick(PickingMode picking_mode, int x, int y);
+  [[nodiscard]] bool PickOnCpu(PickingMode picking_mode, int x, int y);
   virtual void HandlePickedElement(PickingMode /*picking_mode*/, PickingId /*picking_id*/,
                                    int /*x*/, int /*y*/) {}
 };
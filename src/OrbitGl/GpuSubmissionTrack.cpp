@@ -37,7 +37,6 @@ GpuSubmissionTrack::GpuSubmissionTrack(Track* parent, TimeGraph* time_graph,
     : TimerTrack(parent, time_graph, viewport, layout, app, capture_data, indentation_level) {
   SetLabel("Submissions");
   draw_background_ = false;
-  text_renderer_ = time_graph->GetTextRenderer();
   timeline_hash_ = timeline_hash;
   string_manager_ = app->GetStringManager();
   parent_ = parent;
@@ -180,7 +179,7 @@ void GpuSubmissionTrack::SetTimesliceText(const TimerInfo& timer_info, float min
   const auto& box_size = text_box->GetSize();
   float pos_x = std::max(box_pos.first, min_x);
   float max_size = box_pos.first + box_size.first - pos_x;
-  text_renderer_->AddTextTrailingCharsPrioritized(
+  time_graph_->GetTextRendererForUpdate()->AddTextTrailingCharsPrioritized(
       text_box->GetText().c_str(), pos_x, box_pos.second + layout_->GetTextOffset(),
       GlCanvas::kZValueBox + z_offset, kTextWhite, text_box->GetElapsedTimeTextLength(),
       layout_->CalculateZoomedFontSize(), max_size);
@@ -145,8 +145,6 @@ void GpuTrack::Draw(Batcher& batcher, TextRenderer& text_renderer, uint64_t curr
   SetPos(viewport_->GetWorldTopLeft()[0], pos_[1]);
   SetSize(track_width, track_height);
 
-  UpdatePositionOfSubtracks();
-
   Track::Draw(batcher, text_renderer, current_mouse_time_ns, picking_mode, z_offset);
 
   if (collapse_toggle_->IsCollapsed()) {
@@ -73,7 +73,7 @@ class GpuTrack : public Track {
   [[nodiscard]] bool IsCollapsible() const override { return true; }
 
  private:
-  void UpdatePositionOfSubtracks();
+  void UpdatePositionOfSubtracks() override;
   const std::shared_ptr<GpuSubmissionTrack> submission_track_;
   const std::shared_ptr<GpuDebugMarkerTrack> marker_track_;
 
@@ -0,0 +1,196 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "InstancedBoxRenderer.h"
+
+#include <glad/glad.h>
+#include <stddef.h>
+
+#include <string>
+
+#include "Introspection/Introspection.h"
+#include "OrbitBase/Logging.h"
+
+namespace orbit_gl {
+
+namespace {
+
+// Attribute locations of the vertex shader below.
+constexpr GLuint kRectLocation = 0;
+constexpr GLuint kStartColorLocation = 1;
+constexpr GLuint kEndColorLocation = 2;
+constexpr GLuint kPickingColorLocation = 3;
+constexpr GLuint kGradientAxisLocation = 4;
+
+// The four vertices of an instance are generated from gl_VertexID in the order of Box::vertices,
+// and are drawn as a triangle fan.
+constexpr const char* kVertexShader = R"(#version 330
+uniform mat4 projection;
+uniform mat4 modelview;
+uniform float z;
+
+layout(location = 0) in vec4 rect;
+layout(location = 1) in vec4 start_color;
+layout(location = 2) in vec4 end_color;
+layout(location = 3) in vec4 picking_color;
+layout(location = 4) in float gradient_axis;
+
+out vec4 fragment_color;
+flat out vec4 fragment_picking_color;
+
+void main() {
+  vec2 corner = vec2(gl_VertexID >= 2 ? 1.0 : 0.0, (gl_VertexID == 1 || gl_VertexID == 2) ? 1.0 : 0.0);
+  float gradient_position = gradient_axis > 0.5 ? corner.y : corner.x;
+  fragment_color = mix(start_color, end_color, gradient_position);
+  fragment_picking_color = picking_color;
+  gl_Position = projection * modelview * vec4(rect.xy + corner * rect.zw, z, 1.0);
+}
+)";
+
+constexpr const char* kFragmentShader = R"(#version 330
+uniform bool picking;
+
+in vec4 fragment_color;
+flat in vec4 fragment_picking_color;
+
+out vec4 output_color;
+
+void main() {
+  output_color = picking ? fragment_picking_color : fragment_color;
+}
+)";
+
+[[nodiscard]] GLuint CompileShader(GLenum type, const char* source) {
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+
+  GLint status = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (status == GL_FALSE) {
+    GLint log_length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+    std::string log(static_cast<size_t>(log_length), '\0');
+    glGetShaderInfoLog(shader, log_length, nullptr, log.data());
+    ERROR("Compiling box shader: %s", log);
+    glDeleteShader(shader);
+    return 0;
+  }
+  return shader;
+}
+
+[[nodiscard]] GLuint LinkProgram(GLuint vertex_shader, GLuint fragment_shader) {
+  GLuint program = glCreateProgram();
+  glAttachShader(program, vertex_shader);
+  glAttachShader(program, fragment_shader);
+  glLinkProgram(program);
+  glDetachShader(program, vertex_shader);
+  glDetachShader(program, fragment_shader);
+
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &status);
+  if (status == GL_FALSE) {
+    GLint log_length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &log_length);
+    std::string log(static_cast<size_t>(log_length), '\0');
+    glGetProgramInfoLog(program, log_length, nullptr, log.data());
+    ERROR("Linking box shader program: %s", log);
+    glDeleteProgram(program);
+    return 0;
+  }
+  return program;
+}
+
+void SetInstanceAttribute(GLuint location, GLint size, GLenum type, GLboolean normalized,
+                          size_t offset) {
+  glEnableVertexAttribArray(location);
+  glVertexAttribPointer(location, size, type, normalized, sizeof(BoxInstance),
+                        reinterpret_cast<const void*>(offset));
+  glVertexAttribDivisor(location, 1);
+}
+
+}  // namespace
+
+InstancedBoxRenderer::~InstancedBoxRenderer() {
+  if (instance_buffer_ != 0) glDeleteBuffers(1, &instance_buffer_);
+  if (vertex_array_ != 0) glDeleteVertexArrays(1, &vertex_array_);
+  if (program_ != 0) glDeleteProgram(program_);
+}
+
+bool InstancedBoxRenderer::IsSupported() {
+  if (!initialized_) Init();
+  return supported_;
+}
+
+void InstancedBoxRenderer::Init() {
+  initialized_ = true;
+  if (!GLAD_GL_VERSION_3_3) {
+    LOG("GL 3.3 is not available, boxes will not be drawn with instancing");
+    return;
+  }
+
+  GLuint vertex_shader = CompileShader(GL_VERTEX_SHADER, kVertexShader);
+  GLuint fragment_shader = CompileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+  if (vertex_shader != 0 && fragment_shader != 0) {
+    program_ = LinkProgram(vertex_shader, fragment_shader);
+  }
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  if (program_ == 0) return;
+
+  projection_location_ = glGetUniformLocation(program_, "projection");
+  modelview_location_ = glGetUniformLocation(program_, "modelview");
+  z_location_ = glGetUniformLocation(program_, "z");
+  picking_location_ = glGetUniformLocation(program_, "picking");
+
+  glGenVertexArrays(1, &vertex_array_);
+  glGenBuffers(1, &instance_buffer_);
+  glBindVertexArray(vertex_array_);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+  SetInstanceAttribute(kRectLocation, 4, GL_FLOAT, GL_FALSE, offsetof(BoxInstance, x));
+  SetInstanceAttribute(kStartColorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                       offsetof(BoxInstance, start_color));
+  SetInstanceAttribute(kEndColorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                       offsetof(BoxInstance, end_color));
+  SetInstanceAttribute(kPickingColorLocation, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                       offsetof(BoxInstance, picking_color));
+  SetInstanceAttribute(kGradientAxisLocation, 1, GL_UNSIGNED_BYTE, GL_FALSE,
+                       offsetof(BoxInstance, gradient_axis));
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  supported_ = true;
+}
+
+void InstancedBoxRenderer::Draw(const BoxInstance* boxes, size_t num_boxes, float z,
+                                bool picking) {
+  ORBIT_SCOPE_FUNCTION;
+  CHECK(supported_);
+  if (num_boxes == 0) return;
+
+  GLfloat projection[16];
+  GLfloat modelview[16];
+  glGetFloatv(GL_PROJECTION_MATRIX, projection);
+  glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+
+  glUseProgram(program_);
+  glUniformMatrix4fv(projection_location_, 1, GL_FALSE, projection);
+  glUniformMatrix4fv(modelview_location_, 1, GL_FALSE, modelview);
+  glUniform1f(z_location_, z);
+  glUniform1i(picking_location_, picking ? 1 : 0);
+
+  // The attribute pointers of the vertex array refer to the instance buffer, whose data store is
+  // replaced here.
+  glBindVertexArray(vertex_array_);
+  glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(num_boxes * sizeof(BoxInstance)), boxes,
+               GL_STREAM_DRAW);
+
+  glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, static_cast<GLsizei>(num_boxes));
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glUseProgram(0);
+}
+
+}  // namespace orbit_gl
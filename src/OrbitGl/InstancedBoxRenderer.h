@@ -0,0 +1,54 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_GL_INSTANCED_BOX_RENDERER_H_
+#define ORBIT_GL_INSTANCED_BOX_RENDERER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "BoxInstance.h"
+
+namespace orbit_gl {
+
+// Draws BoxInstance records with one instanced draw call per block of boxes. A vertex shader
+// expands each record into a quad, so only the compact records need to be uploaded. This requires
+// GL 3.3 (instanced vertex attributes). IsSupported() returns false on older GL versions or if the
+// shader could not be built, in which case boxes have to be expanded and drawn on the CPU side.
+//
+// GL resources are created lazily on the first call to IsSupported() and released on destruction,
+// both of which require the GL context they belong to to be current. As GL objects can't be used
+// across contexts that don't share them, there is one renderer per GL context, owned by GlCanvas
+// and used by all of the canvas' batchers.
+class InstancedBoxRenderer {
+ public:
+  InstancedBoxRenderer() = default;
+  InstancedBoxRenderer(const InstancedBoxRenderer&) = delete;
+  InstancedBoxRenderer& operator=(const InstancedBoxRenderer&) = delete;
+  ~InstancedBoxRenderer();
+
+  [[nodiscard]] bool IsSupported();
+
+  // Draws `num_boxes` boxes at depth `z` with the current modelview and projection matrices. If
+  // `picking` is true, boxes are filled with their picking color instead of their color.
+  void Draw(const BoxInstance* boxes, size_t num_boxes, float z, bool picking);
+
+ private:
+  void Init();
+
+  bool initialized_ = false;
+  bool supported_ = false;
+  uint32_t program_ = 0;
+  // Holds the instanced attribute setup, so that it doesn't leak into the default vertex array.
+  uint32_t vertex_array_ = 0;
+  uint32_t instance_buffer_ = 0;
+  int32_t projection_location_ = -1;
+  int32_t modelview_location_ = -1;
+  int32_t z_location_ = -1;
+  int32_t picking_location_ = -1;
+};
+
+}  // namespace orbit_gl
+
+#endif  // ORBIT_GL_INSTANCED_BOX_RENDERER_H_
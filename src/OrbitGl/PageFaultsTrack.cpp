@@ -80,8 +80,6 @@ void PageFaultsTrack::Draw(Batcher& batcher, TextRenderer& text_renderer,
   SetSize(track_width, track_height);
   SetLabel(collapse_toggle_->IsCollapsed() ? major_page_faults_track_->GetName() : GetName());
 
-  UpdatePositionOfSubtracks();
-
   Track::Draw(batcher, text_renderer, current_mouse_time_ns, picking_mode, z_offset);
 
   if (collapse_toggle_->IsCollapsed()) return;
@@ -54,7 +54,7 @@ class PageFaultsTrack : public Track {
   }
 
  private:
-  void UpdatePositionOfSubtracks();
+  void UpdatePositionOfSubtracks() override;
 
   std::shared_ptr<MajorPageFaultsTrack> major_page_faults_track_;
   std::shared_ptr<MinorPageFaultsTrack> minor_page_faults_track_;
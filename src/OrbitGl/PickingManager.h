@@ -89,6 +89,11 @@ struct PickingId {
     return id;
   }
 
+  [[nodiscard]] static PickingId FromColor(const Color& color) {
+    std::array<uint8_t, 4> color_values{color[0], color[1], color[2], color[3]};
+    return FromPixelValue(absl::bit_cast<uint32_t>(color_values));
+  }
+
   [[nodiscard]] uint32_t ToPixelValue() const {
     Layout layout{};
     layout.element_id = element_id;
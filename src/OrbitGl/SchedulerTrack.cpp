@@ -8,15 +8,19 @@
 #include <absl/strings/str_format.h>
 #include <stdint.h>
 
+#include <limits>
+
 #include "App.h"
 #include "Batcher.h"
 #include "ClientData/TextBox.h"
 #include "ClientModel/CaptureData.h"
+#include "GlCanvas.h"
 #include "OrbitBase/Logging.h"
 #include "TimeGraph.h"
 #include "TimeGraphLayout.h"
 #include "Viewport.h"
 
+using orbit_client_data::SchedulingSliceInfo;
 using orbit_client_protos::TimerInfo;
 
 const Color kInactiveColor(100, 100, 100, 255);
@@ -34,13 +38,113 @@ SchedulerTrack::SchedulerTrack(CaptureViewElement* parent, TimeGraph* time_graph
 }
 
 void SchedulerTrack::OnTimer(const orbit_client_protos::TimerInfo& timer_info) {
-  TimerTrack::OnTimer(timer_info);
+  scheduling_slices_->AddSlice(timer_info.process_id(), timer_info.thread_id(),
+                               timer_info.processor(), timer_info.start(), timer_info.end());
+  if (timer_info.start() < min_time_) min_time_ = timer_info.start();
+  if (timer_info.end() > max_time_) max_time_ = timer_info.end();
+  ++num_timers_;
+
   if (num_cores_ <= static_cast<uint32_t>(timer_info.processor())) {
     num_cores_ = timer_info.processor() + 1;
+    UpdateDepth(num_cores_);
     SetLabel(absl::StrFormat("Scheduler (%u cores)", num_cores_));
   }
 }
 
+void SchedulerTrack::UpdatePrimitives(Batcher* batcher, uint64_t min_tick, uint64_t max_tick,
+                                      PickingMode /*picking_mode*/, float z_offset) {
+  UpdateBoxHeight();
+  visible_timer_count_ = 0;
+
+  const internal::DrawData draw_data = GetDrawData(
+      min_tick, max_tick, z_offset, batcher, time_graph_, viewport_,
+      collapse_toggle_->IsCollapsed(), app_->selected_text_box(), app_->GetFunctionIdToHighlight());
+  const TimerInfo* selected_timer_info =
+      draw_data.selected_textbox != nullptr &&
+              draw_data.selected_textbox->GetTimerInfo().type() == TimerInfo::kCoreActivity
+          ? &draw_data.selected_textbox->GetTimerInfo()
+          : nullptr;
+
+  const uint32_t num_cores = scheduling_slices_->GetNumCores();
+  for (uint32_t core = 0; core < num_cores; ++core) {
+    // As in TimerTrack::UpdatePrimitives, slices that would just draw over an already drawn line
+    // are discarded.
+    uint64_t min_ignore = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ignore = std::numeric_limits<uint64_t>::min();
+    scheduling_slices_->ForEachSliceInRange(
+        core, min_tick, max_tick, [&](const SchedulingSliceInfo& slice) {
+          if (slice.start_ns >= min_ignore && slice.end_ns <= max_ignore) return true;
+          const bool is_selected = selected_timer_info != nullptr &&
+                                   selected_timer_info->processor() == slice.core &&
+                                   selected_timer_info->start() == slice.start_ns;
+          DrawSlice(slice, draw_data, is_selected, &min_ignore, &max_ignore);
+          ++visible_timer_count_;
+          return true;
+        });
+  }
+}
+
+void SchedulerTrack::DrawSlice(const SchedulingSliceInfo& slice,
+                               const internal::DrawData& draw_data, bool is_selected,
+                               uint64_t* min_ignore, uint64_t* max_ignore) {
+  const double start_us = time_graph_->GetUsFromTick(slice.start_ns);
+  const double end_us = time_graph_->GetUsFromTick(slice.end_ns);
+  const double normalized_start = start_us * draw_data.inv_time_window;
+  const double normalized_width = (end_us - start_us) * draw_data.inv_time_window;
+  const float world_x_start =
+      static_cast<float>(draw_data.world_start_x + normalized_start * draw_data.world_width);
+  const float world_x_width = static_cast<float>(normalized_width * draw_data.world_width);
+  const float world_y = GetYFromCore(slice.core);
+  const Color color = GetSliceColor(slice.pid, slice.tid, is_selected);
+
+  bool is_visible_width = normalized_width * draw_data.viewport->GetScreenWidth() > 1;
+  if (is_visible_width) {
+    Vec2 pos(world_x_start, world_y);
+    Vec2 size(world_x_width, box_height_);
+    draw_data.batcher->AddShadedBox(pos, size, draw_data.z, color,
+                                    CreateSlicePickingUserData(slice));
+    return;
+  }
+
+  Vec2 pos(world_x_start, world_y);
+  draw_data.batcher->AddVerticalLine(pos, box_height_, draw_data.z, color,
+                                     CreateSlicePickingUserData(slice));
+  // See TimerTrack::DrawTimer.
+  if (draw_data.ns_per_pixel != 0) {
+    *min_ignore = draw_data.min_timegraph_tick +
+                  ((slice.start_ns - draw_data.min_timegraph_tick) / draw_data.ns_per_pixel) *
+                      draw_data.ns_per_pixel;
+    *max_ignore = *min_ignore + draw_data.ns_per_pixel;
+  }
+}
+
+std::unique_ptr<PickingUserData> SchedulerTrack::CreateSlicePickingUserData(
+    const SchedulingSliceInfo& slice) {
+  auto user_data = std::make_unique<PickingUserData>(
+      nullptr, [this, slice](PickingId /*id*/) { return GetSliceTooltip(slice); });
+  user_data->create_text_box_ = [this, slice] { return GetOrCreateTextBox(slice); };
+  return user_data;
+}
+
+const orbit_client_data::TextBox* SchedulerTrack::GetOrCreateTextBox(
+    const SchedulingSliceInfo& slice) {
+  absl::MutexLock lock(&picked_text_boxes_mutex_);
+  auto it = picked_text_boxes_.find(std::make_pair(slice.core, slice.start_ns));
+  if (it != picked_text_boxes_.end()) return &it->second;
+
+  TimerInfo timer_info;
+  timer_info.set_start(slice.start_ns);
+  timer_info.set_end(slice.end_ns);
+  timer_info.set_process_id(slice.pid);
+  timer_info.set_thread_id(slice.tid);
+  timer_info.set_processor(slice.core);
+  timer_info.set_depth(slice.core);
+  timer_info.set_type(TimerInfo::kCoreActivity);
+  return &picked_text_boxes_
+              .try_emplace(std::make_pair(slice.core, slice.start_ns), std::move(timer_info))
+              .first->second;
+}
+
 float SchedulerTrack::GetHeight() const {
   uint32_t num_gaps = depth_ > 0 ? depth_ - 1 : 0;
   return GetHeaderHeight() + (depth_ * layout_->GetTextCoresHeight()) +
@@ -48,11 +152,14 @@ float SchedulerTrack::GetHeight() const {
 }
 
 bool SchedulerTrack::IsTimerActive(const TimerInfo& timer_info) const {
-  bool is_same_tid_as_selected = timer_info.thread_id() == app_->selected_thread_id();
+  return IsSliceActive(timer_info.process_id(), timer_info.thread_id());
+}
+
+bool SchedulerTrack::IsSliceActive(int32_t pid, int32_t tid) const {
+  bool is_same_tid_as_selected = tid == app_->selected_thread_id();
   CHECK(capture_data_ != nullptr);
   int32_t capture_process_id = capture_data_->process_id();
-  bool is_same_pid_as_target =
-      capture_process_id == 0 || capture_process_id == timer_info.process_id();
+  bool is_same_pid_as_target = capture_process_id == 0 || capture_process_id == pid;
 
   return is_same_tid_as_selected || (app_->selected_thread_id() == -1 && is_same_pid_as_target);
 }
@@ -62,19 +169,27 @@ Color SchedulerTrack::GetTimerColor(const TimerInfo& timer_info, bool is_selecte
   if (is_highlighted) {
     return TimerTrack::kHighlightColor;
   }
+  return GetSliceColor(timer_info.process_id(), timer_info.thread_id(), is_selected);
+}
+
+Color SchedulerTrack::GetSliceColor(int32_t pid, int32_t tid, bool is_selected) const {
   if (is_selected) {
     return kSelectionColor;
   }
-  if (!IsTimerActive(timer_info)) {
+  if (!IsSliceActive(pid, tid)) {
     return kInactiveColor;
   }
-  return TimeGraph::GetThreadColor(timer_info.thread_id());
+  return TimeGraph::GetThreadColor(tid);
 }
 
 float SchedulerTrack::GetYFromTimer(const TimerInfo& timer_info) const {
-  uint32_t num_gaps = timer_info.depth();
+  return GetYFromCore(timer_info.depth());
+}
+
+float SchedulerTrack::GetYFromCore(int32_t core) const {
+  uint32_t num_gaps = core;
   return pos_[1] - GetHeaderHeight() -
-         (layout_->GetTextCoresHeight() * static_cast<float>(timer_info.depth() + 1)) -
+         (layout_->GetTextCoresHeight() * static_cast<float>(core + 1)) -
          num_gaps * layout_->GetSpaceBetweenCores();
 }
 
@@ -84,12 +199,7 @@ std::string SchedulerTrack::GetTooltip() const {
 
 void SchedulerTrack::UpdateBoxHeight() { box_height_ = layout_->GetTextCoresHeight(); }
 
-std::string SchedulerTrack::GetBoxTooltip(const Batcher& batcher, PickingId id) const {
-  const orbit_client_data::TextBox* text_box = batcher.GetTextBox(id);
-  if (!text_box) {
-    return "";
-  }
-
+std::string SchedulerTrack::GetSliceTooltip(const SchedulingSliceInfo& slice) const {
   CHECK(capture_data_ != nullptr);
   return absl::StrFormat(
       "<b>CPU Core activity</b><br/>"
@@ -97,9 +207,6 @@ std::string SchedulerTrack::GetBoxTooltip(const Batcher& batcher, PickingId id)
       "<b>Core:</b> %d<br/>"
       "<b>Process:</b> %s [%d]<br/>"
       "<b>Thread:</b> %s [%d]<br/>",
-      text_box->GetTimerInfo().processor(),
-      capture_data_->GetThreadName(text_box->GetTimerInfo().process_id()),
-      text_box->GetTimerInfo().process_id(),
-      capture_data_->GetThreadName(text_box->GetTimerInfo().thread_id()),
-      text_box->GetTimerInfo().thread_id());
+      slice.core, capture_data_->GetThreadName(slice.pid), slice.pid,
+      capture_data_->GetThreadName(slice.tid), slice.tid);
 }
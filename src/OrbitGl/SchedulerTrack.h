@@ -5,9 +5,18 @@
 #ifndef ORBIT_GL_SCHEDULER_TRACK_H_
 #define ORBIT_GL_SCHEDULER_TRACK_H_
 
+#include <absl/base/thread_annotations.h>
+#include <absl/container/node_hash_map.h>
+#include <absl/synchronization/mutex.h>
+#include <stdint.h>
+
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "CallstackThreadBar.h"
+#include "ClientData/SchedulingSlicesPerCore.h"
+#include "ClientData/TextBox.h"
 #include "CoreMath.h"
 #include "PickingManager.h"
 #include "TimerTrack.h"
@@ -32,19 +41,49 @@ class SchedulerTrack final : public TimerTrack {
   [[nodiscard]] float GetHeight() const override;
   [[nodiscard]] bool IsCollapsible() const override { return false; }
 
+  void UpdatePrimitives(Batcher* batcher, uint64_t min_tick, uint64_t max_tick,
+                        PickingMode picking_mode, float z_offset = 0) override;
+
   void UpdateBoxHeight() override;
   [[nodiscard]] float GetYFromTimer(
       const orbit_client_protos::TimerInfo& timer_info) const override;
 
+  [[nodiscard]] std::shared_ptr<const orbit_client_data::SchedulingSlicesPerCore>
+  GetSchedulingSlices() const {
+    return scheduling_slices_;
+  }
+
   [[nodiscard]] Color GetTrackBackgroundColor() const override { return color_; }
 
  protected:
   [[nodiscard]] bool IsTimerActive(const orbit_client_protos::TimerInfo& timer_info) const override;
   [[nodiscard]] Color GetTimerColor(const orbit_client_protos::TimerInfo& timer_info,
                                     bool is_selected, bool is_highlighted) const override;
-  [[nodiscard]] std::string GetBoxTooltip(const Batcher& batcher, PickingId id) const override;
 
  private:
+  [[nodiscard]] bool IsSliceActive(int32_t pid, int32_t tid) const;
+  [[nodiscard]] Color GetSliceColor(int32_t pid, int32_t tid, bool is_selected) const;
+  [[nodiscard]] float GetYFromCore(int32_t core) const;
+  [[nodiscard]] std::string GetSliceTooltip(
+      const orbit_client_data::SchedulingSliceInfo& slice) const;
+  void DrawSlice(const orbit_client_data::SchedulingSliceInfo& slice,
+                 const internal::DrawData& draw_data, bool is_selected, uint64_t* min_ignore,
+                 uint64_t* max_ignore);
+  [[nodiscard]] std::unique_ptr<PickingUserData> CreateSlicePickingUserData(
+      const orbit_client_data::SchedulingSliceInfo& slice);
+  [[nodiscard]] const orbit_client_data::TextBox* GetOrCreateTextBox(
+      const orbit_client_data::SchedulingSliceInfo& slice);
+
+  // Scheduling slices are not stored as TextBoxes in TimerChains like other timers, see
+  // SchedulingSlicesPerCore.
+  std::shared_ptr<orbit_client_data::SchedulingSlicesPerCore> scheduling_slices_ =
+      std::make_shared<orbit_client_data::SchedulingSlicesPerCore>();
+  // TextBoxes are only created for the slices that get picked, as selection works on TextBoxes.
+  // They are keyed by (core, start timestamp) and never erased, so that pointers to them (e.g. the
+  // selected TextBox) stay valid for the lifetime of the track.
+  absl::Mutex picked_text_boxes_mutex_;
+  absl::node_hash_map<std::pair<int32_t, uint64_t>, orbit_client_data::TextBox> picked_text_boxes_
+      ABSL_GUARDED_BY(picked_text_boxes_mutex_);
   uint32_t num_cores_;
 };
 
@@ -14,26 +14,79 @@ using orbit_client_protos::TimerInfo;
 
 static constexpr double kNsToMs = 1 / 1000000.0;
 
+void SchedulingStats::PartialStats::Add(const TimerInfo& timer_info, uint64_t start_ns,
+                                       uint64_t end_ns) {
+  uint64_t clipped_start_ns = std::max(start_ns, timer_info.start());
+  uint64_t clipped_end_ns = std::min(end_ns, timer_info.end());
+  uint64_t timer_duration_ns = clipped_end_ns - clipped_start_ns;
+
+  time_on_core_ns_by_core[timer_info.processor()] += timer_duration_ns;
+  time_on_core_ns_by_thread[{timer_info.process_id(), timer_info.thread_id()}] += timer_duration_ns;
+}
+
+void SchedulingStats::PartialStats::Add(const orbit_client_data::SchedulingSliceInfo& slice,
+                                       uint64_t start_ns, uint64_t end_ns) {
+  uint64_t clipped_start_ns = std::max(start_ns, slice.start_ns);
+  uint64_t clipped_end_ns = std::min(end_ns, slice.end_ns);
+  uint64_t slice_duration_ns = clipped_end_ns - clipped_start_ns;
+
+  time_on_core_ns_by_core[slice.core] += slice_duration_ns;
+  time_on_core_ns_by_thread[{slice.pid, slice.tid}] += slice_duration_ns;
+}
+
+SchedulingStats::PartialStats SchedulingStats::AggregateCore(
+    const orbit_client_data::SchedulingSlicesPerCore& scheduling_slices, int32_t core,
+    uint64_t start_ns, uint64_t end_ns, const std::atomic<bool>& cancelled) {
+  PartialStats partial_stats;
+  if (cancelled) return partial_stats;
+  uint64_t num_visited_slices = 0;
+  scheduling_slices.ForEachSliceInRange(
+      core, start_ns, end_ns,
+      [&](const orbit_client_data::SchedulingSliceInfo& slice) {
+        if (++num_visited_slices % kSlicesPerCancellationCheck == 0 && cancelled) return false;
+        if (slice.end_ns > start_ns) partial_stats.Add(slice, start_ns, end_ns);
+        return true;
+      });
+  return partial_stats;
+}
+
+static SchedulingStats::PartialStats AggregateScopes(
+    const std::vector<const orbit_client_data::TextBox*>& scheduling_scopes, uint64_t start_ns,
+    uint64_t end_ns) {
+  SchedulingStats::PartialStats partial_stats;
+  for (const orbit_client_data::TextBox* scope : scheduling_scopes) {
+    partial_stats.Add(scope->GetTimerInfo(), start_ns, end_ns);
+  }
+  return partial_stats;
+}
+
 SchedulingStats::SchedulingStats(
     const std::vector<const orbit_client_data::TextBox*>& scheduling_scopes,
-    const ThreadNameProvider& thread_name_provider, uint64_t start_ns, uint64_t end_ns) {
+    const ThreadNameProvider& thread_name_provider, uint64_t start_ns, uint64_t end_ns)
+    : SchedulingStats(std::vector<PartialStats>{AggregateScopes(scheduling_scopes, start_ns,
+                                                                end_ns)},
+                      thread_name_provider, start_ns, end_ns) {}
+
+SchedulingStats::SchedulingStats(const std::vector<PartialStats>& partial_stats,
+                                 const ThreadNameProvider& thread_name_provider, uint64_t start_ns,
+                                 uint64_t end_ns) {
   time_range_ms_ = static_cast<double>(end_ns - start_ns) * kNsToMs;
 
-  // Iterate on every scope in the selected range to compute stats.
-  for (const orbit_client_data::TextBox* scope : scheduling_scopes) {
-    const orbit_client_protos::TimerInfo& timer_info = scope->GetTimerInfo();
-    uint64_t clipped_start_ns = std::max(start_ns, timer_info.start());
-    uint64_t clipped_end_ns = std::min(end_ns, timer_info.end());
-    uint64_t timer_duration_ns = clipped_end_ns - clipped_start_ns;
-
-    time_on_core_ns_ += timer_duration_ns;
-    time_on_core_ns_by_core_[timer_info.processor()] += timer_duration_ns;
+  // Combine the stats of every subset of the selection.
+  for (const PartialStats& stats : partial_stats) {
+    for (const auto& [core, timer_duration_ns] : stats.time_on_core_ns_by_core) {
+      time_on_core_ns_ += timer_duration_ns;
+      time_on_core_ns_by_core_[core] += timer_duration_ns;
+    }
 
-    ProcessStats& process_stats = process_stats_by_pid_[timer_info.process_id()];
-    process_stats.time_on_core_ns += timer_duration_ns;
+    for (const auto& [pid_tid, timer_duration_ns] : stats.time_on_core_ns_by_thread) {
+      const auto& [pid, tid] = pid_tid;
+      ProcessStats& process_stats = process_stats_by_pid_[pid];
+      process_stats.time_on_core_ns += timer_duration_ns;
 
-    ThreadStats& thread_stats = process_stats.thread_stats_by_tid[timer_info.thread_id()];
-    thread_stats.time_on_core_ns += timer_duration_ns;
+      ThreadStats& thread_stats = process_stats.thread_stats_by_tid[tid];
+      thread_stats.time_on_core_ns += timer_duration_ns;
+    }
   }
 
   // Iterate on every process and thread to finalize stats.
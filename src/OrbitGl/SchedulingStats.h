@@ -5,11 +5,16 @@
 #ifndef ORBIT_GL_SCHEDULING_STATS_H_
 #define ORBIT_GL_SCHEDULING_STATS_H_
 
+#include <absl/container/flat_hash_map.h>
+
+#include <atomic>
 #include <functional>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "ClientData/SchedulingSlicesPerCore.h"
 #include "ClientData/TextBox.h"
 
 class CaptureData;
@@ -24,10 +29,33 @@ class SchedulingStats {
  public:
   using ThreadNameProvider = std::function<std::string(int32_t)>;
 
+  // Time on core of the scheduling scopes of a subset of the selection, typically of a single core.
+  // Partial stats of disjoint subsets can be computed concurrently and combined by the constructor.
+  struct PartialStats {
+    void Add(const orbit_client_protos::TimerInfo& timer_info, uint64_t start_ns, uint64_t end_ns);
+    void Add(const orbit_client_data::SchedulingSliceInfo& slice, uint64_t start_ns,
+             uint64_t end_ns);
+
+    std::map<int32_t, uint64_t> time_on_core_ns_by_core;
+    // Keyed by (pid, tid).
+    absl::flat_hash_map<std::pair<int32_t, int32_t>, uint64_t> time_on_core_ns_by_thread;
+  };
+
+  // Aggregates the scheduling slices of `core` overlapping [start_ns, end_ns]. Returns early with
+  // incomplete stats once `cancelled` is set, it is checked once every kSlicesPerCancellationCheck
+  // slices.
+  [[nodiscard]] static PartialStats AggregateCore(
+      const orbit_client_data::SchedulingSlicesPerCore& scheduling_slices, int32_t core,
+      uint64_t start_ns, uint64_t end_ns, const std::atomic<bool>& cancelled);
+  static constexpr uint64_t kSlicesPerCancellationCheck = 1024;
+
   SchedulingStats() = delete;
   SchedulingStats(const std::vector<const orbit_client_data::TextBox*>& scheduling_scopes,
                   const ThreadNameProvider& thread_name_provider, uint64_t start_ns,
                   uint64_t end_ns);
+  SchedulingStats(const std::vector<PartialStats>& partial_stats,
+                  const ThreadNameProvider& thread_name_provider, uint64_t start_ns,
+                  uint64_t end_ns);
 
   [[nodiscard]] std::string ToString() const;
 
@@ -5,6 +5,7 @@
 #ifndef ORBIT_GL_SCOPE_TREE_H_
 #define ORBIT_GL_SCOPE_TREE_H_
 
+#include <iterator>
 #include <memory>
 #include <set>
 #include <vector>
@@ -35,6 +36,7 @@ class ScopeNode {
   }
 
   [[nodiscard]] ScopeNode* GetLastChildBeforeOrAtTime(uint64_t time) const;
+  [[nodiscard]] ScopeNode* GetFirstChild() const;
   [[nodiscard]] std::vector<ScopeNode*> GetChildrenInRange(uint64_t start, uint64_t end) const;
   [[nodiscard]] const absl::btree_map<uint64_t, ScopeNode*>& GetChildrenByStartTime() const {
     return *children_by_start_time_;
@@ -47,7 +49,9 @@ class ScopeNode {
   [[nodiscard]] size_t CountNodesInSubtree() const;
   [[nodiscard]] std::set<const ScopeNode*> GetAllNodesInSubtree() const;
   void SetDepth(uint32_t depth) { depth_ = depth; }
-  ScopeT* GetScope() { return scope_; }
+  // Returns nullptr for the root of the tree.
+  [[nodiscard]] ScopeNode* GetParent() const { return parent_; }
+  ScopeT* GetScope() const { return scope_; }
 
  private:
   [[nodiscard]] ScopeNode* FindDeepestParentForNode(const ScopeNode* node);
@@ -58,6 +62,7 @@ class ScopeNode {
 
  private:
   ScopeT* scope_ = nullptr;
+  ScopeNode* parent_ = nullptr;
   uint32_t depth_ = 0;
 
   // We use std::unique_ptr to work around an issue with absl::btree_map which complains about not
@@ -86,6 +91,24 @@ class ScopeTree {
     return ordered_nodes_by_depth_;
   }
 
+  // Lookups in the ordered nodes by depth, O(log n) per depth. They return nullptr if there is no
+  // such node. Neighbors are the nodes right before and after `node` at the same depth, whether they
+  // have the same parent or not, which is what keyboard navigation in a track expects.
+  [[nodiscard]] const ScopeNodeT* FindNode(const ScopeT* scope) const;
+  [[nodiscard]] const ScopeNodeT* FindPreviousNodeAtDepth(const ScopeNodeT* node) const;
+  [[nodiscard]] const ScopeNodeT* FindNextNodeAtDepth(const ScopeNodeT* node) const;
+
+  // Return the node satisfying `predicate` whose scope ends last before `time`, respectively first
+  // after `time`, or nullptr if there is none. Each depth is searched from `time` outwards and only
+  // until no later (earlier) node can end closer to `time`. This assumes that the nodes at a depth
+  // don't overlap, i.e. that the scopes nest properly, as calls on a thread do.
+  template <typename Predicate>
+  [[nodiscard]] const ScopeNodeT* FindLastNodeEndingBefore(uint64_t time,
+                                                           Predicate&& predicate) const;
+  template <typename Predicate>
+  [[nodiscard]] const ScopeNodeT* FindFirstNodeEndingAfter(uint64_t time,
+                                                           Predicate&& predicate) const;
+
  private:
   [[nodiscard]] ScopeNodeT* CreateNode(ScopeT* scope);
   void UpdateDepthInSubtree(ScopeNodeT* node, uint32_t depth);
@@ -137,6 +160,87 @@ void ScopeTree<ScopeT>::UpdateDepthInSubtree(ScopeNodeT* node, uint32_t new_dept
   ordered_nodes_by_depth_[new_depth].insert({node_timestamp, node});
 }
 
+template <typename ScopeT>
+const ScopeNode<ScopeT>* ScopeTree<ScopeT>::FindNode(const ScopeT* scope) const {
+  // The root is the only node at depth 0.
+  for (auto it = ordered_nodes_by_depth_.upper_bound(0); it != ordered_nodes_by_depth_.end();
+       ++it) {
+    const absl::btree_map<uint64_t, ScopeNodeT*>& nodes_at_depth = it->second;
+    auto node_it = nodes_at_depth.find(scope->Start());
+    if (node_it != nodes_at_depth.end() && node_it->second->GetScope() == scope) {
+      return node_it->second;
+    }
+  }
+  return nullptr;
+}
+
+template <typename ScopeT>
+const ScopeNode<ScopeT>* ScopeTree<ScopeT>::FindPreviousNodeAtDepth(const ScopeNodeT* node) const {
+  auto depth_it = ordered_nodes_by_depth_.find(node->Depth());
+  if (depth_it == ordered_nodes_by_depth_.end()) return nullptr;
+  const absl::btree_map<uint64_t, ScopeNodeT*>& nodes_at_depth = depth_it->second;
+  auto node_it = nodes_at_depth.lower_bound(node->Start());
+  if (node_it == nodes_at_depth.begin()) return nullptr;
+  return (--node_it)->second;
+}
+
+template <typename ScopeT>
+const ScopeNode<ScopeT>* ScopeTree<ScopeT>::FindNextNodeAtDepth(const ScopeNodeT* node) const {
+  auto depth_it = ordered_nodes_by_depth_.find(node->Depth());
+  if (depth_it == ordered_nodes_by_depth_.end()) return nullptr;
+  const absl::btree_map<uint64_t, ScopeNodeT*>& nodes_at_depth = depth_it->second;
+  auto node_it = nodes_at_depth.upper_bound(node->Start());
+  if (node_it == nodes_at_depth.end()) return nullptr;
+  return node_it->second;
+}
+
+template <typename ScopeT>
+template <typename Predicate>
+const ScopeNode<ScopeT>* ScopeTree<ScopeT>::FindLastNodeEndingBefore(uint64_t time,
+                                                                     Predicate&& predicate) const {
+  const ScopeNodeT* result = nullptr;
+  for (auto depth_it = ordered_nodes_by_depth_.upper_bound(0);
+       depth_it != ordered_nodes_by_depth_.end(); ++depth_it) {
+    const absl::btree_map<uint64_t, ScopeNodeT*>& nodes_at_depth = depth_it->second;
+    // Nodes starting at or after `time` can't end before it. Going backwards, the nodes end earlier
+    // and earlier, so the first match is the last one at this depth.
+    for (auto node_it = std::make_reverse_iterator(nodes_at_depth.lower_bound(time));
+         node_it != nodes_at_depth.rend(); ++node_it) {
+      const ScopeNodeT* node = node_it->second;
+      if (result != nullptr && node->End() <= result->End()) break;
+      if (node->End() < time && predicate(node)) {
+        result = node;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+template <typename ScopeT>
+template <typename Predicate>
+const ScopeNode<ScopeT>* ScopeTree<ScopeT>::FindFirstNodeEndingAfter(uint64_t time,
+                                                                     Predicate&& predicate) const {
+  const ScopeNodeT* result = nullptr;
+  for (auto depth_it = ordered_nodes_by_depth_.upper_bound(0);
+       depth_it != ordered_nodes_by_depth_.end(); ++depth_it) {
+    const absl::btree_map<uint64_t, ScopeNodeT*>& nodes_at_depth = depth_it->second;
+    // The node right before `time` might still end after it.
+    auto node_it = nodes_at_depth.lower_bound(time);
+    if (node_it != nodes_at_depth.begin()) --node_it;
+    for (; node_it != nodes_at_depth.end(); ++node_it) {
+      const ScopeNodeT* node = node_it->second;
+      // Nodes don't end before they start.
+      if (result != nullptr && node->Start() >= result->End()) break;
+      if (node->End() > time && predicate(node)) {
+        result = node;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
 template <typename ScopeT>
 size_t ScopeTree<ScopeT>::CountOrderedNodesByDepth() const {
   size_t count_from_depth = 0;
@@ -222,6 +326,12 @@ ScopeNode<ScopeT>* ScopeNode<ScopeT>::GetLastChildBeforeOrAtTime(uint64_t time)
   return (--next_node_it)->second;
 }
 
+template <typename ScopeT>
+ScopeNode<ScopeT>* ScopeNode<ScopeT>::GetFirstChild() const {
+  if (children_by_start_time_->empty()) return nullptr;
+  return children_by_start_time_->begin()->second;
+}
+
 template <typename ScopeT>
 ScopeNode<ScopeT>* ScopeNode<ScopeT>::FindDeepestParentForNode(const ScopeNode* node) {
   // Find the deepest node in our hierarchy that encloses the passed in node's scope.
@@ -266,10 +376,12 @@ void ScopeNode<ScopeT>::Insert(ScopeNode<ScopeT>* node) {
   for (ScopeNode* encompassed_node : parent_node->GetChildrenInRange(node->Start(), node->End())) {
     parent_node->children_by_start_time_->erase(encompassed_node->Start());
     node->children_by_start_time_->emplace(encompassed_node->Start(), encompassed_node);
+    encompassed_node->parent_ = node;
   }
 
   // Add new node as child of parent_node.
   parent_node->children_by_start_time_->emplace(node->Start(), node);
+  node->parent_ = parent_node;
 }
 
 #endif  // ORBIT_GL_SCOPE_TREE_H_
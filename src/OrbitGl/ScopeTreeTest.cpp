@@ -181,4 +181,82 @@ TEST(ScopeTree, OutOfOrderScopes) {
   }
 }
 
+TEST(ScopeTree, FindNodeAndNeighbors) {
+  ScopeTree<TestScope> tree;
+  TestScope* outer = CreateScope(0, 100);
+  TestScope* first_child = CreateScope(10, 20);
+  TestScope* second_child = CreateScope(30, 60);
+  TestScope* grand_child = CreateScope(40, 50);
+  TestScope* other_outer = CreateScope(200, 300);
+  TestScope* other_child = CreateScope(210, 220);
+  // Insert out of order, so that nodes get migrated to their final parent.
+  for (TestScope* scope :
+       {grand_child, other_child, first_child, second_child, other_outer, outer}) {
+    tree.Insert(scope);
+  }
+  ValidateTree(tree);
+
+  const auto* outer_node = tree.FindNode(outer);
+  const auto* first_child_node = tree.FindNode(first_child);
+  const auto* second_child_node = tree.FindNode(second_child);
+  const auto* grand_child_node = tree.FindNode(grand_child);
+  const auto* other_child_node = tree.FindNode(other_child);
+  ASSERT_NE(outer_node, nullptr);
+  ASSERT_NE(first_child_node, nullptr);
+  ASSERT_NE(second_child_node, nullptr);
+  ASSERT_NE(grand_child_node, nullptr);
+  ASSERT_NE(other_child_node, nullptr);
+  EXPECT_EQ(outer_node->GetScope(), outer);
+  EXPECT_EQ(grand_child_node->Depth(), 3);
+
+  // A scope with the same timestamps as a scope in the tree is not found.
+  TestScope same_as_outer = *outer;
+  EXPECT_EQ(tree.FindNode(&same_as_outer), nullptr);
+
+  EXPECT_EQ(outer_node->GetParent(), tree.Root());
+  EXPECT_EQ(grand_child_node->GetParent(), second_child_node);
+  EXPECT_EQ(second_child_node->GetParent(), outer_node);
+  EXPECT_EQ(outer_node->GetFirstChild(), first_child_node);
+  EXPECT_EQ(grand_child_node->GetFirstChild(), nullptr);
+
+  EXPECT_EQ(tree.FindPreviousNodeAtDepth(first_child_node), nullptr);
+  EXPECT_EQ(tree.FindNextNodeAtDepth(first_child_node), second_child_node);
+  // Neighbors at the same depth don't need to have the same parent.
+  EXPECT_EQ(tree.FindNextNodeAtDepth(second_child_node), other_child_node);
+  EXPECT_EQ(tree.FindPreviousNodeAtDepth(other_child_node), second_child_node);
+  EXPECT_EQ(tree.FindNextNodeAtDepth(other_child_node), nullptr);
+  EXPECT_EQ(tree.FindNextNodeAtDepth(outer_node)->GetScope(), other_outer);
+}
+
+TEST(ScopeTree, FindNodesEndingBeforeAndAfter) {
+  ScopeTree<TestScope> tree;
+  TestScope* outer = CreateScope(0, 100);
+  TestScope* first_child = CreateScope(10, 20);
+  TestScope* second_child = CreateScope(30, 60);
+  TestScope* grand_child = CreateScope(40, 50);
+  TestScope* other_outer = CreateScope(200, 300);
+  for (TestScope* scope : {outer, first_child, second_child, grand_child, other_outer}) {
+    tree.Insert(scope);
+  }
+  auto any_node = [](const ScopeTree<TestScope>::ScopeNodeT* /*node*/) { return true; };
+  auto is_outer = [](const ScopeTree<TestScope>::ScopeNodeT* node) { return node->Depth() == 1; };
+
+  auto scope_of = [](const ScopeTree<TestScope>::ScopeNodeT* node) {
+    return node != nullptr ? node->GetScope() : nullptr;
+  };
+  EXPECT_EQ(scope_of(tree.FindFirstNodeEndingAfter(0, any_node)), first_child);
+  EXPECT_EQ(scope_of(tree.FindFirstNodeEndingAfter(45, any_node)), grand_child);
+  EXPECT_EQ(scope_of(tree.FindFirstNodeEndingAfter(50, any_node)), second_child);
+  EXPECT_EQ(scope_of(tree.FindFirstNodeEndingAfter(45, is_outer)), outer);
+  EXPECT_EQ(scope_of(tree.FindFirstNodeEndingAfter(100, any_node)), other_outer);
+  EXPECT_EQ(tree.FindFirstNodeEndingAfter(300, any_node), nullptr);
+
+  EXPECT_EQ(tree.FindLastNodeEndingBefore(20, any_node), nullptr);
+  EXPECT_EQ(scope_of(tree.FindLastNodeEndingBefore(55, any_node)), grand_child);
+  EXPECT_EQ(scope_of(tree.FindLastNodeEndingBefore(61, any_node)), second_child);
+  EXPECT_EQ(scope_of(tree.FindLastNodeEndingBefore(250, any_node)), outer);
+  EXPECT_EQ(tree.FindLastNodeEndingBefore(99, is_outer), nullptr);
+  EXPECT_EQ(scope_of(tree.FindLastNodeEndingBefore(301, is_outer)), other_outer);
+}
+
 }  // namespace
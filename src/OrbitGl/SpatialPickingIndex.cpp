@@ -0,0 +1,188 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "SpatialPickingIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include "OrbitBase/Logging.h"
+
+namespace orbit_gl {
+
+namespace {
+
+[[nodiscard]] float EdgeFunction(const Vec3& a, const Vec3& b, const Vec2& p) {
+  return (b[0] - a[0]) * (p[1] - a[1]) - (b[1] - a[1]) * (p[0] - a[0]);
+}
+
+[[nodiscard]] bool TriangleContains(const Triangle& triangle, const Vec2& pos) {
+  const float e0 = EdgeFunction(triangle.vertices[0], triangle.vertices[1], pos);
+  const float e1 = EdgeFunction(triangle.vertices[1], triangle.vertices[2], pos);
+  const float e2 = EdgeFunction(triangle.vertices[2], triangle.vertices[0], pos);
+  // Accept both windings, as the batcher does not enforce one.
+  return (e0 >= 0 && e1 >= 0 && e2 >= 0) || (e0 <= 0 && e1 <= 0 && e2 <= 0);
+}
+
+[[nodiscard]] bool DiagonalLineContains(const Line& line, const Vec2& pos) {
+  // Lines are rasterized one pixel wide, so we accept positions within one pixel of the segment.
+  // The segment is shifted by half a pixel to the right to match the pixel centers used for
+  // axis-aligned lines.
+  const float x0 = line.start_point[0] + 0.5f;
+  const float y0 = line.start_point[1];
+  const float dx = line.end_point[0] - line.start_point[0];
+  const float dy = line.end_point[1] - line.start_point[1];
+  const float length_squared = dx * dx + dy * dy;
+  float t = ((pos[0] - x0) * dx + (pos[1] - y0) * dy) / length_squared;
+  t = std::clamp(t, 0.f, 1.f);
+  const float distance_x = x0 + t * dx - pos[0];
+  const float distance_y = y0 + t * dy - pos[1];
+  return distance_x * distance_x + distance_y * distance_y <= 1.f;
+}
+
+}  // namespace
+
+void SpatialPickingIndex::AddBox(const Box& box, PickingId id, bool is_decoration) {
+  // Sizes of boxes can be negative, so vertices 0 and 2 are not necessarily the minimum and
+  // maximum.
+  const Vec3& corner_0 = box.vertices[0];
+  const Vec3& corner_2 = box.vertices[2];
+  AddEntry(std::min(corner_0[0], corner_2[0]), std::max(corner_0[0], corner_2[0]),
+           std::min(corner_0[1], corner_2[1]), std::max(corner_0[1], corner_2[1]), PickingType::kBox,
+           0, id, is_decoration);
+}
+
+void SpatialPickingIndex::AddLine(const Line& line, PickingId id, bool is_decoration) {
+  // The batcher places lines at pixel centers vertically (y + 0.5) and at pixel borders
+  // horizontally, so a line covers one pixel to the right of its x coordinate and half a pixel
+  // above and below its y coordinate.
+  const float min_x = std::min(line.start_point[0], line.end_point[0]);
+  const float max_x = std::max(line.start_point[0], line.end_point[0]) + 1.f;
+  const float min_y = std::min(line.start_point[1], line.end_point[1]) - 0.5f;
+  const float max_y = std::max(line.start_point[1], line.end_point[1]) + 0.5f;
+  AddEntry(min_x, max_x, min_y, max_y, PickingType::kLine, static_cast<uint32_t>(lines_.size()), id,
+           is_decoration);
+  lines_.push_back(line);
+}
+
+void SpatialPickingIndex::AddTriangle(const Triangle& triangle, PickingId id, bool is_decoration) {
+  float min_x = std::numeric_limits<float>::max();
+  float max_x = std::numeric_limits<float>::lowest();
+  float min_y = std::numeric_limits<float>::max();
+  float max_y = std::numeric_limits<float>::lowest();
+  for (const Vec3& vertex : triangle.vertices) {
+    min_x = std::min(min_x, vertex[0]);
+    max_x = std::max(max_x, vertex[0]);
+    min_y = std::min(min_y, vertex[1]);
+    max_y = std::max(max_y, vertex[1]);
+  }
+  AddEntry(min_x, max_x, min_y, max_y, PickingType::kTriangle,
+           static_cast<uint32_t>(triangles_.size()), id, is_decoration);
+  triangles_.push_back(triangle);
+}
+
+void SpatialPickingIndex::AddEntry(float min_x, float max_x, float min_y, float max_y,
+                                   PickingType type, uint32_t shape_index, PickingId id,
+                                   bool is_decoration) {
+  CHECK(!is_built_);
+  Entry entry{};
+  entry.min_x = min_x;
+  entry.max_x = max_x;
+  entry.min_y = min_y;
+  entry.max_y = max_y;
+  entry.order = static_cast<uint32_t>(entries_.size());
+  entry.shape_index = shape_index;
+  entry.type = type;
+  entry.is_decoration = is_decoration;
+  entry.id = id;
+  entries_.push_back(entry);
+}
+
+void SpatialPickingIndex::Build() {
+  CHECK(!is_built_);
+  std::sort(entries_.begin(), entries_.end(), [](const Entry& lhs, const Entry& rhs) {
+    return std::tie(lhs.min_y, lhs.max_y, lhs.min_x) < std::tie(rhs.min_y, rhs.max_y, rhs.min_x);
+  });
+
+  running_max_x_.resize(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const Entry& entry = entries_[i];
+    if (rows_.empty() || rows_.back().min_y != entry.min_y || rows_.back().max_y != entry.max_y) {
+      rows_.push_back(Row{entry.min_y, entry.max_y, i, i});
+      max_row_height_ = std::max(max_row_height_, entry.max_y - entry.min_y);
+      running_max_x_[i] = entry.max_x;
+    } else {
+      running_max_x_[i] = std::max(running_max_x_[i - 1], entry.max_x);
+    }
+    rows_.back().end = i + 1;
+  }
+
+  is_built_ = true;
+}
+
+bool SpatialPickingIndex::ShapeContains(const Entry& entry, const Vec2& pos) const {
+  switch (entry.type) {
+    case PickingType::kTriangle:
+      return TriangleContains(triangles_[entry.shape_index], pos);
+    case PickingType::kLine: {
+      const Line& line = lines_[entry.shape_index];
+      const bool is_axis_aligned = line.start_point[0] == line.end_point[0] ||
+                                   line.start_point[1] == line.end_point[1];
+      return is_axis_aligned || DiagonalLineContains(line, pos);
+    }
+    default:
+      return true;
+  }
+}
+
+std::optional<PickingId> SpatialPickingIndex::Find(const Vec2& pos, bool decorations_occlude) const {
+  CHECK(is_built_);
+  const float x = pos[0];
+  const float y = pos[1];
+
+  // Only rows starting in [y - max_row_height_, y] can cover y.
+  auto rows_begin = std::lower_bound(
+      rows_.begin(), rows_.end(), y - max_row_height_,
+      [](const Row& row, float min_y) { return row.min_y < min_y; });
+  auto rows_end = std::upper_bound(rows_.begin(), rows_.end(), y,
+                                   [](float y, const Row& row) { return y < row.min_y; });
+
+  const Entry* top_most = nullptr;
+  for (auto row = rows_begin; row != rows_end; ++row) {
+    if (row->max_y < y) continue;
+
+    // First entry in this row that starts to the right of x. All entries before it start at or
+    // left of x, and we walk those backwards until none of them can reach x anymore.
+    auto entries_begin = entries_.begin() + row->begin;
+    auto first_right_of_x =
+        std::upper_bound(entries_begin, entries_.begin() + row->end, x,
+                         [](float x, const Entry& entry) { return x < entry.min_x; });
+    for (size_t i = first_right_of_x - entries_.begin(); i > row->begin; --i) {
+      if (running_max_x_[i - 1] < x) break;
+      const Entry& entry = entries_[i - 1];
+      if (entry.max_x < x) continue;
+      if (top_most != nullptr && entry.order < top_most->order) continue;
+      if (entry.is_decoration && !decorations_occlude) continue;
+      if (!ShapeContains(entry, pos)) continue;
+      top_most = &entry;
+    }
+  }
+
+  if (top_most == nullptr) return std::nullopt;
+  return top_most->id;
+}
+
+void SpatialPickingIndex::Clear() {
+  entries_.clear();
+  running_max_x_.clear();
+  rows_.clear();
+  max_row_height_ = 0.f;
+  is_built_ = false;
+  lines_.clear();
+  triangles_.clear();
+}
+
+}  // namespace orbit_gl
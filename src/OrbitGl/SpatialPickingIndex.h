@@ -0,0 +1,93 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_GL_SPATIAL_PICKING_INDEX_H_
+#define ORBIT_GL_SPATIAL_PICKING_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <optional>
+#include <vector>
+
+#include "CoreMath.h"
+#include "Geometry.h"
+#include "PickingManager.h"
+
+namespace orbit_gl {
+
+// CPU-side lookup structure that answers "which primitive is drawn on top at this position"
+// without rendering the primitives with picking colors and reading the result back from the GPU.
+//
+// Primitives are grouped into rows of equal vertical extent. For timer tracks, a row corresponds
+// to one depth of one track. Inside a row, primitives are sorted by their horizontal start, i.e.
+// by time, so a lookup consists of a binary search over the rows followed by a binary search
+// inside each row that covers the position.
+//
+// Primitives have to be added in the order in which they are drawn. Among all primitives that
+// cover a position, the one added last is the one that is visible.
+//
+// "Decorations" are primitives that carry neither user data nor a Pickable. They can be configured
+// to either hide primitives below them or to be transparent for picking (see Find()).
+class SpatialPickingIndex {
+ public:
+  void AddBox(const Box& box, PickingId id, bool is_decoration = false);
+  void AddLine(const Line& line, PickingId id, bool is_decoration = false);
+  void AddTriangle(const Triangle& triangle, PickingId id, bool is_decoration = false);
+
+  // Sorts the primitives added so far into rows. Needs to be called after the last primitive was
+  // added and before the first call to Find().
+  void Build();
+
+  // Returns the id of the top-most primitive covering `pos`, or std::nullopt if there is none.
+  // If `decorations_occlude` is false, decorations are ignored.
+  [[nodiscard]] std::optional<PickingId> Find(const Vec2& pos, bool decorations_occlude) const;
+
+  [[nodiscard]] size_t GetNumPrimitives() const { return entries_.size(); }
+  [[nodiscard]] size_t GetNumRows() const { return rows_.size(); }
+
+  void Clear();
+
+ private:
+  struct Entry {
+    float min_x;
+    float max_x;
+    float min_y;
+    float max_y;
+    // Position in drawing order, higher values are drawn on top.
+    uint32_t order;
+    // Index into lines_ or triangles_, depending on `type`. Unused for boxes.
+    uint32_t shape_index;
+    PickingType type;
+    bool is_decoration;
+    PickingId id;
+  };
+
+  struct Row {
+    float min_y;
+    float max_y;
+    size_t begin;
+    size_t end;
+  };
+
+  void AddEntry(float min_x, float max_x, float min_y, float max_y, PickingType type,
+                uint32_t shape_index, PickingId id, bool is_decoration);
+  [[nodiscard]] bool ShapeContains(const Entry& entry, const Vec2& pos) const;
+
+  std::vector<Entry> entries_;
+  // For each entry, the maximum of max_x over all entries of the same row up to and including this
+  // one. As entries inside a row are sorted by min_x, this allows to stop searching to the left as
+  // soon as no earlier entry can reach `pos` anymore.
+  std::vector<float> running_max_x_;
+  std::vector<Row> rows_;
+  float max_row_height_ = 0.f;
+  bool is_built_ = false;
+
+  std::vector<Line> lines_;
+  std::vector<Triangle> triangles_;
+};
+
+}  // namespace orbit_gl
+
+#endif  // ORBIT_GL_SPATIAL_PICKING_INDEX_H_
@@ -0,0 +1,153 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <optional>
+
+#include "CoreMath.h"
+#include "Geometry.h"
+#include "PickingManager.h"
+#include "SpatialPickingIndex.h"
+
+namespace orbit_gl {
+
+namespace {
+
+PickingId BoxId(uint32_t element_id) { return PickingId::Create(PickingType::kBox, element_id); }
+
+void ExpectPicked(const SpatialPickingIndex& index, Vec2 pos, std::optional<uint32_t> element_id,
+                  bool decorations_occlude = false) {
+  std::optional<PickingId> id = index.Find(pos, decorations_occlude);
+  ASSERT_EQ(id.has_value(), element_id.has_value());
+  if (element_id.has_value()) {
+    EXPECT_EQ(id->element_id, element_id.value());
+  }
+}
+
+}  // namespace
+
+TEST(SpatialPickingIndex, EmptyIndexFindsNothing) {
+  SpatialPickingIndex index;
+  index.Build();
+  ExpectPicked(index, Vec2(0, 0), std::nullopt);
+}
+
+TEST(SpatialPickingIndex, FindsBoxesInRows) {
+  SpatialPickingIndex index;
+  // Two rows (depths) with two boxes each, added out of order.
+  index.AddBox(Box(Vec2(20, 0), Vec2(10, 10), 0), BoxId(1));
+  index.AddBox(Box(Vec2(0, 0), Vec2(10, 10), 0), BoxId(0));
+  index.AddBox(Box(Vec2(0, -10), Vec2(15, 10), 0), BoxId(2));
+  index.AddBox(Box(Vec2(15, -10), Vec2(15, 10), 0), BoxId(3));
+  index.Build();
+
+  EXPECT_EQ(index.GetNumPrimitives(), 4);
+  EXPECT_EQ(index.GetNumRows(), 2);
+
+  ExpectPicked(index, Vec2(5.5f, 5.5f), 0);
+  ExpectPicked(index, Vec2(25.5f, 5.5f), 1);
+  ExpectPicked(index, Vec2(15.5f, 5.5f), std::nullopt);
+  ExpectPicked(index, Vec2(5.5f, -5.5f), 2);
+  ExpectPicked(index, Vec2(20.5f, -5.5f), 3);
+  ExpectPicked(index, Vec2(5.5f, 15.5f), std::nullopt);
+  ExpectPicked(index, Vec2(35.5f, -5.5f), std::nullopt);
+}
+
+TEST(SpatialPickingIndex, LastAddedPrimitiveIsOnTop) {
+  SpatialPickingIndex index;
+  index.AddBox(Box(Vec2(0, 0), Vec2(100, 10), 0), BoxId(0));
+  index.AddBox(Box(Vec2(10, 0), Vec2(10, 10), 0), BoxId(1));
+  // A box spanning more rows, added last.
+  index.AddBox(Box(Vec2(50, -20), Vec2(10, 40), 0), BoxId(2));
+  index.Build();
+
+  ExpectPicked(index, Vec2(5.5f, 5.5f), 0);
+  ExpectPicked(index, Vec2(15.5f, 5.5f), 1);
+  ExpectPicked(index, Vec2(55.5f, 5.5f), 2);
+  ExpectPicked(index, Vec2(95.5f, 5.5f), 0);
+  ExpectPicked(index, Vec2(55.5f, -15.5f), 2);
+}
+
+TEST(SpatialPickingIndex, LongBoxIsFoundBehindManyShortOnes) {
+  SpatialPickingIndex index;
+  index.AddBox(Box(Vec2(0, 0), Vec2(1000, 10), 0), BoxId(0));
+  for (uint32_t i = 1; i < 100; ++i) {
+    index.AddBox(Box(Vec2(static_cast<float>(i) * 2.f, 0), Vec2(1, 10), 0), BoxId(i));
+  }
+  index.Build();
+
+  ExpectPicked(index, Vec2(2.5f, 5.5f), 1);
+  ExpectPicked(index, Vec2(3.5f, 5.5f), 0);
+  ExpectPicked(index, Vec2(500.5f, 5.5f), 0);
+}
+
+TEST(SpatialPickingIndex, NegativeSizes) {
+  SpatialPickingIndex index;
+  index.AddBox(Box(Vec2(10, 0), Vec2(-10, -10), 0), BoxId(0));
+  index.Build();
+
+  ExpectPicked(index, Vec2(5.5f, -5.5f), 0);
+  ExpectPicked(index, Vec2(5.5f, 5.5f), std::nullopt);
+}
+
+TEST(SpatialPickingIndex, Lines) {
+  SpatialPickingIndex index;
+  // Lines as placed by the batcher: x at pixel borders, y at pixel centers.
+  index.AddLine(Line{Vec3(10, 0.5f, 0), Vec3(10, 10.5f, 0)},
+                PickingId::Create(PickingType::kLine, 0));
+  index.AddLine(Line{Vec3(0, 20.5f, 0), Vec3(30, 20.5f, 0)},
+                PickingId::Create(PickingType::kLine, 1));
+  index.AddLine(Line{Vec3(0, 30.5f, 0), Vec3(10, 40.5f, 0)},
+                PickingId::Create(PickingType::kLine, 2));
+  index.Build();
+
+  ExpectPicked(index, Vec2(10.5f, 5.5f), 0);
+  ExpectPicked(index, Vec2(11.5f, 5.5f), std::nullopt);
+  ExpectPicked(index, Vec2(15.5f, 20.5f), 1);
+  ExpectPicked(index, Vec2(15.5f, 21.5f), std::nullopt);
+  ExpectPicked(index, Vec2(5.5f, 35.5f), 2);
+  ExpectPicked(index, Vec2(8.5f, 32.5f), std::nullopt);
+}
+
+TEST(SpatialPickingIndex, Triangles) {
+  SpatialPickingIndex index;
+  index.AddTriangle(Triangle(Vec3(0, 0, 0), Vec3(0, 10, 0), Vec3(10, 0, 0)),
+                    PickingId::Create(PickingType::kTriangle, 0));
+  // Same triangle with opposite winding, shifted.
+  index.AddTriangle(Triangle(Vec3(20, 0, 0), Vec3(30, 0, 0), Vec3(20, 10, 0)),
+                    PickingId::Create(PickingType::kTriangle, 1));
+  index.Build();
+
+  ExpectPicked(index, Vec2(2.5f, 2.5f), 0);
+  ExpectPicked(index, Vec2(8.5f, 8.5f), std::nullopt);
+  ExpectPicked(index, Vec2(22.5f, 2.5f), 1);
+  ExpectPicked(index, Vec2(28.5f, 8.5f), std::nullopt);
+}
+
+TEST(SpatialPickingIndex, Decorations) {
+  SpatialPickingIndex index;
+  index.AddBox(Box(Vec2(0, 0), Vec2(10, 10), 0), BoxId(0));
+  index.AddBox(Box(Vec2(0, 0), Vec2(5, 10), 0), BoxId(1), /*is_decoration=*/true);
+  index.Build();
+
+  ExpectPicked(index, Vec2(2.5f, 5.5f), 0, /*decorations_occlude=*/false);
+  ExpectPicked(index, Vec2(2.5f, 5.5f), 1, /*decorations_occlude=*/true);
+  ExpectPicked(index, Vec2(7.5f, 5.5f), 0, /*decorations_occlude=*/true);
+}
+
+TEST(SpatialPickingIndex, Clear) {
+  SpatialPickingIndex index;
+  index.AddBox(Box(Vec2(0, 0), Vec2(10, 10), 0), BoxId(0));
+  index.Build();
+  ExpectPicked(index, Vec2(5.5f, 5.5f), 0);
+
+  index.Clear();
+  index.AddBox(Box(Vec2(20, 0), Vec2(10, 10), 0), BoxId(1));
+  index.Build();
+  ExpectPicked(index, Vec2(5.5f, 5.5f), std::nullopt);
+  ExpectPicked(index, Vec2(25.5f, 5.5f), 1);
+}
+
+}  // namespace orbit_gl
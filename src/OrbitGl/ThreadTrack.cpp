@@ -84,10 +84,26 @@ void ThreadTrack::InitializeNameAndLabel(int32_t thread_id) {
   }
 }
 
+template <typename GetRelatedNode>
+std::optional<const orbit_client_data::TextBox*> ThreadTrack::FindInScopeTree(
+    const orbit_client_data::TextBox* text_box, GetRelatedNode&& get_related_node) const {
+  absl::MutexLock lock(&scope_tree_mutex_);
+  const ScopeNode<orbit_client_data::TextBox>* node = scope_tree_.FindNode(text_box);
+  if (node == nullptr) return std::nullopt;
+  const ScopeNode<orbit_client_data::TextBox>* related_node = get_related_node(node);
+  if (related_node == nullptr || related_node == scope_tree_.Root()) return nullptr;
+  return related_node->GetScope();
+}
+
 const orbit_client_data::TextBox* ThreadTrack::GetLeft(
     const orbit_client_data::TextBox* text_box) const {
   const TimerInfo& timer_info = text_box->GetTimerInfo();
   if (timer_info.thread_id() == thread_id_) {
+    std::optional<const orbit_client_data::TextBox*> left =
+        FindInScopeTree(text_box, [this](const ScopeNode<orbit_client_data::TextBox>* node) {
+          return scope_tree_.FindPreviousNodeAtDepth(node);
+        });
+    if (left.has_value()) return left.value();
     std::shared_ptr<orbit_client_data::TimerChain> timers = GetTimers(timer_info.depth());
     if (timers) return timers->GetElementBefore(text_box);
   }
@@ -98,12 +114,58 @@ const orbit_client_data::TextBox* ThreadTrack::GetRight(
     const orbit_client_data::TextBox* text_box) const {
   const TimerInfo& timer_info = text_box->GetTimerInfo();
   if (timer_info.thread_id() == thread_id_) {
+    std::optional<const orbit_client_data::TextBox*> right =
+        FindInScopeTree(text_box, [this](const ScopeNode<orbit_client_data::TextBox>* node) {
+          return scope_tree_.FindNextNodeAtDepth(node);
+        });
+    if (right.has_value()) return right.value();
     std::shared_ptr<orbit_client_data::TimerChain> timers = GetTimers(timer_info.depth());
     if (timers) return timers->GetElementAfter(text_box);
   }
   return nullptr;
 }
 
+const orbit_client_data::TextBox* ThreadTrack::GetUp(
+    const orbit_client_data::TextBox* text_box) const {
+  std::optional<const orbit_client_data::TextBox*> parent = FindInScopeTree(
+      text_box,
+      [](const ScopeNode<orbit_client_data::TextBox>* node) { return node->GetParent(); });
+  if (parent.has_value()) return parent.value();
+  return TimerTrack::GetUp(text_box);
+}
+
+const orbit_client_data::TextBox* ThreadTrack::GetDown(
+    const orbit_client_data::TextBox* text_box) const {
+  std::optional<const orbit_client_data::TextBox*> first_child = FindInScopeTree(
+      text_box,
+      [](const ScopeNode<orbit_client_data::TextBox>* node) { return node->GetFirstChild(); });
+  if (first_child.has_value()) return first_child.value();
+  return TimerTrack::GetDown(text_box);
+}
+
+std::optional<const orbit_client_data::TextBox*> ThreadTrack::FindPreviousFunctionCall(
+    uint64_t function_id, uint64_t time) const {
+  absl::MutexLock lock(&scope_tree_mutex_);
+  // The root of the scope tree doesn't correspond to a timer.
+  if (scope_tree_.Size() - 1 != GetNumTimers()) return std::nullopt;
+  const ScopeNode<orbit_client_data::TextBox>* node = scope_tree_.FindLastNodeEndingBefore(
+      time, [function_id](const ScopeNode<orbit_client_data::TextBox>* node) {
+        return node->GetScope()->GetTimerInfo().function_id() == function_id;
+      });
+  return node != nullptr ? node->GetScope() : nullptr;
+}
+
+std::optional<const orbit_client_data::TextBox*> ThreadTrack::FindNextFunctionCall(
+    uint64_t function_id, uint64_t time) const {
+  absl::MutexLock lock(&scope_tree_mutex_);
+  if (scope_tree_.Size() - 1 != GetNumTimers()) return std::nullopt;
+  const ScopeNode<orbit_client_data::TextBox>* node = scope_tree_.FindFirstNodeEndingAfter(
+      time, [function_id](const ScopeNode<orbit_client_data::TextBox>* node) {
+        return node->GetScope()->GetTimerInfo().function_id() == function_id;
+      });
+  return node != nullptr ? node->GetScope() : nullptr;
+}
+
 std::string ThreadTrack::GetBoxTooltip(const Batcher& batcher, PickingId id) const {
   const orbit_client_data::TextBox* text_box = batcher.GetTextBox(id);
   if (!text_box || text_box->GetTimerInfo().type() == TimerInfo::kCoreActivity) {
@@ -140,7 +202,7 @@ std::string ThreadTrack::GetBoxTooltip(const Batcher& batcher, PickingId id) con
           ? orbit_client_data::function_utils::GetLoadedModuleNameByPath(func->file_path())
           : "unknown";
 
-  return absl::StrFormat(
+  std::string tooltip = absl::StrFormat(
       "<b>%s</b><br/>"
       "<i>Timing measured through %s instrumentation</i>"
       "<br/><br/>"
@@ -149,6 +211,26 @@ std::string ThreadTrack::GetBoxTooltip(const Batcher& batcher, PickingId id) con
       function_name, is_manual ? "manual" : "dynamic", module_name,
       orbit_display_formats::GetDisplayTime(
           TicksToDuration(text_box->GetTimerInfo().start(), text_box->GetTimerInfo().end())));
+
+  if (timer_info.num_coalesced_calls() > 0) {
+    absl::StrAppendFormat(
+        &tooltip,
+        "<br/><br/>"
+        "<i>Consecutive short calls coalesced into one timer</i><br/>"
+        "<b>Calls:</b> %u<br/>"
+        "<b>Total:</b> %s<br/>"
+        "<b>Min:</b> %s<br/>"
+        "<b>Max:</b> %s",
+        timer_info.num_coalesced_calls(),
+        orbit_display_formats::GetDisplayTime(
+            absl::Nanoseconds(timer_info.coalesced_total_duration_ns())),
+        orbit_display_formats::GetDisplayTime(
+            absl::Nanoseconds(timer_info.coalesced_min_duration_ns())),
+        orbit_display_formats::GetDisplayTime(
+            absl::Nanoseconds(timer_info.coalesced_max_duration_ns())));
+  }
+
+  return tooltip;
 }
 
 bool ThreadTrack::IsTimerActive(const TimerInfo& timer_info) const {
@@ -235,6 +317,12 @@ Color ThreadTrack::GetTimerColor(const TimerInfo& timer_info, bool is_selected,
     color[3] = kOddAlpha;
   }
 
+  // Coalesced timers are mostly made of the gaps between the calls, so they are drawn fainter.
+  constexpr uint8_t kCoalescedAlpha = 140;
+  if (timer_info.num_coalesced_calls() > 0) {
+    color[3] = kCoalescedAlpha;
+  }
+
   return color;
 }
 
@@ -280,7 +368,6 @@ void ThreadTrack::Draw(Batcher& batcher, TextRenderer& text_renderer,
   TimerTrack::Draw(batcher, text_renderer, current_mouse_time_ns, picking_mode, z_offset);
 
   UpdateMinMaxTimestamps();
-  UpdatePositionOfSubtracks();
 
   const float thread_state_track_height = layout_->GetThreadStateTrackHeight();
   const float event_track_height = layout_->GetEventTrackHeight();
@@ -334,13 +421,18 @@ void ThreadTrack::SetTrackColor(Color color) {
 void ThreadTrack::SetTimesliceText(const TimerInfo& timer_info, float min_x, float z_offset,
                                    orbit_client_data::TextBox* text_box) {
   if (text_box->GetText().empty()) {
+    // Coalesced calls show the time actually spent in the function, not the span of the box.
+    const bool is_coalesced = timer_info.num_coalesced_calls() > 0;
     std::string time = orbit_display_formats::GetDisplayTime(
-        absl::Nanoseconds(timer_info.end() - timer_info.start()));
+        absl::Nanoseconds(is_coalesced ? timer_info.coalesced_total_duration_ns()
+                                       : timer_info.end() - timer_info.start()));
     text_box->SetElapsedTimeTextLength(time.length());
 
     const InstrumentedFunction* func = app_->GetInstrumentedFunction(timer_info.function_id());
     if (func != nullptr) {
-      std::string extra_info = GetExtraInfo(timer_info);
+      std::string extra_info = is_coalesced ? absl::StrFormat("[%u calls]",
+                                                              timer_info.num_coalesced_calls())
+                                            : GetExtraInfo(timer_info);
       std::string name;
       if (func->function_type() == InstrumentedFunction::kTimerStart) {
         auto api_event = ManualInstrumentationManager::ApiEventFromTimerInfo(timer_info);
@@ -375,7 +467,7 @@ void ThreadTrack::SetTimesliceText(const TimerInfo& timer_info, float min_x, flo
   const auto& box_size = text_box->GetSize();
   float pos_x = std::max(box_pos.first, min_x);
   float max_size = box_pos.first + box_size.first - pos_x;
-  text_renderer_->AddTextTrailingCharsPrioritized(
+  time_graph_->GetTextRendererForUpdate()->AddTextTrailingCharsPrioritized(
       text_box->GetText().c_str(), pos_x, box_pos.second + layout_->GetTextOffset(),
       GlCanvas::kZValueBox + z_offset, kTextWhite, text_box->GetElapsedTimeTextLength(),
       layout_->CalculateZoomedFontSize(), max_size);
@@ -9,6 +9,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "CallstackThreadBar.h"
@@ -36,12 +37,25 @@ class ThreadTrack final : public TimerTrack {
   void InitializeNameAndLabel(int32_t thread_id);
 
   [[nodiscard]] Type GetType() const override { return Type::kThreadTrack; }
+  [[nodiscard]] int32_t GetThreadId() const { return thread_id_; }
   [[nodiscard]] std::string GetTooltip() const override;
 
   [[nodiscard]] const orbit_client_data::TextBox* GetLeft(
       const orbit_client_data::TextBox* textbox) const override;
   [[nodiscard]] const orbit_client_data::TextBox* GetRight(
       const orbit_client_data::TextBox* textbox) const override;
+  [[nodiscard]] const orbit_client_data::TextBox* GetUp(
+      const orbit_client_data::TextBox* textbox) const override;
+  [[nodiscard]] const orbit_client_data::TextBox* GetDown(
+      const orbit_client_data::TextBox* textbox) const override;
+
+  // Return the timer of `function_id` ending last before, respectively first after, `time`, or
+  // nullptr if there is none. Return std::nullopt if not all timers of the track are in the scope
+  // tree (yet), in which case the timer chains need to be searched instead.
+  [[nodiscard]] std::optional<const orbit_client_data::TextBox*> FindPreviousFunctionCall(
+      uint64_t function_id, uint64_t time) const;
+  [[nodiscard]] std::optional<const orbit_client_data::TextBox*> FindNextFunctionCall(
+      uint64_t function_id, uint64_t time) const;
 
   void Draw(Batcher& batcher, TextRenderer& text_renderer, uint64_t current_mouse_time_ns,
             PickingMode picking_mode, float z_offset = 0) override;
@@ -76,16 +90,23 @@ class ThreadTrack final : public TimerTrack {
   [[nodiscard]] float GetHeight() const override;
   [[nodiscard]] float GetHeaderHeight() const override;
 
-  void UpdatePositionOfSubtracks();
+  void UpdatePositionOfSubtracks() override;
   void UpdatePrimitivesOfSubtracks(Batcher* batcher, uint64_t min_tick, uint64_t max_tick,
                                    PickingMode picking_mode, float z_offset);
   void UpdateMinMaxTimestamps();
 
+  // Looks up the node of `text_box` in the scope tree and returns the scope of the node returned by
+  // `get_related_node`, or nullptr if there is none. Returns std::nullopt if `text_box` is not in
+  // the scope tree (yet), e.g. when the tree is only built at the end of the capture.
+  template <typename GetRelatedNode>
+  [[nodiscard]] std::optional<const orbit_client_data::TextBox*> FindInScopeTree(
+      const orbit_client_data::TextBox* text_box, GetRelatedNode&& get_related_node) const;
+
   std::shared_ptr<orbit_gl::ThreadStateBar> thread_state_bar_;
   std::shared_ptr<orbit_gl::CallstackThreadBar> event_bar_;
   std::shared_ptr<orbit_gl::TracepointThreadBar> tracepoint_bar_;
 
-  absl::Mutex scope_tree_mutex_;
+  mutable absl::Mutex scope_tree_mutex_;
   ScopeTree<orbit_client_data::TextBox> scope_tree_;
   ScopeTreeUpdateType scope_tree_update_type_ = ScopeTreeUpdateType::kAlways;
 };
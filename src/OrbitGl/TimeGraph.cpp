@@ -65,12 +65,11 @@ TimeGraph::TimeGraph(AccessibleInterfaceProvider* parent, OrbitApp* app,
     // parent in accessible_parent_ which doesn't need to be a CaptureViewElement.
     : orbit_gl::CaptureViewElement(nullptr, this, viewport, &layout_),
       accessible_parent_{parent},
-      batcher_(BatcherId::kTimeGraph),
+      front_primitives_{std::make_unique<PrimitiveBuffer>(viewport, picking_manager)},
+      back_primitives_{std::make_unique<PrimitiveBuffer>(viewport, picking_manager)},
       manual_instrumentation_manager_{app->GetManualInstrumentationManager()},
       capture_data_{capture_data},
       app_{app} {
-  text_renderer_static_.SetViewport(viewport);
-  batcher_.SetPickingManager(picking_manager);
   track_manager_ = std::make_unique<TrackManager>(this, viewport_, &GetLayout(), app, capture_data);
   track_manager_->GetOrCreateSchedulerTrack();
 
@@ -538,24 +537,37 @@ void TimeGraph::SelectAndMakeVisible(const orbit_client_data::TextBox* text_box)
   VerticallyMoveIntoView(timer_info);
 }
 
+// The thread tracks answer these searches from their scope trees, which index the timers by depth
+// and start time. The timer chains are only scanned for tracks whose scope tree is incomplete.
 const orbit_client_data::TextBox* TimeGraph::FindPreviousFunctionCall(
     uint64_t function_id, uint64_t current_time, std::optional<int32_t> thread_id) const {
   const orbit_client_data::TextBox* previous_box = nullptr;
   uint64_t previous_box_time = std::numeric_limits<uint64_t>::lowest();
-  std::vector<std::shared_ptr<orbit_client_data::TimerChain>> chains =
-      GetAllThreadTrackTimerChains();
-  for (auto& chain : chains) {
-    if (!chain) continue;
-    for (const auto& block : *chain) {
-      if (!block.Intersects(previous_box_time, current_time)) continue;
-      for (uint64_t i = 0; i < block.size(); i++) {
-        const orbit_client_data::TextBox& box = block[i];
-        auto box_time = box.GetTimerInfo().end();
-        if ((box.GetTimerInfo().function_id() == function_id) &&
-            (!thread_id || thread_id.value() == box.GetTimerInfo().thread_id()) &&
-            (box_time < current_time) && (previous_box_time < box_time)) {
-          previous_box = &box;
-          previous_box_time = box_time;
+  auto update_previous_box = [&](const orbit_client_data::TextBox* box) {
+    if (box == nullptr) return;
+    uint64_t box_time = box->GetTimerInfo().end();
+    if (box_time < current_time && previous_box_time < box_time) {
+      previous_box = box;
+      previous_box_time = box_time;
+    }
+  };
+
+  for (const ThreadTrack* track : track_manager_->GetThreadTracks()) {
+    if (thread_id.has_value() && track->GetThreadId() != thread_id.value()) continue;
+    std::optional<const orbit_client_data::TextBox*> box_from_scope_tree =
+        track->FindPreviousFunctionCall(function_id, current_time);
+    if (box_from_scope_tree.has_value()) {
+      update_previous_box(box_from_scope_tree.value());
+      continue;
+    }
+
+    for (const auto& chain : track->GetAllChains()) {
+      if (!chain) continue;
+      for (const auto& block : *chain) {
+        if (!block.Intersects(previous_box_time, current_time)) continue;
+        for (uint64_t i = 0; i < block.size(); i++) {
+          const orbit_client_data::TextBox& box = block[i];
+          if (box.GetTimerInfo().function_id() == function_id) update_previous_box(&box);
         }
       }
     }
@@ -567,20 +579,31 @@ const orbit_client_data::TextBox* TimeGraph::FindNextFunctionCall(
     uint64_t function_id, uint64_t current_time, std::optional<int32_t> thread_id) const {
   const orbit_client_data::TextBox* next_box = nullptr;
   uint64_t next_box_time = std::numeric_limits<uint64_t>::max();
-  std::vector<std::shared_ptr<orbit_client_data::TimerChain>> chains =
-      GetAllThreadTrackTimerChains();
-  for (auto& chain : chains) {
-    if (!chain) continue;
-    for (const auto& block : *chain) {
-      if (!block.Intersects(current_time, next_box_time)) continue;
-      for (uint64_t i = 0; i < block.size(); i++) {
-        const orbit_client_data::TextBox& box = block[i];
-        auto box_time = box.GetTimerInfo().end();
-        if ((box.GetTimerInfo().function_id() == function_id) &&
-            (!thread_id || thread_id.value() == box.GetTimerInfo().thread_id()) &&
-            (box_time > current_time) && (next_box_time > box_time)) {
-          next_box = &box;
-          next_box_time = box_time;
+  auto update_next_box = [&](const orbit_client_data::TextBox* box) {
+    if (box == nullptr) return;
+    uint64_t box_time = box->GetTimerInfo().end();
+    if (box_time > current_time && next_box_time > box_time) {
+      next_box = box;
+      next_box_time = box_time;
+    }
+  };
+
+  for (const ThreadTrack* track : track_manager_->GetThreadTracks()) {
+    if (thread_id.has_value() && track->GetThreadId() != thread_id.value()) continue;
+    std::optional<const orbit_client_data::TextBox*> box_from_scope_tree =
+        track->FindNextFunctionCall(function_id, current_time);
+    if (box_from_scope_tree.has_value()) {
+      update_next_box(box_from_scope_tree.value());
+      continue;
+    }
+
+    for (const auto& chain : track->GetAllChains()) {
+      if (!chain) continue;
+      for (const auto& block : *chain) {
+        if (!block.Intersects(current_time, next_box_time)) continue;
+        for (uint64_t i = 0; i < block.size(); i++) {
+          const orbit_client_data::TextBox& box = block[i];
+          if (box.GetTimerInfo().function_id() == function_id) update_next_box(&box);
         }
       }
     }
@@ -597,10 +620,15 @@ void TimeGraph::RequestUpdate() {
 void TimeGraph::UpdatePrimitives(Batcher* /*batcher*/, uint64_t /*min_tick*/, uint64_t /*max_tick*/,
                                  PickingMode picking_mode, float /*z_offset*/) {
   ORBIT_SCOPE_FUNCTION;
+  StartPrimitiveUpdate(picking_mode);
+  ContinuePrimitiveUpdate(absl::InfiniteFuture());
+}
+
+void TimeGraph::StartPrimitiveUpdate(PickingMode picking_mode) {
   CHECK(app_->GetStringManager() != nullptr);
 
-  batcher_.StartNewFrame();
-  text_renderer_static_.Clear();
+  back_primitives_->batcher.StartNewFrame();
+  back_primitives_->text_renderer.Clear();
 
   capture_min_timestamp_ =
       std::min(capture_min_timestamp_, capture_data_->GetCallstackData()->min_time());
@@ -610,15 +638,52 @@ void TimeGraph::UpdatePrimitives(Batcher* /*batcher*/, uint64_t /*min_tick*/, ui
   time_window_us_ = max_time_us_ - min_time_us_;
   world_start_x_ = viewport_->GetWorldTopLeft()[0];
   world_width_ = viewport_->GetVisibleWorldWidth();
-  uint64_t min_tick = GetTickFromUs(min_time_us_);
-  uint64_t max_tick = GetTickFromUs(max_time_us_);
 
   track_manager_->UpdateTracksForRendering();
-  track_manager_->UpdateTrackPrimitives(&batcher_, min_tick, max_tick, picking_mode);
+
+  // A restarted update still has to show the view of the oldest request within the latency bound.
+  if (!pending_primitive_update_.has_value()) {
+    oldest_pending_update_request_time_ = absl::Now();
+  }
+  PendingPrimitiveUpdate& update = pending_primitive_update_.emplace();
+  update.min_tick = GetTickFromUs(min_time_us_);
+  update.max_tick = GetTickFromUs(max_time_us_);
+  update.picking_mode = picking_mode;
 
   update_primitives_requested_ = false;
 }
 
+void TimeGraph::ContinuePrimitiveUpdate(absl::Time deadline) {
+  ORBIT_SCOPE_FUNCTION;
+  CHECK(pending_primitive_update_.has_value());
+  PendingPrimitiveUpdate& update = pending_primitive_update_.value();
+  update.next_track_index = track_manager_->UpdateTrackPrimitives(
+      &back_primitives_->batcher, update.min_tick, update.max_tick, update.picking_mode,
+      update.next_track_index, deadline);
+  if (update.next_track_index < track_manager_->GetNumVisibleTracks()) return;
+
+  // The tracks move to their new positions together with showing their new primitives.
+  track_manager_->ApplyTrackLayout();
+  std::swap(front_primitives_, back_primitives_);
+  pending_primitive_update_.reset();
+}
+
+void TimeGraph::RecordPrimitiveUpdateDuration(absl::Duration duration) {
+  constexpr size_t kNumFramesPerReport = 100;
+  primitive_update_durations_ms_.push_back(absl::ToDoubleMilliseconds(duration));
+  if (primitive_update_durations_ms_.size() < kNumFramesPerReport) return;
+
+  std::vector<double>& durations = primitive_update_durations_ms_;
+  std::sort(durations.begin(), durations.end());
+  auto percentile = [&durations](size_t percent) {
+    return durations[(durations.size() - 1) * percent / 100];
+  };
+  ORBIT_DOUBLE("TimeGraph primitive update p50 (ms)", percentile(50));
+  ORBIT_DOUBLE("TimeGraph primitive update p90 (ms)", percentile(90));
+  ORBIT_DOUBLE("TimeGraph primitive update p99 (ms)", percentile(99));
+  durations.clear();
+}
+
 void TimeGraph::SelectCallstacks(float world_start, float world_end, int32_t thread_id) {
   if (world_start > world_end) {
     std::swap(world_end, world_start);
@@ -653,9 +718,25 @@ void TimeGraph::Draw(Batcher& batcher, TextRenderer& text_renderer, uint64_t cur
                      PickingMode picking_mode, float z_offset) {
   ORBIT_SCOPE("TimeGraph::Draw");
 
+  // Picking needs the primitives of the current frame, so we update them all at once. Otherwise, we
+  // only spend a limited amount of time per frame on updating tracks and keep drawing the previous
+  // primitives until the update is complete. We give up on the budget if that takes too long, so
+  // that continuous interaction, which restarts the update on every frame, still shows progress.
+  constexpr absl::Duration kPrimitiveUpdateBudgetPerFrame = absl::Milliseconds(8);
+  constexpr absl::Duration kMaxPrimitiveUpdateLatency = absl::Milliseconds(100);
+
   const bool picking = picking_mode != PickingMode::kNone;
-  if ((!picking && update_primitives_requested_) || picking) {
+  if (picking) {
     UpdatePrimitives(nullptr, 0, 0, picking_mode, z_offset);
+  } else if (update_primitives_requested_ || pending_primitive_update_.has_value()) {
+    const absl::Time start = absl::Now();
+    if (update_primitives_requested_) StartPrimitiveUpdate(picking_mode);
+    const absl::Time deadline =
+        start - oldest_pending_update_request_time_ > kMaxPrimitiveUpdateLatency
+            ? absl::InfiniteFuture()
+            : start + kPrimitiveUpdateBudgetPerFrame;
+    ContinuePrimitiveUpdate(deadline);
+    RecordPrimitiveUpdateDuration(absl::Now() - start);
   }
 
   DrawTracks(batcher, text_renderer, current_mouse_time_ns, picking_mode);
@@ -868,28 +949,34 @@ void TimeGraph::DrawIncompleteDataIntervals(Batcher& batcher, PickingMode pickin
   for (const auto& [start_x, end_x] : x_ranges) {
     const Vec2 pos{start_x, world_start_y};
     const Vec2 size{end_x - start_x, -world_height};
-    float z_value = GlCanvas::kZValueIncompleteDataOverlay;
-
-    std::unique_ptr<PickingUserData> user_data = nullptr;
-    // Show a tooltip when hovering.
-    if (picking_mode == PickingMode::kHover) {
-      // This overlay is placed in front of the tracks (with transparency), but when it comes to
-      // tooltips give it a much lower Z value, so that it's possible to "hover through" it.
-      z_value = GlCanvas::kZValueIncompleteDataOverlayPicking;
-      user_data = std::make_unique<PickingUserData>(nullptr, [](PickingId /*id*/) {
-        return std::string{
-            "Capture data is incomplete in this time range. Some information might be inaccurate."};
-      });
-    }
 
     static const Color kIncompleteDataIntervalOrange{255, 128, 0, 32};
-    batcher.AddBox(Box{pos, size, z_value}, kIncompleteDataIntervalOrange, std::move(user_data));
+    if (picking_mode == PickingMode::kNone) {
+      batcher.AddBox(Box{pos, size, GlCanvas::kZValueIncompleteDataOverlay},
+                     kIncompleteDataIntervalOrange);
+    }
+
+    // Show a tooltip when hovering. This overlay is placed in front of the tracks (with
+    // transparency), but when it comes to tooltips give it a much lower Z value, so that it's
+    // possible to "hover through" it. The invisible box is also added when not picking, so that
+    // hovering can be resolved from the primitives of the last frame (see GlCanvas::PickOnCpu).
+    auto user_data = std::make_unique<PickingUserData>(nullptr, [](PickingId /*id*/) {
+      return std::string{
+          "Capture data is incomplete in this time range. Some information might be inaccurate."};
+    });
+    static const Color kTransparent{0, 0, 0, 0};
+    batcher.AddBox(Box{pos, size, GlCanvas::kZValueIncompleteDataOverlayPicking},
+                   picking_mode == PickingMode::kNone ? kTransparent : kIncompleteDataIntervalOrange,
+                   std::move(user_data));
   }
 }
 
 void TimeGraph::DrawTracks(Batcher& batcher, TextRenderer& text_renderer,
                            uint64_t current_mouse_time_ns, PickingMode picking_mode) {
-  for (auto& track : track_manager_->GetVisibleTracks()) {
+  // Only tracks intersecting the viewport produce any visible output.
+  const float world_top_y = viewport_->GetWorldTopLeft()[1];
+  const float world_bottom_y = world_top_y - viewport_->GetVisibleWorldHeight();
+  for (auto& track : track_manager_->GetVisibleTracksInRange(world_top_y, world_bottom_y)) {
     float z_offset = 0;
     if (track->IsPinned()) {
       z_offset = GlCanvas::kZOffsetPinnedTrack;
@@ -1037,7 +1124,7 @@ TimeGraph::GetMinMaxTextBoxForFunction(uint64_t function_id) const {
 
 void TimeGraph::DrawText(float layer) {
   if (draw_text_) {
-    text_renderer_static_.RenderLayer(layer);
+    front_primitives_->text_renderer.RenderLayer(layer);
   }
 }
 
@@ -6,6 +6,8 @@
 #define ORBIT_GL_TIME_GRAPH_H_
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/time/time.h>
+#include <stddef.h>
 
 #include <cstdint>
 #include <map>
@@ -113,7 +115,9 @@ class TimeGraph : public orbit_gl::CaptureViewElement {
   [[nodiscard]] double GetCaptureTimeSpanUs() const;
   [[nodiscard]] double GetCurrentTimeSpanUs() const;
   void RequestRedraw() { redraw_requested_ = true; }
-  [[nodiscard]] bool IsRedrawNeeded() const { return redraw_requested_; }
+  [[nodiscard]] bool IsRedrawNeeded() const {
+    return redraw_requested_ || pending_primitive_update_.has_value();
+  }
   void SetThreadFilter(const std::string& filter);
 
   [[nodiscard]] bool IsFullyVisible(uint64_t min, uint64_t max) const;
@@ -121,8 +125,18 @@ class TimeGraph : public orbit_gl::CaptureViewElement {
   [[nodiscard]] bool IsVisible(VisibilityType vis_type, uint64_t min, uint64_t max) const;
 
   [[nodiscard]] int GetNumDrawnTextBoxes() const { return num_drawn_text_boxes_; }
-  [[nodiscard]] TextRenderer* GetTextRenderer() { return &text_renderer_static_; }
-  [[nodiscard]] Batcher& GetBatcher() { return batcher_; }
+  // Batcher and text renderer holding the primitives of the last completed update. These are the
+  // ones to draw.
+  [[nodiscard]] Batcher& GetBatcher() { return front_primitives_->batcher; }
+  void SetInstancedBoxRenderer(orbit_gl::InstancedBoxRenderer* instanced_box_renderer) {
+    front_primitives_->batcher.SetInstancedBoxRenderer(instanced_box_renderer);
+    back_primitives_->batcher.SetInstancedBoxRenderer(instanced_box_renderer);
+  }
+  [[nodiscard]] TextRenderer* GetTextRenderer() { return &front_primitives_->text_renderer; }
+  // Text renderer that tracks add their text to while their primitives are being updated.
+  [[nodiscard]] TextRenderer* GetTextRendererForUpdate() {
+    return &back_primitives_->text_renderer;
+  }
   [[nodiscard]] std::vector<std::shared_ptr<orbit_client_data::TimerChain>>
   GetAllThreadTrackTimerChains() const;
 
@@ -196,8 +210,33 @@ class TimeGraph : public orbit_gl::CaptureViewElement {
   void ProcessPageFaultsTrackingTimer(const orbit_client_protos::TimerInfo& timer_info);
 
  private:
+  // Primitives are double-buffered: tracks write into the back buffer, and the buffers are only
+  // swapped once all visible tracks have been updated. Until then, the front buffer with the
+  // primitives of the previous update is drawn.
+  struct PrimitiveBuffer {
+    explicit PrimitiveBuffer(orbit_gl::Viewport* viewport, PickingManager* picking_manager)
+        : batcher(BatcherId::kTimeGraph, picking_manager) {
+      text_renderer.SetViewport(viewport);
+    }
+    Batcher batcher;
+    TextRenderer text_renderer;
+  };
+
+  struct PendingPrimitiveUpdate {
+    uint64_t min_tick = 0;
+    uint64_t max_tick = 0;
+    PickingMode picking_mode = PickingMode::kNone;
+    size_t next_track_index = 0;
+  };
+
+  // Cancels a pending update, if any, and starts a new one from the current view.
+  void StartPrimitiveUpdate(PickingMode picking_mode);
+  // Updates tracks of the pending update until `deadline` and swaps the buffers once all tracks
+  // are done.
+  void ContinuePrimitiveUpdate(absl::Time deadline);
+  void RecordPrimitiveUpdateDuration(absl::Duration duration);
+
   AccessibleInterfaceProvider* accessible_parent_;
-  TextRenderer text_renderer_static_;
   int num_drawn_text_boxes_ = 0;
 
   // First member is id.
@@ -228,7 +267,14 @@ class TimeGraph : public orbit_gl::CaptureViewElement {
 
   bool draw_text_ = true;
 
-  Batcher batcher_;
+  // Held by pointer, so that swapping keeps the addresses of the batchers stable. Picking user data
+  // created during an update refers to the batcher it was created for.
+  std::unique_ptr<PrimitiveBuffer> front_primitives_;
+  std::unique_ptr<PrimitiveBuffer> back_primitives_;
+  std::optional<PendingPrimitiveUpdate> pending_primitive_update_;
+  // Time of the oldest request that is not reflected in the front buffer yet.
+  absl::Time oldest_pending_update_request_time_;
+  std::vector<double> primitive_update_durations_ms_;
 
   std::unique_ptr<TrackManager> track_manager_;
 
@@ -78,6 +78,7 @@ bool TimeGraphLayout::DrawProperties() {
   FLOAT_SLIDER_MIN_MAX(scale_, 0.05f, 20.f);
   ImGui::Checkbox("Draw Track Background", &draw_track_background_);
 
+  if (needs_redraw) ++version_;
   return needs_redraw;
 }
 
@@ -42,7 +42,14 @@ class TimeGraphLayout {
   float GetToolbarIconHeight() const { return toolbar_icon_height_; }
   float GetGenericFixedSpacerWidth() const { return generic_fixed_spacer_width_; }
   float GetScale() const { return scale_; }
-  void SetScale(float value) { scale_ = value; }
+  void SetScale(float value) {
+    if (value == scale_) return;
+    scale_ = value;
+    ++version_;
+  }
+  // Incremented on every change of the layout properties, so that geometry computed from them can
+  // be cached until the version changes.
+  [[nodiscard]] uint64_t GetVersion() const { return version_; }
   void SetDrawProperties(bool value) { draw_properties_ = value; }
   bool DrawProperties();
   bool GetDrawTrackBackground() const { return draw_track_background_; }
@@ -88,6 +95,8 @@ class TimeGraphLayout {
 
   bool draw_properties_ = false;
   bool draw_track_background_ = true;
+
+  uint64_t version_ = 0;
 };
 
 #endif  // ORBIT_GL_TIME_GRAPH_LAYOUT_H_
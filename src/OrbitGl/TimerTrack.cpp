@@ -34,9 +34,7 @@ TimerTrack::TimerTrack(CaptureViewElement* parent, TimeGraph* time_graph,
                        orbit_gl::Viewport* viewport, TimeGraphLayout* layout, OrbitApp* app,
                        const orbit_client_model::CaptureData* capture_data,
                        uint32_t indentation_level)
-    : Track(parent, time_graph, viewport, layout, capture_data, indentation_level), app_{app} {
-  text_renderer_ = time_graph->GetTextRenderer();
-}
+    : Track(parent, time_graph, viewport, layout, capture_data, indentation_level), app_{app} {}
 
 void TimerTrack::Draw(Batcher& batcher, TextRenderer& text_renderer, uint64_t current_mouse_time_ns,
                       PickingMode picking_mode, float z_offset) {
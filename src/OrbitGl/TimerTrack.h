@@ -145,7 +145,6 @@ class TimerTrack : public Track {
       orbit_gl::Viewport* viewport, bool is_collapsed,
       const orbit_client_data::TextBox* selected_textbox, uint64_t highlighted_function_id);
 
-  TextRenderer* text_renderer_ = nullptr;
   uint32_t depth_ = 0;
   mutable absl::Mutex mutex_;
   int visible_timer_count_ = 0;
@@ -186,12 +186,13 @@ void Track::Draw(Batcher& batcher, TextRenderer& text_renderer, uint64_t current
                                                   font_size, label_width - label_offset_x);
   }
 
-  // Draw track's content background.
+  // Draw track's content background. It is not drawn when picking, so it does not need a picking
+  // color and must not hide the background from picking on the CPU either.
   if (!picking) {
     if (layout_->GetDrawTrackBackground()) {
       Box box(Vec2(x0, y0 - label_height + top_margin),
               Vec2(size_[0], -size_[1] + label_height - top_margin), track_z);
-      batcher.AddBox(box, track_background_color, shared_from_this());
+      batcher.AddBox(box, track_background_color);
     }
   }
 }
@@ -234,5 +235,6 @@ void Track::OnDrag(int x, int y) {
   CaptureViewElement::OnDrag(x, y);
 
   pos_[1] = mouse_pos_cur_[1] - picking_offset_[1];
+  UpdatePositionOfSubtracks();
   time_graph_->VerticallyMoveIntoView(*this);
 }
@@ -65,6 +65,8 @@ class Track : public orbit_gl::CaptureViewElement, public std::enable_shared_fro
   [[nodiscard]] virtual bool Movable() { return !pinned_; }
 
   [[nodiscard]] virtual float GetHeight() const = 0;
+  // Moves the subtracks, if any, to match the current position of this track.
+  virtual void UpdatePositionOfSubtracks() {}
   [[nodiscard]] bool GetVisible() const { return visible_; }
   void SetVisible(bool value) { visible_ = value; }
 
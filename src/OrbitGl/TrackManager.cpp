@@ -6,12 +6,14 @@
 
 #include <GteVector.h>
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 #include <absl/flags/declare.h>
 #include <absl/flags/flag.h>
 #include <absl/strings/ascii.h>
 #include <absl/strings/match.h>
 #include <absl/strings/str_format.h>
 #include <absl/strings/str_split.h>
+#include <absl/time/time.h>
 #include <stdlib.h>
 
 #include <algorithm>
@@ -28,6 +30,7 @@
 #include "CoreMath.h"
 #include "GlCanvas.h"
 #include "OrbitBase/Append.h"
+#include "OrbitBase/Logging.h"
 #include "OrbitBase/ThreadConstants.h"
 #include "TimeGraph.h"
 #include "TimeGraphLayout.h"
@@ -182,6 +185,7 @@ void TrackManager::SetFilter(const std::string& filter) {
 
 void TrackManager::UpdateVisibleTrackList() {
   visible_track_list_needs_update_ = false;
+  layout_needs_update_ = true;
   visible_tracks_.clear();
 
   auto track_should_be_shown = [this](const Track* track) {
@@ -191,23 +195,42 @@ void TrackManager::UpdateVisibleTrackList() {
   if (filter_.empty()) {
     std::copy_if(sorted_tracks_.begin(), sorted_tracks_.end(), std::back_inserter(visible_tracks_),
                  track_should_be_shown);
-    return;
-  }
-
-  std::vector<std::string> filters = absl::StrSplit(filter_, ' ', absl::SkipWhitespace());
-  for (const auto& track : sorted_tracks_) {
-    if (!track_should_be_shown(track)) {
-      continue;
-    }
+  } else {
+    std::vector<std::string> filters = absl::StrSplit(filter_, ' ', absl::SkipWhitespace());
+    for (const auto& track : sorted_tracks_) {
+      if (!track_should_be_shown(track)) {
+        continue;
+      }
 
-    std::string lower_case_label = absl::AsciiStrToLower(track->GetLabel());
-    for (auto& filter : filters) {
-      if (absl::StrContains(lower_case_label, filter)) {
-        visible_tracks_.push_back(track);
-        break;
+      std::string lower_case_label = absl::AsciiStrToLower(track->GetLabel());
+      for (auto& filter : filters) {
+        if (absl::StrContains(lower_case_label, filter)) {
+          visible_tracks_.push_back(track);
+          break;
+        }
       }
     }
   }
+
+  RemoveHiddenTracksFromAppliedLayout();
+}
+
+void TrackManager::RemoveHiddenTracksFromAppliedLayout() {
+  // Tracks that were removed or filtered out must not be drawn anymore, even before the next
+  // layout gets applied. The remaining tracks keep their applied positions until then.
+  absl::flat_hash_set<const Track*> visible_tracks(visible_tracks_.begin(), visible_tracks_.end());
+  size_t num_kept_tracks = 0;
+  for (size_t i = 0; i < applied_tracks_.size(); ++i) {
+    if (!visible_tracks.contains(applied_tracks_[i])) continue;
+    applied_tracks_[num_kept_tracks] = applied_tracks_[i];
+    applied_track_tops_[num_kept_tracks] = applied_track_tops_[i];
+    applied_track_heights_[num_kept_tracks] = applied_track_heights_[i];
+    ++num_kept_tracks;
+  }
+  applied_tracks_.resize(num_kept_tracks);
+  applied_track_tops_.resize(num_kept_tracks);
+  applied_track_heights_.resize(num_kept_tracks);
+  if (moving_track_ != nullptr && !visible_tracks.contains(moving_track_)) moving_track_ = nullptr;
 }
 
 std::vector<ThreadTrack*> TrackManager::GetSortedThreadTracks() {
@@ -246,9 +269,11 @@ void TrackManager::UpdateMovingTrackPositionInVisibleTracks() {
   // could be optimized, but this is not worth the effort for the limited number of tracks.
 
   int moving_track_previous_position = FindMovingTrackIndex();
+  moving_track_ = nullptr;
 
   if (moving_track_previous_position != -1) {
     Track* moving_track = visible_tracks_[moving_track_previous_position];
+    moving_track_ = moving_track;
     visible_tracks_.erase(visible_tracks_.begin() + moving_track_previous_position);
 
     int moving_track_current_position = -1;
@@ -269,6 +294,7 @@ void TrackManager::UpdateMovingTrackPositionInVisibleTracks() {
     if (moving_track_current_position == moving_track_previous_position) {
       return;
     }
+    layout_needs_update_ = true;
     sorted_tracks_.erase(std::find(sorted_tracks_.begin(), sorted_tracks_.end(), moving_track));
     if (moving_track_current_position > moving_track_previous_position) {
       // In this case we will insert the moving_track right after the one who is before in the
@@ -298,19 +324,48 @@ int TrackManager::FindMovingTrackIndex() {
   return -1;
 }
 
-void TrackManager::UpdateTrackPrimitives(Batcher* batcher, uint64_t min_tick, uint64_t max_tick,
-                                         PickingMode picking_mode) {
+bool TrackManager::UpdateTrackLayout() {
+  if (layout_needs_update_ || layout_->GetVersion() != layout_version_ ||
+      track_heights_.size() != visible_tracks_.size()) {
+    ComputeTrackLayout(0);
+    layout_needs_update_ = false;
+    layout_version_ = layout_->GetVersion();
+    return true;
+  }
+
+  // Heights change with new data, e.g. when a subtrack of a thread track gets its first event, or
+  // when a track gets collapsed or expanded. Comparing them is cheap, and only the tracks from the
+  // first changed one on need to be laid out again.
+  size_t first_changed_track_index = 0;
+  while (first_changed_track_index < visible_tracks_.size() &&
+         visible_tracks_[first_changed_track_index]->GetHeight() ==
+             track_heights_[first_changed_track_index]) {
+    ++first_changed_track_index;
+  }
+  if (first_changed_track_index == visible_tracks_.size()) return false;
+
+  ComputeTrackLayout(first_changed_track_index);
+  return true;
+}
+
+void TrackManager::ComputeTrackLayout(size_t first_track_index) {
+  ORBIT_SCOPE_FUNCTION;
+  CHECK(first_track_index <= track_tops_.size());
+  track_tops_.resize(visible_tracks_.size());
+  track_heights_.resize(visible_tracks_.size());
+
   // Make sure track tab fits in the viewport.
   float current_y = -layout_->GetSchedulerTrackOffset();
+  if (first_track_index > 0) {
+    current_y = track_tops_[first_track_index - 1] - track_heights_[first_track_index - 1] -
+                layout_->GetSpaceBetweenTracks();
+  }
 
-  // Draw tracks
-  for (auto& track : visible_tracks_) {
-    const float z_offset = track->IsMoving() ? GlCanvas::kZOffsetMovingTrack : 0.f;
-    if (!track->IsMoving()) {
-      track->SetPos(track->GetPos()[0], current_y);
-    }
-    track->UpdatePrimitives(batcher, min_tick, max_tick, picking_mode, z_offset);
-    current_y -= (track->GetHeight() + layout_->GetSpaceBetweenTracks());
+  for (size_t i = first_track_index; i < visible_tracks_.size(); ++i) {
+    Track* track = visible_tracks_[i];
+    track_tops_[i] = current_y;
+    track_heights_[i] = track->GetHeight();
+    current_y -= (track_heights_[i] + layout_->GetSpaceBetweenTracks());
   }
 
   // TODO: This margin should be treated in a different way (http://b/192070555).
@@ -320,6 +375,82 @@ void TrackManager::UpdateTrackPrimitives(Batcher* batcher, uint64_t min_tick, ui
   tracks_total_height_ = std::abs(current_y);
 }
 
+size_t TrackManager::UpdateTrackPrimitives(Batcher* batcher, uint64_t min_tick, uint64_t max_tick,
+                                           PickingMode picking_mode, size_t first_track_index,
+                                           absl::Time deadline) {
+  CHECK(first_track_index <= visible_tracks_.size());
+  if (first_track_index == 0 || track_heights_.size() != visible_tracks_.size()) {
+    UpdateTrackLayout();
+  }
+
+  size_t track_index = first_track_index;
+  while (track_index < visible_tracks_.size()) {
+    if (track_index > first_track_index && absl::Now() >= deadline) return track_index;
+
+    Track* track = visible_tracks_[track_index];
+    const float z_offset = track->IsMoving() ? GlCanvas::kZOffsetMovingTrack : 0.f;
+    // The moving track follows the mouse, but keeps its slot in the layout. All other tracks are
+    // only moved temporarily, as they are still drawn with the primitives of the applied layout.
+    if (track->IsMoving()) {
+      track->UpdatePrimitives(batcher, min_tick, max_tick, picking_mode, z_offset);
+    } else {
+      const float applied_y = track->GetPos()[1];
+      track->SetPos(track->GetPos()[0], track_tops_[track_index]);
+      track->UpdatePrimitives(batcher, min_tick, max_tick, picking_mode, z_offset);
+      track->SetPos(track->GetPos()[0], applied_y);
+      track->UpdatePositionOfSubtracks();
+    }
+
+    // Updating the primitives can change the height of a track, e.g. when the depth of a thread
+    // track is computed from its scope tree. Only then the tracks below need to move.
+    if (track->GetHeight() != track_heights_[track_index]) {
+      ComputeTrackLayout(track_index);
+    }
+    ++track_index;
+  }
+
+  return track_index;
+}
+
+void TrackManager::ApplyTrackLayout() {
+  CHECK(track_tops_.size() == visible_tracks_.size());
+  for (size_t i = 0; i < visible_tracks_.size(); ++i) {
+    Track* track = visible_tracks_[i];
+    if (!track->IsMoving()) {
+      track->SetPos(track->GetPos()[0], track_tops_[i]);
+      track->UpdatePositionOfSubtracks();
+    }
+  }
+  applied_tracks_ = visible_tracks_;
+  applied_track_tops_ = track_tops_;
+  applied_track_heights_ = track_heights_;
+  applied_tracks_total_height_ = tracks_total_height_;
+}
+
+std::vector<Track*> TrackManager::GetVisibleTracksInRange(float top_y, float bottom_y) const {
+  std::vector<Track*> tracks;
+
+  // Tracks are laid out from top to bottom without overlap, so both their tops and their bottoms
+  // are decreasing. We search for the first track whose bottom is above `top_y`.
+  size_t first = 0;
+  size_t last = applied_track_tops_.size();
+  while (first < last) {
+    const size_t middle = first + (last - first) / 2;
+    if (applied_track_tops_[middle] - applied_track_heights_[middle] > top_y) {
+      first = middle + 1;
+    } else {
+      last = middle;
+    }
+  }
+
+  for (size_t i = first; i < applied_tracks_.size() && applied_track_tops_[i] >= bottom_y; ++i) {
+    if (applied_tracks_[i] != moving_track_) tracks.push_back(applied_tracks_[i]);
+  }
+  // The moving track is drawn wherever the mouse is, independent of its slot.
+  if (moving_track_ != nullptr) tracks.push_back(moving_track_);
+  return tracks;
+}
+
 void TrackManager::UpdateTracksForRendering() {
   // Reorder threads if sorting isn't valid or once per second when capturing.
   if (sorting_invalidated_ ||
@@ -334,6 +465,8 @@ void TrackManager::UpdateTracksForRendering() {
 
   // Update position of a track which is currently being moved.
   UpdateMovingTrackPositionInVisibleTracks();
+
+  UpdateTrackLayout();
 }
 
 void TrackManager::AddTrack(const std::shared_ptr<Track>& track) {
@@ -363,8 +496,9 @@ void TrackManager::RemoveFrameTrack(uint64_t function_id) {
   sorted_tracks_.erase(
       std::remove(sorted_tracks_.begin(), sorted_tracks_.end(), frame_tracks_[function_id].get()),
       sorted_tracks_.end());
+  // Also drops the track from visible_tracks_ and from the applied layout before it is destroyed.
+  UpdateVisibleTrackList();
   frame_tracks_.erase(function_id);
-  visible_track_list_needs_update_ = true;
 }
 
 void TrackManager::SetTrackTypeVisibility(Track::Type type, bool value) {
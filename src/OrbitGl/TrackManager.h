@@ -6,6 +6,8 @@
 #define ORBIT_GL_TRACK_MANAGER_H_
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/time/time.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -45,6 +47,7 @@ class TrackManager {
 
   [[nodiscard]] std::vector<Track*> GetAllTracks() const;
   [[nodiscard]] std::vector<Track*> GetVisibleTracks() const { return visible_tracks_; }
+  [[nodiscard]] size_t GetNumVisibleTracks() const { return visible_tracks_.size(); }
   [[nodiscard]] std::vector<ThreadTrack*> GetThreadTracks() const;
   [[nodiscard]] std::vector<FrameTrack*> GetFrameTracks() const;
 
@@ -52,9 +55,31 @@ class TrackManager {
   void SetFilter(const std::string& filter);
 
   void UpdateTracksForRendering();
-  void UpdateTrackPrimitives(Batcher* batcher, uint64_t min_tick, uint64_t max_tick,
-                             PickingMode picking_mode);
-  [[nodiscard]] float GetTracksTotalHeight() const { return tracks_total_height_; }
+  // Recomputes the vertical positions of the visible tracks and their total height. This only does
+  // work if the list or the order of the visible tracks, the height of a track or the
+  // TimeGraphLayout changed since the last call. Height changes are found by comparing the heights
+  // of the visible tracks to the ones of the last layout, and only the tracks from the first changed
+  // one on are laid out again. Returns whether the layout was recomputed.
+  // The tracks are not moved before the next call to ApplyTrackLayout.
+  bool UpdateTrackLayout();
+  // Updates the primitives of the visible tracks, starting with the track at index
+  // `first_track_index`, and returns the index of the first track that was not updated yet. Once
+  // `deadline` has passed, no further track is started, but at least one track is always updated
+  // so that an update split across several calls makes progress. If updating a track changes its
+  // height, the tracks below it are laid out again. The primitives are built for the new layout,
+  // while the tracks keep their current position until ApplyTrackLayout is called.
+  [[nodiscard]] size_t UpdateTrackPrimitives(Batcher* batcher, uint64_t min_tick,
+                                             uint64_t max_tick, PickingMode picking_mode,
+                                             size_t first_track_index = 0,
+                                             absl::Time deadline = absl::InfiniteFuture());
+  // Moves the tracks to the positions of the last layout. This has to happen together with showing
+  // the primitives built by UpdateTrackPrimitives, so that the track headers and their content
+  // stay in sync while an update is split across several frames.
+  void ApplyTrackLayout();
+  // Returns the tracks which overlap the world y-range [bottom_y, top_y], based on the applied
+  // layout, plus the currently moving track. This is logarithmic in the number of tracks.
+  [[nodiscard]] std::vector<Track*> GetVisibleTracksInRange(float top_y, float bottom_y) const;
+  [[nodiscard]] float GetTracksTotalHeight() const { return applied_tracks_total_height_; }
 
   [[nodiscard]] uint32_t GetNumTimers() const;
   [[nodiscard]] std::pair<uint64_t, uint64_t> GetTracksMinMaxTimestamps() const;
@@ -92,6 +117,8 @@ class TrackManager {
   void SortTracks();
   [[nodiscard]] std::vector<ThreadTrack*> GetSortedThreadTracks();
   void UpdateVisibleTrackList();
+  void RemoveHiddenTracksFromAppliedLayout();
+  void ComputeTrackLayout(size_t first_track_index);
 
   void AddTrack(const std::shared_ptr<Track>& track);
   void AddFrameTrack(const std::shared_ptr<FrameTrack>& frame_track);
@@ -125,8 +152,20 @@ class TrackManager {
 
   std::string filter_;
   std::vector<Track*> visible_tracks_;
+  // The visible track which was being moved during the last UpdateTracksForRendering, if any.
+  Track* moving_track_ = nullptr;
 
   float tracks_total_height_ = 0.0f;
+  // Top and height of each track in visible_tracks_, as computed by the last layout.
+  std::vector<float> track_tops_;
+  std::vector<float> track_heights_;
+  bool layout_needs_update_ = true;
+  uint64_t layout_version_ = 0;
+  // The layout the tracks are currently positioned and drawn with, see ApplyTrackLayout.
+  std::vector<Track*> applied_tracks_;
+  std::vector<float> applied_track_tops_;
+  std::vector<float> applied_track_heights_;
+  float applied_tracks_total_height_ = 0.0f;
   const orbit_client_model::CaptureData* capture_data_ = nullptr;
 
   OrbitApp* app_ = nullptr;
@@ -3,8 +3,15 @@
 // found in the LICENSE file.
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 #include "ClientData/ModuleManager.h"
+#include "ClientData/TextBox.h"
+#include "ClientData/TimerChain.h"
 #include "ClientModel/CaptureData.h"
+#include "ThreadTrack.h"
 #include "TimeGraph.h"
 #include "Track.h"
 #include "TrackManager.h"
@@ -144,4 +151,195 @@ TEST_F(TrackManagerTest, TrackTypeVisibilityAffectsVisibleTrackList) {
   EXPECT_EQ(kNumTracks - 1, track_manager_.GetVisibleTracks().size());
 }
 
-}  // namespace orbit_gl
\ No newline at end of file
+TEST_F(TrackManagerTest, TrackLayoutIsOnlyRecomputedWhenSomethingChanged) {
+  CreateAndFillTracks();
+  track_manager_.UpdateTracksForRendering();
+  // The layout was computed by UpdateTracksForRendering and nothing changed since.
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  layout_.SetScale(layout_.GetScale() * 2.f);
+  EXPECT_TRUE(track_manager_.UpdateTrackLayout());
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  track_manager_.SetFilter("thread");
+  EXPECT_TRUE(track_manager_.UpdateTrackLayout());
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  // A new timer at a larger depth changes the height of the track.
+  TimerInfo timer;
+  timer.set_start(0);
+  timer.set_end(100);
+  timer.set_thread_id(TrackTestData::kThreadId);
+  timer.set_depth(1);
+  timer.set_type(TimerInfo::kNone);
+  ThreadTrack* thread_track = track_manager_.GetOrCreateThreadTrack(TrackTestData::kThreadId);
+  thread_track->OnTimer(timer);
+  EXPECT_TRUE(track_manager_.UpdateTrackLayout());
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  // A timer which doesn't change the depth doesn't change the layout.
+  thread_track->OnTimer(timer);
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  thread_track->GetTriangleToggle()->SetCollapsed(true);
+  thread_track->OnCollapseToggle(true);
+  EXPECT_TRUE(track_manager_.UpdateTrackLayout());
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+}
+
+TEST_F(TrackManagerTest, TracksOnlyMoveWhenTheLayoutIsApplied) {
+  CreateAndFillTracks();
+  track_manager_.UpdateTracksForRendering();
+  track_manager_.ApplyTrackLayout();
+  const std::vector<Track*> tracks = track_manager_.GetVisibleTracks();
+  ASSERT_EQ(tracks.size(), kNumTracks);
+  const float old_y = tracks.back()->GetPos()[1];
+  const float old_total_height = track_manager_.GetTracksTotalHeight();
+
+  layout_.SetScale(layout_.GetScale() * 2.f);
+  track_manager_.UpdateTracksForRendering();
+  EXPECT_EQ(tracks.back()->GetPos()[1], old_y);
+  EXPECT_EQ(track_manager_.GetTracksTotalHeight(), old_total_height);
+
+  track_manager_.ApplyTrackLayout();
+  EXPECT_NE(tracks.back()->GetPos()[1], old_y);
+  EXPECT_NE(track_manager_.GetTracksTotalHeight(), old_total_height);
+}
+
+TEST_F(TrackManagerTest, HiddenTracksAreNotDrawnBeforeTheLayoutIsApplied) {
+  CreateAndFillTracks();
+  track_manager_.UpdateTracksForRendering();
+  track_manager_.ApplyTrackLayout();
+  const float all_top_y = track_manager_.GetVisibleTracks().front()->GetPos()[1] + 1.f;
+  const float all_bottom_y = -track_manager_.GetTracksTotalHeight();
+  ASSERT_EQ(track_manager_.GetVisibleTracksInRange(all_top_y, all_bottom_y).size(), kNumTracks);
+
+  track_manager_.SetFilter("thread");
+  EXPECT_EQ(track_manager_.GetVisibleTracksInRange(all_top_y, all_bottom_y),
+            track_manager_.GetVisibleTracks());
+  EXPECT_EQ(track_manager_.GetVisibleTracksInRange(all_top_y, all_bottom_y).size(),
+            kNumThreadTracks);
+}
+
+TEST_F(TrackManagerTest, ManyTracksAreLaidOutAndCulled) {
+  constexpr size_t kNumManyTracks = 1000;
+  TimerInfo timer;
+  timer.set_start(0);
+  timer.set_end(100);
+  timer.set_depth(0);
+  timer.set_type(TimerInfo::kNone);
+  for (size_t i = 0; i < kNumManyTracks; ++i) {
+    const int32_t thread_id = static_cast<int32_t>(i) + 1;
+    timer.set_thread_id(thread_id);
+    track_manager_.GetOrCreateThreadTrack(thread_id)->OnTimer(timer);
+  }
+
+  track_manager_.UpdateTracksForRendering();
+  track_manager_.ApplyTrackLayout();
+
+  const std::vector<Track*>& tracks = track_manager_.GetVisibleTracks();
+  ASSERT_EQ(tracks.size(), kNumManyTracks);
+  float expected_y = -layout_.GetSchedulerTrackOffset();
+  for (Track* track : tracks) {
+    EXPECT_EQ(track->GetPos()[1], expected_y);
+    expected_y -= track->GetHeight() + layout_.GetSpaceBetweenTracks();
+  }
+  EXPECT_EQ(track_manager_.GetTracksTotalHeight(),
+            std::abs(expected_y - layout_.GetBottomMargin()));
+
+  // Repeated updates without any change don't lay out the tracks again.
+  track_manager_.UpdateTracksForRendering();
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  // A range covering three tracks, starting and ending in the middle of a track.
+  const float top_y = tracks[10]->GetPos()[1] - 1.f;
+  const float bottom_y = tracks[12]->GetPos()[1] - 1.f;
+  std::vector<Track*> tracks_in_range = track_manager_.GetVisibleTracksInRange(top_y, bottom_y);
+  EXPECT_EQ(tracks_in_range, std::vector<Track*>(tracks.begin() + 10, tracks.begin() + 13));
+
+  const float all_top_y = tracks.front()->GetPos()[1] + 1.f;
+  const float all_bottom_y = -track_manager_.GetTracksTotalHeight();
+  EXPECT_EQ(track_manager_.GetVisibleTracksInRange(all_top_y, all_bottom_y), tracks);
+
+  EXPECT_TRUE(track_manager_.GetVisibleTracksInRange(all_bottom_y - 1.f, all_bottom_y - 10.f)
+                  .empty());
+
+  // A height change in the middle only moves the tracks below.
+  constexpr int32_t kChangedThreadId = static_cast<int32_t>(kNumManyTracks / 2);
+  Track* changed_track = track_manager_.GetOrCreateThreadTrack(kChangedThreadId);
+  const size_t changed_index =
+      std::find(tracks.begin(), tracks.end(), changed_track) - tracks.begin();
+  ASSERT_LT(changed_index + 1, tracks.size());
+  const float top_of_first_track = tracks.front()->GetPos()[1];
+  const float previous_height = changed_track->GetHeight();
+  timer.set_thread_id(kChangedThreadId);
+  timer.set_depth(3);
+  changed_track->OnTimer(timer);
+  ASSERT_NE(changed_track->GetHeight(), previous_height);
+  EXPECT_TRUE(track_manager_.UpdateTrackLayout());
+  EXPECT_FALSE(track_manager_.UpdateTrackLayout());
+
+  track_manager_.ApplyTrackLayout();
+  EXPECT_EQ(tracks.front()->GetPos()[1], top_of_first_track);
+  EXPECT_EQ(tracks[changed_index + 1]->GetPos()[1], changed_track->GetPos()[1] -
+                                                        changed_track->GetHeight() -
+                                                        layout_.GetSpaceBetweenTracks());
+}
+
+TEST_F(TrackManagerTest, ThreadTrackNavigatesAndSearchesThroughTheScopeTree) {
+  constexpr uint64_t kFunctionIdFoo = 1;
+  constexpr uint64_t kFunctionIdBar = 2;
+  ThreadTrack* track = track_manager_.GetOrCreateThreadTrack(TrackTestData::kThreadId);
+  // Two calls of foo, with nested calls of bar.
+  struct Call {
+    uint64_t start;
+    uint64_t end;
+    uint32_t depth;
+    uint64_t function_id;
+  };
+  const std::vector<Call> calls{{0, 100, 0, kFunctionIdFoo},   {10, 20, 1, kFunctionIdBar},
+                                {30, 60, 1, kFunctionIdBar},   {40, 50, 2, kFunctionIdFoo},
+                                {200, 300, 0, kFunctionIdFoo}, {210, 220, 1, kFunctionIdBar}};
+  for (const Call& call : calls) {
+    TimerInfo timer;
+    timer.set_start(call.start);
+    timer.set_end(call.end);
+    timer.set_depth(call.depth);
+    timer.set_function_id(call.function_id);
+    timer.set_thread_id(TrackTestData::kThreadId);
+    timer.set_type(TimerInfo::kNone);
+    track->OnTimer(timer);
+  }
+
+  std::vector<const orbit_client_data::TextBox*> boxes;
+  for (const auto& chain : track->GetAllChains()) {
+    for (const orbit_client_data::TimerBlock& block : *chain) {
+      for (uint64_t i = 0; i < block.size(); ++i) boxes.push_back(&block[i]);
+    }
+  }
+  ASSERT_EQ(boxes.size(), calls.size());
+
+  EXPECT_EQ(track->GetUp(boxes[3]), boxes[2]);
+  EXPECT_EQ(track->GetUp(boxes[0]), nullptr);
+  EXPECT_EQ(track->GetDown(boxes[0]), boxes[1]);
+  EXPECT_EQ(track->GetDown(boxes[3]), nullptr);
+  EXPECT_EQ(track->GetLeft(boxes[1]), nullptr);
+  EXPECT_EQ(track->GetRight(boxes[1]), boxes[2]);
+  EXPECT_EQ(track->GetRight(boxes[2]), boxes[5]);
+  EXPECT_EQ(track->GetLeft(boxes[5]), boxes[2]);
+  EXPECT_EQ(track->GetRight(boxes[0]), boxes[4]);
+
+  // Searches are ordered by the end of the timers, across depths.
+  EXPECT_EQ(track->FindNextFunctionCall(kFunctionIdFoo, 0), boxes[3]);
+  EXPECT_EQ(track->FindNextFunctionCall(kFunctionIdFoo, 50), boxes[0]);
+  EXPECT_EQ(track->FindNextFunctionCall(kFunctionIdFoo, 100), boxes[4]);
+  EXPECT_EQ(track->FindNextFunctionCall(kFunctionIdFoo, 300), nullptr);
+  EXPECT_EQ(track->FindNextFunctionCall(kFunctionIdBar, 20), boxes[2]);
+  EXPECT_EQ(track->FindPreviousFunctionCall(kFunctionIdBar, 300), boxes[5]);
+  EXPECT_EQ(track->FindPreviousFunctionCall(kFunctionIdBar, 210), boxes[2]);
+  EXPECT_EQ(track->FindPreviousFunctionCall(kFunctionIdFoo, 100), boxes[3]);
+  EXPECT_EQ(track->FindPreviousFunctionCall(kFunctionIdFoo, 101), boxes[0]);
+  EXPECT_EQ(track->FindPreviousFunctionCall(kFunctionIdFoo, 50), nullptr);
+}
+
+}  // namespace orbit_gl
@@ -18,6 +18,11 @@
 #include "SourcePathsMappingUI/AskUserForFile.h"
 
 namespace orbit_qt {
+AnnotatingSourceCodeDialog::~AnnotatingSourceCodeDialog() {
+  annotation_canceled_ = true;
+  annotation_thread_pool_->ShutdownAndWait();
+}
+
 void AnnotatingSourceCodeDialog::AddAnnotatingSourceCode(
     orbit_client_protos::FunctionInfo function_info, RetrieveModuleWithDebugInfoCallback callback) {
   function_info_ = std::move(function_info);
@@ -160,19 +165,56 @@ void AnnotatingSourceCodeDialog::ChooseFile() {
 }
 
 void AnnotatingSourceCodeDialog::HandleSourceCode(const QString& source_file_contents) {
-  annotations_ = orbit_code_report::AnnotateDisassemblyWithSourceCode(
+  annotator_ = std::make_unique<orbit_code_report::DisassemblyAnnotator>(
       function_info_, location_info_, source_file_contents.toStdString(), elf_file_.get(),
-      report_.value());
+      &report_.value());
+
+  user_chose_file_ = awaited_button_action_ == ButtonAction::kChooseFile;
+
+  // There is no button while annotating, so ChooseFile can't start a second annotation.
+  SetStatusMessage("Matching source code lines to instructions", std::nullopt);
+  awaited_button_action_ = ButtonAction::kNone;
+  AnnotateInstructionsInBackground();
+}
+
+void AnnotatingSourceCodeDialog::AnnotateInstructionsInBackground() {
+  // Looking up the source lines of large functions can take seconds, so this happens off the main
+  // thread. Progress is reported after each chunk, and the dialog's destructor cancels the
+  // annotation between chunks.
+  annotation_thread_pool_->Schedule([this]() {
+    constexpr size_t kInstructionsPerChunk = 4096;
+    size_t num_annotated_instructions = 0;
+    while (!annotation_canceled_ && !annotator_->AnnotateNextInstructions(kInstructionsPerChunk)) {
+      num_annotated_instructions += kInstructionsPerChunk;
+      main_thread_executor_->Schedule([this, num_annotated_instructions]() {
+        HandleAnnotationProgress(num_annotated_instructions);
+      });
+    }
+    if (annotation_canceled_) return;
+    main_thread_executor_->Schedule([this]() { HandleAnnotationsComputed(); });
+  });
+}
+
+void AnnotatingSourceCodeDialog::HandleAnnotationProgress(size_t num_annotated_instructions) {
+  const size_t num_instructions = report_->GetInstructionAddresses().size();
+  SetStatusMessage(QString("Matching source code lines to instructions (%1 of %2)")
+                       .arg(num_annotated_instructions)
+                       .arg(num_instructions),
+                   std::nullopt);
+}
+
+void AnnotatingSourceCodeDialog::HandleAnnotationsComputed() {
+  annotations_ = annotator_->GetAnnotatingLines();
+  annotator_.reset();
 
   // When loading the source code takes less than the given time we won't ask the user if they want
   // to have the source code added for context. We will add it right away - as it's done in Visual
   // Studio.
   constexpr std::chrono::steady_clock::duration kMaxWaitingTime = std::chrono::milliseconds{250};
 
-  // ButtonAction::kChooseFile means the user had to select the source file path manually. In this
-  // case we don't keep them waiting even if loading took longer than the limit.
-  if (awaited_button_action_ == ButtonAction::kChooseFile ||
-      std::chrono::steady_clock::now() - starting_time_ < kMaxWaitingTime) {
+  // If the user had to select the source file path manually, we don't keep them waiting even if
+  // loading took longer than the limit.
+  if (user_chose_file_ || std::chrono::steady_clock::now() - starting_time_ < kMaxWaitingTime) {
     HandleAnnotations();
     return;
   }
@@ -5,14 +5,18 @@
 #ifndef ORBIT_QT_ANNOTATING_SOURCE_CODE_DIALOG_H_
 #define ORBIT_QT_ANNOTATING_SOURCE_CODE_DIALOG_H_
 
+#include <absl/time/time.h>
 #include <absl/types/span.h>
 
 #include <QObject>
 #include <QPointer>
+#include <atomic>
 #include <chrono>
 #include <functional>
+#include <memory>
 
 #include "App.h"
+#include "CodeReport/AnnotateDisassembly.h"
 #include "CodeReport/AnnotatingLine.h"
 #include "CodeReport/DisassemblyReport.h"
 #include "CodeViewer/FontSizeInEm.h"
@@ -20,6 +24,7 @@
 #include "ObjectUtils/ElfFile.h"
 #include "OrbitBase/Future.h"
 #include "OrbitBase/Result.h"
+#include "OrbitBase/ThreadPool.h"
 #include "QtUtils/MainThreadExecutorImpl.h"
 #include "capture_data.pb.h"
 #include "symbol.pb.h"
@@ -45,6 +50,8 @@ class AnnotatingSourceCodeDialog : public orbit_code_viewer::Dialog {
 
  public:
   using orbit_code_viewer::Dialog::Dialog;
+  // Waits for a running annotation to stop, which takes at most one chunk of instructions.
+  ~AnnotatingSourceCodeDialog() override;
 
   // Same interface as OrbitApp::RetrieveModuleWithDebugInfo;
   using RetrieveModuleWithDebugInfoCallback =
@@ -77,6 +84,9 @@ class AnnotatingSourceCodeDialog : public orbit_code_viewer::Dialog {
   void HandleDebugInfo(const ErrorMessageOr<std::filesystem::path>& local_file_path);
   void ChooseFile();
   void HandleSourceCode(const QString& source_file_contents);
+  void AnnotateInstructionsInBackground();
+  void HandleAnnotationProgress(size_t num_annotated_instructions);
+  void HandleAnnotationsComputed();
   void HandleAnnotations();
 
   orbit_client_protos::FunctionInfo function_info_;
@@ -89,10 +99,18 @@ class AnnotatingSourceCodeDialog : public orbit_code_viewer::Dialog {
 
   enum class ButtonAction { kNone, kChooseFile, kAddAnnotations, kHide };
   ButtonAction awaited_button_action_ = ButtonAction::kNone;
+  bool user_chose_file_ = false;
 
   std::filesystem::path local_source_file_path_;
   std::unique_ptr<orbit_object_utils::ElfFile> elf_file_;
   orbit_grpc_protos::LineInfo location_info_;
+  // While the annotator runs on `annotation_thread_pool_`, it owns `elf_file_` and only reads
+  // `report_`, so neither may be touched from the main thread until HandleAnnotationsComputed.
+  std::unique_ptr<orbit_code_report::DisassemblyAnnotator> annotator_;
+  std::atomic<bool> annotation_canceled_ = false;
+  std::shared_ptr<ThreadPool> annotation_thread_pool_ =
+      ThreadPool::Create(/*thread_pool_min_size=*/0, /*thread_pool_max_size=*/1,
+                         /*thread_ttl=*/absl::Seconds(1));
   std::vector<orbit_code_report::AnnotatingLine> annotations_;
 };
 
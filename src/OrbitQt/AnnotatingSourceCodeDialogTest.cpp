@@ -79,7 +79,8 @@ TEST(AnnotatingSourceCodeDialog, SmokeTest) {
   orbit_code_report::DisassemblyReport report{std::move(disassembler), kAddressOfMainFunction};
 
   orbit_qt::AnnotatingSourceCodeDialog dialog{};
-  auto syntax_highlighter = std::make_unique<orbit_syntax_highlighter::X86Assembly>();
+  auto syntax_highlighter =
+      std::make_unique<orbit_syntax_highlighter::X86AssemblyBlockHighlighter>();
   dialog.SetMainContent(QString::fromStdString(assembly), std::move(syntax_highlighter));
   dialog.SetDisassemblyCodeReport(std::move(report));
 
@@ -30,6 +30,7 @@ CaptureOptionsDialog::CaptureOptionsDialog(QWidget* parent)
   ui_->localMarkerDepthLineEdit->setValidator(&uint64_validator_);
   ui_->memorySamplingPeriodMsLineEdit->setValidator(new UInt64Validator(1));
   ui_->memoryWarningThresholdKbLineEdit->setValidator(&uint64_validator_);
+  ui_->functionCallCoalescingThresholdUsLineEdit->setValidator(new UInt64Validator(1));
 
   if (!absl::GetFlag(FLAGS_enable_warning_threshold)) {
     ui_->memoryWarningThresholdKbLabel->hide();
@@ -103,6 +104,35 @@ void CaptureOptionsDialog::ResetLocalMarkerDepthLineEdit() {
   }
 }
 
+void CaptureOptionsDialog::SetCoalesceFunctionCalls(bool coalesce_function_calls) {
+  ui_->functionCallCoalescingCheckBox->setChecked(coalesce_function_calls);
+}
+
+bool CaptureOptionsDialog::GetCoalesceFunctionCalls() const {
+  return ui_->functionCallCoalescingCheckBox->isChecked();
+}
+
+void CaptureOptionsDialog::SetFunctionCallCoalescingThresholdUs(
+    uint64_t function_call_coalescing_threshold_us) {
+  ui_->functionCallCoalescingThresholdUsLineEdit->setText(
+      QString::number(function_call_coalescing_threshold_us));
+}
+
+uint64_t CaptureOptionsDialog::GetFunctionCallCoalescingThresholdUs() const {
+  CHECK(!ui_->functionCallCoalescingThresholdUsLineEdit->text().isEmpty());
+  bool valid = false;
+  uint64_t result = ui_->functionCallCoalescingThresholdUsLineEdit->text().toULongLong(&valid);
+  CHECK(valid);
+  return result;
+}
+
+void CaptureOptionsDialog::ResetFunctionCallCoalescingThresholdUsLineEditWhenEmpty() {
+  if (!ui_->functionCallCoalescingThresholdUsLineEdit->text().isEmpty()) return;
+
+  ui_->functionCallCoalescingThresholdUsLineEdit->setText(
+      QString::number(kFunctionCallCoalescingThresholdUsDefaultValue));
+}
+
 void CaptureOptionsDialog::SetCollectMemoryInfo(bool collect_memory_info) {
   ui_->collectMemoryInfoCheckBox->setChecked(collect_memory_info);
 }
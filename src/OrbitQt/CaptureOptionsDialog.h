@@ -17,6 +17,10 @@
 
 namespace orbit_qt {
 
+// Default value of the function call coalescing threshold, used when no value is stored in the
+// settings and when the corresponding field of the dialog is left empty.
+constexpr uint64_t kFunctionCallCoalescingThresholdUsDefaultValue = 10;
+
 class UInt64Validator : public QValidator {
  public:
   explicit UInt64Validator(QObject* parent = nullptr) : QValidator(parent) {}
@@ -56,6 +60,10 @@ class CaptureOptionsDialog : public QDialog {
   [[nodiscard]] bool GetLimitLocalMarkerDepthPerCommandBuffer() const;
   void SetMaxLocalMarkerDepthPerCommandBuffer(uint64_t local_marker_depth_per_command_buffer);
   [[nodiscard]] uint64_t GetMaxLocalMarkerDepthPerCommandBuffer() const;
+  void SetCoalesceFunctionCalls(bool coalesce_function_calls);
+  [[nodiscard]] bool GetCoalesceFunctionCalls() const;
+  void SetFunctionCallCoalescingThresholdUs(uint64_t function_call_coalescing_threshold_us);
+  [[nodiscard]] uint64_t GetFunctionCallCoalescingThresholdUs() const;
 
   void SetCollectMemoryInfo(bool collect_memory_info);
   [[nodiscard]] bool GetCollectMemoryInfo() const;
@@ -68,6 +76,7 @@ class CaptureOptionsDialog : public QDialog {
   void ResetLocalMarkerDepthLineEdit();
   void ResetMemorySamplingPeriodMsLineEditWhenEmpty();
   void ResetMemoryWarningThresholdKbLineEditWhenEmpty();
+  void ResetFunctionCallCoalescingThresholdUsLineEditWhenEmpty();
 
  private:
   std::unique_ptr<Ui::CaptureOptionsDialog> ui_;
@@ -71,7 +71,10 @@ void OrbitGLWidget::Deinitialize(OrbitMainWindow* main_window) {
   if (main_window) {
     main_window->UnregisterGlWidget(this);
   }
+  // The canvas releases the GL resources it owns, which requires its context to be current.
+  makeCurrent();
   gl_canvas_.reset();
+  doneCurrent();
 }
 
 void OrbitGLWidget::initializeGL() {
@@ -139,6 +139,8 @@ using orbit_session_setup::TargetLabel;
 
 using orbit_data_views::DataViewType;
 
+using orbit_qt::kFunctionCallCoalescingThresholdUsDefaultValue;
+
 namespace {
 const QString kLightGrayColor = "rgb(117, 117, 117)";
 const QString kMediumGrayColor = "rgb(68, 68, 68)";
@@ -302,6 +304,7 @@ void OrbitMainWindow::SetupMainWindow() {
   app_->SetClipboardCallback([this](const std::string& text) { this->OnSetClipboard(text); });
 
   ui->CaptureGLWidget->Initialize(GlCanvas::CanvasType::kCaptureWindow, this, app_.get());
+  ui->flameGraphWidget->Initialize(GlCanvas::CanvasType::kFlameGraphWindow, this, app_.get());
 
   app_->SetTimerSelectedCallback([this](const orbit_client_protos::TimerInfo* timer_info) {
     OnTimerSelectionChanged(timer_info);
@@ -714,6 +717,7 @@ OrbitMainWindow::~OrbitMainWindow() {
     ui->debugOpenGLWidget->Deinitialize(this);
   }
 
+  ui->flameGraphWidget->Deinitialize(this);
   ui->CaptureGLWidget->Deinitialize(this);
   ui->PresetsList->Deinitialize();
   ui->FunctionsList->Deinitialize();
@@ -1002,6 +1006,9 @@ const QString OrbitMainWindow::kLimitLocalMarkerDepthPerCommandBufferSettingsKey
     "LimitLocalMarkerDepthPerCommandBuffer"};
 const QString OrbitMainWindow::kMaxLocalMarkerDepthPerCommandBufferSettingsKey{
     "MaxLocalMarkerDepthPerCommandBuffer"};
+const QString OrbitMainWindow::kCoalesceFunctionCallsSettingKey{"CoalesceFunctionCalls"};
+const QString OrbitMainWindow::kFunctionCallCoalescingThresholdUsSettingKey{
+    "FunctionCallCoalescingThresholdUs"};
 
 constexpr uint64_t kMemorySamplingPeriodMsDefaultValue = 10;
 constexpr uint64_t kMemoryWarningThresholdKbDefaultValue = 1024 * 1024 * 8;  // 8Gb
@@ -1037,6 +1044,18 @@ void OrbitMainWindow::LoadCaptureOptionsIntoApp() {
         settings.value(kMaxLocalMarkerDepthPerCommandBufferSettingsKey, 0).toULongLong();
   }
   app_->SetMaxLocalMarkerDepthPerCommandBuffer(max_local_marker_depth_per_command_buffer);
+
+  uint64_t function_call_coalescing_threshold_ns = 0;
+  if (settings.value(kCoalesceFunctionCallsSettingKey, false).toBool()) {
+    constexpr uint64_t kUsToNs = 1'000;
+    function_call_coalescing_threshold_ns =
+        settings
+            .value(kFunctionCallCoalescingThresholdUsSettingKey,
+                   QVariant::fromValue(kFunctionCallCoalescingThresholdUsDefaultValue))
+            .toULongLong() *
+        kUsToNs;
+  }
+  app_->SetFunctionCallCoalescingThresholdNs(function_call_coalescing_threshold_ns);
 }
 
 void OrbitMainWindow::on_actionCaptureOptions_triggered() {
@@ -1063,6 +1082,12 @@ void OrbitMainWindow::on_actionCaptureOptions_triggered() {
       settings.value(kLimitLocalMarkerDepthPerCommandBufferSettingsKey, false).toBool());
   dialog.SetMaxLocalMarkerDepthPerCommandBuffer(
       settings.value(kMaxLocalMarkerDepthPerCommandBufferSettingsKey, 0).toULongLong());
+  dialog.SetCoalesceFunctionCalls(settings.value(kCoalesceFunctionCallsSettingKey, false).toBool());
+  dialog.SetFunctionCallCoalescingThresholdUs(
+      settings
+          .value(kFunctionCallCoalescingThresholdUsSettingKey,
+                 QVariant::fromValue(kFunctionCallCoalescingThresholdUsDefaultValue))
+          .toULongLong());
 
   int result = dialog.exec();
   if (result != QDialog::Accepted) {
@@ -1083,6 +1108,9 @@ void OrbitMainWindow::on_actionCaptureOptions_triggered() {
                     dialog.GetLimitLocalMarkerDepthPerCommandBuffer());
   settings.setValue(kMaxLocalMarkerDepthPerCommandBufferSettingsKey,
                     QString::number(dialog.GetMaxLocalMarkerDepthPerCommandBuffer()));
+  settings.setValue(kCoalesceFunctionCallsSettingKey, dialog.GetCoalesceFunctionCalls());
+  settings.setValue(kFunctionCallCoalescingThresholdUsSettingKey,
+                    QString::number(dialog.GetFunctionCallCoalescingThresholdUs()));
   LoadCaptureOptionsIntoApp();
 }
 
@@ -1483,7 +1511,7 @@ void OrbitMainWindow::ShowSourceCode(
 
   if (!source_code.has_value()) return;
 
-  auto syntax_highlighter = std::make_unique<orbit_syntax_highlighter::Cpp>();
+  auto syntax_highlighter = std::make_unique<orbit_syntax_highlighter::CppBlockHighlighter>();
   code_viewer_dialog->SetMainContent(source_code.value(), std::move(syntax_highlighter));
   constexpr orbit_code_viewer::FontSizeInEm kHeatmapAreaWidth{1.3f};
 
@@ -1505,7 +1533,8 @@ void OrbitMainWindow::ShowDisassembly(const orbit_client_protos::FunctionInfo& f
   dialog->SetLineNumberTypes(orbit_code_viewer::Dialog::LineNumberTypes::kOnlyAnnotatingLines);
   dialog->SetHighlightCurrentLine(true);
 
-  auto syntax_highlighter = std::make_unique<orbit_syntax_highlighter::X86Assembly>();
+  auto syntax_highlighter =
+      std::make_unique<orbit_syntax_highlighter::X86AssemblyBlockHighlighter>();
   dialog->SetMainContent(QString::fromStdString(assembly), std::move(syntax_highlighter));
   uint32_t num_samples = report.GetNumSamples();
   dialog->SetDisassemblyCodeReport(std::move(report));
@@ -188,6 +188,8 @@ class OrbitMainWindow final : public QMainWindow, public orbit_gl::MainWindowInt
   static const QString kMemoryWarningThresholdKbSettingKey;
   static const QString kLimitLocalMarkerDepthPerCommandBufferSettingsKey;
   static const QString kMaxLocalMarkerDepthPerCommandBufferSettingsKey;
+  static const QString kCoalesceFunctionCallsSettingKey;
+  static const QString kFunctionCallCoalescingThresholdUsSettingKey;
   void LoadCaptureOptionsIntoApp();
 
   [[nodiscard]] bool ConfirmExit();
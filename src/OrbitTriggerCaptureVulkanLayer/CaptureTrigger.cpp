@@ -0,0 +1,100 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "CaptureTrigger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "OrbitBase/Logging.h"
+
+namespace {
+constexpr const int kCaptureClientResultSuccess = 1;
+constexpr std::chrono::steady_clock::duration kMinStartCaptureRetryInterval =
+    std::chrono::seconds{1};
+}  // namespace
+
+CaptureTrigger::CaptureTrigger(CaptureClientGgpClient* capture_client,
+                               CaptureTriggerOptions options)
+    : capture_client_{capture_client},
+      options_{std::move(options)},
+      statistics_{options_.statistics_window} {
+  CHECK(capture_client_ != nullptr);
+}
+
+size_t CaptureTrigger::GetMinFrameCountForPercentile(double percentile) {
+  if (percentile >= 100) return 1;
+  return static_cast<size_t>(std::ceil(100 / (100 - percentile)));
+}
+
+void CaptureTrigger::OnFramePresented(std::chrono::steady_clock::time_point present_time) {
+  // The time of the first frame is unknown, as is the time of the first frame after a capture,
+  // which is expected to be longer.
+  if (!last_present_time_.has_value()) {
+    last_present_time_ = present_time;
+    return;
+  }
+  const std::chrono::steady_clock::duration frame_time = present_time - last_present_time_.value();
+  last_present_time_ = present_time;
+
+  if (capture_running_) {
+    if (present_time - capture_started_time_ >= options_.capture_length) {
+      LOG("Capture has been running for %ds; stopping it",
+          std::chrono::duration_cast<std::chrono::seconds>(options_.capture_length).count());
+      StopCapture(present_time);
+    }
+    return;
+  }
+
+  statistics_.AddFrame(present_time, frame_time);
+  if (present_time < cooldown_end_time_) return;
+
+  const FrameTimeTriggerRule* rule = FindMatchingRule();
+  if (rule == nullptr) return;
+  LOG("The %.1fth percentile of the frame times (%.2fms over %u frames) exceeds the %.2fms "
+      "threshold; starting capture",
+      rule->percentile, statistics_.GetPercentileMs(rule->percentile), statistics_.GetFrameCount(),
+      rule->threshold_ms);
+  StartCapture(present_time);
+}
+
+void CaptureTrigger::Reset() {
+  capture_running_ = false;
+  last_present_time_.reset();
+  statistics_.Clear();
+}
+
+const FrameTimeTriggerRule* CaptureTrigger::FindMatchingRule() const {
+  for (const FrameTimeTriggerRule& rule : options_.rules) {
+    if (statistics_.GetFrameCount() < GetMinFrameCountForPercentile(rule.percentile)) continue;
+    if (std::isgreater(statistics_.GetPercentileMs(rule.percentile), rule.threshold_ms)) {
+      return &rule;
+    }
+  }
+  return nullptr;
+}
+
+void CaptureTrigger::StartCapture(std::chrono::steady_clock::time_point current_time) {
+  int capture_started = capture_client_->StartCapture(options_.retroactive_capture_s);
+  if (capture_started == kCaptureClientResultSuccess) {
+    capture_started_time_ = current_time;
+    capture_running_ = true;
+  } else {
+    // Don't retry on every frame while the statistics still match the rule.
+    cooldown_end_time_ = current_time + std::max(options_.cooldown, kMinStartCaptureRetryInterval);
+  }
+}
+
+void CaptureTrigger::StopCapture(std::chrono::steady_clock::time_point current_time) {
+  int capture_stopped = capture_client_->StopCapture();
+  if (capture_stopped == kCaptureClientResultSuccess) {
+    capture_running_ = false;
+    cooldown_end_time_ = current_time + options_.cooldown;
+    // The frame times during the capture, and of the next frame, are affected by the capture, so
+    // the statistics start over.
+    last_present_time_.reset();
+    statistics_.Clear();
+  }
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_CAPTURE_TRIGGER_H_
+#define ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_CAPTURE_TRIGGER_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+#include "FrameTimeStatistics.h"
+#include "OrbitCaptureGgpClient/OrbitCaptureGgpClient.h"
+
+// A capture is triggered when the given percentile of the frame times in the statistics window
+// exceeds the threshold. A percentile of 100 compares the longest frame, which triggers on a single
+// hitch, while lower percentiles trigger on sustained slowdowns.
+struct FrameTimeTriggerRule {
+  double percentile = 100;
+  double threshold_ms = 0;
+};
+
+struct CaptureTriggerOptions {
+  std::vector<FrameTimeTriggerRule> rules;
+  std::chrono::steady_clock::duration statistics_window = std::chrono::seconds{5};
+  std::chrono::steady_clock::duration capture_length = std::chrono::seconds{10};
+  // No capture is triggered for this long after a capture was stopped or failed to start.
+  std::chrono::steady_clock::duration cooldown = std::chrono::seconds{0};
+  // How much of the time before the trigger the capture should contain, if the service supports it.
+  uint32_t retroactive_capture_s = 0;
+};
+
+// Decides, from the time of each frame, when to start and stop Orbit captures through the given
+// client.
+class CaptureTrigger {
+ public:
+  CaptureTrigger(CaptureClientGgpClient* capture_client, CaptureTriggerOptions options);
+
+  // To be called once per frame, with the time at which the frame was presented.
+  void OnFramePresented(std::chrono::steady_clock::time_point present_time);
+  // Stops tracking the frame times and forgets them, e.g. when the capture service is shut down.
+  void Reset();
+
+  [[nodiscard]] bool IsCaptureRunning() const { return capture_running_; }
+  [[nodiscard]] const FrameTimeStatistics& GetStatistics() const { return statistics_; }
+
+  // The number of frames in the window that is needed for `percentile` to be meaningful, e.g. 100
+  // frames for the 99th percentile.
+  [[nodiscard]] static size_t GetMinFrameCountForPercentile(double percentile);
+
+ private:
+  // Returns the first rule that the current statistics match, if any.
+  [[nodiscard]] const FrameTimeTriggerRule* FindMatchingRule() const;
+  void StartCapture(std::chrono::steady_clock::time_point current_time);
+  void StopCapture(std::chrono::steady_clock::time_point current_time);
+
+  CaptureClientGgpClient* capture_client_;
+  CaptureTriggerOptions options_;
+  FrameTimeStatistics statistics_;
+  bool capture_running_ = false;
+  std::optional<std::chrono::steady_clock::time_point> last_present_time_;
+  std::chrono::steady_clock::time_point capture_started_time_;
+  std::chrono::steady_clock::time_point cooldown_end_time_;
+};
+
+#endif  // ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_CAPTURE_TRIGGER_H_
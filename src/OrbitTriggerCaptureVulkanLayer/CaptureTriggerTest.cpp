@@ -0,0 +1,204 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CaptureTrigger.h"
+#include "OrbitCaptureGgpClient/OrbitCaptureGgpClient.h"
+
+namespace {
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+constexpr int kCaptureClientResultSuccess = 1;
+constexpr int kCaptureClientResultFailure = 0;
+
+// Records the calls of the `CaptureTrigger` instead of calling an OrbitCaptureGgpService.
+class FakeCaptureClientGgpClient : public CaptureClientGgpClient {
+ public:
+  int StartCapture(uint32_t retroactive_capture_s) override {
+    start_capture_times.push_back(*current_time);
+    last_retroactive_capture_s = retroactive_capture_s;
+    if (start_capture_result == kCaptureClientResultSuccess) {
+      EXPECT_FALSE(capture_running);
+      capture_running = true;
+    }
+    return start_capture_result;
+  }
+  int StopCapture() override {
+    EXPECT_TRUE(capture_running);
+    capture_running = false;
+    stop_capture_times.push_back(*current_time);
+    return kCaptureClientResultSuccess;
+  }
+  int UpdateSelectedFunctions(const std::vector<std::string>& /*selected_functions*/) override {
+    return kCaptureClientResultSuccess;
+  }
+  void ShutdownService() override {}
+
+  const steady_clock::time_point* current_time = nullptr;
+  int start_capture_result = kCaptureClientResultSuccess;
+  bool capture_running = false;
+  uint32_t last_retroactive_capture_s = 0;
+  std::vector<steady_clock::time_point> start_capture_times;
+  std::vector<steady_clock::time_point> stop_capture_times;
+};
+
+// Replays a synthetic trace of frame times to a `CaptureTrigger` using the fake client.
+class CaptureTriggerTest : public ::testing::Test {
+ protected:
+  void CreateTrigger(CaptureTriggerOptions options) {
+    client_.current_time = &time_;
+    trigger_ = std::make_unique<CaptureTrigger>(&client_, std::move(options));
+    trigger_->OnFramePresented(time_);
+  }
+
+  void PresentFrames(steady_clock::duration frame_time, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      time_ += frame_time;
+      trigger_->OnFramePresented(time_);
+    }
+  }
+
+  // Presents frames of `frame_time` until `duration` has passed.
+  void PresentFramesFor(steady_clock::duration frame_time, steady_clock::duration duration) {
+    PresentFrames(frame_time, duration / frame_time);
+  }
+
+  [[nodiscard]] double SecondsSinceStart(steady_clock::time_point time) const {
+    return std::chrono::duration<double>(time - steady_clock::time_point{}).count();
+  }
+
+  steady_clock::time_point time_;
+  FakeCaptureClientGgpClient client_;
+  std::unique_ptr<CaptureTrigger> trigger_;
+};
+}  // namespace
+
+TEST_F(CaptureTriggerTest, SingleLongFrameTriggersCaptureOfCaptureLength) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{100, 20}};
+  options.capture_length = seconds{10};
+  CreateTrigger(std::move(options));
+
+  PresentFramesFor(milliseconds{16}, seconds{5});
+  EXPECT_TRUE(client_.start_capture_times.empty());
+
+  PresentFrames(milliseconds{50}, 1);
+  ASSERT_EQ(client_.start_capture_times.size(), 1);
+  EXPECT_TRUE(trigger_->IsCaptureRunning());
+
+  PresentFramesFor(milliseconds{16}, milliseconds{9'900});
+  EXPECT_TRUE(client_.stop_capture_times.empty());
+  PresentFramesFor(milliseconds{16}, milliseconds{200});
+  ASSERT_EQ(client_.stop_capture_times.size(), 1);
+  EXPECT_FALSE(trigger_->IsCaptureRunning());
+  EXPECT_GE(client_.stop_capture_times[0] - client_.start_capture_times[0], seconds{10});
+  EXPECT_EQ(client_.last_retroactive_capture_s, 0);
+}
+
+TEST_F(CaptureTriggerTest, PercentileRuleTriggersOnGradualRegressionButNotOnSpikes) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{95, 20}};
+  options.statistics_window = seconds{5};
+  CreateTrigger(std::move(options));
+
+  // Isolated spikes don't move the 95th percentile.
+  for (int i = 0; i < 10; ++i) {
+    PresentFramesFor(milliseconds{16}, seconds{1});
+    PresentFrames(milliseconds{100}, 1);
+  }
+  EXPECT_TRUE(client_.start_capture_times.empty());
+
+  // The frame time slowly increases by 0.1ms per second, until the capture starts.
+  for (int i = 0; i < 100 && client_.start_capture_times.empty(); ++i) {
+    PresentFramesFor(std::chrono::microseconds{16'000 + 100 * i}, seconds{1});
+  }
+  ASSERT_EQ(client_.start_capture_times.size(), 1);
+  // The frame time exceeds 20ms after 40s, and the capture starts as soon as more than 5% of the
+  // frames of the window do.
+  EXPECT_GT(SecondsSinceStart(client_.start_capture_times[0]), 10 + 40);
+  EXPECT_LT(SecondsSinceStart(client_.start_capture_times[0]), 10 + 45);
+}
+
+TEST_F(CaptureTriggerTest, PercentileRuleNeedsEnoughFrames) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{99, 20}};
+  options.statistics_window = seconds{10};
+  CreateTrigger(std::move(options));
+
+  EXPECT_EQ(CaptureTrigger::GetMinFrameCountForPercentile(99), 100);
+  PresentFrames(milliseconds{30}, 99);
+  EXPECT_TRUE(client_.start_capture_times.empty());
+  PresentFrames(milliseconds{30}, 1);
+  EXPECT_EQ(client_.start_capture_times.size(), 1);
+}
+
+TEST_F(CaptureTriggerTest, CooldownAvoidsRepeatedCapturesOnLoadingScreen) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{100, 50}};
+  options.capture_length = seconds{2};
+  options.cooldown = seconds{30};
+  CreateTrigger(std::move(options));
+
+  // A loading screen with a long frame every second, for one minute.
+  for (int i = 0; i < 60; ++i) {
+    PresentFramesFor(milliseconds{16}, milliseconds{800});
+    PresentFrames(milliseconds{200}, 1);
+  }
+
+  ASSERT_EQ(client_.start_capture_times.size(), 2);
+  ASSERT_GE(client_.stop_capture_times.size(), 1);
+  EXPECT_GE(client_.start_capture_times[1] - client_.stop_capture_times[0], seconds{30});
+}
+
+TEST_F(CaptureTriggerTest, FailedStartIsNotRetriedOnEveryFrame) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{100, 20}};
+  CreateTrigger(std::move(options));
+  client_.start_capture_result = kCaptureClientResultFailure;
+
+  PresentFramesFor(milliseconds{50}, milliseconds{3'500});
+  EXPECT_EQ(client_.start_capture_times.size(), 4);
+  EXPECT_FALSE(trigger_->IsCaptureRunning());
+
+  client_.start_capture_result = kCaptureClientResultSuccess;
+  PresentFramesFor(milliseconds{50}, seconds{1});
+  EXPECT_EQ(client_.start_capture_times.size(), 5);
+  EXPECT_TRUE(trigger_->IsCaptureRunning());
+}
+
+TEST_F(CaptureTriggerTest, RequestsRetroactiveCapture) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{100, 20}};
+  options.retroactive_capture_s = 7;
+  CreateTrigger(std::move(options));
+
+  PresentFrames(milliseconds{50}, 2);
+  ASSERT_EQ(client_.start_capture_times.size(), 1);
+  EXPECT_EQ(client_.last_retroactive_capture_s, 7);
+}
+
+TEST_F(CaptureTriggerTest, ResetForgetsFrameTimes) {
+  CaptureTriggerOptions options;
+  options.rules = {FrameTimeTriggerRule{50, 20}};
+  CreateTrigger(std::move(options));
+
+  PresentFrames(milliseconds{30}, 1);
+  EXPECT_EQ(trigger_->GetStatistics().GetFrameCount(), 1);
+  trigger_->Reset();
+  EXPECT_EQ(trigger_->GetStatistics().GetFrameCount(), 0);
+
+  // The first frame after the reset has no known start, so it is not counted.
+  PresentFrames(milliseconds{30}, 1);
+  EXPECT_EQ(trigger_->GetStatistics().GetFrameCount(), 0);
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "FrameTimeStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "OrbitBase/Logging.h"
+
+FrameTimeStatistics::FrameTimeStatistics(std::chrono::steady_clock::duration window)
+    : window_{window},
+      gamma_{(1 + kRelativeAccuracy) / (1 - kRelativeAccuracy)},
+      log_gamma_{std::log(gamma_)} {
+  bucket_counts_.resize(GetBucketIndex(kMaxFrameTimeMs) + 1, 0);
+}
+
+void FrameTimeStatistics::AddFrame(std::chrono::steady_clock::time_point frame_end_time,
+                                   std::chrono::steady_clock::duration frame_time) {
+  const double frame_time_ms =
+      std::chrono::duration<double, std::milli>(frame_time).count();
+  const Frame frame{frame_end_time, frame_time_ms, GetBucketIndex(frame_time_ms)};
+
+  frames_.push_back(frame);
+  ++bucket_counts_[frame.bucket_index];
+  while (!max_candidates_.empty() && max_candidates_.back().frame_time_ms <= frame_time_ms) {
+    max_candidates_.pop_back();
+  }
+  max_candidates_.push_back(frame);
+
+  // Frames are added in order of their end time, so the ones that left the window are in front.
+  while (frames_.front().end_time + window_ <= frame_end_time) {
+    --bucket_counts_[frames_.front().bucket_index];
+    if (max_candidates_.front().end_time == frames_.front().end_time) {
+      max_candidates_.pop_front();
+    }
+    frames_.pop_front();
+  }
+}
+
+void FrameTimeStatistics::Clear() {
+  frames_.clear();
+  max_candidates_.clear();
+  std::fill(bucket_counts_.begin(), bucket_counts_.end(), 0);
+}
+
+double FrameTimeStatistics::GetPercentileMs(double percentile) const {
+  if (frames_.empty()) return 0;
+  if (percentile >= 100) return GetMaxMs();
+
+  // The nearest rank: the smallest frame time that `percentile` percent of the frames don't exceed.
+  const auto rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percentile / 100 * static_cast<double>(frames_.size()))));
+  uint64_t count = 0;
+  for (size_t bucket_index = 0; bucket_index < bucket_counts_.size(); ++bucket_index) {
+    count += bucket_counts_[bucket_index];
+    if (count >= rank) return GetBucketValue(bucket_index);
+  }
+  UNREACHABLE();
+}
+
+double FrameTimeStatistics::GetMaxMs() const {
+  if (max_candidates_.empty()) return 0;
+  return max_candidates_.front().frame_time_ms;
+}
+
+// The bucket with index i contains the frame times in (kMinFrameTimeMs * gamma^(i-1),
+// kMinFrameTimeMs * gamma^i], and bucket 0 also all the shorter ones.
+size_t FrameTimeStatistics::GetBucketIndex(double frame_time_ms) const {
+  const double clamped_frame_time_ms = std::clamp(frame_time_ms, kMinFrameTimeMs, kMaxFrameTimeMs);
+  return static_cast<size_t>(
+      std::max(0.0, std::ceil(std::log(clamped_frame_time_ms / kMinFrameTimeMs) / log_gamma_)));
+}
+
+double FrameTimeStatistics::GetBucketValue(size_t bucket_index) const {
+  // This is within kRelativeAccuracy of both bounds of the bucket.
+  return kMinFrameTimeMs * 2 * std::pow(gamma_, static_cast<double>(bucket_index)) / (gamma_ + 1);
+}
@@ -0,0 +1,61 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_FRAME_TIME_STATISTICS_H_
+#define ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_FRAME_TIME_STATISTICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+// Rolling statistics of the times of the frames that ended during the last `window` of time.
+//
+// Percentiles are estimated with a histogram of logarithmically sized buckets, as in the DDSketch
+// streaming sketch: any estimate is within `kRelativeAccuracy` of an actual frame time, and adding
+// a frame or querying a percentile costs the same however high the frame rate is. The maximum is
+// tracked exactly, so that a single long frame can be compared with a threshold as is.
+class FrameTimeStatistics {
+ public:
+  static constexpr double kRelativeAccuracy = 0.01;
+  // Frame times outside of this range are clamped into it for the percentile estimates.
+  static constexpr double kMinFrameTimeMs = 0.1;
+  static constexpr double kMaxFrameTimeMs = 10'000.0;
+
+  explicit FrameTimeStatistics(std::chrono::steady_clock::duration window);
+
+  void AddFrame(std::chrono::steady_clock::time_point frame_end_time,
+                std::chrono::steady_clock::duration frame_time);
+  void Clear();
+
+  [[nodiscard]] size_t GetFrameCount() const { return frames_.size(); }
+  // Returns the estimated time, in milliseconds, that at least `percentile` percent of the frames
+  // in the window did not exceed. A `percentile` of 100 returns the exact maximum. Returns 0 if
+  // there is no frame in the window.
+  [[nodiscard]] double GetPercentileMs(double percentile) const;
+  [[nodiscard]] double GetMaxMs() const;
+
+ private:
+  struct Frame {
+    std::chrono::steady_clock::time_point end_time;
+    double frame_time_ms;
+    size_t bucket_index;
+  };
+
+  [[nodiscard]] size_t GetBucketIndex(double frame_time_ms) const;
+  [[nodiscard]] double GetBucketValue(size_t bucket_index) const;
+
+  std::chrono::steady_clock::duration window_;
+  double gamma_;
+  double log_gamma_;
+  std::deque<Frame> frames_;
+  std::vector<uint32_t> bucket_counts_;
+  // The frames that are longer than all the frames that ended after them, which are the only
+  // candidates to be the maximum of the window. The front is the current maximum.
+  std::deque<Frame> max_candidates_;
+};
+
+#endif  // ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_FRAME_TIME_STATISTICS_H_
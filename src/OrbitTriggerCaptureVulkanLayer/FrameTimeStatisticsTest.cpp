@@ -0,0 +1,83 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "FrameTimeStatistics.h"
+
+namespace {
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+using std::chrono::steady_clock;
+
+// Adds frames of the given time back to back, starting at `*time`, which is advanced.
+void AddFrames(FrameTimeStatistics* statistics, steady_clock::time_point* time,
+               steady_clock::duration frame_time, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    *time += frame_time;
+    statistics->AddFrame(*time, frame_time);
+  }
+}
+}  // namespace
+
+TEST(FrameTimeStatistics, EmptyStatistics) {
+  FrameTimeStatistics statistics{seconds{1}};
+  EXPECT_EQ(statistics.GetFrameCount(), 0);
+  EXPECT_EQ(statistics.GetPercentileMs(50), 0);
+  EXPECT_EQ(statistics.GetMaxMs(), 0);
+}
+
+TEST(FrameTimeStatistics, PercentilesAreWithinRelativeAccuracy) {
+  FrameTimeStatistics statistics{seconds{100}};
+  steady_clock::time_point time;
+  // One frame of each time from 1ms to 100ms.
+  for (int frame_time_ms = 1; frame_time_ms <= 100; ++frame_time_ms) {
+    AddFrames(&statistics, &time, milliseconds{frame_time_ms}, 1);
+  }
+  ASSERT_EQ(statistics.GetFrameCount(), 100);
+
+  for (double percentile : {1.0, 10.0, 50.0, 90.0, 95.0, 99.0}) {
+    EXPECT_NEAR(statistics.GetPercentileMs(percentile), percentile,
+                percentile * FrameTimeStatistics::kRelativeAccuracy);
+  }
+  EXPECT_EQ(statistics.GetPercentileMs(100), 100);
+  EXPECT_EQ(statistics.GetMaxMs(), 100);
+}
+
+TEST(FrameTimeStatistics, FramesLeaveTheWindow) {
+  FrameTimeStatistics statistics{seconds{1}};
+  steady_clock::time_point time;
+  AddFrames(&statistics, &time, milliseconds{100}, 1);
+  AddFrames(&statistics, &time, milliseconds{10}, 50);
+  EXPECT_EQ(statistics.GetMaxMs(), 100);
+  EXPECT_EQ(statistics.GetFrameCount(), 51);
+
+  // After one more second of 10ms frames, the long frame is out of the window.
+  AddFrames(&statistics, &time, milliseconds{10}, 100);
+  EXPECT_EQ(statistics.GetFrameCount(), 100);
+  EXPECT_EQ(statistics.GetMaxMs(), 10);
+  EXPECT_NEAR(statistics.GetPercentileMs(99), 10, 10 * FrameTimeStatistics::kRelativeAccuracy);
+
+  statistics.Clear();
+  EXPECT_EQ(statistics.GetFrameCount(), 0);
+  EXPECT_EQ(statistics.GetMaxMs(), 0);
+  AddFrames(&statistics, &time, milliseconds{20}, 1);
+  EXPECT_EQ(statistics.GetMaxMs(), 20);
+}
+
+TEST(FrameTimeStatistics, FrameTimesOutOfRangeAreClamped) {
+  FrameTimeStatistics statistics{seconds{1'000}};
+  steady_clock::time_point time;
+  AddFrames(&statistics, &time, std::chrono::microseconds{1}, 1);
+  AddFrames(&statistics, &time, seconds{100}, 1);
+
+  EXPECT_NEAR(statistics.GetPercentileMs(50), FrameTimeStatistics::kMinFrameTimeMs,
+              FrameTimeStatistics::kMinFrameTimeMs * FrameTimeStatistics::kRelativeAccuracy);
+  EXPECT_NEAR(statistics.GetPercentileMs(99), FrameTimeStatistics::kMaxFrameTimeMs,
+              FrameTimeStatistics::kMaxFrameTimeMs * FrameTimeStatistics::kRelativeAccuracy);
+  // The maximum is not affected.
+  EXPECT_EQ(statistics.GetMaxMs(), 100'000);
+}
@@ -6,12 +6,11 @@
 
 #include <unistd.h>
 
-#include <algorithm>
 #include <chrono>
-#include <cmath>
 #include <cstdint>
-#include <ratio>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "OrbitBase/Logging.h"
@@ -19,7 +18,6 @@
 #include "absl/strings/str_format.h"
 
 namespace {
-constexpr const int kCaptureClientResultSuccess = 1;
 constexpr uint16_t kGrpcPort = 44767;
 }  // namespace
 
@@ -68,6 +66,17 @@ void LayerLogic::Init() {
     ggp_capture_client_ =
         std::unique_ptr<CaptureClientGgpClient>(new CaptureClientGgpClient(grpc_server_address));
 
+    CaptureTriggerOptions capture_trigger_options;
+    capture_trigger_options.rules = layer_options_.GetFrameTimeTriggerRules();
+    capture_trigger_options.statistics_window =
+        std::chrono::seconds{layer_options_.GetStatisticsWindowSeconds()};
+    capture_trigger_options.capture_length =
+        std::chrono::seconds{layer_options_.GetCaptureLengthSeconds()};
+    capture_trigger_options.cooldown = std::chrono::seconds{layer_options_.GetCooldownSeconds()};
+    capture_trigger_options.retroactive_capture_s = layer_options_.GetRetroactiveCaptureSeconds();
+    capture_trigger_ = std::make_unique<CaptureTrigger>(ggp_capture_client_.get(),
+                                                        std::move(capture_trigger_options));
+
     data_initialized_ = true;
   }
 }
@@ -75,60 +84,15 @@ void LayerLogic::Init() {
 void LayerLogic::Destroy() {
   if (data_initialized_) {
     ggp_capture_client_->ShutdownService();
+    capture_trigger_->Reset();
     data_initialized_ = false;
-    orbit_capture_running_ = false;
-    skip_logic_call_ = true;
   }
 }
 
-// QueuePresentKHR is called once per frame so we can calculate the time per frame. When this value
-// is higher than a certain threshold, an Orbit capture is started and runs during a certain period
-// of time; after which is stopped and saved.
+// QueuePresentKHR is called once per frame so we can calculate the time per frame. When the frame
+// times match a trigger rule, an Orbit capture is started and runs during a certain period of time;
+// after which is stopped and saved.
 void LayerLogic::ProcessQueuePresentKHR() {
-  std::chrono::steady_clock::time_point current_time = std::chrono::steady_clock::now();
-  // Ignore logic on the first call because times are not initialized. Also skipped right after a
-  // capture has been stopped
-  if (skip_logic_call_) {
-    skip_logic_call_ = false;
-    last_frame_time_ = current_time;
-    return;
-  }
-
-  if (!orbit_capture_running_) {
-    auto frame_time = std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
-        current_time - last_frame_time_);
-    if (std::isgreater(frame_time.count(), layer_options_.GetFrameTimeThresholdMilliseconds())) {
-      LOG("Time frame is %fms and exceeds the %fms threshold; starting capture", frame_time.count(),
-          layer_options_.GetFrameTimeThresholdMilliseconds());
-      RunCapture();
-    }
-  } else {
-    // Stop capture if it has been running long enough
-    auto capture_time = std::chrono::duration_cast<std::chrono::duration<int64_t>>(
-        current_time - capture_started_time_);
-    if (capture_time.count() >= layer_options_.GetCaptureLengthSeconds()) {
-      LOG("Capture has been running for %ds; stopping it",
-          layer_options_.GetCaptureLengthSeconds());
-      StopCapture();
-    }
-  }
-
-  last_frame_time_ = current_time;
-}
-
-void LayerLogic::RunCapture() {
-  int capture_started = ggp_capture_client_->StartCapture();
-  if (capture_started == kCaptureClientResultSuccess) {
-    capture_started_time_ = std::chrono::steady_clock::now();
-    orbit_capture_running_ = true;
-  }
-}
-
-void LayerLogic::StopCapture() {
-  int capture_stopped = ggp_capture_client_->StopCapture();
-  if (capture_stopped == kCaptureClientResultSuccess) {
-    orbit_capture_running_ = false;
-    // The frame time is expected to be longer the next call so we skip the check
-    skip_logic_call_ = true;
-  }
+  if (!data_initialized_) return;
+  capture_trigger_->OnFramePresented(std::chrono::steady_clock::now());
 }
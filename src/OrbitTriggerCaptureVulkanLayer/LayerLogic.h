@@ -9,16 +9,17 @@
 #include <memory>
 #include <string>
 
+#include "CaptureTrigger.h"
 #include "LayerOptions.h"
 #include "OrbitCaptureGgpClient/OrbitCaptureGgpClient.h"
 #include "layer_config.pb.h"
 
 // Contains the logic of the OrbitTriggerCaptureVulkanLayer to run Orbit captures automatically when
-// the time per frame is higher than a certain threshold. It also instantiates the classes and
-// variables needed for this so the layer itself is transparent to it.
+// the frame times exceed the thresholds of the trigger rules, see `CaptureTrigger`. It also
+// instantiates the classes and variables needed for this so the layer itself is transparent to it.
 class LayerLogic {
  public:
-  LayerLogic() : data_initialized_{false}, orbit_capture_running_{false}, skip_logic_call_{true} {}
+  LayerLogic() : data_initialized_{false} {}
 
   void Init();
   void Destroy();
@@ -26,16 +27,11 @@ class LayerLogic {
 
  private:
   bool data_initialized_;
-  bool orbit_capture_running_;
-  bool skip_logic_call_;
   std::unique_ptr<CaptureClientGgpClient> ggp_capture_client_;
-  std::chrono::steady_clock::time_point last_frame_time_;
-  std::chrono::steady_clock::time_point capture_started_time_;
+  std::unique_ptr<CaptureTrigger> capture_trigger_;
   LayerOptions layer_options_;
 
   void StartOrbitCaptureService();
-  void RunCapture();
-  void StopCapture();
 };
 
 #endif  // ORBIT_TRIGGER_CAPTURE_VULKAN_LAYER_LAYER_LOGIC_H_
@@ -28,6 +28,7 @@ constexpr char const* kOrbitCaptureService = "/mnt/developer/OrbitCaptureGgpServ
 constexpr char const* kLogDirectory = "/var/game/";
 constexpr double kFrameTimeThresholdMillisecondsDefault = 1000.0 / 60.0;
 constexpr uint32_t kCaptureLengthSecondsDefault = 10;
+constexpr uint32_t kStatisticsWindowSecondsDefault = 5;
 }  // namespace
 
 void LayerOptions::Init() {
@@ -69,6 +70,41 @@ uint32_t LayerOptions::GetCaptureLengthSeconds() {
   return kCaptureLengthSecondsDefault;
 }
 
+std::vector<FrameTimeTriggerRule> LayerOptions::GetFrameTimeTriggerRules() {
+  std::vector<FrameTimeTriggerRule> rules;
+  if (layer_config_.has_layer_options()) {
+    for (const auto& rule : layer_config_.layer_options().trigger_rules()) {
+      if (rule.percentile() <= 0 || rule.percentile() > 100 || rule.threshold_ms() <= 0) {
+        ERROR("Ignoring trigger rule with percentile %f and threshold %fms", rule.percentile(),
+              rule.threshold_ms());
+        continue;
+      }
+      rules.push_back(FrameTimeTriggerRule{rule.percentile(), rule.threshold_ms()});
+    }
+  }
+  // By default, a capture is triggered by a single frame exceeding the threshold.
+  if (rules.empty()) {
+    rules.push_back(FrameTimeTriggerRule{100, GetFrameTimeThresholdMilliseconds()});
+  }
+  return rules;
+}
+
+uint32_t LayerOptions::GetStatisticsWindowSeconds() {
+  if (layer_config_.has_layer_options() &&
+      layer_config_.layer_options().statistics_window_s() > 0) {
+    return layer_config_.layer_options().statistics_window_s();
+  }
+  return kStatisticsWindowSecondsDefault;
+}
+
+uint32_t LayerOptions::GetCooldownSeconds() {
+  return layer_config_.layer_options().cooldown_s();
+}
+
+uint32_t LayerOptions::GetRetroactiveCaptureSeconds() {
+  return layer_config_.layer_options().retroactive_capture_s();
+}
+
 std::vector<std::string> LayerOptions::BuildOrbitCaptureServiceArgv(const std::string& game_pid) {
   std::vector<std::string> argv;
 
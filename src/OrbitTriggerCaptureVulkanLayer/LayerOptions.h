@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 
+#include "CaptureTrigger.h"
 #include "layer_config.pb.h"
 
 // Reads the config file into a proto to be used in the layer.
@@ -18,6 +19,10 @@ class LayerOptions {
   void Init();
   double GetFrameTimeThresholdMilliseconds();
   uint32_t GetCaptureLengthSeconds();
+  std::vector<FrameTimeTriggerRule> GetFrameTimeTriggerRules();
+  uint32_t GetStatisticsWindowSeconds();
+  uint32_t GetCooldownSeconds();
+  uint32_t GetRetroactiveCaptureSeconds();
   std::vector<std::string> BuildOrbitCaptureServiceArgv(const std::string&);
 
  private:
@@ -5,17 +5,27 @@
 #ifndef ORBIT_SERVICE_CAPTURE_EVENT_BUFFER_H_
 #define ORBIT_SERVICE_CAPTURE_EVENT_BUFFER_H_
 
+#include <utility>
+#include <vector>
+
 #include "capture.pb.h"
 
 namespace orbit_service {
 
 // Interface used to buffer CaptureEvents so that multiple CaptureEvents
 // can be processed at the same time (e.g., grouped into fewer bigger CaptureResponses).
-// AddEvent is to be assumed thread safe.
+// AddEvent and AddEvents are to be assumed thread safe.
 class CaptureEventBuffer {
  public:
   virtual ~CaptureEventBuffer() = default;
   virtual void AddEvent(orbit_grpc_protos::ClientCaptureEvent&& event) = 0;
+  // Implementations should override this when adding several events at once is cheaper than adding
+  // them one by one, e.g., because a lock is taken only once.
+  virtual void AddEvents(std::vector<orbit_grpc_protos::ClientCaptureEvent>&& events) {
+    for (orbit_grpc_protos::ClientCaptureEvent& event : events) {
+      AddEvent(std::move(event));
+    }
+  }
 };
 
 }  // namespace orbit_service
@@ -5,12 +5,16 @@
 #include "CaptureServiceImpl.h"
 
 #include <absl/container/flat_hash_set.h>
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
 #include <absl/synchronization/mutex.h>
+#include <absl/time/clock.h>
 #include <absl/time/time.h>
 #include <pthread.h>
 #include <stdint.h>
 
 #include <algorithm>
+#include <iterator>
 #include <limits>
 #include <thread>
 #include <utility>
@@ -30,6 +34,8 @@
 #include "ProducerEventProcessor.h"
 #include "capture.pb.h"
 
+ABSL_DECLARE_FLAG(bool, pre_arm_perf_events);
+
 namespace orbit_service {
 
 using orbit_grpc_protos::CaptureFinished;
@@ -59,6 +65,19 @@ class SenderThreadCaptureEventBuffer final : public CaptureEventBuffer {
     event_buffer_.emplace_back(std::move(event));
   }
 
+  void AddEvents(std::vector<ClientCaptureEvent>&& events) override {
+    absl::MutexLock lock{&event_buffer_mutex_};
+    if (stop_requested_) {
+      return;
+    }
+    if (event_buffer_.empty()) {
+      event_buffer_ = std::move(events);
+      return;
+    }
+    event_buffer_.insert(event_buffer_.end(), std::make_move_iterator(events.begin()),
+                         std::make_move_iterator(events.end()));
+  }
+
   void StopAndWait() {
     CHECK(sender_thread_.joinable());
     {
@@ -319,7 +338,8 @@ grpc::Status CaptureServiceImpl::Capture(
                                          std::move(error_enabling_orbit_api.value())));
   }
 
-  tracing_handler.Start(capture_options);
+  const bool pre_arm_perf_events = absl::GetFlag(FLAGS_pre_arm_perf_events);
+  tracing_handler.Start(capture_options, TakeArmedTracer(), pre_arm_perf_events);
 
   memory_info_handler.Start(request.capture_options());
   for (CaptureStartStopListener* listener : capture_start_stop_listeners_) {
@@ -348,6 +368,9 @@ grpc::Status CaptureServiceImpl::Capture(
 
   StopInternalProducersAndCaptureStartStopListenersInParallel(
       &tracing_handler, &memory_info_handler, &capture_start_stop_listeners_);
+  if (pre_arm_perf_events) {
+    KeepArmedTracer(tracing_handler.ReleaseArmedTracer());
+  }
 
   capture_event_buffer.AddEvent(CreateCaptureFinishedEvent());
 
@@ -357,6 +380,64 @@ grpc::Status CaptureServiceImpl::Capture(
   return grpc::Status::OK;
 }
 
+CaptureServiceImpl::~CaptureServiceImpl() {
+  {
+    absl::MutexLock lock{&armed_tracer_mutex_};
+    disarm_idle_tracer_thread_exit_requested_ = true;
+  }
+  if (disarm_idle_tracer_thread_.joinable()) {
+    disarm_idle_tracer_thread_.join();
+  }
+}
+
+void CaptureServiceImpl::KeepArmedTracer(std::unique_ptr<orbit_linux_tracing::Tracer> tracer) {
+  if (tracer == nullptr) return;
+  absl::MutexLock lock{&armed_tracer_mutex_};
+  armed_tracer_ = std::move(tracer);
+  armed_tracer_idle_since_ = absl::Now();
+  if (!disarm_idle_tracer_thread_.joinable()) {
+    disarm_idle_tracer_thread_ = std::thread{[this] { DisarmIdleTracerThread(); }};
+  }
+}
+
+std::unique_ptr<orbit_linux_tracing::Tracer> CaptureServiceImpl::TakeArmedTracer() {
+  absl::MutexLock lock{&armed_tracer_mutex_};
+  return std::move(armed_tracer_);
+}
+
+void CaptureServiceImpl::DisarmIdleTracerThread() {
+  pthread_setname_np(pthread_self(), "DisarmIdleTrcr");
+  absl::MutexLock lock{&armed_tracer_mutex_};
+  while (!disarm_idle_tracer_thread_exit_requested_) {
+    if (armed_tracer_ == nullptr) {
+      armed_tracer_mutex_.Await(absl::Condition(
+          +[](CaptureServiceImpl* self) {
+            return self->armed_tracer_ != nullptr ||
+                   self->disarm_idle_tracer_thread_exit_requested_;
+          },
+          this));
+      continue;
+    }
+
+    const absl::Time deadline = armed_tracer_idle_since_ + kArmedTracerIdleTimeout;
+    if (absl::Now() >= deadline) {
+      LOG("Closing the armed perf_event_open file descriptors, unused for %s",
+          absl::FormatDuration(kArmedTracerIdleTimeout));
+      armed_tracer_.reset();
+      continue;
+    }
+    // Also wakes up when a capture takes the Tracer, after which the deadline changes.
+    armed_tracer_mutex_.AwaitWithDeadline(
+        absl::Condition(
+            +[](CaptureServiceImpl* self) {
+              return self->armed_tracer_ == nullptr ||
+                     self->disarm_idle_tracer_thread_exit_requested_;
+            },
+            this),
+        deadline);
+  }
+}
+
 void CaptureServiceImpl::AddCaptureStartStopListener(CaptureStartStopListener* listener) {
   bool new_insertion = capture_start_stop_listeners_.insert(listener).second;
   CHECK(new_insertion);
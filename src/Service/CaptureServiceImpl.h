@@ -5,11 +5,17 @@
 #ifndef ORBIT_SERVICE_CAPTURE_SERVICE_IMPL_H_
 #define ORBIT_SERVICE_CAPTURE_SERVICE_IMPL_H_
 
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
 #include <grpcpp/grpcpp.h>
 
 #include <atomic>
+#include <memory>
+#include <thread>
 
 #include "CaptureStartStopListener.h"
+#include "LinuxTracing/Tracer.h"
 #include "OrbitBase/Logging.h"
 #include "OrbitBase/Profiling.h"
 #include "absl/container/flat_hash_set.h"
@@ -24,6 +30,7 @@ class CaptureServiceImpl final : public orbit_grpc_protos::CaptureService::Servi
     // We want to estimate clock resolution once, not at the beginning of every capture.
     EstimateAndLogClockResolution();
   }
+  ~CaptureServiceImpl() override;
 
   grpc::Status Capture(
       grpc::ServerContext* context,
@@ -37,6 +44,21 @@ class CaptureServiceImpl final : public orbit_grpc_protos::CaptureService::Servi
   std::atomic<bool> is_capturing = false;
   absl::flat_hash_set<CaptureStartStopListener*> capture_start_stop_listeners_;
 
+  // With --pre_arm_perf_events, the Tracer of the last capture, whose perf_event_open file
+  // descriptors are kept open but disabled, to be reused by the next capture with the same options.
+  // If no capture takes it within kArmedTracerIdleTimeout, DisarmIdleTracerThread destroys it, so
+  // that the file descriptors, ring buffers and u(ret)probes are not held indefinitely.
+  void KeepArmedTracer(std::unique_ptr<orbit_linux_tracing::Tracer> tracer);
+  [[nodiscard]] std::unique_ptr<orbit_linux_tracing::Tracer> TakeArmedTracer();
+  void DisarmIdleTracerThread();
+
+  static constexpr absl::Duration kArmedTracerIdleTimeout = absl::Minutes(10);
+  absl::Mutex armed_tracer_mutex_;
+  std::unique_ptr<orbit_linux_tracing::Tracer> armed_tracer_ ABSL_GUARDED_BY(armed_tracer_mutex_);
+  absl::Time armed_tracer_idle_since_ ABSL_GUARDED_BY(armed_tracer_mutex_);
+  bool disarm_idle_tracer_thread_exit_requested_ ABSL_GUARDED_BY(armed_tracer_mutex_) = false;
+  std::thread disarm_idle_tracer_thread_;
+
   uint64_t clock_resolution_ns_ = 0;
   void EstimateAndLogClockResolution();
 };
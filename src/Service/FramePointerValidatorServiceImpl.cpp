@@ -5,13 +5,16 @@
 #include "FramePointerValidatorServiceImpl.h"
 
 #include <absl/strings/str_format.h>
+#include <absl/time/time.h>
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <outcome.hpp>
+#include <string>
+#include <thread>
 #include <vector>
 
-#include "FramePointerValidator/FramePointerValidator.h"
 #include "ObjectUtils/ElfFile.h"
 #include "OrbitBase/Result.h"
 #include "code_block.pb.h"
@@ -22,6 +25,17 @@ using orbit_grpc_protos::CodeBlock;
 using orbit_grpc_protos::ValidateFramePointersRequest;
 using orbit_grpc_protos::ValidateFramePointersResponse;
 
+FramePointerValidatorServiceImpl::FramePointerValidatorServiceImpl()
+    : thread_pool_{ThreadPool::Create(
+          /*thread_pool_min_size=*/1,
+          /*thread_pool_max_size=*/std::max(1U, std::thread::hardware_concurrency()),
+          /*thread_ttl=*/absl::Seconds(1))},
+      validator_{thread_pool_.get()} {}
+
+FramePointerValidatorServiceImpl::~FramePointerValidatorServiceImpl() {
+  thread_pool_->ShutdownAndWait();
+}
+
 grpc::Status FramePointerValidatorServiceImpl::ValidateFramePointers(
     grpc::ServerContext*, const ValidateFramePointersRequest* request,
     ValidateFramePointersResponse* response) {
@@ -37,11 +51,12 @@ grpc::Status FramePointerValidatorServiceImpl::ValidateFramePointers(
   }
 
   bool is_64_bit = elf_file_result.value()->Is64Bit();
+  const std::string build_id = elf_file_result.value()->GetBuildId();
 
   std::vector<CodeBlock> function_infos(request->functions().begin(), request->functions().end());
 
   std::optional<std::vector<CodeBlock>> functions =
-      FramePointerValidator::GetFpoFunctions(function_infos, request->module_path(), is_64_bit);
+      validator_.GetFpoFunctions(function_infos, request->module_path(), build_id, is_64_bit);
 
   if (!functions.has_value()) {
     return grpc::Status(
@@ -7,6 +7,10 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include <memory>
+
+#include "FramePointerValidator/CachingFramePointerValidator.h"
+#include "OrbitBase/ThreadPool.h"
 #include "services.grpc.pb.h"
 #include "services.pb.h"
 
@@ -16,12 +20,21 @@ namespace orbit_service {
 // validate whether certain modules are compiled with frame pointers.
 // It returns a list of functions that don't have a prologue and epilogue
 // associated with frame pointers (see FunctionFramePointerValidator).
+// Functions are validated in parallel, and the results are cached by build id, so that validating
+// a module again is immediate.
 class FramePointerValidatorServiceImpl final
     : public orbit_grpc_protos::FramePointerValidatorService::Service {
  public:
+  FramePointerValidatorServiceImpl();
+  ~FramePointerValidatorServiceImpl() override;
+
   [[nodiscard]] grpc::Status ValidateFramePointers(
       grpc::ServerContext* context, const orbit_grpc_protos::ValidateFramePointersRequest* request,
       orbit_grpc_protos::ValidateFramePointersResponse* response) override;
+
+ private:
+  std::shared_ptr<ThreadPool> thread_pool_;
+  CachingFramePointerValidator validator_;
 };
 
 }  // namespace orbit_service
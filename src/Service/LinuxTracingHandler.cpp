@@ -8,6 +8,7 @@
 #include <unistd.h>
 
 #include <utility>
+#include <vector>
 
 #include "GrpcProtos/Constants.h"
 #include "OrbitBase/Logging.h"
@@ -22,16 +23,27 @@ using orbit_grpc_protos::FunctionCall;
 using orbit_grpc_protos::IntrospectionScope;
 using orbit_grpc_protos::ProducerCaptureEvent;
 using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
 using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadStateSlice;
 
 using orbit_grpc_protos::kLinuxTracingProducerId;
 
-void LinuxTracingHandler::Start(CaptureOptions capture_options) {
+void LinuxTracingHandler::Start(CaptureOptions capture_options,
+                                std::unique_ptr<orbit_linux_tracing::Tracer> armed_tracer,
+                                bool keep_armed) {
   CHECK(tracer_ == nullptr);
   bool enable_introspection = capture_options.enable_introspection();
 
-  tracer_ = std::make_unique<orbit_linux_tracing::Tracer>(std::move(capture_options));
+  if (armed_tracer != nullptr && armed_tracer->IsArmedFor(capture_options)) {
+    LOG("Reusing the armed perf_event_open file descriptors of the previous capture");
+    tracer_ = std::move(armed_tracer);
+  } else {
+    // Close the file descriptors armed for different capture options before opening new ones.
+    armed_tracer.reset();
+    tracer_ = std::make_unique<orbit_linux_tracing::Tracer>(std::move(capture_options));
+  }
+  tracer_->SetKeepArmedAfterStop(keep_armed);
   tracer_->SetListener(this);
   tracer_->Start();
 
@@ -63,13 +75,43 @@ void LinuxTracingHandler::SetupIntrospection() {
 void LinuxTracingHandler::Stop() {
   CHECK(tracer_ != nullptr);
   tracer_->Stop();
-  tracer_.reset();
+  if (!tracer_->IsArmed()) {
+    tracer_.reset();
+  }
+
+  SendSchedulingSlicesOnCore(scheduling_slice_encoder_.Flush());
+}
+
+std::unique_ptr<orbit_linux_tracing::Tracer> LinuxTracingHandler::ReleaseArmedTracer() {
+  if (tracer_ == nullptr || !tracer_->IsArmed()) return nullptr;
+  // The Tracer must not report to this LinuxTracingHandler anymore.
+  tracer_->SetListener(nullptr);
+  return std::move(tracer_);
 }
 
 void LinuxTracingHandler::OnSchedulingSlice(SchedulingSlice scheduling_slice) {
-  ProducerCaptureEvent event;
-  *event.mutable_scheduling_slice() = std::move(scheduling_slice);
-  producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
+  SendSchedulingSlicesOnCore(scheduling_slice_encoder_.EncodeSchedulingSlice(scheduling_slice));
+}
+
+void LinuxTracingHandler::OnSchedulingSlices(std::vector<SchedulingSlice> scheduling_slices) {
+  std::vector<SchedulingSlicesOnCore> completed_scheduling_slices_on_core;
+  for (const SchedulingSlice& scheduling_slice : scheduling_slices) {
+    for (SchedulingSlicesOnCore& scheduling_slices_on_core :
+         scheduling_slice_encoder_.EncodeSchedulingSlice(scheduling_slice)) {
+      completed_scheduling_slices_on_core.emplace_back(std::move(scheduling_slices_on_core));
+    }
+  }
+  SendSchedulingSlicesOnCore(std::move(completed_scheduling_slices_on_core));
+}
+
+void LinuxTracingHandler::SendSchedulingSlicesOnCore(
+    std::vector<SchedulingSlicesOnCore> scheduling_slices_on_core) {
+  if (scheduling_slices_on_core.empty()) return;
+  std::vector<ProducerCaptureEvent> events(scheduling_slices_on_core.size());
+  for (size_t i = 0; i < scheduling_slices_on_core.size(); ++i) {
+    *events[i].mutable_scheduling_slices_on_core() = std::move(scheduling_slices_on_core[i]);
+  }
+  producer_event_processor_->ProcessEvents(kLinuxTracingProducerId, std::move(events));
 }
 
 void LinuxTracingHandler::OnCallstackSample(FullCallstackSample callstack_sample) {
@@ -78,12 +120,28 @@ void LinuxTracingHandler::OnCallstackSample(FullCallstackSample callstack_sample
   producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
 }
 
+void LinuxTracingHandler::OnCallstackSamples(std::vector<FullCallstackSample> callstack_samples) {
+  std::vector<ProducerCaptureEvent> events(callstack_samples.size());
+  for (size_t i = 0; i < callstack_samples.size(); ++i) {
+    *events[i].mutable_full_callstack_sample() = std::move(callstack_samples[i]);
+  }
+  producer_event_processor_->ProcessEvents(kLinuxTracingProducerId, std::move(events));
+}
+
 void LinuxTracingHandler::OnFunctionCall(FunctionCall function_call) {
   ProducerCaptureEvent event;
   *event.mutable_function_call() = std::move(function_call);
   producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
 }
 
+void LinuxTracingHandler::OnFunctionCalls(std::vector<FunctionCall> function_calls) {
+  std::vector<ProducerCaptureEvent> events(function_calls.size());
+  for (size_t i = 0; i < function_calls.size(); ++i) {
+    *events[i].mutable_function_call() = std::move(function_calls[i]);
+  }
+  producer_event_processor_->ProcessEvents(kLinuxTracingProducerId, std::move(events));
+}
+
 void LinuxTracingHandler::OnIntrospectionScope(
     orbit_grpc_protos::IntrospectionScope introspection_scope) {
   ProducerCaptureEvent event;
@@ -97,6 +155,14 @@ void LinuxTracingHandler::OnGpuJob(FullGpuJob full_gpu_job) {
   producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
 }
 
+void LinuxTracingHandler::OnGpuJobs(std::vector<FullGpuJob> full_gpu_jobs) {
+  std::vector<ProducerCaptureEvent> events(full_gpu_jobs.size());
+  for (size_t i = 0; i < full_gpu_jobs.size(); ++i) {
+    *events[i].mutable_full_gpu_job() = std::move(full_gpu_jobs[i]);
+  }
+  producer_event_processor_->ProcessEvents(kLinuxTracingProducerId, std::move(events));
+}
+
 void LinuxTracingHandler::OnThreadName(ThreadName thread_name) {
   ProducerCaptureEvent event;
   *event.mutable_thread_name() = std::move(thread_name);
@@ -116,12 +182,28 @@ void LinuxTracingHandler::OnThreadStateSlice(ThreadStateSlice thread_state_slice
   producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
 }
 
+void LinuxTracingHandler::OnThreadStateSlices(std::vector<ThreadStateSlice> thread_state_slices) {
+  std::vector<ProducerCaptureEvent> events(thread_state_slices.size());
+  for (size_t i = 0; i < thread_state_slices.size(); ++i) {
+    *events[i].mutable_thread_state_slice() = std::move(thread_state_slices[i]);
+  }
+  producer_event_processor_->ProcessEvents(kLinuxTracingProducerId, std::move(events));
+}
+
 void LinuxTracingHandler::OnAddressInfo(FullAddressInfo full_address_info) {
   ProducerCaptureEvent event;
   *event.mutable_full_address_info() = std::move(full_address_info);
   producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
 }
 
+void LinuxTracingHandler::OnAddressInfos(std::vector<FullAddressInfo> full_address_infos) {
+  std::vector<ProducerCaptureEvent> events(full_address_infos.size());
+  for (size_t i = 0; i < full_address_infos.size(); ++i) {
+    *events[i].mutable_full_address_info() = std::move(full_address_infos[i]);
+  }
+  producer_event_processor_->ProcessEvents(kLinuxTracingProducerId, std::move(events));
+}
+
 void LinuxTracingHandler::OnTracepointEvent(
     orbit_grpc_protos::FullTracepointEvent tracepoint_event) {
   ProducerCaptureEvent event;
@@ -163,4 +245,11 @@ void LinuxTracingHandler::OnOutOfOrderEventsDiscardedEvent(
   producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
 }
 
+void LinuxTracingHandler::OnUnwindingErrorsSummaryEvent(
+    orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) {
+  orbit_grpc_protos::ProducerCaptureEvent event;
+  *event.mutable_unwinding_errors_summary_event() = std::move(unwinding_errors_summary_event);
+  producer_event_processor_->ProcessEvent(kLinuxTracingProducerId, std::move(event));
+}
+
 }  // namespace orbit_service
@@ -11,12 +11,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Introspection/Introspection.h"
 #include "LinuxTracing/Tracer.h"
 #include "LinuxTracing/TracerListener.h"
 #include "OrbitBase/Logging.h"
 #include "ProducerEventProcessor.h"
+#include "SchedulingSliceEncoder.h"
 #include "capture.pb.h"
 #include "tracepoint.pb.h"
 
@@ -33,8 +35,15 @@ class LinuxTracingHandler : public orbit_linux_tracing::TracerListener {
   LinuxTracingHandler(LinuxTracingHandler&&) = delete;
   LinuxTracingHandler& operator=(LinuxTracingHandler&&) = delete;
 
-  void Start(orbit_grpc_protos::CaptureOptions capture_options);
+  // If `armed_tracer` is armed for the same CaptureOptions, its perf_event_open file descriptors,
+  // already open but disabled, are used instead of opening new ones, which makes the capture start
+  // much faster. If `keep_armed` is true, Stop only disables the file descriptors, and the Tracer
+  // can be retrieved with ReleaseArmedTracer for the next capture.
+  void Start(orbit_grpc_protos::CaptureOptions capture_options,
+             std::unique_ptr<orbit_linux_tracing::Tracer> armed_tracer = nullptr,
+             bool keep_armed = false);
   void Stop();
+  [[nodiscard]] std::unique_ptr<orbit_linux_tracing::Tracer> ReleaseArmedTracer();
 
   void OnSchedulingSlice(orbit_grpc_protos::SchedulingSlice scheduling_slice) override;
   void OnCallstackSample(orbit_grpc_protos::FullCallstackSample callstack_sample) override;
@@ -54,15 +63,31 @@ class LinuxTracingHandler : public orbit_linux_tracing::TracerListener {
       orbit_grpc_protos::LostPerfRecordsEvent lost_perf_records_event) override;
   void OnOutOfOrderEventsDiscardedEvent(orbit_grpc_protos::OutOfOrderEventsDiscardedEvent
                                             out_of_order_events_discarded_event) override;
+  void OnUnwindingErrorsSummaryEvent(
+      orbit_grpc_protos::UnwindingErrorsSummaryEvent unwinding_errors_summary_event) override;
+
+  void OnSchedulingSlices(
+      std::vector<orbit_grpc_protos::SchedulingSlice> scheduling_slices) override;
+  void OnCallstackSamples(
+      std::vector<orbit_grpc_protos::FullCallstackSample> callstack_samples) override;
+  void OnFunctionCalls(std::vector<orbit_grpc_protos::FunctionCall> function_calls) override;
+  void OnGpuJobs(std::vector<orbit_grpc_protos::FullGpuJob> full_gpu_jobs) override;
+  void OnThreadStateSlices(
+      std::vector<orbit_grpc_protos::ThreadStateSlice> thread_state_slices) override;
+  void OnAddressInfos(std::vector<orbit_grpc_protos::FullAddressInfo> full_address_infos) override;
 
  private:
   ProducerEventProcessor* producer_event_processor_;
   std::unique_ptr<orbit_linux_tracing::Tracer> tracer_;
+  // Only accessed by the thread of tracer_, and by Stop once that thread has been joined.
+  SchedulingSliceEncoder scheduling_slice_encoder_;
 
   // Manual instrumentation tracing listener.
   std::unique_ptr<orbit_introspection::TracingListener> orbit_tracing_listener_;
 
   void SetupIntrospection();
+  void SendSchedulingSlicesOnCore(
+      std::vector<orbit_grpc_protos::SchedulingSlicesOnCore> scheduling_slices_on_core);
 };
 
 }  // namespace orbit_service
@@ -5,7 +5,13 @@
 #include "ProducerEventProcessor.h"
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
 
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Api/EncodedEvent.h"
 #include "OrbitBase/Logging.h"
 #include "capture.pb.h"
 
@@ -15,6 +21,7 @@ namespace {
 
 using orbit_grpc_protos::AddressInfo;
 using orbit_grpc_protos::ApiEvent;
+using orbit_grpc_protos::ApiScope;
 using orbit_grpc_protos::Callstack;
 using orbit_grpc_protos::CallstackSample;
 using orbit_grpc_protos::CaptureStarted;
@@ -41,10 +48,12 @@ using orbit_grpc_protos::ModuleUpdateEvent;
 using orbit_grpc_protos::OutOfOrderEventsDiscardedEvent;
 using orbit_grpc_protos::ProducerCaptureEvent;
 using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
 using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadNamesSnapshot;
 using orbit_grpc_protos::ThreadStateSlice;
 using orbit_grpc_protos::TracepointEvent;
+using orbit_grpc_protos::UnwindingErrorsSummaryEvent;
 using orbit_grpc_protos::WarningEvent;
 
 template <typename T>
@@ -80,45 +89,87 @@ class ProducerEventProcessorImpl : public ProducerEventProcessor {
       : capture_event_buffer_{capture_event_buffer} {}
 
   void ProcessEvent(uint64_t producer_id, ProducerCaptureEvent event) override;
+  void ProcessEvents(uint64_t producer_id, std::vector<ProducerCaptureEvent> events) override;
 
  private:
-  void ProcessCaptureStartedAndTransferOwnership(CaptureStarted* capture_started);
-  void ProcessFullAddressInfo(FullAddressInfo* full_address_info);
-  void ProcessFullCallstackSample(FullCallstackSample* full_callstack_sample);
-  void ProcessFunctionCallAndTransferOwnership(FunctionCall* function_call);
-  void ProcessFullGpuJob(FullGpuJob* full_gpu_job_event);
-  void ProcessGpuQueueSubmissionAndTransferOwnership(uint64_t producer_id,
-                                                     GpuQueueSubmission* gpu_queue_submission);
+  // Converts `event` to ClientCaptureEvents, possibly none or more than one, and appends them to
+  // `client_events`. The Process* functions below do the same for each type of event.
+  void ConvertEvent(uint64_t producer_id, ProducerCaptureEvent* event,
+                    std::vector<ClientCaptureEvent>* client_events);
+  void ProcessCaptureStartedAndTransferOwnership(CaptureStarted* capture_started,
+                                                 std::vector<ClientCaptureEvent>* client_events);
+  void ProcessFullAddressInfo(FullAddressInfo* full_address_info,
+                              std::vector<ClientCaptureEvent>* client_events);
+  void ProcessFullCallstackSample(FullCallstackSample* full_callstack_sample,
+                                  std::vector<ClientCaptureEvent>* client_events);
+  void ProcessFunctionCallAndTransferOwnership(FunctionCall* function_call,
+                                               std::vector<ClientCaptureEvent>* client_events);
+  void ProcessFullGpuJob(FullGpuJob* full_gpu_job_event,
+                         std::vector<ClientCaptureEvent>* client_events);
+  void ProcessGpuQueueSubmissionAndTransferOwnership(
+      uint64_t producer_id, GpuQueueSubmission* gpu_queue_submission,
+      std::vector<ClientCaptureEvent>* client_events);
   // ProcessInterned* functions remap producer intern_ids to the id space used in the client.
   // They keep track of these mappings in producer_interned_callstack_id_to_client_callstack_id_
   // and producer_interned_string_id_to_client_string_id_.
-  void ProcessInternedCallstack(uint64_t producer_id, InternedCallstack* interned_callstack);
+  void ProcessInternedCallstack(uint64_t producer_id, InternedCallstack* interned_callstack,
+                                std::vector<ClientCaptureEvent>* client_events);
   void ProcessCallstackSampleAndTransferOwnership(uint64_t producer_id,
-                                                  CallstackSample* callstack_sample);
-  void ProcessInternedString(uint64_t producer_id, InternedString* interned_string);
-  void ProcessIntrospectionScopeAndTransferOwnership(IntrospectionScope* introspection_scope);
-  void ProcessModuleUpdateEventAndTransferOwnership(ModuleUpdateEvent* module_update_event);
-  void ProcessModulesSnapshotAndTransferOwnership(ModulesSnapshot* modules_snapshot);
-  void ProcessSchedulingSliceAndTransferOwnership(SchedulingSlice* scheduling_slice);
-  void ProcessThreadNameAndTransferOwnership(ThreadName* thread_name);
-  void ProcessThreadNamesSnapshotAndTransferOwnership(ThreadNamesSnapshot* thread_names_snapshot);
-  void ProcessThreadStateSliceAndTransferOwnership(ThreadStateSlice* thread_state_slice);
-  void ProcessFullTracepointEvent(FullTracepointEvent* full_tracepoint_event);
-  void ProcessMemoryUsageEventAndTransferOwnership(MemoryUsageEvent* memory_usage_event);
-  void ProcessApiEventAndTransferOwnership(ApiEvent* api_event);
-  void ProcessWarningEventAndTransferOwnership(WarningEvent* warning_event);
+                                                  CallstackSample* callstack_sample,
+                                                  std::vector<ClientCaptureEvent>* client_events);
+  void ProcessInternedString(uint64_t producer_id, InternedString* interned_string,
+                             std::vector<ClientCaptureEvent>* client_events);
+  void ProcessIntrospectionScopeAndTransferOwnership(
+      IntrospectionScope* introspection_scope, std::vector<ClientCaptureEvent>* client_events);
+  void ProcessModuleUpdateEventAndTransferOwnership(ModuleUpdateEvent* module_update_event,
+                                                    std::vector<ClientCaptureEvent>* client_events);
+  void ProcessModulesSnapshotAndTransferOwnership(ModulesSnapshot* modules_snapshot,
+                                                  std::vector<ClientCaptureEvent>* client_events);
+  void ProcessSchedulingSliceAndTransferOwnership(SchedulingSlice* scheduling_slice,
+                                                  std::vector<ClientCaptureEvent>* client_events);
+  void ProcessSchedulingSlicesOnCoreAndTransferOwnership(
+      SchedulingSlicesOnCore* scheduling_slices_on_core,
+      std::vector<ClientCaptureEvent>* client_events);
+  void ProcessThreadNameAndTransferOwnership(ThreadName* thread_name,
+                                             std::vector<ClientCaptureEvent>* client_events);
+  void ProcessThreadNamesSnapshotAndTransferOwnership(
+      ThreadNamesSnapshot* thread_names_snapshot, std::vector<ClientCaptureEvent>* client_events);
+  void ProcessThreadStateSliceAndTransferOwnership(ThreadStateSlice* thread_state_slice,
+                                                   std::vector<ClientCaptureEvent>* client_events);
+  void ProcessFullTracepointEvent(FullTracepointEvent* full_tracepoint_event,
+                                  std::vector<ClientCaptureEvent>* client_events);
+  void ProcessMemoryUsageEventAndTransferOwnership(MemoryUsageEvent* memory_usage_event,
+                                                   std::vector<ClientCaptureEvent>* client_events);
+  // Synchronous scope start and stop events are paired into ApiScopes, other ApiEvents are
+  // forwarded to the client as they are.
+  void ProcessApiEvent(ApiEvent* api_event, std::vector<ClientCaptureEvent>* client_events);
+  void ProcessWarningEventAndTransferOwnership(WarningEvent* warning_event,
+                                               std::vector<ClientCaptureEvent>* client_events);
   void ProcessClockResolutionEventAndTransferOwnership(
-      ClockResolutionEvent* clock_resolution_event);
+      ClockResolutionEvent* clock_resolution_event, std::vector<ClientCaptureEvent>* client_events);
   void ProcessErrorsWithPerfEventOpenEventAndTransferOwnership(
-      ErrorsWithPerfEventOpenEvent* errors_with_perf_event_open_event);
+      ErrorsWithPerfEventOpenEvent* errors_with_perf_event_open_event,
+      std::vector<ClientCaptureEvent>* client_events);
   void ProcessErrorEnablingOrbitApiEventAndTransferOwnership(
-      ErrorEnablingOrbitApiEvent* error_enabling_orbit_api_event);
+      ErrorEnablingOrbitApiEvent* error_enabling_orbit_api_event,
+      std::vector<ClientCaptureEvent>* client_events);
   void ProcessLostPerfRecordsEventAndTransferOwnership(
-      LostPerfRecordsEvent* lost_perf_records_event);
+      LostPerfRecordsEvent* lost_perf_records_event,
+      std::vector<ClientCaptureEvent>* client_events);
+  void ProcessUnwindingErrorsSummaryEventAndTransferOwnership(
+      UnwindingErrorsSummaryEvent* unwinding_errors_summary_event,
+      std::vector<ClientCaptureEvent>* client_events);
   void ProcessOutOfOrderEventsDiscardedEventAndTransferOwnership(
-      OutOfOrderEventsDiscardedEvent* out_of_order_events_discarded_event);
+      OutOfOrderEventsDiscardedEvent* out_of_order_events_discarded_event,
+      std::vector<ClientCaptureEvent>* client_events);
+
+  void SendInternedStringEvent(uint64_t key, std::string value,
+                               std::vector<ClientCaptureEvent>* client_events);
 
-  void SendInternedStringEvent(uint64_t key, std::string value);
+  struct OpenApiScope {
+    uint64_t start_timestamp_ns;
+    orbit_api::EncodedEvent encoded_event;
+  };
 
   CaptureEventBuffer* capture_event_buffer_;
 
@@ -134,19 +185,24 @@ class ProducerEventProcessorImpl : public ProducerEventProcessor {
   // <producer_id, producer_string_id> -> client_string_id
   absl::flat_hash_map<std::pair<uint64_t, uint64_t>, uint64_t>
       producer_interned_string_id_to_client_string_id_;
+
+  // The kScopeStart ApiEvents waiting for their kScopeStop, by thread id.
+  absl::flat_hash_map<int32_t, std::vector<OpenApiScope>> open_api_scopes_by_tid_;
+  absl::Mutex open_api_scopes_mutex_;
 };
 
-void ProducerEventProcessorImpl::ProcessFullAddressInfo(FullAddressInfo* full_address_info) {
+void ProducerEventProcessorImpl::ProcessFullAddressInfo(
+    FullAddressInfo* full_address_info, std::vector<ClientCaptureEvent>* client_events) {
   auto [function_name_key, function_key_assigned] =
       string_pool_.GetOrAssignId(full_address_info->function_name());
   if (function_key_assigned) {
-    SendInternedStringEvent(function_name_key, full_address_info->function_name());
+    SendInternedStringEvent(function_name_key, full_address_info->function_name(), client_events);
   }
 
   auto [module_name_key, module_key_assigned] =
       string_pool_.GetOrAssignId(full_address_info->module_name());
   if (module_key_assigned) {
-    SendInternedStringEvent(module_name_key, full_address_info->module_name());
+    SendInternedStringEvent(module_name_key, full_address_info->module_name(), client_events);
   }
 
   ClientCaptureEvent event;
@@ -156,20 +212,21 @@ void ProducerEventProcessorImpl::ProcessFullAddressInfo(FullAddressInfo* full_ad
   interned_address_info->set_function_name_key(function_name_key);
   interned_address_info->set_module_name_key(module_name_key);
 
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessFunctionCallAndTransferOwnership(
-    FunctionCall* function_call) {
+    FunctionCall* function_call, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_function_call(function_call);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
-void ProducerEventProcessorImpl::ProcessFullGpuJob(FullGpuJob* full_gpu_job_event) {
+void ProducerEventProcessorImpl::ProcessFullGpuJob(FullGpuJob* full_gpu_job_event,
+                                                   std::vector<ClientCaptureEvent>* client_events) {
   auto [timeline_key, assigned] = string_pool_.GetOrAssignId(full_gpu_job_event->timeline());
   if (assigned) {
-    SendInternedStringEvent(timeline_key, full_gpu_job_event->timeline());
+    SendInternedStringEvent(timeline_key, full_gpu_job_event->timeline(), client_events);
   }
 
   ClientCaptureEvent event;
@@ -185,11 +242,12 @@ void ProducerEventProcessorImpl::ProcessFullGpuJob(FullGpuJob* full_gpu_job_even
   gpu_job_event->set_gpu_hardware_start_time_ns(full_gpu_job_event->gpu_hardware_start_time_ns());
   gpu_job_event->set_dma_fence_signaled_time_ns(full_gpu_job_event->dma_fence_signaled_time_ns());
   gpu_job_event->set_timeline_key(timeline_key);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessGpuQueueSubmissionAndTransferOwnership(
-    uint64_t producer_id, GpuQueueSubmission* gpu_queue_submission) {
+    uint64_t producer_id, GpuQueueSubmission* gpu_queue_submission,
+    std::vector<ClientCaptureEvent>* client_events) {
   // Translate debug marker keys
   for (GpuDebugMarker& mutable_marker : *gpu_queue_submission->mutable_completed_markers()) {
     auto it = producer_interned_string_id_to_client_string_id_.find(
@@ -200,11 +258,11 @@ void ProducerEventProcessorImpl::ProcessGpuQueueSubmissionAndTransferOwnership(
 
   ClientCaptureEvent event;
   event.set_allocated_gpu_queue_submission(gpu_queue_submission);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessFullCallstackSample(
-    FullCallstackSample* full_callstack_sample) {
+    FullCallstackSample* full_callstack_sample, std::vector<ClientCaptureEvent>* client_events) {
   const Callstack& callstack = full_callstack_sample->callstack();
   std::pair<std::vector<uint64_t>, Callstack::CallstackType> callstack_data{
       {callstack.pcs().begin(), callstack.pcs().end()}, callstack.type()};
@@ -215,7 +273,7 @@ void ProducerEventProcessorImpl::ProcessFullCallstackSample(
     interned_callstack_event.mutable_interned_callstack()->set_key(callstack_id);
     interned_callstack_event.mutable_interned_callstack()->set_allocated_intern(
         full_callstack_sample->release_callstack());
-    capture_event_buffer_->AddEvent(std::move(interned_callstack_event));
+    client_events->emplace_back(std::move(interned_callstack_event));
   }
 
   ClientCaptureEvent callstack_sample_event;
@@ -224,11 +282,12 @@ void ProducerEventProcessorImpl::ProcessFullCallstackSample(
   callstack_sample->set_tid(full_callstack_sample->tid());
   callstack_sample->set_timestamp_ns(full_callstack_sample->timestamp_ns());
   callstack_sample->set_callstack_id(callstack_id);
-  capture_event_buffer_->AddEvent(std::move(callstack_sample_event));
+  client_events->emplace_back(std::move(callstack_sample_event));
 }
 
-void ProducerEventProcessorImpl::ProcessInternedCallstack(uint64_t producer_id,
-                                                          InternedCallstack* interned_callstack) {
+void ProducerEventProcessorImpl::ProcessInternedCallstack(
+    uint64_t producer_id, InternedCallstack* interned_callstack,
+    std::vector<ClientCaptureEvent>* client_events) {
   // TODO(b/180235290): replace with error message
   CHECK(!producer_interned_callstack_id_to_client_callstack_id_.contains(
       {producer_id, interned_callstack->key()}));
@@ -249,11 +308,12 @@ void ProducerEventProcessorImpl::ProcessInternedCallstack(uint64_t producer_id,
   interned_callstack->set_key(interned_callstack_id);
   ClientCaptureEvent event;
   *event.mutable_interned_callstack() = std::move(*interned_callstack);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessCallstackSampleAndTransferOwnership(
-    uint64_t producer_id, CallstackSample* callstack_sample) {
+    uint64_t producer_id, CallstackSample* callstack_sample,
+    std::vector<ClientCaptureEvent>* client_events) {
   // translate producer id to client id
   auto it = producer_interned_callstack_id_to_client_callstack_id_.find(
       {producer_id, callstack_sample->callstack_id()});
@@ -263,11 +323,12 @@ void ProducerEventProcessorImpl::ProcessCallstackSampleAndTransferOwnership(
 
   ClientCaptureEvent event;
   event.set_allocated_callstack_sample(callstack_sample);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
-void ProducerEventProcessorImpl::ProcessInternedString(uint64_t producer_id,
-                                                       InternedString* interned_string) {
+void ProducerEventProcessorImpl::ProcessInternedString(
+    uint64_t producer_id, InternedString* interned_string,
+    std::vector<ClientCaptureEvent>* client_events) {
   // TODO(b/180235290): replace with error message
   CHECK(!producer_interned_string_id_to_client_string_id_.contains(
       {producer_id, interned_string->key()}));
@@ -284,66 +345,76 @@ void ProducerEventProcessorImpl::ProcessInternedString(uint64_t producer_id,
 
   ClientCaptureEvent event;
   *event.mutable_interned_string() = std::move(*interned_string);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessIntrospectionScopeAndTransferOwnership(
-    IntrospectionScope* introspection_scope) {
+    IntrospectionScope* introspection_scope, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_introspection_scope(introspection_scope);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessModuleUpdateEventAndTransferOwnership(
-    orbit_grpc_protos::ModuleUpdateEvent* module_update_event) {
+    orbit_grpc_protos::ModuleUpdateEvent* module_update_event,
+    std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_module_update_event(module_update_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessModulesSnapshotAndTransferOwnership(
-    ModulesSnapshot* modules_snapshot) {
+    ModulesSnapshot* modules_snapshot, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_modules_snapshot(modules_snapshot);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessCaptureStartedAndTransferOwnership(
-    CaptureStarted* capture_started) {
+    CaptureStarted* capture_started, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_capture_started(capture_started);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessSchedulingSliceAndTransferOwnership(
-    SchedulingSlice* scheduling_slice) {
+    SchedulingSlice* scheduling_slice, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_scheduling_slice(scheduling_slice);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
+}
+
+void ProducerEventProcessorImpl::ProcessSchedulingSlicesOnCoreAndTransferOwnership(
+    SchedulingSlicesOnCore* scheduling_slices_on_core,
+    std::vector<ClientCaptureEvent>* client_events) {
+  ClientCaptureEvent event;
+  event.set_allocated_scheduling_slices_on_core(scheduling_slices_on_core);
+  client_events->emplace_back(std::move(event));
 }
 
-void ProducerEventProcessorImpl::ProcessThreadNameAndTransferOwnership(ThreadName* thread_name) {
+void ProducerEventProcessorImpl::ProcessThreadNameAndTransferOwnership(
+    ThreadName* thread_name, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_thread_name(thread_name);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessThreadNamesSnapshotAndTransferOwnership(
-    ThreadNamesSnapshot* thread_names_snapshot) {
+    ThreadNamesSnapshot* thread_names_snapshot, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_thread_names_snapshot(thread_names_snapshot);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessThreadStateSliceAndTransferOwnership(
-    ThreadStateSlice* thread_state_slice) {
+    ThreadStateSlice* thread_state_slice, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_thread_state_slice(thread_state_slice);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessFullTracepointEvent(
-    FullTracepointEvent* full_tracepoint_event) {
+    FullTracepointEvent* full_tracepoint_event, std::vector<ClientCaptureEvent>* client_events) {
   auto [tracepoint_key, assigned] =
       tracepoint_pool_.GetOrAssignId({full_tracepoint_event->tracepoint_info().category(),
                                       full_tracepoint_event->tracepoint_info().name()});
@@ -353,7 +424,7 @@ void ProducerEventProcessorImpl::ProcessFullTracepointEvent(
     interned_tracepoint_info->set_key(tracepoint_key);
     interned_tracepoint_info->set_allocated_intern(
         full_tracepoint_event->release_tracepoint_info());
-    capture_event_buffer_->AddEvent(std::move(event));
+    client_events->emplace_back(std::move(event));
   }
 
   ClientCaptureEvent event;
@@ -363,156 +434,248 @@ void ProducerEventProcessorImpl::ProcessFullTracepointEvent(
   tracepoint_event->set_timestamp_ns(full_tracepoint_event->timestamp_ns());
   tracepoint_event->set_cpu(full_tracepoint_event->cpu());
   tracepoint_event->set_tracepoint_info_key(tracepoint_key);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessMemoryUsageEventAndTransferOwnership(
-    MemoryUsageEvent* memory_usage_event) {
+    MemoryUsageEvent* memory_usage_event, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_memory_usage_event(memory_usage_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
-void ProducerEventProcessorImpl::ProcessApiEventAndTransferOwnership(ApiEvent* api_event) {
+void ProducerEventProcessorImpl::ProcessApiEvent(ApiEvent* api_event,
+                                                 std::vector<ClientCaptureEvent>* client_events) {
+  orbit_api::EncodedEvent encoded_event{api_event->r0(), api_event->r1(), api_event->r2(),
+                                        api_event->r3(), api_event->r4(), api_event->r5()};
+  if (encoded_event.Type() == orbit_api::kScopeStart) {
+    absl::MutexLock lock(&open_api_scopes_mutex_);
+    open_api_scopes_by_tid_[api_event->tid()].push_back(
+        {api_event->timestamp_ns(), encoded_event});
+    return;
+  }
+
+  if (encoded_event.Type() == orbit_api::kScopeStop) {
+    std::optional<OpenApiScope> open_scope;
+    int32_t depth = 0;
+    {
+      absl::MutexLock lock(&open_api_scopes_mutex_);
+      auto it = open_api_scopes_by_tid_.find(api_event->tid());
+      if (it != open_api_scopes_by_tid_.end() && !it->second.empty()) {
+        open_scope = it->second.back();
+        it->second.pop_back();
+        depth = static_cast<int32_t>(it->second.size());
+      }
+    }
+
+    // A stop event without start event is possible if the capture was started between the two. It
+    // is forwarded unpaired, which the client handles like any unmatched stop event.
+    if (open_scope.has_value()) {
+      std::string name{open_scope->encoded_event.event.name};
+      auto [name_key, assigned] = string_pool_.GetOrAssignId(name);
+      if (assigned) {
+        SendInternedStringEvent(name_key, std::move(name), client_events);
+      }
+
+      ClientCaptureEvent event;
+      ApiScope* api_scope = event.mutable_api_scope();
+      api_scope->set_pid(api_event->pid());
+      api_scope->set_tid(api_event->tid());
+      api_scope->set_duration_ns(api_event->timestamp_ns() - open_scope->start_timestamp_ns);
+      api_scope->set_end_timestamp_ns(api_event->timestamp_ns());
+      api_scope->set_depth(depth);
+      api_scope->set_name_key(name_key);
+      api_scope->set_color(static_cast<uint32_t>(open_scope->encoded_event.event.color));
+      client_events->emplace_back(std::move(event));
+      return;
+    }
+  }
+
   ClientCaptureEvent event;
-  event.set_allocated_api_event(api_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  *event.mutable_api_event() = std::move(*api_event);
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessWarningEventAndTransferOwnership(
-    WarningEvent* warning_event) {
+    WarningEvent* warning_event, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_warning_event(warning_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessErrorEnablingOrbitApiEventAndTransferOwnership(
-    ErrorEnablingOrbitApiEvent* error_enabling_orbit_api_event) {
+    ErrorEnablingOrbitApiEvent* error_enabling_orbit_api_event,
+    std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_error_enabling_orbit_api_event(error_enabling_orbit_api_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessClockResolutionEventAndTransferOwnership(
-    ClockResolutionEvent* clock_resolution_event) {
+    ClockResolutionEvent* clock_resolution_event, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_clock_resolution_event(clock_resolution_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessErrorsWithPerfEventOpenEventAndTransferOwnership(
-    ErrorsWithPerfEventOpenEvent* errors_with_perf_event_open_event) {
+    ErrorsWithPerfEventOpenEvent* errors_with_perf_event_open_event,
+    std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_errors_with_perf_event_open_event(errors_with_perf_event_open_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessLostPerfRecordsEventAndTransferOwnership(
-    LostPerfRecordsEvent* lost_perf_records_event) {
+    LostPerfRecordsEvent* lost_perf_records_event, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_lost_perf_records_event(lost_perf_records_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessOutOfOrderEventsDiscardedEventAndTransferOwnership(
-    OutOfOrderEventsDiscardedEvent* out_of_order_events_discarded_event) {
+    OutOfOrderEventsDiscardedEvent* out_of_order_events_discarded_event,
+    std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   event.set_allocated_out_of_order_events_discarded_event(out_of_order_events_discarded_event);
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
+}
+
+void ProducerEventProcessorImpl::ProcessUnwindingErrorsSummaryEventAndTransferOwnership(
+    UnwindingErrorsSummaryEvent* unwinding_errors_summary_event,
+    std::vector<ClientCaptureEvent>* client_events) {
+  ClientCaptureEvent event;
+  event.set_allocated_unwinding_errors_summary_event(unwinding_errors_summary_event);
+  client_events->emplace_back(std::move(event));
 }
 
 void ProducerEventProcessorImpl::ProcessEvent(uint64_t producer_id, ProducerCaptureEvent event) {
-  switch (event.event_case()) {
+  std::vector<ClientCaptureEvent> client_events;
+  ConvertEvent(producer_id, &event, &client_events);
+  capture_event_buffer_->AddEvents(std::move(client_events));
+}
+
+void ProducerEventProcessorImpl::ProcessEvents(uint64_t producer_id,
+                                               std::vector<ProducerCaptureEvent> events) {
+  std::vector<ClientCaptureEvent> client_events;
+  client_events.reserve(events.size());
+  for (ProducerCaptureEvent& event : events) {
+    ConvertEvent(producer_id, &event, &client_events);
+  }
+  capture_event_buffer_->AddEvents(std::move(client_events));
+}
+
+void ProducerEventProcessorImpl::ConvertEvent(uint64_t producer_id, ProducerCaptureEvent* event,
+                                              std::vector<ClientCaptureEvent>* client_events) {
+  switch (event->event_case()) {
     case ProducerCaptureEvent::kCaptureStarted:
-      ProcessCaptureStartedAndTransferOwnership(event.release_capture_started());
+      ProcessCaptureStartedAndTransferOwnership(event->release_capture_started(), client_events);
       break;
     case ProducerCaptureEvent::kInternedCallstack:
-      ProcessInternedCallstack(producer_id, event.mutable_interned_callstack());
+      ProcessInternedCallstack(producer_id, event->mutable_interned_callstack(), client_events);
       break;
     case ProducerCaptureEvent::kSchedulingSlice:
-      ProcessSchedulingSliceAndTransferOwnership(event.release_scheduling_slice());
+      ProcessSchedulingSliceAndTransferOwnership(event->release_scheduling_slice(), client_events);
+      break;
+    case ProducerCaptureEvent::kSchedulingSlicesOnCore:
+      ProcessSchedulingSlicesOnCoreAndTransferOwnership(event->release_scheduling_slices_on_core(),
+                                                        client_events);
       break;
     case ProducerCaptureEvent::kCallstackSample:
-      ProcessCallstackSampleAndTransferOwnership(producer_id, event.release_callstack_sample());
+      ProcessCallstackSampleAndTransferOwnership(producer_id, event->release_callstack_sample(),
+                                                 client_events);
       break;
     case ProducerCaptureEvent::kFullCallstackSample:
-      ProcessFullCallstackSample(event.mutable_full_callstack_sample());
+      ProcessFullCallstackSample(event->mutable_full_callstack_sample(), client_events);
       break;
     case ProducerCaptureEvent::kFullTracepointEvent:
-      ProcessFullTracepointEvent(event.mutable_full_tracepoint_event());
+      ProcessFullTracepointEvent(event->mutable_full_tracepoint_event(), client_events);
       break;
     case ProducerCaptureEvent::kFunctionCall:
-      ProcessFunctionCallAndTransferOwnership(event.release_function_call());
+      ProcessFunctionCallAndTransferOwnership(event->release_function_call(), client_events);
       break;
     case ProducerCaptureEvent::kInternedString:
-      ProcessInternedString(producer_id, event.mutable_interned_string());
+      ProcessInternedString(producer_id, event->mutable_interned_string(), client_events);
       break;
     case ProducerCaptureEvent::kFullGpuJob:
-      ProcessFullGpuJob(event.mutable_full_gpu_job());
+      ProcessFullGpuJob(event->mutable_full_gpu_job(), client_events);
       break;
     case ProducerCaptureEvent::kGpuQueueSubmission:
       ProcessGpuQueueSubmissionAndTransferOwnership(producer_id,
-                                                    event.release_gpu_queue_submission());
+                                                    event->release_gpu_queue_submission(),
+                                                    client_events);
       break;
     case ProducerCaptureEvent::kThreadName:
-      ProcessThreadNameAndTransferOwnership(event.release_thread_name());
+      ProcessThreadNameAndTransferOwnership(event->release_thread_name(), client_events);
       break;
     case ProducerCaptureEvent::kThreadNamesSnapshot:
-      ProcessThreadNamesSnapshotAndTransferOwnership(event.release_thread_names_snapshot());
+      ProcessThreadNamesSnapshotAndTransferOwnership(event->release_thread_names_snapshot(),
+                                                     client_events);
       break;
     case ProducerCaptureEvent::kThreadStateSlice:
-      ProcessThreadStateSliceAndTransferOwnership(event.release_thread_state_slice());
+      ProcessThreadStateSliceAndTransferOwnership(event->release_thread_state_slice(),
+                                                  client_events);
       break;
     case ProducerCaptureEvent::kFullAddressInfo:
-      ProcessFullAddressInfo(event.mutable_full_address_info());
+      ProcessFullAddressInfo(event->mutable_full_address_info(), client_events);
       break;
     case ProducerCaptureEvent::kIntrospectionScope:
-      ProcessIntrospectionScopeAndTransferOwnership(event.release_introspection_scope());
+      ProcessIntrospectionScopeAndTransferOwnership(event->release_introspection_scope(),
+                                                    client_events);
       break;
     case ProducerCaptureEvent::kModuleUpdateEvent:
-      ProcessModuleUpdateEventAndTransferOwnership(event.release_module_update_event());
+      ProcessModuleUpdateEventAndTransferOwnership(event->release_module_update_event(),
+                                                   client_events);
       break;
     case ProducerCaptureEvent::kModulesSnapshot:
-      ProcessModulesSnapshotAndTransferOwnership(event.release_modules_snapshot());
+      ProcessModulesSnapshotAndTransferOwnership(event->release_modules_snapshot(), client_events);
       break;
     case ProducerCaptureEvent::kMemoryUsageEvent:
-      ProcessMemoryUsageEventAndTransferOwnership(event.release_memory_usage_event());
+      ProcessMemoryUsageEventAndTransferOwnership(event->release_memory_usage_event(),
+                                                  client_events);
       break;
     case ProducerCaptureEvent::kApiEvent:
-      ProcessApiEventAndTransferOwnership(event.release_api_event());
+      ProcessApiEvent(event->mutable_api_event(), client_events);
       break;
     case ProducerCaptureEvent::kWarningEvent:
-      ProcessWarningEventAndTransferOwnership(event.release_warning_event());
+      ProcessWarningEventAndTransferOwnership(event->release_warning_event(), client_events);
       break;
     case ProducerCaptureEvent::kClockResolutionEvent:
-      ProcessClockResolutionEventAndTransferOwnership(event.release_clock_resolution_event());
+      ProcessClockResolutionEventAndTransferOwnership(event->release_clock_resolution_event(),
+                                                      client_events);
       break;
     case ProducerCaptureEvent::kErrorsWithPerfEventOpenEvent:
       ProcessErrorsWithPerfEventOpenEventAndTransferOwnership(
-          event.release_errors_with_perf_event_open_event());
+          event->release_errors_with_perf_event_open_event(), client_events);
       break;
     case ProducerCaptureEvent::kErrorEnablingOrbitApiEvent:
       ProcessErrorEnablingOrbitApiEventAndTransferOwnership(
-          event.release_error_enabling_orbit_api_event());
+          event->release_error_enabling_orbit_api_event(), client_events);
       break;
     case ProducerCaptureEvent::kLostPerfRecordsEvent:
-      ProcessLostPerfRecordsEventAndTransferOwnership(event.release_lost_perf_records_event());
+      ProcessLostPerfRecordsEventAndTransferOwnership(event->release_lost_perf_records_event(),
+                                                      client_events);
       break;
     case ProducerCaptureEvent::kOutOfOrderEventsDiscardedEvent:
       ProcessOutOfOrderEventsDiscardedEventAndTransferOwnership(
-          event.release_out_of_order_events_discarded_event());
+          event->release_out_of_order_events_discarded_event(), client_events);
+      break;
+    case ProducerCaptureEvent::kUnwindingErrorsSummaryEvent:
+      ProcessUnwindingErrorsSummaryEventAndTransferOwnership(
+          event->release_unwinding_errors_summary_event(), client_events);
       break;
     case ProducerCaptureEvent::EVENT_NOT_SET:
       UNREACHABLE();
   }
 }
 
-void ProducerEventProcessorImpl::SendInternedStringEvent(uint64_t key, std::string value) {
+void ProducerEventProcessorImpl::SendInternedStringEvent(
+    uint64_t key, std::string value, std::vector<ClientCaptureEvent>* client_events) {
   ClientCaptureEvent event;
   InternedString* interned_string = event.mutable_interned_string();
   interned_string->set_key(key);
   interned_string->set_intern(std::move(value));
-  capture_event_buffer_->AddEvent(std::move(event));
+  client_events->emplace_back(std::move(event));
 }
 
 }  // namespace
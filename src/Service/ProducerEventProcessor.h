@@ -7,6 +7,10 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "CaptureEventBuffer.h"
 #include "capture.pb.h"
 
@@ -23,6 +27,15 @@ class ProducerEventProcessor {
   virtual void ProcessEvent(uint64_t producer_id,
                             orbit_grpc_protos::ProducerCaptureEvent event) = 0;
 
+  // Processes the events in order, like calling ProcessEvent for each of them, but allows
+  // implementations to pass the resulting ClientCaptureEvents to CaptureEventBuffer all at once.
+  virtual void ProcessEvents(uint64_t producer_id,
+                             std::vector<orbit_grpc_protos::ProducerCaptureEvent> events) {
+    for (orbit_grpc_protos::ProducerCaptureEvent& event : events) {
+      ProcessEvent(producer_id, std::move(event));
+    }
+  }
+
   static std::unique_ptr<ProducerEventProcessor> Create(CaptureEventBuffer* capture_event_buffer);
 };
 
@@ -7,6 +7,9 @@
 #include <gtest/gtest.h>
 #include <stdint.h>
 
+#include <vector>
+
+#include "Api/EncodedEvent.h"
 #include "ProducerEventProcessor.h"
 #include "capture.pb.h"
 
@@ -15,6 +18,8 @@ namespace orbit_service {
 namespace {
 
 using orbit_grpc_protos::AddressInfo;
+using orbit_grpc_protos::ApiEvent;
+using orbit_grpc_protos::ApiScope;
 using orbit_grpc_protos::Callstack;
 using orbit_grpc_protos::CallstackSample;
 using orbit_grpc_protos::CaptureOptions;
@@ -48,11 +53,13 @@ using orbit_grpc_protos::OutOfOrderEventsDiscardedEvent;
 using orbit_grpc_protos::ProcessMemoryUsage;
 using orbit_grpc_protos::ProducerCaptureEvent;
 using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
 using orbit_grpc_protos::SystemMemoryUsage;
 using orbit_grpc_protos::ThreadName;
 using orbit_grpc_protos::ThreadNamesSnapshot;
 using orbit_grpc_protos::ThreadStateSlice;
 using orbit_grpc_protos::TracepointEvent;
+using orbit_grpc_protos::UnwindingErrorsSummaryEvent;
 using orbit_grpc_protos::WarningEvent;
 
 using ::testing::SaveArg;
@@ -107,6 +114,24 @@ constexpr const char* kExecutablePath = "/path/to/executable";
 constexpr const char* kBuildId1 = "build_id_1";
 constexpr const char* kBuildId2 = "build_id_2";
 
+ProducerCaptureEvent CreateApiEvent(int32_t tid, uint64_t timestamp_ns, orbit_api::EventType type,
+                                    const char* name = nullptr,
+                                    orbit_api_color color = kOrbitColorAuto) {
+  orbit_api::EncodedEvent encoded_event(type, name, /*data=*/0, color);
+  ProducerCaptureEvent producer_capture_event;
+  ApiEvent* api_event = producer_capture_event.mutable_api_event();
+  api_event->set_pid(kPid1);
+  api_event->set_tid(tid);
+  api_event->set_timestamp_ns(timestamp_ns);
+  api_event->set_r0(encoded_event.args[0]);
+  api_event->set_r1(encoded_event.args[1]);
+  api_event->set_r2(encoded_event.args[2]);
+  api_event->set_r3(encoded_event.args[3]);
+  api_event->set_r4(encoded_event.args[4]);
+  api_event->set_r5(encoded_event.args[5]);
+  return producer_capture_event;
+}
+
 }  // namespace
 
 TEST(ProducerEventProcessor, OneSchedulingSliceEvent) {
@@ -135,6 +160,34 @@ TEST(ProducerEventProcessor, OneSchedulingSliceEvent) {
   EXPECT_EQ(actual_scheduling_slice.out_timestamp_ns(), kTimestampNs1);
 }
 
+TEST(ProducerEventProcessor, OneSchedulingSlicesOnCoreEvent) {
+  MockCaptureEventBuffer buffer;
+  auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
+
+  ProducerCaptureEvent event;
+  SchedulingSlicesOnCore* scheduling_slices_on_core = event.mutable_scheduling_slices_on_core();
+  scheduling_slices_on_core->set_core(kCore1);
+  scheduling_slices_on_core->add_thread_pids(kPid1);
+  scheduling_slices_on_core->add_thread_tids(kTid1);
+  scheduling_slices_on_core->add_thread_indices(0);
+  scheduling_slices_on_core->add_in_timestamp_deltas_ns(kTimestampNs1 - kDurationNs1);
+  scheduling_slices_on_core->add_durations_ns(kDurationNs1);
+
+  ClientCaptureEvent client_capture_event;
+  EXPECT_CALL(buffer, AddEvent).Times(1).WillOnce(SaveArg<0>(&client_capture_event));
+
+  producer_event_processor->ProcessEvent(kDefaultProducerId, event);
+  ASSERT_EQ(client_capture_event.event_case(), ClientCaptureEvent::kSchedulingSlicesOnCore);
+  const SchedulingSlicesOnCore& actual = client_capture_event.scheduling_slices_on_core();
+
+  EXPECT_EQ(actual.core(), kCore1);
+  EXPECT_THAT(actual.thread_pids(), testing::ElementsAre(kPid1));
+  EXPECT_THAT(actual.thread_tids(), testing::ElementsAre(kTid1));
+  EXPECT_THAT(actual.thread_indices(), testing::ElementsAre(0));
+  EXPECT_THAT(actual.in_timestamp_deltas_ns(), testing::ElementsAre(kTimestampNs1 - kDurationNs1));
+  EXPECT_THAT(actual.durations_ns(), testing::ElementsAre(kDurationNs1));
+}
+
 TEST(ProducerEventProcessor, OneInternedCallstack) {
   MockCaptureEventBuffer buffer;
   auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
@@ -718,6 +771,45 @@ TEST(ProducerEventProcessor, FullCallstackSamplesSameCallstack) {
   EXPECT_EQ(callstack_sample2.callstack_id(), interned_callstack1.key());
 }
 
+TEST(ProducerEventProcessor, FullCallstackSamplesProcessedTogether) {
+  class MockBatchedCaptureEventBuffer : public CaptureEventBuffer {
+   public:
+    MOCK_METHOD(void, AddEvent, (orbit_grpc_protos::ClientCaptureEvent && /*event*/), (override));
+    MOCK_METHOD(void, AddEvents,
+                (std::vector<orbit_grpc_protos::ClientCaptureEvent> && /*events*/), (override));
+  };
+  MockBatchedCaptureEventBuffer buffer;
+  auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
+
+  std::vector<ProducerCaptureEvent> events(2);
+  for (size_t i = 0; i < events.size(); ++i) {
+    FullCallstackSample* full_callstack_sample = events[i].mutable_full_callstack_sample();
+    full_callstack_sample->set_pid(kPid1);
+    full_callstack_sample->set_tid(kTid1);
+    full_callstack_sample->set_timestamp_ns(i == 0 ? kTimestampNs1 : kTimestampNs2);
+    Callstack* callstack = full_callstack_sample->mutable_callstack();
+    callstack->add_pcs(1);
+    callstack->add_pcs(2);
+    callstack->set_type(Callstack::kComplete);
+  }
+
+  std::vector<ClientCaptureEvent> client_events;
+  EXPECT_CALL(buffer, AddEvent).Times(0);
+  EXPECT_CALL(buffer, AddEvents).Times(1).WillOnce(SaveArg<0>(&client_events));
+
+  producer_event_processor->ProcessEvents(kDefaultProducerId, std::move(events));
+
+  ASSERT_EQ(client_events.size(), 3);
+  ASSERT_EQ(client_events[0].event_case(), ClientCaptureEvent::kInternedCallstack);
+  ASSERT_EQ(client_events[1].event_case(), ClientCaptureEvent::kCallstackSample);
+  ASSERT_EQ(client_events[2].event_case(), ClientCaptureEvent::kCallstackSample);
+  const uint64_t callstack_key = client_events[0].interned_callstack().key();
+  EXPECT_EQ(client_events[1].callstack_sample().timestamp_ns(), kTimestampNs1);
+  EXPECT_EQ(client_events[1].callstack_sample().callstack_id(), callstack_key);
+  EXPECT_EQ(client_events[2].callstack_sample().timestamp_ns(), kTimestampNs2);
+  EXPECT_EQ(client_events[2].callstack_sample().callstack_id(), callstack_key);
+}
+
 TEST(ProducerEventProcessor, FullTracepointEventsDifferentTracepoints) {
   MockCaptureEventBuffer buffer;
   auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
@@ -1782,4 +1874,125 @@ TEST(ProducerEventProcessor, OutOfOrderEventsDiscardedEvent) {
   EXPECT_EQ(actual_out_of_order_events_discarded_event.end_timestamp_ns(), kTimestampNs1);
 }
 
-}  // namespace orbit_service
\ No newline at end of file
+TEST(ProducerEventProcessor, UnwindingErrorsSummaryEvent) {
+  MockCaptureEventBuffer buffer;
+  auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
+
+  ProducerCaptureEvent producer_capture_event;
+  UnwindingErrorsSummaryEvent* unwinding_errors_summary_event =
+      producer_capture_event.mutable_unwinding_errors_summary_event();
+  unwinding_errors_summary_event->set_timestamp_ns(kTimestampNs1);
+  unwinding_errors_summary_event->set_pid(kPid1);
+  UnwindingErrorsSummaryEvent::ModuleErrors* module_errors =
+      unwinding_errors_summary_event->add_modules();
+  module_errors->set_module_path(kExecutablePath);
+  module_errors->mutable_errors()->set_missing_unwind_info(1);
+
+  ClientCaptureEvent client_capture_event;
+  EXPECT_CALL(buffer, AddEvent).Times(1).WillOnce(SaveArg<0>(&client_capture_event));
+
+  producer_event_processor->ProcessEvent(kDefaultProducerId, producer_capture_event);
+
+  ASSERT_EQ(client_capture_event.event_case(), ClientCaptureEvent::kUnwindingErrorsSummaryEvent);
+  const UnwindingErrorsSummaryEvent& actual_unwinding_errors_summary_event =
+      client_capture_event.unwinding_errors_summary_event();
+  EXPECT_EQ(actual_unwinding_errors_summary_event.timestamp_ns(), kTimestampNs1);
+  EXPECT_EQ(actual_unwinding_errors_summary_event.pid(), kPid1);
+  ASSERT_EQ(actual_unwinding_errors_summary_event.modules_size(), 1);
+  EXPECT_EQ(actual_unwinding_errors_summary_event.modules(0).module_path(), kExecutablePath);
+  EXPECT_EQ(actual_unwinding_errors_summary_event.modules(0).errors().missing_unwind_info(), 1);
+}
+
+TEST(ProducerEventProcessor, ApiScopesArePaired) {
+  MockCaptureEventBuffer buffer;
+  auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
+
+  std::vector<ClientCaptureEvent> client_capture_events;
+  EXPECT_CALL(buffer, AddEvent)
+      .WillRepeatedly([&client_capture_events](ClientCaptureEvent&& event) {
+        client_capture_events.emplace_back(std::move(event));
+      });
+
+  producer_event_processor->ProcessEvent(
+      kDefaultProducerId,
+      CreateApiEvent(kTid1, 1, orbit_api::kScopeStart, "Outer", kOrbitColorRed));
+  producer_event_processor->ProcessEvent(kDefaultProducerId,
+                                         CreateApiEvent(kTid1, 2, orbit_api::kScopeStart, "Inner"));
+  // Scopes of different threads are paired independently.
+  producer_event_processor->ProcessEvent(kDefaultProducerId,
+                                         CreateApiEvent(kTid2, 3, orbit_api::kScopeStart, "Inner"));
+  EXPECT_TRUE(client_capture_events.empty());
+
+  producer_event_processor->ProcessEvent(kDefaultProducerId,
+                                         CreateApiEvent(kTid1, 4, orbit_api::kScopeStop));
+  producer_event_processor->ProcessEvent(kDefaultProducerId,
+                                         CreateApiEvent(kTid1, 5, orbit_api::kScopeStop));
+  producer_event_processor->ProcessEvent(kDefaultProducerId,
+                                         CreateApiEvent(kTid2, 6, orbit_api::kScopeStop));
+
+  ASSERT_EQ(client_capture_events.size(), 5);
+  ASSERT_EQ(client_capture_events[0].event_case(), ClientCaptureEvent::kInternedString);
+  const InternedString& inner_name = client_capture_events[0].interned_string();
+  EXPECT_EQ(inner_name.intern(), "Inner");
+
+  ASSERT_EQ(client_capture_events[1].event_case(), ClientCaptureEvent::kApiScope);
+  const ApiScope& inner_scope = client_capture_events[1].api_scope();
+  EXPECT_EQ(inner_scope.pid(), kPid1);
+  EXPECT_EQ(inner_scope.tid(), kTid1);
+  EXPECT_EQ(inner_scope.duration_ns(), 2);
+  EXPECT_EQ(inner_scope.end_timestamp_ns(), 4);
+  EXPECT_EQ(inner_scope.depth(), 1);
+  EXPECT_EQ(inner_scope.name_key(), inner_name.key());
+  EXPECT_EQ(inner_scope.color(), kOrbitColorAuto);
+
+  ASSERT_EQ(client_capture_events[2].event_case(), ClientCaptureEvent::kInternedString);
+  const InternedString& outer_name = client_capture_events[2].interned_string();
+  EXPECT_EQ(outer_name.intern(), "Outer");
+
+  ASSERT_EQ(client_capture_events[3].event_case(), ClientCaptureEvent::kApiScope);
+  const ApiScope& outer_scope = client_capture_events[3].api_scope();
+  EXPECT_EQ(outer_scope.tid(), kTid1);
+  EXPECT_EQ(outer_scope.duration_ns(), 4);
+  EXPECT_EQ(outer_scope.end_timestamp_ns(), 5);
+  EXPECT_EQ(outer_scope.depth(), 0);
+  EXPECT_EQ(outer_scope.name_key(), outer_name.key());
+  EXPECT_EQ(outer_scope.color(), kOrbitColorRed);
+
+  // The name is only interned once.
+  ASSERT_EQ(client_capture_events[4].event_case(), ClientCaptureEvent::kApiScope);
+  const ApiScope& other_thread_scope = client_capture_events[4].api_scope();
+  EXPECT_EQ(other_thread_scope.tid(), kTid2);
+  EXPECT_EQ(other_thread_scope.depth(), 0);
+  EXPECT_EQ(other_thread_scope.name_key(), inner_name.key());
+}
+
+TEST(ProducerEventProcessor, UnpairedApiEventsAreForwarded) {
+  MockCaptureEventBuffer buffer;
+  auto producer_event_processor = ProducerEventProcessor::Create(&buffer);
+
+  std::vector<ClientCaptureEvent> client_capture_events;
+  EXPECT_CALL(buffer, AddEvent)
+      .WillRepeatedly([&client_capture_events](ClientCaptureEvent&& event) {
+        client_capture_events.emplace_back(std::move(event));
+      });
+
+  // A stop event without start event, as when the capture starts inside a scope.
+  producer_event_processor->ProcessEvent(kDefaultProducerId,
+                                         CreateApiEvent(kTid1, 1, orbit_api::kScopeStop));
+  producer_event_processor->ProcessEvent(
+      kDefaultProducerId, CreateApiEvent(kTid1, 2, orbit_api::kTrackUint64, "Value"));
+  producer_event_processor->ProcessEvent(
+      kDefaultProducerId, CreateApiEvent(kTid1, 3, orbit_api::kScopeStartAsync, "Async"));
+
+  ASSERT_EQ(client_capture_events.size(), 3);
+  for (const ClientCaptureEvent& event : client_capture_events) {
+    ASSERT_EQ(event.event_case(), ClientCaptureEvent::kApiEvent);
+    EXPECT_EQ(event.api_event().pid(), kPid1);
+    EXPECT_EQ(event.api_event().tid(), kTid1);
+  }
+  EXPECT_EQ(client_capture_events[0].api_event().timestamp_ns(), 1);
+  EXPECT_EQ(client_capture_events[1].api_event().timestamp_ns(), 2);
+  EXPECT_EQ(client_capture_events[2].api_event().timestamp_ns(), 3);
+}
+
+}  // namespace orbit_service
@@ -0,0 +1,82 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "SchedulingSliceEncoder.h"
+
+#include <utility>
+
+#include "OrbitBase/Logging.h"
+
+namespace orbit_service {
+
+using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
+
+std::vector<SchedulingSlicesOnCore> SchedulingSliceEncoder::EncodeSchedulingSlice(
+    const SchedulingSlice& scheduling_slice) {
+  std::vector<SchedulingSlicesOnCore> completed_batches;
+  const int32_t core = scheduling_slice.core();
+  if (core < 0) {
+    ERROR("SchedulingSlice with negative core %d", core);
+    return completed_batches;
+  }
+  if (static_cast<size_t>(core) >= open_batches_.size()) {
+    open_batches_.resize(core + 1);
+  }
+
+  const uint64_t out_timestamp_ns = scheduling_slice.out_timestamp_ns();
+  const uint64_t in_timestamp_ns = out_timestamp_ns - scheduling_slice.duration_ns();
+
+  OpenBatch& batch = open_batches_[core];
+  if (batch.slices.durations_ns_size() == 0) {
+    batch.slices.set_core(core);
+    batch.first_out_timestamp_ns = out_timestamp_ns;
+  }
+  auto [thread_index_it, inserted] = batch.thread_indices.try_emplace(
+      std::make_pair(scheduling_slice.pid(), scheduling_slice.tid()),
+      batch.slices.thread_pids_size());
+  if (inserted) {
+    batch.slices.add_thread_pids(scheduling_slice.pid());
+    batch.slices.add_thread_tids(scheduling_slice.tid());
+  }
+  batch.slices.add_thread_indices(thread_index_it->second);
+  batch.slices.add_in_timestamp_deltas_ns(static_cast<int64_t>(in_timestamp_ns) -
+                                          static_cast<int64_t>(batch.last_out_timestamp_ns));
+  batch.slices.add_durations_ns(scheduling_slice.duration_ns());
+  batch.last_out_timestamp_ns = out_timestamp_ns;
+
+  if (static_cast<size_t>(batch.slices.durations_ns_size()) >= max_slices_per_batch_) {
+    completed_batches.emplace_back(CloseBatch(&batch));
+  }
+
+  // Scanning all cores for every slice would be wasteful, so only do it once per batch duration.
+  if (out_timestamp_ns >= last_duration_check_timestamp_ns_ + max_batch_duration_ns_) {
+    last_duration_check_timestamp_ns_ = out_timestamp_ns;
+    for (OpenBatch& open_batch : open_batches_) {
+      if (open_batch.slices.durations_ns_size() == 0) continue;
+      if (out_timestamp_ns - open_batch.first_out_timestamp_ns >= max_batch_duration_ns_) {
+        completed_batches.emplace_back(CloseBatch(&open_batch));
+      }
+    }
+  }
+
+  return completed_batches;
+}
+
+std::vector<SchedulingSlicesOnCore> SchedulingSliceEncoder::Flush() {
+  std::vector<SchedulingSlicesOnCore> batches;
+  for (OpenBatch& open_batch : open_batches_) {
+    if (open_batch.slices.durations_ns_size() == 0) continue;
+    batches.emplace_back(CloseBatch(&open_batch));
+  }
+  return batches;
+}
+
+SchedulingSlicesOnCore SchedulingSliceEncoder::CloseBatch(OpenBatch* batch) {
+  SchedulingSlicesOnCore slices = std::move(batch->slices);
+  *batch = OpenBatch{};
+  return slices;
+}
+
+}  // namespace orbit_service
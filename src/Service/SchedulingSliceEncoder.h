@@ -0,0 +1,64 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SERVICE_SCHEDULING_SLICE_ENCODER_H_
+#define SERVICE_SCHEDULING_SLICE_ENCODER_H_
+
+#include <absl/container/flat_hash_map.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "capture.pb.h"
+
+namespace orbit_service {
+
+// Encodes the SchedulingSlices produced by LinuxTracing into one SchedulingSlicesOnCore per core.
+// For system-wide captures scheduling slices are the largest category of events, and sending them
+// one by one repeats the pid, the tid, the core, and a full timestamp for every slice.
+//
+// A batch is emitted when it contains `max_slices_per_batch` slices, or when it has been open for
+// more than `max_batch_duration_ns` of capture time (so that cores with few context switches still
+// show up in the live capture), or on Flush. Slices are expected in order of out timestamp.
+class SchedulingSliceEncoder {
+ public:
+  static constexpr size_t kDefaultMaxSlicesPerBatch = 4096;
+  static constexpr uint64_t kDefaultMaxBatchDurationNs = 200'000'000;
+
+  explicit SchedulingSliceEncoder(size_t max_slices_per_batch = kDefaultMaxSlicesPerBatch,
+                                  uint64_t max_batch_duration_ns = kDefaultMaxBatchDurationNs)
+      : max_slices_per_batch_{max_slices_per_batch},
+        max_batch_duration_ns_{max_batch_duration_ns} {}
+
+  // Returns the batches that were completed by adding `scheduling_slice`, usually none.
+  [[nodiscard]] std::vector<orbit_grpc_protos::SchedulingSlicesOnCore> EncodeSchedulingSlice(
+      const orbit_grpc_protos::SchedulingSlice& scheduling_slice);
+
+  // Returns all the batches that are still open, in order of core.
+  [[nodiscard]] std::vector<orbit_grpc_protos::SchedulingSlicesOnCore> Flush();
+
+ private:
+  struct OpenBatch {
+    orbit_grpc_protos::SchedulingSlicesOnCore slices;
+    // Keyed by (pid, tid), the values are indices into slices.thread_pids and slices.thread_tids.
+    absl::flat_hash_map<std::pair<int32_t, int32_t>, uint32_t> thread_indices;
+    uint64_t first_out_timestamp_ns = 0;
+    uint64_t last_out_timestamp_ns = 0;
+  };
+
+  [[nodiscard]] static orbit_grpc_protos::SchedulingSlicesOnCore CloseBatch(OpenBatch* batch);
+
+  size_t max_slices_per_batch_;
+  uint64_t max_batch_duration_ns_;
+  // Indexed by core.
+  std::vector<OpenBatch> open_batches_;
+  // Out timestamp of the last time open batches were checked for their duration.
+  uint64_t last_duration_check_timestamp_ns_ = 0;
+};
+
+}  // namespace orbit_service
+
+#endif  // SERVICE_SCHEDULING_SLICE_ENCODER_H_
@@ -0,0 +1,142 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "SchedulingSliceEncoder.h"
+#include "capture.pb.h"
+
+namespace orbit_service {
+
+using orbit_grpc_protos::SchedulingSlice;
+using orbit_grpc_protos::SchedulingSlicesOnCore;
+
+namespace {
+
+SchedulingSlice MakeSchedulingSlice(int32_t pid, int32_t tid, int32_t core,
+                                    uint64_t in_timestamp_ns, uint64_t out_timestamp_ns) {
+  SchedulingSlice scheduling_slice;
+  scheduling_slice.set_pid(pid);
+  scheduling_slice.set_tid(tid);
+  scheduling_slice.set_core(core);
+  scheduling_slice.set_duration_ns(out_timestamp_ns - in_timestamp_ns);
+  scheduling_slice.set_out_timestamp_ns(out_timestamp_ns);
+  return scheduling_slice;
+}
+
+// Same decoding as in the client's CaptureEventProcessor.
+std::vector<SchedulingSlice> Decode(const SchedulingSlicesOnCore& scheduling_slices_on_core) {
+  std::vector<SchedulingSlice> scheduling_slices;
+  uint64_t previous_out_timestamp_ns = 0;
+  for (int i = 0; i < scheduling_slices_on_core.durations_ns_size(); ++i) {
+    const uint64_t in_timestamp_ns =
+        previous_out_timestamp_ns + scheduling_slices_on_core.in_timestamp_deltas_ns(i);
+    const uint64_t out_timestamp_ns = in_timestamp_ns + scheduling_slices_on_core.durations_ns(i);
+    const uint32_t thread_index = scheduling_slices_on_core.thread_indices(i);
+    scheduling_slices.emplace_back(MakeSchedulingSlice(
+        scheduling_slices_on_core.thread_pids(thread_index),
+        scheduling_slices_on_core.thread_tids(thread_index), scheduling_slices_on_core.core(),
+        in_timestamp_ns, out_timestamp_ns));
+    previous_out_timestamp_ns = out_timestamp_ns;
+  }
+  return scheduling_slices;
+}
+
+void ExpectSchedulingSliceEq(const SchedulingSlice& actual, const SchedulingSlice& expected) {
+  EXPECT_EQ(actual.pid(), expected.pid());
+  EXPECT_EQ(actual.tid(), expected.tid());
+  EXPECT_EQ(actual.core(), expected.core());
+  EXPECT_EQ(actual.duration_ns(), expected.duration_ns());
+  EXPECT_EQ(actual.out_timestamp_ns(), expected.out_timestamp_ns());
+}
+
+}  // namespace
+
+TEST(SchedulingSliceEncoder, SlicesAreBatchedPerCoreWithThreadDictionary) {
+  SchedulingSliceEncoder encoder;
+  const std::vector<SchedulingSlice> slices_on_core_0{
+      MakeSchedulingSlice(10, 11, 0, 1000, 1100), MakeSchedulingSlice(20, 21, 0, 1150, 1300),
+      MakeSchedulingSlice(10, 11, 0, 1300, 1400)};
+  const SchedulingSlice slice_on_core_2 = MakeSchedulingSlice(10, 12, 2, 1050, 1250);
+
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(slices_on_core_0[0]).empty());
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(slice_on_core_2).empty());
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(slices_on_core_0[1]).empty());
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(slices_on_core_0[2]).empty());
+
+  std::vector<SchedulingSlicesOnCore> batches = encoder.Flush();
+  ASSERT_EQ(batches.size(), 2);
+
+  EXPECT_EQ(batches[0].core(), 0);
+  EXPECT_THAT(batches[0].thread_pids(), testing::ElementsAre(10, 20));
+  EXPECT_THAT(batches[0].thread_tids(), testing::ElementsAre(11, 21));
+  EXPECT_THAT(batches[0].thread_indices(), testing::ElementsAre(0, 1, 0));
+  EXPECT_THAT(batches[0].in_timestamp_deltas_ns(), testing::ElementsAre(1000, 50, 0));
+  EXPECT_THAT(batches[0].durations_ns(), testing::ElementsAre(100, 150, 100));
+  std::vector<SchedulingSlice> decoded = Decode(batches[0]);
+  ASSERT_EQ(decoded.size(), slices_on_core_0.size());
+  for (size_t i = 0; i < decoded.size(); ++i) {
+    ExpectSchedulingSliceEq(decoded[i], slices_on_core_0[i]);
+  }
+
+  EXPECT_EQ(batches[1].core(), 2);
+  decoded = Decode(batches[1]);
+  ASSERT_EQ(decoded.size(), 1);
+  ExpectSchedulingSliceEq(decoded[0], slice_on_core_2);
+
+  EXPECT_TRUE(encoder.Flush().empty());
+}
+
+TEST(SchedulingSliceEncoder, FullBatchIsEmittedAndNextBatchStartsFromZero) {
+  SchedulingSliceEncoder encoder{/*max_slices_per_batch=*/2};
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(MakeSchedulingSlice(10, 11, 1, 100, 200)).empty());
+  std::vector<SchedulingSlicesOnCore> batches =
+      encoder.EncodeSchedulingSlice(MakeSchedulingSlice(10, 11, 1, 300, 400));
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_EQ(batches[0].durations_ns_size(), 2);
+
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(MakeSchedulingSlice(20, 21, 1, 500, 600)).empty());
+  batches = encoder.Flush();
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_THAT(batches[0].thread_tids(), testing::ElementsAre(21));
+  EXPECT_THAT(batches[0].in_timestamp_deltas_ns(), testing::ElementsAre(500));
+}
+
+TEST(SchedulingSliceEncoder, OldBatchesAreEmittedEvenIfTheirCoreIsIdle) {
+  SchedulingSliceEncoder encoder{/*max_slices_per_batch=*/100, /*max_batch_duration_ns=*/1000};
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(MakeSchedulingSlice(10, 11, 0, 100, 200)).empty());
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(MakeSchedulingSlice(10, 12, 1, 500, 900)).empty());
+
+  std::vector<SchedulingSlicesOnCore> batches =
+      encoder.EncodeSchedulingSlice(MakeSchedulingSlice(10, 12, 1, 1000, 1300));
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_EQ(batches[0].core(), 0);
+
+  batches = encoder.Flush();
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_EQ(batches[0].core(), 1);
+  EXPECT_EQ(batches[0].durations_ns_size(), 2);
+}
+
+TEST(SchedulingSliceEncoder, InTimestampBeforePreviousOutTimestampIsPreserved) {
+  SchedulingSliceEncoder encoder;
+  const SchedulingSlice first = MakeSchedulingSlice(10, 11, 0, 100, 300);
+  const SchedulingSlice second = MakeSchedulingSlice(10, 12, 0, 250, 400);
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(first).empty());
+  EXPECT_TRUE(encoder.EncodeSchedulingSlice(second).empty());
+
+  std::vector<SchedulingSlicesOnCore> batches = encoder.Flush();
+  ASSERT_EQ(batches.size(), 1);
+  EXPECT_THAT(batches[0].in_timestamp_deltas_ns(), testing::ElementsAre(100, -50));
+  std::vector<SchedulingSlice> decoded = Decode(batches[0]);
+  ASSERT_EQ(decoded.size(), 2);
+  ExpectSchedulingSliceEq(decoded[0], first);
+  ExpectSchedulingSliceEq(decoded[1], second);
+}
+
+}  // namespace orbit_service
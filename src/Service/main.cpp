@@ -21,6 +21,11 @@ ABSL_FLAG(uint64_t, grpc_port, 44765, "gRPC server port");
 
 ABSL_FLAG(bool, devmode, false, "Enable developer mode");
 
+ABSL_FLAG(bool, pre_arm_perf_events, false,
+          "Keep the perf_event_open file descriptors of a capture open, but disabled, after the "
+          "capture, so that the next capture with the same options starts much faster. They are "
+          "closed if no capture uses them for 10 minutes");
+
 namespace {
 std::atomic<bool> exit_requested;
 
@@ -7,6 +7,7 @@
 #include <QColor>
 #include <QRegularExpression>
 #include <QString>
+#include <QTextBlock>
 #include <QTextCharFormat>
 
 namespace orbit_syntax_highlighter {
@@ -134,6 +135,43 @@ CppHighlighterState HighlightBlockCpp(
   return next_block_state;
 }
 
+CppHighlighterState ComputeNextBlockStateCpp(const QString& code, int previous_block_state) {
+  CppHighlighterState next_block_state = CppHighlighterState::kInitialState;
+  const auto apply = [&code, &next_block_state](
+                         const QRegularExpression& expression,
+                         CppHighlighterState new_state = CppHighlighterState::kInitialState) {
+    if (expression.match(code).hasMatch()) next_block_state = new_state;
+  };
+
+  // This mirrors the tail of HighlightBlockCpp. Matches of the patterns before kStringRegex would
+  // only reset the state to kInitialState, which is the default anyway.
+  apply(CppRegex::kStringRegex);
+  apply(CppRegex::kCommentRegex);
+
+  if (previous_block_state == CppHighlighterState::kOpenStringState) {
+    apply(CppRegex::kNoEndStringRegex, CppHighlighterState::kOpenStringState);
+    apply(CppRegex::kEndStringRegex);
+  }
+  if (previous_block_state == CppHighlighterState::kOpenCommentState) {
+    apply(CppRegex::kNoEndCommentRegex, CppHighlighterState::kOpenCommentState);
+    apply(CppRegex::kEndCommentRegex);
+  }
+  apply(CppRegex::kOpenStringRegex, CppHighlighterState::kOpenStringState);
+  apply(CppRegex::kOpenCommentRegex, CppHighlighterState::kOpenCommentState);
+
+  return next_block_state;
+}
+
+int CppBlockHighlighter::HighlightBlock(const QTextBlock& block, int previous_block_state,
+                                        const SetFormatFunction& set_format) const {
+  return HighlightBlockCpp(block.text(), previous_block_state, set_format);
+}
+
+int CppBlockHighlighter::ComputeNextBlockState(const QTextBlock& block,
+                                               int previous_block_state) const {
+  return ComputeNextBlockStateCpp(block.text(), previous_block_state);
+}
+
 void Cpp::highlightBlock(const QString& code) {
   setCurrentBlockState(HighlightBlockCpp(
       code, previousBlockState(), [this](int start, int count, const QTextCharFormat& format) {
@@ -9,6 +9,7 @@
 #include <QColor>
 #include <QRegularExpression>
 #include <QString>
+#include <QTextBlock>
 #include <QTextCharFormat>
 
 #include "SyntaxHighlighter/HighlightingMetadata.h"
@@ -232,6 +233,19 @@ void X86Assembly::highlightBlock(const QString& code) {
   }
 }
 
+int X86AssemblyBlockHighlighter::HighlightBlock(const QTextBlock& block,
+                                                int /*previous_block_state*/,
+                                                const SetFormatFunction& set_format) const {
+  const HighlightingMetadata* const highlighting_metadata =
+      dynamic_cast<const HighlightingMetadata*>(block.userData());
+  if (highlighting_metadata == nullptr || highlighting_metadata->IsMainContentLine()) {
+    HighlightBlockAssembly(block.text(), set_format);
+  } else {  // Metadata::LineType::kAnnotatingLine
+    HighlightAnnotatingBlock(block.text(), set_format);
+  }
+  return kNoPreviousBlockState;
+}
+
 // Highlight every character with the same default_color
 void HighlightAnnotatingBlock(
     const QString& code, const std::function<void(int, int, const QTextCharFormat&)>& set_format,
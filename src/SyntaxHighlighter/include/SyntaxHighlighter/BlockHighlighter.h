@@ -0,0 +1,40 @@
+// Copyright (c) 2021 The Orbit Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef SYNTAX_HIGHLIGHTER_BLOCK_HIGHLIGHTER_H_
+#define SYNTAX_HIGHLIGHTER_BLOCK_HIGHLIGHTER_H_
+
+#include <QTextBlock>
+#include <QTextCharFormat>
+#include <functional>
+
+namespace orbit_syntax_highlighter {
+
+// A syntax highlighter that, in contrast to QSyntaxHighlighter, is not attached to a document.
+// It highlights a single block at a time, which allows the caller to only highlight the blocks that
+// are actually visible (see orbit_code_viewer::LazySyntaxHighlighter).
+//
+// Like in QSyntaxHighlighter, a block can depend on the preceding blocks through an integer state
+// (e.g. an open multi-line comment). The state passed for the first block is kNoPreviousBlockState.
+class BlockHighlighter {
+ public:
+  using SetFormatFunction = std::function<void(int, int, const QTextCharFormat&)>;
+  static constexpr int kNoPreviousBlockState = -1;
+
+  virtual ~BlockHighlighter() = default;
+
+  // Calls `set_format(start, count, format)` for the ranges of `block` to format. Later calls paint
+  // over earlier ones. Returns the state at the end of `block`.
+  [[nodiscard]] virtual int HighlightBlock(const QTextBlock& block, int previous_block_state,
+                                           const SetFormatFunction& set_format) const = 0;
+
+  // Returns the same state as HighlightBlock but without determining any formats. This is used for
+  // blocks that are not visible, so it needs to be considerably cheaper than HighlightBlock.
+  [[nodiscard]] virtual int ComputeNextBlockState(const QTextBlock& block,
+                                                  int previous_block_state) const = 0;
+};
+
+}  // namespace orbit_syntax_highlighter
+
+#endif  // SYNTAX_HIGHLIGHTER_BLOCK_HIGHLIGHTER_H_
@@ -8,6 +8,8 @@
 #include <QRegularExpression>
 #include <QSyntaxHighlighter>
 
+#include "SyntaxHighlighter/BlockHighlighter.h"
+
 namespace orbit_syntax_highlighter {
 
 //  This a syntax highlighter for C++.
@@ -25,9 +27,23 @@ class Cpp : public QSyntaxHighlighter {
   explicit Cpp();
 };
 
+// Same as Cpp, but highlights blocks on demand. See BlockHighlighter.
+class CppBlockHighlighter : public BlockHighlighter {
+ public:
+  [[nodiscard]] int HighlightBlock(const QTextBlock& block, int previous_block_state,
+                                   const SetFormatFunction& set_format) const override;
+  [[nodiscard]] int ComputeNextBlockState(const QTextBlock& block,
+                                          int previous_block_state) const override;
+};
+
 CppHighlighterState HighlightBlockCpp(
     const QString& code, int previous_block_state,
     std::function<void(int, int, const QTextCharFormat&)> set_format);
+
+// Returns the same state as HighlightBlockCpp. Only the patterns for strings and comments are
+// evaluated, as all others can't affect the state.
+[[nodiscard]] CppHighlighterState ComputeNextBlockStateCpp(const QString& code,
+                                                           int previous_block_state);
 }  // namespace orbit_syntax_highlighter
 
 #endif  // SYNTAX_HIGHLIGHTER_CPP_H_
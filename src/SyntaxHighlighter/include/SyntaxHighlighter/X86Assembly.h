@@ -10,6 +10,8 @@
 
 #include <QSyntaxHighlighter>
 
+#include "SyntaxHighlighter/BlockHighlighter.h"
+
 namespace orbit_syntax_highlighter {
 
 /*
@@ -28,6 +30,18 @@ class X86Assembly : public QSyntaxHighlighter {
   explicit X86Assembly();
 };
 
+// Same as X86Assembly, but highlights blocks on demand. See BlockHighlighter. Assembly has no
+// multi-line constructs, so blocks don't depend on each other.
+class X86AssemblyBlockHighlighter : public BlockHighlighter {
+ public:
+  [[nodiscard]] int HighlightBlock(const QTextBlock& block, int previous_block_state,
+                                   const SetFormatFunction& set_format) const override;
+  [[nodiscard]] int ComputeNextBlockState(const QTextBlock& /*block*/,
+                                          int /*previous_block_state*/) const override {
+    return kNoPreviousBlockState;
+  }
+};
+
 void HighlightBlockAssembly(
     const QString& code, const std::function<void(int, int, const QTextCharFormat&)>& set_format);
 void HighlightAnnotatingBlock(